@@ -0,0 +1,144 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#define _GNU_SOURCE
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <stdlib.h>
+
+#include "alloc-count.h"
+
+#if defined(ENABLE_ALLOC_COUNT) && defined(__GLIBC__)
+
+#include <errno.h>
+
+/* the allocator of the C library */
+extern void    *__libc_malloc(size_t size);
+extern void    *__libc_calloc(size_t nmemb, size_t size);
+extern void    *__libc_realloc(void *ptr, size_t size);
+extern void    *__libc_memalign(size_t alignment, size_t size);
+extern void     __libc_free(void *ptr);
+
+static _Thread_local gboolean counting = FALSE;
+static _Thread_local guint count = 0;
+
+/* Count an allocation if the calling thread is counted */
+static inline void count_alloc(void)
+{
+    if (G_UNLIKELY(counting))
+        count++;
+}
+
+void           *malloc(size_t size)
+{
+    count_alloc();
+    return __libc_malloc(size);
+}
+
+void           *calloc(size_t nmemb, size_t size)
+{
+    count_alloc();
+    return __libc_calloc(nmemb, size);
+}
+
+void           *realloc(void *ptr, size_t size)
+{
+    if (size > 0)
+        count_alloc();
+    return __libc_realloc(ptr, size);
+}
+
+void           *memalign(size_t alignment, size_t size)
+{
+    count_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+void           *aligned_alloc(size_t alignment, size_t size)
+{
+    count_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    void           *ptr;
+
+    if (alignment == 0 || alignment % sizeof(void *) != 0 ||
+        (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    count_alloc();
+    ptr = __libc_memalign(alignment, size);
+    if (ptr == NULL)
+        return ENOMEM;
+
+    *memptr = ptr;
+
+    return 0;
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+/**
+ * Start counting the allocations of the calling thread.
+ *
+ * @return TRUE if the counter is available.
+ */
+gboolean alloc_count_enable()
+{
+    counting = TRUE;
+
+    return TRUE;
+}
+
+/** Check whether the allocations of the calling thread are counted. */
+gboolean alloc_count_enabled()
+{
+    return counting;
+}
+
+/** Get the number of allocations made on the calling thread. */
+guint alloc_count_get()
+{
+    return count;
+}
+
+#else
+
+gboolean alloc_count_enable()
+{
+    return FALSE;
+}
+
+gboolean alloc_count_enabled()
+{
+    return FALSE;
+}
+
+guint alloc_count_get()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H 1
+
+#include <glib.h>
+
+/*
+ * Heap allocation counter (configure --enable-alloc-count).
+ *
+ * Counts the heap allocations made on the threads where counting has been
+ * enabled, so that code paths that run in every module cycle can be kept
+ * free of allocations:
+ *
+ *   guint start = alloc_count_get();
+ *   ...
+ *   allocs = alloc_count_get() - start;
+ *
+ * Every allocation is counted, whether gpredict asked for it or GLib, GTK+,
+ * GooCanvas or Pango did so on its behalf.
+ *
+ * The counter replaces malloc() and friends and needs the GNU C library.
+ * In other builds alloc_count_enable() returns FALSE and the count stays 0.
+ */
+gboolean        alloc_count_enable(void);
+gboolean        alloc_count_enabled(void);
+guint           alloc_count_get(void);
+
+#endif
@@ -26,6 +26,10 @@
 #include <build-config.h>
 #endif
 #include <glib.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 #include "compat.h"
 
@@ -321,6 +325,19 @@ gchar          *get_hwconf_dir(void)
     return dir;
 }
 
+/** Get USER_CONF_DIR/cache */
+gchar          *get_cache_dir(void)
+{
+    gchar          *confdir;
+    gchar          *dir;
+
+    confdir = get_user_conf_dir();
+    dir = g_strconcat(confdir, G_DIR_SEPARATOR_S, "cache", NULL);
+    g_free(confdir);
+
+    return dir;
+}
+
 /** Get full path of a .sat or .cat file */
 gchar          *sat_file_name(const gchar * satfile)
 {
@@ -395,3 +412,26 @@ gchar          *hw_file_name(const gchar * hwfile)
 
     return filename;
 }
+
+/**
+ * Remove a UNIX socket left behind by a previous run.
+ *
+ * @param path The path of the socket.
+ * @return TRUE if the path is free, FALSE if it is something other than a
+ *         socket, which is left alone.
+ */
+gboolean remove_stale_socket(const gchar * path)
+{
+#ifdef G_OS_UNIX
+    GStatBuf        st;
+
+    if (g_lstat(path, &st) != 0)
+        return TRUE;
+
+    if (!S_ISSOCK(st.st_mode))
+        return FALSE;
+#endif
+    g_unlink(path);
+
+    return TRUE;
+}
@@ -11,6 +11,7 @@ gchar          *get_modules_dir(void);
 gchar          *get_satdata_dir(void);
 gchar          *get_trsp_dir(void);
 gchar          *get_hwconf_dir(void);
+gchar          *get_cache_dir(void);
 gchar          *get_old_conf_dir(void);
 gchar          *map_file_name(const gchar * map);
 gchar          *logo_file_name(const gchar * logo);
@@ -23,4 +24,6 @@ gchar          *hw_file_name(const gchar * hwfile);
 gchar          *sat_file_name_from_catnum(guint catnum);
 gchar          *sat_file_name_from_catnum_s(gchar * catnum);
 
+gboolean        remove_stale_socket(const gchar * path);
+
 #endif
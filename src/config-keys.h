@@ -60,6 +60,7 @@
 #define QTH_CFG_GPSD_SERVER_KEY "GPSDSERVER"
 #define QTH_CFG_GPSD_PORT_KEY  "GPSDPORT"
 #define QTH_CFG_TYPE_KEY       "QTH_TYPE"
+#define QTH_CFG_TRAJ_FILE_KEY  "TRAJECTORY"
 
 /* Module files (.mod) */
 
@@ -0,0 +1,178 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Benchmark for the close approach screening.
+ *
+ * A synthetic catalogue of random objects, most of them in low Earth orbit
+ * and the rest in medium and geostationary orbits, is screened over a
+ * window of the given length with the default threshold. By default all
+ * objects are primaries, which is the worst case; with a number of
+ * primaries the first objects are screened against the rest, as the
+ * conjunction dialog does with the satellites of a module. The wall clock
+ * time and the work done by each stage are printed as JSON like those of
+ * ephem-bench.
+ *
+ * Usage: conj-bench [objects [primaries [hours]]]
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conj-screen.h"
+#include "gtk-sat-data.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+#define DEF_OBJECTS     5000
+#define DEF_HOURS       24.0
+#define RAND_SEED       4711
+
+/* the main window used by other parts of gpredict */
+GtkWidget      *app = NULL;
+
+/* Create an object with random elements */
+static void make_sat(sat_t * sat, GRand * rand, gint catnum)
+{
+    gdouble         alt, ecc, incl, a;
+    gdouble         r = g_rand_double(rand);
+
+    if (r < 0.85)
+    {
+        alt = g_rand_double_range(rand, 300.0, 1500.0);
+        ecc = g_rand_double_range(rand, 0.0, 0.02);
+        incl = g_rand_double_range(rand, 0.0, 100.0);
+    }
+    else if (r < 0.93)
+    {
+        alt = g_rand_double_range(rand, 19000.0, 24000.0);
+        ecc = g_rand_double_range(rand, 0.0, 0.01);
+        incl = g_rand_double_range(rand, 50.0, 65.0);
+    }
+    else
+    {
+        alt = g_rand_double_range(rand, 35700.0, 35900.0);
+        ecc = g_rand_double_range(rand, 0.0, 0.001);
+        incl = g_rand_double_range(rand, 0.0, 15.0);
+    }
+    a = xkmper + alt;
+
+    memset(sat, 0, sizeof(sat_t));
+    sat->tle.catnr = catnum;
+    sat->tle.epoch = 17001.0;
+    sat->tle.epoch_year = 17;
+    sat->tle.epoch_day = 1;
+    sat->tle.xincl = incl;
+    sat->tle.xnodeo = g_rand_double_range(rand, 0.0, 360.0);
+    sat->tle.eo = ecc;
+    sat->tle.omegao = g_rand_double_range(rand, 0.0, 360.0);
+    sat->tle.xmo = g_rand_double_range(rand, 0.0, 360.0);
+    sat->tle.xno = sqrt(ge / (a * a * a)) * secday / twopi;
+    sat->tle.bstar = 1.0E-5;
+    sat->nickname = g_strdup_printf("OBJ %d", catnum);
+    select_ephemeris(sat);
+    gtk_sat_data_init_sat(sat, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    conj_job_t     *job;
+    GArray         *result;
+    GRand          *rand;
+    gchar          *confdir;
+    sat_t          *sats;
+    gdouble         hours = DEF_HOURS;
+    gdouble         secs;
+    gint64          start;
+    gint            objects = DEF_OBJECTS;
+    gint            primaries = -1;
+    gint            i;
+
+    if (argc > 1)
+        objects = atoi(argv[1]);
+    if (argc > 2)
+        primaries = atoi(argv[2]);
+    if (argc > 3)
+        hours = g_ascii_strtod(argv[3], NULL);
+    if (objects < 2 || primaries > objects || hours <= 0.0)
+    {
+        fprintf(stderr, "Usage: %s [objects [primaries [hours]]]\n",
+                argv[0]);
+        return 1;
+    }
+    if (primaries < 0)
+        primaries = objects;
+
+    /* the default threshold, not that of the user configuration */
+    confdir = g_dir_make_tmp("gpredict-bench-XXXXXX", NULL);
+    if (confdir == NULL)
+    {
+        fprintf(stderr, "Could not create a configuration directory\n");
+        return 1;
+    }
+    g_setenv("XDG_CONFIG_HOME", confdir, TRUE);
+
+    sat_log_init();
+    sat_cfg_load();
+
+    sats = g_new(sat_t, objects);
+    rand = g_rand_new_with_seed(RAND_SEED);
+    for (i = 0; i < objects; i++)
+        make_sat(&sats[i], rand, 10000 + i);
+    g_rand_free(rand);
+
+    job = conj_job_new(sats[0].jul_epoch, sats[0].jul_epoch + hours / 24.0,
+                       sat_cfg_get_int(SAT_CFG_INT_CONJ_THRESHOLD));
+    for (i = 0; i < objects; i++)
+        conj_job_add_sat(job, &sats[i], i < primaries);
+
+    start = g_get_monotonic_time();
+    result = conj_job_run(job);
+    secs = (g_get_monotonic_time() - start) / 1.0e6;
+
+    printf("{\"benchmark\":\"conj-screen\",\"version\":1,"
+           "\"objects\":%d,\"primaries\":%d,\"hours\":%.1f,"
+           "\"threshold\":%.1f,\"step\":%.1f,\"threads\":%u,"
+           "\"seconds\":%.3f,\"pruned_apsis\":%u,\"pruned_plane\":%u,"
+           "\"candidates\":%u,\"approaches\":%u}\n",
+           objects, primaries, hours, job->threshold, job->step,
+           g_get_num_processors(), secs, job->pruned_apsis,
+           job->pruned_plane, job->candidates, result->len);
+
+    g_array_free(result, TRUE);
+    conj_job_free(job);
+    for (i = 0; i < objects; i++)
+    {
+        g_free(sats[i].nickname);
+        Sat_Release(&sats[i]);
+    }
+    g_free(sats);
+
+    sat_cfg_close();
+    sat_log_close();
+    g_free(confdir);
+
+    return 0;
+}
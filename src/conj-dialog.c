@@ -0,0 +1,379 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Close approach dialog.
+ *
+ * Screens the satellites of a module against each other and against all
+ * other satellites in the local database, and shows the close approaches
+ * found in the screening window. The screening runs in a background
+ * thread; closing the dialog cancels it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "compat.h"
+#include "conj-dialog.h"
+#include "conj-screen.h"
+#include "gtk-sat-data.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "time-tools.h"
+
+
+enum {
+    CONJ_COL_TCA = 0,
+    CONJ_COL_SAT1,
+    CONJ_COL_SAT2,
+    CONJ_COL_DIST,
+    CONJ_COL_RELVEL,
+    CONJ_COL_NUMBER
+};
+
+static const gchar *CONJ_COL_TITLE[CONJ_COL_NUMBER] = {
+    N_("Time of Closest Approach"),
+    N_("Satellite"),
+    N_("Object"),
+    N_("Miss Distance [km]"),
+    N_("Rel. Velocity [km/s]")
+};
+
+/* refresh interval of the progress bar [msec] */
+#define CONJ_PROGRESS_REFRESH 250
+
+typedef struct {
+    GtkWidget      *dialog;
+    GtkWidget      *progress;
+    GtkListStore   *store;
+    conj_job_t     *job;
+    GThread        *thread;
+    GArray         *result;
+    gint            done;
+    guint           timerid;
+} conj_dlg_t;
+
+
+/* Add the satellites of the local database as secondaries */
+static void load_catalogue(conj_job_t * job)
+{
+    GDir           *dir;
+    gchar          *dirname;
+    const gchar    *fname;
+    gchar         **buffv;
+    gint            catnum;
+    sat_t           sat;
+
+    dirname = get_satdata_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    if (!dir)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open satdata directory %s."),
+                    __func__, dirname);
+        g_free(dirname);
+        return;
+    }
+
+    while ((fname = g_dir_read_name(dir)) &&
+           !g_atomic_int_get(&job->cancel))
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        buffv = g_strsplit(fname, ".", 0);
+        catnum = (gint) g_ascii_strtoll(buffv[0], NULL, 0);
+        g_strfreev(buffv);
+
+        /* already added as a primary */
+        if (conj_job_get_name(job, catnum) != NULL)
+            continue;
+
+        memset(&sat, 0, sizeof(sat_t));
+        if (!gtk_sat_data_read_sat(catnum, &sat))
+            conj_job_add_sat(job, &sat, FALSE);
+
+        gtk_sat_data_clear_sat(&sat);
+    }
+
+    g_dir_close(dir);
+    g_free(dirname);
+}
+
+static gpointer conj_thread(gpointer data)
+{
+    conj_dlg_t     *dlg = data;
+
+    load_catalogue(dlg->job);
+    dlg->result = conj_job_run(dlg->job);
+    g_atomic_int_set(&dlg->done, 1);
+
+    return NULL;
+}
+
+static gchar   *object_label(conj_job_t * job, gint catnum)
+{
+    return g_strdup_printf("%s (%d)", conj_job_get_name(job, catnum), catnum);
+}
+
+/* Fill the list once the screening is done */
+static void fill_list(conj_dlg_t * dlg)
+{
+    conj_t         *conj;
+    GtkTreeIter     item;
+    gchar          *sat1, *sat2;
+    gchar          *buff;
+    guint           i;
+
+    for (i = 0; i < dlg->result->len; i++)
+    {
+        conj = &g_array_index(dlg->result, conj_t, i);
+        sat1 = object_label(dlg->job, conj->catnum1);
+        sat2 = object_label(dlg->job, conj->catnum2);
+
+        gtk_list_store_append(dlg->store, &item);
+        gtk_list_store_set(dlg->store, &item,
+                           CONJ_COL_TCA, conj->tca,
+                           CONJ_COL_SAT1, sat1,
+                           CONJ_COL_SAT2, sat2,
+                           CONJ_COL_DIST, conj->dist,
+                           CONJ_COL_RELVEL, conj->relvel, -1);
+        g_free(sat1);
+        g_free(sat2);
+    }
+
+    buff = g_strdup_printf(_("%d close approaches below %.0f km "
+                             "(%d objects screened)"),
+                           dlg->result->len, dlg->job->threshold,
+                           dlg->job->objs->len);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(dlg->progress), 1.0);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(dlg->progress), buff);
+    g_free(buff);
+}
+
+static gboolean progress_update(gpointer data)
+{
+    conj_dlg_t     *dlg = data;
+
+    if (!g_atomic_int_get(&dlg->done))
+    {
+        if (dlg->job->steps == 0)
+            gtk_progress_bar_pulse(GTK_PROGRESS_BAR(dlg->progress));
+        else
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(dlg->progress),
+                                          conj_job_get_progress(dlg->job));
+
+        return TRUE;
+    }
+
+    g_thread_join(dlg->thread);
+    dlg->thread = NULL;
+    dlg->timerid = 0;
+    fill_list(dlg);
+
+    return FALSE;
+}
+
+static void conj_dialog_destroy(GtkWidget * dialog, gpointer data)
+{
+    conj_dlg_t     *dlg = data;
+
+    (void)dialog;
+
+    if (dlg->timerid > 0)
+        g_source_remove(dlg->timerid);
+
+    if (dlg->thread != NULL)
+    {
+        conj_job_cancel(dlg->job);
+        g_thread_join(dlg->thread);
+    }
+
+    if (dlg->result != NULL)
+        g_array_free(dlg->result, TRUE);
+
+    conj_job_free(dlg->job);
+    g_free(dlg);
+}
+
+static void conj_dialog_response(GtkWidget * dialog, gint response,
+                                 gpointer data)
+{
+    (void)response;
+    (void)data;
+
+    gtk_widget_destroy(dialog);
+}
+
+static void time_cell_data_function(GtkTreeViewColumn * col,
+                                    GtkCellRenderer * renderer,
+                                    GtkTreeModel * model,
+                                    GtkTreeIter * iter, gpointer column)
+{
+    gdouble         number;
+    gchar           buff[TIME_FORMAT_MAX_LENGTH];
+    gchar          *fmtstr;
+    guint           coli = GPOINTER_TO_UINT(column);
+
+    (void)col;
+
+    gtk_tree_model_get(model, iter, coli, &number, -1);
+
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, number);
+    g_object_set(renderer, "text", buff, NULL);
+    g_free(fmtstr);
+}
+
+static void two_dec_cell_data_function(GtkTreeViewColumn * col,
+                                       GtkCellRenderer * renderer,
+                                       GtkTreeModel * model,
+                                       GtkTreeIter * iter, gpointer column)
+{
+    gdouble         number;
+    gchar          *buff;
+    guint           coli = GPOINTER_TO_UINT(column);
+
+    (void)col;
+
+    gtk_tree_model_get(model, iter, coli, &number, -1);
+
+    buff = g_strdup_printf("%.2f", number);
+    g_object_set(renderer, "text", buff, NULL);
+    g_free(buff);
+}
+
+static GtkWidget *create_list(conj_dlg_t * dlg)
+{
+    GtkWidget      *list;
+    GtkCellRenderer *renderer;
+    GtkTreeViewColumn *column;
+    guint           i;
+
+    list = gtk_tree_view_new();
+
+    for (i = 0; i < CONJ_COL_NUMBER; i++)
+    {
+        renderer = gtk_cell_renderer_text_new();
+        g_object_set(G_OBJECT(renderer), "xalign",
+                     (i == CONJ_COL_SAT1 || i == CONJ_COL_SAT2) ? 0.0 : 0.5,
+                     NULL);
+        column = gtk_tree_view_column_new_with_attributes(_(CONJ_COL_TITLE[i]),
+                                                          renderer, "text", i,
+                                                          NULL);
+        gtk_tree_view_column_set_alignment(column, 0.5);
+        gtk_tree_view_column_set_sort_column_id(column, i);
+        gtk_tree_view_insert_column(GTK_TREE_VIEW(list), column, -1);
+
+        if (i == CONJ_COL_TCA)
+            gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                                    time_cell_data_function,
+                                                    GUINT_TO_POINTER(i),
+                                                    NULL);
+        else if (i == CONJ_COL_DIST || i == CONJ_COL_RELVEL)
+            gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                                    two_dec_cell_data_function,
+                                                    GUINT_TO_POINTER(i),
+                                                    NULL);
+    }
+
+    dlg->store = gtk_list_store_new(CONJ_COL_NUMBER, G_TYPE_DOUBLE,
+                                    G_TYPE_STRING, G_TYPE_STRING,
+                                    G_TYPE_DOUBLE, G_TYPE_DOUBLE);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(dlg->store));
+    g_object_unref(dlg->store);
+
+    return list;
+}
+
+static void add_sat(gpointer key, gpointer value, gpointer user_data)
+{
+    (void)key;
+
+    conj_job_add_sat(user_data, SAT(value), TRUE);
+}
+
+/**
+ * Show close approaches of a set of satellites.
+ *
+ * @param name The name of the module, used in the title.
+ * @param sats The satellites to screen (catnum -> sat_t).
+ * @param t0 The start of the screening window.
+ * @param toplevel The parent window.
+ *
+ * The window length and the miss distance threshold are taken from
+ * SAT_CFG_INT_CONJ_WINDOW and SAT_CFG_INT_CONJ_THRESHOLD.
+ */
+void conj_dialog_show(const gchar * name, GHashTable * sats, gdouble t0,
+                      GtkWidget * toplevel)
+{
+    conj_dlg_t     *dlg;
+    GtkWidget      *swin, *vbox;
+    gchar          *title;
+    gchar          *buff;
+    gdouble         t1;
+
+    t1 = t0 + sat_cfg_get_int(SAT_CFG_INT_CONJ_WINDOW) / 24.0;
+
+    dlg = g_new0(conj_dlg_t, 1);
+    dlg->job = conj_job_new(t0, t1, sat_cfg_get_int(SAT_CFG_INT_CONJ_THRESHOLD));
+    g_hash_table_foreach(sats, add_sat, dlg->job);
+
+    swin = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(swin),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(swin), create_list(dlg));
+
+    dlg->progress = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(dlg->progress), TRUE);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(dlg->progress),
+                              _("Screening..."));
+
+    title = g_strdup_printf(_("Close approaches for %s"), name);
+    dlg->dialog = gtk_dialog_new_with_buttons(title,
+                                              GTK_WINDOW(toplevel),
+                                              GTK_DIALOG_DESTROY_WITH_PARENT,
+                                              "_Close", GTK_RESPONSE_CLOSE,
+                                              NULL);
+    g_free(title);
+
+    buff = icon_file_name("gpredict-sat-list.png");
+    gtk_window_set_icon_from_file(GTK_WINDOW(dlg->dialog), buff, NULL);
+    g_free(buff);
+
+    gtk_window_set_modal(GTK_WINDOW(dlg->dialog), FALSE);
+    g_signal_connect(dlg->dialog, "response",
+                     G_CALLBACK(conj_dialog_response), NULL);
+    g_signal_connect(dlg->dialog, "destroy",
+                     G_CALLBACK(conj_dialog_destroy), dlg);
+
+    vbox = gtk_dialog_get_content_area(GTK_DIALOG(dlg->dialog));
+    gtk_box_pack_start(GTK_BOX(vbox), swin, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), dlg->progress, FALSE, FALSE, 0);
+
+    gtk_window_set_default_size(GTK_WINDOW(dlg->dialog), -1, 300);
+    gtk_widget_show_all(dlg->dialog);
+
+    dlg->thread = g_thread_new("gpredict_conj_dlg", conj_thread, dlg);
+    dlg->timerid = g_timeout_add(CONJ_PROGRESS_REFRESH, progress_update, dlg);
+}
@@ -0,0 +1,901 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Close approach screening.
+ *
+ * The objects are split into primaries (e.g. the satellites of a module)
+ * and secondaries (e.g. the rest of the catalogue). Pairs of primaries and
+ * pairs of a primary and a secondary are screened, pairs of secondaries are
+ * not. Without secondaries all pairs of primaries are screened.
+ *
+ * The screening is done in three stages:
+ *
+ *  1. Apogee/perigee filter: objects whose radial bands are separated by
+ *     more than the threshold can never meet. Secondaries that do not
+ *     overlap any primary are dropped before propagation.
+ *  2. Spatial sieve: at each time step the objects are sorted into a
+ *     uniform grid and only objects in neighbouring cells are compared.
+ *     The cell size covers the threshold plus the largest relative motion
+ *     within half a time step, so no approach can be missed.
+ *  3. Candidate pairs found by the sieve are checked with the orbital
+ *     plane filter, which looks at the radial distance of the orbits around
+ *     the line of intersection of the orbital planes. The minimum distance
+ *     of the survivors is bracketed around the time of closest approach of
+ *     the straight line motion and refined with a golden section search.
+ *
+ * The time window is split into slices that are screened in parallel, each
+ * thread working on its own copy of the propagators.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conj-screen.h"
+#include "sat-log.h"
+
+
+/* default sieve time step [sec] */
+#define CONJ_STEP           30.0
+
+/* upper limit for the relative velocity of two objects [km/sec] */
+#define CONJ_VREL_MAX       16.0
+
+/* margin for short periodic terms, drag and lunisolar effects [km] */
+#define CONJ_PAD            30.0
+
+/* TCA refinement tolerance [sec] */
+#define CONJ_TCA_TOL        1.0e-3
+
+/* initial half width of the TCA bracket around the linear estimate [sec] */
+#define CONJ_TCA_WIN        2.0
+
+/* offset of the grid cell indices so that they are positive */
+#define GRID_BIAS           (1 << 20)
+#define GRID_MASK           ((1 << 21) - 1)
+
+typedef struct {
+    sat_t           sat;        /* propagator template */
+    gint            catnum;
+    gboolean        primary;
+    gboolean        active;     /* FALSE if dropped by the apsis filter */
+    gboolean        deep;       /* deep space object */
+    gdouble         rp;         /* perigee radius [km] */
+    gdouble         ra;         /* apogee radius [km] */
+    gdouble         p;          /* semi-latus rectum [km] */
+    gdouble         e;          /* eccentricity */
+    gdouble         incl;       /* inclination [rad] */
+    gdouble         raan;       /* RAAN at the middle of the window [rad] */
+    gdouble         argp;       /* arg. of perigee at the middle of the window */
+    gdouble         draan;      /* J2 rate of the RAAN [rad/day] */
+    gdouble         dargp;      /* J2 rate of the arg. of perigee [rad/day] */
+} conj_obj_t;
+
+/* entry of the sorted grid */
+typedef struct {
+    guint64         key;
+    guint           idx;
+} grid_entry_t;
+
+/* state of one worker thread */
+typedef struct {
+    conj_job_t     *job;
+    gint            step0;      /* first time step of the slice */
+    gint            step1;      /* last time step of the slice (excl) */
+    sat_t          *sats;       /* propagators, one per active object */
+    guint          *objidx;     /* object index of each propagator */
+    guint           nsats;
+    gdouble        *pos;        /* positions at current step [km] */
+    gdouble        *vel;        /* velocities at current step [km/sec] */
+    grid_entry_t   *grid;
+    GHashTable     *filtered;   /* pair -> plane filter result + 1 */
+    GArray         *result;     /* conj_t */
+    guint           pruned_plane;
+    guint           candidates;
+} conj_worker_t;
+
+
+static void clear_obj(gpointer data)
+{
+    conj_obj_t     *obj = data;
+
+    Sat_Release(&obj->sat);
+}
+
+/**
+ * Create a new screening job.
+ *
+ * @param t0 The start of the time window.
+ * @param t1 The end of the time window.
+ * @param threshold The miss distance threshold [km].
+ * @return A new job, which should be freed with conj_job_free().
+ */
+conj_job_t     *conj_job_new(gdouble t0, gdouble t1, gdouble threshold)
+{
+    conj_job_t     *job;
+
+    job = g_new0(conj_job_t, 1);
+    job->t0 = t0;
+    job->t1 = t1;
+    job->threshold = threshold;
+    job->step = CONJ_STEP;
+    job->objs = g_array_new(FALSE, FALSE, sizeof(conj_obj_t));
+    g_array_set_clear_func(job->objs, clear_obj);
+    job->names = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                       NULL, g_free);
+
+    return job;
+}
+
+void conj_job_free(conj_job_t * job)
+{
+    if (job == NULL)
+        return;
+
+    g_array_free(job->objs, TRUE);
+    g_hash_table_destroy(job->names);
+    g_free(job);
+}
+
+/* Wrap an angle into [-pi;pi] */
+static gdouble wrap_pi(gdouble a)
+{
+    a = fmod(a, twopi);
+    if (a > pi)
+        a -= twopi;
+    else if (a < -pi)
+        a += twopi;
+
+    return a;
+}
+
+/**
+ * Add an object to the job.
+ *
+ * @param job The screening job.
+ * @param sat The satellite, initialised with gtk_sat_data_read_sat().
+ * @param primary Whether the satellite is a primary or a secondary object.
+ *
+ * The satellite data is copied.
+ */
+void conj_job_add_sat(conj_job_t * job, sat_t * sat, gboolean primary)
+{
+    conj_obj_t      obj;
+    gdouble         a, n, cosi, k, tm;
+
+    memset(&obj, 0, sizeof(conj_obj_t));
+    Sat_Copy(&obj.sat, sat);
+    obj.sat.name = NULL;
+    obj.sat.nickname = NULL;
+    obj.sat.website = NULL;
+    obj.sat.flags &= DEEP_SPACE_EPHEM_FLAG;
+    obj.catnum = sat->tle.catnr;
+    obj.primary = primary;
+    obj.active = TRUE;
+    obj.deep = (sat->flags & DEEP_SPACE_EPHEM_FLAG) ? TRUE : FALSE;
+
+    /* mean elements; tle.xno is in rad/min and the angles in rad */
+    a = xkmper * pow(xke / sat->tle.xno, tothrd);
+    obj.e = sat->tle.eo;
+    obj.p = a * (1.0 - obj.e * obj.e);
+    obj.rp = a * (1.0 - obj.e);
+    obj.ra = a * (1.0 + obj.e);
+    obj.incl = sat->tle.xincl;
+
+    /* secular J2 rates of the node and the perigee */
+    n = sat->tle.xno * xmnpda;
+    cosi = cos(obj.incl);
+    k = 1.5 * xj2 * (xkmper / obj.p) * (xkmper / obj.p) * n;
+    obj.draan = -k * cosi;
+    obj.dargp = 0.5 * k * (5.0 * cosi * cosi - 1.0);
+
+    tm = 0.5 * (job->t0 + job->t1) - sat->jul_epoch;
+    obj.raan = wrap_pi(sat->tle.xnodeo + obj.draan * tm);
+    obj.argp = wrap_pi(sat->tle.omegao + obj.dargp * tm);
+
+    g_array_append_val(job->objs, obj);
+
+    if (!primary)
+        job->nsec++;
+
+    g_hash_table_replace(job->names, GINT_TO_POINTER(obj.catnum),
+                         g_strdup(sat->nickname ? sat->nickname : sat->name));
+}
+
+/** Get the nickname of an object in the job. */
+const gchar    *conj_job_get_name(conj_job_t * job, gint catnum)
+{
+    return g_hash_table_lookup(job->names, GINT_TO_POINTER(catnum));
+}
+
+/** Stop a running job. The partial result is still returned. */
+void conj_job_cancel(conj_job_t * job)
+{
+    g_atomic_int_set(&job->cancel, 1);
+}
+
+/** Get the progress of a running job (0.0 - 1.0). */
+gdouble conj_job_get_progress(conj_job_t * job)
+{
+    if (job->steps == 0)
+        return 0.0;
+
+    return (gdouble) g_atomic_int_get(&job->progress) / job->steps;
+}
+
+/* Safety margin of the filters for a pair of objects */
+static gdouble pair_pad(conj_job_t * job, conj_obj_t * o1, conj_obj_t * o2)
+{
+    gdouble         pad = job->threshold + CONJ_PAD;
+
+    if (o1->deep || o2->deep)
+        pad += CONJ_PAD;
+
+    return pad;
+}
+
+/* Apogee/perigee filter; TRUE if the pair can approach */
+static gboolean apsis_filter(conj_job_t * job, conj_obj_t * o1,
+                             conj_obj_t * o2)
+{
+    gdouble         pad = pair_pad(job, o1, o2);
+
+    return (MAX(o1->rp, o2->rp) - MIN(o1->ra, o2->ra)) <= pad;
+}
+
+/* Radius range of an orbit for true anomalies within theta +/- delta */
+static void radius_band(conj_obj_t * obj, gdouble theta, gdouble delta,
+                        gdouble * lo, gdouble * hi)
+{
+    gdouble         r1, r2;
+
+    if (delta >= pi)
+    {
+        *lo = obj->rp;
+        *hi = obj->ra;
+        return;
+    }
+
+    r1 = obj->p / (1.0 + obj->e * cos(theta - delta));
+    r2 = obj->p / (1.0 + obj->e * cos(theta + delta));
+    *lo = MIN(r1, r2);
+    *hi = MAX(r1, r2);
+
+    /* perigee or apogee within the interval */
+    if (fabs(wrap_pi(theta)) <= delta)
+        *lo = obj->rp;
+    if (fabs(wrap_pi(theta - pi)) <= delta)
+        *hi = obj->ra;
+}
+
+/*
+ * Orbital plane filter; TRUE if the pair can approach.
+ *
+ * Two orbits can only be closer than D near the line of intersection of
+ * their planes, within an argument of latitude window of asin(D/(r sin I))
+ * where I is the mutual inclination. The window is widened by the J2 drift
+ * of the planes and perigees during the time window. If the radial bands
+ * of the orbits are separated by more than D at both crossings, the pair is
+ * rejected.
+ */
+static gboolean plane_filter(conj_job_t * job, conj_obj_t * o1,
+                             conj_obj_t * o2)
+{
+    gdouble         h1[3], h2[3], nd[3], n1[3], n2[3], m[3];
+    gdouble         sini, pad, span, delta, du, u1, u2;
+    gdouble         lo1, hi1, lo2, hi2;
+    gint            i;
+
+    /* lunisolar perturbations are not modelled */
+    if (o1->deep || o2->deep)
+        return TRUE;
+
+    pad = pair_pad(job, o1, o2);
+    span = 0.5 * (job->t1 - job->t0);
+
+    /* orbit normals */
+    h1[0] = sin(o1->incl) * sin(o1->raan);
+    h1[1] = -sin(o1->incl) * cos(o1->raan);
+    h1[2] = cos(o1->incl);
+    h2[0] = sin(o2->incl) * sin(o2->raan);
+    h2[1] = -sin(o2->incl) * cos(o2->raan);
+    h2[2] = cos(o2->incl);
+
+    /* line of intersection */
+    nd[0] = h1[1] * h2[2] - h1[2] * h2[1];
+    nd[1] = h1[2] * h2[0] - h1[0] * h2[2];
+    nd[2] = h1[0] * h2[1] - h1[1] * h2[0];
+    sini = sqrt(nd[0] * nd[0] + nd[1] * nd[1] + nd[2] * nd[2]);
+
+    /* node drift moves the line of intersection by about
+       drift / sin(I); give up for nearly coplanar orbits */
+    delta = span * (fabs(o1->draan) + fabs(o2->draan)) / MAX(sini, 1.0e-9);
+    if (pad >= MIN(o1->rp, o2->rp) * sini || delta >= pio2)
+        return TRUE;
+
+    for (i = 0; i < 3; i++)
+        nd[i] /= sini;
+
+    du = asin(pad / (MIN(o1->rp, o2->rp) * sini));
+
+    /* argument of latitude of the line of intersection in each orbit */
+    n1[0] = cos(o1->raan);
+    n1[1] = sin(o1->raan);
+    n1[2] = 0.0;
+    m[0] = h1[1] * n1[2] - h1[2] * n1[1];
+    m[1] = h1[2] * n1[0] - h1[0] * n1[2];
+    m[2] = h1[0] * n1[1] - h1[1] * n1[0];
+    u1 = atan2(nd[0] * m[0] + nd[1] * m[1] + nd[2] * m[2],
+               nd[0] * n1[0] + nd[1] * n1[1]);
+
+    n2[0] = cos(o2->raan);
+    n2[1] = sin(o2->raan);
+    n2[2] = 0.0;
+    m[0] = h2[1] * n2[2] - h2[2] * n2[1];
+    m[1] = h2[2] * n2[0] - h2[0] * n2[2];
+    m[2] = h2[0] * n2[1] - h2[1] * n2[0];
+    u2 = atan2(nd[0] * m[0] + nd[1] * m[1] + nd[2] * m[2],
+               nd[0] * n2[0] + nd[1] * n2[1]);
+
+    /* check both crossings */
+    for (i = 0; i < 2; i++)
+    {
+        radius_band(o1, u1 + i * pi - o1->argp,
+                    delta + du + span * fabs(o1->dargp), &lo1, &hi1);
+        radius_band(o2, u2 + i * pi - o2->argp,
+                    delta + du + span * fabs(o2->dargp), &lo2, &hi2);
+
+        if (MAX(lo1, lo2) - MIN(hi1, hi2) <= pad)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* Propagate a satellite and return the state in pos and vel */
+static void propagate(sat_t * sat, gdouble t, gdouble * pos, gdouble * vel)
+{
+    sat->jul_utc = t;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4(sat, sat->tsince);
+    else
+        SGP4(sat, sat->tsince);
+
+    Convert_Sat_State(&sat->pos, &sat->vel);
+
+    pos[0] = sat->pos.x;
+    pos[1] = sat->pos.y;
+    pos[2] = sat->pos.z;
+    vel[0] = sat->vel.x;
+    vel[1] = sat->vel.y;
+    vel[2] = sat->vel.z;
+}
+
+static gdouble pair_distance(sat_t * s1, sat_t * s2, gdouble t,
+                             gdouble * relvel)
+{
+    gdouble         p1[3], v1[3], p2[3], v2[3];
+    gdouble         d[3], dv[3];
+    gint            i;
+
+    propagate(s1, t, p1, v1);
+    propagate(s2, t, p2, v2);
+
+    for (i = 0; i < 3; i++)
+    {
+        d[i] = p1[i] - p2[i];
+        dv[i] = v1[i] - v2[i];
+    }
+
+    if (relvel != NULL)
+        *relvel = sqrt(dv[0] * dv[0] + dv[1] * dv[1] + dv[2] * dv[2]);
+
+    return sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
+
+/*
+ * Bracket the minimum distance around tc within [lo;hi].
+ *
+ * The straight line estimate tc is only good for fast encounters; when
+ * the relative velocity is small the curvature of the relative motion
+ * moves the minimum by up to a sieve step. Starting at +/- CONJ_TCA_WIN
+ * the bracket moves downhill with doubling width until the distance rises
+ * on both sides or the limit is reached.
+ */
+static void bracket_tca(sat_t * s1, sat_t * s2, gdouble tc, gdouble lo,
+                        gdouble hi, gdouble * ta, gdouble * tb)
+{
+    gdouble         h = CONJ_TCA_WIN / secday;
+    gdouble         a, b, fa, fb, fc;
+
+    a = MAX(tc - h, lo);
+    b = MIN(tc + h, hi);
+    fa = pair_distance(s1, s2, a, NULL);
+    fb = pair_distance(s1, s2, b, NULL);
+    fc = pair_distance(s1, s2, tc, NULL);
+
+    for (;;)
+    {
+        h *= 2.0;
+        if (fa < fc && fa <= fb && a > lo)
+        {
+            b = tc;
+            fb = fc;
+            tc = a;
+            fc = fa;
+            a = MAX(tc - h, lo);
+            fa = pair_distance(s1, s2, a, NULL);
+        }
+        else if (fb < fc && b < hi)
+        {
+            a = tc;
+            fa = fc;
+            tc = b;
+            fc = fb;
+            b = MIN(tc + h, hi);
+            fb = pair_distance(s1, s2, b, NULL);
+        }
+        else
+            break;
+    }
+
+    *ta = a;
+    *tb = b;
+}
+
+/* Find the time of closest approach around tc within [lo;hi] */
+static void refine_tca(conj_worker_t * w, guint i, guint j, gdouble tc,
+                       gdouble lo, gdouble hi)
+{
+    const gdouble   gr = 0.6180339887498949;
+    conj_job_t     *job = w->job;
+    sat_t          *s1 = &w->sats[i];
+    sat_t          *s2 = &w->sats[j];
+    conj_obj_t     *o1, *o2;
+    gdouble         ta, tb, x1, x2, f1, f2;
+    conj_t          conj;
+
+    bracket_tca(s1, s2, tc, lo, hi, &ta, &tb);
+
+    x1 = tb - gr * (tb - ta);
+    x2 = ta + gr * (tb - ta);
+    f1 = pair_distance(s1, s2, x1, NULL);
+    f2 = pair_distance(s1, s2, x2, NULL);
+
+    while ((tb - ta) * secday > CONJ_TCA_TOL)
+    {
+        if (f1 < f2)
+        {
+            tb = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = tb - gr * (tb - ta);
+            f1 = pair_distance(s1, s2, x1, NULL);
+        }
+        else
+        {
+            ta = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = ta + gr * (tb - ta);
+            f2 = pair_distance(s1, s2, x2, NULL);
+        }
+    }
+
+    conj.tca = 0.5 * (ta + tb);
+    conj.dist = pair_distance(s1, s2, conj.tca, &conj.relvel);
+    if (!(conj.dist <= job->threshold))
+        return;
+
+    o1 = &g_array_index(job->objs, conj_obj_t, w->objidx[i]);
+    o2 = &g_array_index(job->objs, conj_obj_t, w->objidx[j]);
+    conj.catnum1 = MIN(o1->catnum, o2->catnum);
+    conj.catnum2 = MAX(o1->catnum, o2->catnum);
+    g_array_append_val(w->result, conj);
+}
+
+/* Check a pair of propagators found in neighbouring cells */
+static void check_pair(conj_worker_t * w, guint i, guint j, gdouble t)
+{
+    conj_job_t     *job = w->job;
+    conj_obj_t     *o1, *o2;
+    gdouble         d[3], dv[3], dist, vrel, tl, dl, r, margin;
+    gdouble         lo, hi;
+    guint64         pair;
+    gpointer        res;
+    gint            k;
+
+    o1 = &g_array_index(job->objs, conj_obj_t, w->objidx[i]);
+    o2 = &g_array_index(job->objs, conj_obj_t, w->objidx[j]);
+
+    if (!o1->primary && !o2->primary)
+        return;
+
+    for (k = 0; k < 3; k++)
+    {
+        d[k] = w->pos[3 * i + k] - w->pos[3 * j + k];
+        dv[k] = w->vel[3 * i + k] - w->vel[3 * j + k];
+    }
+
+    /* can the pair come closer than the threshold within +/- step/2 */
+    dist = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    vrel = sqrt(dv[0] * dv[0] + dv[1] * dv[1] + dv[2] * dv[2]);
+    if (!(dist <= job->threshold + 0.5 * vrel * job->step))
+        return;
+
+    /* closest approach of the straight line motion; the deviation from
+       it is bounded by the tidal acceleration 3 mu d / r^3 */
+    tl = (vrel > 0.0) ? -(d[0] * dv[0] + d[1] * dv[1] + d[2] * dv[2]) /
+        (vrel * vrel) : 0.0;
+    tl = CLAMP(tl, -0.5 * job->step, 0.5 * job->step);
+    for (k = 0; k < 3; k++)
+        d[k] += dv[k] * tl;
+    dl = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    r = MIN(o1->rp, o2->rp) - CONJ_PAD;
+    margin = 1.5 * ge / (r * r * r) * dist * tl * tl + 0.1;
+    if (dl > job->threshold + margin)
+        return;
+
+    if (!apsis_filter(job, o1, o2))
+        return;
+
+    /* the plane filter only depends on the pair; cache the result */
+    pair = ((guint64) MIN(w->objidx[i], w->objidx[j]) << 32) |
+        MAX(w->objidx[i], w->objidx[j]);
+    res = g_hash_table_lookup(w->filtered, &pair);
+    if (res == NULL)
+    {
+        guint64        *key = g_new(guint64, 1);
+
+        *key = pair;
+        res = GINT_TO_POINTER(plane_filter(job, o1, o2) ? 2 : 1);
+        g_hash_table_insert(w->filtered, key, res);
+        if (res == GINT_TO_POINTER(1))
+            w->pruned_plane++;
+    }
+
+    if (res == GINT_TO_POINTER(1))
+        return;
+
+    /* a minimum further away than one step is found from the next step */
+    w->candidates++;
+    lo = MAX(t - job->step / secday, job->t0);
+    hi = MIN(t + job->step / secday, job->t1);
+    refine_tca(w, i, j, CLAMP(t + tl / secday, lo, hi), lo, hi);
+}
+
+static int grid_compare(const void *a, const void *b)
+{
+    const grid_entry_t *ea = a;
+    const grid_entry_t *eb = b;
+
+    if (ea->key < eb->key)
+        return -1;
+    if (ea->key > eb->key)
+        return 1;
+
+    return 0;
+}
+
+static guint64 grid_key(gint64 ix, gint64 iy, gint64 iz)
+{
+    return ((guint64) ((ix + GRID_BIAS) & GRID_MASK) << 42) |
+        ((guint64) ((iy + GRID_BIAS) & GRID_MASK) << 21) |
+        (guint64) ((iz + GRID_BIAS) & GRID_MASK);
+}
+
+/* First entry of the sorted grid with the given key */
+static guint grid_find(grid_entry_t * grid, guint n, guint64 key)
+{
+    guint           lo = 0;
+    guint           hi = n;
+    guint           mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (grid[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* Screen one time step */
+static void screen_step(conj_worker_t * w, gdouble t)
+{
+    conj_job_t     *job = w->job;
+    gdouble         cell;
+    gint64          ix, iy, iz;
+    guint           i, j, k, n;
+    gint            dx, dy, dz;
+    guint64         key;
+
+    /* cell size covering the threshold and the motion within the step */
+    cell = job->threshold + 0.5 * CONJ_VREL_MAX * job->step;
+
+    for (i = 0; i < w->nsats; i++)
+    {
+        propagate(&w->sats[i], t, &w->pos[3 * i], &w->vel[3 * i]);
+        w->grid[i].idx = i;
+
+        /* decayed objects give NaN; sort them to the end and skip them */
+        if (!isfinite(w->pos[3 * i]) || !isfinite(w->pos[3 * i + 1]) ||
+            !isfinite(w->pos[3 * i + 2]))
+        {
+            w->grid[i].key = G_MAXUINT64;
+            continue;
+        }
+
+        w->grid[i].key = grid_key((gint64) floor(w->pos[3 * i] / cell),
+                                  (gint64) floor(w->pos[3 * i + 1] / cell),
+                                  (gint64) floor(w->pos[3 * i + 2] / cell));
+    }
+
+    n = w->nsats;
+    qsort(w->grid, n, sizeof(grid_entry_t), grid_compare);
+
+    for (i = 0; i < n && w->grid[i].key != G_MAXUINT64; i++)
+    {
+        ix = (gint64) floor(w->pos[3 * w->grid[i].idx] / cell);
+        iy = (gint64) floor(w->pos[3 * w->grid[i].idx + 1] / cell);
+        iz = (gint64) floor(w->pos[3 * w->grid[i].idx + 2] / cell);
+
+        /* visit each pair of neighbouring cells once: the own cell
+           (later entries only) and the 13 cells with a larger key */
+        for (dx = -1; dx <= 1; dx++)
+            for (dy = -1; dy <= 1; dy++)
+                for (dz = -1; dz <= 1; dz++)
+                {
+                    key = grid_key(ix + dx, iy + dy, iz + dz);
+                    if (key < w->grid[i].key)
+                        continue;
+
+                    k = (key == w->grid[i].key) ? i + 1 :
+                        grid_find(w->grid, n, key);
+
+                    for (j = k; j < n && w->grid[j].key == key; j++)
+                        check_pair(w, w->grid[i].idx, w->grid[j].idx, t);
+                }
+    }
+}
+
+static gpointer conj_worker(gpointer data)
+{
+    conj_worker_t  *w = data;
+    conj_job_t     *job = w->job;
+    gint            s;
+    gdouble         t;
+
+    for (s = w->step0; s < w->step1; s++)
+    {
+        if (g_atomic_int_get(&job->cancel))
+            break;
+
+        t = MIN(job->t0 + s * job->step / secday, job->t1);
+        screen_step(w, t);
+        g_atomic_int_inc(&job->progress);
+    }
+
+    return NULL;
+}
+
+static gint conj_compare(gconstpointer a, gconstpointer b)
+{
+    const conj_t   *ca = a;
+    const conj_t   *cb = b;
+
+    if (ca->catnum1 != cb->catnum1)
+        return ca->catnum1 - cb->catnum1;
+    if (ca->catnum2 != cb->catnum2)
+        return ca->catnum2 - cb->catnum2;
+
+    return (ca->tca < cb->tca) ? -1 : (ca->tca > cb->tca);
+}
+
+static gint conj_compare_tca(gconstpointer a, gconstpointer b)
+{
+    const conj_t   *ca = a;
+    const conj_t   *cb = b;
+
+    return (ca->tca < cb->tca) ? -1 : (ca->tca > cb->tca);
+}
+
+/*
+ * Merge the events of the same pair found in consecutive steps or
+ * threads, keeping the closest one.
+ */
+static GArray  *merge_result(conj_job_t * job, GArray * all)
+{
+    GArray         *result;
+    conj_t         *c, *last = NULL;
+    gdouble         gap = 2.0 * job->step / secday;
+    gdouble         tlast = 0.0;
+    guint           i;
+
+    g_array_sort(all, conj_compare);
+
+    result = g_array_new(FALSE, FALSE, sizeof(conj_t));
+    for (i = 0; i < all->len; i++)
+    {
+        c = &g_array_index(all, conj_t, i);
+
+        if (last != NULL && last->catnum1 == c->catnum1 &&
+            last->catnum2 == c->catnum2 && c->tca - tlast <= gap)
+        {
+            if (c->dist < last->dist)
+                *last = *c;
+            tlast = c->tca;
+            continue;
+        }
+
+        g_array_append_val(result, *c);
+        last = &g_array_index(result, conj_t, result->len - 1);
+        tlast = c->tca;
+    }
+
+    g_array_sort(result, conj_compare_tca);
+
+    return result;
+}
+
+/* Drop secondaries that cannot approach any primary */
+static void apply_filters(conj_job_t * job)
+{
+    conj_obj_t     *obj, *prim;
+    gboolean        apsis;
+    guint           i, j;
+
+    if (job->nsec == 0)
+        return;
+
+    for (i = 0; i < job->objs->len; i++)
+    {
+        obj = &g_array_index(job->objs, conj_obj_t, i);
+        if (obj->primary)
+            continue;
+
+        obj->active = FALSE;
+        apsis = FALSE;
+        for (j = 0; j < job->objs->len && !obj->active; j++)
+        {
+            prim = &g_array_index(job->objs, conj_obj_t, j);
+            if (!prim->primary || !apsis_filter(job, obj, prim))
+                continue;
+
+            apsis = TRUE;
+            if (plane_filter(job, obj, prim))
+                obj->active = TRUE;
+        }
+
+        if (!apsis)
+            job->pruned_apsis++;
+        else if (!obj->active)
+            job->pruned_plane++;
+    }
+}
+
+/**
+ * Run the screening.
+ *
+ * @param job The screening job.
+ * @return The close approaches (conj_t) sorted by time of closest approach.
+ *
+ * This function blocks until the job is done or cancelled and may be
+ * called from a worker thread. The caller owns the returned array.
+ */
+GArray         *conj_job_run(conj_job_t * job)
+{
+    conj_worker_t  *workers;
+    GThread       **threads;
+    GArray         *all, *result;
+    conj_obj_t     *obj;
+    guint           nthreads, nactive, i, j;
+    gint64          start;
+
+    start = g_get_monotonic_time();
+
+    apply_filters(job);
+
+    nactive = 0;
+    for (i = 0; i < job->objs->len; i++)
+        if (g_array_index(job->objs, conj_obj_t, i).active)
+            nactive++;
+
+    job->steps = (gint) ceil((job->t1 - job->t0) * secday / job->step) + 1;
+    nthreads = CLAMP(g_get_num_processors(), 1, (guint) job->steps);
+
+    workers = g_new0(conj_worker_t, nthreads);
+    threads = g_new0(GThread *, nthreads);
+
+    for (i = 0; i < nthreads; i++)
+    {
+        conj_worker_t  *w = &workers[i];
+
+        w->job = job;
+        w->step0 = job->steps * i / nthreads;
+        w->step1 = job->steps * (i + 1) / nthreads;
+        w->sats = g_new(sat_t, nactive);
+        w->objidx = g_new(guint, nactive);
+        w->pos = g_new(gdouble, 3 * nactive);
+        w->vel = g_new(gdouble, 3 * nactive);
+        w->grid = g_new(grid_entry_t, nactive);
+        w->filtered = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                            g_free, NULL);
+        w->result = g_array_new(FALSE, FALSE, sizeof(conj_t));
+
+        for (j = 0; j < job->objs->len; j++)
+        {
+            obj = &g_array_index(job->objs, conj_obj_t, j);
+            if (!obj->active)
+                continue;
+
+            memcpy(&w->sats[w->nsats], &obj->sat, sizeof(sat_t));
+            w->objidx[w->nsats] = j;
+            w->nsats++;
+        }
+
+        threads[i] = g_thread_new("gpredict_conj", conj_worker, w);
+    }
+
+    all = g_array_new(FALSE, FALSE, sizeof(conj_t));
+    for (i = 0; i < nthreads; i++)
+    {
+        g_thread_join(threads[i]);
+
+        g_array_append_vals(all, workers[i].result->data,
+                            workers[i].result->len);
+        job->pruned_plane += workers[i].pruned_plane;
+        job->candidates += workers[i].candidates;
+
+        g_free(workers[i].sats);
+        g_free(workers[i].objidx);
+        g_free(workers[i].pos);
+        g_free(workers[i].vel);
+        g_free(workers[i].grid);
+        g_hash_table_destroy(workers[i].filtered);
+        g_array_free(workers[i].result, TRUE);
+    }
+
+    result = merge_result(job, all);
+    g_array_free(all, TRUE);
+    g_free(workers);
+    g_free(threads);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Screened %d objects (%d rejected by apsis filter, "
+                  "%d by plane filter) over %d steps in %.1f s using "
+                  "%d threads: %d candidates, %d approaches"),
+                __func__, job->objs->len, job->pruned_apsis,
+                job->pruned_plane, job->steps,
+                (g_get_monotonic_time() - start) / 1.0e6, nthreads,
+                job->candidates, result->len);
+
+    return result;
+}
@@ -0,0 +1,61 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef CONJ_SCREEN_H
+#define CONJ_SCREEN_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+/** A close approach between two objects. */
+typedef struct {
+    gint            catnum1;    /*!< Catalogue number of the first object */
+    gint            catnum2;    /*!< Catalogue number of the second object */
+    gdouble         tca;        /*!< Time of closest approach (Julian date) */
+    gdouble         dist;       /*!< Miss distance [km] */
+    gdouble         relvel;     /*!< Relative velocity at TCA [km/sec] */
+} conj_t;
+
+/** Conjunction screening job. */
+typedef struct {
+    gdouble         t0;         /*!< Start of the time window */
+    gdouble         t1;         /*!< End of the time window */
+    gdouble         threshold;  /*!< Miss distance threshold [km] */
+    gdouble         step;       /*!< Sieve time step [sec] */
+    GArray         *objs;       /*!< The objects (conj_obj_t, private) */
+    GHashTable     *names;      /*!< catnum -> nickname */
+    gint            nsec;       /*!< Number of secondary objects */
+    gint            steps;      /*!< Total number of time steps */
+    gint            progress;   /*!< Time steps done (atomic) */
+    gint            cancel;     /*!< Set to 1 to stop the job (atomic) */
+    guint           pruned_apsis;       /*!< Objects rejected by apsis filter */
+    guint           pruned_plane;       /*!< Objects and pairs rejected by
+                                             plane filter */
+    guint           candidates; /*!< Pairs sent to TCA refinement */
+} conj_job_t;
+
+conj_job_t     *conj_job_new(gdouble t0, gdouble t1, gdouble threshold);
+void            conj_job_free(conj_job_t * job);
+void            conj_job_add_sat(conj_job_t * job, sat_t * sat,
+                                 gboolean primary);
+GArray         *conj_job_run(conj_job_t * job);
+void            conj_job_cancel(conj_job_t * job);
+gdouble         conj_job_get_progress(conj_job_t * job);
+const gchar    *conj_job_get_name(conj_job_t * job, gint catnum);
+
+#endif
@@ -0,0 +1,429 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Coverage analysis dialog.
+ *
+ * Runs a ground coverage analysis of a satellite group (.cat file) in a
+ * background thread, shows the selected statistics as an overlay on the
+ * map of the module and exports the grid to a file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <math.h>
+
+#include "compat.h"
+#include "cov-dialog.h"
+#include "cov-grid.h"
+#include "gpredict-utils.h"
+#include "gtk-sat-map.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+
+/* grid resolution [deg] */
+#define COV_RES 1.0
+
+/* opacity of the map overlay */
+#define COV_ALPHA 0x90
+
+/* refresh interval of the progress bar [msec] */
+#define COV_PROGRESS_REFRESH 250
+
+enum {
+    COV_RESPONSE_RUN = 1,
+    COV_RESPONSE_EXPORT
+};
+
+static const gchar *COV_STAT_NAME[COV_STAT_NUM] = {
+    N_("Time covered"),
+    N_("Longest revisit gap"),
+    N_("Satellites in view")
+};
+
+typedef struct {
+    GtkWidget      *dialog;
+    GtkWidget      *group;
+    GtkWidget      *minel;
+    GtkWidget      *hours;
+    GtkWidget      *show;
+    GtkWidget      *progress;
+    GtkWidget      *summary;
+    GtkWidget      *satmap;     /* weak pointer, may be NULL */
+    gdouble         t0;
+    gchar          *catfile;
+    cov_job_t      *job;
+    GThread        *thread;
+    gboolean        valid;      /* job holds a complete result */
+    gint            done;
+    guint           timerid;
+} cov_dlg_t;
+
+
+static gpointer cov_thread(gpointer data)
+{
+    cov_dlg_t      *dlg = data;
+
+    if (cov_job_load_cat(dlg->job, dlg->catfile) > 0)
+        dlg->valid = cov_job_run(dlg->job);
+
+    g_atomic_int_set(&dlg->done, 1);
+
+    return NULL;
+}
+
+/* Map a value between 0 and 1 to a blue - green - red colour scale */
+static void heat_colour(gdouble v, guchar * p)
+{
+    v = CLAMP(v, 0.0, 1.0);
+    p[0] = (guchar) (255 * CLAMP(1.5 - fabs(4.0 * v - 3.0), 0.0, 1.0));
+    p[1] = (guchar) (255 * CLAMP(1.5 - fabs(4.0 * v - 2.0), 0.0, 1.0));
+    p[2] = (guchar) (255 * CLAMP(1.5 - fabs(4.0 * v - 1.0), 0.0, 1.0));
+    p[3] = COV_ALPHA;
+}
+
+/* Show the selected statistics on the map */
+static void update_overlay(cov_dlg_t * dlg)
+{
+    GdkPixbuf      *pixbuf;
+    guchar         *pixels;
+    gfloat         *stat;
+    gdouble         scale;
+    gint            rowstride;
+    guint           i, j, s;
+
+    if (dlg->satmap == NULL)
+        return;
+
+    if (!dlg->valid)
+    {
+        gtk_sat_map_set_overlay(GTK_SAT_MAP(dlg->satmap), NULL);
+        return;
+    }
+
+    s = gtk_combo_box_get_active(GTK_COMBO_BOX(dlg->show));
+    stat = dlg->job->stat[s];
+    scale = (s == COV_STAT_COVERED) ? 1.0 : dlg->job->max[s];
+    if (scale <= 0.0)
+        scale = 1.0;
+
+    pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8,
+                            dlg->job->nlon, dlg->job->nlat);
+    pixels = gdk_pixbuf_get_pixels(pixbuf);
+    rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+
+    for (i = 0; i < dlg->job->nlat; i++)
+        for (j = 0; j < dlg->job->nlon; j++)
+            heat_colour(stat[i * dlg->job->nlon + j] / scale,
+                        &pixels[i * rowstride + 4 * j]);
+
+    gtk_sat_map_set_overlay(GTK_SAT_MAP(dlg->satmap), pixbuf);
+    g_object_unref(pixbuf);
+}
+
+static void show_summary(cov_dlg_t * dlg)
+{
+    cov_job_t      *job = dlg->job;
+    gchar          *buff;
+
+    if (!dlg->valid)
+    {
+        gtk_label_set_text(GTK_LABEL(dlg->summary),
+                           _("No satellites could be loaded from the group."));
+        return;
+    }
+
+    buff = g_strdup_printf(_("%s: %d satellites, %.1f%% of the time covered, "
+                             "revisit gap %.0f min (max %.0f min), "
+                             "%.2f satellites in view (max %.2f)"),
+                           job->name, job->sats->len,
+                           100.0 * job->mean[COV_STAT_COVERED],
+                           job->mean[COV_STAT_MAX_GAP] / 60.0,
+                           job->max[COV_STAT_MAX_GAP] / 60.0,
+                           job->mean[COV_STAT_IN_VIEW],
+                           job->max[COV_STAT_IN_VIEW]);
+    gtk_label_set_text(GTK_LABEL(dlg->summary), buff);
+    g_free(buff);
+}
+
+static gboolean progress_update(gpointer data)
+{
+    cov_dlg_t      *dlg = data;
+
+    if (!g_atomic_int_get(&dlg->done))
+    {
+        if (dlg->job->steps == 0)
+            gtk_progress_bar_pulse(GTK_PROGRESS_BAR(dlg->progress));
+        else
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(dlg->progress),
+                                          cov_job_get_progress(dlg->job));
+
+        return TRUE;
+    }
+
+    g_thread_join(dlg->thread);
+    dlg->thread = NULL;
+    dlg->timerid = 0;
+
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(dlg->progress), 1.0);
+    show_summary(dlg);
+    update_overlay(dlg);
+
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      COV_RESPONSE_RUN, TRUE);
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      COV_RESPONSE_EXPORT, dlg->valid);
+
+    return FALSE;
+}
+
+static void start_job(cov_dlg_t * dlg)
+{
+    gint            minel, hours;
+
+    minel = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(dlg->minel));
+    hours = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(dlg->hours));
+    sat_cfg_set_int(SAT_CFG_INT_COV_MIN_EL, minel);
+    sat_cfg_set_int(SAT_CFG_INT_COV_WINDOW, hours);
+
+    g_free(dlg->catfile);
+    dlg->catfile = g_strdup(gtk_combo_box_get_active_id
+                            (GTK_COMBO_BOX(dlg->group)));
+    if (dlg->catfile == NULL)
+        return;
+
+    cov_job_free(dlg->job);
+    dlg->job = cov_job_new(dlg->t0, dlg->t0 + hours / 24.0, minel, COV_RES);
+    dlg->valid = FALSE;
+    dlg->done = 0;
+
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      COV_RESPONSE_RUN, FALSE);
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      COV_RESPONSE_EXPORT, FALSE);
+    gtk_label_set_text(GTK_LABEL(dlg->summary), _("Computing..."));
+
+    dlg->thread = g_thread_new("gpredict_cov_dlg", cov_thread, dlg);
+    dlg->timerid = g_timeout_add(COV_PROGRESS_REFRESH, progress_update, dlg);
+}
+
+static void export_result(cov_dlg_t * dlg)
+{
+    GtkWidget      *chooser;
+    GtkWidget      *msg;
+    gchar          *fname;
+
+    chooser = gtk_file_chooser_dialog_new(_("Export Coverage"),
+                                          GTK_WINDOW(dlg->dialog),
+                                          GTK_FILE_CHOOSER_ACTION_SAVE,
+                                          "_Cancel", GTK_RESPONSE_CANCEL,
+                                          "_Save", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(chooser),
+                                                   TRUE);
+    fname = g_strdup_printf("%s-coverage.csv", dlg->job->name);
+    g_strdelimit(fname, " /\\", '_');
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(chooser), fname);
+    g_free(fname);
+
+    if (gtk_dialog_run(GTK_DIALOG(chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        fname = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(chooser));
+        if (cov_job_export(dlg->job, fname))
+        {
+            msg = gtk_message_dialog_new(GTK_WINDOW(dlg->dialog),
+                                         GTK_DIALOG_MODAL |
+                                         GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         GTK_MESSAGE_ERROR,
+                                         GTK_BUTTONS_CLOSE,
+                                         _("Could not write %s"), fname);
+            gtk_dialog_run(GTK_DIALOG(msg));
+            gtk_widget_destroy(msg);
+        }
+        g_free(fname);
+    }
+
+    gtk_widget_destroy(chooser);
+}
+
+static void cov_dialog_response(GtkWidget * dialog, gint response,
+                                gpointer data)
+{
+    cov_dlg_t      *dlg = data;
+
+    switch (response)
+    {
+    case COV_RESPONSE_RUN:
+        if (dlg->thread == NULL)
+            start_job(dlg);
+        break;
+
+    case COV_RESPONSE_EXPORT:
+        if (dlg->valid)
+            export_result(dlg);
+        break;
+
+    default:
+        gtk_widget_destroy(dialog);
+        break;
+    }
+}
+
+static void show_changed(GtkComboBox * combo, gpointer data)
+{
+    (void)combo;
+
+    update_overlay(data);
+}
+
+static void cov_dialog_destroy(GtkWidget * dialog, gpointer data)
+{
+    cov_dlg_t      *dlg = data;
+
+    (void)dialog;
+
+    if (dlg->timerid > 0)
+        g_source_remove(dlg->timerid);
+
+    if (dlg->thread != NULL)
+    {
+        cov_job_cancel(dlg->job);
+        g_thread_join(dlg->thread);
+    }
+
+    if (dlg->satmap != NULL)
+    {
+        gtk_sat_map_set_overlay(GTK_SAT_MAP(dlg->satmap), NULL);
+        g_object_remove_weak_pointer(G_OBJECT(dlg->satmap),
+                                     (gpointer *) &dlg->satmap);
+    }
+
+    cov_job_free(dlg->job);
+    g_free(dlg->catfile);
+    g_free(dlg);
+}
+
+static GtkWidget *add_row(GtkWidget * grid, const gchar * text,
+                          GtkWidget * widget, gint row)
+{
+    GtkWidget      *label;
+
+    label = gtk_label_new(text);
+    g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, row, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), widget, 1, row, 1, 1);
+
+    return widget;
+}
+
+/**
+ * Show the coverage analysis dialog.
+ *
+ * @param name The name of the module, used in the title.
+ * @param satmap The map of the module where the results are shown, or NULL.
+ * @param t0 The start of the analysis window.
+ * @param toplevel The parent window.
+ *
+ * The satellite group is selected in the dialog. The minimum elevation
+ * and the window length default to SAT_CFG_INT_COV_MIN_EL and
+ * SAT_CFG_INT_COV_WINDOW. The map overlay is removed when the dialog is
+ * closed.
+ */
+void cov_dialog_show(const gchar * name, GtkWidget * satmap, gdouble t0,
+                     GtkWidget * toplevel)
+{
+    cov_dlg_t      *dlg;
+    GtkWidget      *grid, *vbox;
+    gchar          *title;
+    gchar          *buff;
+    guint           i;
+
+    dlg = g_new0(cov_dlg_t, 1);
+    dlg->t0 = t0;
+    dlg->satmap = satmap;
+    if (satmap != NULL)
+        g_object_add_weak_pointer(G_OBJECT(satmap), (gpointer *) &dlg->satmap);
+
+    grid = gtk_grid_new();
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 10);
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 5);
+
+    dlg->group = add_row(grid, _("Satellite group"),
+                         gtk_combo_box_text_new(), 0);
+    gpredict_load_cat_groups(dlg->group);
+
+    dlg->minel = add_row(grid, _("Minimum elevation [deg]"),
+                         gtk_spin_button_new_with_range(0, 80, 1), 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(dlg->minel),
+                              sat_cfg_get_int(SAT_CFG_INT_COV_MIN_EL));
+
+    dlg->hours = add_row(grid, _("Time span [hours]"),
+                         gtk_spin_button_new_with_range(1, 240, 1), 2);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(dlg->hours),
+                              sat_cfg_get_int(SAT_CFG_INT_COV_WINDOW));
+
+    dlg->show = add_row(grid, _("Show on map"),
+                        gtk_combo_box_text_new(), 3);
+    for (i = 0; i < COV_STAT_NUM; i++)
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(dlg->show),
+                                       _(COV_STAT_NAME[i]));
+    gtk_combo_box_set_active(GTK_COMBO_BOX(dlg->show), COV_STAT_COVERED);
+    gtk_widget_set_sensitive(dlg->show, satmap != NULL);
+    g_signal_connect(dlg->show, "changed", G_CALLBACK(show_changed), dlg);
+
+    dlg->progress = gtk_progress_bar_new();
+    dlg->summary = gtk_label_new(satmap != NULL ? "" :
+                                 _("The module has no map view."));
+    gtk_label_set_line_wrap(GTK_LABEL(dlg->summary), TRUE);
+    gtk_label_set_max_width_chars(GTK_LABEL(dlg->summary), 50);
+
+    title = g_strdup_printf(_("Coverage analysis for %s"), name);
+    dlg->dialog = gtk_dialog_new_with_buttons(title,
+                                              GTK_WINDOW(toplevel),
+                                              GTK_DIALOG_DESTROY_WITH_PARENT,
+                                              _("_Export"),
+                                              COV_RESPONSE_EXPORT,
+                                              _("C_ompute"), COV_RESPONSE_RUN,
+                                              "_Close", GTK_RESPONSE_CLOSE,
+                                              NULL);
+    g_free(title);
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      COV_RESPONSE_EXPORT, FALSE);
+
+    buff = icon_file_name("gpredict-icon.png");
+    gtk_window_set_icon_from_file(GTK_WINDOW(dlg->dialog), buff, NULL);
+    g_free(buff);
+
+    g_signal_connect(dlg->dialog, "response",
+                     G_CALLBACK(cov_dialog_response), dlg);
+    g_signal_connect(dlg->dialog, "destroy",
+                     G_CALLBACK(cov_dialog_destroy), dlg);
+
+    vbox = gtk_dialog_get_content_area(GTK_DIALOG(dlg->dialog));
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 10);
+    gtk_box_set_spacing(GTK_BOX(vbox), 5);
+    gtk_box_pack_start(GTK_BOX(vbox), grid, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), dlg->progress, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), dlg->summary, FALSE, FALSE, 0);
+
+    gtk_widget_show_all(dlg->dialog);
+}
@@ -0,0 +1,539 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Constellation ground coverage analysis.
+ *
+ * A group of satellites is propagated over a time window and at each time
+ * step the coverage area of every satellite, i.e. the part of the Earth
+ * where it is above the minimum elevation, is rasterised into a lat/lon
+ * grid. For each grid cell the job accumulates the fraction of time with
+ * at least one satellite in view, the longest revisit gap and the average
+ * number of satellites in view.
+ *
+ * The coverage area is rasterised one grid row at a time: the half width
+ * in longitude of the spherical cap at the latitude of the row follows
+ * from the spherical law of cosines, so only the covered cells are
+ * touched.
+ *
+ * The time window is split into slices that are processed in parallel,
+ * each thread working on its own copy of the propagators. The revisit gaps
+ * of the slices are joined afterwards using the uncovered time at the
+ * beginning and at the end of each slice.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <string.h>
+
+#include "compat.h"
+#include "cov-grid.h"
+#include "gtk-sat-data.h"
+#include "sat-log.h"
+
+
+/* default time step [sec] */
+#define COV_STEP            60.0
+
+/* state of one worker thread */
+typedef struct {
+    cov_job_t      *job;
+    gint            step0;      /* first time step of the slice */
+    gint            step1;      /* last time step of the slice (excl) */
+    sat_t          *sats;       /* propagators */
+    guint           nsats;
+    guint16        *count;      /* satellites in view at the current step */
+    guint32        *covered;    /* number of covered steps */
+    guint32        *inview;     /* sum of satellites in view */
+    guint32        *lead;       /* uncovered steps before the first covered */
+    guint32        *run;        /* current run of uncovered steps */
+    guint32        *gap;        /* longest run between two covered steps */
+} cov_worker_t;
+
+
+/**
+ * Create a new coverage job.
+ *
+ * @param t0 The start of the time window.
+ * @param t1 The end of the time window.
+ * @param min_el The minimum elevation [deg].
+ * @param res The grid resolution [deg].
+ * @return A new job, which should be freed with cov_job_free().
+ */
+cov_job_t      *cov_job_new(gdouble t0, gdouble t1, gdouble min_el,
+                            gdouble res)
+{
+    cov_job_t      *job;
+    guint           i;
+
+    job = g_new0(cov_job_t, 1);
+    job->t0 = t0;
+    job->t1 = t1;
+    job->step = COV_STEP;
+    job->min_el = min_el;
+    job->nlat = MAX((guint) ceil(180.0 / res), 1);
+    job->nlon = 2 * job->nlat;
+    job->res = 180.0 / job->nlat;
+    job->sats = g_array_new(FALSE, FALSE, sizeof(sat_t));
+    g_array_set_clear_func(job->sats, (GDestroyNotify) Sat_Release);
+
+    for (i = 0; i < COV_STAT_NUM; i++)
+        job->stat[i] = g_new0(gfloat, job->nlat * job->nlon);
+
+    return job;
+}
+
+void cov_job_free(cov_job_t * job)
+{
+    guint           i;
+
+    if (job == NULL)
+        return;
+
+    for (i = 0; i < COV_STAT_NUM; i++)
+        g_free(job->stat[i]);
+
+    g_array_free(job->sats, TRUE);
+    g_free(job->name);
+    g_free(job);
+}
+
+/**
+ * Add a satellite to the job.
+ *
+ * @param job The coverage job.
+ * @param sat The satellite, initialised with gtk_sat_data_read_sat().
+ *
+ * The satellite data is copied.
+ */
+void cov_job_add_sat(cov_job_t * job, sat_t * sat)
+{
+    sat_t           copy;
+
+    Sat_Copy(&copy, sat);
+    copy.name = NULL;
+    copy.nickname = NULL;
+    copy.website = NULL;
+    copy.flags &= DEEP_SPACE_EPHEM_FLAG;
+
+    g_array_append_val(job->sats, copy);
+}
+
+/**
+ * Add the satellites of a group to the job.
+ *
+ * @param job The coverage job.
+ * @param catfile The name of the .cat file in the satdata directory.
+ * @return The number of satellites added.
+ *
+ * The group name in the first line of the file is used as job name.
+ */
+gint cov_job_load_cat(cov_job_t * job, const gchar * catfile)
+{
+    GIOChannel     *chan;
+    GError         *error = NULL;
+    gchar          *path;
+    gchar          *buff;
+    sat_t           sat;
+    gint            num = 0;
+
+    path = sat_file_name(catfile);
+    chan = g_io_channel_new_file(path, "r", &error);
+    g_free(path);
+
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open %s: %s"),
+                    __func__, catfile, error->message);
+        g_clear_error(&error);
+        return 0;
+    }
+
+    /* group name then one catalogue number per line */
+    if (g_io_channel_read_line(chan, &buff, NULL, NULL, NULL) ==
+        G_IO_STATUS_NORMAL)
+    {
+        g_free(job->name);
+        job->name = g_strstrip(buff);
+
+        while (g_io_channel_read_line(chan, &buff, NULL, NULL, NULL) ==
+               G_IO_STATUS_NORMAL)
+        {
+            memset(&sat, 0, sizeof(sat_t));
+            if (!gtk_sat_data_read_sat((gint) g_ascii_strtoll(buff, NULL, 0),
+                                       &sat))
+            {
+                cov_job_add_sat(job, &sat);
+                num++;
+            }
+
+            gtk_sat_data_clear_sat(&sat);
+            g_free(buff);
+        }
+    }
+
+    g_io_channel_shutdown(chan, FALSE, NULL);
+    g_io_channel_unref(chan);
+
+    return num;
+}
+
+/** Stop a running job. */
+void cov_job_cancel(cov_job_t * job)
+{
+    g_atomic_int_set(&job->cancel, 1);
+}
+
+/** Get the progress of a running job (0.0 - 1.0). */
+gdouble cov_job_get_progress(cov_job_t * job)
+{
+    if (job->steps == 0)
+        return 0.0;
+
+    return (gdouble) g_atomic_int_get(&job->progress) / job->steps;
+}
+
+/* Latitude of the centre of a grid row [rad] */
+static gdouble row_lat(cov_job_t * job, guint i)
+{
+    return (90.0 - (i + 0.5) * job->res) * de2ra;
+}
+
+/* Add the coverage area of a satellite to the current step */
+static void rasterize(cov_worker_t * w, sat_t * sat, gdouble t)
+{
+    cov_job_t      *job = w->job;
+    geodetic_t      geo;
+    gdouble         el, cap, c, dlon, phi, res;
+    gint            i, i0, i1, j, j0, j1, nlon;
+    guint16        *row;
+
+    sat->jul_utc = t;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4(sat, sat->tsince);
+    else
+        SGP4(sat, sat->tsince);
+
+    Convert_Sat_State(&sat->pos, &sat->vel);
+
+    /* decayed or otherwise broken orbits */
+    if (isnan(sat->pos.x) || isnan(sat->pos.y) || isnan(sat->pos.z))
+        return;
+
+    Calculate_LatLonAlt(t, &sat->pos, &geo);
+    if (!(geo.alt > 0.0))
+        return;
+
+    /* Earth central angle of the coverage area */
+    el = job->min_el * de2ra;
+    cap = acos(xkmper * cos(el) / (xkmper + geo.alt)) - el;
+    if (!(cap > 0.0))
+        return;
+
+    if (geo.lon > pi)
+        geo.lon -= twopi;
+
+    res = job->res * de2ra;
+    nlon = (gint) job->nlon;
+    i0 = MAX((gint) floor((pio2 - geo.lat - cap) / res), 0);
+    i1 = MIN((gint) floor((pio2 - geo.lat + cap) / res), (gint) job->nlat - 1);
+
+    for (i = i0; i <= i1; i++)
+    {
+        phi = row_lat(job, i);
+        if (fabs(phi - geo.lat) > cap)
+            continue;
+
+        row = &w->count[i * nlon];
+
+        /* cos(dlon) limit for cells within cap of the sub-satellite point */
+        c = cos(phi) * cos(geo.lat);
+        c = (c > 1.0e-12) ? (cos(cap) - sin(phi) * sin(geo.lat)) / c : -1.0;
+
+        if (c <= -1.0)
+        {
+            for (j = 0; j < nlon; j++)
+                row[j]++;
+            continue;
+        }
+        if (c >= 1.0)
+            continue;
+
+        dlon = acos(c);
+        j0 = (gint) ceil((geo.lon - dlon + pi) / res - 0.5);
+        j1 = (gint) floor((geo.lon + dlon + pi) / res - 0.5);
+
+        if (j1 - j0 + 1 >= nlon)
+        {
+            for (j = 0; j < nlon; j++)
+                row[j]++;
+            continue;
+        }
+
+        for (j = j0; j <= j1; j++)
+            row[(j % nlon + nlon) % nlon]++;
+    }
+}
+
+static void cov_step(cov_worker_t * w, gdouble t)
+{
+    guint           ncells = w->job->nlat * w->job->nlon;
+    guint           k;
+
+    memset(w->count, 0, ncells * sizeof(guint16));
+
+    for (k = 0; k < w->nsats; k++)
+        rasterize(w, &w->sats[k], t);
+
+    for (k = 0; k < ncells; k++)
+    {
+        w->inview[k] += w->count[k];
+
+        if (w->count[k] == 0)
+        {
+            w->run[k]++;
+        }
+        else
+        {
+            if (w->covered[k] == 0)
+                w->lead[k] = w->run[k];
+            else if (w->run[k] > w->gap[k])
+                w->gap[k] = w->run[k];
+
+            w->covered[k]++;
+            w->run[k] = 0;
+        }
+    }
+}
+
+static gpointer cov_worker(gpointer data)
+{
+    cov_worker_t   *w = data;
+    cov_job_t      *job = w->job;
+    gint            s;
+
+    for (s = w->step0; s < w->step1; s++)
+    {
+        if (g_atomic_int_get(&job->cancel))
+            break;
+
+        cov_step(w, job->t0 + s * job->step / secday);
+        g_atomic_int_inc(&job->progress);
+    }
+
+    return NULL;
+}
+
+/* Join the slices in time order and compute the final statistics */
+static void merge_result(cov_job_t * job, cov_worker_t * workers,
+                         guint nworkers)
+{
+    cov_worker_t   *w;
+    guint           ncells = job->nlat * job->nlon;
+    guint32         covered, inview, carry, gap;
+    gdouble         weight, wsum = 0.0;
+    gfloat          value;
+    guint           i, k, s;
+
+    memset(job->mean, 0, sizeof(job->mean));
+    memset(job->max, 0, sizeof(job->max));
+
+    for (k = 0; k < ncells; k++)
+    {
+        covered = inview = carry = gap = 0;
+
+        for (i = 0; i < nworkers; i++)
+        {
+            w = &workers[i];
+            covered += w->covered[k];
+            inview += w->inview[k];
+
+            if (w->covered[k] == 0)
+            {
+                carry += w->run[k];
+            }
+            else
+            {
+                gap = MAX(gap, MAX(carry + w->lead[k], w->gap[k]));
+                carry = w->run[k];
+            }
+        }
+        gap = MAX(gap, carry);
+
+        job->stat[COV_STAT_COVERED][k] = (gfloat) covered / job->steps;
+        job->stat[COV_STAT_MAX_GAP][k] = gap * job->step;
+        job->stat[COV_STAT_IN_VIEW][k] = (gfloat) inview / job->steps;
+
+        /* cell area is proportional to the cosine of the latitude */
+        weight = cos(row_lat(job, k / job->nlon));
+        wsum += weight;
+
+        for (s = 0; s < COV_STAT_NUM; s++)
+        {
+            value = job->stat[s][k];
+            job->mean[s] += weight * value;
+            if (value > job->max[s])
+                job->max[s] = value;
+        }
+    }
+
+    for (s = 0; s < COV_STAT_NUM; s++)
+        job->mean[s] /= wsum;
+}
+
+/**
+ * Run the coverage analysis.
+ *
+ * @param job The coverage job.
+ * @return TRUE if the job completed, FALSE if it was cancelled.
+ *
+ * This function blocks until the job is done or cancelled and may be
+ * called from a worker thread. The results are left in job->stat.
+ */
+gboolean cov_job_run(cov_job_t * job)
+{
+    cov_worker_t   *workers;
+    GThread       **threads;
+    guint           ncells = job->nlat * job->nlon;
+    guint           nthreads, i;
+    gint64          start;
+    gboolean        done;
+
+    start = g_get_monotonic_time();
+
+    job->steps = (gint) floor((job->t1 - job->t0) * secday / job->step) + 1;
+    nthreads = CLAMP(g_get_num_processors(), 1, (guint) job->steps);
+
+    workers = g_new0(cov_worker_t, nthreads);
+    threads = g_new0(GThread *, nthreads);
+
+    for (i = 0; i < nthreads; i++)
+    {
+        cov_worker_t   *w = &workers[i];
+
+        w->job = job;
+        w->step0 = job->steps * i / nthreads;
+        w->step1 = job->steps * (i + 1) / nthreads;
+        w->nsats = job->sats->len;
+        w->sats = g_memdup(job->sats->data, w->nsats * sizeof(sat_t));
+        w->count = g_new(guint16, ncells);
+        w->covered = g_new0(guint32, ncells);
+        w->inview = g_new0(guint32, ncells);
+        w->lead = g_new0(guint32, ncells);
+        w->run = g_new0(guint32, ncells);
+        w->gap = g_new0(guint32, ncells);
+
+        threads[i] = g_thread_new("gpredict_cov", cov_worker, w);
+    }
+
+    for (i = 0; i < nthreads; i++)
+        g_thread_join(threads[i]);
+
+    done = !g_atomic_int_get(&job->cancel);
+    if (done)
+        merge_result(job, workers, nthreads);
+
+    for (i = 0; i < nthreads; i++)
+    {
+        g_free(workers[i].sats);
+        g_free(workers[i].count);
+        g_free(workers[i].covered);
+        g_free(workers[i].inview);
+        g_free(workers[i].lead);
+        g_free(workers[i].run);
+        g_free(workers[i].gap);
+    }
+    g_free(workers);
+    g_free(threads);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Coverage of %d satellites on a %dx%d grid over %d "
+                  "steps in %.1f s using %d threads"),
+                __func__, job->sats->len, job->nlon, job->nlat, job->steps,
+                (g_get_monotonic_time() - start) / 1.0e6, nthreads);
+
+    return done;
+}
+
+/**
+ * Export the results as comma separated values.
+ *
+ * @param job The coverage job, after cov_job_run().
+ * @param fname The name of the file.
+ * @return 0 if the file was written, -1 otherwise.
+ *
+ * One line per grid cell with the latitude and longitude of the cell
+ * centre, the time covered in percent, the longest revisit gap in minutes
+ * and the average number of satellites in view.
+ */
+gint cov_job_export(cov_job_t * job, const gchar * fname)
+{
+    GString        *data;
+    GError         *error = NULL;
+    gchar           lat[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar           lon[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar           val[3][G_ASCII_DTOSTR_BUF_SIZE];
+    guint           i, j, k;
+    gint            retcode = 0;
+
+    data = g_string_new(NULL);
+    g_string_append_printf(data, "# %s, minimum elevation %.1f deg\n",
+                           job->name ? job->name : "", job->min_el);
+    g_string_append(data, "lat,lon,covered_pct,max_gap_min,avg_in_view\n");
+
+    for (i = 0; i < job->nlat; i++)
+    {
+        g_ascii_formatd(lat, sizeof(lat), "%.3f", 90.0 - (i + 0.5) * job->res);
+
+        for (j = 0; j < job->nlon; j++)
+        {
+            k = i * job->nlon + j;
+            g_ascii_formatd(lon, sizeof(lon), "%.3f",
+                            -180.0 + (j + 0.5) * job->res);
+            g_ascii_formatd(val[0], sizeof(val[0]), "%.2f",
+                            100.0 * job->stat[COV_STAT_COVERED][k]);
+            g_ascii_formatd(val[1], sizeof(val[1]), "%.1f",
+                            job->stat[COV_STAT_MAX_GAP][k] / 60.0);
+            g_ascii_formatd(val[2], sizeof(val[2]), "%.3f",
+                            job->stat[COV_STAT_IN_VIEW][k]);
+            g_string_append_printf(data, "%s,%s,%s,%s,%s\n",
+                                   lat, lon, val[0], val[1], val[2]);
+        }
+    }
+
+    if (!g_file_set_contents(fname, data->str, data->len, &error))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not write %s (%s)"),
+                    __func__, fname, error->message);
+        g_clear_error(&error);
+        retcode = -1;
+    }
+
+    g_string_free(data, TRUE);
+
+    return retcode;
+}
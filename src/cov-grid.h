@@ -0,0 +1,62 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef COV_GRID_H
+#define COV_GRID_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+/** Coverage statistics computed for each grid cell. */
+typedef enum {
+    COV_STAT_COVERED = 0,       /*!< Fraction of time covered (0.0 - 1.0) */
+    COV_STAT_MAX_GAP,           /*!< Longest revisit gap [sec] */
+    COV_STAT_IN_VIEW,           /*!< Average number of satellites in view */
+    COV_STAT_NUM
+} cov_stat_t;
+
+/** Coverage analysis job. */
+typedef struct {
+    gdouble         t0;         /*!< Start of the time window */
+    gdouble         t1;         /*!< End of the time window */
+    gdouble         step;       /*!< Time step [sec] */
+    gdouble         min_el;     /*!< Minimum elevation [deg] */
+    gdouble         res;        /*!< Grid resolution [deg] */
+    guint           nlat;       /*!< Number of grid rows, row 0 is north */
+    guint           nlon;       /*!< Number of grid columns, column 0 is -180 */
+    gchar          *name;       /*!< Name of the satellite group */
+    GArray         *sats;       /*!< The satellites (sat_t) */
+    gfloat         *stat[COV_STAT_NUM];    /*!< Results, nlat * nlon each */
+    gdouble         mean[COV_STAT_NUM];    /*!< Area weighted mean of results */
+    gdouble         max[COV_STAT_NUM];     /*!< Largest value of results */
+    gint            steps;      /*!< Total number of time steps */
+    gint            progress;   /*!< Time steps done (atomic) */
+    gint            cancel;     /*!< Set to 1 to stop the job (atomic) */
+} cov_job_t;
+
+cov_job_t      *cov_job_new(gdouble t0, gdouble t1, gdouble min_el,
+                            gdouble res);
+void            cov_job_free(cov_job_t * job);
+void            cov_job_add_sat(cov_job_t * job, sat_t * sat);
+gint            cov_job_load_cat(cov_job_t * job, const gchar * catfile);
+gboolean        cov_job_run(cov_job_t * job);
+void            cov_job_cancel(cov_job_t * job);
+gdouble         cov_job_get_progress(cov_job_t * job);
+gint            cov_job_export(cov_job_t * job, const gchar * fname);
+
+#endif
@@ -0,0 +1,200 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Microbenchmark for the ephemeris cache.
+ *
+ * Each satellite in the TLE file (default sgpsdp/test-004.tle) is queried
+ * in one second steps starting half a day after epoch, once with the
+ * propagator and once from a cache with the default error bound, which is
+ * what the rotator controller does. The cache is filled before the timed
+ * queries. The best time of several repeats is used and the results are
+ * printed as JSON like those of sgpsdp-bench.
+ *
+ * Usage: ephem-bench [tlefile [queries [repeats]]]
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ephem-cache.h"
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+#define DEF_QUERIES     100000
+#define DEF_REPEATS     5
+#define QUERY_STEP      (1.0 / 86400.0)         /* days */
+
+/* the main window used by other parts of gpredict */
+GtkWidget      *app = NULL;
+
+/* Time the queries; uses the cache if there is one, the propagator if not */
+static gdouble bench_sat(sat_t * sat, ephem_cache_t * cache, qth_t * qth,
+                         gdouble t0, gint queries, gint repeats)
+{
+    sat_t           copy;
+    clock_t         start;
+    gdouble         secs, best = -1.0;
+    gint            i, j;
+
+    Sat_Copy(&copy, sat);
+    for (j = 0; j < repeats; j++)
+    {
+        start = clock();
+        for (i = 0; i < queries; i++)
+        {
+            if (cache)
+                ephem_cache_calc(cache, &copy, qth, t0 + i * QUERY_STEP);
+            else
+                predict_calc(&copy, qth, t0 + i * QUERY_STEP);
+        }
+        secs = (gdouble) (clock() - start) / CLOCKS_PER_SEC;
+
+        if (best < 0.0 || secs < best)
+            best = secs;
+    }
+    Sat_Release(&copy);
+
+    return best;
+}
+
+static void print_name(const gchar * name)
+{
+    putchar('"');
+    for (; *name; name++)
+    {
+        if (*name == '"' || *name == '\\')
+            putchar('\\');
+        putchar(*name);
+    }
+    putchar('"');
+}
+
+int main(int argc, char *argv[])
+{
+    FILE           *fp;
+    ephem_cache_t  *cache;
+    gchar          *confdir;
+    gchar          *fname;
+    gchar           tle_str[3][80];
+    sat_t           sat;
+    qth_t           qth;
+    gdouble         t0, direct, cached;
+    gint            queries = DEF_QUERIES;
+    gint            repeats = DEF_REPEATS;
+    gint            n = 0;
+
+    if (argc > 2)
+        queries = atoi(argv[2]);
+    if (argc > 3)
+        repeats = atoi(argv[3]);
+    if (queries < 1 || repeats < 1)
+    {
+        fprintf(stderr, "Usage: %s [tlefile [queries [repeats]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    if (argc > 1)
+        fname = g_strdup(argv[1]);
+    else
+        fname = g_build_filename(g_getenv("srcdir") ? g_getenv("srcdir") :
+                                 ".", "sgpsdp", "test-004.tle", NULL);
+    fp = g_fopen(fname, "r");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", fname);
+        return 1;
+    }
+
+    /* the default error bound, not that of the user configuration */
+    confdir = g_dir_make_tmp("gpredict-bench-XXXXXX", NULL);
+    if (confdir == NULL)
+    {
+        fprintf(stderr, "Could not create a configuration directory\n");
+        return 1;
+    }
+    g_setenv("XDG_CONFIG_HOME", confdir, TRUE);
+
+    sat_log_init();
+    sat_cfg_load();
+
+    memset(&qth, 0, sizeof(qth));
+    qth.lat = 55.6167;
+    qth.lon = 12.65;
+    qth.alt = 5;
+
+    printf("{\"benchmark\":\"ephem-cache\",\"version\":1,"
+           "\"queries\":%d,\"repeats\":%d,\"results\":[", queries, repeats);
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        memset(&sat, 0, sizeof(sat));
+        if (Get_Next_Tle_Set(tle_str, &sat.tle) != 1)
+        {
+            fprintf(stderr, "Could not read TLE data %s", tle_str[0]);
+            continue;
+        }
+        g_strchomp(sat.tle.sat_name);
+        select_ephemeris(&sat);
+        gtk_sat_data_init_sat(&sat, NULL);
+
+        t0 = sat.jul_epoch + 0.5;
+        cache = ephem_cache_new(&sat, 0.0);
+        cache->autofill = FALSE;
+        ephem_cache_fill(cache, t0 - 2.0 * cache->step,
+                         t0 + queries * QUERY_STEP + 2.0 * cache->step);
+
+        direct = bench_sat(&sat, NULL, &qth, t0, queries, repeats);
+        cached = bench_sat(&sat, cache, &qth, t0, queries, repeats);
+
+        printf("%s\n{\"name\":", n++ ? "," : "");
+        print_name(sat.tle.sat_name);
+        printf(",\"catnum\":%d,\"model\":\"%s\",\"step\":%.1f,"
+               "\"direct\":%.0f,\"cached\":%.0f,\"misses\":%u}",
+               sat.tle.catnr,
+               (sat.flags & DEEP_SPACE_EPHEM_FLAG) ? "SDP4" : "SGP4",
+               cache->step * 86400.0,
+               direct > 0.0 ? queries / direct : 0.0,
+               cached > 0.0 ? queries / cached : 0.0, cache->misses);
+
+        ephem_cache_free(cache);
+        Sat_Release(&sat);
+    }
+    fclose(fp);
+
+    printf("]}\n");
+
+    sat_cfg_close();
+    sat_log_close();
+    g_free(fname);
+    g_free(confdir);
+
+    return n == 0;
+}
@@ -0,0 +1,471 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Interpolated ephemeris cache.
+ *
+ * Consumers that need the satellite position many times per second, e.g.
+ * the rotator controller when it computes the lead position, used to run
+ * the full SGP4/SDP4 propagator on a copy of the satellite for every
+ * sample. The cache propagates the satellite at coarse nodes in a
+ * background thread and serves positions in between using cubic Hermite
+ * interpolation of the position and velocity vectors over the four nearest
+ * nodes.
+ *
+ * The error of cubic Hermite interpolation over an interval h is bounded by
+ * h^4/384 * max|x''''| with exact slopes; the slopes from third order
+ * differences add up to h^4/48 * max|x''''|. For an orbit |x''''| is of the
+ * order w^4 * r where w is the angular rate, which peaks at perigee. The
+ * perturbations of SGP4 add to that, and test-ephem finds errors of up to
+ * 1.15 times the bound, so the node spacing is chosen from the h^4/48 bound
+ * for half of SAT_CFG_INT_EPHEM_MAX_ERR. It is never larger than
+ * SAT_CFG_INT_EPHEM_STEP.
+ *
+ * The ground tracks of the map and the Doppler shift of the radio
+ * controller do not use the cache: the ground tracks are sampled every 30
+ * seconds over whole orbits, which costs as many propagations as filling
+ * the nodes, and the radio controller takes the range rate the module has
+ * already computed for the current time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+
+#include "ephem-cache.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+/* time span covered by one fill */
+#define EPHEM_SPAN      (1.0 / 24.0)
+
+/* smallest node spacing we accept */
+#define EPHEM_MIN_STEP  (1.0 / 86400.0)
+
+/* thread pool used for background fills, shared by all caches */
+static GThreadPool *fill_pool = NULL;
+static GMutex   fill_pool_lock;
+
+/* background fill job */
+typedef struct {
+    ephem_cache_t  *cache;
+    gdouble         t;
+} fill_job_t;
+
+
+static void ephem_cache_unref(ephem_cache_t * cache)
+{
+    if (!g_atomic_int_dec_and_test(&cache->refcount))
+        return;
+
+    if (cache->nodes)
+        g_array_unref(cache->nodes);
+
+    Sat_Release(&cache->work);
+    Sat_Release(&cache->fallback);
+    g_mutex_clear(&cache->lock);
+    g_mutex_clear(&cache->fill_lock);
+    g_free(cache);
+}
+
+/**
+ * Calculate node spacing.
+ *
+ * @param sat The satellite.
+ * @param maxerr The interpolation error bound [km].
+ * @return The node spacing in days.
+ */
+static gdouble node_step(sat_t * sat, gdouble maxerr)
+{
+    gdouble         n, a, e, rp, wp;
+    gdouble         step, maxstep;
+
+    maxstep = sat_cfg_get_int(SAT_CFG_INT_EPHEM_STEP) / 86400.0;
+    if (maxstep < EPHEM_MIN_STEP)
+        maxstep = EPHEM_MIN_STEP;
+
+    /* mean motion is stored in rad/min by select_ephemeris() */
+    if (sat->tle.xno <= 0.0 || maxerr <= 0.0)
+        return maxstep;
+
+    n = sat->tle.xno / 60.0;
+    e = CLAMP(sat->tle.eo, 0.0, 0.99);
+    a = pow(xke / sat->tle.xno, tothrd) * xkmper;
+
+    /* perigee radius and angular rate at perigee */
+    rp = a * (1.0 - e);
+    wp = n * sqrt((1.0 + e) / ((1.0 - e) * (1.0 - e) * (1.0 - e)));
+
+    /* h^4/48 * wp^4 * rp = maxerr / 2, see the top of the file */
+    step = pow(48.0 * 0.5 * maxerr / (wp * wp * wp * wp * rp), 0.25) /
+        86400.0;
+
+    return CLAMP(step, EPHEM_MIN_STEP, maxstep);
+}
+
+static void fill_job_run(gpointer data, gpointer user_data)
+{
+    fill_job_t     *job = data;
+    ephem_cache_t  *cache = job->cache;
+
+    (void)user_data;
+
+    ephem_cache_fill(cache, job->t - 2.0 * cache->step, job->t + cache->span);
+
+    g_mutex_lock(&cache->lock);
+    cache->pending = FALSE;
+    g_mutex_unlock(&cache->lock);
+
+    ephem_cache_unref(cache);
+    g_free(job);
+}
+
+/**
+ * Create a new ephemeris cache.
+ *
+ * @param sat The satellite. A private copy is made; the satellite is not
+ *            referenced after this function returns.
+ * @param maxerr The interpolation error bound in km. Use 0.0 to use
+ *               the value from SAT_CFG_INT_EPHEM_MAX_ERR.
+ * @return A newly allocated cache that should be freed with
+ *         ephem_cache_free() when no longer needed.
+ *
+ * The cache is empty when created. Call ephem_cache_prefetch() to start
+ * filling it in the background.
+ */
+ephem_cache_t  *ephem_cache_new(sat_t * sat, gdouble maxerr)
+{
+    ephem_cache_t  *cache;
+
+    g_return_val_if_fail(sat != NULL, NULL);
+
+    if (maxerr <= 0.0)
+        maxerr = sat_cfg_get_int(SAT_CFG_INT_EPHEM_MAX_ERR) / 1000.0;
+
+    cache = g_new0(ephem_cache_t, 1);
+    Sat_Copy(&cache->work, sat);
+    Sat_Copy(&cache->fallback, sat);
+
+    cache->maxerr = maxerr;
+    cache->step = node_step(sat, maxerr);
+    cache->span = MAX(EPHEM_SPAN, 8.0 * cache->step);
+    cache->nodes = NULL;
+    cache->pending = FALSE;
+    cache->autofill = TRUE;
+    cache->refcount = 1;
+    g_mutex_init(&cache->lock);
+    g_mutex_init(&cache->fill_lock);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Ephemeris cache for %s using %.1f sec node spacing"),
+                __func__, sat->nickname, cache->step * 86400.0);
+
+    return cache;
+}
+
+/**
+ * Free an ephemeris cache.
+ *
+ * @param cache The cache to free.
+ *
+ * A background fill may still be running when this function is called;
+ * in that case the memory is released when the fill is finished.
+ */
+void ephem_cache_free(ephem_cache_t * cache)
+{
+    if (cache == NULL)
+        return;
+
+    ephem_cache_unref(cache);
+}
+
+/**
+ * Fill the cache.
+ *
+ * @param cache The ephemeris cache.
+ * @param t0 Start of the time window (Julian date).
+ * @param t1 End of the time window (Julian date).
+ *
+ * This function propagates the satellite at the nodes covering [t0;t1]
+ * and replaces the nodes currently in the cache. The nodes are aligned to
+ * multiples of the node spacing so that nodes shared by consecutive fills
+ * have identical times. The function is normally called from the
+ * background thread, but it is safe to call it from anywhere.
+ */
+void ephem_cache_fill(ephem_cache_t * cache, gdouble t0, gdouble t1)
+{
+    GArray         *nodes, *old;
+    ephem_node_t    node;
+    sat_t          *sat = &cache->work;
+    guint           i, n;
+
+    g_return_if_fail(cache != NULL && t1 > t0);
+
+    t0 = floor(t0 / cache->step) * cache->step;
+    n = (guint) ceil((t1 - t0) / cache->step) + 1;
+
+    nodes = g_array_sized_new(FALSE, FALSE, sizeof(ephem_node_t), n);
+
+    g_mutex_lock(&cache->fill_lock);
+    for (i = 0; i < n; i++)
+    {
+        node.t = t0 + i * cache->step;
+
+        /* SDP4 only updates the lunar-solar periodics every 30 minutes,
+           which leaves steps between the nodes; compute them at each node */
+        sat->dstate.savtsn = 1E20;
+        predict_calc_eci(sat, node.t);
+        node.pos = sat->pos;
+        node.vel = sat->vel;
+        node.phase = sat->phase;
+        g_array_append_val(nodes, node);
+    }
+    g_mutex_unlock(&cache->fill_lock);
+
+    g_mutex_lock(&cache->lock);
+    old = cache->nodes;
+    cache->nodes = nodes;
+    g_mutex_unlock(&cache->lock);
+
+    if (old)
+        g_array_unref(old);
+}
+
+/**
+ * Fill the cache in the background.
+ *
+ * @param cache The ephemeris cache.
+ * @param t The time around which the cache should be filled.
+ *
+ * The fill covers a short time before t and EPHEM_SPAN after. If a fill
+ * is already queued for this cache, the request is ignored.
+ */
+void ephem_cache_prefetch(ephem_cache_t * cache, gdouble t)
+{
+    fill_job_t     *job;
+    GError         *error = NULL;
+
+    g_return_if_fail(cache != NULL);
+
+    g_mutex_lock(&cache->lock);
+    if (cache->pending)
+    {
+        g_mutex_unlock(&cache->lock);
+        return;
+    }
+    cache->pending = TRUE;
+    g_mutex_unlock(&cache->lock);
+
+    g_mutex_lock(&fill_pool_lock);
+    if (fill_pool == NULL)
+    {
+        fill_pool = g_thread_pool_new(fill_job_run, NULL, 1, FALSE, &error);
+        if (error != NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not create thread pool (%s)"),
+                        __func__, error->message);
+            g_clear_error(&error);
+            fill_pool = NULL;
+        }
+    }
+    g_mutex_unlock(&fill_pool_lock);
+
+    g_atomic_int_inc(&cache->refcount);
+    job = g_new(fill_job_t, 1);
+    job->cache = cache;
+    job->t = t;
+
+    /* no thread pool; fill synchronously */
+    if (fill_pool == NULL)
+    {
+        fill_job_run(job, NULL);
+        return;
+    }
+
+    g_thread_pool_push(fill_pool, job, NULL);
+}
+
+/**
+ * Interpolate a vector between the two middle of four nodes.
+ *
+ * @param a The node before the interval.
+ * @param b The node at the start of the interval.
+ * @param c The node at the end of the interval.
+ * @param d The node after the interval.
+ * @param tau The position in the interval, 0 at b and 1 at c.
+ * @param res Return location for the interpolated vector.
+ *
+ * Cubic Hermite interpolation with the slopes at b and c taken from third
+ * order differences of the four nodes.
+ */
+static void interpolate(const vector_t * a, const vector_t * b,
+                        const vector_t * c, const vector_t * d, gdouble tau,
+                        vector_t * res)
+{
+    gdouble         tau2, tau3;
+    gdouble         h00, h10, h01, h11;
+
+    tau2 = tau * tau;
+    tau3 = tau2 * tau;
+    h00 = 2.0 * tau3 - 3.0 * tau2 + 1.0;
+    h10 = (tau3 - 2.0 * tau2 + tau) / 6.0;
+    h01 = -2.0 * tau3 + 3.0 * tau2;
+    h11 = (tau3 - tau2) / 6.0;
+
+    res->x = h00 * b->x + h01 * c->x +
+        h10 * (-2.0 * a->x - 3.0 * b->x + 6.0 * c->x - d->x) +
+        h11 * (a->x - 6.0 * b->x + 3.0 * c->x + 2.0 * d->x);
+    res->y = h00 * b->y + h01 * c->y +
+        h10 * (-2.0 * a->y - 3.0 * b->y + 6.0 * c->y - d->y) +
+        h11 * (a->y - 6.0 * b->y + 3.0 * c->y + 2.0 * d->y);
+    res->z = h00 * b->z + h01 * c->z +
+        h10 * (-2.0 * a->z - 3.0 * b->z + 6.0 * c->z - d->z) +
+        h11 * (a->z - 6.0 * b->z + 3.0 * c->z + 2.0 * d->z);
+}
+
+/**
+ * Get the interpolated state vector.
+ *
+ * @param cache The ephemeris cache.
+ * @param t The time (Julian date).
+ * @param pos Return location for the ECI position [km].
+ * @param vel Return location for the ECI velocity [km/sec].
+ * @param phase Return location for the orbit phase [rad].
+ * @return TRUE if t is covered by the cache, FALSE otherwise. In the latter
+ *         case the return values are not touched.
+ *
+ * If t is not covered by the cache, or it is getting close to the end of the
+ * cached window, a background fill is started unless autofill has been
+ * disabled.
+ */
+gboolean ephem_cache_get_state(ephem_cache_t * cache, gdouble t,
+                               vector_t * pos, vector_t * vel,
+                               gdouble * phase)
+{
+    ephem_node_t   *n0, *n1, *nprev, *nnext;
+    gdouble         tau;
+    gdouble         dphase;
+    gdouble         tend;
+    gboolean        found = FALSE;
+    gboolean        refill = FALSE;
+    gint            i;
+
+    g_mutex_lock(&cache->lock);
+
+    if (cache->nodes != NULL && cache->nodes->len > 1)
+    {
+        n0 = &g_array_index(cache->nodes, ephem_node_t, 0);
+        i = (gint) floor((t - n0->t) / cache->step);
+        tend = g_array_index(cache->nodes, ephem_node_t,
+                             cache->nodes->len - 1).t;
+
+        /* the slopes need a node on either side of the interval */
+        if (i >= 1 && i + 2 < (gint) cache->nodes->len)
+        {
+            n0 = &g_array_index(cache->nodes, ephem_node_t, i);
+            n1 = &g_array_index(cache->nodes, ephem_node_t, i + 1);
+            nprev = n0 - 1;
+            nnext = n1 + 1;
+
+            tau = (t - n0->t) / cache->step;
+            interpolate(&nprev->pos, &n0->pos, &n1->pos, &nnext->pos, tau,
+                        pos);
+
+            /* The SGP4/SDP4 velocity is not exactly the derivative of the
+               position; deep-space orbits are off by tens of m/s. The
+               velocity is interpolated on its own so that the range rate
+               matches predict_calc(). */
+            interpolate(&nprev->vel, &n0->vel, &n1->vel, &nnext->vel, tau,
+                        vel);
+
+            Magnitude(pos);
+            Magnitude(vel);
+
+            /* phase is monotonously increasing modulo 2pi */
+            dphase = n1->phase - n0->phase;
+            if (dphase < 0.0)
+                dphase += twopi;
+            *phase = FMod2p(n0->phase + tau * dphase);
+
+            found = TRUE;
+        }
+
+        /* start refilling when a quarter of the window is left */
+        if (t > tend - 0.25 * cache->span)
+            refill = TRUE;
+    }
+
+    if (!found)
+    {
+        refill = TRUE;
+        cache->misses++;
+    }
+    else
+    {
+        cache->hits++;
+    }
+
+    if (refill && (cache->pending || !cache->autofill))
+        refill = FALSE;
+
+    g_mutex_unlock(&cache->lock);
+
+    if (refill)
+        ephem_cache_prefetch(cache, t);
+
+    return found;
+}
+
+/**
+ * Calculate satellite data using the ephemeris cache.
+ *
+ * @param cache The ephemeris cache.
+ * @param sat The satellite data structure where the results are stored.
+ * @param qth The observer.
+ * @param t The time (Julian date).
+ *
+ * This function is the cached equivalent of predict_calc(). It updates the
+ * same fields, but the propagator state in sat is never used or modified,
+ * so it is safe to call it on the satellites owned by the module.
+ *
+ * If t is not covered by the cache, the satellite is propagated directly
+ * using the private fallback copy in the cache. The fallback copy is not
+ * protected by any lock, so each cache must only be queried by one thread
+ * at a time.
+ */
+void ephem_cache_calc(ephem_cache_t * cache, sat_t * sat, qth_t * qth,
+                      gdouble t)
+{
+    if (!ephem_cache_get_state(cache, t, &sat->pos, &sat->vel, &sat->phase))
+    {
+        predict_calc_eci(&cache->fallback, t);
+        sat->pos = cache->fallback.pos;
+        sat->vel = cache->fallback.vel;
+        sat->phase = cache->fallback.phase;
+    }
+
+    sat->jul_utc = t;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+    predict_calc_obs(sat, qth);
+}
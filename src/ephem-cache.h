@@ -0,0 +1,70 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef EPHEM_CACHE_H
+#define EPHEM_CACHE_H 1
+
+#include <glib.h>
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+/** Ephemeris node; ECI state of the satellite at a given time. */
+typedef struct {
+    gdouble         t;          /*!< Time in "jul_utc" */
+    vector_t        pos;        /*!< ECI position [km] */
+    vector_t        vel;        /*!< ECI velocity [km/sec] */
+    gdouble         phase;      /*!< Orbit phase [rad] */
+} ephem_node_t;
+
+/**
+ * Per-satellite ephemeris cache.
+ *
+ * The cache holds the ECI state of a satellite at uniformly spaced nodes
+ * and serves the state at arbitrary times using cubic Hermite interpolation.
+ * The node spacing is derived from the error bound and the orbit so that
+ * the interpolation error stays below the bound. Nodes are propagated on
+ * a private copy of the satellite in a background thread; the cache never
+ * touches the sat_t it was created from after ephem_cache_new() returns.
+ */
+typedef struct {
+    sat_t           work;       /*!< Private copy used by the fill job */
+    sat_t           fallback;   /*!< Private copy used on cache misses */
+    gdouble         step;       /*!< Node spacing [days] */
+    gdouble         span;       /*!< Time span covered by one fill [days] */
+    gdouble         maxerr;     /*!< Interpolation error bound [km] */
+    GArray         *nodes;      /*!< ephem_node_t, sorted by time */
+    GMutex          lock;       /*!< Protects nodes and pending */
+    GMutex          fill_lock;  /*!< Serialises fills using work */
+    gboolean        pending;    /*!< A background fill has been queued */
+    gboolean        autofill;   /*!< Refill when queried outside the window */
+    gint            refcount;   /*!< Owner + queued fill jobs */
+    guint           hits;       /*!< Number of interpolated queries */
+    guint           misses;     /*!< Number of queries that had to propagate */
+} ephem_cache_t;
+
+ephem_cache_t  *ephem_cache_new(sat_t * sat, gdouble maxerr);
+void            ephem_cache_free(ephem_cache_t * cache);
+void            ephem_cache_fill(ephem_cache_t * cache, gdouble t0, gdouble t1);
+void            ephem_cache_prefetch(ephem_cache_t * cache, gdouble t);
+gboolean        ephem_cache_get_state(ephem_cache_t * cache, gdouble t,
+                                      vector_t * pos, vector_t * vel,
+                                      gdouble * phase);
+void            ephem_cache_calc(ephem_cache_t * cache, sat_t * sat,
+                                 qth_t * qth, gdouble t);
+
+#endif
@@ -0,0 +1,600 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * GNSS visibility and DOP dialog.
+ *
+ * Propagates a navigation satellite group (.cat file) for the QTH of the
+ * module in a background thread and plots the number of satellites in
+ * view together with the GDOP, PDOP and HDOP as a timeline. Changing the
+ * elevation mask only recomputes the DOP values, so the plot follows the
+ * spin button without propagating the satellites again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib/gi18n.h>
+#include <goocanvas.h>
+#include <gtk/gtk.h>
+#include <math.h>
+
+#include "compat.h"
+#include "gnss-dop.h"
+#include "gnss-dop-dialog.h"
+#include "gpredict-utils.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "time-tools.h"
+
+
+/* plot geometry */
+#define DOP_PLOT_WIDTH      600
+#define DOP_PLOT_HEIGHT     250
+#define DOP_PLOT_X_MARGIN   45
+#define DOP_PLOT_Y_MARGIN   30
+#define DOP_PLOT_NUM_TICKS  5
+#define DOP_MARKER_SIZE     5
+
+/* DOP values above this are drawn at the top of the plot */
+#define DOP_PLOT_MAX        10.0
+
+/* refresh interval of the progress bar [msec] */
+#define DOP_PROGRESS_REFRESH 250
+
+#define DOP_COL_NVIS        0x808080FF
+
+enum {
+    DOP_RESPONSE_RUN = 1,
+    DOP_RESPONSE_EXPORT
+};
+
+/* the DOP values shown in the plot */
+static const struct {
+    dop_type_t      type;
+    const gchar    *name;
+    guint32         col;
+} DOP_CURVE[] = {
+    {DOP_GDOP, N_("GDOP"), 0x000000FF},
+    {DOP_PDOP, N_("PDOP"), 0x0000BFFF},
+    {DOP_HDOP, N_("HDOP"), 0x00A000FF}
+};
+
+typedef struct {
+    GtkWidget      *dialog;
+    GtkWidget      *group;
+    GtkWidget      *mask;
+    GtkWidget      *hours;
+    GtkWidget      *progress;
+    GtkWidget      *canvas;
+    GtkWidget      *summary;
+    gdouble         width;
+    gdouble         height;
+    qth_t           qth;        /* copy of the observer location */
+    gdouble         t0;
+    gchar          *catfile;
+    dop_job_t      *job;
+    GThread        *thread;
+    gboolean        valid;      /* job holds a complete result */
+    gint            done;
+    guint           timerid;
+} dop_dlg_t;
+
+
+static gpointer dop_thread(gpointer data)
+{
+    dop_dlg_t      *dlg = data;
+
+    if (dop_job_load_cat(dlg->job, dlg->catfile) > 0)
+        dlg->valid = dop_job_run(dlg->job, &dlg->qth);
+
+    g_atomic_int_set(&dlg->done, 1);
+
+    return NULL;
+}
+
+// We use these defines to shorten the function names (indent)
+#define MKLINE goo_canvas_polyline_model_new_line
+#define MKTEXT goo_canvas_text_model_new
+
+/* Add a curve to the plot, split into segments where the value is NAN */
+static void add_curve(GooCanvasItemModel * root, dop_dlg_t * dlg,
+                      const gfloat * val, gdouble ymax, guint32 col)
+{
+    dop_job_t      *job = dlg->job;
+    GooCanvasPoints *pts;
+    gdouble         x0 = DOP_PLOT_X_MARGIN;
+    gdouble         y0 = dlg->height - DOP_PLOT_Y_MARGIN;
+    gdouble         xscale, yscale;
+    guint           e, start, n;
+
+    xscale = (dlg->width - 2 * DOP_PLOT_X_MARGIN) / MAX(job->nepochs - 1, 1);
+    yscale = (dlg->height - 2 * DOP_PLOT_Y_MARGIN) / ymax;
+
+    for (e = 0; e < job->nepochs; e++)
+    {
+        if (isnan(val[e]))
+            continue;
+
+        for (start = e; e < job->nepochs && !isnan(val[e]); e++);
+        n = e - start;
+
+        pts = goo_canvas_points_new(MAX(n, 2));
+        for (e = start; e < start + n; e++)
+        {
+            pts->coords[2 * (e - start)] = x0 + e * xscale;
+            pts->coords[2 * (e - start) + 1] =
+                y0 - MIN(val[e], ymax) * yscale;
+        }
+
+        /* a single epoch is drawn as a short horizontal line */
+        if (n == 1)
+        {
+            pts->coords[2] = pts->coords[0] + 1.0;
+            pts->coords[3] = pts->coords[1];
+        }
+
+        goo_canvas_polyline_model_new(root, FALSE, 0,
+                                      "points", pts,
+                                      "stroke-color-rgba", col,
+                                      "line-width", 1.0, NULL);
+        goo_canvas_points_unref(pts);
+    }
+}
+
+/* Create the frame, tick marks and labels of the plot */
+static void add_axes(GooCanvasItemModel * root, dop_dlg_t * dlg,
+                     guint nvismax)
+{
+    gdouble         x0 = DOP_PLOT_X_MARGIN;
+    gdouble         xmax = dlg->width - DOP_PLOT_X_MARGIN;
+    gdouble         y0 = dlg->height - DOP_PLOT_Y_MARGIN;
+    gdouble         ymax = DOP_PLOT_Y_MARGIN;
+    gdouble         xstep, ystep, x, y;
+    gdouble         t;
+    gchar           buff[7];
+    gchar          *txt;
+    guint32         col;
+    guint           i;
+
+    col = sat_cfg_get_int(SAT_CFG_INT_POLAR_AXIS_COL);
+
+    goo_canvas_rect_model_new(root, 0.0, 0.0, dlg->width, dlg->height,
+                              "fill-color-rgba", 0xFFFFFFFF,
+                              "stroke-color-rgba", 0xFFFFFFFF, NULL);
+
+    goo_canvas_rect_model_new(root, x0, ymax, xmax - x0, y0 - ymax,
+                              "stroke-color-rgba", 0x000000FF,
+                              "line-cap", CAIRO_LINE_CAP_SQUARE,
+                              "line-join", CAIRO_LINE_JOIN_MITER,
+                              "line-width", 1.0, NULL);
+
+    xstep = (xmax - x0) / (DOP_PLOT_NUM_TICKS + 1);
+    ystep = (y0 - ymax) / (DOP_PLOT_NUM_TICKS + 1);
+
+    for (i = 1; i <= DOP_PLOT_NUM_TICKS; i++)
+    {
+        x = x0 + i * xstep;
+        y = y0 - i * ystep;
+
+        MKLINE(root, x, y0, x, y0 - DOP_MARKER_SIZE,
+               "stroke-color-rgba", col, "line-width", 1.0, NULL);
+        MKLINE(root, x0, y, x0 + DOP_MARKER_SIZE, y,
+               "stroke-color-rgba", col, "line-width", 1.0, NULL);
+        MKLINE(root, xmax, y, xmax - DOP_MARKER_SIZE, y,
+               "stroke-color-rgba", col, "line-width", 1.0, NULL);
+
+        /* time labels */
+        t = dlg->job->t0 +
+            (dlg->job->t1 - dlg->job->t0) * i / (DOP_PLOT_NUM_TICKS + 1);
+        daynum_to_str(buff, 7, "%H:%M", t);
+        MKTEXT(root, buff, x, y0 + 5, -1, GOO_CANVAS_ANCHOR_N,
+               "font", "Sans 8", "fill-color-rgba", 0x000000FF, NULL);
+
+        /* DOP labels */
+        txt = g_strdup_printf("%.0f", DOP_PLOT_MAX * i /
+                              (DOP_PLOT_NUM_TICKS + 1));
+        MKTEXT(root, txt, x0 - 5, y, -1, GOO_CANVAS_ANCHOR_E,
+               "font", "Sans 8", "fill-color-rgba", 0x000000FF, NULL);
+        g_free(txt);
+
+        /* satellites in view labels */
+        txt = g_strdup_printf("%u", nvismax * i / (DOP_PLOT_NUM_TICKS + 1));
+        MKTEXT(root, txt, xmax + 5, y, -1, GOO_CANVAS_ANCHOR_W,
+               "font", "Sans 8", "fill-color-rgba", DOP_COL_NVIS, NULL);
+        g_free(txt);
+    }
+
+    MKTEXT(root, sat_cfg_get_bool(SAT_CFG_BOOL_USE_LOCAL_TIME) ?
+           _("Local Time") : _("UTC"),
+           x0 + (xmax - x0) / 2, dlg->height - 5, -1, GOO_CANVAS_ANCHOR_S,
+           "font", "Sans 9", "fill-color-rgba", 0x000000FF, NULL);
+
+    MKTEXT(root, _("DOP"), x0 - 7, ymax, -1, GOO_CANVAS_ANCHOR_NE,
+           "font", "Sans 9", "fill-color-rgba", 0x000000FF, NULL);
+    MKTEXT(root, _("Sats"), xmax + 7, ymax, -1, GOO_CANVAS_ANCHOR_NW,
+           "font", "Sans 9", "fill-color-rgba", DOP_COL_NVIS, NULL);
+
+    /* legend above the frame */
+    x = x0;
+    for (i = 0; i < G_N_ELEMENTS(DOP_CURVE); i++)
+    {
+        MKTEXT(root, _(DOP_CURVE[i].name), x, ymax - 5, -1,
+               GOO_CANVAS_ANCHOR_SW, "font", "Sans 9",
+               "fill-color-rgba", DOP_CURVE[i].col, NULL);
+        x += 50;
+    }
+    MKTEXT(root, _("Satellites in view"), x, ymax - 5, -1,
+           GOO_CANVAS_ANCHOR_SW, "font", "Sans 9",
+           "fill-color-rgba", DOP_COL_NVIS, NULL);
+}
+
+/* Rebuild the plot from the current results */
+static void update_plot(dop_dlg_t * dlg)
+{
+    GooCanvasItemModel *root;
+    gfloat         *nvis;
+    guint           nvismax = 0;
+    guint           e, i;
+
+    root = goo_canvas_group_model_new(NULL, NULL);
+
+    if (dlg->valid)
+    {
+        for (e = 0; e < dlg->job->nepochs; e++)
+            nvismax = MAX(nvismax, dlg->job->nvis[e]);
+
+        /* integer tick labels on the right axis */
+        nvismax = MAX(nvismax, 1) + DOP_PLOT_NUM_TICKS;
+        nvismax -= nvismax % (DOP_PLOT_NUM_TICKS + 1);
+
+        add_axes(root, dlg, nvismax);
+
+        nvis = g_new(gfloat, dlg->job->nepochs);
+        for (e = 0; e < dlg->job->nepochs; e++)
+            nvis[e] = dlg->job->nvis[e];
+        add_curve(root, dlg, nvis, nvismax, DOP_COL_NVIS);
+        g_free(nvis);
+
+        for (i = 0; i < G_N_ELEMENTS(DOP_CURVE); i++)
+            add_curve(root, dlg, dlg->job->dop[DOP_CURVE[i].type],
+                      DOP_PLOT_MAX, DOP_CURVE[i].col);
+    }
+
+    goo_canvas_set_root_item_model(GOO_CANVAS(dlg->canvas), root);
+    g_object_unref(root);
+}
+
+static void show_summary(dop_dlg_t * dlg)
+{
+    dop_job_t      *job = dlg->job;
+    gchar          *buff;
+    gdouble         sum = 0.0, max = 0.0;
+    guint           e, nfix = 0, nvismin = G_MAXUINT;
+
+    if (!dlg->valid)
+    {
+        gtk_label_set_text(GTK_LABEL(dlg->summary),
+                           _("No satellites could be loaded from the group."));
+        return;
+    }
+
+    for (e = 0; e < job->nepochs; e++)
+    {
+        nvismin = MIN(nvismin, job->nvis[e]);
+        if (isnan(job->dop[DOP_PDOP][e]))
+            continue;
+
+        nfix++;
+        sum += job->dop[DOP_PDOP][e];
+        max = MAX(max, job->dop[DOP_PDOP][e]);
+    }
+
+    buff = g_strdup_printf(_("%s: %d satellites, at least %d in view, "
+                             "position fix %.1f%% of the time, "
+                             "PDOP %.2f (max %.2f)"),
+                           job->name, job->sats->len, nvismin,
+                           100.0 * nfix / job->nepochs,
+                           nfix ? sum / nfix : 0.0, max);
+    gtk_label_set_text(GTK_LABEL(dlg->summary), buff);
+    g_free(buff);
+}
+
+static gboolean progress_update(gpointer data)
+{
+    dop_dlg_t      *dlg = data;
+
+    if (!g_atomic_int_get(&dlg->done))
+    {
+        if (dlg->job->steps == 0)
+            gtk_progress_bar_pulse(GTK_PROGRESS_BAR(dlg->progress));
+        else
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(dlg->progress),
+                                          dop_job_get_progress(dlg->job));
+
+        return TRUE;
+    }
+
+    g_thread_join(dlg->thread);
+    dlg->thread = NULL;
+    dlg->timerid = 0;
+
+    /* the mask may have been changed while the job was running */
+    if (dlg->valid)
+        dop_job_compute(dlg->job, gtk_spin_button_get_value
+                        (GTK_SPIN_BUTTON(dlg->mask)));
+
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(dlg->progress), 1.0);
+    show_summary(dlg);
+    update_plot(dlg);
+
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      DOP_RESPONSE_RUN, TRUE);
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      DOP_RESPONSE_EXPORT, dlg->valid);
+
+    return FALSE;
+}
+
+static void start_job(dop_dlg_t * dlg)
+{
+    gint            hours;
+
+    hours = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(dlg->hours));
+    sat_cfg_set_int(SAT_CFG_INT_DOP_WINDOW, hours);
+
+    g_free(dlg->catfile);
+    dlg->catfile = g_strdup(gtk_combo_box_get_active_id
+                            (GTK_COMBO_BOX(dlg->group)));
+    if (dlg->catfile == NULL)
+        return;
+
+    dop_job_free(dlg->job);
+    dlg->job = dop_job_new(dlg->t0, dlg->t0 + hours / 24.0);
+    dlg->valid = FALSE;
+    dlg->done = 0;
+
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      DOP_RESPONSE_RUN, FALSE);
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      DOP_RESPONSE_EXPORT, FALSE);
+    gtk_label_set_text(GTK_LABEL(dlg->summary), _("Computing..."));
+
+    dlg->thread = g_thread_new("gpredict_dop_dlg", dop_thread, dlg);
+    dlg->timerid = g_timeout_add(DOP_PROGRESS_REFRESH, progress_update, dlg);
+}
+
+static void export_result(dop_dlg_t * dlg)
+{
+    GtkWidget      *chooser;
+    GtkWidget      *msg;
+    gchar          *fname;
+
+    chooser = gtk_file_chooser_dialog_new(_("Export DOP"),
+                                          GTK_WINDOW(dlg->dialog),
+                                          GTK_FILE_CHOOSER_ACTION_SAVE,
+                                          "_Cancel", GTK_RESPONSE_CANCEL,
+                                          "_Save", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(chooser),
+                                                   TRUE);
+    fname = g_strdup_printf("%s-dop.csv", dlg->job->name);
+    g_strdelimit(fname, " /\\", '_');
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(chooser), fname);
+    g_free(fname);
+
+    if (gtk_dialog_run(GTK_DIALOG(chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        fname = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(chooser));
+        if (dop_job_export(dlg->job, fname))
+        {
+            msg = gtk_message_dialog_new(GTK_WINDOW(dlg->dialog),
+                                         GTK_DIALOG_MODAL |
+                                         GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         GTK_MESSAGE_ERROR,
+                                         GTK_BUTTONS_CLOSE,
+                                         _("Could not write %s"), fname);
+            gtk_dialog_run(GTK_DIALOG(msg));
+            gtk_widget_destroy(msg);
+        }
+        g_free(fname);
+    }
+
+    gtk_widget_destroy(chooser);
+}
+
+static void dop_dialog_response(GtkWidget * dialog, gint response,
+                                gpointer data)
+{
+    dop_dlg_t      *dlg = data;
+
+    switch (response)
+    {
+    case DOP_RESPONSE_RUN:
+        if (dlg->thread == NULL)
+            start_job(dlg);
+        break;
+
+    case DOP_RESPONSE_EXPORT:
+        if (dlg->valid)
+            export_result(dlg);
+        break;
+
+    default:
+        gtk_widget_destroy(dialog);
+        break;
+    }
+}
+
+/* A new elevation mask only needs the DOP values to be recomputed */
+static void mask_changed(GtkSpinButton * spin, gpointer data)
+{
+    dop_dlg_t      *dlg = data;
+    gint            mask;
+
+    mask = gtk_spin_button_get_value_as_int(spin);
+    sat_cfg_set_int(SAT_CFG_INT_DOP_MASK, mask);
+
+    if (!dlg->valid || dlg->thread != NULL)
+        return;
+
+    dop_job_compute(dlg->job, mask);
+    show_summary(dlg);
+    update_plot(dlg);
+}
+
+static void size_allocate_cb(GtkWidget * canvas, GtkAllocation * allocation,
+                             gpointer data)
+{
+    dop_dlg_t      *dlg = data;
+
+    if (dlg->width == allocation->width && dlg->height == allocation->height)
+        return;
+
+    dlg->width = allocation->width;
+    dlg->height = allocation->height;
+    goo_canvas_set_bounds(GOO_CANVAS(canvas), 0, 0, dlg->width, dlg->height);
+    update_plot(dlg);
+}
+
+static void dop_dialog_destroy(GtkWidget * dialog, gpointer data)
+{
+    dop_dlg_t      *dlg = data;
+
+    (void)dialog;
+
+    if (dlg->timerid > 0)
+        g_source_remove(dlg->timerid);
+
+    if (dlg->thread != NULL)
+    {
+        dop_job_cancel(dlg->job);
+        g_thread_join(dlg->thread);
+    }
+
+    dop_job_free(dlg->job);
+    g_free(dlg->catfile);
+    g_free(dlg);
+}
+
+static GtkWidget *add_row(GtkWidget * grid, const gchar * text,
+                          GtkWidget * widget, gint row)
+{
+    GtkWidget      *label;
+
+    label = gtk_label_new(text);
+    g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, row, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), widget, 1, row, 1, 1);
+
+    return widget;
+}
+
+/**
+ * Show the GNSS visibility and DOP dialog.
+ *
+ * @param name The name of the module, used in the title.
+ * @param qth The observer location. Only the coordinates are copied.
+ * @param t0 The start of the timeline.
+ * @param toplevel The parent window.
+ *
+ * The satellite group is selected in the dialog. The elevation mask and
+ * the length of the timeline default to SAT_CFG_INT_DOP_MASK and
+ * SAT_CFG_INT_DOP_WINDOW.
+ */
+void dop_dialog_show(const gchar * name, qth_t * qth, gdouble t0,
+                     GtkWidget * toplevel)
+{
+    dop_dlg_t      *dlg;
+    GtkWidget      *grid, *vbox;
+    gchar          *title;
+    gchar          *buff;
+
+    dlg = g_new0(dop_dlg_t, 1);
+    dlg->t0 = t0;
+    dlg->qth.lat = qth->lat;
+    dlg->qth.lon = qth->lon;
+    dlg->qth.alt = qth->alt;
+
+    grid = gtk_grid_new();
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 10);
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 5);
+
+    dlg->group = add_row(grid, _("Satellite group"),
+                         gtk_combo_box_text_new(), 0);
+    gpredict_load_cat_groups(dlg->group);
+
+    dlg->mask = add_row(grid, _("Elevation mask [deg]"),
+                        gtk_spin_button_new_with_range(0, 60, 1), 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(dlg->mask),
+                              sat_cfg_get_int(SAT_CFG_INT_DOP_MASK));
+    g_signal_connect(dlg->mask, "value-changed",
+                     G_CALLBACK(mask_changed), dlg);
+
+    dlg->hours = add_row(grid, _("Time span [hours]"),
+                         gtk_spin_button_new_with_range(1, 72, 1), 2);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(dlg->hours),
+                              sat_cfg_get_int(SAT_CFG_INT_DOP_WINDOW));
+
+    dlg->progress = gtk_progress_bar_new();
+
+    dlg->width = DOP_PLOT_WIDTH;
+    dlg->height = DOP_PLOT_HEIGHT;
+    dlg->canvas = goo_canvas_new();
+    gtk_widget_set_size_request(dlg->canvas, DOP_PLOT_WIDTH, DOP_PLOT_HEIGHT);
+    goo_canvas_set_bounds(GOO_CANVAS(dlg->canvas), 0, 0,
+                          DOP_PLOT_WIDTH, DOP_PLOT_HEIGHT);
+    g_signal_connect(dlg->canvas, "size-allocate",
+                     G_CALLBACK(size_allocate_cb), dlg);
+
+    dlg->summary = gtk_label_new("");
+    gtk_label_set_line_wrap(GTK_LABEL(dlg->summary), TRUE);
+    gtk_label_set_max_width_chars(GTK_LABEL(dlg->summary), 70);
+
+    title = g_strdup_printf(_("GNSS visibility and DOP for %s"), name);
+    dlg->dialog = gtk_dialog_new_with_buttons(title,
+                                              GTK_WINDOW(toplevel),
+                                              GTK_DIALOG_DESTROY_WITH_PARENT,
+                                              _("_Export"),
+                                              DOP_RESPONSE_EXPORT,
+                                              _("C_ompute"), DOP_RESPONSE_RUN,
+                                              "_Close", GTK_RESPONSE_CLOSE,
+                                              NULL);
+    g_free(title);
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(dlg->dialog),
+                                      DOP_RESPONSE_EXPORT, FALSE);
+
+    buff = icon_file_name("gpredict-icon.png");
+    gtk_window_set_icon_from_file(GTK_WINDOW(dlg->dialog), buff, NULL);
+    g_free(buff);
+
+    g_signal_connect(dlg->dialog, "response",
+                     G_CALLBACK(dop_dialog_response), dlg);
+    g_signal_connect(dlg->dialog, "destroy",
+                     G_CALLBACK(dop_dialog_destroy), dlg);
+
+    vbox = gtk_dialog_get_content_area(GTK_DIALOG(dlg->dialog));
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 10);
+    gtk_box_set_spacing(GTK_BOX(vbox), 5);
+    gtk_box_pack_start(GTK_BOX(vbox), grid, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), dlg->progress, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), dlg->canvas, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), dlg->summary, FALSE, FALSE, 0);
+
+    gtk_widget_show_all(dlg->dialog);
+}
@@ -0,0 +1,555 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * GNSS visibility and dilution of precision.
+ *
+ * A navigation constellation is propagated on a fixed time grid and the
+ * line of sight from the QTH to every satellite is stored in local east,
+ * north, up coordinates together with the elevation. This is the
+ * expensive part and runs in parallel, each thread taking a share of the
+ * satellites with its own copy of the propagators.
+ *
+ * The DOP values are then computed for each epoch from the satellites
+ * above the elevation mask. The normal matrix H'H of the usual position
+ * and clock design matrix only has 10 distinct elements, which are
+ * accumulated with a branch free loop over the contiguous per epoch line
+ * of sight arrays so that the compiler can vectorise it. The diagonal of
+ * the inverse follows from a 4x4 Cholesky factorisation. The whole 24
+ * hour timeline takes a few milliseconds, so a new elevation mask is
+ * applied without propagating the satellites again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "compat.h"
+#include "gnss-dop.h"
+#include "gtk-sat-data.h"
+#include "sat-log.h"
+
+
+/* time step [sec] */
+#define DOP_STEP            30.0
+
+/* state of one worker thread */
+typedef struct {
+    dop_job_t      *job;
+    qth_t          *qth;
+    guint           sat0;       /* first satellite of the share */
+    guint           sat1;       /* last satellite of the share (excl) */
+} dop_worker_t;
+
+
+/**
+ * Create a new DOP job.
+ *
+ * @param t0 The start of the time window.
+ * @param t1 The end of the time window.
+ * @return A new job, which should be freed with dop_job_free().
+ */
+dop_job_t      *dop_job_new(gdouble t0, gdouble t1)
+{
+    dop_job_t      *job;
+
+    job = g_new0(dop_job_t, 1);
+    job->t0 = t0;
+    job->t1 = t1;
+    job->step = DOP_STEP;
+    job->nepochs = (guint) floor((t1 - t0) * secday / job->step) + 1;
+    job->sats = g_array_new(FALSE, FALSE, sizeof(sat_t));
+    g_array_set_clear_func(job->sats, (GDestroyNotify) Sat_Release);
+
+    return job;
+}
+
+/* Free the line of sight and result arrays */
+static void free_arrays(dop_job_t * job)
+{
+    guint           i;
+
+    g_free(job->east);
+    g_free(job->north);
+    g_free(job->up);
+    g_free(job->el);
+    g_free(job->nvis);
+    job->east = job->north = job->up = job->el = NULL;
+    job->nvis = NULL;
+
+    for (i = 0; i < DOP_NUM; i++)
+    {
+        g_free(job->dop[i]);
+        job->dop[i] = NULL;
+    }
+}
+
+void dop_job_free(dop_job_t * job)
+{
+    if (job == NULL)
+        return;
+
+    free_arrays(job);
+    g_array_free(job->sats, TRUE);
+    g_free(job->name);
+    g_free(job);
+}
+
+/**
+ * Add a satellite to the job.
+ *
+ * @param job The DOP job.
+ * @param sat The satellite, initialised with gtk_sat_data_read_sat().
+ *
+ * The satellite data is copied.
+ */
+void dop_job_add_sat(dop_job_t * job, sat_t * sat)
+{
+    sat_t           copy;
+
+    Sat_Copy(&copy, sat);
+    copy.name = NULL;
+    copy.nickname = NULL;
+    copy.website = NULL;
+    copy.flags &= DEEP_SPACE_EPHEM_FLAG;
+
+    g_array_append_val(job->sats, copy);
+}
+
+/**
+ * Add the satellites of a group to the job.
+ *
+ * @param job The DOP job.
+ * @param catfile The name of the .cat file in the satdata directory.
+ * @return The number of satellites added.
+ *
+ * The group name in the first line of the file is used as job name.
+ */
+gint dop_job_load_cat(dop_job_t * job, const gchar * catfile)
+{
+    GIOChannel     *chan;
+    GError         *error = NULL;
+    gchar          *path;
+    gchar          *buff;
+    sat_t           sat;
+    gint            num = 0;
+
+    path = sat_file_name(catfile);
+    chan = g_io_channel_new_file(path, "r", &error);
+    g_free(path);
+
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open %s: %s"),
+                    __func__, catfile, error->message);
+        g_clear_error(&error);
+        return 0;
+    }
+
+    /* group name then one catalogue number per line */
+    if (g_io_channel_read_line(chan, &buff, NULL, NULL, NULL) ==
+        G_IO_STATUS_NORMAL)
+    {
+        g_free(job->name);
+        job->name = g_strstrip(buff);
+
+        while (g_io_channel_read_line(chan, &buff, NULL, NULL, NULL) ==
+               G_IO_STATUS_NORMAL)
+        {
+            memset(&sat, 0, sizeof(sat_t));
+            if (!gtk_sat_data_read_sat((gint) g_ascii_strtoll(buff, NULL, 0),
+                                       &sat))
+            {
+                dop_job_add_sat(job, &sat);
+                num++;
+            }
+
+            gtk_sat_data_clear_sat(&sat);
+            g_free(buff);
+        }
+    }
+
+    g_io_channel_shutdown(chan, FALSE, NULL);
+    g_io_channel_unref(chan);
+
+    return num;
+}
+
+/** Stop a running job. */
+void dop_job_cancel(dop_job_t * job)
+{
+    g_atomic_int_set(&job->cancel, 1);
+}
+
+/** Get the progress of a running job (0.0 - 1.0). */
+gdouble dop_job_get_progress(dop_job_t * job)
+{
+    if (job->steps == 0)
+        return 0.0;
+
+    return (gdouble) g_atomic_int_get(&job->progress) / job->steps;
+}
+
+/* Compute the line of sight to the satellites of one worker */
+static gpointer dop_worker(gpointer data)
+{
+    dop_worker_t   *w = data;
+    dop_job_t      *job = w->job;
+    guint           nsats = job->sats->len;
+    geodetic_t      obs_geodetic;
+    obs_set_t       obs_set;
+    sat_t           sat;
+    gdouble         t, ce;
+    guint           e, k, idx;
+
+    obs_geodetic.lon = w->qth->lon * de2ra;
+    obs_geodetic.lat = w->qth->lat * de2ra;
+    obs_geodetic.alt = w->qth->alt / 1000.0;
+    obs_geodetic.theta = 0;
+
+    for (k = w->sat0; k < w->sat1; k++)
+    {
+        if (g_atomic_int_get(&job->cancel))
+            break;
+
+        memcpy(&sat, &g_array_index(job->sats, sat_t, k), sizeof(sat_t));
+
+        for (e = 0; e < job->nepochs; e++)
+        {
+            t = job->t0 + e * job->step / secday;
+            idx = e * nsats + k;
+
+            sat.jul_utc = t;
+            sat.tsince = (sat.jul_utc - sat.jul_epoch) * xmnpda;
+
+            if (sat.flags & DEEP_SPACE_EPHEM_FLAG)
+                SDP4(&sat, sat.tsince);
+            else
+                SGP4(&sat, sat.tsince);
+
+            Convert_Sat_State(&sat.pos, &sat.vel);
+
+            /* decayed or otherwise broken orbits are never in view */
+            if (isnan(sat.pos.x) || isnan(sat.pos.y) || isnan(sat.pos.z))
+            {
+                job->el[idx] = -90.0f;
+                job->east[idx] = job->north[idx] = job->up[idx] = 0.0f;
+                continue;
+            }
+
+            Calculate_Obs(t, &sat.pos, &sat.vel, &obs_geodetic, &obs_set);
+
+            ce = cos(obs_set.el);
+            job->east[idx] = (gfloat) (ce * sin(obs_set.az));
+            job->north[idx] = (gfloat) (ce * cos(obs_set.az));
+            job->up[idx] = (gfloat) sin(obs_set.el);
+            job->el[idx] = (gfloat) (obs_set.el / de2ra);
+        }
+
+        g_atomic_int_inc(&job->progress);
+    }
+
+    return NULL;
+}
+
+/**
+ * Propagate the satellites and compute the line of sight from the QTH.
+ *
+ * @param job The DOP job.
+ * @param qth The observer location.
+ * @return TRUE if the job completed, FALSE if it was cancelled.
+ *
+ * This function blocks until the job is done or cancelled and may be
+ * called from a worker thread. Use dop_job_compute() afterwards to get
+ * the DOP values for an elevation mask.
+ */
+gboolean dop_job_run(dop_job_t * job, qth_t * qth)
+{
+    dop_worker_t   *workers;
+    GThread       **threads;
+    guint           nsats = job->sats->len;
+    guint           n = job->nepochs * nsats;
+    guint           nthreads, i;
+    gint64          start;
+    gboolean        done;
+
+    if (nsats == 0)
+        return FALSE;
+
+    start = g_get_monotonic_time();
+
+    free_arrays(job);
+    job->east = g_new(gfloat, n);
+    job->north = g_new(gfloat, n);
+    job->up = g_new(gfloat, n);
+    job->el = g_new(gfloat, n);
+    job->nvis = g_new0(guint16, job->nepochs);
+    for (i = 0; i < DOP_NUM; i++)
+        job->dop[i] = g_new(gfloat, job->nepochs);
+
+    job->steps = (gint) nsats;
+    nthreads = CLAMP(g_get_num_processors(), 1, nsats);
+
+    workers = g_new0(dop_worker_t, nthreads);
+    threads = g_new0(GThread *, nthreads);
+
+    for (i = 0; i < nthreads; i++)
+    {
+        workers[i].job = job;
+        workers[i].qth = qth;
+        workers[i].sat0 = nsats * i / nthreads;
+        workers[i].sat1 = nsats * (i + 1) / nthreads;
+
+        threads[i] = g_thread_new("gpredict_dop", dop_worker, &workers[i]);
+    }
+
+    for (i = 0; i < nthreads; i++)
+        g_thread_join(threads[i]);
+
+    g_free(workers);
+    g_free(threads);
+
+    done = !g_atomic_int_get(&job->cancel);
+    if (done)
+        dop_job_compute(job, job->mask);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Line of sight to %d satellites at %d epochs "
+                  "in %.1f s using %d threads"),
+                __func__, nsats, job->nepochs,
+                (g_get_monotonic_time() - start) / 1.0e6, nthreads);
+
+    return done;
+}
+
+/*
+ * Diagonal of the inverse of a symmetric positive definite 4x4 matrix.
+ * Only the lower triangle of a is used. Returns FALSE if the matrix is
+ * singular, i.e. the geometry does not allow a solution.
+ */
+static gboolean inverse_diag(gdouble a[4][4], gdouble q[4])
+{
+    gdouble         l[4][4] = { {0.0} };
+    gdouble         m[4][4] = { {0.0} };
+    gdouble         s;
+    gint            i, j, k;
+
+    /* a = l * l' */
+    for (j = 0; j < 4; j++)
+    {
+        s = a[j][j];
+        for (k = 0; k < j; k++)
+            s -= l[j][k] * l[j][k];
+
+        if (!(s > 1.0e-9))
+            return FALSE;
+
+        l[j][j] = sqrt(s);
+
+        for (i = j + 1; i < 4; i++)
+        {
+            s = a[i][j];
+            for (k = 0; k < j; k++)
+                s -= l[i][k] * l[j][k];
+            l[i][j] = s / l[j][j];
+        }
+    }
+
+    /* m = inv(l), inv(a) = m' * m */
+    for (j = 0; j < 4; j++)
+    {
+        m[j][j] = 1.0 / l[j][j];
+        for (i = j + 1; i < 4; i++)
+        {
+            s = 0.0;
+            for (k = j; k < i; k++)
+                s -= l[i][k] * m[k][j];
+            m[i][j] = s / l[i][i];
+        }
+    }
+
+    for (j = 0; j < 4; j++)
+    {
+        q[j] = 0.0;
+        for (i = j; i < 4; i++)
+            q[j] += m[i][j] * m[i][j];
+    }
+
+    return TRUE;
+}
+
+/**
+ * Compute the number of satellites in view and the DOP values.
+ *
+ * @param job The DOP job, after dop_job_run().
+ * @param mask The elevation mask [deg].
+ *
+ * The results are left in job->nvis and job->dop. The DOP values are NAN
+ * for epochs with less than 4 satellites in view or a degenerate
+ * geometry.
+ */
+void dop_job_compute(dop_job_t * job, gdouble mask)
+{
+    guint           nsats = job->sats->len;
+    const gfloat   *ve, *vn, *vu, *vel;
+    gfloat          fmask = (gfloat) mask;
+    gdouble         w, see, sen, seu, se, snn, snu, sn, suu, su, sw;
+    gdouble         a[4][4], q[4];
+    guint           e, k, i;
+
+    job->mask = mask;
+
+    if (job->el == NULL)
+        return;
+
+    for (e = 0; e < job->nepochs; e++)
+    {
+        ve = &job->east[e * nsats];
+        vn = &job->north[e * nsats];
+        vu = &job->up[e * nsats];
+        vel = &job->el[e * nsats];
+
+        see = sen = seu = se = snn = snu = sn = suu = su = sw = 0.0;
+
+        for (k = 0; k < nsats; k++)
+        {
+            w = (vel[k] >= fmask) ? 1.0 : 0.0;
+            see += w * ve[k] * ve[k];
+            sen += w * ve[k] * vn[k];
+            seu += w * ve[k] * vu[k];
+            se += w * ve[k];
+            snn += w * vn[k] * vn[k];
+            snu += w * vn[k] * vu[k];
+            sn += w * vn[k];
+            suu += w * vu[k] * vu[k];
+            su += w * vu[k];
+            sw += w;
+        }
+
+        job->nvis[e] = (guint16) sw;
+
+        a[0][0] = see;
+        a[1][0] = sen;
+        a[1][1] = snn;
+        a[2][0] = seu;
+        a[2][1] = snu;
+        a[2][2] = suu;
+        a[3][0] = se;
+        a[3][1] = sn;
+        a[3][2] = su;
+        a[3][3] = sw;
+
+        if (job->nvis[e] < 4 || !inverse_diag(a, q))
+        {
+            for (i = 0; i < DOP_NUM; i++)
+                job->dop[i][e] = NAN;
+            continue;
+        }
+
+        job->dop[DOP_GDOP][e] = (gfloat) sqrt(q[0] + q[1] + q[2] + q[3]);
+        job->dop[DOP_PDOP][e] = (gfloat) sqrt(q[0] + q[1] + q[2]);
+        job->dop[DOP_HDOP][e] = (gfloat) sqrt(q[0] + q[1]);
+        job->dop[DOP_VDOP][e] = (gfloat) sqrt(q[2]);
+        job->dop[DOP_TDOP][e] = (gfloat) sqrt(q[3]);
+    }
+}
+
+/* Format a DOP value for export, empty if undefined */
+static void format_dop(gchar * buff, gsize len, gfloat value)
+{
+    if (isnan(value))
+        buff[0] = '\0';
+    else
+        g_ascii_formatd(buff, len, "%.3f", value);
+}
+
+/**
+ * Export the timeline as comma separated values.
+ *
+ * @param job The DOP job, after dop_job_run().
+ * @param fname The name of the file, or "-" for the standard output.
+ * @return 0 if the file was written, -1 otherwise.
+ *
+ * One line per epoch with the time in UTC, the number of satellites above
+ * the elevation mask and the GDOP, PDOP, HDOP, VDOP and TDOP. The DOP
+ * fields are empty when less than 4 satellites are in view.
+ */
+gint dop_job_export(dop_job_t * job, const gchar * fname)
+{
+    GString        *data;
+    GError         *error = NULL;
+    GDateTime      *dt;
+    gchar          *tstr;
+    gchar           val[DOP_NUM][G_ASCII_DTOSTR_BUF_SIZE];
+    gdouble         t;
+    guint           e, i;
+    gint            retcode = 0;
+
+    if (job->el == NULL)
+        return -1;
+
+    data = g_string_new(NULL);
+    g_string_append_printf(data, "# %s, elevation mask %.1f deg\n",
+                           job->name ? job->name : "", job->mask);
+    g_string_append(data, "time,in_view,gdop,pdop,hdop,vdop,tdop\n");
+
+    for (e = 0; e < job->nepochs; e++)
+    {
+        /* Julian date to Unix time */
+        t = job->t0 + e * job->step / secday;
+        dt = g_date_time_new_from_unix_utc((gint64) floor((t - 2440587.5) *
+                                                          secday + 0.5));
+        tstr = g_date_time_format(dt, "%Y-%m-%dT%H:%M:%SZ");
+        g_date_time_unref(dt);
+
+        for (i = 0; i < DOP_NUM; i++)
+            format_dop(val[i], sizeof(val[i]), job->dop[i][e]);
+
+        g_string_append_printf(data, "%s,%d,%s,%s,%s,%s,%s\n", tstr,
+                               job->nvis[e], val[DOP_GDOP], val[DOP_PDOP],
+                               val[DOP_HDOP], val[DOP_VDOP], val[DOP_TDOP]);
+        g_free(tstr);
+    }
+
+    if (!strcmp(fname, "-"))
+    {
+        if (fwrite(data->str, 1, data->len, stdout) != data->len)
+            retcode = -1;
+        fflush(stdout);
+    }
+    else if (!g_file_set_contents(fname, data->str, data->len, &error))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not write %s (%s)"),
+                    __func__, fname, error->message);
+        g_clear_error(&error);
+        retcode = -1;
+    }
+
+    g_string_free(data, TRUE);
+
+    return retcode;
+}
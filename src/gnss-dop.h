@@ -0,0 +1,67 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef GNSS_DOP_H
+#define GNSS_DOP_H 1
+
+#include <glib.h>
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+/** Dilution of precision values computed for each epoch. */
+typedef enum {
+    DOP_GDOP = 0,               /*!< Geometric DOP */
+    DOP_PDOP,                   /*!< Position DOP */
+    DOP_HDOP,                   /*!< Horizontal DOP */
+    DOP_VDOP,                   /*!< Vertical DOP */
+    DOP_TDOP,                   /*!< Time DOP */
+    DOP_NUM
+} dop_type_t;
+
+/** GNSS visibility and DOP job. */
+typedef struct {
+    gdouble         t0;         /*!< Start of the time window */
+    gdouble         t1;         /*!< End of the time window */
+    gdouble         step;       /*!< Time step [sec] */
+    gdouble         mask;       /*!< Elevation mask of the results [deg] */
+    gchar          *name;       /*!< Name of the satellite group */
+    GArray         *sats;       /*!< The satellites (sat_t) */
+    guint           nepochs;    /*!< Number of epochs */
+    gfloat         *east;       /*!< Line of sight, nepochs * nsats each */
+    gfloat         *north;
+    gfloat         *up;
+    gfloat         *el;         /*!< Elevation [deg], nepochs * nsats */
+    guint16        *nvis;       /*!< Satellites above the mask, nepochs */
+    gfloat         *dop[DOP_NUM];  /*!< Results, nepochs each, NAN if less
+                                        than 4 satellites are in view */
+    gint            steps;      /*!< Total number of propagation steps */
+    gint            progress;   /*!< Propagation steps done (atomic) */
+    gint            cancel;     /*!< Set to 1 to stop the job (atomic) */
+} dop_job_t;
+
+dop_job_t      *dop_job_new(gdouble t0, gdouble t1);
+void            dop_job_free(dop_job_t * job);
+void            dop_job_add_sat(dop_job_t * job, sat_t * sat);
+gint            dop_job_load_cat(dop_job_t * job, const gchar * catfile);
+gboolean        dop_job_run(dop_job_t * job, qth_t * qth);
+void            dop_job_compute(dop_job_t * job, gdouble mask);
+void            dop_job_cancel(dop_job_t * job);
+gdouble         dop_job_get_progress(dop_job_t * job);
+gint            dop_job_export(dop_job_t * job, const gchar * fname);
+
+#endif
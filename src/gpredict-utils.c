@@ -24,6 +24,7 @@
 #include <glib/gi18n.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
+#include <string.h>
 
 #include "compat.h"
 #include "gpredict-utils.h"
@@ -653,3 +654,53 @@ guint rgb_to_cfg(const GdkRGBA * gdk_rgba)
 
     return cfg_int;
 }
+
+/**
+ * Fill a combo box with the satellite groups.
+ *
+ * @param combo The GtkComboBoxText.
+ *
+ * Adds the .cat files of the satdata directory using the group name from
+ * the first line of the file as text and the file name as ID. The first
+ * group is selected.
+ */
+void gpredict_load_cat_groups(GtkWidget * combo)
+{
+    GDir           *dir;
+    gchar          *dirname;
+    const gchar    *fname;
+    gchar          *path;
+    gchar          *contents;
+    gchar          *name;
+    GSList         *files = NULL, *node;
+
+    dirname = get_satdata_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    g_free(dirname);
+    if (!dir)
+        return;
+
+    while ((fname = g_dir_read_name(dir)))
+        if (g_str_has_suffix(fname, ".cat"))
+            files = g_slist_insert_sorted(files, g_strdup(fname),
+                                          (GCompareFunc) g_strcmp0);
+    g_dir_close(dir);
+
+    for (node = files; node != NULL; node = node->next)
+    {
+        /* the group name is in the first line */
+        path = sat_file_name(node->data);
+        if (g_file_get_contents(path, &contents, NULL, NULL))
+        {
+            name = g_strstrip(g_strndup(contents, strcspn(contents, "\n")));
+            gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(combo), node->data,
+                                      name);
+            g_free(name);
+            g_free(contents);
+        }
+        g_free(path);
+    }
+
+    g_slist_free_full(files, g_free);
+    gtk_combo_box_set_active(GTK_COMBO_BOX(combo), 0);
+}
@@ -47,4 +47,5 @@ char           *gpredict_strcasestr(const char *s1, const char *s2);
 gboolean        gpredict_save_key_file(GKeyFile * cfgdata,
                                        const char *filename);
 gboolean        gpredict_legal_char(int ch);
+void            gpredict_load_cat_groups(GtkWidget * combo);
 #endif
@@ -254,12 +254,12 @@ static void size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation,
                      "y", (gfloat) (azel->height - 5), NULL);
 
         /* Az graph */
-        n = g_slist_length(azel->pass->details);
+        n = PASS_NUM_DETAILS(azel->pass);
         pts = goo_canvas_points_new(n);
 
         for (i = 0; i < n; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(azel->pass->details, i));
+            detail = PASS_NTH_DETAIL(azel->pass, i);
             az_to_xy(azel, detail->time, detail->az, &dx, &dy);
             pts->coords[2 * i] = dx;
             pts->coords[2 * i + 1] = dy;
@@ -270,12 +270,12 @@ static void size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation,
         goo_canvas_points_unref(pts);
 
         /* El graph */
-        n = g_slist_length(azel->pass->details);
+        n = PASS_NUM_DETAILS(azel->pass);
         pts = goo_canvas_points_new(n);
 
         for (i = 0; i < n; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(azel->pass->details, i));
+            detail = PASS_NTH_DETAIL(azel->pass, i);
             el_to_xy(azel, detail->time, detail->el, &dx, &dy);
             pts->coords[2 * i] = dx;
             pts->coords[2 * i + 1] = dy;
@@ -628,10 +628,10 @@ GtkWidget      *gtk_azel_plot_new(qth_t * qth, pass_t * pass)
     azel->cursinfo = TRUE;
 
     /* check maximum Az */
-    n = g_slist_length(pass->details);
+    n = PASS_NUM_DETAILS(pass);
     for (i = 0; i < n; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+        detail = PASS_NTH_DETAIL(pass, i);
 
         if (detail->az > azel->maxaz)
         {
@@ -420,7 +420,7 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
                                        GtkTreeIter * iter, gpointer data)
 {
     GtkEventList   *evlist = GTK_EVENT_LIST(data);
-    guint          *catnum;
+    guint           catnum;
     sat_t          *sat;
     gdouble         number, now;
 
@@ -429,21 +429,20 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
     /* get the catalogue number for this row
        then look it up in the hash table
      */
-    catnum = g_new0(guint, 1);
-    gtk_tree_model_get(model, iter, EVENT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT(g_hash_table_lookup(evlist->satellites, catnum));
+    gtk_tree_model_get(model, iter, EVENT_LIST_COL_CATNUM, &catnum, -1);
+    sat = SAT(g_hash_table_lookup(evlist->satellites, &catnum));
 
     if (sat == NULL)
     {
         /* satellite not tracked anymore => remove */
         sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s: Failed to get data for #%d."), __func__, *catnum);
+                    _("%s: Failed to get data for #%d."), __func__, catnum);
 
         gtk_list_store_remove(GTK_LIST_STORE(model), iter);
 
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: Satellite #%d removed from list."),
-                    __func__, *catnum);
+                    __func__, catnum);
     }
     else
     {
@@ -486,8 +485,6 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
                            -1);
     }
 
-    g_free(catnum);
-
     /* Return value not documented what to return, but it seems that
        FALSE continues to next row while TRUE breaks
      */
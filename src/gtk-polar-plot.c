@@ -265,7 +265,7 @@ static void create_track(GtkPolarPlot * pv)
     root = goo_canvas_get_root_item_model(GOO_CANVAS(pv->canvas));
 
     /* create points */
-    num = g_slist_length(pv->pass->details);
+    num = PASS_NUM_DETAILS(pv->pass);
 
     /* time resolution for time ticks; we need
        3 additional points to AOS and LOS ticks.
@@ -284,7 +284,7 @@ static void create_track(GtkPolarPlot * pv)
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pv->pass->details, i));
+        detail = PASS_NTH_DETAIL(pv->pass, i);
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
         points->coords[2 * i] = (double)x;
@@ -529,7 +529,7 @@ static void update_track(GtkPolarPlot * pv)
     guint           tres, ttidx;
 
     /* create points */
-    num = g_slist_length(pv->pass->details);
+    num = PASS_NUM_DETAILS(pv->pass);
 
     points = goo_canvas_points_new(num);
 
@@ -549,7 +549,7 @@ static void update_track(GtkPolarPlot * pv)
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pv->pass->details, i));
+        detail = PASS_NTH_DETAIL(pv->pass, i);
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
         points->coords[2 * i] = (double)x;
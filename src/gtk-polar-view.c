@@ -1379,7 +1379,7 @@ static void update_track(gpointer key, gpointer value, gpointer data)
         }
 
         /* create points */
-        num = g_slist_length(obj->pass->details);
+        num = PASS_NUM_DETAILS(obj->pass);
         if (num == 0)
         {
             sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1406,7 +1406,7 @@ static void update_track(gpointer key, gpointer value, gpointer data)
 
         for (i = 1; i < num - 1; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+            detail = PASS_NTH_DETAIL(obj->pass, i);
             if (detail->el >= 0)
                 azel_to_xy(pv, detail->az, detail->el, &x, &y);
             points->coords[2 * i] = (double)x;
@@ -1521,7 +1521,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
     /* add sky track */
 
     /* create points */
-    num = g_slist_length(obj->pass->details);
+    num = PASS_NUM_DETAILS(obj->pass);
     if (num == 0)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1548,7 +1548,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+        detail = PASS_NTH_DETAIL(obj->pass, i);
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
         points->coords[2 * i] = (double)x;
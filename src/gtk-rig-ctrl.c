@@ -59,6 +59,7 @@
 #include "radio-conf.h"
 #include "sat-log.h"
 #include "sat-cfg.h"
+#include "sat-trace.h"
 #include "trsp-conf.h"
 
 
@@ -66,6 +67,9 @@
 #define MAX_ERROR_COUNT 5
 #define WR_DEL 5000             /* delay in usec to wait between write and read commands */
 
+/* look for a new pass at most once a minute [days] */
+#define PASS_LOOKUP_DT (1.0 / 1440.0)
+
 /* radio control functions */
 static void     exec_rx_cycle(GtkRigCtrl * ctrl);
 static void     exec_tx_cycle(GtkRigCtrl * ctrl);
@@ -128,6 +132,12 @@ static void gtk_rig_ctrl_destroy(GtkWidget * widget)
         ctrl->conf2 = NULL;
     }
 
+    if (ctrl->trspwatch > 0)
+    {
+        trsp_db_remove_watch(ctrl->trspwatch);
+        ctrl->trspwatch = 0;
+    }
+
     if (ctrl->trsplist != NULL)
     {
         free_transponders(ctrl->trsplist);
@@ -157,6 +167,7 @@ static void gtk_rig_ctrl_init(GtkRigCtrl * ctrl)
     ctrl->trsp = NULL;
     ctrl->trsplist = NULL;
     ctrl->trsplock = FALSE;
+    ctrl->trspwatch = 0;
     ctrl->tracking = FALSE;
     ctrl->prev_ele = 0.0;
     ctrl->sock = 0;
@@ -206,20 +217,20 @@ static void update_count_down(GtkRigCtrl * ctrl, gdouble t)
 {
     gdouble         targettime;
     gdouble         delta;
-    gchar          *buff;
+    gchar           buff[128];
     guint           h, m, s;
-    gchar          *aoslos;
+    const gchar    *aoslos;
 
     /* select AOS or LOS time depending on target elevation */
     if (ctrl->target->el < 0.0)
     {
         targettime = ctrl->target->aos;
-        aoslos = g_strdup_printf(_("AOS in"));
+        aoslos = _("AOS in");
     }
     else
     {
         targettime = ctrl->target->los;
-        aoslos = g_strdup_printf(_("LOS in"));
+        aoslos = _("LOS in");
     }
 
     delta = targettime - t;
@@ -236,19 +247,15 @@ static void update_count_down(GtkRigCtrl * ctrl, gdouble t)
     s -= 60 * m;
 
     if (h > 0)
-        buff =
-            g_strdup_printf
-            ("<span size='xx-large'><b>%s %02d:%02d:%02d</b></span>", aoslos,
-             h, m, s);
+        g_snprintf(buff, sizeof(buff),
+                   "<span size='xx-large'><b>%s %02d:%02d:%02d</b></span>",
+                   aoslos, h, m, s);
     else
-        buff =
-            g_strdup_printf("<span size='xx-large'><b>%s %02d:%02d</b></span>",
-                            aoslos, m, s);
+        g_snprintf(buff, sizeof(buff),
+                   "<span size='xx-large'><b>%s %02d:%02d</b></span>",
+                   aoslos, m, s);
 
     gtk_label_set_markup(GTK_LABEL(ctrl->SatCnt), buff);
-
-    g_free(buff);
-    g_free(aoslos);
 }
 
 /*
@@ -261,71 +268,64 @@ static void update_count_down(GtkRigCtrl * ctrl, gdouble t)
 void gtk_rig_ctrl_update(GtkRigCtrl * ctrl, gdouble t)
 {
     gdouble         satfreq;
-    gchar          *buff;
+    gchar           buff[64];
 
     g_mutex_lock(&ctrl->rig_ctrl_updatelock);
 
     if (ctrl->target)
     {
-        buff = g_strdup_printf(AZEL_FMTSTR, ctrl->target->az);
+        g_snprintf(buff, sizeof(buff), AZEL_FMTSTR, ctrl->target->az);
         gtk_label_set_text(GTK_LABEL(ctrl->SatAz), buff);
-        g_free(buff);
-        buff = g_strdup_printf(AZEL_FMTSTR, ctrl->target->el);
+        g_snprintf(buff, sizeof(buff), AZEL_FMTSTR, ctrl->target->el);
         gtk_label_set_text(GTK_LABEL(ctrl->SatEl), buff);
-        g_free(buff);
 
         update_count_down(ctrl, t);
 
         if (sat_cfg_get_bool(SAT_CFG_BOOL_USE_IMPERIAL))
         {
-            buff = g_strdup_printf("%.0f mi", KM_TO_MI(ctrl->target->range));
+            g_snprintf(buff, sizeof(buff), "%.0f mi",
+                       KM_TO_MI(ctrl->target->range));
         }
         else
         {
-            buff = g_strdup_printf("%.0f km", ctrl->target->range);
+            g_snprintf(buff, sizeof(buff), "%.0f km", ctrl->target->range);
         }
         gtk_label_set_text(GTK_LABEL(ctrl->SatRng), buff);
-        g_free(buff);
 
         if (sat_cfg_get_bool(SAT_CFG_BOOL_USE_IMPERIAL))
         {
-            buff = g_strdup_printf("%.3f mi/s",
-                                   KM_TO_MI(ctrl->target->range_rate));
+            g_snprintf(buff, sizeof(buff), "%.3f mi/s",
+                       KM_TO_MI(ctrl->target->range_rate));
         }
         else
         {
-            buff = g_strdup_printf("%.3f km/s", ctrl->target->range_rate);
+            g_snprintf(buff, sizeof(buff), "%.3f km/s",
+                       ctrl->target->range_rate);
         }
         gtk_label_set_text(GTK_LABEL(ctrl->SatRngRate), buff);
-        g_free(buff);
 
         /* Doppler shift down */
         satfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
         ctrl->dd = -satfreq * (ctrl->target->range_rate / 299792.4580); // Hz
-        buff = g_strdup_printf("%.0f Hz", ctrl->dd);
+        g_snprintf(buff, sizeof(buff), "%.0f Hz", ctrl->dd);
         gtk_label_set_text(GTK_LABEL(ctrl->SatDopDown), buff);
-        g_free(buff);
 
         /* Doppler shift up */
         satfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
         ctrl->du = satfreq * (ctrl->target->range_rate / 299792.4580);  // Hz
-        buff = g_strdup_printf("%.0f Hz", ctrl->du);
+        g_snprintf(buff, sizeof(buff), "%.0f Hz", ctrl->du);
         gtk_label_set_text(GTK_LABEL(ctrl->SatDopUp), buff);
-        g_free(buff);
 
-        /* update next pass if necessary */
-        if (ctrl->pass != NULL)
+        /* update next pass when the pass is over; the pass includes the
+           current one, and a pass that can not be found is looked for at
+           most once a minute */
+        if ((ctrl->pass == NULL || ctrl->pass->los < t) &&
+            fabs(t - ctrl->pass_t) >= PASS_LOOKUP_DT)
         {
-            if (ctrl->target->aos > ctrl->pass->aos)
-            {
+            if (ctrl->pass != NULL)
                 free_pass(ctrl->pass);
-                ctrl->pass = get_next_pass(ctrl->target, ctrl->qth, 3.0);
-            }
-        }
-        else
-        {
-            /* we don't have any current pass; store the current one */
-            ctrl->pass = get_next_pass(ctrl->target, ctrl->qth, 3.0);
+            ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
+            ctrl->pass_t = t;
         }
     }
 
@@ -612,6 +612,25 @@ static void load_trsp_list(GtkRigCtrl * ctrl)
     gtk_combo_box_set_active(GTK_COMBO_BOX(ctrl->TrspSel), 0);
 }
 
+/* Reload the transponder list if the transponders of the target changed */
+static void trsp_changed_cb(GArray * catnums, gpointer data)
+{
+    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
+    guint           i;
+
+    if (ctrl->target == NULL)
+        return;
+
+    for (i = 0; i < catnums->len; i++)
+    {
+        if (g_array_index(catnums, guint, i) == (guint) ctrl->target->tle.catnr)
+        {
+            load_trsp_list(ctrl);
+            return;
+        }
+    }
+}
+
 static gboolean have_conf()
 {
     GDir           *dir = NULL; /* directory handle */
@@ -1381,6 +1400,7 @@ static gboolean _send_rigctld_command(GtkRigCtrl * ctrl, gint sock,
 {
     gint            written;
     gint            size;
+    gint64          start = sat_trace_begin();
 
     size = strlen(buff);
 
@@ -1422,6 +1442,7 @@ static gboolean _send_rigctld_command(GtkRigCtrl * ctrl, gint sock,
                     __FILE__, __func__, size);
     }
     ctrl->wrops++;
+    sat_trace_end_arg("device", "rigctld", start, buff);
 
     return TRUE;
 }
@@ -1532,6 +1553,7 @@ static gboolean rig_ctrl_timeout_cb(gpointer data)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s missed the deadline"),
                     __func__);
+        sat_trace_instant("device", "rig missed deadline", NULL);
         return TRUE;
     }
 
@@ -2957,6 +2979,8 @@ GtkWidget      *gtk_rig_ctrl_new(GtkSatModule * module)
 
     gtk_container_add(GTK_CONTAINER(rigctrl), table);
 
+    rigctrl->trspwatch = trsp_db_add_watch(trsp_changed_cb, rigctrl);
+
     if (module->target > 0)
         gtk_rig_ctrl_select_sat(rigctrl, module->target);
 
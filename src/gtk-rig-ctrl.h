@@ -54,10 +54,12 @@ struct _gtk_rig_ctrl {
     GSList         *trsplist;   /*!< List of available transponders */
     trsp_t         *trsp;       /*!< Pointer to the current transponder configuration */
     gboolean        trsplock;   /*!< Flag indicating whether uplink and downlink are lockled */
+    guint           trspwatch;  /*!< Transponder database watch ID */
 
     GSList         *sats;       /*!< List of sats in parent module */
     sat_t          *target;     /*!< Target satellite */
     pass_t         *pass;       /*!< Next pass of target satellite */
+    gdouble         pass_t;     /*!< Time of the last pass lookup */
     qth_t          *qth;        /*!< The QTH for this module */
 
     double          prev_ele;   /*!< Previous elevation (used for AOS/LOS signalling) */
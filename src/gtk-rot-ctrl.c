@@ -55,11 +55,15 @@
 #include "gtk-rot-ctrl.h"
 #include "predict-tools.h"
 #include "sat-log.h"
+#include "sat-trace.h"
 
 
 #define FMTSTR "%7.2f\302\260"
 #define MAX_ERROR_COUNT 5
 
+/* look for a new pass at most once a minute [days] */
+#define PASS_LOOKUP_DT (1.0 / 1440.0)
+
 static GtkVBoxClass *parent_class = NULL;
 
 
@@ -158,6 +162,7 @@ static gboolean rotctld_socket_rw(gint sock, gchar * buff, gchar * buffout,
 {
     gint            written;
     gint            size;
+    gint64          start = sat_trace_begin();
 
     size = strlen(buff);
 
@@ -191,6 +196,7 @@ static gboolean rotctld_socket_rw(gint sock, gchar * buff, gchar * buffout,
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%s: Got 0 bytes from rotctld"), __FILE__, __func__);
     }
+    sat_trace_end_arg("device", "rotctld", start, buff);
 
     return TRUE;
 }
@@ -214,7 +220,7 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     pass_detail_t  *detail;
     gboolean        retval = FALSE;
 
-    num = g_slist_length(pass->details);
+    num = PASS_NUM_DETAILS(pass);
     if (type == ROT_AZ_TYPE_360)
     {
         min_az = 0;
@@ -248,7 +254,7 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     {
         for (i = 1; i < num - 1; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+            detail = PASS_NTH_DETAIL(pass, i);
             caz = detail->az;
 
             while (caz > max_az)
@@ -284,6 +290,23 @@ static inline void set_flipped_pass(GtkRotCtrl * ctrl)
                                         ctrl->conf->azstoppos);
 }
 
+/* Replace the pass with the current pass or the next one at t */
+static void update_pass(GtkRotCtrl * ctrl, gdouble t, gboolean current)
+{
+    if (ctrl->pass != NULL)
+        free_pass(ctrl->pass);
+
+    if (current)
+        ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, t);
+    else
+        ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
+    ctrl->pass_t = t;
+
+    set_flipped_pass(ctrl);
+    /* update polar plot */
+    gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot), ctrl->pass);
+}
+
 /**
  * Read rotator position from device.
  *
@@ -470,7 +493,7 @@ static void update_count_down(GtkRotCtrl * ctrl, gdouble t)
 {
     gdouble         targettime;
     gdouble         delta;
-    gchar          *buff;
+    gchar           buff[32];
     guint           h, m, s;
 
     /* select AOS or LOS time depending on target elevation */
@@ -493,13 +516,11 @@ static void update_count_down(GtkRotCtrl * ctrl, gdouble t)
     s -= 60 * m;
 
     if (h > 0)
-        buff = g_strdup_printf("%02d:%02d:%02d", h, m, s);
+        g_snprintf(buff, sizeof(buff), "%02d:%02d:%02d", h, m, s);
     else
-        buff = g_strdup_printf("%02d:%02d", m, s);
+        g_snprintf(buff, sizeof(buff), "%02d:%02d", m, s);
 
     gtk_label_set_text(GTK_LABEL(ctrl->SatCnt), buff);
-
-    g_free(buff);
 }
 
 /*
@@ -511,37 +532,29 @@ static void update_count_down(GtkRotCtrl * ctrl, gdouble t)
  */
 void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
 {
-    gchar          *buff;
+    gchar           buff[32];
 
     ctrl->t = t;
 
     if (ctrl->target)
     {
         /* update target displays */
-        buff = g_strdup_printf(FMTSTR, ctrl->target->az);
+        g_snprintf(buff, sizeof(buff), FMTSTR, ctrl->target->az);
         gtk_label_set_text(GTK_LABEL(ctrl->AzSat), buff);
-        g_free(buff);
-        buff = g_strdup_printf(FMTSTR, ctrl->target->el);
+        g_snprintf(buff, sizeof(buff), FMTSTR, ctrl->target->el);
         gtk_label_set_text(GTK_LABEL(ctrl->ElSat), buff);
-        g_free(buff);
 
         update_count_down(ctrl, t);
 
         /*if the current pass is too far away */
         if ((ctrl->pass != NULL))
             if (qth_small_dist(ctrl->qth, ctrl->pass->qth_comp) > 1.0)
-            {
-                free_pass(ctrl->pass);
-                ctrl->pass = NULL;
-                ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                if (ctrl->pass)
-                {
-                    set_flipped_pass(ctrl);
-                    /* update polar plot */
-                    gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
-                                            ctrl->pass);
-                }
-            }
+                update_pass(ctrl, t, FALSE);
+
+        /* a pass that can not be found or does not match the target would
+           otherwise be looked up again in every cycle */
+        if (fabs(t - ctrl->pass_t) < PASS_LOOKUP_DT)
+            return;
 
         /* update next pass if necessary */
         if (ctrl->pass != NULL)
@@ -554,12 +567,7 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                 if (ctrl->target->el >= 0.0)
                 {
                     /* inside an unexpected/unpredicted pass */
-                    free_pass(ctrl->pass);
-                    ctrl->pass = NULL;
-                    ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, t);
-                    set_flipped_pass(ctrl);
-                    gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
-                                            ctrl->pass);
+                    update_pass(ctrl, t, TRUE);
                 }
                 else if ((ctrl->target->aos - ctrl->pass->aos) >
                          (ctrl->delay / secday / 1000 / 4.0))
@@ -571,13 +579,7 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                        fraction of it as a threshold for deciding a new pass */
 
                     /* if the next pass is not the one for the target */
-                    free_pass(ctrl->pass);
-                    ctrl->pass = NULL;
-                    ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                    set_flipped_pass(ctrl);
-                    /* update polar plot */
-                    gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
-                                            ctrl->pass);
+                    update_pass(ctrl, t, FALSE);
                 }
             }
             else
@@ -585,28 +587,13 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                 /* inside a pass and target dropped below the 
                    horizon so look for a new pass */
                 if (ctrl->target->el < 0.0)
-                {
-                    free_pass(ctrl->pass);
-                    ctrl->pass = NULL;
-                    ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                    set_flipped_pass(ctrl);
-                    /* update polar plot */
-                    gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
-                                            ctrl->pass);
-                }
+                    update_pass(ctrl, t, FALSE);
             }
         }
         else
         {
             /* we don't have any current pass; store the current one */
-            if (ctrl->target->el > 0.0)
-                ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, t);
-            else
-                ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-
-            set_flipped_pass(ctrl);
-            /* update polar plot */
-            gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot), ctrl->pass);
+            update_pass(ctrl, t, ctrl->target->el > 0.0);
         }
     }
 }
@@ -890,7 +877,11 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
                      */
                     while (step_size > (ctrl->delay / 1000.0 / 4.0 / (secday)))
                     {
-                        predict_calc(sat, ctrl->qth, ctrl->t + time_delta);
+                        if (ctrl->ephem)
+                            ephem_cache_calc(ctrl->ephem, sat, ctrl->qth,
+                                             ctrl->t + time_delta);
+                        else
+                            predict_calc(sat, ctrl->qth, ctrl->t + time_delta);
                         /*update sat->az and sat->el to account for flips and az range */
                         if ((ctrl->flipped) && (ctrl->conf->maxel >= 180.0))
                         {
@@ -1211,6 +1202,11 @@ static void sat_selected_cb(GtkComboBox * satsel, gpointer data)
     {
         ctrl->target = SAT(g_slist_nth_data(ctrl->sats, i));
 
+        /* new ephemeris cache for lead computations */
+        ephem_cache_free(ctrl->ephem);
+        ctrl->ephem = ephem_cache_new(ctrl->target, 0.0);
+        ephem_cache_prefetch(ctrl->ephem, ctrl->t);
+
         /* update next pass */
         if (ctrl->pass != NULL)
             free_pass(ctrl->pass);
@@ -1529,6 +1525,7 @@ static void gtk_rot_ctrl_init(GtkRotCtrl * ctrl)
     ctrl->sats = NULL;
     ctrl->target = NULL;
     ctrl->pass = NULL;
+    ctrl->ephem = NULL;
     ctrl->qth = NULL;
     ctrl->plot = NULL;
 
@@ -1571,6 +1568,9 @@ static void gtk_rot_ctrl_destroy(GtkWidget * widget)
 
     g_mutex_clear(&ctrl->client.mutex);
 
+    ephem_cache_free(ctrl->ephem);
+    ctrl->ephem = NULL;
+
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -1634,6 +1634,9 @@ GtkWidget      *gtk_rot_ctrl_new(GtkSatModule * module)
     /* get next pass for target satellite */
     if (rot_ctrl->target)
     {
+        rot_ctrl->ephem = ephem_cache_new(rot_ctrl->target, 0.0);
+        ephem_cache_prefetch(rot_ctrl->ephem, rot_ctrl->t);
+
         if (rot_ctrl->target->el > 0.0)
         {
             rot_ctrl->pass = get_current_pass(rot_ctrl->target,
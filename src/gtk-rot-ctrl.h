@@ -5,6 +5,7 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "ephem-cache.h"
 #include "gtk-sat-module.h"
 #include "predict-tools.h"
 #include "rotor-conf.h"
@@ -53,6 +54,8 @@ struct _gtk_rot_ctrl {
     GSList         *sats;       /*!< List of sats in parent module */
     sat_t          *target;     /*!< Target satellite */
     pass_t         *pass;       /*!< Next pass of target satellite */
+    gdouble         pass_t;     /*!< Time of the last pass lookup */
+    ephem_cache_t  *ephem;      /*!< Ephemeris cache for target satellite */
     qth_t          *qth;        /*!< The QTH for this module */
     gboolean        flipped;    /*!< Whether the current pass loaded is a flip pass or not */
 
@@ -43,7 +43,8 @@
  * Read TLE data for a given satellite into memory.
  *
  * @param catnum The catalog number of the satellite.
- * @param sat Pointer to a valid sat_t structure.
+ * @param sat Pointer to a zeroed sat_t structure, or one that has been
+ *            cleared with gtk_sat_data_clear_sat().
  * @return 0 if successfull, 1 if an I/O error occurred,
  *         2 if the TLE data appears to be bad.
  *
@@ -265,7 +266,8 @@ void gtk_sat_data_init_sat(sat_t * sat, qth_t * qth)
  * Copy satellite data.
  *
  * @param source Pointer to the source satellite to copy data from.
- * @param dest Pointer to the destination satellite to copy data into.
+ * @param dest Pointer to the destination satellite to copy data into. It must
+ *             be zeroed or cleared with gtk_sat_data_clear_sat().
  * @param qth Pointer to the observer data (needed to initialize sat)
  *
  * This function copies the satellite data from a source sat_t structure into
@@ -334,14 +336,16 @@ void gtk_sat_data_copy_sat(const sat_t * source, sat_t * dest, qth_t * qth)
 }
 
 /**
- * Free satellite data
+ * Clear satellite data
  *
- * @param sat Pointer to the satellite data to free
- * 
- * This function frees the memory that has been dyunamically allocated
- * when creating a new satellite object.
+ * @param sat Pointer to the satellite data to clear
+ *
+ * This function frees the memory that is owned by a satellite object,
+ * i.e. the name strings and the reference to the propagator constants,
+ * but not the sat_t structure itself. Use it for satellites that live on
+ * the stack or in an array.
  */
-void gtk_sat_data_free_sat(sat_t * sat)
+void gtk_sat_data_clear_sat(sat_t * sat)
 {
     if (!sat)
         return;
@@ -362,5 +366,22 @@ void gtk_sat_data_free_sat(sat_t * sat)
         sat->website = NULL;
     }
 
+    Sat_Release(sat);
+}
+
+/**
+ * Free satellite data
+ *
+ * @param sat Pointer to the satellite data to free
+ * 
+ * This function frees the memory that has been dyunamically allocated
+ * when creating a new satellite object.
+ */
+void gtk_sat_data_free_sat(sat_t * sat)
+{
+    if (!sat)
+        return;
+
+    gtk_sat_data_clear_sat(sat);
     g_free(sat);
 }
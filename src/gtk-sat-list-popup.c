@@ -75,6 +75,8 @@ void gtk_sat_list_popup_exec(sat_t * sat, qth_t * qth, GdkEventButton * event,
 
     /* add the menu items for current,next, and future passes. */
     add_pass_menu_items(menu, sat, qth, &list->tstamp, GTK_WIDGET(list));
+    add_link_menu_item(menu, sat, list->satellites, &list->tstamp,
+                       GTK_WIDGET(list));
 
     gtk_widget_show_all(menu);
 
@@ -563,9 +563,9 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
                                      GtkTreeIter * iter, gpointer data)
 {
     GtkSatList     *satlist = GTK_SAT_LIST(data);
-    guint          *catnum;
+    guint           catnum;
     sat_t          *sat;
-    gchar          *buff;
+    const gchar    *dir;
     gdouble         doppler;
     gdouble         delay;
     gdouble         loss;
@@ -577,21 +577,20 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
     /* get the catalogue number for this row
        then look it up in the hash table
      */
-    catnum = g_new0(guint, 1);
-    gtk_tree_model_get(model, iter, SAT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT(g_hash_table_lookup(satlist->satellites, catnum));
+    gtk_tree_model_get(model, iter, SAT_LIST_COL_CATNUM, &catnum, -1);
+    sat = SAT(g_hash_table_lookup(satlist->satellites, &catnum));
 
     if (sat == NULL)
     {
         /* satellite not tracked anymore => remove */
         sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s: Failed to get data for #%d."), __func__, *catnum);
+                    _("%s: Failed to get data for #%d."), __func__, catnum);
 
         gtk_list_store_remove(GTK_LIST_STORE(model), iter);
 
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: Satellite #%d removed from list."), __func__,
-                    *catnum);
+                    catnum);
     }
     else
     {
@@ -644,16 +643,16 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
         {
             if (sat->otype == ORBIT_TYPE_GEO)
             {
-                buff = g_strdup("G");
+                dir = "G";
             }
             else if (decayed(sat))
             {
-                buff = g_strdup("D");
+                dir = "D";
             }
             else if (sat->range_rate > 0.001)
             {
                 /* going down */
-                buff = g_strdup("\342\206\223");
+                dir = "\342\206\223";
             }
             else if ((sat->range_rate <= 0.001) && (sat->range_rate >= -0.001))
             {
@@ -663,37 +662,32 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
                 if (sat->range_rate < oldrate)
                 {
                     /* starting to approach */
-                    buff = g_strdup("\342\206\272");
+                    dir = "\342\206\272";
                 }
                 else
                 {
                     /* to receed */
-                    buff = g_strdup("\342\206\267");
+                    dir = "\342\206\267";
                 }
             }
             else if (sat->range_rate < -0.001)
             {
                 /* coming up */
-                buff = g_strdup("\342\206\221");
+                dir = "\342\206\221";
             }
             else
             {
-                buff = g_strdup("-");
+                dir = "-";
             }
 
             gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_DIR,
-                               buff, -1);
-
-            /* free memory */
-            g_free(buff);
-
+                               dir, -1);
         }
 
         /* SSP locator */
         if (satlist->flags & SAT_LIST_FLAG_SSP)
         {
-
-            buff = g_try_malloc(7);
+            gchar           buff[7];
 
             retcode = longlat2locator(sat->ssplon, sat->ssplat, buff, 3);
             if (retcode == RIG_OK)
@@ -702,7 +696,6 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
                 gtk_list_store_set(GTK_LIST_STORE(model), iter,
                                    SAT_LIST_COL_SSP, buff, -1);
             }
-            g_free(buff);
         }
 
         /* Ra and Dec */
@@ -737,22 +730,19 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
         {
             gdouble         number;
             gchar           buff[TIME_FORMAT_MAX_LENGTH];
-            gchar          *tfstr;
-            gchar          *fmtstr;
-            gchar          *alstr;
-
+            gsize           len;
 
             if (sat->aos > sat->los)
             {
                 /* next event is LOS */
                 number = sat->los;
-                alstr = g_strdup("LOS: ");
+                len = g_strlcpy(buff, "LOS: ", sizeof(buff));
             }
             else
             {
                 /* next event is AOS */
                 number = sat->aos;
-                alstr = g_strdup("AOS: ");
+                len = g_strlcpy(buff, "AOS: ", sizeof(buff));
             }
 
             if (number == 0.0)
@@ -762,38 +752,29 @@ static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
             }
             else
             {
-
-                /* format the number */
-                tfstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-                fmtstr = g_strconcat(alstr, tfstr, NULL);
-                g_free(tfstr);
-
-                daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, number);
+                /* format the number after the prefix */
+                daynum_to_str(buff + len, sizeof(buff) - len,
+                              sat_cfg_peek_str(SAT_CFG_STR_TIME_FORMAT),
+                              number);
 
                 gtk_list_store_set(GTK_LIST_STORE(model), iter,
                                    SAT_LIST_COL_NEXT_EVENT, buff, -1);
-
-
-                g_free(fmtstr);
             }
-
-            g_free(alstr);
         }
 
         if (satlist->flags & SAT_LIST_FLAG_VISIBILITY)
         {
             sat_vis_t       vis;
+            gchar           buff[2];
 
             vis = get_sat_vis(sat, satlist->qth, sat->jul_utc);
-            buff = g_strdup_printf("%c", vis_to_chr(vis));
+            buff[0] = vis_to_chr(vis);
+            buff[1] = '\0';
             gtk_list_store_set(GTK_LIST_STORE(model), iter,
                                SAT_LIST_COL_VISIBILITY, buff, -1);
-            g_free(buff);
         }
     }
 
-    g_free(catnum);
-
     /* Return value not documented what to return, but it seems that
        FALSE continues to next row while TRUE breaks
      */
@@ -1124,7 +1105,6 @@ static void event_cell_data_function(GtkTreeViewColumn * col,
 {
     gdouble         number;
     gchar           buff[TIME_FORMAT_MAX_LENGTH];
-    gchar          *fmtstr;
     guint           coli = GPOINTER_TO_UINT(column);
 
     (void)col;                  /* avoid unusued parameter compiler warning */
@@ -1138,13 +1118,10 @@ static void event_cell_data_function(GtkTreeViewColumn * col,
     else
     {
         /* format the number */
-        fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-
-        daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, number);
+        daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH,
+                      sat_cfg_peek_str(SAT_CFG_STR_TIME_FORMAT), number);
 
         g_object_set(renderer, "text", buff, NULL);
-
-        g_free(fmtstr);
     }
 
 }
@@ -43,6 +43,7 @@
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "sat-trace.h"
 #include "sgpsdp/sgp4sdp4.h"
 
 
@@ -73,6 +74,11 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     double          t0;         /* time when this_orbit starts */
     double          t;
     ssp_t          *this_ssp;
+    GSList         *node;
+    GArray         *track;
+    const gdouble  *cached;
+    guint           i, len;
+    gint64          start = sat_trace_begin();
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: Creating ground track for %s"),
@@ -93,6 +99,28 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: End orbit %d"), __func__, max_orbit);
 
+    /* the track saved for this orbit by a previous session */
+    cached = pred_cache_get_track(satmap->pcache, sat, this_orbit,
+                                  max_orbit - this_orbit + 1, &len);
+    if (cached != NULL)
+    {
+        for (i = 0; i < len; i++)
+        {
+            this_ssp = g_new(ssp_t, 1);
+            this_ssp->lat = cached[2 * i];
+            this_ssp->lon = cached[2 * i + 1];
+            obj->track_data.latlon =
+                g_slist_prepend(obj->track_data.latlon, this_ssp);
+        }
+        obj->track_data.latlon = g_slist_reverse(obj->track_data.latlon);
+        create_polylines(satmap, sat, qth, obj);
+        obj->track_orbit = this_orbit;
+        sat_trace_end_arg("map", "cached ground track", start,
+                          sat->nickname);
+
+        return;
+    }
+
     /* find the time when the current orbit started */
 
     /* Iterate backwards in time until we reach sat->orbit < this_orbit.
@@ -162,11 +190,24 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     /* reverse GSList */
     obj->track_data.latlon = g_slist_reverse(obj->track_data.latlon);
 
+    /* save the track for the next session */
+    track = g_array_sized_new(FALSE, FALSE, sizeof(gdouble),
+                              2 * g_slist_length(obj->track_data.latlon));
+    for (node = obj->track_data.latlon; node != NULL; node = node->next)
+    {
+        this_ssp = node->data;
+        g_array_append_val(track, this_ssp->lat);
+        g_array_append_val(track, this_ssp->lon);
+    }
+    pred_cache_put_track(satmap->pcache, sat, this_orbit,
+                         max_orbit - this_orbit + 1, track);
+
     /* split points into polylines */
     create_polylines(satmap, sat, qth, obj);
 
     /* misc book-keeping */
     obj->track_orbit = this_orbit;
+    sat_trace_end_arg("map", "ground track", start, sat->nickname);
 }
 
 /**
@@ -88,6 +88,8 @@ void gtk_sat_map_popup_exec(sat_t * sat, qth_t * qth,
 
     /* add the menu items for current,next, and future passes. */
     add_pass_menu_items(menu, sat, qth, &satmap->tstamp, GTK_WIDGET(satmap));
+    add_link_menu_item(menu, sat, satmap->sats, &satmap->tstamp,
+                       GTK_WIDGET(satmap));
 
     /* separator */
     menuitem = gtk_separator_menu_item_new();
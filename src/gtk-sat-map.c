@@ -51,6 +51,9 @@
 /* Update terminator every 30 seconds */
 #define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
 
+/* Size of the next event and selected satellite texts */
+#define INFO_TEXT_LEN 512
+
 static void     gtk_sat_map_class_init(GtkSatMapClass * class);
 static void     gtk_sat_map_init(GtkSatMap * polview);
 static void     gtk_sat_map_destroy(GtkWidget * widget);
@@ -63,6 +66,9 @@ static void     lonlat_to_xy(GtkSatMap * m, gdouble lon, gdouble lat,
                              gfloat * x, gfloat * y);
 static void     xy_to_lonlat(GtkSatMap * m, gfloat x, gfloat y, gfloat * lon,
                              gfloat * lat);
+static gboolean on_query_tooltip(GooCanvasItem * item, gdouble x, gdouble y,
+                                 gboolean keyboard_mode, GtkTooltip * tooltip,
+                                 gpointer data);
 static gboolean on_motion_notify(GooCanvasItem * item, GooCanvasItem * target,
                                  GdkEventMotion * event, gpointer data);
 static void     on_item_created(GooCanvas * canvas, GooCanvasItem * item,
@@ -89,11 +95,9 @@ static void     sort_points_x(GtkSatMap * satmap, sat_t * sat,
                               GooCanvasPoints * points, gint num);
 static void     sort_points_y(GtkSatMap * satmap, sat_t * sat,
                               GooCanvasPoints * points, gint num);
-static gint     compare_coordinates_x(gconstpointer a, gconstpointer b,
-                                      gpointer data);
-static gint     compare_coordinates_y(gconstpointer a, gconstpointer b,
-                                      gpointer data);
-static void     update_selected(GtkSatMap * satmap, sat_t * sat);
+static void     sort_coords(gdouble * coords, gint num, gint axis);
+static void     update_selected(GtkSatMap * satmap, sat_t * sat,
+                                sat_map_obj_t * obj);
 static void     draw_grid_lines(GtkSatMap * satmap, GooCanvasItemModel * root);
 static void     redraw_grid_lines(GtkSatMap * satmap);
 static void     draw_terminator(GtkSatMap * satmap, GooCanvasItemModel * root);
@@ -103,12 +107,15 @@ static void     gtk_sat_map_load_showtracks(GtkSatMap * map);
 static void     gtk_sat_map_store_showtracks(GtkSatMap * satmap);
 static void     gtk_sat_map_load_hide_coverages(GtkSatMap * map);
 static void     gtk_sat_map_store_hidecovs(GtkSatMap * satmap);
-static void     reset_ground_track(gpointer key, gpointer value,
+static void     reset_sat_obj(gpointer key, gpointer value,
                                    gpointer user_data);
 
 static GtkVBoxClass *parent_class = NULL;
-static GooCanvasPoints *points1;
-static GooCanvasPoints *points2;
+
+/* footprint points shared by all maps; they are allocated once with 360
+   points and num_points is the number of points in use */
+static GooCanvasPoints *points1 = NULL;
+static GooCanvasPoints *points2 = NULL;
 
 
 GType gtk_sat_map_get_type()
@@ -151,6 +158,7 @@ static void gtk_sat_map_init(GtkSatMap * satmap)
 {
     satmap->sats = NULL;
     satmap->qth = NULL;
+    satmap->pcache = NULL;
     satmap->obj = NULL;
     satmap->showtracks = g_hash_table_new_full(g_int_hash, g_int_equal,
                                                NULL, NULL);
@@ -159,6 +167,7 @@ static void gtk_sat_map_init(GtkSatMap * satmap)
     satmap->naos = 0.0;
     satmap->ncat = 0;
     satmap->tstamp = 2458849.5;
+    satmap->scrubbing = FALSE;
     satmap->x0 = 0;
     satmap->y0 = 0;
     satmap->width = 0;
@@ -172,12 +181,16 @@ static void gtk_sat_map_init(GtkSatMap * satmap)
     satmap->showgrid = FALSE;
     satmap->keepratio = FALSE;
     satmap->resize = FALSE;
+    satmap->tracks_deferred = FALSE;
+    satmap->overlay = NULL;
+    satmap->overlayimg = NULL;
 }
 
 static void gtk_sat_map_destroy(GtkWidget * widget)
 {
     gtk_sat_map_store_showtracks(GTK_SAT_MAP(widget));
     gtk_sat_map_store_hidecovs(GTK_SAT_MAP(widget));
+    g_clear_object(&GTK_SAT_MAP(widget)->overlay);
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -464,6 +477,19 @@ static void update_map_size(GtkSatMap * satmap)
                      "y", (gdouble) satmap->y0, NULL);
         g_object_unref(pbuf);
 
+        if (satmap->overlay != NULL)
+        {
+            pbuf = gdk_pixbuf_scale_simple(satmap->overlay,
+                                           satmap->width,
+                                           satmap->height,
+                                           GDK_INTERP_BILINEAR);
+            g_object_set(satmap->overlayimg,
+                         "pixbuf", pbuf,
+                         "x", (gdouble) satmap->x0,
+                         "y", (gdouble) satmap->y0, NULL);
+            g_object_unref(pbuf);
+        }
+
         redraw_grid_lines(satmap);
 
         if (satmap->show_terminator)
@@ -513,11 +539,11 @@ void gtk_sat_map_update(GtkWidget * widget)
 {
     GtkSatMap      *satmap = GTK_SAT_MAP(widget);
     sat_t          *sat = NULL;
+    sat_map_obj_t  *obj = NULL;
     gdouble         number, now;
-    gchar          *buff;
-    gint           *catnr;
+    gchar           buff[INFO_TEXT_LEN];
     guint           h, m, s;
-    gchar          *ch, *cm, *cs;
+    const gchar    *ch, *cm, *cs;
     gfloat          x, y;
     gdouble         oldx, oldy;
 
@@ -542,6 +568,14 @@ void gtk_sat_map_update(GtkWidget * widget)
         satmap->counter = satmap->refresh;
     }
 
+    /* refresh right away when scrubbing has ended so that the ground tracks
+       deferred while scrubbing are recalculated */
+    if (satmap->tracks_deferred && !satmap->scrubbing)
+    {
+        satmap->tracks_deferred = FALSE;
+        satmap->counter = satmap->refresh;
+    }
+
     /* check refresh rate and refresh sats/qth if time */
     /* FIXME add location check */
     if (satmap->counter < satmap->refresh)
@@ -579,13 +613,12 @@ void gtk_sat_map_update(GtkWidget * widget)
         {
             if (satmap->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = satmap->ncat;
-                sat = SAT(g_hash_table_lookup(satmap->sats, catnr));
-                g_free(catnr);
+                sat = SAT(g_hash_table_lookup(satmap->sats, &satmap->ncat));
+                obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj,
+                                                      &satmap->ncat));
 
                 /* last desperate sanity check */
-                if (sat != NULL)
+                if (sat != NULL && obj != NULL)
                 {
                     now = satmap->tstamp;       //get_current_daynum ();
                     number = satmap->naos - now;
@@ -599,9 +632,9 @@ void gtk_sat_map_update(GtkWidget * widget)
 
                     /* leading zero */
                     if ((h > 0) && (h < 10))
-                        ch = g_strdup("0");
+                        ch = "0";
                     else
-                        ch = g_strdup("");
+                        ch = "";
 
                     /* extract minutes */
                     m = (guint) floor(s / 60);
@@ -609,39 +642,30 @@ void gtk_sat_map_update(GtkWidget * widget)
 
                     /* leading zero */
                     if (m < 10)
-                        cm = g_strdup("0");
+                        cm = "0";
                     else
-                        cm = g_strdup("");
+                        cm = "";
 
                     /* leading zero */
                     if (s < 10)
-                        cs = g_strdup(":0");
+                        cs = ":0";
                     else
-                        cs = g_strdup(":");
+                        cs = ":";
 
                     if (h > 0)
-                        buff =
-                            g_markup_printf_escaped(_
-                                                    ("<span background=\"#%s\"> "
-                                                     "Next: %s in %s%d:%s%d%s%d </span>"),
-                                                    satmap->infobgd,
-                                                    sat->nickname, ch, h, cm,
-                                                    m, cs, s);
+                        g_snprintf(buff, sizeof(buff),
+                                   _("<span background=\"#%s\"> "
+                                     "Next: %s in %s%d:%s%d%s%d </span>"),
+                                   satmap->infobgd, obj->nickname, ch, h, cm,
+                                   m, cs, s);
                     else
-                        buff =
-                            g_markup_printf_escaped(_
-                                                    ("<span background=\"#%s\"> "
-                                                     "Next: %s in %s%d%s%d </span>"),
-                                                    satmap->infobgd,
-                                                    sat->nickname, cm, m, cs,
-                                                    s);
+                        g_snprintf(buff, sizeof(buff),
+                                   _("<span background=\"#%s\"> "
+                                     "Next: %s in %s%d%s%d </span>"),
+                                   satmap->infobgd, obj->nickname, cm, m, cs,
+                                   s);
 
                     g_object_set(satmap->next, "text", buff, NULL);
-
-                    g_free(buff);
-                    g_free(ch);
-                    g_free(cm);
-                    g_free(cs);
                 }
                 else
                 {
@@ -750,9 +774,58 @@ static void on_item_created(GooCanvas * canvas,
                          (GCallback) on_button_press, data);
         g_signal_connect(item, "button_release_event",
                          (GCallback) on_button_release, data);
+        g_signal_connect(item, "query-tooltip",
+                         (GCallback) on_query_tooltip, data);
     }
 }
 
+/*
+ * Show the tooltip of a satellite marker or label.
+ *
+ * The tooltip is built when it is shown rather than on every update of the
+ * map.
+ */
+static gboolean on_query_tooltip(GooCanvasItem * item, gdouble x, gdouble y,
+                                 gboolean keyboard_mode, GtkTooltip * tooltip,
+                                 gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
+    sat_map_obj_t  *obj;
+    sat_t          *sat;
+    gint            catnum;
+    gchar          *aosstr;
+    gchar          *text;
+
+    (void)x;
+    (void)y;
+    (void)keyboard_mode;
+
+    catnum = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
+    sat = SAT(g_hash_table_lookup(satmap->sats, &catnum));
+
+    if (obj == NULL || sat == NULL ||
+        (model != obj->marker && model != obj->label))
+        return FALSE;
+
+    aosstr = aoslos_time_to_str(satmap, sat);
+    text = g_markup_printf_escaped("<b>%s</b>\n"
+                                   "Lon: %5.1f\302\260\n"
+                                   "Lat: %5.1f\302\260\n"
+                                   " Az: %5.1f\302\260\n"
+                                   " El: %5.1f\302\260\n"
+                                   "%s",
+                                   sat->nickname,
+                                   sat->ssplon, sat->ssplat,
+                                   sat->az, sat->el, aosstr);
+    gtk_tooltip_set_markup(tooltip, text);
+    g_free(text);
+    g_free(aosstr);
+
+    return TRUE;
+}
+
 static gboolean on_button_press(GooCanvasItem * item,
                                 GooCanvasItem * target, GdkEventButton * event,
                                 gpointer data)
@@ -1177,6 +1250,18 @@ static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
     return warped;
 }
 
+/* Prepare the footprint points for a new footprint */
+static void reset_footprint_points(void)
+{
+    if (points1 == NULL)
+    {
+        points1 = goo_canvas_points_new(360);
+        points2 = goo_canvas_points_new(360);
+    }
+    points1->num_points = 360;
+    points2->num_points = 360;
+}
+
 /**
  * Calculate satellite footprint and coverage area.
  *
@@ -1320,7 +1405,7 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
  */
 static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 {
-    GooCanvasPoints *tps1, *tps2;
+    gdouble         tps1[720], tps2[720];
     gint            n, n1, n2, ns, i, j, k;
 
     /* initialize parameters */
@@ -1331,8 +1416,6 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
     j = 0;
     k = 0;
     ns = 0;
-    tps1 = goo_canvas_points_new(n);
-    tps2 = goo_canvas_points_new(n);
 
     //if ((sspx >= (satmap->x0 + satmap->width - 0.6)) ||
     //    (sspx >= (satmap->x0 - 0.6))) {
@@ -1349,14 +1432,14 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
         {
             if (points1->coords[2 * i] > (satmap->x0 + satmap->width / 2))
             {
-                tps1->coords[2 * n1] = points1->coords[2 * i];
-                tps1->coords[2 * n1 + 1] = points1->coords[2 * i + 1];
+                tps1[2 * n1] = points1->coords[2 * i];
+                tps1[2 * n1 + 1] = points1->coords[2 * i + 1];
                 n1++;
             }
             else
             {
-                tps2->coords[2 * n2] = points1->coords[2 * i];
-                tps2->coords[2 * n2 + 1] = points1->coords[2 * i + 1];
+                tps2[2 * n2] = points1->coords[2 * i];
+                tps2[2 * n2 + 1] = points1->coords[2 * i + 1];
                 n2++;
             }
         }
@@ -1383,8 +1466,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         while (points1->coords[2 * i] > (satmap->x0 + satmap->width / 2))
         {
-            tps2->coords[2 * j] = points1->coords[2 * i];
-            tps2->coords[2 * j + 1] = points1->coords[2 * i + 1];
+            tps2[2 * j] = points1->coords[2 * i];
+            tps2[2 * j + 1] = points1->coords[2 * i + 1];
             i++;
             j++;
             n2++;
@@ -1392,8 +1475,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         while (i < n)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1->coords[2 * i];
+            tps1[2 * k + 1] = points1->coords[2 * i + 1];
             i++;
             k++;
             n1++;
@@ -1401,8 +1484,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         for (i = 0; i <= ns; i++)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1->coords[2 * i];
+            tps1[2 * k + 1] = points1->coords[2 * i + 1];
             k++;
             n1++;
         }
@@ -1426,8 +1509,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         while (points1->coords[2 * i] < (satmap->x0 + satmap->width / 2))
         {
-            tps2->coords[2 * j] = points1->coords[2 * i];
-            tps2->coords[2 * j + 1] = points1->coords[2 * i + 1];
+            tps2[2 * j] = points1->coords[2 * i];
+            tps2[2 * j + 1] = points1->coords[2 * i + 1];
             i--;
             j++;
             n2++;
@@ -1435,8 +1518,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         while (i >= 0)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1->coords[2 * i];
+            tps1[2 * k + 1] = points1->coords[2 * i + 1];
             i--;
             k++;
             n1++;
@@ -1444,8 +1527,8 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
         for (i = n - 1; i >= ns; i--)
         {
-            tps1->coords[2 * k] = points1->coords[2 * i];
-            tps1->coords[2 * k + 1] = points1->coords[2 * i + 1];
+            tps1[2 * k] = points1->coords[2 * i];
+            tps1[2 * k + 1] = points1->coords[2 * i + 1];
             k++;
             n1++;
         }
@@ -1453,25 +1536,20 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 
     //g_print ("NS:%d  N1:%d  N2:%d\n", ns, n1, n2);
 
-    /* free points and copy new contents */
-    goo_canvas_points_unref(points1);
-    goo_canvas_points_unref(points2);
-
-    points1 = goo_canvas_points_new(n1);
+    /* copy new contents */
+    points1->num_points = n1;
     for (i = 0; i < n1; i++)
     {
-        points1->coords[2 * i] = tps1->coords[2 * i];
-        points1->coords[2 * i + 1] = tps1->coords[2 * i + 1];
+        points1->coords[2 * i] = tps1[2 * i];
+        points1->coords[2 * i + 1] = tps1[2 * i + 1];
     }
-    goo_canvas_points_unref(tps1);
 
-    points2 = goo_canvas_points_new(n2);
+    points2->num_points = n2;
     for (i = 0; i < n2; i++)
     {
-        points2->coords[2 * i] = tps2->coords[2 * i];
-        points2->coords[2 * i + 1] = tps2->coords[2 * i + 1];
+        points2->coords[2 * i] = tps2[2 * i];
+        points2->coords[2 * i + 1] = tps2[2 * i + 1];
     }
-    goo_canvas_points_unref(tps2);
 
     /* stretch end points to map borders */
     if (points1->coords[0] > (satmap->x0 + satmap->width / 2))
@@ -1519,11 +1597,7 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx)
 static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
                           GooCanvasPoints * points, gint num)
 {
-    gsize           size = 2 * sizeof(double);
-
-    /* call g_qsort_with_data, which warps the qsort function
-       from stdlib */
-    g_qsort_with_data(points->coords, num, size, compare_coordinates_x, NULL);
+    sort_coords(points->coords, num, 0);
 
     /* move point at position 0 to position 1 */
     points->coords[2] = satmap->x0;
@@ -1570,92 +1644,41 @@ static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
 static void sort_points_y(GtkSatMap * satmap, sat_t * sat,
                           GooCanvasPoints * points, gint num)
 {
-    gsize           size;
-
     (void)satmap;
     (void)sat;
-    size = 2 * sizeof(double);
 
-    /* call g_qsort_with_data, which warps the qsort function
-       from stdlib */
-    g_qsort_with_data(points->coords, num, size, compare_coordinates_y, NULL);
+    sort_coords(points->coords, num, 1);
 }
 
 /**
- * Compare two X coordinates.
+ * Sort coordinate pairs.
  *
- * @param a Pointer to one coordinate (x,y) both double.
- * @param b Pointer to the second coordinate (x,y) both double.
- * @param data User data; always NULL.
- * @return Negative value if a < b; zero if a = b; positive value if a > b. 
- *
- * This function is used by the g_qsort_with_data function to compare two
- * elements in the coordinate array of the GooCanvasPoints structure. We have
- * to remember that GooCanvasPoints->coords is an array of XY values, i.e.
- * [X0,Y0,X1,Y1,...,Xn,Yn], but we only want to sort according to the X
- * coordinate. Therefore, we let the g_qsort_with_data believe that the whole
- * pair is one element (which is OK even according to the API docs) but we
- * cast the pointers to an array with two elements and compare only the first
- * one (x).
+ * @param coords Array of XY values, i.e. [X0,Y0,X1,Y1,...,Xn,Yn].
+ * @param num The number of pairs.
+ * @param axis 0 to sort according to X, 1 according to Y.
  *
+ * This is an insertion sort of the pairs. Unlike g_qsort_with_data it does
+ * not allocate memory; the footprint points are mostly in order already.
  */
-static gint compare_coordinates_x(gconstpointer a, gconstpointer b,
-                                  gpointer data)
+static void sort_coords(gdouble * coords, gint num, gint axis)
 {
-    double         *ea = (double *)a;
-    double         *eb = (double *)b;
-
-    (void)data;
+    gdouble         x, y, key;
+    gint            i, j;
 
-    if (ea[0] < eb[0])
-    {
-        return -1;
-    }
-    else if (ea[0] > eb[0])
+    for (i = 1; i < num; i++)
     {
-        return 1;
-    }
-
-    return 0;
-}
-
-/**
- * Compare two Y coordinates.
- *
- * @param a Pointer to one coordinate (x,y) both double.
- * @param b Pointer to the second coordinate (x,y) both double.
- * @param data User data; always NULL.
- * @return Negative value if a < b; zero if a = b; positive value if a > b. 
- *
- * This function is used by the g_qsort_with_data function to compare two
- * elements in the coordinate array of the GooCanvasPoints structure. We have
- * to remember that GooCanvasPoints->coords is an array of XY values, i.e.
- * [X0,Y0,X1,Y1,...,Xn,Yn], but we only want to sort according to the Y
- * coordinate. Therefore, we let the g_qsort_with_data believe that the whole
- * pair is one element (which is OK even according to the API docs) but we
- * cast the pointers to an array with two elements and compare only the second
- * one (y).
- *
- */
-static gint compare_coordinates_y(gconstpointer a, gconstpointer b,
-                                  gpointer data)
-{
-    double         *ea = (double *)a;
-    double         *eb = (double *)b;
+        x = coords[2 * i];
+        y = coords[2 * i + 1];
+        key = axis ? y : x;
 
-    (void)data;
-
-    if (ea[1] < eb[1])
-    {
-        return -1;
-    }
-
-    else if (ea[1] > eb[1])
-    {
-        return 1;
+        for (j = i; j > 0 && coords[2 * (j - 1) + axis] > key; j--)
+        {
+            coords[2 * j] = coords[2 * (j - 1)];
+            coords[2 * j + 1] = coords[2 * (j - 1) + 1];
+        }
+        coords[2 * j] = x;
+        coords[2 * j + 1] = y;
     }
-
-    return 0;
 }
 
 /**
@@ -1678,7 +1701,6 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     gint           *catnum;
     guint32         col, covcol, shadowcol;
     gfloat          x, y;
-    gchar          *tooltip;
 
     (void)key;
 
@@ -1728,6 +1750,7 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     obj->track_data.latlon = NULL;
     obj->track_data.lines = NULL;
     obj->track_orbit = 0;
+    obj->nickname = g_markup_escape_text(sat->nickname, -1);
 
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
@@ -1761,16 +1784,6 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                 MOD_CFG_MAP_SHADOW_ALPHA,
                                 SAT_CFG_INT_MAP_SHADOW_ALPHA);
 
-    /* create tooltip */
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el);
-
     /* create satellite marker and label + shadows. We create shadows first */
     obj->shadowm = goo_canvas_rect_model_new(root,
                                              x - MARKER_SIZE_HALF + 1,
@@ -1786,8 +1799,7 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                             2 * MARKER_SIZE_HALF,
                                             2 * MARKER_SIZE_HALF,
                                             "fill-color-rgba", col,
-                                            "stroke-color-rgba", col,
-                                            "tooltip", tooltip, NULL);
+                                            "stroke-color-rgba", col, NULL);
 
     obj->shadowl = goo_canvas_text_model_new(root, sat->nickname,
                                              x + 1,
@@ -1803,21 +1815,15 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
                                            -1,
                                            GOO_CANVAS_ANCHOR_NORTH,
                                            "font", "Sans 8",
-                                           "fill-color-rgba", col,
-                                           "tooltip", tooltip, NULL);
-
-    g_free(tooltip);
+                                           "fill-color-rgba", col, NULL);
 
     g_object_set_data(G_OBJECT(obj->marker), "catnum",
                       GINT_TO_POINTER(*catnum));
     g_object_set_data(G_OBJECT(obj->label), "catnum",
                       GINT_TO_POINTER(*catnum));
 
-    /* initialize points for footprint */
-    points1 = goo_canvas_points_new(360);
-    points2 = goo_canvas_points_new(360);
-
     /* calculate footprint */
+    reset_footprint_points();
     obj->newrcnum = calculate_footprint(satmap, sat);
     obj->oldrcnum = obj->newrcnum;
 
@@ -1859,9 +1865,6 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
 
     }
 
-    goo_canvas_points_unref(points1);
-    goo_canvas_points_unref(points2);
-
     /* add sat to hash table */
     g_hash_table_insert(satmap->obj, catnum, obj);
 }
@@ -1869,7 +1872,7 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
 /** Update a given satellite. */
 static void update_sat(gpointer key, gpointer value, gpointer data)
 {
-    gint           *catnum;
+    gint            catnum;
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
     sat_t          *sat = SAT(value);
@@ -1879,15 +1882,12 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     GooCanvasItemModel *root;
     gint            idx;
     guint32         col, covcol;
-    gchar          *tooltip;
-    gchar          *aosstr;
 
     //gdouble sspla,ssplo;
 
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
+    catnum = sat->tle.catnr;
 
     now = satmap->tstamp;
 
@@ -1901,7 +1901,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catnum));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
 
     /* get rid of a decayed satellite */
     if (decayed(sat) && obj != NULL)
@@ -1924,12 +1924,13 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         idx = goo_canvas_item_model_find_child(root, obj->range2);
         if (idx != -1)
             goo_canvas_item_model_remove_child(root, idx);
-        g_hash_table_remove(satmap->obj, catnum);
+        g_hash_table_remove(satmap->obj, &catnum);
         if (obj->showtrack)
             ground_track_update(satmap, sat, satmap->qth, obj, TRUE);
+        g_free(obj->nickname);
         g_free(obj);
 
-        g_hash_table_remove(satmap->obj, catnum);
+        g_hash_table_remove(satmap->obj, &catnum);
         return;
     }
 
@@ -1951,27 +1952,9 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     if (obj->selected)
     {
         /* update satmap->sel */
-        update_selected(satmap, sat);
+        update_selected(satmap, sat, obj);
     }
 
-    g_object_set(obj->label, "text", sat->nickname, NULL);
-    g_object_set(obj->shadowl, "text", sat->nickname, NULL);
-
-    aosstr = aoslos_time_to_str(satmap, sat);
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260\n"
-                                      "%s",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el, aosstr);
-    g_object_set(obj->marker, "tooltip", tooltip, NULL);
-    g_object_set(obj->label, "tooltip", tooltip, NULL);
-    g_free(tooltip);
-    g_free(aosstr);
-
     lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &x, &y);
 
     /* update only if satellite has moved at least
@@ -2032,11 +2015,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                          "anchor", GOO_CANVAS_ANCHOR_NORTH, NULL);
         }
 
-        /* initialize points for footprint */
-        points1 = goo_canvas_points_new(360);
-        points2 = goo_canvas_points_new(360);
-
         /* calculate footprint */
+        reset_footprint_points();
         obj->newrcnum = calculate_footprint(satmap, sat);
 
         /* always update first part */
@@ -2085,7 +2065,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                                                             CAIRO_LINE_JOIN_MITER,
                                                             NULL);
                 g_object_set_data(G_OBJECT(obj->range2), "catnum",
-                                  GINT_TO_POINTER(*catnum));
+                                  GINT_TO_POINTER(catnum));
             }
             else
             {
@@ -2108,17 +2088,20 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
 
         /* update rc-number */
         obj->oldrcnum = obj->newrcnum;
-
-        goo_canvas_points_unref(points1);
-        goo_canvas_points_unref(points2);
     }
 
     /* if ground track is visible check whether we have passed into a
-       new orbit, in which case we need to recalculate the ground track
+       new orbit, in which case we need to recalculate the ground track;
+       while scrubbing this is deferred until scrubbing ends, since the
+       orbit may change in every cycle
      */
     if (obj->showtrack)
     {
-        if (obj->track_orbit != sat->orbit)
+        if (obj->track_orbit != sat->orbit && satmap->scrubbing)
+        {
+            satmap->tracks_deferred = TRUE;
+        }
+        else if (obj->track_orbit != sat->orbit)
         {
             ground_track_update(satmap, sat, satmap->qth, obj, TRUE);
         }
@@ -2128,8 +2111,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             ground_track_update(satmap, sat, satmap->qth, obj, FALSE);
         }
     }
-
-    g_free(catnum);
 }
 
 /**
@@ -2137,12 +2118,15 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
  *
  * @param satmap Pointer to the GtkSatMap widget.
  * @param sat Pointer to the selected satellite
+ * @param obj The map object of the satellite.
  */
-static void update_selected(GtkSatMap * satmap, sat_t * sat)
+static void update_selected(GtkSatMap * satmap, sat_t * sat,
+                            sat_map_obj_t * obj)
 {
     guint           h, m, s;
-    gchar          *ch, *cm, *cs;
-    gchar          *alsstr, *text;
+    const gchar    *ch, *cm, *cs;
+    const gchar    *alsstr;
+    gchar           text[INFO_TEXT_LEN];
     gdouble         number, now;
     gboolean        isgeo = FALSE;      /* set to TRUE if satellite appears to be GEO */
 
@@ -2153,7 +2137,7 @@ static void update_selected(GtkSatMap * satmap, sat_t * sat)
         if (sat->los > 0.0)
         {
             number = sat->los - now;
-            alsstr = g_strdup("LOS");
+            alsstr = "LOS";
         }
         else
         {
@@ -2165,7 +2149,7 @@ static void update_selected(GtkSatMap * satmap, sat_t * sat)
         if (sat->aos > 0.0)
         {
             number = sat->aos - now;
-            alsstr = g_strdup("AOS");
+            alsstr = "AOS";
         }
         else
         {
@@ -2178,17 +2162,15 @@ static void update_selected(GtkSatMap * satmap, sat_t * sat)
     {
         if (sat->el > 0.0)
         {
-            text =
-                g_markup_printf_escaped
-                ("<span background=\"#%s\"> %s: Always in range </span>",
-                 satmap->infobgd, sat->nickname);
+            g_snprintf(text, sizeof(text),
+                       "<span background=\"#%s\"> %s: Always in range </span>",
+                       satmap->infobgd, obj->nickname);
         }
         else
         {
-            text =
-                g_markup_printf_escaped
-                ("<span background=\"#%s\"> %s: Always out of range </span>",
-                 satmap->infobgd, sat->nickname);
+            g_snprintf(text, sizeof(text),
+                       "<span background=\"#%s\"> %s: Always out of range </span>",
+                       satmap->infobgd, obj->nickname);
         }
     }
     else
@@ -2202,9 +2184,9 @@ static void update_selected(GtkSatMap * satmap, sat_t * sat)
 
         /* leading zero */
         if ((h > 0) && (h < 10))
-            ch = g_strdup("0");
+            ch = "0";
         else
-            ch = g_strdup("");
+            ch = "";
 
         /* extract minutes */
         m = (guint) floor(s / 60);
@@ -2212,40 +2194,34 @@ static void update_selected(GtkSatMap * satmap, sat_t * sat)
 
         /* leading zero */
         if (m < 10)
-            cm = g_strdup("0");
+            cm = "0";
         else
-            cm = g_strdup("");
+            cm = "";
 
         /* leading zero */
         if (s < 10)
-            cs = g_strdup(":0");
+            cs = ":0";
         else
-            cs = g_strdup(":");
+            cs = ":";
 
         if (h > 0)
         {
-            text = g_markup_printf_escaped("<span background=\"#%s\"> "
-                                           "%s %s in %s%d:%s%d%s%d </span>",
-                                           satmap->infobgd, sat->nickname,
-                                           alsstr, ch, h, cm, m, cs, s);
+            g_snprintf(text, sizeof(text), "<span background=\"#%s\"> "
+                       "%s %s in %s%d:%s%d%s%d </span>",
+                       satmap->infobgd, obj->nickname,
+                       alsstr, ch, h, cm, m, cs, s);
         }
         else
         {
-            text = g_markup_printf_escaped("<span background=\"#%s\"> "
-                                           "%s %s in %s%d%s%d </span>",
-                                           satmap->infobgd, sat->nickname,
-                                           alsstr, cm, m, cs, s);
+            g_snprintf(text, sizeof(text), "<span background=\"#%s\"> "
+                       "%s %s in %s%d%s%d </span>",
+                       satmap->infobgd, obj->nickname,
+                       alsstr, cm, m, cs, s);
         }
-
-        g_free(ch);
-        g_free(cm);
-        g_free(cs);
-        g_free(alsstr);
     }
 
     /* update info text */
     g_object_set(satmap->sel, "text", text, NULL);
-    g_free(text);
 }
 
 static void draw_grid_lines(GtkSatMap * satmap, GooCanvasItemModel * root)
@@ -2504,8 +2480,8 @@ static inline gdouble sgn(gdouble const t)
 static void redraw_terminator(GtkSatMap * satmap)
 {
     /* Set of (x, y) points along the terminator, one on each line of longitude in
-       increments of longitudinal degrees. */
-    GooCanvasPoints *line;
+       increments of longitudinal degrees. Allocated once and reused. */
+    static GooCanvasPoints *line = NULL;
 
     /* A variable which iterates over the longitudes. */
     int             longitude;
@@ -2533,7 +2509,8 @@ static void redraw_terminator(GtkSatMap * satmap)
     /* Vector cross-product of (lx,ly,lz) and sun vector. */
     gdouble         rx, ry, rz;
 
-    line = goo_canvas_points_new(363);
+    if (line == NULL)
+        line = goo_canvas_points_new(363);
 
     Calculate_Solar_Position(satmap->tstamp, &sun_);
     Calculate_LatLonAlt(satmap->tstamp, &sun_, &geodetic);
@@ -2572,7 +2549,6 @@ static void redraw_terminator(GtkSatMap * satmap)
     line->coords[725] = y;
 
     g_object_set(satmap->terminator, "points", line, NULL);
-    goo_canvas_points_unref(line);
 }
 
 void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
@@ -2596,18 +2572,79 @@ void gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats)
     GTK_SAT_MAP(satmap)->naos = 0.0;
     GTK_SAT_MAP(satmap)->ncat = 0;
 
-    /* reset ground track orbit to force repaint */
-    g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_ground_track, NULL);
+    /* reset ground track orbit to force repaint and pick up new names */
+    g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_sat_obj, satmap);
 }
 
-static void reset_ground_track(gpointer key, gpointer value,
-                               gpointer user_data)
+static void reset_sat_obj(gpointer key, gpointer value, gpointer user_data)
 {
     sat_map_obj_t  *obj = (sat_map_obj_t *) value;
-    (void) key;
-    (void) user_data;
+    sat_t          *sat;
 
     obj->track_orbit = 0;
+
+    sat = SAT(g_hash_table_lookup(GTK_SAT_MAP(user_data)->sats, key));
+    if (sat == NULL)
+        return;
+
+    g_object_set(obj->label, "text", sat->nickname, NULL);
+    g_object_set(obj->shadowl, "text", sat->nickname, NULL);
+    g_free(obj->nickname);
+    obj->nickname = g_markup_escape_text(sat->nickname, -1);
+}
+
+/**
+ * Show an overlay image on top of the map.
+ *
+ * @param satmap The GtkSatMap widget.
+ * @param pixbuf The overlay image, spanning -180 to 180 deg longitude from
+ *               left to right and 90 to -90 deg latitude from top to bottom.
+ *               It should have an alpha channel. NULL removes the overlay.
+ *
+ * The image is copied, shifted to the map centre and scaled with the map.
+ * It is drawn above the background map and below everything else.
+ */
+void gtk_sat_map_set_overlay(GtkSatMap * satmap, GdkPixbuf * pixbuf)
+{
+    GooCanvasItemModel *root;
+    GdkPixbuf      *pbuf;
+    gint            idx;
+    float           clon;
+
+    root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
+
+    if (satmap->overlayimg != NULL)
+    {
+        idx = goo_canvas_item_model_find_child(root, satmap->overlayimg);
+        if (idx != -1)
+            goo_canvas_item_model_remove_child(root, idx);
+        satmap->overlayimg = NULL;
+    }
+    g_clear_object(&satmap->overlay);
+
+    if (pixbuf == NULL)
+        return;
+
+    clon = (float)mod_cfg_get_int(satmap->cfgdata,
+                                  MOD_CFG_MAP_SECTION,
+                                  MOD_CFG_MAP_CENTER, SAT_CFG_INT_MAP_CENTER);
+
+    satmap->overlay = gdk_pixbuf_new(GDK_COLORSPACE_RGB,
+                                     gdk_pixbuf_get_has_alpha(pixbuf),
+                                     gdk_pixbuf_get_bits_per_sample(pixbuf),
+                                     gdk_pixbuf_get_width(pixbuf),
+                                     gdk_pixbuf_get_height(pixbuf));
+    map_tools_shift_center(pixbuf, satmap->overlay, clon);
+
+    pbuf = gdk_pixbuf_scale_simple(satmap->overlay,
+                                   MAX(satmap->width, 1),
+                                   MAX(satmap->height, 1),
+                                   GDK_INTERP_BILINEAR);
+    satmap->overlayimg = goo_canvas_image_model_new(root, pbuf,
+                                                    satmap->x0, satmap->y0,
+                                                    NULL);
+    g_object_unref(pbuf);
+    goo_canvas_item_model_raise(satmap->overlayimg, satmap->map);
 }
 
 static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat)
@@ -8,6 +8,7 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "pred-cache.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -62,6 +63,8 @@ typedef struct {
     GooCanvasItemModel *range1; /*!< First part of the range circle. */
     GooCanvasItemModel *range2; /*!< Second part of the range circle. */
 
+    gchar          *nickname;   /*!< Satellite name escaped for markup. */
+
     /* book keeping */
     guint           oldrcnum;   /*!< Number of RC parts in prev. cycle. */
     guint           newrcnum;   /*!< Number of RC parts in this cycle. */
@@ -104,10 +107,12 @@ typedef struct {
     gint            ncat;       /*!< Next event catnum. */
 
     gdouble         tstamp;     /*!< Time stamp for calculations; set by GtkSatModule */
+    gboolean        scrubbing;  /*!< Time is being scrubbed; set by GtkSatModule */
 
     GKeyFile       *cfgdata;    /*!< Module configuration data. */
     GHashTable     *sats;       /*!< Pointer to satellites (owned by parent GtkSatModule). */
     qth_t          *qth;        /*!< Pointer to current location. */
+    pred_cache_t   *pcache;     /*!< Prediction cache of the parent GtkSatModule or NULL. */
 
     GHashTable     *obj;        /*!< Canvas items representing each satellite. */
     GHashTable     *showtracks; /*!< A hash of satellites to show tracks for. */
@@ -128,11 +133,15 @@ typedef struct {
     gboolean        showgrid;   /*!< Show grid on map. */
     gboolean        keepratio;  /*!< Keep map aspect ratio. */
     gboolean        resize;     /*!< Flag indicating that the map has been resized. */
+    gboolean        tracks_deferred;    /*!< Ground tracks are out of date because of scrubbing. */
 
     gchar          *infobgd;    /*!< Background color of info text. */
 
     GdkPixbuf      *origmap;    /*!< Original map kept here for high quality scaling. */
 
+    GdkPixbuf      *overlay;    /*!< Overlay image, e.g. coverage; shifted like origmap. */
+    GooCanvasItemModel *overlayimg;     /*!< The canvas overlay item. */
+
 } GtkSatMap;
 
 struct _GtkSatMapClass {
@@ -150,6 +159,7 @@ void            gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
 
 void            gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats);
 void            gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum);
+void            gtk_sat_map_set_overlay(GtkSatMap * satmap, GdkPixbuf * pixbuf);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -27,11 +27,16 @@
 
 #include "compat.h"
 #include "config-keys.h"
+#include "conj-dialog.h"
+#include "cov-dialog.h"
+#include "gnss-dop-dialog.h"
 #include "gpredict-utils.h"
 #include "gtk-rig-ctrl.h"
 #include "gtk-rot-ctrl.h"
+#include "gtk-sat-map.h"
 #include "gtk-sat-module.h"
 #include "gtk-sat-module-popup.h"
+#include "gtk-sat-module-stats.h"
 #include "gtk-sat-module-tmg.h"
 #include "gtk-sky-glance.h"
 #include "mod-mgr.h"
@@ -49,6 +54,10 @@ static void     screen_state_cb(GtkWidget * menuitem, gpointer data);
 static void     sat_selected_cb(GtkWidget * menuitem, gpointer data);
 static void     sky_at_glance_cb(GtkWidget * menuitem, gpointer data);
 static void     tmgr_cb(GtkWidget * menuitem, gpointer data);
+static void     conj_cb(GtkWidget * menuitem, gpointer data);
+static void     cov_cb(GtkWidget * menuitem, gpointer data);
+static void     dop_cb(GtkWidget * menuitem, gpointer data);
+static void     stats_cb(GtkWidget * menuitem, gpointer data);
 static void     rigctrl_cb(GtkWidget * menuitem, gpointer data);
 static void     rotctrl_cb(GtkWidget * menuitem, gpointer data);
 static void     delete_cb(GtkWidget * menuitem, gpointer data);
@@ -167,11 +176,31 @@ void gtk_sat_module_popup(GtkSatModule * module)
     g_signal_connect(menuitem, "activate",
                      G_CALLBACK(sky_at_glance_cb), module);
 
+    /* close approaches */
+    menuitem = gtk_menu_item_new_with_label(_("Close approaches"));
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(conj_cb), module);
+
+    /* coverage analysis */
+    menuitem = gtk_menu_item_new_with_label(_("Coverage analysis"));
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(cov_cb), module);
+
+    /* GNSS visibility and DOP */
+    menuitem = gtk_menu_item_new_with_label(_("GNSS visibility and DOP"));
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(dop_cb), module);
+
     /* time manager */
     menuitem = gtk_menu_item_new_with_label(_("Time Controller"));
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
     g_signal_connect(menuitem, "activate", G_CALLBACK(tmgr_cb), module);
 
+    /* cycle statistics */
+    menuitem = gtk_menu_item_new_with_label(_("Performance"));
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(stats_cb), module);
+
     /* separator */
     menuitem = gtk_separator_menu_item_new();
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
@@ -833,12 +862,13 @@ static void sky_at_glance_cb(GtkWidget * menuitem, gpointer data)
     /* create sky at a glance widget */
     if (sat_cfg_get_bool(SAT_CFG_BOOL_PRED_USE_REAL_T0))
     {
-        module->skg = gtk_sky_glance_new(module->satellites, module->qth, 0.0);
+        module->skg = gtk_sky_glance_new(module->satellites, module->qth, 0.0,
+                                         module->pcache);
     }
     else
     {
         module->skg = gtk_sky_glance_new(module->satellites, module->qth,
-                                         module->tmgCdnum);
+                                         module->tmgCdnum, module->pcache);
     }
 
     /* store time at which GtkSkyGlance has been created */
@@ -852,6 +882,47 @@ static void sky_at_glance_cb(GtkWidget * menuitem, gpointer data)
     g_mutex_unlock(&module->busy);
 }
 
+/** Screen the satellites of the module for close approaches. */
+static void conj_cb(GtkWidget * menuitem, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    (void)menuitem;
+
+    conj_dialog_show(module->name, module->satellites, module->tmgCdnum,
+                     gtk_widget_get_toplevel(GTK_WIDGET(module)));
+}
+
+/** Analyse the ground coverage of a satellite group. */
+static void cov_cb(GtkWidget * menuitem, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+    GtkWidget      *satmap = NULL;
+    GSList         *node;
+
+    (void)menuitem;
+
+    /* results are shown on the first map of the module */
+    for (node = module->views; node != NULL && satmap == NULL;
+         node = node->next)
+        if (IS_GTK_SAT_MAP(node->data))
+            satmap = GTK_WIDGET(node->data);
+
+    cov_dialog_show(module->name, satmap, module->tmgCdnum,
+                    gtk_widget_get_toplevel(GTK_WIDGET(module)));
+}
+
+/** Show GNSS visibility and DOP for the QTH of the module. */
+static void dop_cb(GtkWidget * menuitem, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    (void)menuitem;
+
+    dop_dialog_show(module->name, module->qth, module->tmgCdnum,
+                    gtk_widget_get_toplevel(GTK_WIDGET(module)));
+}
+
 /** Open time manager. */
 static void tmgr_cb(GtkWidget * menuitem, gpointer data)
 {
@@ -862,6 +933,16 @@ static void tmgr_cb(GtkWidget * menuitem, gpointer data)
     tmg_create(module);
 }
 
+/** Open cycle statistics window. */
+static void stats_cb(GtkWidget * menuitem, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    (void)menuitem;
+
+    stats_create(module);
+}
+
 /**
  * Open Radio control window.
  *
@@ -0,0 +1,303 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+
+#include "alloc-count.h"
+#include "gtk-sat-module.h"
+#include "gtk-sat-module-stats.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+
+/* statistics columns */
+enum {
+    STATS_COL_LAST = 0,
+    STATS_COL_AVG,
+    STATS_COL_MAX,
+    STATS_COL_RUNS,
+    STATS_COL_SKIPPED,
+    STATS_COL_ALLOCS,
+    STATS_COL_NUM
+};
+
+/* refresh interval of the window [msec] */
+#define STATS_REFRESH 1000
+
+/* widgets of the statistics window */
+typedef struct {
+    GtkSatModule   *mod;
+    GtkWidget      *stage[GTK_SAT_MOD_STAGE_NUM][STATS_COL_NUM];
+    GtkWidget      *cycle;
+    GtkWidget      *budget;
+    GtkWidget      *cycles;
+    GtkWidget      *overruns;
+    GtkWidget      *missed;
+    GtkWidget      *queue;
+    GtkWidget      *propagated;
+    GtkWidget      *extrapolated;
+    GtkWidget      *allocs;
+    GtkWidget      *view_allocs[GTK_SAT_MOD_VIEW_NUM];
+    guint           timerid;
+} stats_win_t;
+
+static const gchar *stage_names[GTK_SAT_MOD_STAGE_NUM] = {
+    N_("Satellites"),
+    N_("Radio / rotator"),
+    N_("Views"),
+    N_("AOS/LOS refresh"),
+    N_("Sky at a glance")
+};
+
+static const gchar *col_names[STATS_COL_NUM] = {
+    N_("Last [ms]"),
+    N_("Avg [ms]"),
+    N_("Max [ms]"),
+    N_("Runs"),
+    N_("Deferred"),
+    N_("Allocs")
+};
+
+static const gchar *view_names[GTK_SAT_MOD_VIEW_NUM] = {
+    N_("Allocs in list view"),
+    N_("Allocs in map view"),
+    N_("Allocs in polar view"),
+    N_("Allocs in single sat view"),
+    N_("Allocs in event list")
+};
+
+
+static void set_label_double(GtkWidget * label, gdouble value)
+{
+    gchar           buff[32];
+
+    g_snprintf(buff, sizeof(buff), "%.2f", value);
+    gtk_label_set_text(GTK_LABEL(label), buff);
+}
+
+static void set_label_uint(GtkWidget * label, guint value)
+{
+    gchar           buff[32];
+
+    g_snprintf(buff, sizeof(buff), "%u", value);
+    gtk_label_set_text(GTK_LABEL(label), buff);
+}
+
+/** Refresh the statistics window */
+static gboolean stats_update(gpointer data)
+{
+    stats_win_t    *win = data;
+    GtkSatModule   *mod = win->mod;
+    gtk_sat_mod_stats_t *stats;
+    guint           i;
+
+    for (i = 0; i < GTK_SAT_MOD_STAGE_NUM; i++)
+    {
+        stats = &mod->stats[i];
+        set_label_double(win->stage[i][STATS_COL_LAST], stats->last);
+        set_label_double(win->stage[i][STATS_COL_AVG], stats->avg);
+        set_label_double(win->stage[i][STATS_COL_MAX], stats->max);
+        set_label_uint(win->stage[i][STATS_COL_RUNS], stats->runs);
+        set_label_uint(win->stage[i][STATS_COL_SKIPPED], stats->skipped);
+    }
+
+    /* allocations are only known in builds with the counter */
+    if (alloc_count_enabled())
+    {
+        for (i = 0; i < GTK_SAT_MOD_STAGE_NUM; i++)
+            set_label_uint(win->stage[i][STATS_COL_ALLOCS],
+                           mod->stats[i].allocs);
+
+        set_label_uint(win->allocs, mod->cycle_allocs);
+        for (i = 0; i < GTK_SAT_MOD_VIEW_NUM; i++)
+            set_label_uint(win->view_allocs[i], mod->view_allocs[i]);
+    }
+
+    set_label_double(win->cycle, mod->cycle_last);
+    set_label_double(win->budget, mod->timeout *
+                     sat_cfg_get_int(SAT_CFG_INT_TICK_BUDGET) / 100.0);
+    set_label_uint(win->cycles, mod->cycles);
+    set_label_uint(win->overruns, mod->overruns);
+    set_label_uint(win->missed, mod->missed);
+    set_label_uint(win->queue, mod->event_queue->len - mod->event_next);
+    set_label_uint(win->propagated, mod->sats_propagated);
+    set_label_uint(win->extrapolated, mod->sats_extrapolated);
+
+    return TRUE;
+}
+
+static void stats_destroy(GtkWidget * window, gpointer data)
+{
+    stats_win_t    *win = data;
+
+    (void)window;
+
+    g_source_remove(win->timerid);
+    win->mod->statswin = NULL;
+    g_free(win);
+}
+
+/** Reset the statistics */
+static void stats_reset(GtkWidget * button, gpointer data)
+{
+    stats_win_t    *win = data;
+    GtkSatModule   *mod = win->mod;
+    guint           i;
+
+    (void)button;
+
+    for (i = 0; i < GTK_SAT_MOD_STAGE_NUM; i++)
+    {
+        mod->stats[i].last = 0.0;
+        mod->stats[i].avg = 0.0;
+        mod->stats[i].max = 0.0;
+        mod->stats[i].runs = 0;
+        mod->stats[i].skipped = 0;
+        mod->stats[i].allocs = 0;
+    }
+
+    mod->cycles = 0;
+    mod->overruns = 0;
+    mod->missed = 0;
+
+    stats_update(win);
+}
+
+/* add a label and value to the summary grid */
+static GtkWidget *add_summary(GtkWidget * grid, const gchar * text, gint row)
+{
+    GtkWidget      *label;
+
+    label = gtk_label_new(text);
+    g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, row, 1, 1);
+
+    label = gtk_label_new("-");
+    g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 1, row, 1, 1);
+
+    return label;
+}
+
+/**
+ * Create the cycle statistics window.
+ *
+ * @param mod Pointer to the GtkSatModule widget.
+ *
+ * The window shows the timing of each stage of the module cycle and how
+ * often lower priority stages have been deferred because the cycle was
+ * over its time budget.
+ */
+void stats_create(GtkSatModule * mod)
+{
+    stats_win_t    *win;
+    GtkWidget      *vbox, *grid, *sgrid;
+    GtkWidget      *label, *button;
+    gchar          *title;
+    gchar          *buff;
+    guint           i, j;
+
+    if (mod->statswin != NULL)
+    {
+        gtk_window_present(GTK_WINDOW(mod->statswin));
+        return;
+    }
+
+    win = g_new0(stats_win_t, 1);
+    win->mod = mod;
+
+    /* per-stage statistics */
+    grid = gtk_grid_new();
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 10);
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 3);
+
+    for (j = 0; j < STATS_COL_NUM; j++)
+    {
+        buff = g_strdup_printf("<b>%s</b>", _(col_names[j]));
+        label = gtk_label_new(NULL);
+        gtk_label_set_markup(GTK_LABEL(label), buff);
+        g_free(buff);
+        gtk_grid_attach(GTK_GRID(grid), label, j + 1, 0, 1, 1);
+    }
+
+    for (i = 0; i < GTK_SAT_MOD_STAGE_NUM; i++)
+    {
+        label = gtk_label_new(_(stage_names[i]));
+        g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+        gtk_grid_attach(GTK_GRID(grid), label, 0, i + 1, 1, 1);
+
+        for (j = 0; j < STATS_COL_NUM; j++)
+        {
+            win->stage[i][j] = gtk_label_new("-");
+            g_object_set(win->stage[i][j], "xalign", 1.0f, "yalign", 0.5f,
+                         NULL);
+            gtk_grid_attach(GTK_GRID(grid), win->stage[i][j],
+                            j + 1, i + 1, 1, 1);
+        }
+    }
+
+    /* cycle summary */
+    sgrid = gtk_grid_new();
+    gtk_grid_set_column_spacing(GTK_GRID(sgrid), 10);
+    gtk_grid_set_row_spacing(GTK_GRID(sgrid), 3);
+    win->cycle = add_summary(sgrid, _("Last cycle [ms]"), 0);
+    win->budget = add_summary(sgrid, _("Time budget [ms]"), 1);
+    win->cycles = add_summary(sgrid, _("Cycles"), 2);
+    win->overruns = add_summary(sgrid, _("Over budget"), 3);
+    win->missed = add_summary(sgrid, _("Missed deadline"), 4);
+    win->queue = add_summary(sgrid, _("Pending AOS/LOS refresh"), 5);
+    win->propagated = add_summary(sgrid, _("Satellites propagated"), 6);
+    win->extrapolated = add_summary(sgrid, _("Satellites extrapolated"), 7);
+    win->allocs = add_summary(sgrid, _("Allocs in last cycle"), 8);
+    for (i = 0; i < GTK_SAT_MOD_VIEW_NUM; i++)
+        win->view_allocs[i] = add_summary(sgrid, _(view_names[i]), 9 + i);
+
+    button = gtk_button_new_with_label(_("Reset"));
+    g_signal_connect(button, "clicked", G_CALLBACK(stats_reset), win);
+
+    vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 10);
+    gtk_box_pack_start(GTK_BOX(vbox), grid, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox),
+                       gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), sgrid, FALSE, FALSE, 0);
+    gtk_box_pack_end(GTK_BOX(vbox), button, FALSE, FALSE, 0);
+
+    /* create main window */
+    mod->statswin = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    title = g_strconcat(_("Performance"), " / ", mod->name, NULL);
+    gtk_window_set_title(GTK_WINDOW(mod->statswin), title);
+    g_free(title);
+    gtk_window_set_transient_for(GTK_WINDOW(mod->statswin),
+                                 GTK_WINDOW(gtk_widget_get_toplevel
+                                            (GTK_WIDGET(mod))));
+    g_signal_connect(G_OBJECT(mod->statswin), "destroy",
+                     G_CALLBACK(stats_destroy), win);
+
+    gtk_container_add(GTK_CONTAINER(mod->statswin), vbox);
+    gtk_widget_show_all(mod->statswin);
+
+    stats_update(win);
+    win->timerid = g_timeout_add(STATS_REFRESH, stats_update, win);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Performance window for %s launched"),
+                __func__, mod->name);
+}
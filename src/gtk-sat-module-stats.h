@@ -0,0 +1,26 @@
+/*
+ * NOTE: This file is an internal part of gtk-sat-module and should not
+ * be used by other files than gtk-sat-module.c and gtk-sat-module-popup.c
+ */
+
+#ifndef __GTK_SAT_MODULE_STATS_H__
+#define __GTK_SAT_MODULE_STATS_H__ 1
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* *INDENT-ON* */
+
+void            stats_create(GtkSatModule * mod);
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+}
+#endif
+/* *INDENT-ON* */
+
+#endif /* __GTK_SAT_MODULE_STATS_H__ */
@@ -46,6 +46,13 @@ static void     tmg_cal_add_one_day(GtkSatModule * mod);
 static void     tmg_cal_sub_one_day(GtkSatModule * mod);
 
 static gdouble  calculate_time(GtkSatModule * mod);
+static void     tmg_scrub_start(GtkSatModule * mod);
+
+/* time without time changes after which scrubbing ends [msec] */
+#define SCRUB_IDLE_TIME  300
+
+/* half width of the time window covered by the scrub table [days] */
+#define SCRUB_WINDOW     0.25
 
 void tmg_create(GtkSatModule * mod)
 {
@@ -312,6 +319,13 @@ static void tmg_destroy(GtkWidget * tmg, gpointer data)
     mod->throttle = 1;
     mod->tmgActive = FALSE;
 
+    if (mod->tmgScrubTimer > 0)
+    {
+        g_source_remove(mod->tmgScrubTimer);
+        mod->tmgScrubTimer = 0;
+    }
+    mod->tmgScrubbing = FALSE;
+
     /* reset time */
     tmg_reset(NULL, data);
 
@@ -470,6 +484,8 @@ static void tmg_time_set(GtkWidget * widget, gpointer data)
         slider = gtk_range_get_value(GTK_RANGE(mod->tmgSlider));
 
         mod->tmgCdnum = jd + slider;
+
+        tmg_scrub_start(mod);
     }
 }
 
@@ -819,3 +835,98 @@ static gdouble calculate_time(GtkSatModule * mod)
 
     return jd;
 }
+
+/**
+ * Scrubbing timeout.
+ *
+ * @param data Pointer to the GtkSatModule structure.
+ *
+ * This function is called when the time has not been changed for
+ * SCRUB_IDLE_TIME. It ends the scrubbing and resets the event counter so
+ * that the next cycle recalculates AOS and LOS with full fidelity.
+ */
+static gboolean tmg_scrub_stop(gpointer data)
+{
+    GtkSatModule   *mod = GTK_SAT_MODULE(data);
+
+    mod->tmgScrubbing = FALSE;
+    mod->tmgScrubTimer = 0;
+    mod->event_count = 0;
+
+    return FALSE;
+}
+
+/**
+ * Start or continue scrubbing.
+ *
+ * @param mod Pointer to the GtkSatModule this time manager belongs to.
+ *
+ * This function is called every time the user changes the time in manual
+ * mode. Scrubbing continues until the time has not been changed for
+ * SCRUB_IDLE_TIME.
+ */
+static void tmg_scrub_start(GtkSatModule * mod)
+{
+    if (mod->tmgScrubTimer > 0)
+        g_source_remove(mod->tmgScrubTimer);
+
+    mod->tmgScrubbing = TRUE;
+    mod->tmgScrubTimer = g_timeout_add(SCRUB_IDLE_TIME, tmg_scrub_stop, mod);
+}
+
+/**
+ * Check whether the module time is being scrubbed.
+ *
+ * @param mod Pointer to the GtkSatModule widget.
+ * @return TRUE if the user is dragging the time in manual mode or time is
+ *         running faster than real time, FALSE otherwise.
+ *
+ * While scrubbing, the module uses the precomputed data in mod->scrub
+ * instead of propagating each satellite and searching for AOS and LOS.
+ */
+gboolean tmg_is_scrubbing(GtkSatModule * mod)
+{
+    if (!mod->tmgActive)
+        return FALSE;
+
+    return mod->tmgScrubbing || ABS(mod->throttle) > 1;
+}
+
+/**
+ * Update the scrub table.
+ *
+ * @param mod Pointer to the GtkSatModule widget.
+ *
+ * This function is called by the module in each cycle. While scrubbing it
+ * makes sure that a scrub table covering the current time is available or
+ * being built. When scrubbing has ended the table is released and the event
+ * counter is reset so that AOS and LOS are recalculated.
+ */
+void tmg_update_scrub(GtkSatModule * mod)
+{
+    gdouble         t = mod->tmgCdnum;
+    gdouble         margin = SCRUB_WINDOW / 4.0;
+
+    if (!tmg_is_scrubbing(mod))
+    {
+        if (mod->scrub != NULL)
+        {
+            scrub_table_free(mod->scrub);
+            mod->scrub = NULL;
+            mod->event_count = 0;
+        }
+
+        return;
+    }
+
+    /* keep the current table, even if it is still being built, as long as
+       t is not close to the edges of its window */
+    if (mod->scrub != NULL &&
+        t > mod->scrub->t0 + margin && t < mod->scrub->t1 - margin &&
+        qth_small_dist(mod->qth, mod->scrub->qth_comp) < 1.0)
+        return;
+
+    scrub_table_free(mod->scrub);
+    mod->scrub = scrub_table_new(mod->satellites, mod->qth,
+                                 t - SCRUB_WINDOW, t + SCRUB_WINDOW);
+}
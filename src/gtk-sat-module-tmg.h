@@ -19,6 +19,8 @@ extern "C" {
 void            tmg_create(GtkSatModule * mod);
 void            tmg_update_widgets(GtkSatModule * mod);
 void            tmg_update_state(GtkSatModule * mod);
+gboolean        tmg_is_scrubbing(GtkSatModule * mod);
+void            tmg_update_scrub(GtkSatModule * mod);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
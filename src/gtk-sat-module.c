@@ -38,8 +38,10 @@
 
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
+#include <string.h>
 #include <sys/time.h>
 
+#include "alloc-count.h"
 #include "compat.h"
 #include "config-keys.h"
 #include "gpredict-utils.h"
@@ -60,25 +62,29 @@
 #include "orbit-tools.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
+#include "sat-decim.h"
 #include "sat-log.h"
+#include "sat-stream.h"
+#include "sat-trace.h"
 #include "sgpsdp/sgp4sdp4.h"
+#include "startup-prof.h"
 #include "time-tools.h"
 
 
 static GtkVBoxClass *parent_class = NULL;
 
 
+/* the sat_t structures belong to module->satstore */
 static void gtk_sat_module_free_sat(gpointer sat)
 {
-    gtk_sat_data_free_sat(SAT(sat));
+    mod_mgr_sat_release(SAT(sat)->tle.catnr);
+    gtk_sat_data_clear_sat(SAT(sat));
 }
 
 static void update_autotrack(GtkSatModule * module)
 {
-    GList          *satlist = NULL;
-    GList          *iter;
+    GHashTableIter  iter;
     sat_t          *sat = NULL;
-    guint           i, n;
     double          next_aos;
     gint            next_sat;
 
@@ -90,20 +96,12 @@ static void update_autotrack(GtkSatModule * module)
         return;
 
     /* set target to satellite with next AOS */
-    satlist = g_hash_table_get_values(module->satellites);
-    iter = satlist;
-    n = g_list_length(satlist);
-    if (n == 0)
-        return;
-
     next_aos = module->tmgCdnum + 10.f; /* hope there is AOS within 10 days */
     next_sat = module->target;
 
-    i = 0;
-    while (i++ < n)
+    g_hash_table_iter_init(&iter, module->satellites);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &sat))
     {
-        sat = (sat_t *) iter->data;
-
         /* if sat is above horizon, select it and we are done */
         if (sat->el > 0.0)
         {
@@ -117,8 +115,6 @@ static void update_autotrack(GtkSatModule * module)
             next_aos = sat->aos;
             next_sat = sat->tle.catnr;
         }
-
-        iter = iter->next;
     }
 
     if (next_sat != module->target)
@@ -128,8 +124,16 @@ static void update_autotrack(GtkSatModule * module)
                     module->target, next_sat);
         gtk_sat_module_select_sat(module, next_sat);
     }
+}
+
+static void save_events(gpointer key, gpointer val, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
 
-    g_list_free(satlist);
+    (void)key;
+
+    pred_cache_put_events(module->pcache, SAT(val), module->qth,
+                          module->tmgCdnum);
 }
 
 static void gtk_sat_module_destroy(GtkWidget * widget)
@@ -141,7 +145,7 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
 
     /* stop timeout */
     if (module->timerid > 0)
-        g_source_remove(module->timerid);
+        mod_mgr_remove_timeout(module->timerid);
 
     /* destroy time controller */
     if (module->tmgActive)
@@ -166,6 +170,18 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
         gtk_widget_destroy(module->skgwin);
     }
 
+    /* save the predictions for the next time; the events are only valid
+       when a refresh has been completed */
+    if (module->pcache)
+    {
+        if (module->satellites && module->scrub == NULL &&
+            module->event_next >= module->event_queue->len)
+            g_hash_table_foreach(module->satellites, save_events, module);
+        pred_cache_save(module->pcache, module->satellites);
+        pred_cache_free(module->pcache);
+        module->pcache = NULL;
+    }
+
     /* clean up QTH */
     if (module->qth)
     {
@@ -173,6 +189,27 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
         module->qth = NULL;
     }
 
+    /* clean up scrub table and event queue before the satellites */
+    scrub_table_free(module->scrub);
+    module->scrub = NULL;
+
+    if (module->event_queue)
+    {
+        g_ptr_array_free(module->event_queue, TRUE);
+        module->event_queue = NULL;
+    }
+
+    if (module->statswin)
+    {
+        gtk_widget_destroy(module->statswin);
+    }
+
+    if (module->decim)
+    {
+        g_hash_table_destroy(module->decim);
+        module->decim = NULL;
+    }
+
     /* clean up satellites */
     if (module->satellites)
     {
@@ -180,6 +217,9 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
         module->satellites = NULL;
     }
 
+    g_free(module->satstore);
+    module->satstore = NULL;
+
     if (module->grid)
     {
         g_free(module->grid);
@@ -230,6 +270,23 @@ static void gtk_sat_module_init(GtkSatModule * module)
     module->grid = NULL;
     module->views = NULL;
     module->nviews = 0;
+    module->layout = NULL;
+
+    module->event_queue = g_ptr_array_new();
+    module->event_next = 0;
+    module->event_refine = FALSE;
+    module->pcache = NULL;
+    module->decim = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                          NULL, g_free);
+    module->view_res = 1.0;
+    module->sats_propagated = 0;
+    module->sats_extrapolated = 0;
+    module->cycle_last = 0.0;
+    module->cycles = 0;
+    module->overruns = 0;
+    module->missed = 0;
+    module->views_deferred = 0;
+    module->statswin = NULL;
 
     module->timerid = 0;
 
@@ -240,6 +297,9 @@ static void gtk_sat_module_init(GtkSatModule * module)
     module->tmgPdnum = 0.0;
     module->tmgCdnum = 0.0;
     module->tmgReset = FALSE;
+    module->tmgScrubbing = FALSE;
+    module->tmgScrubTimer = 0;
+    module->scrub = NULL;
 
     module->target = -1;
     module->autotrack = FALSE;
@@ -294,6 +354,7 @@ static GtkWidget *create_view(GtkSatModule * module, guint num)
     case GTK_SAT_MOD_VIEW_MAP:
         view = gtk_sat_map_new(module->cfgdata,
                                module->satellites, module->qth);
+        GTK_SAT_MAP(view)->pcache = module->pcache;
         break;
 
     case GTK_SAT_MOD_VIEW_POLAR:
@@ -350,17 +411,44 @@ static void get_grid_size(GtkSatModule * module, guint * rows, guint * cols)
 }
 
 /**
- * Create module layout and add views.
+ * Create module layout.
+ *
+ * The views are added by gtk_sat_module_create_views() when the module is
+ * shown the first time.
+ */
+static void create_module_layout(GtkSatModule * module)
+{
+    module->layout = gtk_grid_new();
+    gtk_grid_set_row_homogeneous(GTK_GRID(module->layout), TRUE);
+    gtk_grid_set_column_homogeneous(GTK_GRID(module->layout), TRUE);
+
+    gtk_box_pack_start(GTK_BOX(module), module->layout, TRUE, TRUE, 0);
+}
+
+/**
+ * Create the views of a module.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ *
+ * Modules in notebook tabs that are not visible do not need their views,
+ * so these are created when the module is shown the first time, either by
+ * the module manager or by the first update of a visible module. Nothing is
+ * done if the views already exist.
  *
  * It is assumed that module->grid and module->nviews have
  * coherent values.
  */
-static void create_module_layout(GtkSatModule * module)
+void gtk_sat_module_create_views(GtkSatModule * module)
 {
-    GtkWidget      *table;
     GtkWidget      *view;
     guint           rows, cols;
     guint           i;
+    gint64          start;
+
+    if (module->views != NULL || module->layout == NULL)
+        return;
+
+    start = g_get_monotonic_time();
 
     /* calculate the number of rows and columns necessary */
     get_grid_size(module, &rows, &cols);
@@ -368,10 +456,6 @@ static void create_module_layout(GtkSatModule * module)
                 _("%s: Layout has %d columns and %d rows."),
                 __func__, cols, rows);
 
-    table = gtk_grid_new();
-    gtk_grid_set_row_homogeneous(GTK_GRID(table), TRUE);
-    gtk_grid_set_column_homogeneous(GTK_GRID(table), TRUE);
-
     for (i = 0; i < module->nviews; i++)
     {
         /* create the view */
@@ -381,14 +465,20 @@ static void create_module_layout(GtkSatModule * module)
         module->views = g_slist_append(module->views, view);
 
         /* add view to the grid */
-        gtk_grid_attach(GTK_GRID(table), view,
+        gtk_grid_attach(GTK_GRID(module->layout), view,
                         module->grid[5 * i + 1],                            // left
                         module->grid[5 * i + 3],                            // top
                         module->grid[5 * i + 2] - module->grid[5 * i + 1],  // width
                         module->grid[5 * i + 4] - module->grid[5 * i + 3]); // height
     }
 
-    gtk_box_pack_start(GTK_BOX(module), table, TRUE, TRUE, 0);
+    gtk_widget_show_all(module->layout);
+
+    /* the views show the current target */
+    if (module->target != -1)
+        gtk_sat_module_select_sat(module, module->target);
+
+    startup_prof_add("create views", start);
 }
 
 
@@ -430,46 +520,44 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
         return;
     }
 
-    /* read each satellite into hash table */
+    /* read the satellites that no other module uses in parallel */
+    mod_mgr_sat_preload(sats, length);
+
+    /* the satellites are stored in one block, which keeps the data used
+       by every cycle close together */
+    module->satstore = g_new0(sat_t, length);
+
+    /* get each satellite from the shared data into hash table */
     for (i = 0; i < length; i++)
     {
-        sat = g_new(sat_t, 1);
+        /* check whether satellite is already in list
+           in order to avoid duplicates
+         */
+        if (g_hash_table_lookup(module->satellites, &sats[i]) != NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: Sat #%d already in list"), __func__, sats[i]);
+            continue;
+        }
+
+        sat = &module->satstore[succ];
 
-        if (gtk_sat_data_read_sat(sats[i], sat))
+        if (mod_mgr_sat_acquire(sats[i], sat, module->qth))
         {
             /* the satellite could not be read */
             sat_log_log(SAT_LOG_LEVEL_ERROR,
                         _("%s: Error reading data for #%d"),
                         __func__, sats[i]);
-
-            g_free(sat);
         }
         else
         {
-            /* check whether satellite is already in list
-               in order to avoid duplicates
-             */
             key = g_new0(guint, 1);
             *key = sats[i];
 
-            if (g_hash_table_lookup(module->satellites, key) == NULL)
-            {
-                gtk_sat_data_init_sat(sat, module->qth);
-                g_hash_table_insert(module->satellites, key, sat);
-                succ++;
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: Read data for #%d"), __func__, sats[i]);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_WARN,
-                            _("%s: Sat #%d already in list"),
-                            __func__, sats[i]);
-
-                /* it is not needed in this case */
-                g_free(sat);
-            }
-
+            g_hash_table_insert(module->satellites, key, sat);
+            succ++;
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: Read data for #%d"), __func__, sats[i]);
         }
     }
 
@@ -507,6 +595,8 @@ static void update_skg(GtkSatModule * module)
         G_UNLIKELY(qth_small_dist(module->qth, module->lastSkgUpdqth) > 1.0))
     {
 
+        gint64          start = sat_trace_begin();
+
         sat_log_log(SAT_LOG_LEVEL_INFO,
                     _("%s: Updating GtkSkyGlance for %s"),
                     __func__, module->name);
@@ -514,88 +604,162 @@ static void update_skg(GtkSatModule * module)
         gtk_container_remove(GTK_CONTAINER(module->skgwin), module->skg);
         module->skg =
             gtk_sky_glance_new(module->satellites, module->qth,
-                               module->tmgCdnum);
+                               module->tmgCdnum, module->pcache);
         gtk_container_add(GTK_CONTAINER(module->skgwin), module->skg);
         gtk_widget_show_all(module->skg);
+        sat_trace_end_arg("module", "rebuild sky at a glance", start,
+                          module->name);
 
         module->lastSkgUpd = module->tmgCdnum;
         qth_small_save(module->qth, &(module->lastSkgUpdqth));
     }
 }
 
+/* The prediction cache has found passes in the background */
+static void passes_found(gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    /* rebuild the sky at a glance in the next cycle */
+    module->lastSkgUpd = 0.0;
+}
+
 static void update_header(GtkSatModule * module)
 {
-    gchar          *fmtstr;
     gchar           buff[TIME_FORMAT_MAX_LENGTH + 1];
-    gchar          *buff2;
+    gchar           buff2[TIME_FORMAT_MAX_LENGTH + 32];
 
-    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-    daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, module->tmgCdnum);
+    daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH,
+                  sat_cfg_peek_str(SAT_CFG_STR_TIME_FORMAT), module->tmgCdnum);
 
     if (module->qth->type == QTH_GPSD_TYPE)
     {
-        buff2 =
-            g_strdup_printf("%s GPS %0.3f seconds old", buff,
-                            fabs(module->tmgCdnum -
-                                 module->qth->gpsd_update) * (24 * 3600));
+        g_snprintf(buff2, sizeof(buff2), "%s GPS %0.3f seconds old", buff,
+                   fabs(module->tmgCdnum -
+                        module->qth->gpsd_update) * (24 * 3600));
         gtk_label_set_text(GTK_LABEL(module->header), buff2);
-        g_free(buff2);
     }
     else
         gtk_label_set_text(GTK_LABEL(module->header), buff);
 
-    g_free(fmtstr);
-
     if (module->tmgActive)
         tmg_update_state(module);
 }
 
+/* angular resolution of text views [deg] */
+#define TEXT_VIEW_RES 0.01
+
+/**
+ * Get the angular resolution of the views.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ * @return The smallest angle in degrees that is visible in any of the views.
+ *
+ * For the map and polar views this is the size of a pixel, while the text
+ * based views are assumed to show angles with TEXT_VIEW_RES resolution.
+ */
+static gdouble views_resolution(GtkSatModule * module)
+{
+    GtkWidget      *child;
+    GSList         *node;
+    gdouble         res = 1.0;
+    gint            w, h;
+
+    for (node = module->views; node != NULL; node = node->next)
+    {
+        child = GTK_WIDGET(node->data);
+        w = gtk_widget_get_allocated_width(child);
+        h = gtk_widget_get_allocated_height(child);
+
+        if (IS_GTK_SAT_MAP(child))
+        {
+            if (w > 0)
+                res = MIN(res, 360.0 / w);
+        }
+        else if (IS_GTK_POLAR_VIEW(child))
+        {
+            if (MIN(w, h) > 0)
+                res = MIN(res, 180.0 / MIN(w, h));
+        }
+        else
+        {
+            res = MIN(res, TEXT_VIEW_RES);
+        }
+    }
+
+    return res;
+}
+
+/* names of the view types in the trace */
+static const gchar *view_trace_names[GTK_SAT_MOD_VIEW_NUM] = {
+    "GtkSatList",
+    "GtkSatMap",
+    "GtkPolarView",
+    "GtkSingleSat",
+    "GtkEventList"
+};
+
 /**
  * Update a child widget.
  *
+ * @param module Pointer to the GtkSatModule widget.
  * @param child Pointer to the child widget (views)
- * @param tstamp The current timestamp
  *
  * This function is called by the main loop of the GtkSatModule widget for
  * each view in the layout grid.
  */
-static void update_child(GtkWidget * child, gdouble tstamp)
+static void update_child(GtkSatModule * module, GtkWidget * child)
 {
+    gdouble         tstamp = module->tmgCdnum;
+    gint64          start = sat_trace_begin();
+    guint           allocs = alloc_count_get();
+    gtk_sat_mod_view_t type;
+
     if (IS_GTK_SAT_LIST(child))
     {
         GTK_SAT_LIST(child)->tstamp = tstamp;
         gtk_sat_list_update(child);
+        type = GTK_SAT_MOD_VIEW_LIST;
     }
 
     else if (IS_GTK_SAT_MAP(child))
     {
         GTK_SAT_MAP(child)->tstamp = tstamp;
+        GTK_SAT_MAP(child)->scrubbing = (module->scrub != NULL);
         gtk_sat_map_update(child);
+        type = GTK_SAT_MOD_VIEW_MAP;
     }
 
     else if (IS_GTK_POLAR_VIEW(child))
     {
         GTK_POLAR_VIEW(child)->tstamp = tstamp;
         gtk_polar_view_update(child);
+        type = GTK_SAT_MOD_VIEW_POLAR;
     }
 
     else if (IS_GTK_SINGLE_SAT(child))
     {
         GTK_SINGLE_SAT(child)->tstamp = tstamp;
         gtk_single_sat_update(child);
+        type = GTK_SAT_MOD_VIEW_SINGLE;
     }
 
     else if (IS_GTK_EVENT_LIST(child))
     {
         GTK_EVENT_LIST(child)->tstamp = tstamp;
         gtk_event_list_update(child);
+        type = GTK_SAT_MOD_VIEW_EVENT;
     }
 
     else
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%d: Unknown child type"), __FILE__, __LINE__);
+        return;
     }
+
+    sat_trace_end("view", view_trace_names[type], start);
+    module->view_allocs[type] += alloc_count_get() - allocs;
 }
 
 /**
@@ -612,6 +776,7 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
                                       gpointer data)
 {
     sat_t          *sat;
+    sat_decim_t    *decim;
     GtkSatModule   *module;
     gdouble         daynum;
     gdouble         maxdt;
@@ -627,20 +792,20 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
     /* get current time (real or simulated */
     daynum = module->tmgCdnum;
 
-    /* update events if the event counter has been reset
-       and the other requirements are fulfilled */
-    if ((GTK_SAT_MODULE(module)->event_count == 0) &&
-        has_aos(sat, module->qth))
+    /* while scrubbing use the precomputed data; if it is not available yet
+       only propagate the satellite and leave AOS/LOS for later */
+    if (module->tmgScrubbing || module->scrub != NULL)
     {
-        /* Note that has_aos may return TRUE for geostationary sats
-           whose orbit deviate from a true-geostat orbit, however,
-           find_aos and find_los will not go beyond the time limit
-           we specify (in those cases they return 0.0 for AOS/LOS times.
-           We use SAT_CFG_INT_PRED_LOOK_AHEAD for upper time limit */
-        sat->aos = find_aos(sat, module->qth, daynum, maxdt);
-        sat->los = find_los(sat, module->qth, daynum, maxdt);
+        if (!scrub_table_calc(module->scrub, sat, module->qth, daynum))
+            predict_calc(sat, module->qth, daynum);
+
+        return;
     }
+
     /*
+       Full AOS/LOS updates are done in the event stage, see
+       gtk_sat_module_update_events().
+
        Update AOS and LOS for this satellite if it was known and is before
        the current time.
 
@@ -682,20 +847,213 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
     if (sat->los > 0 && sat->los < daynum)
         sat->los = find_los(sat, module->qth, daynum, maxdt);
 
+    /* propagate or extrapolate depending on the angular rate */
+    decim = g_hash_table_lookup(module->decim, &sat->tle.catnr);
+    if (decim == NULL)
+    {
+        decim = sat_decim_new(sat);
+        g_hash_table_insert(module->decim, &decim->catnum, decim);
+    }
+
+    if (sat_decim_due(decim, daynum))
+    {
+        /* shared with other modules tracking the satellite at this time */
+        mod_mgr_sat_calc(sat, module->qth, daynum);
+        sat_decim_store(decim, sat, module->view_res);
+        module->sats_propagated++;
+    }
+    else
+    {
+        sat_decim_extrapolate(decim, sat, daynum);
+        predict_calc_obs(sat, module->qth);
+        module->sats_extrapolated++;
+    }
+}
+
+/**
+ * Refine AOS and LOS times of a satellite after the QTH has moved.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ * @param sat The satellite.
+ * @return TRUE if both times were refined, FALSE if a full search is needed.
+ *
+ * The AOS and LOS found for the previous QTH are used as seeds for a local
+ * search, see refine_event(). It leaves the satellite data at the current
+ * time.
+ */
+static gboolean gtk_sat_module_refine_events(GtkSatModule * module,
+                                             sat_t * sat)
+{
+    gdouble         daynum = module->tmgCdnum;
+    gdouble         aos, los;
+
+    /* both events are needed as seeds */
+    if (sat->aos <= daynum || sat->los <= daynum)
+        return FALSE;
+
+    aos = refine_event(sat, module->qth, sat->aos, TRUE);
+    los = refine_event(sat, module->qth, sat->los, FALSE);
     predict_calc(sat, module->qth, daynum);
+
+    /* the events must still be ahead and agree with the current elevation */
+    if (aos <= daynum || los <= daynum || ((los < aos) != (sat->el > 0.0)))
+        return FALSE;
+
+    sat->aos = aos;
+    sat->los = los;
+
+    return TRUE;
+}
+
+/**
+ * Refresh AOS and LOS times of a satellite.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ * @param sat The satellite.
+ *
+ * This function is called in the event stage of the module cycle for the
+ * satellites in the event queue. It leaves the satellite data at the
+ * current time.
+ */
+static void gtk_sat_module_update_events(GtkSatModule * module, sat_t * sat)
+{
+    gdouble         daynum = module->tmgCdnum;
+    gdouble         maxdt;
+    gdouble         aos, los;
+
+    /* after a small QTH movement the old events are good seeds */
+    if (module->event_refine && gtk_sat_module_refine_events(module, sat))
+        return;
+
+    /* when the module is opened the events saved last time may still be
+       the next ones */
+    if (pred_cache_take_events(module->pcache, sat, module->qth, daynum,
+                               &aos, &los) && ((los < aos) == (sat->el > 0.0)))
+    {
+        sat->aos = aos;
+        sat->los = los;
+        return;
+    }
+
+    maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+
+    if (has_aos(sat, module->qth))
+    {
+        /* Note that has_aos may return TRUE for geostationary sats
+           whose orbit deviate from a true-geostat orbit, however,
+           find_aos and find_los will not go beyond the time limit
+           we specify (in those cases they return 0.0 for AOS/LOS times.
+           We use SAT_CFG_INT_PRED_LOOK_AHEAD for upper time limit */
+        sat->aos = find_aos(sat, module->qth, daynum, maxdt);
+        sat->los = find_los(sat, module->qth, daynum, maxdt);
+
+        /* find_aos and find_los leave the satellite at the event time */
+        predict_calc(sat, module->qth, daynum);
+    }
+}
+
+static void queue_sat(gpointer key, gpointer val, gpointer data)
+{
+    (void)key;
+
+    g_ptr_array_add((GPtrArray *) data, val);
+}
+
+/* Check whether there are satellites waiting for AOS/LOS refresh */
+static gboolean event_queue_empty(GtkSatModule * mod)
+{
+    return mod->event_next >= mod->event_queue->len;
+}
+
+/* names of the cycle stages in the trace */
+static const gchar *stage_trace_names[GTK_SAT_MOD_STAGE_NUM] = {
+    "satellites",
+    "control",
+    "views",
+    "events",
+    "sky at a glance"
+};
+
+/** Get time elapsed since start in msec */
+static gdouble elapsed_ms(gint64 start)
+{
+    return (g_get_monotonic_time() - start) / 1000.0;
+}
+
+/** Start a cycle stage; returns the monotonic time */
+static gint64 stage_begin(GtkSatModule * mod)
+{
+    mod->stage_allocs = alloc_count_get();
+
+    return g_get_monotonic_time();
+}
+
+/**
+ * Update the statistics of a cycle stage.
+ *
+ * @param mod Pointer to the GtkSatModule widget.
+ * @param stage The stage.
+ * @param start Monotonic time when the stage was started, or -1 if the stage
+ *              has been deferred.
+ */
+static void stage_done(GtkSatModule * mod, gtk_sat_mod_stage_t stage,
+                       gint64 start)
+{
+    gtk_sat_mod_stats_t *stats = &mod->stats[stage];
+
+    if (start < 0)
+    {
+        stats->last = 0.0;
+        stats->allocs = 0;
+        stats->skipped++;
+        return;
+    }
+
+    stats->allocs = alloc_count_get() - mod->stage_allocs;
+
+    sat_trace_end_arg("module", stage_trace_names[stage], start, mod->name);
+
+    stats->last = elapsed_ms(start);
+    stats->avg = stats->runs ? 0.9 * stats->avg + 0.1 * stats->last :
+        stats->last;
+    if (stats->last > stats->max)
+        stats->max = stats->last;
+    stats->runs++;
 }
 
-/** Module timeout callback. */
+/* max number of consecutive cycles where the views may be deferred */
+#define MAX_VIEWS_DEFERRED 4
+
+/* max QTH movement where AOS/LOS are refined instead of searched [km]; a
+   pass that appears after a larger movement could be missed */
+#define EVENT_REFINE_MAX_DIST 10.0
+
+/**
+ * Module timeout callback.
+ *
+ * The cycle is split into stages in order of priority, see
+ * gtk_sat_mod_stage_t. Satellites, autotracking and radio/rotator control
+ * are updated in every cycle. The remaining stages only run while the
+ * cycle is within its time budget (SAT_CFG_INT_TICK_BUDGET percent of the
+ * refresh rate) and are deferred to a later cycle otherwise. The views are
+ * never deferred more than MAX_VIEWS_DEFERRED cycles in a row, and the
+ * event stage refreshes at least one satellite per cycle.
+ */
 static gboolean gtk_sat_module_timeout_cb(gpointer module)
 {
     GtkSatModule   *mod = GTK_SAT_MODULE(module);
-    GtkWidget      *child;
+    GSList         *node;
     gboolean        needupdate = FALSE;
+    gboolean        moved = FALSE;
+    gdouble         dist;
     GdkWindowState  state;
     gdouble         delta;
-    guint           i;
+    gdouble         budget;
+    gint64          cycle_start, stage_start;
+    guint           cycle_allocs;
 
-    /*update the qth position */
+    /* update the qth position; gpsd is read by a separate thread and a
+       trajectory is followed in real and simulated time */
     qth_data_update(mod->qth, mod->tmgCdnum);
 
     /* in docked state, update only if tab is visible */
@@ -721,19 +1079,35 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
 
     if (needupdate)
     {
+        /* the views of a module restored in a hidden tab are created when
+           it is shown the first time */
+        gtk_sat_module_create_views(mod);
+
         if (g_mutex_trylock(&mod->busy) == FALSE)
         {
             sat_log_log(SAT_LOG_LEVEL_WARN,
                         _("%s: Previous cycle missed it's deadline."),
                         __func__);
+            sat_trace_instant("module", "missed deadline", mod->name);
+            mod->missed++;
 
             return TRUE;
         }
 
-        mod->rtNow = get_current_daynum();
+        cycle_start = g_get_monotonic_time();
+        cycle_allocs = alloc_count_get();
+        budget = mod->timeout * sat_cfg_get_int(SAT_CFG_INT_TICK_BUDGET) /
+            100.0;
+
+        mod->rtNow = mod_mgr_get_current_daynum();
 
-        /* Update time if throttle != 0 */
-        if (mod->throttle)
+        /* Update time if throttle != 0; in real time follow the clock
+           exactly so that modules share the same time */
+        if (mod->throttle == 1 && mod->tmgPdnum == mod->rtPrev)
+        {
+            mod->tmgCdnum = mod->rtNow;
+        }
+        else if (mod->throttle)
         {
             delta = mod->throttle * (mod->rtNow - mod->rtPrev);
             mod->tmgCdnum = mod->tmgPdnum + delta;
@@ -750,54 +1124,108 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
             update_header(mod);
         }
 
+        /* start, continue or end scrubbing */
+        if (mod->tmgActive || mod->scrub != NULL)
+            tmg_update_scrub(mod);
+
         /* reset event update counter if is has expired or if we have moved
-           significantly */
+           far; after a small movement the events are refined from the
+           previous ones */
+        dist = qth_small_dist(mod->qth, mod->qth_event);
         if (mod->event_count == mod->event_timeout ||
-            qth_small_dist(mod->qth, mod->qth_event) > 1.0)
-        {
+            dist > EVENT_REFINE_MAX_DIST)
             mod->event_count = 0;       // will trigger find_aos() and find_los()
-        }
+        else
+            moved = (dist > 1.0);
 
-        /* if the events are going to be recalculated store the position */
-        if (mod->event_count == 0)
+        /* if the events are going to be recalculated store the position
+           and queue all satellites; a refresh that has not been completed
+           yet starts over, and stays a full one if it was */
+        if ((mod->event_count == 0 || moved) && mod->satellites != NULL)
         {
+            mod->event_refine = moved && mod->event_count != 0 &&
+                (mod->event_refine || event_queue_empty(mod));
             qth_small_save(mod->qth, &(mod->qth_event));
+            g_ptr_array_set_size(mod->event_queue, 0);
+            mod->event_next = 0;
+            if (mod->scrub == NULL)
+                g_hash_table_foreach(mod->satellites, queue_sat,
+                                     mod->event_queue);
         }
 
         /* update satellite data */
+        stage_start = stage_begin(mod);
+        mod->view_res = views_resolution(mod);
+        mod->sats_propagated = 0;
+        mod->sats_extrapolated = 0;
         if (mod->satellites != NULL)
             g_hash_table_foreach(mod->satellites,
                                  gtk_sat_module_update_sat, module);
+        stage_done(mod, GTK_SAT_MOD_STAGE_SATS, stage_start);
 
-        /* update children */
-        for (i = 0; i < mod->nviews; i++)
-        {
-            child = GTK_WIDGET(g_slist_nth_data(mod->views, i));
-            update_child(child, mod->tmgCdnum);
-        }
-
-        /* update satellite data (it may have got out of sync during child updates) */
-        if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
-
-        /* update target if autotracking is enabled */
+        /* update target if autotracking is enabled and
+           send notice to radio and rotator controller */
+        stage_start = stage_begin(mod);
         if (mod->autotrack)
             update_autotrack(mod);
-
-        /* send notice to radio and rotator controller */
         if (mod->rigctrl)
             gtk_rig_ctrl_update(GTK_RIG_CTRL(mod->rigctrl), mod->tmgCdnum);
         if (mod->rotctrl)
             gtk_rot_ctrl_update(GTK_ROT_CTRL(mod->rotctrl), mod->tmgCdnum);
+        sat_stream_publish(mod->name, mod->satellites, mod->tmgCdnum);
+        stage_done(mod, GTK_SAT_MOD_STAGE_CTRL, stage_start);
+
+        /* update children; views that recalculate data, e.g. ground tracks,
+           restore the satellite data to the current time when done */
+        if (elapsed_ms(cycle_start) < budget ||
+            mod->views_deferred >= MAX_VIEWS_DEFERRED)
+        {
+            stage_start = stage_begin(mod);
+            memset(mod->view_allocs, 0, sizeof(mod->view_allocs));
+            for (node = mod->views; node != NULL; node = node->next)
+                update_child(mod, GTK_WIDGET(node->data));
+            mod->views_deferred = 0;
+            stage_done(mod, GTK_SAT_MOD_STAGE_VIEWS, stage_start);
+        }
+        else
+        {
+            mod->views_deferred++;
+            stage_done(mod, GTK_SAT_MOD_STAGE_VIEWS, -1);
+        }
+
+        /* refresh AOS/LOS for queued satellites while time permits */
+        if (!event_queue_empty(mod))
+        {
+            stage_start = stage_begin(mod);
+            do
+            {
+                gtk_sat_module_update_events(mod,
+                                             SAT(g_ptr_array_index
+                                                 (mod->event_queue,
+                                                  mod->event_next++)));
+            }
+            while (!event_queue_empty(mod) &&
+                   elapsed_ms(cycle_start) < budget);
+
+            stage_done(mod, GTK_SAT_MOD_STAGE_EVENTS, stage_start);
+            if (!event_queue_empty(mod))
+                mod->stats[GTK_SAT_MOD_STAGE_EVENTS].skipped++;
+        }
 
         /* check and update Sky at glance */
-        /* FIXME: We should have some timeout counter to ensure that we don't
-           update GtkSkyGlance too often when running with high throttle values;
-           however, the update does not seem to add any significant load even
-           when running at max throttle */
-        if (mod->skg)
-            update_skg(mod);
+        if (mod->skg && mod->scrub == NULL)
+        {
+            if (elapsed_ms(cycle_start) < budget)
+            {
+                stage_start = stage_begin(mod);
+                update_skg(mod);
+                stage_done(mod, GTK_SAT_MOD_STAGE_SKG, stage_start);
+            }
+            else
+            {
+                stage_done(mod, GTK_SAT_MOD_STAGE_SKG, -1);
+            }
+        }
 
         mod->event_count++;
 
@@ -813,6 +1241,13 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
                 tmg_update_widgets(mod);
         }
 
+        sat_trace_end_arg("module", "cycle", cycle_start, mod->name);
+        mod->cycle_last = elapsed_ms(cycle_start);
+        mod->cycle_allocs = alloc_count_get() - cycle_allocs;
+        mod->cycles++;
+        if (mod->cycle_last > budget)
+            mod->overruns++;
+
         g_mutex_unlock(&mod->busy);
     }
 
@@ -986,6 +1421,7 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
 {
     GtkSatModule   *module;
     GtkWidget      *butbox;
+    gint64          start;
 
     /* Read configuration data.
        If cfgfile is not existing or is NULL, start the wizard
@@ -1005,6 +1441,7 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
     g_object_set(module, "orientation", GTK_ORIENTATION_VERTICAL, NULL);
 
     /* load configuration; note that this will also set the module name */
+    start = g_get_monotonic_time();
     gtk_sat_module_read_cfg_data(module, cfgfile);
 
     /*check that we loaded some reasonable data */
@@ -1017,6 +1454,7 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
     }
     /*initialize the qth engine and get position */
     qth_data_update_init(module->qth);
+    startup_prof_add("read module configuration", start);
 
     /* module state */
     if ((g_key_file_has_key(module->cfgdata,
@@ -1034,13 +1472,20 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
     }
 
     /* initialise time keeping vars to current time */
-    module->rtNow = get_current_daynum();
-    module->rtPrev = get_current_daynum();
-    module->tmgPdnum = get_current_daynum();
-    module->tmgCdnum = get_current_daynum();
+    module->rtNow = mod_mgr_get_current_daynum();
+    module->rtPrev = module->rtNow;
+    module->tmgPdnum = module->rtNow;
+    module->tmgCdnum = module->rtNow;
 
-    /* load satellites */
+    /* load satellites and the predictions saved last time */
+    start = g_get_monotonic_time();
     gtk_sat_module_load_sats(module);
+    startup_prof_add("load satellites", start);
+
+    start = g_get_monotonic_time();
+    module->pcache = pred_cache_load(module->name, module->qth);
+    pred_cache_set_notify(module->pcache, passes_found, module);
+    startup_prof_add("load prediction cache", start);
 
     /* create buttons */
     module->popup_button = gpredict_mini_mod_button("gpredict-mod-popup.png",
@@ -1082,12 +1527,15 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
                        gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
                        FALSE, FALSE, 0);
 
+    /* a docked module creates its views when its tab is shown */
     create_module_layout(module);
+    if (module->state != GTK_SAT_MOD_STATE_DOCKED)
+        gtk_sat_module_create_views(module);
     gtk_widget_show_all(GTK_WIDGET(module));
 
     /* start timeout */
-    module->timerid = g_timeout_add(module->timeout, gtk_sat_module_timeout_cb,
-                                    module);
+    module->timerid = mod_mgr_add_timeout(module->timeout,
+                                          gtk_sat_module_timeout_cb, module);
 
     return GTK_WIDGET(module);
 }
@@ -1251,7 +1699,7 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
                 _("%s: Module %s received CONFIG signal."), __func__, name);
 
     /* stop timeout */
-    if (!g_source_remove(module->timerid))
+    if (!mod_mgr_remove_timeout(module->timerid))
     {
         /* internal error, since the timerid appears
            to be invalid.
@@ -1263,7 +1711,7 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
     }
     else
     {
-        module->timerid = -1;
+        module->timerid = 0;
         retcode = mod_cfg_edit(name, module->cfgdata, toplevel);
         if (retcode == MOD_CFG_OK)
         {
@@ -1368,8 +1816,9 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
         else
         {
             /* user cancelled => just re-start timer */
-            module->timerid = g_timeout_add(module->timeout,
-                                            gtk_sat_module_timeout_cb, data);
+            module->timerid = mod_mgr_add_timeout(module->timeout,
+                                                  gtk_sat_module_timeout_cb,
+                                                  data);
         }
     }
 
@@ -1433,8 +1882,7 @@ static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
  */
 void gtk_sat_module_reload_sats(GtkSatModule * module)
 {
-    GtkWidget      *child;
-    guint           i;
+    GSList         *node;
 
     g_return_if_fail(IS_GTK_SAT_MODULE(module));
 
@@ -1445,21 +1893,29 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
                 _("%s: Reloading satellites for module %s"),
                 __func__, module->name);
 
+    /* queued satellites are about to be freed */
+    g_ptr_array_set_size(module->event_queue, 0);
+    module->event_next = 0;
+    g_hash_table_remove_all(module->decim);
+
     /* remove each element from the hash table, but keep the hash table */
     g_hash_table_foreach_remove(module->satellites, empty, NULL);
+    g_free(module->satstore);
+    module->satstore = NULL;
 
     /* reset event counter so that next AOS/LOS gets re-calculated */
     module->event_count = 0;
 
+    /* scrub table has been built using the old data */
+    scrub_table_free(module->scrub);
+    module->scrub = NULL;
+
     /* load satellites */
     gtk_sat_module_load_sats(module);
 
     /* update children */
-    for (i = 0; i < module->nviews; i++)
-    {
-        child = GTK_WIDGET(g_slist_nth_data(module->views, i));
-        reload_sats_in_child(child, module);
-    }
+    for (node = module->views; node != NULL; node = node->next)
+        reload_sats_in_child(GTK_WIDGET(node->data), module);
 
     /* FIXME: radio and rotator controller */
 
@@ -1471,14 +1927,14 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
 void gtk_sat_module_select_sat(GtkSatModule * module, gint catnum)
 {
     GtkWidget      *child;
-    guint           i;
+    GSList         *node;
 
     module->target = catnum;
 
     /* select satellite in each view */
-    for (i = 0; i < module->nviews; i++)
+    for (node = module->views; node != NULL; node = node->next)
     {
-        child = GTK_WIDGET(g_slist_nth_data(module->views, i));
+        child = GTK_WIDGET(node->data);
 
         if (IS_GTK_SINGLE_SAT(G_OBJECT(child)))
         {
@@ -7,6 +7,8 @@
 
 #include "qth-data.h"
 #include "gtk-sat-data.h"
+#include "pred-cache.h"
+#include "scrub-table.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -31,6 +33,25 @@ typedef enum {
     GTK_SAT_MOD_VIEW_NUM,       /*!< Number of modules */
 } gtk_sat_mod_view_t;
 
+/** Stages of the module cycle in order of priority */
+typedef enum {
+    GTK_SAT_MOD_STAGE_SATS = 0, /*!< Propagate satellites */
+    GTK_SAT_MOD_STAGE_CTRL,     /*!< Autotracking, radio and rotator control */
+    GTK_SAT_MOD_STAGE_VIEWS,    /*!< Update views */
+    GTK_SAT_MOD_STAGE_EVENTS,   /*!< Refresh AOS/LOS times */
+    GTK_SAT_MOD_STAGE_SKG,      /*!< Sky at a glance */
+    GTK_SAT_MOD_STAGE_NUM       /*!< Number of stages */
+} gtk_sat_mod_stage_t;
+
+/** Timing statistics for one stage of the module cycle */
+typedef struct {
+    gdouble         last;       /*!< Duration in the last cycle [msec] */
+    gdouble         avg;        /*!< Moving average of the duration [msec] */
+    gdouble         max;        /*!< Largest duration [msec] */
+    guint           runs;       /*!< Number of cycles where the stage ran */
+    guint           skipped;    /*!< Number of cycles where the stage was deferred */
+    guint           allocs;     /*!< Allocations in the last cycle, see alloc-count.h */
+} gtk_sat_mod_stats_t;
 
 #define GTK_TYPE_SAT_MODULE         (gtk_sat_module_get_type ())
 #define GTK_SAT_MODULE(obj)         G_TYPE_CHECK_INSTANCE_CAST (obj,\
@@ -68,16 +89,22 @@ struct _gtk_sat_module {
     guint           head_timeout;
     guint           event_count;
     guint           event_timeout;
+    GPtrArray      *event_queue;        /*!< Satellites waiting for AOS/LOS refresh */
+    guint           event_next; /*!< Index of the next satellite in event_queue */
+    gboolean        event_refine;       /*!< Refresh by refining the previous AOS/LOS */
+    pred_cache_t   *pcache;     /*!< Predictions saved between sessions, may be NULL */
 
     /* layout and children */
     guint          *grid;       /*!< The grid layout array [(type,left,right,top,bottom),...] */
     guint           nviews;     /*!< The number of views */
-    GSList         *views;      /*!< Pointers to the views */
+    GSList         *views;      /*!< Pointers to the views, NULL until shown */
+    GtkWidget      *layout;     /*!< The grid containing the views */
 
     GKeyFile       *cfgdata;    /*!< Configuration data. */
     qth_t          *qth;        /*!< QTH information. */
     qth_small_t     qth_event;  /*!< QTH information for last AOS/LOS update. */
     GHashTable     *satellites; /*!< Satellites. */
+    sat_t          *satstore;   /*!< Storage of the satellites (one block) */
 
     guint32         timeout;    /*!< Timeout value [msec] */
 
@@ -88,6 +115,24 @@ struct _gtk_sat_module {
                                    finished or not. Also used for blocking
                                    the module during TLE update. */
 
+    /* cycle scheduling */
+    gtk_sat_mod_stats_t stats[GTK_SAT_MOD_STAGE_NUM];   /*!< Per-stage timing */
+    gdouble         cycle_last; /*!< Duration of the last cycle [msec] */
+    guint           cycles;     /*!< Number of cycles */
+    guint           overruns;   /*!< Cycles that exceeded the time budget */
+    guint           missed;     /*!< Cycles skipped because the module was busy */
+    guint           views_deferred;     /*!< Consecutive cycles without view update */
+    guint           cycle_allocs;       /*!< Allocations in the last cycle */
+    guint           view_allocs[GTK_SAT_MOD_VIEW_NUM];  /*!< Allocations per view type in the last cycle */
+    guint           stage_allocs;       /*!< Allocation count when the current stage started */
+    GtkWidget      *statswin;   /*!< Cycle statistics window */
+
+    /* update decimation */
+    GHashTable     *decim;      /*!< catnum -> sat_decim_t */
+    gdouble         view_res;   /*!< Angular resolution of the views [deg] */
+    guint           sats_propagated;    /*!< Satellites propagated in the last cycle */
+    guint           sats_extrapolated;  /*!< Satellites extrapolated in the last cycle */
+
     /* time keeping */
     gdouble         rtNow;      /*!< Real-time in this cycle */
     gdouble         rtPrev;     /*!< Real-time in previous cycle */
@@ -109,6 +154,9 @@ struct _gtk_sat_module {
     GtkWidget      *tmgReset;   /*!< Reset button */
     GtkWidget      *tmgWin;     /*!< Window containing the widgets. */
     GtkWidget      *tmgState;   /*!< Status label indicating RT/SRT/MAN */
+    gboolean        tmgScrubbing;       /*!< Flag indicating that time is being dragged */
+    guint           tmgScrubTimer;      /*!< Timeout ending the scrubbing */
+    scrub_table_t  *scrub;      /*!< Precomputed data used while scrubbing */
 
     gboolean        reset;      /*!< Flag indicating whether time reset is in progress */
 
@@ -131,6 +179,7 @@ void            gtk_sat_module_close_cb(GtkWidget * button, gpointer data);
 void            gtk_sat_module_config_cb(GtkWidget * button, gpointer data);
 
 void            gtk_sat_module_reload_sats(GtkSatModule * module);
+void            gtk_sat_module_create_views(GtkSatModule * module);
 void            gtk_sat_module_reconf(GtkSatModule * module, gboolean local);
 void            gtk_sat_module_select_sat(GtkSatModule * module, gint catnum);
 
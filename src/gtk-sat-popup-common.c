@@ -21,10 +21,12 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-popup-common.h"
+#include "link-dialog.h"
 #include "orbit-tools.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-pass-dialogs.h"
+#include "time-tools.h"
 
 
 void add_pass_menu_items(GtkWidget * menu, sat_t * sat, qth_t * qth,
@@ -63,6 +65,28 @@ void add_pass_menu_items(GtkWidget * menu, sat_t * sat, qth_t * qth,
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
 }
 
+/**
+ * Add the satellite to satellite link menu item.
+ *
+ * @param menu The popup menu.
+ * @param sat The satellite the menu belongs to.
+ * @param sats The other satellites to search links with.
+ * @param tstamp Pointer to the time of the view.
+ * @param widget The view; its toplevel is the parent of the dialog.
+ */
+void add_link_menu_item(GtkWidget * menu, sat_t * sat, GHashTable * sats,
+                        gdouble * tstamp, GtkWidget * widget)
+{
+    GtkWidget      *menuitem;
+
+    menuitem = gtk_menu_item_new_with_label(_("Links to other satellites"));
+    g_object_set_data(G_OBJECT(menuitem), "sat", sat);
+    g_object_set_data(G_OBJECT(menuitem), "sats", sats);
+    g_object_set_data(G_OBJECT(menuitem), "tstamp", tstamp);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(show_links_cb), widget);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+}
+
 void show_current_pass_cb(GtkWidget * menuitem, gpointer data)
 {
     sat_t          *sat;
@@ -114,6 +138,21 @@ void show_future_passes_cb(GtkWidget * menuitem, gpointer data)
     show_future_passes_dialog(sat, qth, *tstamp, toplevel);
 }
 
+void show_links_cb(GtkWidget * menuitem, gpointer data)
+{
+    sat_t          *sat;
+    GHashTable     *sats;
+    gdouble        *tstamp;
+    GtkWindow      *toplevel =
+        GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(data)));
+
+    sat = SAT(g_object_get_data(G_OBJECT(menuitem), "sat"));
+    sats = (GHashTable *) g_object_get_data(G_OBJECT(menuitem), "sats");
+    tstamp = (gdouble *) (g_object_get_data(G_OBJECT(menuitem), "tstamp"));
+
+    link_dialog_show(sat, sats, *tstamp, toplevel);
+}
+
 void show_next_pass_dialog(sat_t * sat, qth_t * qth, gdouble tstamp,
                            GtkWindow * toplevel)
 {
@@ -181,52 +220,22 @@ void show_next_pass_dialog(sat_t * sat, qth_t * qth, gdouble tstamp,
 void show_future_passes_dialog(sat_t * sat, qth_t * qth, gdouble tstamp,
                                GtkWindow * toplevel)
 {
-    GSList         *passes = NULL;
-    GtkWidget      *dialog;
+    pass_job_t     *job;
+    gint            days;
 
     /* check wheather sat actially has AOS */
     if (has_aos(sat, qth))
     {
-
         if (sat_cfg_get_bool(SAT_CFG_BOOL_PRED_USE_REAL_T0))
-        {
-            passes = get_next_passes(sat, qth,
-                                     sat_cfg_get_int
-                                     (SAT_CFG_INT_PRED_LOOK_AHEAD),
-                                     sat_cfg_get_int
-                                     (SAT_CFG_INT_PRED_NUM_PASS));
-        }
-        else
-        {
-            passes = get_passes(sat, qth, tstamp,
-                                sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD),
-                                sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_PASS));
-
-        }
+            tstamp = get_current_daynum();
 
+        /* long look-ahead times are searched in parallel and the passes
+           are shown as they are found */
+        days = sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+        job = pass_job_new(sat, qth, tstamp, days,
+                           sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_PASS));
 
-        if (passes != NULL)
-        {
-            show_passes(sat->nickname, qth, passes, GTK_WIDGET(toplevel));
-        }
-        else
-        {
-            /* show dialog that there are no passes within time frame */
-            dialog = gtk_message_dialog_new(toplevel,
-                                            GTK_DIALOG_MODAL |
-                                            GTK_DIALOG_DESTROY_WITH_PARENT,
-                                            GTK_MESSAGE_INFO,
-                                            GTK_BUTTONS_OK,
-                                            _("Satellite %s has no passes\n"
-                                              "within the next %d days"),
-                                            sat->nickname,
-                                            sat_cfg_get_int
-                                            (SAT_CFG_INT_PRED_LOOK_AHEAD));
-
-            gtk_dialog_run(GTK_DIALOG(dialog));
-            gtk_widget_destroy(dialog);
-        }
-
+        show_passes_job(sat->nickname, qth, job, days, GTK_WIDGET(toplevel));
     }
     else
     {
@@ -7,9 +7,13 @@
 void            add_pass_menu_items(GtkWidget * menu, sat_t * sat,
                                     qth_t * qth, gdouble * tstamp,
                                     GtkWidget * widget);
+void            add_link_menu_item(GtkWidget * menu, sat_t * sat,
+                                   GHashTable * sats, gdouble * tstamp,
+                                   GtkWidget * widget);
 void            show_current_pass_cb(GtkWidget * menuitem, gpointer data);
 void            show_next_pass_cb(GtkWidget * menuitem, gpointer data);
 void            show_future_passes_cb(GtkWidget * menuitem, gpointer data);
+void            show_links_cb(GtkWidget * menuitem, gpointer data);
 void            show_next_pass_dialog(sat_t * sat, qth_t * qth,
                                       gdouble tstamp, GtkWindow * toplevel);
 void            show_future_passes_dialog(sat_t * sat, qth_t * qth,
@@ -581,6 +581,7 @@ static void load_cat_file(GtkSatSelector * selector, const gchar * fname)
                 catnum = (gint) g_ascii_strtoll(buff, NULL, 0);
 
                 /* try to read satellite data */
+                memset(&sat, 0, sizeof(sat_t));
                 if (gtk_sat_data_read_sat(catnum, &sat))
                 {
                     /* error */
@@ -599,11 +600,10 @@ static void load_cat_file(GtkSatSelector * selector, const gchar * fname)
                                        sat.jul_epoch,
                                        GTK_SAT_SELECTOR_COL_SELECTED, FALSE,
                                        -1);
-                    g_free(sat.name);
-                    g_free(sat.nickname);
                     num++;
                 }
 
+                gtk_sat_data_clear_sat(&sat);
                 g_free(buff);
             }
             sat_log_log(SAT_LOG_LEVEL_INFO,
@@ -754,6 +754,7 @@ static void create_and_fill_models(GtkSatSelector * selector)
             buffv = g_strsplit(fname, ".", 0);
             catnum = (gint) g_ascii_strtoll(buffv[0], NULL, 0);
 
+            memset(&sat, 0, sizeof(sat_t));
             if (gtk_sat_data_read_sat(catnum, &sat))
             {
                 /* error */
@@ -769,11 +770,10 @@ static void create_and_fill_models(GtkSatSelector * selector)
                                    GTK_SAT_SELECTOR_COL_EPOCH, sat.jul_epoch,
                                    GTK_SAT_SELECTOR_COL_SELECTED, FALSE, -1);
 
-                g_free(sat.name);
-                g_free(sat.nickname);
                 num++;
             }
 
+            gtk_sat_data_clear_sat(&sat);
             g_strfreev(buffv);
         }
     }
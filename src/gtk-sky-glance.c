@@ -681,8 +681,11 @@ static void create_sat(gpointer key, gpointer value, gpointer data)
     get_colors(skg->satcnt++, &bcol, &fcol);
     maxdt = skg->te - skg->ts;
 
-    /* get passes for satellite */
-    passes = get_passes(sat, skg->qth, skg->ts, maxdt, 10);
+    /* get passes for satellite; the passes that are still in the window
+       are reused from the last time, and the module rebuilds the view when
+       the rest has been found in the background */
+    passes = pred_cache_get_passes(skg->pcache, sat, skg->qth, skg->ts,
+                                   maxdt, 10);
     n = g_slist_length(passes);
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s:%d: %s has %d passes within %.4f days\n"),
@@ -768,8 +771,10 @@ static void create_sat(gpointer key, gpointer value, gpointer data)
  * @param sats Pointer to the hash table containing the asociated satellites.
  * @param qth Pointer to the ground station data.
  * @param ts The t0 for the timeline or 0 to use the current date and time.
+ * @param pcache The prediction cache of the module or NULL.
  */
-GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
+GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts,
+                                   pred_cache_t * pcache)
 {
     GtkSkyGlance   *skg;
     guint           number;
@@ -785,6 +790,7 @@ GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
     /* FIXME? */
     skg->sats = sats;
     skg->qth = qth;
+    skg->pcache = pcache;
 
     /* get settings */
     skg->numsat = g_hash_table_size(sats);
@@ -34,6 +34,7 @@
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
 
+#include "pred-cache.h"
 #include "predict-tools.h"
 
 /* *INDENT-OFF* */
@@ -72,6 +73,7 @@ struct _GtkSkyGlance {
 
     GHashTable     *sats;       /* Local copy of satellites. */
     qth_t          *qth;        /* Pointer to current location. */
+    pred_cache_t   *pcache;     /* Prediction cache of the module or NULL. */
 
     GSList         *passes;     /* Canvas items representing each pass.
                                  * Each element in the list is of type sky_pass_t.
@@ -112,7 +114,8 @@ struct _GtkSkyGlanceClass {
 
 
 GType           gtk_sky_glance_get_type(void);
-GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts);
+GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts,
+                                   pred_cache_t * pcache);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -0,0 +1,357 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Satellite to satellite link dialog.
+ *
+ * Lists the mutual visibility windows between one satellite and the other
+ * satellites of a module.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+
+#include "compat.h"
+#include "gtk-sat-data.h"
+#include "link-dialog.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "time-tools.h"
+
+
+enum {
+    LINK_COL_SAT = 0,
+    LINK_COL_START,
+    LINK_COL_END,
+    LINK_COL_DURATION,
+    LINK_COL_MIN_RANGE,
+    LINK_COL_MAX_RANGE,
+    LINK_COL_NUMBER
+};
+
+static const gchar *LINK_COL_TITLE[LINK_COL_NUMBER] = {
+    N_("Satellite"),
+    N_("Start"),
+    N_("End"),
+    N_("Duration"),
+    N_("Min Range [km]"),
+    N_("Max Range [km]")
+};
+
+/* link search of a dialog, run in a background thread */
+typedef struct {
+    sat_t          *sat;        /* private copies of the satellites */
+    GHashTable     *sats;
+    gdouble         t0;
+    gint            hours;
+    gint            margin;
+    GSList         *links;
+    GThread        *thread;
+    GtkWidget      *dialog;
+    GtkWidget      *list;
+    GtkWidget      *label;
+} link_job_dlg_t;
+
+
+static void link_dialog_response(GtkWidget * dialog, gint response,
+                                 gpointer data)
+{
+    (void)response;
+    (void)data;
+
+    gtk_widget_destroy(dialog);
+}
+
+static void time_cell_data_function(GtkTreeViewColumn * col,
+                                    GtkCellRenderer * renderer,
+                                    GtkTreeModel * model,
+                                    GtkTreeIter * iter, gpointer column)
+{
+    gdouble         number;
+    gchar           buff[TIME_FORMAT_MAX_LENGTH];
+    gchar          *fmtstr;
+    guint           coli = GPOINTER_TO_UINT(column);
+
+    (void)col;
+
+    gtk_tree_model_get(model, iter, coli, &number, -1);
+
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, number);
+    g_object_set(renderer, "text", buff, NULL);
+    g_free(fmtstr);
+}
+
+static void duration_cell_data_function(GtkTreeViewColumn * col,
+                                        GtkCellRenderer * renderer,
+                                        GtkTreeModel * model,
+                                        GtkTreeIter * iter, gpointer column)
+{
+    gdouble         number;
+    gchar          *buff;
+    guint           coli = GPOINTER_TO_UINT(column);
+    guint           h, m, s;
+
+    (void)col;
+
+    gtk_tree_model_get(model, iter, coli, &number, -1);
+
+    /* convert julian date to seconds */
+    s = (guint) (number * 86400);
+    h = s / 3600;
+    s -= 3600 * h;
+    m = s / 60;
+    s -= 60 * m;
+
+    buff = g_strdup_printf("%02d:%02d:%02d", h, m, s);
+    g_object_set(renderer, "text", buff, NULL);
+    g_free(buff);
+}
+
+static void range_cell_data_function(GtkTreeViewColumn * col,
+                                     GtkCellRenderer * renderer,
+                                     GtkTreeModel * model,
+                                     GtkTreeIter * iter, gpointer column)
+{
+    gdouble         number;
+    gchar          *buff;
+    guint           coli = GPOINTER_TO_UINT(column);
+
+    (void)col;
+
+    gtk_tree_model_get(model, iter, coli, &number, -1);
+
+    buff = g_strdup_printf("%.0f", number);
+    g_object_set(renderer, "text", buff, NULL);
+    g_free(buff);
+}
+
+static GtkWidget *create_list(void)
+{
+    GtkWidget      *list;
+    GtkListStore   *store;
+    GtkCellRenderer *renderer;
+    GtkTreeViewColumn *column;
+    guint           i;
+
+    list = gtk_tree_view_new();
+
+    for (i = 0; i < LINK_COL_NUMBER; i++)
+    {
+        renderer = gtk_cell_renderer_text_new();
+        g_object_set(G_OBJECT(renderer), "xalign",
+                     (i == LINK_COL_SAT) ? 0.0 : 0.5, NULL);
+        column = gtk_tree_view_column_new_with_attributes(_(LINK_COL_TITLE[i]),
+                                                          renderer, "text", i,
+                                                          NULL);
+        gtk_tree_view_column_set_alignment(column, 0.5);
+        gtk_tree_view_column_set_sort_column_id(column, i);
+        gtk_tree_view_insert_column(GTK_TREE_VIEW(list), column, -1);
+
+        if (i == LINK_COL_START || i == LINK_COL_END)
+            gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                                    time_cell_data_function,
+                                                    GUINT_TO_POINTER(i),
+                                                    NULL);
+        else if (i == LINK_COL_DURATION)
+            gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                                    duration_cell_data_function,
+                                                    GUINT_TO_POINTER(i),
+                                                    NULL);
+        else if (i != LINK_COL_SAT)
+            gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                                    range_cell_data_function,
+                                                    GUINT_TO_POINTER(i),
+                                                    NULL);
+    }
+
+    store = gtk_list_store_new(LINK_COL_NUMBER, G_TYPE_STRING, G_TYPE_DOUBLE,
+                               G_TYPE_DOUBLE, G_TYPE_DOUBLE, G_TYPE_DOUBLE,
+                               G_TYPE_DOUBLE);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(store));
+    g_object_unref(store);
+
+    return list;
+}
+
+static void fill_list(GtkWidget * list, GSList * links)
+{
+    GtkListStore   *store;
+    GtkTreeIter     item;
+    link_t         *link;
+
+    store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(list)));
+
+    for (; links != NULL; links = links->next)
+    {
+        link = LINK(links->data);
+        gtk_list_store_append(store, &item);
+        gtk_list_store_set(store, &item,
+                           LINK_COL_SAT, link->satname,
+                           LINK_COL_START, link->start,
+                           LINK_COL_END, link->end,
+                           LINK_COL_DURATION, link->end - link->start,
+                           LINK_COL_MIN_RANGE, link->min_range,
+                           LINK_COL_MAX_RANGE, link->max_range, -1);
+    }
+}
+
+static void link_job_free(link_job_dlg_t * ld)
+{
+    free_links(ld->links);
+    g_hash_table_destroy(ld->sats);
+    gtk_sat_data_free_sat(ld->sat);
+    g_free(ld);
+}
+
+/* The dialog is closed during the search; link_job_done() cleans up */
+static void link_dialog_destroy(GtkWidget * dialog, gpointer data)
+{
+    link_job_dlg_t *ld = data;
+
+    (void)dialog;
+
+    ld->dialog = NULL;
+}
+
+/* Show the links found by the search; called on the main thread */
+static gboolean link_job_done(gpointer data)
+{
+    link_job_dlg_t *ld = data;
+    gchar          *buff;
+
+    g_thread_join(ld->thread);
+
+    if (ld->dialog != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Found %d link windows for %s"),
+                    __func__, g_slist_length(ld->links), ld->sat->nickname);
+
+        fill_list(ld->list, ld->links);
+
+        buff = g_strdup_printf(_("%d windows within the next %d hours "
+                                 "(atmosphere margin %d km)"),
+                               g_slist_length(ld->links), ld->hours,
+                               ld->margin);
+        gtk_label_set_text(GTK_LABEL(ld->label), buff);
+        g_free(buff);
+
+        g_signal_handlers_disconnect_by_func(ld->dialog, link_dialog_destroy,
+                                             ld);
+    }
+
+    link_job_free(ld);
+
+    return FALSE;
+}
+
+static gpointer link_job_thread(gpointer data)
+{
+    link_job_dlg_t *ld = data;
+
+    ld->links = get_links_multi(ld->sat, ld->sats, ld->t0, ld->hours / 24.0,
+                                ld->margin);
+    g_idle_add(link_job_done, ld);
+
+    return NULL;
+}
+
+/**
+ * Show the link windows between a satellite and a set of satellites.
+ *
+ * @param sat The satellite.
+ * @param sats The other satellites (catnum -> sat_t), e.g. those of the
+ *             module sat belongs to.
+ * @param t0 The start of the search.
+ * @param toplevel The parent window.
+ *
+ * The search window and the atmosphere margin are taken from
+ * SAT_CFG_INT_LINK_WINDOW and SAT_CFG_INT_LINK_MARGIN. The search runs in
+ * a background thread and the list is filled when it is done.
+ */
+void link_dialog_show(sat_t * sat, GHashTable * sats, gdouble t0,
+                      GtkWindow * toplevel)
+{
+    GtkWidget      *swin, *vbox;
+    GHashTableIter  iter;
+    gpointer        value;
+    sat_t          *copy;
+    link_job_dlg_t *ld;
+    gchar          *title;
+    gchar          *buff;
+
+    /* the search runs on copies; the module goes on updating its
+       satellites and may be closed before the search is done */
+    ld = g_new0(link_job_dlg_t, 1);
+    ld->sat = g_new0(sat_t, 1);
+    gtk_sat_data_copy_sat(sat, ld->sat, NULL);
+    ld->sats = g_hash_table_new_full(g_int_hash, g_int_equal, NULL,
+                                     (GDestroyNotify) gtk_sat_data_free_sat);
+    g_hash_table_iter_init(&iter, sats);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        copy = g_new0(sat_t, 1);
+        gtk_sat_data_copy_sat(SAT(value), copy, NULL);
+        g_hash_table_insert(ld->sats, &copy->tle.catnr, copy);
+    }
+    ld->t0 = t0;
+    ld->hours = sat_cfg_get_int(SAT_CFG_INT_LINK_WINDOW);
+    ld->margin = sat_cfg_get_int(SAT_CFG_INT_LINK_MARGIN);
+
+    ld->list = create_list();
+    swin = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(swin),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(swin), ld->list);
+
+    buff = g_strdup_printf(_("Searching the next %d hours..."), ld->hours);
+    ld->label = gtk_label_new(buff);
+    g_free(buff);
+
+    title = g_strdup_printf(_("Links for %s"), sat->nickname);
+    ld->dialog = gtk_dialog_new_with_buttons(title, toplevel,
+                                             GTK_DIALOG_DESTROY_WITH_PARENT,
+                                             "_Close", GTK_RESPONSE_CLOSE,
+                                             NULL);
+    g_free(title);
+
+    buff = icon_file_name("gpredict-sat-list.png");
+    gtk_window_set_icon_from_file(GTK_WINDOW(ld->dialog), buff, NULL);
+    g_free(buff);
+
+    gtk_window_set_modal(GTK_WINDOW(ld->dialog), FALSE);
+    g_signal_connect(ld->dialog, "response",
+                     G_CALLBACK(link_dialog_response), NULL);
+    g_signal_connect(ld->dialog, "destroy", G_CALLBACK(link_dialog_destroy),
+                     ld);
+
+    vbox = gtk_dialog_get_content_area(GTK_DIALOG(ld->dialog));
+    gtk_box_pack_start(GTK_BOX(vbox), swin, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), ld->label, FALSE, FALSE, 0);
+
+    gtk_window_set_default_size(GTK_WINDOW(ld->dialog), -1, 300);
+    gtk_widget_show_all(ld->dialog);
+
+    ld->thread = g_thread_new("gpredict_links", link_job_thread, ld);
+}
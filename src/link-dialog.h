@@ -0,0 +1,29 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef LINK_DIALOG_H
+#define LINK_DIALOG_H 1
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+void            link_dialog_show(sat_t * sat, GHashTable * sats,
+                                 gdouble t0, GtkWindow * toplevel);
+
+#endif
@@ -29,14 +29,22 @@
 #include <winsock2.h>
 #endif
 
+#include "alloc-count.h"
 #include "compat.h"
 #include "gtk-sat-selector.h"
 #include "gui.h"
 #include "first-time.h"
+#include "gnss-dop.h"
+#include "pass-export.h"
+#include "pred-server.h"
 #include "tle-update.h"
 #include "mod-mgr.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "sat-stream.h"
+#include "sat-trace.h"
+#include "startup-prof.h"
+#include "time-tools.h"
 
 
 /* Main application widget. */
@@ -48,12 +56,50 @@ static gboolean cleantle = FALSE;
 /* Command line flag for cleaning TRSP data */
 static gboolean cleantrsp = FALSE;
 
+/* Command line options for the GNSS DOP timeline */
+static gchar   *dopgroup = NULL;
+static gchar   *dopoutput = NULL;
+static gint     dopmask = -1;
+
+/* Command line options for the pass export benchmark */
+static gint     benchrows = 0;
+static gchar   *benchoutput = NULL;
+
+/* Command line option for running prediction server queries */
+static gchar   *queryfile = NULL;
+
+/* Command line flag for printing the startup profile */
+static gboolean profilestartup = FALSE;
+
+/* Command line option for tracing */
+static gchar   *tracefile = NULL;
+
 /* Command line options. */
 static GOptionEntry entries[] = {
     {"clean-tle", 0, 0, G_OPTION_ARG_NONE, &cleantle,
      "Clean the TLE data in user's configuration directory", NULL},
     {"clean-trsp", 0, 0, G_OPTION_ARG_NONE, &cleantrsp,
      "Clean the transponder data in user's configuration directory", NULL},
+    {"dop-group", 0, 0, G_OPTION_ARG_STRING, &dopgroup,
+     "Export GNSS visibility and DOP at the default location for the "
+     "satellites in FILE (e.g. gps-ops.cat) and exit", "FILE"},
+    {"dop-mask", 0, 0, G_OPTION_ARG_INT, &dopmask,
+     "Elevation mask in degrees for --dop-group", "DEG"},
+    {"dop-output", 0, 0, G_OPTION_ARG_FILENAME, &dopoutput,
+     "Output file for --dop-group (default: standard output)", "FILE"},
+    {"export-bench", 0, 0, G_OPTION_ARG_INT, &benchrows,
+     "Measure the pass export throughput with ROWS rows per format and exit",
+     "ROWS"},
+    {"export-bench-output", 0, 0, G_OPTION_ARG_FILENAME, &benchoutput,
+     "Output file for --export-bench (default: temporary file)", "FILE"},
+    {"query", 0, 0, G_OPTION_ARG_FILENAME, &queryfile,
+     "Run the prediction server queries in FILE (- for standard input), "
+     "print the responses and exit", "FILE"},
+    {"profile-startup", 0, 0, G_OPTION_ARG_NONE, &profilestartup,
+     "Print the time spent in each phase of the startup", NULL},
+    {"trace", 0, 0, G_OPTION_ARG_FILENAME, &tracefile,
+     "Record the module cycles, predictions and radio/rotator commands and "
+     "write them to FILE in the Chrome trace event format on exit", "FILE"},
     {NULL}
 };
 
@@ -81,6 +127,8 @@ static void     tle_mon_stop(void);
 static gpointer update_tle_thread(gpointer data);
 static void     clean_tle(void);
 static void     clean_trsp(void);
+static gint     export_dop(void);
+static gboolean startup_done(gpointer data);
 
 #ifdef G_OS_WIN32
 static void     InitWinSock2(void);
@@ -93,14 +141,16 @@ int main(int argc, char *argv[])
     GError         *err = NULL;
     GOptionContext *context;
     guint           error = 0;
-
+    gboolean        gui;
+    gint64          start;
 
 #ifdef ENABLE_NLS
     bindtextdomain(PACKAGE, PACKAGE_LOCALE_DIR);
     bind_textdomain_codeset(PACKAGE, "UTF-8");
     textdomain(PACKAGE);
 #endif
-    gtk_init(&argc, &argv);
+    /* the display is not needed for the headless exports */
+    gui = gtk_init_check(&argc, &argv);
 
     context = g_option_context_new("");
     g_option_context_add_main_entries(context, entries, GETTEXT_PACKAGE);
@@ -109,13 +159,26 @@ int main(int argc, char *argv[])
                                    "tracking and orbit prediction program.\n"
                                    "Gpredict does not require any command line "
                                    "options for nominal operation."));
-    g_option_context_add_group(context, gtk_get_option_group(TRUE));
+    g_option_context_add_group(context, gtk_get_option_group(gui));
     if (!g_option_context_parse(context, &argc, &argv, &err))
         g_print(_("Option parsing failed: %s\n"), err->message);
 
+    if (profilestartup)
+        startup_prof_start();
+
+    start = g_get_monotonic_time();
     sat_log_init();
     sat_cfg_load();
     sat_log_set_level(sat_cfg_get_int(SAT_CFG_INT_LOG_LEVEL));
+    startup_prof_add("load configuration", start);
+
+    if (tracefile != NULL)
+        sat_trace_start(tracefile);
+
+    if (alloc_count_enable())
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Counting allocations of the module cycle"),
+                    __func__);
 
     if (cleantle)
         clean_tle();
@@ -124,7 +187,9 @@ int main(int argc, char *argv[])
         clean_trsp();
 
     /* check that user settings are ok */
+    start = g_get_monotonic_time();
     error = first_time_check_run();
+    startup_prof_add("check user configuration", start);
     if (error)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -136,9 +201,54 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (dopgroup != NULL)
+    {
+        error = export_dop();
+        g_option_context_free(context);
+        sat_trace_stop();
+        sat_log_close();
+        sat_cfg_close();
+
+        return error;
+    }
+
+    if (benchrows > 0)
+    {
+        error = pass_export_bench(benchrows, benchoutput);
+        g_option_context_free(context);
+        sat_trace_stop();
+        sat_log_close();
+        sat_cfg_close();
+
+        return error;
+    }
+
+    if (queryfile != NULL)
+    {
+        error = pred_server_query_file(queryfile);
+        g_option_context_free(context);
+        sat_trace_stop();
+        sat_log_close();
+        sat_cfg_close();
+
+        return error;
+    }
+
+    if (!gui)
+    {
+        g_printerr(_("Cannot open display\n"));
+        return 1;
+    }
+
     /* create application */
     gpredict_app_create();
+    start = g_get_monotonic_time();
     gtk_widget_show_all(app);
+    startup_prof_add("show main window", start);
+
+    /* the first frame is drawn before the idle sources run */
+    if (startup_prof_enabled())
+        g_idle_add(startup_done, NULL);
 
     //sat_debugger_run ();
 
@@ -150,10 +260,15 @@ int main(int argc, char *argv[])
     InitWinSock2();
 #endif
 
+    /* publish tracking state to external clients if enabled */
+    sat_stream_start();
+    pred_server_start();
+
     gtk_main();
 
     g_option_context_free(context);
 
+    sat_trace_stop();
     sat_cfg_save();
     sat_log_close();
     sat_cfg_close();
@@ -320,6 +435,9 @@ static void gpredict_app_destroy(GtkWidget * widget, gpointer data)
     /* stop TLE monitoring task */
     tle_mon_stop();
 
+    sat_stream_stop();
+    pred_server_stop();
+
     /* GUI timers are stopped automatically */
     mod_mgr_save_state();
 
@@ -626,3 +744,68 @@ static void clean_trsp(void)
     }
     g_free(targetdirname);
 }
+
+/**
+ * Export the GNSS visibility and DOP timeline without the GUI.
+ *
+ * @return 0 on success, 1 otherwise.
+ *
+ * Uses the satellite group given with --dop-group, the default QTH and the
+ * SAT_CFG_INT_DOP_WINDOW hours starting now. The elevation mask is given
+ * with --dop-mask or SAT_CFG_INT_DOP_MASK.
+ */
+static gint export_dop(void)
+{
+    dop_job_t      *job;
+    qth_t          *qth;
+    gchar          *confdir, *buffer, *qthfile;
+    gdouble         t0;
+    gint            retcode = 1;
+
+    qth = g_new0(qth_t, 1);
+    confdir = get_user_conf_dir();
+    buffer = sat_cfg_get_str(SAT_CFG_STR_DEF_QTH);
+    qthfile = g_strconcat(confdir, G_DIR_SEPARATOR_S, buffer, NULL);
+    if (!qth_data_read(qthfile, qth))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Can not load default QTH file %s"),
+                    __func__, buffer);
+        g_printerr(_("Can not load default QTH file %s\n"), buffer);
+        qth_data_free(qth);
+        g_free(confdir);
+        g_free(buffer);
+        g_free(qthfile);
+
+        return 1;
+    }
+    g_free(confdir);
+    g_free(buffer);
+    g_free(qthfile);
+
+    t0 = get_current_daynum();
+    job = dop_job_new(t0, t0 + sat_cfg_get_int(SAT_CFG_INT_DOP_WINDOW) / 24.0);
+    job->mask = (dopmask >= 0) ? dopmask :
+        sat_cfg_get_int(SAT_CFG_INT_DOP_MASK);
+
+    if (dop_job_load_cat(job, dopgroup) == 0)
+        g_printerr(_("No satellites could be loaded from %s\n"), dopgroup);
+    else if (dop_job_run(job, qth) &&
+             !dop_job_export(job, dopoutput ? dopoutput : "-"))
+        retcode = 0;
+
+    dop_job_free(job);
+    qth_data_free(qth);
+
+    return retcode;
+}
+
+/** Print the startup profile once the main window has been drawn. */
+static gboolean startup_done(gpointer data)
+{
+    (void)data;
+
+    startup_prof_print();
+
+    return FALSE;
+}
@@ -27,6 +27,7 @@
 #endif
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
+#include <string.h>
 
 #include "compat.h"
 #include "config-keys.h"
@@ -128,6 +129,7 @@ static void add_selected_sat(GtkListStore * store, gint catnum)
     /* if we have made it so far, satellite is not in list */
 
     /* Get satellite data */
+    memset(&sat, 0, sizeof(sat_t));
     if (gtk_sat_data_read_sat(catnum, &sat))
     {
         /* error */
@@ -143,9 +145,8 @@ static void add_selected_sat(GtkListStore * store, gint catnum)
                            GTK_SAT_SELECTOR_COL_NAME, sat.nickname,
                            GTK_SAT_SELECTOR_COL_CATNUM, catnum,
                            GTK_SAT_SELECTOR_COL_EPOCH, sat.jul_epoch, -1);
-        g_free(sat.name);
-        g_free(sat.nickname);
     }
+    gtk_sat_data_clear_sat(&sat);
 }
 
 /* Signal handler for "->" button signals */
@@ -48,21 +48,37 @@
  * The mod-mgr maintains an internal GSList with references to the opened modules.
  * This allows the mod-mgr to know about both docked and undocked modules.
  *
+ * The mod-mgr also owns the satellite data shared between the modules. Each
+ * satellite is read from disk once and propagated once per time step, no
+ * matter how many modules track it. The module timers are grouped by
+ * interval so that modules with the same refresh rate run in the same main
+ * loop iteration and at the same time.
+ *
+ * When the modules are restored at startup, the satellites of all modules
+ * are read in parallel before the modules are created, and the views of a
+ * docked module are only created when its tab is shown the first time.
+ *
  */
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
 #endif
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
+#include <string.h>
 
 #include "config-keys.h"
 #include "compat.h"
 #include "gtk-sat-module.h"
+#include "gtk-sat-data.h"
 #include "gtk-sat-module-popup.h"
 #include "mod-cfg.h"
 #include "mod-mgr.h"
+#include "pred-server.h"
+#include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "startup-prof.h"
+#include "time-tools.h"
 
 extern GtkWidget *app;
 
@@ -73,6 +89,52 @@ static GSList  *modules = NULL;
 /* The notebook widget for docked modules */
 static GtkWidget *nbook = NULL;
 
+/* The modules of the last session are being restored */
+static gboolean restoring = FALSE;
+
+/* Satellite shared by the modules */
+typedef struct {
+    gint            catnum;     /* catalogue number, used as hash key */
+    guint           refcount;   /* number of module copies */
+    sat_t           sat;        /* TLE data and shared propagator */
+    gdouble         eci_t;      /* time of the ECI state in sat (0 = none) */
+    gdouble         phase;      /* orbit phase at eci_t [rad] */
+    gboolean        obs_valid;  /* observer dependent fields in sat are valid */
+    gdouble         obs_lat;    /* observer of the observer dependent fields */
+    gdouble         obs_lon;
+    gdouble         obs_alt;
+} shared_sat_t;
+
+/* Shared satellites (catnum -> shared_sat_t) */
+static GHashTable *shared_sats = NULL;
+
+/* Satellite read by the preload pool */
+typedef struct {
+    gint            catnum;
+    gint            retcode;
+    sat_t           sat;
+} preload_job_t;
+
+/* Module timers with the same interval */
+typedef struct {
+    guint           interval;   /* interval [msec] */
+    guint           source;     /* GLib source ID */
+    GSList         *timers;     /* list of mod_timer_t */
+    gboolean        dispatching;
+} timer_group_t;
+
+typedef struct {
+    guint           id;
+    GSourceFunc     func;
+    gpointer        data;
+} mod_timer_t;
+
+static GSList  *timer_groups = NULL;
+static guint    timer_next_id = 1;
+
+/* Time of the timer group being dispatched (0 = none) */
+static gdouble  dispatch_daynum = 0.0;
+
 
 static void     update_window_title(void);
 static void     switch_page_cb(GtkNotebook * notebook,
@@ -80,6 +142,11 @@ static void     switch_page_cb(GtkNotebook * notebook,
                                guint page_num, gpointer user_data);
 
 static void     create_module_window(GtkWidget * module);
+static void     preload_modules(gchar ** mods);
+static void     shared_sat_reload(gpointer key, gpointer value,
+                                  gpointer user_data);
+static gboolean shared_sat_unused(gpointer key, gpointer value,
+                                  gpointer user_data);
 
 
 GtkWidget      *mod_mgr_create(void)
@@ -106,6 +173,10 @@ GtkWidget      *mod_mgr_create(void)
         mods = g_strsplit(openmods, ";", 0);
         count = g_strv_length(mods);
 
+        /* read the satellites of all modules at once */
+        preload_modules(mods);
+
+        restoring = TRUE;
         for (i = 0; i < count; i++)
         {
 
@@ -144,9 +215,21 @@ GtkWidget      *mod_mgr_create(void)
 
         }
 
-        /* set to the page open when gpredict was closed */
+        restoring = FALSE;
+
+        /* set to the page open when gpredict was closed; only this module
+           needs its views now */
         if (page >= 0)
             gtk_notebook_set_current_page(GTK_NOTEBOOK(nbook), page);
+        page = gtk_notebook_get_current_page(GTK_NOTEBOOK(nbook));
+        if (page >= 0)
+            gtk_sat_module_create_views(GTK_SAT_MODULE
+                                        (gtk_notebook_get_nth_page
+                                         (GTK_NOTEBOOK(nbook), page)));
+
+        /* satellites of modules that could not be restored */
+        if (shared_sats != NULL)
+            g_hash_table_foreach_remove(shared_sats, shared_sat_unused, NULL);
 
         g_strfreev(mods);
         g_free(openmods);
@@ -565,6 +648,10 @@ static void switch_page_cb(GtkNotebook * notebook,
                                                             (nbook), pg));
     gtk_window_set_title(GTK_WINDOW(app), title);
     g_free(title);
+
+    /* the pages switched through while restoring are not shown */
+    if (!restoring)
+        gtk_sat_module_create_views(GTK_SAT_MODULE(pg));
 }
 
 void mod_mgr_reload_sats()
@@ -581,6 +668,13 @@ void mod_mgr_reload_sats()
         return;
     }
 
+    /* the prediction server reads the new TLEs on the next query */
+    pred_server_reload();
+
+    /* refresh the shared data first so that the modules get the new TLEs */
+    if (shared_sats != NULL)
+        g_hash_table_foreach(shared_sats, shared_sat_reload, NULL);
+
     num = g_slist_length(modules);
     if (num == 0)
     {
@@ -688,3 +782,499 @@ static void create_module_window(GtkWidget * module)
                                      GTK_WINDOW(GTK_SAT_MODULE(module)->win));
     }
 }
+
+/* Read the satellites of the modules to be restored */
+static void preload_modules(gchar ** mods)
+{
+    GKeyFile       *cfgdata;
+    GArray         *catnums;
+    gint           *sats;
+    gchar          *confdir;
+    gchar          *modfile;
+    gsize           length;
+    guint           i;
+
+    catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+    confdir = get_modules_dir();
+
+    for (i = 0; mods[i] != NULL; i++)
+    {
+        modfile = g_strconcat(confdir, G_DIR_SEPARATOR_S,
+                              mods[i], ".mod", NULL);
+        cfgdata = g_key_file_new();
+        g_key_file_set_list_separator(cfgdata, ';');
+
+        /* errors are reported when the module is created */
+        if (g_key_file_load_from_file(cfgdata, modfile, G_KEY_FILE_NONE,
+                                      NULL))
+        {
+            sats = g_key_file_get_integer_list(cfgdata,
+                                               MOD_CFG_GLOBAL_SECTION,
+                                               MOD_CFG_SATS_KEY, &length,
+                                               NULL);
+            if (sats != NULL)
+                g_array_append_vals(catnums, sats, length);
+            g_free(sats);
+        }
+
+        g_key_file_free(cfgdata);
+        g_free(modfile);
+    }
+
+    mod_mgr_sat_preload((gint *) catnums->data, catnums->len);
+
+    g_free(confdir);
+    g_array_free(catnums, TRUE);
+}
+
+static void shared_sat_free(gpointer data)
+{
+    shared_sat_t   *ssat = data;
+
+    gtk_sat_data_clear_sat(&ssat->sat);
+    g_free(ssat);
+}
+
+/* Re-read the TLE data of a shared satellite, e.g. after a TLE update */
+static void shared_sat_reload(gpointer key, gpointer value,
+                              gpointer user_data)
+{
+    shared_sat_t   *ssat = value;
+    sat_t           sat;
+
+    (void)key;
+    (void)user_data;
+
+    memset(&sat, 0, sizeof(sat_t));
+    if (gtk_sat_data_read_sat(ssat->catnum, &sat))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error reading data for #%d, keeping old data"),
+                    __func__, ssat->catnum);
+        gtk_sat_data_clear_sat(&sat);
+        return;
+    }
+
+    gtk_sat_data_clear_sat(&ssat->sat);
+    memcpy(&ssat->sat, &sat, sizeof(sat_t));
+    ssat->eci_t = 0.0;
+    ssat->obs_valid = FALSE;
+}
+
+/* Remove a satellite that was preloaded but not used by any module */
+static gboolean shared_sat_unused(gpointer key, gpointer value,
+                                  gpointer user_data)
+{
+    (void)key;
+    (void)user_data;
+
+    return ((shared_sat_t *) value)->refcount == 0;
+}
+
+static void preload_job_run(gpointer data, gpointer user_data)
+{
+    preload_job_t  *job = data;
+
+    (void)user_data;
+
+    job->retcode = gtk_sat_data_read_sat(job->catnum, &job->sat);
+}
+
+/**
+ * Read satellites into the shared data in parallel.
+ *
+ * @param catnums The catalogue numbers.
+ * @param num The number of catalogue numbers.
+ *
+ * The .sat files of the satellites that are not shared yet are read, parsed
+ * and initialised in a pool with one thread per processor, so that the
+ * following mod_mgr_sat_acquire() calls only have to copy them. The
+ * satellites are added without copies; those that no module acquires are
+ * dropped by mod_mgr_create(). Satellites that can not be read are left out
+ * and reported again by mod_mgr_sat_acquire().
+ */
+void mod_mgr_sat_preload(const gint * catnums, gsize num)
+{
+    GThreadPool    *pool;
+    GPtrArray      *jobs;
+    GHashTable     *queued;
+    preload_job_t  *job;
+    shared_sat_t   *ssat;
+    GError         *error = NULL;
+    gint64          start;
+    gsize           i;
+
+    if (shared_sats == NULL)
+        shared_sats = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                            NULL, shared_sat_free);
+
+    start = g_get_monotonic_time();
+    jobs = g_ptr_array_new();
+    queued = g_hash_table_new(g_int_hash, g_int_equal);
+    pool = g_thread_pool_new(preload_job_run, NULL, g_get_num_processors(),
+                             FALSE, &error);
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not create thread pool (%s)"),
+                    __func__, error->message);
+        g_clear_error(&error);
+        pool = NULL;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        if (g_hash_table_contains(shared_sats, &catnums[i]) ||
+            g_hash_table_contains(queued, &catnums[i]))
+            continue;
+
+        job = g_new0(preload_job_t, 1);
+        job->catnum = catnums[i];
+        g_hash_table_add(queued, &job->catnum);
+        g_ptr_array_add(jobs, job);
+
+        if (pool != NULL)
+            g_thread_pool_push(pool, job, NULL);
+        else
+            preload_job_run(job, NULL);
+    }
+
+    /* wait for all satellites to be read */
+    if (pool != NULL)
+        g_thread_pool_free(pool, FALSE, TRUE);
+    g_hash_table_destroy(queued);
+
+    for (i = 0; i < jobs->len; i++)
+    {
+        job = g_ptr_array_index(jobs, i);
+        if (job->retcode == 0)
+        {
+            ssat = g_new0(shared_sat_t, 1);
+            ssat->catnum = job->catnum;
+            memcpy(&ssat->sat, &job->sat, sizeof(sat_t));
+            g_hash_table_insert(shared_sats, &ssat->catnum, ssat);
+        }
+        else
+        {
+            gtk_sat_data_clear_sat(&job->sat);
+        }
+        g_free(job);
+    }
+
+    if (jobs->len > 0)
+        startup_prof_add("read satellite data", start);
+
+    g_ptr_array_free(jobs, TRUE);
+}
+
+/**
+ * Get a copy of a shared satellite.
+ *
+ * @param catnum The catalogue number of the satellite.
+ * @param sat Pointer to the sat_t structure to fill.
+ * @param qth The observer of the module.
+ * @return 0 if successful, otherwise the error code of gtk_sat_data_read_sat().
+ *
+ * The .sat file is only read the first time a satellite is requested. The
+ * copy is initialised like gtk_sat_data_read_sat() followed by
+ * gtk_sat_data_init_sat() would do, and must be released with
+ * mod_mgr_sat_release() before it is freed.
+ */
+gint mod_mgr_sat_acquire(gint catnum, sat_t * sat, qth_t * qth)
+{
+    shared_sat_t   *ssat;
+    gint            retcode;
+
+    if (shared_sats == NULL)
+        shared_sats = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                            NULL, shared_sat_free);
+
+    ssat = g_hash_table_lookup(shared_sats, &catnum);
+    if (ssat == NULL)
+    {
+        ssat = g_new0(shared_sat_t, 1);
+        retcode = gtk_sat_data_read_sat(catnum, &ssat->sat);
+        if (retcode)
+        {
+            shared_sat_free(ssat);
+            return retcode;
+        }
+
+        ssat->catnum = catnum;
+        g_hash_table_insert(shared_sats, &ssat->catnum, ssat);
+    }
+
+    ssat->refcount++;
+
+    Sat_Copy(sat, &ssat->sat);
+    sat->name = g_strdup(ssat->sat.name);
+    sat->nickname = g_strdup(ssat->sat.nickname);
+    sat->website = g_strdup(ssat->sat.website);
+
+    /* the TLE is already preprocessed by select_ephemeris(); only reset
+       the propagator so that the copy initialises its own state */
+    sat->flags &= DEEP_SPACE_EPHEM_FLAG;
+    sat->jul_utc = 0.0;
+    sat->tsince = 0.0;
+    sat->ra = 0.0;
+    sat->dec = 0.0;
+    sat->aos = 0.0;
+    sat->los = 0.0;
+    gtk_sat_data_init_sat(sat, qth);
+
+    return 0;
+}
+
+/**
+ * Release a shared satellite.
+ *
+ * @param catnum The catalogue number of the satellite.
+ *
+ * The shared data is freed when the last copy has been released.
+ */
+void mod_mgr_sat_release(gint catnum)
+{
+    shared_sat_t   *ssat;
+
+    if (shared_sats == NULL)
+        return;
+
+    ssat = g_hash_table_lookup(shared_sats, &catnum);
+    if (ssat == NULL)
+        return;
+
+    if (--ssat->refcount == 0)
+        g_hash_table_remove(shared_sats, &catnum);
+}
+
+/* Copy the observer dependent fields */
+static void copy_obs(const sat_t * source, sat_t * dest)
+{
+    dest->velo = source->velo;
+    dest->az = source->az;
+    dest->el = source->el;
+    dest->range = source->range;
+    dest->range_rate = source->range_rate;
+    dest->ssplat = source->ssplat;
+    dest->ssplon = source->ssplon;
+    dest->alt = source->alt;
+    dest->ma = source->ma;
+    dest->phase = source->phase;
+    dest->footprint = source->footprint;
+    dest->orbit = source->orbit;
+}
+
+/**
+ * Calculate satellite data using the shared propagator.
+ *
+ * @param sat The module copy of the satellite.
+ * @param qth The observer.
+ * @param t The time.
+ *
+ * This function is equivalent to predict_calc(sat, qth, t). The satellite is
+ * propagated once per time step for all modules, and the observer dependent
+ * part is also shared when the modules use the same location. Satellites
+ * that are not shared, or whose TLE differs from the shared one, are
+ * calculated locally.
+ */
+void mod_mgr_sat_calc(sat_t * sat, qth_t * qth, gdouble t)
+{
+    shared_sat_t   *ssat = NULL;
+
+    if (shared_sats != NULL)
+        ssat = g_hash_table_lookup(shared_sats, &sat->tle.catnr);
+
+    if (ssat == NULL || ssat->sat.tle.epoch != sat->tle.epoch ||
+        ssat->sat.tle.xno != sat->tle.xno)
+    {
+        predict_calc(sat, qth, t);
+        return;
+    }
+
+    if (ssat->eci_t != t)
+    {
+        predict_calc_eci(&ssat->sat, t);
+        ssat->eci_t = t;
+        ssat->phase = ssat->sat.phase;
+        ssat->obs_valid = FALSE;
+    }
+
+    sat->pos = ssat->sat.pos;
+    sat->vel = ssat->sat.vel;
+    sat->jul_utc = ssat->sat.jul_utc;
+    sat->tsince = ssat->sat.tsince;
+
+    if (ssat->obs_valid && ssat->obs_lat == qth->lat &&
+        ssat->obs_lon == qth->lon && ssat->obs_alt == qth->alt)
+    {
+        copy_obs(&ssat->sat, sat);
+        return;
+    }
+
+    sat->phase = ssat->phase;
+    predict_calc_obs(sat, qth);
+
+    copy_obs(sat, &ssat->sat);
+    ssat->obs_valid = TRUE;
+    ssat->obs_lat = qth->lat;
+    ssat->obs_lon = qth->lon;
+    ssat->obs_alt = qth->alt;
+}
+
+/**
+ * Get the current time for the modules.
+ *
+ * @return The current time as Julian date.
+ *
+ * While a group of module timers is dispatched, every module gets the same
+ * time so that the shared propagation can be reused.
+ */
+gdouble mod_mgr_get_current_daynum()
+{
+    if (dispatch_daynum > 0.0)
+        return dispatch_daynum;
+
+    return get_current_daynum();
+}
+
+static void timer_group_free(timer_group_t * group)
+{
+    timer_groups = g_slist_remove(timer_groups, group);
+    g_free(group);
+}
+
+static gboolean timer_group_cb(gpointer data)
+{
+    timer_group_t  *group = data;
+    mod_timer_t    *timer;
+    GSList         *ids = NULL;
+    GSList         *iter;
+    GSList         *node;
+    guint           id;
+
+    /* the callbacks may add or remove timers, so work on a list of IDs */
+    for (iter = group->timers; iter != NULL; iter = iter->next)
+        ids = g_slist_prepend(ids, GUINT_TO_POINTER(((mod_timer_t *)
+                                                     iter->data)->id));
+    ids = g_slist_reverse(ids);
+
+    group->dispatching = TRUE;
+    dispatch_daynum = get_current_daynum();
+
+    for (iter = ids; iter != NULL; iter = iter->next)
+    {
+        id = GPOINTER_TO_UINT(iter->data);
+
+        for (node = group->timers; node != NULL; node = node->next)
+            if (((mod_timer_t *) node->data)->id == id)
+                break;
+
+        if (node == NULL)
+            continue;
+
+        timer = node->data;
+        if (!timer->func(timer->data))
+            mod_mgr_remove_timeout(id);
+    }
+
+    dispatch_daynum = 0.0;
+    group->dispatching = FALSE;
+    g_slist_free(ids);
+
+    if (group->timers == NULL)
+    {
+        timer_group_free(group);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Add a module timer.
+ *
+ * @param interval The interval [msec].
+ * @param func The function to call, see g_timeout_add().
+ * @param data The user data passed to func.
+ * @return The ID of the timer, used with mod_mgr_remove_timeout().
+ *
+ * Timers with the same interval share one GLib timeout and are called one
+ * after the other in the same main loop iteration. Intervals that are a
+ * multiple of one second are aligned to the GLib second timer.
+ */
+guint mod_mgr_add_timeout(guint interval, GSourceFunc func, gpointer data)
+{
+    timer_group_t  *group = NULL;
+    mod_timer_t    *timer;
+    GSList         *iter;
+
+    for (iter = timer_groups; iter != NULL; iter = iter->next)
+    {
+        if (((timer_group_t *) iter->data)->interval == interval)
+        {
+            group = iter->data;
+            break;
+        }
+    }
+
+    if (group == NULL)
+    {
+        group = g_new0(timer_group_t, 1);
+        group->interval = interval;
+        if (interval > 0 && interval % 1000 == 0)
+            group->source = g_timeout_add_seconds(interval / 1000,
+                                                  timer_group_cb, group);
+        else
+            group->source = g_timeout_add(interval, timer_group_cb, group);
+
+        timer_groups = g_slist_prepend(timer_groups, group);
+    }
+
+    timer = g_new(mod_timer_t, 1);
+    timer->id = timer_next_id++;
+    timer->func = func;
+    timer->data = data;
+    group->timers = g_slist_append(group->timers, timer);
+
+    return timer->id;
+}
+
+/**
+ * Remove a module timer.
+ *
+ * @param id The ID returned by mod_mgr_add_timeout().
+ * @return TRUE if the timer was found and removed.
+ */
+gboolean mod_mgr_remove_timeout(guint id)
+{
+    timer_group_t  *group;
+    mod_timer_t    *timer;
+    GSList         *iter;
+    GSList         *node;
+
+    for (iter = timer_groups; iter != NULL; iter = iter->next)
+    {
+        group = iter->data;
+
+        for (node = group->timers; node != NULL; node = node->next)
+        {
+            timer = node->data;
+            if (timer->id != id)
+                continue;
+
+            group->timers = g_slist_delete_link(group->timers, node);
+            g_free(timer);
+
+            /* a group being dispatched is freed by timer_group_cb() */
+            if (group->timers == NULL && !group->dispatching)
+            {
+                g_source_remove(group->source);
+                timer_group_free(group);
+            }
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
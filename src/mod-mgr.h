@@ -1,6 +1,11 @@
 #ifndef MOD_MGR_H
 #define MOD_MGR_H 1
 
+#include <glib.h>
+#include <gtk/gtk.h>
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
 GtkWidget      *mod_mgr_create(void);
 gint            mod_mgr_add_module(GtkWidget * module, gboolean dock);
 gint            mod_mgr_remove_module(GtkWidget * module);
@@ -10,4 +15,13 @@ gint            mod_mgr_dock_module(GtkWidget * module);
 gint            mod_mgr_undock_module(GtkWidget * module);
 void            mod_mgr_reload_sats(void);
 
+void            mod_mgr_sat_preload(const gint * catnums, gsize num);
+gint            mod_mgr_sat_acquire(gint catnum, sat_t * sat, qth_t * qth);
+void            mod_mgr_sat_release(gint catnum);
+void            mod_mgr_sat_calc(sat_t * sat, qth_t * qth, gdouble t);
+gdouble         mod_mgr_get_current_daynum(void);
+guint           mod_mgr_add_timeout(guint interval, GSourceFunc func,
+                                    gpointer data);
+gboolean        mod_mgr_remove_timeout(guint id);
+
 #endif
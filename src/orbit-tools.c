@@ -133,7 +133,7 @@ decayed        (sat_t *sat)
 gboolean
 has_aos        (sat_t *sat, qth_t *qth)
 {
-     double lin, sma, apogee;
+     double lin, sma, apogee, lat;
      gboolean retcode = FALSE;
 
      /* FIXME */
@@ -160,7 +160,13 @@ has_aos        (sat_t *sat, qth_t *qth)
              sma = 331.25 * exp(log(1440.0/sat->meanmo) * (2.0/3.0));
              apogee = sma * (1.0 + sat->tle.eo) - xkmper;
              
-             if ((acos(xkmper/(apogee+xkmper))+(lin)) > fabs(qth->lat*de2ra))
+             /* a moving QTH may get there anywhere on its trajectory */
+             if (qth->traj != NULL)
+                 lat = qth_traj_max_lat (qth->traj);
+             else
+                 lat = fabs(qth->lat*de2ra);
+
+             if ((acos(xkmper/(apogee+xkmper))+(lin)) > lat)
                  retcode = TRUE;
              else
                  retcode = FALSE;
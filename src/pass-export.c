@@ -0,0 +1,704 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "locator.h"
+#include "pass-export.h"
+#include "pass-to-txt.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "sat-pass-dialogs.h"
+
+
+/* the output buffer is written to the stream when it grows beyond this */
+#define EXPORT_CHUNK_SIZE 65536
+
+/* number of pass details used by the benchmark (one day at 1 sec) */
+#define BENCH_DETAILS 86400
+
+static const gchar *extensions[PASS_EXPORT_NUM] = {
+    ".txt",
+    ".csv",
+    ".eph"
+};
+
+/* CSV column names for the single pass columns */
+static const gchar *csv_single_cols[SINGLE_PASS_COL_NUMBER] = {
+    "time",
+    "az",
+    "el",
+    "ra",
+    "dec",
+    "range_km",
+    "range_rate_kms",
+    "lat",
+    "lon",
+    "ssp",
+    "footprint_km",
+    "alt_km",
+    "vel_kms",
+    "doppler_hz",
+    "loss_db",
+    "delay_ms",
+    "ma",
+    "phase",
+    "vis"
+};
+
+/* CSV column names for the multi pass columns */
+static const gchar *csv_multi_cols[MULTI_PASS_COL_NUMBER] = {
+    "aos",
+    "tca",
+    "los",
+    "duration_s",
+    "max_el",
+    "aos_az",
+    "max_el_az",
+    "los_az",
+    "orbit",
+    "vis"
+};
+
+
+/* write the buffer to the stream; after an error the data is dropped */
+static void flush_buff(pass_export_t * exp)
+{
+    gsize           written = 0;
+
+    if (exp->buff->len > 0 && exp->error == NULL)
+    {
+        g_output_stream_write_all(exp->stream, exp->buff->str,
+                                  exp->buff->len, &written, NULL,
+                                  &exp->error);
+        exp->bytes += written;
+    }
+
+    g_string_truncate(exp->buff, 0);
+}
+
+static void row_done(pass_export_t * exp)
+{
+    exp->rows++;
+    if (exp->buff->len >= EXPORT_CHUNK_SIZE)
+        flush_buff(exp);
+}
+
+/* append a locale independent number and a separator */
+static void csv_append_double(GString * buff, const gchar * format,
+                              gdouble value)
+{
+    gchar           str[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append_c(buff, ',');
+    g_string_append(buff, g_ascii_formatd(str, sizeof(str), format, value));
+}
+
+/* append a Julian date as ISO 8601 UTC */
+static void csv_append_time(GString * buff, gdouble jd)
+{
+    gchar           str[32];
+    time_t          t;
+    struct tm      *tm;
+
+    t = (time_t) floor((jd - 2440587.5) * 86400.0 + 0.5);
+    tm = gmtime(&t);
+    if (tm == NULL ||
+        strftime(str, sizeof(str), "%Y-%m-%dT%H:%M:%SZ", tm) == 0)
+        str[0] = '\0';
+
+    g_string_append(buff, str);
+}
+
+/* little endian encoders for the binary format */
+static void put_u16(guint8 * dst, guint16 value)
+{
+    value = GUINT16_TO_LE(value);
+    memcpy(dst, &value, sizeof(value));
+}
+
+static void put_u32(guint8 * dst, guint32 value)
+{
+    value = GUINT32_TO_LE(value);
+    memcpy(dst, &value, sizeof(value));
+}
+
+static void put_f32(guint8 * dst, gdouble value)
+{
+    gfloat          f = (gfloat) value;
+    guint32         u;
+
+    memcpy(&u, &f, sizeof(u));
+    put_u32(dst, u);
+}
+
+static void put_f64(guint8 * dst, gdouble value)
+{
+    guint64         u;
+
+    memcpy(&u, &value, sizeof(u));
+    u = GUINT64_TO_LE(u);
+    memcpy(dst, &u, sizeof(u));
+}
+
+static void bin_file_header(pass_export_t * exp, pass_t * pass)
+{
+    guint8          hdr[PASS_EXPORT_BIN_HDRSIZE];
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, PASS_EXPORT_BIN_MAGIC, strlen(PASS_EXPORT_BIN_MAGIC));
+    put_u16(hdr + 8, PASS_EXPORT_BIN_VERSION);
+    put_u16(hdr + 10, PASS_EXPORT_BIN_RECSIZE);
+    put_f64(hdr + 16, exp->qth->lat);
+    put_f64(hdr + 24, exp->qth->lon);
+    put_f64(hdr + 32, exp->qth->alt);
+    if (pass->satname != NULL)
+        strncpy((gchar *) hdr + 40, pass->satname, 23);
+
+    g_string_append_len(exp->buff, (const gchar *)hdr, sizeof(hdr));
+    exp->started = TRUE;
+}
+
+static void bin_details(pass_export_t * exp, pass_t * pass)
+{
+    guint8          rec[PASS_EXPORT_BIN_RECSIZE];
+    pass_detail_t  *detail;
+    guint           i, num;
+
+    if (!exp->started)
+        bin_file_header(exp, pass);
+
+    num = PASS_NUM_DETAILS(pass);
+
+    memset(rec, 0, PASS_EXPORT_BIN_PASSIZE);
+    put_u32(rec, num);
+    put_u32(rec + 4, (guint32) pass->orbit);
+    put_f64(rec + 8, pass->tca);
+    g_string_append_len(exp->buff, (const gchar *)rec,
+                        PASS_EXPORT_BIN_PASSIZE);
+
+    memset(rec, 0, sizeof(rec));
+    for (i = 0; i < num; i++)
+    {
+        detail = PASS_NTH_DETAIL(pass, i);
+
+        put_f64(rec, detail->time);
+        put_u32(rec + 8, (guint32) detail->orbit);
+        rec[12] = (guint8) detail->vis;
+        put_f32(rec + 16, detail->az);
+        put_f32(rec + 20, detail->el);
+        put_f32(rec + 24, detail->range);
+        put_f32(rec + 28, detail->range_rate);
+        put_f32(rec + 32, detail->lat);
+        put_f32(rec + 36, detail->lon);
+        put_f32(rec + 40, detail->alt);
+        put_f32(rec + 44, detail->velo);
+        put_f32(rec + 48, detail->ma);
+        put_f32(rec + 52, detail->phase);
+        put_f32(rec + 56, detail->footprint);
+
+        g_string_append_len(exp->buff, (const gchar *)rec, sizeof(rec));
+        row_done(exp);
+    }
+}
+
+static void csv_detail_row(pass_export_t * exp, pass_detail_t * detail,
+                           gint fields)
+{
+    GString        *buff = exp->buff;
+    gchar           ssp[7];
+    gdouble         ra, dec;
+
+    csv_append_time(buff, detail->time);
+    csv_append_double(buff, "%.0f", detail->orbit);
+
+    if (fields & SINGLE_PASS_FLAG_AZ)
+        csv_append_double(buff, "%.3f", detail->az);
+    if (fields & SINGLE_PASS_FLAG_EL)
+        csv_append_double(buff, "%.3f", detail->el);
+
+    if (fields & (SINGLE_PASS_FLAG_RA | SINGLE_PASS_FLAG_DEC))
+    {
+        pass_to_txt_radec(detail, exp->qth, &ra, &dec);
+        if (fields & SINGLE_PASS_FLAG_RA)
+            csv_append_double(buff, "%.3f", ra);
+        if (fields & SINGLE_PASS_FLAG_DEC)
+            csv_append_double(buff, "%.3f", dec);
+    }
+
+    if (fields & SINGLE_PASS_FLAG_RANGE)
+        csv_append_double(buff, "%.3f", detail->range);
+    if (fields & SINGLE_PASS_FLAG_RANGE_RATE)
+        csv_append_double(buff, "%.5f", detail->range_rate);
+    if (fields & SINGLE_PASS_FLAG_LAT)
+        csv_append_double(buff, "%.4f", detail->lat);
+    if (fields & SINGLE_PASS_FLAG_LON)
+        csv_append_double(buff, "%.4f", detail->lon);
+
+    if (fields & SINGLE_PASS_FLAG_SSP)
+    {
+        g_string_append_c(buff, ',');
+        if (longlat2locator(detail->lon, detail->lat, ssp, 3) == RIG_OK)
+            g_string_append(buff, ssp);
+    }
+
+    if (fields & SINGLE_PASS_FLAG_FOOTPRINT)
+        csv_append_double(buff, "%.1f", detail->footprint);
+    if (fields & SINGLE_PASS_FLAG_ALT)
+        csv_append_double(buff, "%.3f", detail->alt);
+    if (fields & SINGLE_PASS_FLAG_VEL)
+        csv_append_double(buff, "%.5f", detail->velo);
+    if (fields & SINGLE_PASS_FLAG_DOPPLER)
+        csv_append_double(buff, "%.1f",
+                          -100.0e06 * (detail->range_rate / 299792.4580));
+    if (fields & SINGLE_PASS_FLAG_LOSS)
+        csv_append_double(buff, "%.2f", 72.4 + 20.0 * log10(detail->range));
+    if (fields & SINGLE_PASS_FLAG_DELAY)
+        csv_append_double(buff, "%.4f", detail->range / 299.7924580);
+    if (fields & SINGLE_PASS_FLAG_MA)
+        csv_append_double(buff, "%.3f", detail->ma);
+    if (fields & SINGLE_PASS_FLAG_PHASE)
+        csv_append_double(buff, "%.3f", detail->phase);
+    if (fields & SINGLE_PASS_FLAG_VIS)
+    {
+        g_string_append_c(buff, ',');
+        g_string_append_c(buff, vis_to_chr(detail->vis));
+    }
+
+    g_string_append_c(buff, '\n');
+}
+
+static void csv_summary_row(pass_export_t * exp, pass_t * pass, gint fields)
+{
+    GString        *buff = exp->buff;
+
+    csv_append_time(buff, pass->aos);
+    g_string_append_c(buff, ',');
+    csv_append_time(buff, pass->tca);
+    g_string_append_c(buff, ',');
+    csv_append_time(buff, pass->los);
+
+    if (fields & (1 << MULTI_PASS_COL_DURATION))
+        g_string_append_printf(buff, ",%u",
+                               (guint) ((pass->los - pass->aos) * 86400));
+    if (fields & (1 << MULTI_PASS_COL_MAX_EL))
+        csv_append_double(buff, "%.2f", pass->max_el);
+    if (fields & (1 << MULTI_PASS_COL_AOS_AZ))
+        csv_append_double(buff, "%.2f", pass->aos_az);
+    if (fields & (1 << MULTI_PASS_COL_MAX_EL_AZ))
+        csv_append_double(buff, "%.2f", pass->maxel_az);
+    if (fields & (1 << MULTI_PASS_COL_LOS_AZ))
+        csv_append_double(buff, "%.2f", pass->los_az);
+    if (fields & (1 << MULTI_PASS_COL_ORBIT))
+        g_string_append_printf(buff, ",%d", pass->orbit);
+    if (fields & (1 << MULTI_PASS_COL_VIS))
+        g_string_append_printf(buff, ",%s", pass->vis);
+
+    g_string_append_c(buff, '\n');
+}
+
+/**
+ * Create a new pass exporter.
+ *
+ * @param stream The output stream. The exporter takes ownership of it.
+ * @param format The file format (pass_export_fmt_t).
+ * @param qth The observer.
+ *
+ * The exporter formats the rows into one reusable buffer and writes it to
+ * the stream in chunks, so the memory use does not depend on the number of
+ * rows. Write errors are recorded and reported by pass_export_close().
+ */
+pass_export_t  *pass_export_new(GOutputStream * stream, gint format,
+                                qth_t * qth)
+{
+    pass_export_t  *exp;
+
+    exp = g_new0(pass_export_t, 1);
+    exp->stream = stream;
+    exp->format = CLAMP(format, 0, PASS_EXPORT_NUM - 1);
+    exp->qth = qth;
+    exp->fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    exp->buff = g_string_sized_new(EXPORT_CHUNK_SIZE + 1024);
+    exp->tstart = g_get_monotonic_time();
+
+    return exp;
+}
+
+/**
+ * Create a new pass exporter writing to a file.
+ *
+ * @param fname The file name. Existing files are replaced.
+ * @param format The file format (pass_export_fmt_t).
+ * @param qth The observer.
+ * @param error Location to store the error occurring, or NULL.
+ * @return A new exporter or NULL if the file could not be created.
+ */
+pass_export_t  *pass_export_new_file(const gchar * fname, gint format,
+                                     qth_t * qth, GError ** error)
+{
+    GFile          *file;
+    GFileOutputStream *stream;
+
+    file = g_file_new_for_path(fname);
+    stream = g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, NULL,
+                            error);
+    g_object_unref(file);
+
+    if (stream == NULL)
+        return NULL;
+
+    return pass_export_new(G_OUTPUT_STREAM(stream), format, qth);
+}
+
+/**
+ * Flush and close the exporter.
+ *
+ * @param exp The exporter. It is freed by this function.
+ * @param error Location to store the first error occurring, or NULL.
+ * @return TRUE if all data has been written.
+ */
+gboolean pass_export_close(pass_export_t * exp, GError ** error)
+{
+    gboolean        ok;
+
+    flush_buff(exp);
+
+    if (exp->error == NULL)
+        g_output_stream_close(exp->stream, NULL, &exp->error);
+    else
+        g_output_stream_close(exp->stream, NULL, NULL);
+
+    ok = (exp->error == NULL);
+    if (ok)
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Exported %" G_GUINT64_FORMAT " rows (%"
+                      G_GUINT64_FORMAT " bytes) in %.3f sec"),
+                    __func__, exp->rows, exp->bytes,
+                    (g_get_monotonic_time() - exp->tstart) / 1.0e6);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Export failed (%s)"),
+                    __func__, exp->error->message);
+        g_propagate_error(error, exp->error);
+        exp->error = NULL;
+    }
+
+    g_object_unref(exp->stream);
+    g_string_free(exp->buff, TRUE);
+    g_free(exp->fmtstr);
+    g_free(exp);
+
+    return ok;
+}
+
+/** Get the file name extension of an export format, including the dot. */
+const gchar    *pass_export_extension(gint format)
+{
+    return extensions[CLAMP(format, 0, PASS_EXPORT_NUM - 1)];
+}
+
+/**
+ * Export free text, e.g. a page header.
+ *
+ * @param exp The exporter.
+ * @param text The text. Text files get it as is, CSV files as comment
+ *             lines and the binary format ignores it.
+ */
+void pass_export_text(pass_export_t * exp, const gchar * text)
+{
+    gchar         **lines;
+    guint           i;
+
+    switch (exp->format)
+    {
+    case PASS_EXPORT_TXT:
+        g_string_append(exp->buff, text);
+        break;
+
+    case PASS_EXPORT_CSV:
+        lines = g_strsplit(text, "\n", -1);
+        for (i = 0; lines[i] != NULL; i++)
+        {
+            if (lines[i][0] != '\0')
+                g_string_append_printf(exp->buff, "# %s\n", lines[i]);
+        }
+        g_strfreev(lines);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/** Export the column headers of the pass details table. */
+void pass_export_details_header(pass_export_t * exp, pass_t * pass,
+                                gint fields)
+{
+    gchar          *buff;
+    guint           i;
+
+    switch (exp->format)
+    {
+    case PASS_EXPORT_TXT:
+        buff = pass_to_txt_tblheader(pass, exp->qth, fields);
+        g_string_append(exp->buff, buff);
+        g_free(buff);
+        break;
+
+    case PASS_EXPORT_CSV:
+        g_string_append(exp->buff, "time,orbit");
+        for (i = 1; i < SINGLE_PASS_COL_NUMBER; i++)
+        {
+            if (fields & (1 << i))
+                g_string_append_printf(exp->buff, ",%s", csv_single_cols[i]);
+        }
+        g_string_append_c(exp->buff, '\n');
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Export the details of a pass.
+ *
+ * @param exp The exporter.
+ * @param pass The pass.
+ * @param fields Bit field of the columns to export. The binary format always
+ *               contains all columns.
+ */
+void pass_export_details(pass_export_t * exp, pass_t * pass, gint fields)
+{
+    guint           i, num;
+
+    num = PASS_NUM_DETAILS(pass);
+
+    switch (exp->format)
+    {
+    case PASS_EXPORT_TXT:
+        for (i = 0; i < num; i++)
+        {
+            pass_to_txt_row(exp->buff, PASS_NTH_DETAIL(pass, i), exp->qth,
+                            fields, exp->fmtstr);
+            row_done(exp);
+        }
+        break;
+
+    case PASS_EXPORT_CSV:
+        for (i = 0; i < num; i++)
+        {
+            csv_detail_row(exp, PASS_NTH_DETAIL(pass, i), fields);
+            row_done(exp);
+        }
+        break;
+
+    case PASS_EXPORT_BIN:
+        bin_details(exp, pass);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/** Export the column headers of the pass summary table. */
+void pass_export_summary_header(pass_export_t * exp, GSList * passes,
+                                gint fields)
+{
+    gchar          *buff;
+    guint           i;
+
+    switch (exp->format)
+    {
+    case PASS_EXPORT_TXT:
+        buff = passes_to_txt_tblheader(passes, exp->qth, fields);
+        g_string_append(exp->buff, buff);
+        g_free(buff);
+        break;
+
+    case PASS_EXPORT_CSV:
+        g_string_append(exp->buff, "aos,tca,los");
+        for (i = MULTI_PASS_COL_DURATION; i < MULTI_PASS_COL_NUMBER; i++)
+        {
+            if (fields & (1 << i))
+                g_string_append_printf(exp->buff, ",%s", csv_multi_cols[i]);
+        }
+        g_string_append_c(exp->buff, '\n');
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Export the pass summary table.
+ *
+ * @param exp The exporter.
+ * @param passes The passes.
+ * @param fields Bit field of the columns to export.
+ *
+ * The binary format has no summary; it gets the details of the passes.
+ */
+void pass_export_summary(pass_export_t * exp, GSList * passes, gint fields)
+{
+    GSList         *iter;
+
+    for (iter = passes; iter != NULL; iter = iter->next)
+    {
+        switch (exp->format)
+        {
+        case PASS_EXPORT_TXT:
+            passes_to_txt_row(exp->buff, PASS(iter->data), fields,
+                              exp->fmtstr);
+            row_done(exp);
+            break;
+
+        case PASS_EXPORT_CSV:
+            csv_summary_row(exp, PASS(iter->data), fields);
+            row_done(exp);
+            break;
+
+        case PASS_EXPORT_BIN:
+            bin_details(exp, PASS(iter->data));
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * Measure the export throughput.
+ *
+ * @param rows The number of rows to export in each format.
+ * @param fname The output file or NULL to use a temporary file.
+ * @return 0 on success, 1 if an export failed.
+ *
+ * A synthetic pass with all columns enabled is exported repeatedly until
+ * the requested number of rows has been written. The results are printed
+ * to the standard output.
+ */
+gint pass_export_bench(guint64 rows, const gchar * fname)
+{
+    pass_export_t  *exp;
+    pass_t         *pass;
+    pass_detail_t  *detail;
+    qth_t           qth;
+    GError         *error = NULL;
+    gchar          *path;
+    gint64          t0;
+    gdouble         secs;
+    guint64         done;
+    guint           i, num;
+    gint            fields = (1 << SINGLE_PASS_COL_NUMBER) - 1;
+    gint            fmt;
+    gint            retcode = 0;
+
+    memset(&qth, 0, sizeof(qth));
+    qth.lat = 55.7;
+    qth.lon = 12.6;
+    qth.alt = 10;
+
+    num = (guint) MIN(rows, BENCH_DETAILS);
+    pass = g_new0(pass_t, 1);
+    pass->satname = g_strdup("BENCH");
+    pass->details = g_array_sized_new(FALSE, TRUE, sizeof(pass_detail_t), num);
+    g_array_set_size(pass->details, num);
+    for (i = 0; i < num; i++)
+    {
+        detail = PASS_NTH_DETAIL(pass, i);
+        detail->time = 2458000.5 + i / 86400.0;
+        detail->az = fmod(i * 0.37, 360.0);
+        detail->el = 45.0 * sin(i * 0.01);
+        detail->range = 500.0 + 2000.0 * fabs(cos(i * 0.01));
+        detail->range_rate = 7.0 * cos(i * 0.01);
+        detail->lat = 60.0 * sin(i * 0.001);
+        detail->lon = fmod(i * 0.07, 360.0) - 180.0;
+        detail->alt = 550.0;
+        detail->velo = 7.6;
+        detail->ma = fmod(i * 0.06, 360.0);
+        detail->phase = fmod(i * 0.06, 256.0);
+        detail->footprint = 5000.0;
+        detail->vis = SAT_VIS_DAYLIGHT;
+        detail->orbit = 1000 + i / 5700;
+    }
+    pass->aos = PASS_NTH_DETAIL(pass, 0)->time;
+    pass->tca = pass->los = PASS_NTH_DETAIL(pass, num - 1)->time;
+
+    if (fname != NULL)
+        path = g_strdup(fname);
+    else
+        path = g_build_filename(g_get_tmp_dir(), "gpredict-bench.out", NULL);
+
+    for (fmt = 0; fmt < PASS_EXPORT_NUM && retcode == 0; fmt++)
+    {
+        t0 = g_get_monotonic_time();
+        exp = pass_export_new_file(path, fmt, &qth, &error);
+        if (exp == NULL)
+        {
+            retcode = 1;
+            break;
+        }
+
+        pass_export_details_header(exp, pass, fields);
+        for (done = 0; done < rows; done += num)
+        {
+            if (rows - done < num)
+                g_array_set_size(pass->details, rows - done);
+            pass_export_details(exp, pass, fields);
+        }
+        g_array_set_size(pass->details, num);
+
+        done = exp->rows;
+        if (!pass_export_close(exp, &error))
+        {
+            retcode = 1;
+            break;
+        }
+
+        secs = (g_get_monotonic_time() - t0) / 1.0e6;
+        g_print("%s: %" G_GUINT64_FORMAT " rows in %.2f sec, "
+                "%.0f rows/sec\n", pass_export_extension(fmt) + 1,
+                done, secs, done / MAX(secs, 1.0e-6));
+    }
+
+    if (error != NULL)
+    {
+        g_printerr("%s\n", error->message);
+        g_clear_error(&error);
+    }
+
+    if (fname == NULL)
+        g_remove(path);
+    g_free(path);
+    free_pass(pass);
+
+    return retcode;
+}
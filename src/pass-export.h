@@ -0,0 +1,101 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PASS_EXPORT_H
+#define PASS_EXPORT_H 1
+
+#include <gio/gio.h>
+#include <glib.h>
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+
+/** Export file formats. */
+typedef enum {
+    PASS_EXPORT_TXT = 0,        /*!< Plain text tables as shown on screen */
+    PASS_EXPORT_CSV,            /*!< Comma separated values */
+    PASS_EXPORT_BIN,            /*!< Binary ephemeris, see below */
+    PASS_EXPORT_NUM
+} pass_export_fmt_t;
+
+/*
+ * Binary ephemeris layout; all values are little endian.
+ *
+ * File header (64 bytes):
+ *    0  char[8]   magic "GPEPHEM\0"
+ *    8  uint16    version (1)
+ *   10  uint16    record size (PASS_EXPORT_BIN_RECSIZE)
+ *   12  uint32    reserved
+ *   16  float64   observer latitude [deg]
+ *   24  float64   observer longitude [deg]
+ *   32  float64   observer altitude [m]
+ *   40  char[24]  satellite name, NUL padded
+ *
+ * Each pass starts with a 16 byte header followed by its records:
+ *    0  uint32    number of records
+ *    4  int32     orbit number
+ *    8  float64   TCA (Julian date, UTC)
+ *
+ * Record:
+ *    0  float64   time (Julian date, UTC)
+ *    8  int32     orbit number
+ *   12  uint8     visibility (sat_vis_t)
+ *   13  uint8[3]  reserved
+ *   16  float32   az, el [deg], range [km], range rate [km/sec],
+ *                 lat, lon [deg], alt [km], velocity [km/sec],
+ *                 MA, phase [deg], footprint [km]
+ */
+#define PASS_EXPORT_BIN_MAGIC   "GPEPHEM"
+#define PASS_EXPORT_BIN_VERSION 1
+#define PASS_EXPORT_BIN_HDRSIZE 64
+#define PASS_EXPORT_BIN_PASSIZE 16
+#define PASS_EXPORT_BIN_RECSIZE 60
+
+/** Streaming pass exporter. */
+typedef struct {
+    GOutputStream  *stream;     /*!< The output stream (owned) */
+    gint            format;     /*!< The file format (pass_export_fmt_t) */
+    qth_t          *qth;        /*!< The observer */
+    gchar          *fmtstr;     /*!< Time format for text output */
+    GString        *buff;       /*!< Reusable output buffer */
+    guint64         rows;       /*!< Number of table rows written */
+    guint64         bytes;      /*!< Number of bytes written */
+    gboolean        started;    /*!< Binary file header written */
+    GError         *error;      /*!< First write error */
+    gint64          tstart;     /*!< Creation time [usec] */
+} pass_export_t;
+
+pass_export_t  *pass_export_new(GOutputStream * stream, gint format,
+                                qth_t * qth);
+pass_export_t  *pass_export_new_file(const gchar * fname, gint format,
+                                     qth_t * qth, GError ** error);
+gboolean        pass_export_close(pass_export_t * exp, GError ** error);
+const gchar    *pass_export_extension(gint format);
+
+void            pass_export_text(pass_export_t * exp, const gchar * text);
+void            pass_export_details_header(pass_export_t * exp,
+                                           pass_t * pass, gint fields);
+void            pass_export_details(pass_export_t * exp, pass_t * pass,
+                                    gint fields);
+void            pass_export_summary_header(pass_export_t * exp,
+                                           GSList * passes, gint fields);
+void            pass_export_summary(pass_export_t * exp, GSList * passes,
+                                    gint fields);
+
+gint            pass_export_bench(guint64 rows, const gchar * fname);
+
+#endif
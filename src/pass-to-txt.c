@@ -113,6 +113,15 @@ const guint     MCW[] = {
 static void     Calc_RADec(gdouble jul_utc, gdouble saz, gdouble sel,
                            qth_t * qth, obs_astro_t * obs_set);
 
+/* format a number into the line without a temporary allocation */
+static void append_value(GString * line, const gchar * format, gdouble value)
+{
+    gchar           buff[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_snprintf(buff, sizeof(buff), format, value);
+    g_string_append(line, buff);
+}
+
 gchar          *pass_to_txt_pgheader(pass_t * pass, qth_t * qth, gint fields)
 {
     gboolean        loc;
@@ -232,230 +241,138 @@ gchar          *pass_to_txt_tblheader(pass_t * pass, qth_t * qth, gint fields)
     return buff;
 }
 
-gchar          *pass_to_txt_tblcontents(pass_t * pass, qth_t * qth,
-                                        gint fields)
+/**
+ * Append one row of the pass details table.
+ *
+ * @param line The string to append the row to, including the newline.
+ * @param detail The pass detail to format.
+ * @param qth The observer, needed for RA and Dec.
+ * @param fields Bit field of the visible columns.
+ * @param fmtstr The time format string.
+ *
+ * The caller owns the buffer so that it can be reused for any number of
+ * rows; see pass-export.c.
+ */
+void pass_to_txt_row(GString * line, pass_detail_t * detail, qth_t * qth,
+                     gint fields, const gchar * fmtstr)
 {
-    gchar          *fmtstr;
     gchar           tbuff[TIME_FORMAT_MAX_LENGTH];
-    guint           i, num;
-    gchar          *line;
-    gchar          *data = NULL;
-    gchar          *buff;
-    pass_detail_t  *detail;
+    gchar           ssp[7];
     obs_astro_t     astro;
-    gdouble         ra, dec, numf;
-    gchar          *ssp;
 
-    /* first, get the length of the time field */
-    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
+    /* time */
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, detail->time);
+    g_string_append_c(line, ' ');
+    g_string_append(line, tbuff);
 
-    /* get number of rows */
-    num = g_slist_length(pass->details);
+    if (fields & SINGLE_PASS_FLAG_AZ)
+        append_value(line, " %6.2f", detail->az);
 
-    for (i = 0; i < num; i++)
-    {
+    if (fields & SINGLE_PASS_FLAG_EL)
+        append_value(line, " %6.2f", detail->el);
 
-        /* get detail */
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+    if (fields & (SINGLE_PASS_FLAG_RA | SINGLE_PASS_FLAG_DEC))
+        Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
 
-        /* time */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, detail->time);
+    if (fields & SINGLE_PASS_FLAG_RA)
+        append_value(line, " %6.2f", Degrees(astro.ra));
 
-        line = g_strdup_printf(" %s", tbuff);
+    if (fields & SINGLE_PASS_FLAG_DEC)
+        append_value(line, " %6.2f", Degrees(astro.dec));
 
-        /* Az */
-        if (fields & SINGLE_PASS_FLAG_AZ)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_RANGE)
+        append_value(line, " %5.0f", detail->range);
 
-        /* El */
-        if (fields & SINGLE_PASS_FLAG_EL)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->el);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_RANGE_RATE)
+        append_value(line, " %6.3f", detail->range_rate);
 
-        /* Ra */
-        if (fields & SINGLE_PASS_FLAG_RA)
-        {
-            Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
-            ra = Degrees(astro.ra);
-            buff = g_strdup_printf("%s %6.2f", line, ra);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_LAT)
+        append_value(line, " %6.2f", detail->lat);
 
-        /* Dec */
-        if (fields & SINGLE_PASS_FLAG_DEC)
-        {
-            Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
-            dec = Degrees(astro.dec);
-            buff = g_strdup_printf("%s %6.2f", line, dec);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_LON)
+        append_value(line, " %7.2f", detail->lon);
 
-        /* Range */
-        if (fields & SINGLE_PASS_FLAG_RANGE)
+    if (fields & SINGLE_PASS_FLAG_SSP)
+    {
+        if (longlat2locator(detail->lon, detail->lat, ssp, 3) == RIG_OK)
         {
-            buff = g_strdup_printf("%s %5.0f", line, detail->range);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
+            g_string_append_c(line, ' ');
+            g_string_append(line, ssp);
         }
+    }
 
-        /* Range Rate */
-        if (fields & SINGLE_PASS_FLAG_RANGE_RATE)
-        {
-            buff = g_strdup_printf("%s %6.3f", line, detail->range_rate);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_FOOTPRINT)
+        append_value(line, " %5.0f", detail->footprint);
 
-        /* Lat */
-        if (fields & SINGLE_PASS_FLAG_LAT)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->lat);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_ALT)
+        append_value(line, " %5.0f", detail->alt);
 
-        /* Lon */
-        if (fields & SINGLE_PASS_FLAG_LON)
-        {
-            buff = g_strdup_printf("%s %7.2f", line, detail->lon);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_VEL)
+        append_value(line, " %5.3f", detail->velo);
 
-        /* SSP */
-        if (fields & SINGLE_PASS_FLAG_SSP)
-        {
-            ssp = g_try_malloc(7);
-            if (longlat2locator(detail->lon, detail->lat, ssp, 3) == RIG_OK)
-            {
-                buff = g_strdup_printf("%s %s", line, ssp);
-                g_free(line);
-                line = g_strdup(buff);
-                g_free(buff);
-            }
-            g_free(ssp);
-        }
+    /* Doppler shift at 100 MHz */
+    if (fields & SINGLE_PASS_FLAG_DOPPLER)
+        append_value(line, " %5.0f",
+                     -100.0e06 * (detail->range_rate / 299792.4580));
 
-        /* Footprint */
-        if (fields & SINGLE_PASS_FLAG_FOOTPRINT)
-        {
-            buff = g_strdup_printf("%s %5.0f", line, detail->footprint);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    /* Path loss at 100 MHz [dB] */
+    if (fields & SINGLE_PASS_FLAG_LOSS)
+        append_value(line, " %6.2f", 72.4 + 20.0 * log10(detail->range));
 
-        /* Alt */
-        if (fields & SINGLE_PASS_FLAG_ALT)
-        {
-            buff = g_strdup_printf("%s %5.0f", line, detail->alt);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    /* Delay [msec] */
+    if (fields & SINGLE_PASS_FLAG_DELAY)
+        append_value(line, " %5.2f", detail->range / 299.7924580);
 
-        /* Vel */
-        if (fields & SINGLE_PASS_FLAG_VEL)
-        {
-            buff = g_strdup_printf("%s %5.3f", line, detail->velo);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_MA)
+        append_value(line, " %6.2f", detail->ma);
 
-        /* Doppler */
-        if (fields & SINGLE_PASS_FLAG_DOPPLER)
-        {
-            numf = -100.0e06 * (detail->range_rate / 299792.4580);
-            buff = g_strdup_printf("%s %5.0f", line, numf);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_PHASE)
+        append_value(line, " %6.2f", detail->phase);
 
-        /* Loss */
-        if (fields & SINGLE_PASS_FLAG_LOSS)
-        {
-            numf = 72.4 + 20.0 * log10(detail->range);  // dB
-            buff = g_strdup_printf("%s %6.2f", line, numf);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_VIS)
+    {
+        g_string_append(line, "  ");
+        g_string_append_c(line, vis_to_chr(detail->vis));
+    }
 
-        /* Delay */
-        if (fields & SINGLE_PASS_FLAG_DELAY)
-        {
-            numf = detail->range / 299.7924580; // msec 
-            buff = g_strdup_printf("%s %5.2f", line, numf);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    g_string_append_c(line, '\n');
+}
 
-        /* MA */
-        if (fields & SINGLE_PASS_FLAG_MA)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->ma);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/**
+ * Get the topocentric RA and Dec of a pass detail.
+ *
+ * @param detail The pass detail.
+ * @param qth The observer.
+ * @param ra Location where the right ascension is stored [deg].
+ * @param dec Location where the declination is stored [deg].
+ */
+void pass_to_txt_radec(pass_detail_t * detail, qth_t * qth,
+                       gdouble * ra, gdouble * dec)
+{
+    obs_astro_t     astro;
 
-        /* Phase */
-        if (fields & SINGLE_PASS_FLAG_PHASE)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->phase);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
+    *ra = Degrees(astro.ra);
+    *dec = Degrees(astro.dec);
+}
 
-        /* Visibility */
-        if (fields & SINGLE_PASS_FLAG_VIS)
-        {
-            buff = g_strdup_printf("%s  %c", line, vis_to_chr(detail->vis));
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+gchar          *pass_to_txt_tblcontents(pass_t * pass, qth_t * qth,
+                                        gint fields)
+{
+    gchar          *fmtstr;
+    GString        *data;
+    guint           i, num;
 
-        /* append line to return string */
-        if (i == 0)
-        {
-            data = g_strdup_printf("%s\n", line);
-            g_free(line);
-        }
-        else
-        {
-            buff = g_strconcat(data, line, "\n", NULL);
-            g_free(data);
-            data = g_strdup(buff);
-            g_free(buff);
-        }
-    }
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    num = PASS_NUM_DETAILS(pass);
+    data = g_string_sized_new(num * 80);
+
+    for (i = 0; i < num; i++)
+        pass_to_txt_row(data, PASS_NTH_DETAIL(pass, i), qth, fields, fmtstr);
 
     g_free(fmtstr);
 
-    return data;
+    return g_string_free(data, FALSE);
 }
 
 gchar          *passes_to_txt_pgheader(GSList * passes, qth_t * qth,
@@ -532,149 +449,88 @@ gchar          *passes_to_txt_tblheader(GSList * passes, qth_t * qth,
     return buff;
 }
 
-gchar          *passes_to_txt_tblcontents(GSList * passes, qth_t * qth,
-                                          gint fields)
+/**
+ * Append one row of the pass summary table.
+ *
+ * @param line The string to append the row to, including the newline.
+ * @param pass The pass to format.
+ * @param fields Bit field of the visible columns.
+ * @param fmtstr The time format string.
+ */
+void passes_to_txt_row(GString * line, pass_t * pass, gint fields,
+                       const gchar * fmtstr)
 {
-    gchar          *fmtstr;
     gchar           tbuff[TIME_FORMAT_MAX_LENGTH];
-    guint           i, num;
-    gchar          *line = NULL;
-    gchar          *data = NULL;
-    gchar          *buff;
-    pass_t         *pass;
 
-    (void)qth;                  /* avoid unused parameter compiler warning */
-
-    pass = PASS(g_slist_nth_data(passes, 0));
-
-    /* first, get the length of the time field */
-    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    /* AOS, TCA and LOS */
     daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
-
-    /* get number of rows */
-    num = g_slist_length(passes);
-
-    for (i = 0; i < num; i++)
+    g_string_append_c(line, ' ');
+    g_string_append(line, tbuff);
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->tca);
+    g_string_append(line, "  ");
+    g_string_append(line, tbuff);
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->los);
+    g_string_append(line, "  ");
+    g_string_append(line, tbuff);
+
+    /* Duration */
+    if (fields & (1 << MULTI_PASS_COL_DURATION))
     {
+        guint           h, m, s;
 
-        pass = PASS(g_slist_nth_data(passes, i));
+        /* convert julian date to seconds */
+        s = (guint) ((pass->los - pass->aos) * 86400);
 
-        /* AOS */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
-
-        line = g_strdup_printf(" %s", tbuff);
+        /* extract hours */
+        h = (guint) floor(s / 3600);
+        s -= 3600 * h;
 
-        /* TCA */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->tca);
+        /* extract minutes */
+        m = (guint) floor(s / 60);
+        s -= 60 * m;
 
-        buff = g_strdup(line);
-        g_free(line);
-        line = g_strdup_printf("%s  %s", buff, tbuff);
-        g_free(buff);
+        g_string_append_printf(line, "  %02d:%02d:%02d", h, m, s);
+    }
 
-        /* LOS */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->los);
+    if (fields & (1 << MULTI_PASS_COL_MAX_EL))
+        append_value(line, "  %6.2f", pass->max_el);
 
-        buff = g_strdup(line);
-        g_free(line);
-        line = g_strdup_printf("%s  %s", buff, tbuff);
-        g_free(buff);
+    if (fields & (1 << MULTI_PASS_COL_AOS_AZ))
+        append_value(line, "  %6.2f", pass->aos_az);
 
-        /* Duration */
-        if (fields & (1 << MULTI_PASS_COL_DURATION))
-        {
-            guint           h, m, s;
+    if (fields & (1 << MULTI_PASS_COL_MAX_EL_AZ))
+        append_value(line, "  %9.2f", pass->maxel_az);
 
-            /* convert julian date to seconds */
-            s = (guint) ((pass->los - pass->aos) * 86400);
+    if (fields & (1 << MULTI_PASS_COL_LOS_AZ))
+        append_value(line, "  %6.2f", pass->los_az);
 
-            /* extract hours */
-            h = (guint) floor(s / 3600);
-            s -= 3600 * h;
+    if (fields & (1 << MULTI_PASS_COL_ORBIT))
+        g_string_append_printf(line, "  %5d", pass->orbit);
 
-            /* extract minutes */
-            m = (guint) floor(s / 60);
-            s -= 60 * m;
+    if (fields & (1 << MULTI_PASS_COL_VIS))
+        g_string_append_printf(line, "  %s", pass->vis);
 
-            buff = g_strdup_printf("%s  %02d:%02d:%02d", line, h, m, s);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
-
-        /* Max El */
-        if (fields & (1 << MULTI_PASS_COL_MAX_EL))
-        {
-            buff = g_strdup_printf("%s  %6.2f", line, pass->max_el);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
-
-        /* AOS Az */
-        if (fields & (1 << MULTI_PASS_COL_AOS_AZ))
-        {
-            buff = g_strdup_printf("%s  %6.2f", line, pass->aos_az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
-
-        /* Max El Az */
-        if (fields & (1 << MULTI_PASS_COL_MAX_EL_AZ))
-        {
-            buff = g_strdup_printf("%s  %9.2f", line, pass->maxel_az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
-
-        /* LOS Az */
-        if (fields & (1 << MULTI_PASS_COL_LOS_AZ))
-        {
-            buff = g_strdup_printf("%s  %6.2f", line, pass->los_az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    g_string_append_c(line, '\n');
+}
 
-        /* Orbit */
-        if (fields & (1 << MULTI_PASS_COL_ORBIT))
-        {
-            buff = g_strdup_printf("%s  %5d", line, pass->orbit);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+gchar          *passes_to_txt_tblcontents(GSList * passes, qth_t * qth,
+                                          gint fields)
+{
+    gchar          *fmtstr;
+    GString        *data;
+    GSList         *iter;
 
-        /* Visibility */
-        if (fields & (1 << MULTI_PASS_COL_VIS))
-        {
-            buff = g_strdup_printf("%s  %s", line, pass->vis);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    (void)qth;                  /* avoid unused parameter compiler warning */
 
-        /* append line to return string */
-        if (i == 0)
-        {
-            data = g_strdup_printf("%s\n", line);
-            g_free(line);
-        }
-        else
-        {
-            buff = g_strconcat(data, line, "\n", NULL);
-            g_free(data);
-            data = g_strdup(buff);
-            g_free(buff);
-        }
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    data = g_string_new(NULL);
 
-    }
+    for (iter = passes; iter != NULL; iter = iter->next)
+        passes_to_txt_row(data, PASS(iter->data), fields, fmtstr);
 
     g_free(fmtstr);
 
-    return data;
+    return g_string_free(data, FALSE);
 }
 
 static void Calc_RADec(gdouble jul_utc, gdouble saz, gdouble sel,
@@ -11,6 +11,11 @@ gchar          *pass_to_txt_pgheader(pass_t * pass, qth_t * qth, gint fields);
 gchar          *pass_to_txt_tblheader(pass_t * pass, qth_t * qth, gint fields);
 gchar          *pass_to_txt_tblcontents(pass_t * pass, qth_t * qth,
                                         gint fields);
+void            pass_to_txt_row(GString * line, pass_detail_t * detail,
+                                qth_t * qth, gint fields,
+                                const gchar * fmtstr);
+void            pass_to_txt_radec(pass_detail_t * detail, qth_t * qth,
+                                  gdouble * ra, gdouble * dec);
 
 gchar          *passes_to_txt_pgheader(GSList * passes, qth_t * qth,
                                        gint fields);
@@ -18,6 +23,8 @@ gchar          *passes_to_txt_tblheader(GSList * passes, qth_t * qth,
                                         gint fields);
 gchar          *passes_to_txt_tblcontents(GSList * passes, qth_t * qth,
                                           gint fields);
+void            passes_to_txt_row(GString * line, pass_t * pass, gint fields,
+                                  const gchar * fmtstr);
 
 
 #endif
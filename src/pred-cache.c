@@ -0,0 +1,910 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Persistent prediction cache.
+ *
+ * The first cycles of a module used to search AOS/LOS for every satellite,
+ * and the ground tracks and the sky at a glance were computed from scratch
+ * as well. This data rarely changes between two sessions, so it is saved
+ * when the module is closed and reused when it is opened again:
+ *
+ *  - AOS/LOS found before time t are still the next events at a later time
+ *    as long as neither has passed.
+ *  - The passes found for a time window are the start of the passes for a
+ *    later window; the passes that are over are dropped and only the end of
+ *    the window is searched. The search runs in a pass_job_t on a worker
+ *    thread, and the owner of the cache is notified when it is done.
+ *  - A ground track is valid for the orbit it starts in.
+ *
+ * The file is a private binary format in host byte order. It starts with a
+ * version and the size of pass_detail_t, so a file written by another
+ * version is ignored, followed by the QTH and the prediction settings the
+ * events and passes were computed with.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <string.h>
+
+#include "compat.h"
+#include "pred-cache.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+#define PRED_CACHE_MAGIC   "GPRCACHE"
+#define PRED_CACHE_VERSION 2
+
+/* time from LOS to the search for the next pass, see get_passes() */
+#define PASS_GAP 0.014
+
+/* what the events and passes depend on besides the satellite */
+typedef struct {
+    gdouble         lat;
+    gdouble         lon;
+    gint32          alt;
+    gint32          min_el;
+    gint32          resolution;
+    gint32          entries;
+    gint32          look_ahead;
+    gint32          twilight;
+} pred_key_t;
+
+typedef struct {
+    gint            catnum;
+    gdouble         epoch;      /* TLE epoch the data belongs to */
+
+    gdouble         ev_time;    /* time the events were valid at, 0 if none */
+    gdouble         aos;
+    gdouble         los;
+
+    gdouble         ts;         /* time window of the passes */
+    gdouble         te;
+    guint           num;        /* max number of passes, 0 if none */
+    GSList         *passes;
+    gboolean        refreshing; /* a pass_refresh_t is searching the rest */
+
+    gint            track_orbit;
+    gint            track_num;  /* number of orbits, 0 if no track */
+    GArray         *track;      /* latitude and longitude pairs */
+} pred_entry_t;
+
+struct pred_cache {
+    gchar          *filename;
+    pred_key_t      key;
+    GHashTable     *entries;    /* pred_entry_t by catalog number */
+    guint           generation; /* changes with the key */
+
+    GThreadPool    *pool;       /* runs the pass_refresh_t searches */
+    GSList         *refreshes;  /* pass_refresh_t not yet done */
+    guint           refs;       /* the owner and each pass_refresh_t */
+    pred_cache_func_t notify;
+    gpointer        notify_data;
+
+    guint           events_reused;
+    guint           passes_reused;
+    guint           tracks_reused;
+};
+
+/* search for the passes at the end of the window of an entry */
+typedef struct {
+    pred_cache_t   *cache;
+    gint            catnum;
+    gdouble         epoch;
+    guint           generation;
+    pass_job_t     *job;
+    gboolean        done;       /* the job has not been cancelled */
+
+    gdouble         ts;         /* the window the entry will have */
+    gdouble         te;
+    guint           num;
+    GSList         *passes;     /* the cached passes still in the window */
+} pass_refresh_t;
+
+typedef struct {
+    const guint8   *p;
+    const guint8   *end;
+} reader_t;
+
+#define PUT(buf, v) g_byte_array_append(buf, (const guint8 *) &(v), sizeof(v))
+#define GET(rd, v)  read_data(rd, &(v), sizeof(v))
+
+static gboolean read_data(reader_t * rd, gpointer data, gsize len)
+{
+    if ((gsize) (rd->end - rd->p) < len)
+        return FALSE;
+
+    memcpy(data, rd->p, len);
+    rd->p += len;
+
+    return TRUE;
+}
+
+/* Check that there is room for n items of the given size */
+static gboolean read_room(reader_t * rd, guint32 n, gsize size)
+{
+    return n <= (gsize) (rd->end - rd->p) / size;
+}
+
+static void key_get(pred_key_t * key, qth_t * qth)
+{
+    key->lat = qth->lat;
+    key->lon = qth->lon;
+    key->alt = qth->alt;
+    key->min_el = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    key->resolution = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION);
+    key->entries = sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+    key->look_ahead = sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+    key->twilight = sat_cfg_get_int(SAT_CFG_INT_PRED_TWILIGHT_THLD);
+}
+
+static gboolean key_equal(const pred_key_t * a, const pred_key_t * b)
+{
+    return (a->lat == b->lat && a->lon == b->lon && a->alt == b->alt &&
+            a->min_el == b->min_el && a->resolution == b->resolution &&
+            a->entries == b->entries && a->look_ahead == b->look_ahead &&
+            a->twilight == b->twilight);
+}
+
+static void entry_clear_pred(pred_entry_t * entry)
+{
+    entry->ev_time = 0.0;
+    entry->num = 0;
+    free_passes(entry->passes);
+    entry->passes = NULL;
+
+    /* a running search is for the old settings and will be dropped */
+    entry->refreshing = FALSE;
+}
+
+static void entry_free(gpointer data)
+{
+    pred_entry_t   *entry = data;
+
+    free_passes(entry->passes);
+    if (entry->track != NULL)
+        g_array_unref(entry->track);
+    g_free(entry);
+}
+
+static void clear_pred(gpointer key, gpointer value, gpointer data)
+{
+    (void)key;
+    (void)data;
+
+    entry_clear_pred(value);
+}
+
+/* Drop the events and passes if the QTH or the settings have changed */
+static void check_key(pred_cache_t * cache, qth_t * qth)
+{
+    pred_key_t      key;
+
+    key_get(&key, qth);
+    if (key_equal(&key, &cache->key))
+        return;
+
+    g_hash_table_foreach(cache->entries, clear_pred, NULL);
+    cache->key = key;
+    cache->generation++;
+}
+
+/* Get the entry of a satellite; data for another TLE epoch is dropped */
+static pred_entry_t *get_entry(pred_cache_t * cache, sat_t * sat,
+                               gboolean create)
+{
+    pred_entry_t   *entry;
+
+    entry = g_hash_table_lookup(cache->entries, &sat->tle.catnr);
+    if (entry != NULL && entry->epoch != sat->tle.epoch)
+    {
+        g_hash_table_remove(cache->entries, &sat->tle.catnr);
+        entry = NULL;
+    }
+
+    if (entry == NULL && create)
+    {
+        entry = g_new0(pred_entry_t, 1);
+        entry->catnum = sat->tle.catnr;
+        entry->epoch = sat->tle.epoch;
+        g_hash_table_insert(cache->entries, &entry->catnum, entry);
+    }
+
+    return entry;
+}
+
+static void cache_unref(pred_cache_t * cache)
+{
+    if (--cache->refs > 0)
+        return;
+
+    g_hash_table_destroy(cache->entries);
+    g_free(cache->filename);
+    g_free(cache);
+}
+
+static void refresh_free(pass_refresh_t * refresh)
+{
+    pass_job_free(refresh->job);
+    free_passes(refresh->passes);
+    g_free(refresh);
+}
+
+/* Store the passes found by a search; runs on the main loop */
+static gboolean refresh_done(gpointer data)
+{
+    pass_refresh_t *refresh = data;
+    pred_cache_t   *cache = refresh->cache;
+    pred_entry_t   *entry = NULL;
+    GSList         *found;
+    GSList         *node;
+    gdouble         last = 0.0;
+    gboolean        changed = FALSE;
+
+    cache->refreshes = g_slist_remove(cache->refreshes, refresh);
+
+    /* the result is dropped if the cache has been closed, or the TLE or
+       the settings have changed during the search */
+    if (cache->pool != NULL && refresh->done &&
+        refresh->generation == cache->generation)
+    {
+        entry = g_hash_table_lookup(cache->entries, &refresh->catnum);
+        if (entry != NULL && entry->epoch != refresh->epoch)
+            entry = NULL;
+    }
+
+    if (entry != NULL)
+    {
+        /* a pass in progress at the start of the search is cached already */
+        if (refresh->passes != NULL)
+            last = PASS(g_slist_last(refresh->passes)->data)->aos;
+
+        found = pass_job_take(refresh->job);
+        for (node = found; node != NULL; node = node->next)
+        {
+            if (PASS(node->data)->aos <= last)
+            {
+                free_pass(PASS(node->data));
+                continue;
+            }
+            refresh->passes = g_slist_append(refresh->passes, node->data);
+            changed = TRUE;
+        }
+        g_slist_free(found);
+
+        free_passes(entry->passes);
+        entry->passes = refresh->passes;
+        refresh->passes = NULL;
+        entry->ts = refresh->ts;
+        entry->te = refresh->te;
+        entry->num = refresh->num;
+        entry->refreshing = FALSE;
+
+        if (changed && cache->notify != NULL)
+            cache->notify(cache->notify_data);
+    }
+
+    refresh_free(refresh);
+    cache_unref(cache);
+
+    return FALSE;
+}
+
+static void refresh_worker(gpointer data, gpointer user_data)
+{
+    pass_refresh_t *refresh = data;
+
+    (void)user_data;
+
+    refresh->done = pass_job_run(refresh->job);
+    g_idle_add(refresh_done, refresh);
+}
+
+/*
+ * Search the passes with AOS from t to the end of the window on a worker.
+ * passes are the cached passes that are still in the window and become the
+ * start of the passes of the entry when the search is done.
+ */
+static void refresh_start(pred_cache_t * cache, pred_entry_t * entry,
+                          sat_t * sat, qth_t * qth, GSList * passes,
+                          gdouble t, gdouble start, gdouble end, guint num)
+{
+    pass_refresh_t *refresh;
+    GSList         *node;
+
+    refresh = g_new0(pass_refresh_t, 1);
+    refresh->cache = cache;
+    refresh->catnum = entry->catnum;
+    refresh->epoch = entry->epoch;
+    refresh->generation = cache->generation;
+    refresh->ts = start;
+    refresh->te = end;
+    refresh->num = num;
+    for (node = passes; node != NULL; node = node->next)
+        refresh->passes = g_slist_prepend(refresh->passes,
+                                          copy_pass(PASS(node->data)));
+    refresh->passes = g_slist_reverse(refresh->passes);
+
+    /* the settings are read here since the job runs on another thread */
+    refresh->job = pass_job_new(sat, qth, t, end - t,
+                                num - g_slist_length(passes));
+
+    entry->refreshing = TRUE;
+    cache->refs++;
+    cache->refreshes = g_slist_prepend(cache->refreshes, refresh);
+    g_thread_pool_push(cache->pool, refresh, NULL);
+}
+
+static gboolean read_key(reader_t * rd, pred_key_t * key)
+{
+    return (GET(rd, key->lat) && GET(rd, key->lon) && GET(rd, key->alt) &&
+            GET(rd, key->min_el) && GET(rd, key->resolution) &&
+            GET(rd, key->entries) && GET(rd, key->look_ahead) &&
+            GET(rd, key->twilight));
+}
+
+static void write_key(GByteArray * buf, const pred_key_t * key)
+{
+    PUT(buf, key->lat);
+    PUT(buf, key->lon);
+    PUT(buf, key->alt);
+    PUT(buf, key->min_el);
+    PUT(buf, key->resolution);
+    PUT(buf, key->entries);
+    PUT(buf, key->look_ahead);
+    PUT(buf, key->twilight);
+}
+
+static pass_t  *read_pass(reader_t * rd)
+{
+    pass_t         *pass;
+    guint32         ndet;
+    gint32          orbit;
+
+    pass = g_new0(pass_t, 1);
+    if (!GET(rd, pass->aos) || !GET(rd, pass->tca) || !GET(rd, pass->los) ||
+        !GET(rd, pass->max_el) || !GET(rd, pass->aos_az) ||
+        !GET(rd, pass->los_az) || !GET(rd, pass->maxel_az) ||
+        !GET(rd, orbit) || !GET(rd, pass->vis) || !GET(rd, ndet) ||
+        !read_room(rd, ndet, sizeof(pass_detail_t)))
+    {
+        g_free(pass);
+        return NULL;
+    }
+
+    pass->orbit = orbit;
+    pass->vis[3] = '\0';
+    pass->details = g_array_sized_new(FALSE, FALSE, sizeof(pass_detail_t),
+                                      ndet);
+    g_array_append_vals(pass->details, rd->p, ndet);
+    rd->p += ndet * sizeof(pass_detail_t);
+
+    return pass;
+}
+
+static void write_pass(GByteArray * buf, pass_t * pass)
+{
+    guint32         ndet = PASS_NUM_DETAILS(pass);
+    gint32          orbit = pass->orbit;
+
+    PUT(buf, pass->aos);
+    PUT(buf, pass->tca);
+    PUT(buf, pass->los);
+    PUT(buf, pass->max_el);
+    PUT(buf, pass->aos_az);
+    PUT(buf, pass->los_az);
+    PUT(buf, pass->maxel_az);
+    PUT(buf, orbit);
+    PUT(buf, pass->vis);
+    PUT(buf, ndet);
+    if (ndet > 0)
+        g_byte_array_append(buf, (const guint8 *)pass->details->data,
+                            ndet * sizeof(pass_detail_t));
+}
+
+static pred_entry_t *read_entry(reader_t * rd)
+{
+    pred_entry_t   *entry;
+    pass_t         *pass;
+    gint32          catnum, num, orbit, tracknum;
+    guint32         npass, ntrack, i;
+
+    entry = g_new0(pred_entry_t, 1);
+    if (!GET(rd, catnum) || !GET(rd, entry->epoch) ||
+        !GET(rd, entry->ev_time) || !GET(rd, entry->aos) ||
+        !GET(rd, entry->los) || !GET(rd, entry->ts) || !GET(rd, entry->te) ||
+        !GET(rd, num) || !GET(rd, npass))
+        goto error;
+
+    entry->catnum = catnum;
+    entry->num = num;
+    for (i = 0; i < npass; i++)
+    {
+        pass = read_pass(rd);
+        if (pass == NULL)
+            goto error;
+        entry->passes = g_slist_prepend(entry->passes, pass);
+    }
+    entry->passes = g_slist_reverse(entry->passes);
+
+    if (!GET(rd, orbit) || !GET(rd, tracknum) || !GET(rd, ntrack) ||
+        !read_room(rd, ntrack, 2 * sizeof(gdouble)))
+        goto error;
+
+    entry->track_orbit = orbit;
+    entry->track_num = tracknum;
+    if (tracknum > 0)
+    {
+        entry->track = g_array_sized_new(FALSE, FALSE, sizeof(gdouble),
+                                         2 * ntrack);
+        g_array_append_vals(entry->track, rd->p, 2 * ntrack);
+    }
+    rd->p += ntrack * 2 * sizeof(gdouble);
+
+    return entry;
+
+  error:
+    entry_free(entry);
+
+    return NULL;
+}
+
+static void write_entry(GByteArray * buf, pred_entry_t * entry)
+{
+    GSList         *node;
+    gint32          catnum = entry->catnum;
+    gint32          num = entry->num;
+    guint32         npass = g_slist_length(entry->passes);
+    gint32          orbit = entry->track_orbit;
+    gint32          tracknum = entry->track_num;
+    guint32         ntrack = 0;
+
+    PUT(buf, catnum);
+    PUT(buf, entry->epoch);
+    PUT(buf, entry->ev_time);
+    PUT(buf, entry->aos);
+    PUT(buf, entry->los);
+    PUT(buf, entry->ts);
+    PUT(buf, entry->te);
+    PUT(buf, num);
+    PUT(buf, npass);
+    for (node = entry->passes; node != NULL; node = node->next)
+        write_pass(buf, PASS(node->data));
+
+    if (tracknum > 0)
+        ntrack = entry->track->len / 2;
+    PUT(buf, orbit);
+    PUT(buf, tracknum);
+    PUT(buf, ntrack);
+    if (ntrack > 0)
+        g_byte_array_append(buf, (const guint8 *)entry->track->data,
+                            ntrack * 2 * sizeof(gdouble));
+}
+
+/* Read the cache file; returns FALSE if it is missing or not usable */
+static gboolean read_file(pred_cache_t * cache)
+{
+    reader_t        rd;
+    pred_key_t      key;
+    pred_entry_t   *entry;
+    gchar          *contents;
+    gsize           length;
+    gchar           magic[8];
+    guint32         version, detsize, count, i;
+    gboolean        ok = FALSE;
+
+    if (!g_file_get_contents(cache->filename, &contents, &length, NULL))
+        return FALSE;
+
+    rd.p = (const guint8 *)contents;
+    rd.end = rd.p + length;
+
+    if (!GET(&rd, magic) || memcmp(magic, PRED_CACHE_MAGIC, 8) ||
+        !GET(&rd, version) || version != PRED_CACHE_VERSION ||
+        !GET(&rd, detsize) || detsize != sizeof(pass_detail_t) ||
+        !read_key(&rd, &key) || !GET(&rd, count))
+        goto out;
+
+    for (i = 0; i < count; i++)
+    {
+        entry = read_entry(&rd);
+        if (entry == NULL)
+            goto out;
+
+        /* only the ground tracks are valid for another QTH */
+        if (!key_equal(&key, &cache->key))
+            entry_clear_pred(entry);
+
+        g_hash_table_replace(cache->entries, &entry->catnum, entry);
+    }
+    ok = TRUE;
+
+  out:
+    g_free(contents);
+    if (!ok)
+        g_hash_table_remove_all(cache->entries);
+
+    return ok;
+}
+
+/**
+ * Load the prediction cache of a module.
+ *
+ * @param modname The name of the module.
+ * @param qth The QTH of the module.
+ * @return The cache, which is empty if there is no valid cache file, or NULL
+ *         if the predictions of the module can not be cached. Free it with
+ *         pred_cache_free().
+ *
+ * The predictions for a QTH that follows a trajectory are not cached, since
+ * they depend on the trajectory file.
+ */
+pred_cache_t   *pred_cache_load(const gchar * modname, qth_t * qth)
+{
+    pred_cache_t   *cache;
+    gchar          *dir;
+    gchar          *fname;
+
+    if (qth->traj != NULL)
+        return NULL;
+
+    cache = g_new0(pred_cache_t, 1);
+    cache->entries = g_hash_table_new_full(g_int_hash, g_int_equal, NULL,
+                                           entry_free);
+    cache->refs = 1;
+
+    /* each search already uses all cores, see pass_job_run() */
+    cache->pool = g_thread_pool_new(refresh_worker, NULL, 1, FALSE, NULL);
+    key_get(&cache->key, qth);
+
+    dir = get_cache_dir();
+    fname = g_strconcat(modname, ".cache", NULL);
+    cache->filename = g_build_filename(dir, fname, NULL);
+    g_free(fname);
+    g_free(dir);
+
+    if (read_file(cache))
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Read cached predictions for %d satellites "
+                      "from %s"), __func__,
+                    g_hash_table_size(cache->entries), cache->filename);
+    else
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: No usable prediction cache in %s"), __func__,
+                    cache->filename);
+
+    return cache;
+}
+
+/**
+ * Save the prediction cache.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param sats The satellites of the module; the data of other satellites
+ *             is not saved.
+ * @return TRUE if the cache has been saved.
+ */
+gboolean pred_cache_save(pred_cache_t * cache, GHashTable * sats)
+{
+    GByteArray     *buf;
+    GHashTableIter  iter;
+    GError         *error = NULL;
+    gpointer        value;
+    pred_entry_t   *entry;
+    gchar          *dir;
+    guint32         version = PRED_CACHE_VERSION;
+    guint32         detsize = sizeof(pass_detail_t);
+    guint32         count = 0;
+    guint           countpos;
+    gboolean        ok;
+
+    if (cache == NULL)
+        return FALSE;
+
+    buf = g_byte_array_new();
+    g_byte_array_append(buf, (const guint8 *)PRED_CACHE_MAGIC, 8);
+    PUT(buf, version);
+    PUT(buf, detsize);
+    write_key(buf, &cache->key);
+
+    /* the number of entries is filled in when they have been written */
+    countpos = buf->len;
+    PUT(buf, count);
+
+    g_hash_table_iter_init(&iter, cache->entries);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        entry = value;
+        if (g_hash_table_lookup(sats, &entry->catnum) == NULL)
+            continue;
+
+        write_entry(buf, entry);
+        count++;
+    }
+    memcpy(buf->data + countpos, &count, sizeof(count));
+
+    dir = g_path_get_dirname(cache->filename);
+    g_mkdir_with_parents(dir, 0755);
+    g_free(dir);
+
+    ok = g_file_set_contents(cache->filename, (const gchar *)buf->data,
+                             buf->len, &error);
+    if (ok)
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Saved predictions for %d satellites to %s "
+                      "(reused %d events, %d pass lists, %d ground tracks)"),
+                    __func__, count, cache->filename, cache->events_reused,
+                    cache->passes_reused, cache->tracks_reused);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not save prediction cache %s (%s)"),
+                    __func__, cache->filename, error->message);
+        g_clear_error(&error);
+    }
+    g_byte_array_free(buf, TRUE);
+
+    return ok;
+}
+
+/**
+ * Free a prediction cache; cache may be NULL.
+ *
+ * Searches that are still running are cancelled; the cache is released
+ * when they have returned to the main loop.
+ */
+void pred_cache_free(pred_cache_t * cache)
+{
+    GSList         *node;
+
+    if (cache == NULL)
+        return;
+
+    for (node = cache->refreshes; node != NULL; node = node->next)
+        pass_job_cancel(((pass_refresh_t *) node->data)->job);
+
+    g_thread_pool_free(cache->pool, FALSE, FALSE);
+    cache->pool = NULL;
+    cache->notify = NULL;
+
+    cache_unref(cache);
+}
+
+/**
+ * Set the function called when passes have been found in the background.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param func The function, called on the main loop, or NULL.
+ * @param data The data passed to func.
+ */
+void pred_cache_set_notify(pred_cache_t * cache, pred_cache_func_t func,
+                           gpointer data)
+{
+    if (cache == NULL)
+        return;
+
+    cache->notify = func;
+    cache->notify_data = data;
+}
+
+/**
+ * Get cached AOS and LOS.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param sat The satellite.
+ * @param qth The QTH.
+ * @param t The current time.
+ * @param aos Where to store the time of the next AOS.
+ * @param los Where to store the time of the next LOS.
+ * @return TRUE if the cached events are the next ones after t.
+ *
+ * The events are found at most once; they are only meant to replace the
+ * first search when the module is opened.
+ */
+gboolean pred_cache_take_events(pred_cache_t * cache, sat_t * sat,
+                                qth_t * qth, gdouble t, gdouble * aos,
+                                gdouble * los)
+{
+    pred_entry_t   *entry;
+    gdouble         ev_time;
+
+    if (cache == NULL)
+        return FALSE;
+
+    check_key(cache, qth);
+    entry = get_entry(cache, sat, FALSE);
+    if (entry == NULL)
+        return FALSE;
+
+    ev_time = entry->ev_time;
+    entry->ev_time = 0.0;
+
+    /* nothing can have happened between ev_time and the first event */
+    if (ev_time == 0.0 || ev_time > t || entry->aos <= t || entry->los <= t)
+        return FALSE;
+
+    *aos = entry->aos;
+    *los = entry->los;
+    cache->events_reused++;
+
+    return TRUE;
+}
+
+/**
+ * Store AOS and LOS of a satellite.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param sat The satellite; sat->aos and sat->los must be the next events
+ *            after t.
+ * @param qth The QTH.
+ * @param t The time.
+ */
+void pred_cache_put_events(pred_cache_t * cache, sat_t * sat, qth_t * qth,
+                           gdouble t)
+{
+    pred_entry_t   *entry;
+
+    if (cache == NULL)
+        return;
+
+    check_key(cache, qth);
+    entry = get_entry(cache, sat, TRUE);
+
+    entry->ev_time = (sat->aos > t && sat->los > t) ? t : 0.0;
+    entry->aos = sat->aos;
+    entry->los = sat->los;
+}
+
+/**
+ * Get passes using the cache.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param sat The satellite.
+ * @param qth The QTH.
+ * @param start Start of the time window.
+ * @param maxdt Length of the time window.
+ * @param num The maximum number of passes.
+ * @return The passes, see get_passes(). Free them with free_passes().
+ *
+ * The passes cached for an earlier window of the same length that are not
+ * over yet are returned right away. The rest of the window is searched on
+ * a worker thread and the result is cached for the next call; the function
+ * set with pred_cache_set_notify() is called when new passes have been
+ * found. Without a cache the passes are searched on the calling thread.
+ */
+GSList         *pred_cache_get_passes(pred_cache_t * cache, sat_t * sat,
+                                      qth_t * qth, gdouble start,
+                                      gdouble maxdt, guint num)
+{
+    pred_entry_t   *entry;
+    GSList         *passes = NULL;
+    GSList         *node;
+    pass_t         *pass;
+    gdouble         end = start + maxdt;
+    gdouble         t = start;
+    guint           n = 0;
+
+    if (cache == NULL || maxdt <= 0.0)
+        return get_passes(sat, qth, start, maxdt, num);
+
+    if (num == 0)
+        num = 100;
+
+    check_key(cache, qth);
+    entry = get_entry(cache, sat, TRUE);
+
+    if (entry->num == num && start >= entry->ts &&
+        fabs((entry->te - entry->ts) - maxdt) < 1.0e-6)
+    {
+        /* get_passes() continues PASS_GAP after each LOS */
+        for (node = entry->passes; node != NULL && n < num && t < end;
+             node = node->next)
+        {
+            pass = PASS(node->data);
+            t = MAX(start, pass->los + PASS_GAP);
+            if (pass->los <= start)
+                continue;
+
+            pass = copy_pass(pass);
+            if (pass->satname == NULL)
+                pass->satname = g_strdup(sat->nickname);
+            qth_small_save(qth, &pass->qth_comp);
+            passes = g_slist_prepend(passes, pass);
+            n++;
+        }
+
+        /* all passes with AOS in the cached window have been found,
+           unless there were more than num */
+        if (g_slist_length(entry->passes) < entry->num)
+            t = MAX(t, entry->te);
+
+        cache->passes_reused++;
+    }
+    passes = g_slist_reverse(passes);
+
+    /* search the rest of the window */
+    if (n < num && t < end && !entry->refreshing)
+        refresh_start(cache, entry, sat, qth, passes, t, start, end, num);
+
+    return passes;
+}
+
+/**
+ * Get a cached ground track.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param sat The satellite.
+ * @param orbit The orbit where the track starts.
+ * @param num The number of orbits.
+ * @param len Where to store the number of points.
+ * @return The latitude and longitude of each point, or NULL if the track is
+ *         not cached. The data is owned by the cache.
+ */
+const gdouble  *pred_cache_get_track(pred_cache_t * cache, sat_t * sat,
+                                     glong orbit, gint num, guint * len)
+{
+    pred_entry_t   *entry;
+
+    if (cache == NULL)
+        return NULL;
+
+    entry = get_entry(cache, sat, FALSE);
+    if (entry == NULL || entry->track == NULL || entry->track_num != num ||
+        entry->track_orbit != orbit)
+        return NULL;
+
+    *len = entry->track->len / 2;
+    cache->tracks_reused++;
+
+    return (const gdouble *)entry->track->data;
+}
+
+/**
+ * Store the ground track of a satellite.
+ *
+ * @param cache The prediction cache, may be NULL.
+ * @param sat The satellite.
+ * @param orbit The orbit where the track starts.
+ * @param num The number of orbits.
+ * @param track The latitude and longitude of each point as gdouble; the
+ *              cache takes the reference.
+ */
+void pred_cache_put_track(pred_cache_t * cache, sat_t * sat, glong orbit,
+                          gint num, GArray * track)
+{
+    pred_entry_t   *entry;
+
+    if (cache == NULL)
+    {
+        g_array_unref(track);
+        return;
+    }
+
+    entry = get_entry(cache, sat, TRUE);
+    if (entry->track != NULL)
+        g_array_unref(entry->track);
+
+    entry->track = track;
+    entry->track_orbit = orbit;
+    entry->track_num = num;
+}
@@ -0,0 +1,66 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PRED_CACHE_H
+#define PRED_CACHE_H 1
+
+#include <glib.h>
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+#include "qth-data.h"
+
+/**
+ * Prediction cache of a module.
+ *
+ * The cache keeps the AOS/LOS times, the sky at a glance passes and the
+ * ground tracks of the satellites in a module, and is saved to
+ * USER_CONF_DIR/cache/<module>.cache when the module is closed. When the
+ * module is opened again the data that is still valid is reused instead of
+ * being computed on the first cycles.
+ *
+ * The data of a satellite is valid for its TLE epoch. Events and passes are
+ * also tied to the position of the QTH and the prediction settings, and are
+ * dropped when either changes. Ground tracks only depend on the orbit.
+ */
+typedef struct pred_cache pred_cache_t;
+
+/** Function called when the cache has new data. */
+typedef void    (*pred_cache_func_t) (gpointer data);
+
+pred_cache_t   *pred_cache_load(const gchar * modname, qth_t * qth);
+gboolean        pred_cache_save(pred_cache_t * cache, GHashTable * sats);
+void            pred_cache_free(pred_cache_t * cache);
+void            pred_cache_set_notify(pred_cache_t * cache,
+                                      pred_cache_func_t func, gpointer data);
+
+gboolean        pred_cache_take_events(pred_cache_t * cache, sat_t * sat,
+                                       qth_t * qth, gdouble t,
+                                       gdouble * aos, gdouble * los);
+void            pred_cache_put_events(pred_cache_t * cache, sat_t * sat,
+                                      qth_t * qth, gdouble t);
+
+GSList         *pred_cache_get_passes(pred_cache_t * cache, sat_t * sat,
+                                      qth_t * qth, gdouble start,
+                                      gdouble maxdt, guint num);
+
+const gdouble  *pred_cache_get_track(pred_cache_t * cache, sat_t * sat,
+                                     glong orbit, gint num, guint * len);
+void            pred_cache_put_track(pred_cache_t * cache, sat_t * sat,
+                                     glong orbit, gint num, GArray * track);
+
+#endif
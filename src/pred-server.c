@@ -0,0 +1,1217 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <gio/gio.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include "compat.h"
+#include "gtk-sat-data.h"
+#include "pred-server.h"
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "sat-vis.h"
+#include "sgpsdp/sgp4sdp4.h"
+#include "time-tools.h"
+
+
+/* max number of connections served in parallel */
+#define MAX_CLIENTS 8
+
+/* max number of satellites in a batch query */
+#define MAX_BATCH 100000
+
+/* min number of satellites per batch job */
+#define BATCH_CHUNK 32
+
+/* max number of passes and days in a query */
+#define MAX_PASSES 100
+#define MAX_DAYS 30.0
+
+/* drop cached passes that ended more than this before a query [days] */
+#define CACHE_KEEP 1.0
+
+/* max number of satellite and location pairs in the pass cache */
+#define CACHE_SIZE 4096
+
+/* gap between a LOS and the next search, as in get_passes() [days] */
+#define PASS_GAP 0.014
+
+/**
+ * Cached passes of a satellite for one location.
+ *
+ * The entry holds every pass with LOS after t0 and AOS before tnext,
+ * regardless of its maximum elevation.
+ */
+typedef struct {
+    gint            refcount;   /*!< Cache + queries using the entry */
+    GMutex          lock;       /*!< Protects the fields below */
+    gdouble         t0;         /*!< Start of the searched window */
+    gdouble         tnext;      /*!< Where the next search starts */
+    GPtrArray      *passes;     /*!< pass_t, sorted by AOS */
+} pass_cache_t;
+
+typedef gboolean (*query_func_t) (GHashTable * args, GString * resp,
+                                  gchar ** error);
+
+/** Query type and its statistics. */
+typedef struct {
+    const gchar    *name;
+    query_func_t    func;
+    guint64         count;      /*!< Number of queries */
+    guint64         errors;     /*!< Number of failed queries */
+    guint64         total_us;   /*!< Total time [usec] */
+    guint64         max_us;     /*!< Longest time [usec] */
+} query_t;
+
+/** Position of a satellite in a batch query. */
+typedef struct {
+    gint            catnum;
+    gboolean        ok;
+    gdouble         az;
+    gdouble         el;
+    gdouble         range;
+    gdouble         range_rate;
+    gdouble         ssplat;
+    gdouble         ssplon;
+    gdouble         alt;
+} batch_rec_t;
+
+typedef struct {
+    batch_rec_t    *recs;
+    qth_t           qth;
+    gdouble         t;
+    gint            pending;    /*!< Jobs not finished yet */
+    GMutex          lock;
+    GCond           cond;
+} batch_t;
+
+typedef struct {
+    batch_t        *batch;
+    guint           first;
+    guint           last;
+} batch_job_t;
+
+static gboolean query_get_passes(GHashTable * args, GString * resp,
+                                 gchar ** error);
+static gboolean query_get_pass(GHashTable * args, GString * resp,
+                               gchar ** error);
+static gboolean query_predict_calc(GHashTable * args, GString * resp,
+                                   gchar ** error);
+static gboolean query_batch(GHashTable * args, GString * resp,
+                            gchar ** error);
+static gboolean query_stats(GHashTable * args, GString * resp,
+                            gchar ** error);
+
+static query_t  queries[] = {
+    {"get_passes", query_get_passes, 0, 0, 0, 0},
+    {"get_pass", query_get_pass, 0, 0, 0, 0},
+    {"predict_calc", query_predict_calc, 0, 0, 0, 0},
+    {"batch", query_batch, 0, 0, 0, 0},
+    {"stats", query_stats, 0, 0, 0, 0}
+};
+
+/* satellite data, locations and pass cache; protected by data_lock */
+static GMutex   data_lock;
+static GHashTable *sats = NULL;
+static GHashTable *qths = NULL;
+static GHashTable *cache = NULL;
+static guint64  cache_hits = 0;
+static guint64  cache_misses = 0;
+
+/* protects the query statistics */
+static GMutex   stats_lock;
+
+static GMutex   pool_lock;
+static GThreadPool *pool = NULL;
+
+static GSocketService *service = NULL;
+static GCancellable *cancel = NULL;
+static gchar   *sockpath = NULL;
+
+
+static void pass_cache_unref(gpointer data)
+{
+    pass_cache_t   *entry = data;
+
+    if (!g_atomic_int_dec_and_test(&entry->refcount))
+        return;
+
+    g_ptr_array_free(entry->passes, TRUE);
+    g_mutex_clear(&entry->lock);
+    g_free(entry);
+}
+
+static void data_init(void)
+{
+    if (sats != NULL)
+        return;
+
+    sats = g_hash_table_new_full(g_int_hash, g_int_equal, NULL,
+                                 (GDestroyNotify) gtk_sat_data_free_sat);
+    qths = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                  pass_cache_unref);
+}
+
+/* Copy a satellite of the sats table; see mod_mgr_sat_acquire() */
+static void copy_sat(sat_t * sat, sat_t * src)
+{
+    Sat_Copy(sat, src);
+    sat->name = g_strdup(src->name);
+    sat->nickname = g_strdup(src->nickname);
+    sat->website = NULL;
+    sat->flags &= DEEP_SPACE_EPHEM_FLAG;
+    sat->jul_utc = 0.0;
+    sat->tsince = 0.0;
+}
+
+/**
+ * Get a private copy of a satellite.
+ *
+ * The .sat file is read the first time the satellite is requested. The
+ * copy must be cleared with gtk_sat_data_clear_sat().
+ */
+static gboolean get_sat(gint catnum, sat_t * sat)
+{
+    sat_t          *src;
+    sat_t          *new;
+
+    g_mutex_lock(&data_lock);
+    data_init();
+    src = g_hash_table_lookup(sats, &catnum);
+    if (src != NULL)
+        copy_sat(sat, src);
+    g_mutex_unlock(&data_lock);
+
+    if (src != NULL)
+        return TRUE;
+
+    /* the file is read without the lock, so that other queries are not
+       blocked by the disk */
+    new = g_new0(sat_t, 1);
+    if (gtk_sat_data_read_sat(catnum, new))
+    {
+        gtk_sat_data_free_sat(new);
+        return FALSE;
+    }
+
+    g_mutex_lock(&data_lock);
+    data_init();
+    src = g_hash_table_lookup(sats, &catnum);
+    if (src == NULL)
+    {
+        g_hash_table_insert(sats, &new->tle.catnr, new);
+        src = new;
+        new = NULL;
+    }
+    copy_sat(sat, src);
+    g_mutex_unlock(&data_lock);
+
+    /* another query has read the satellite in the meantime */
+    if (new != NULL)
+        gtk_sat_data_free_sat(new);
+
+    return TRUE;
+}
+
+/**
+ * Get the observer location.
+ *
+ * @param name The QTH file name with or without .qth, NULL for the default.
+ * @param qth The qth_t to fill in; only the position is set.
+ */
+static gboolean get_qth(const gchar * name, qth_t * qth)
+{
+    qth_t          *loc;
+    qth_t          *tmp;
+    gchar          *fname, *confdir, *path;
+
+    if (name != NULL)
+    {
+        if (strchr(name, '/') || strchr(name, '\\') || name[0] == '.')
+            return FALSE;
+        fname = g_str_has_suffix(name, ".qth") ? g_strdup(name) :
+            g_strconcat(name, ".qth", NULL);
+    }
+    else
+    {
+        fname = g_strdup(sat_cfg_peek_str(SAT_CFG_STR_DEF_QTH));
+    }
+
+    g_mutex_lock(&data_lock);
+    data_init();
+
+    loc = g_hash_table_lookup(qths, fname);
+    if (loc == NULL)
+    {
+        tmp = g_new0(qth_t, 1);
+        confdir = get_user_conf_dir();
+        path = g_strconcat(confdir, G_DIR_SEPARATOR_S, fname, NULL);
+        if (!qth_data_read(path, tmp))
+        {
+            qth_data_free(tmp);
+            g_free(confdir);
+            g_free(path);
+            g_free(fname);
+            g_mutex_unlock(&data_lock);
+            return FALSE;
+        }
+
+        loc = g_new0(qth_t, 1);
+        loc->lat = tmp->lat;
+        loc->lon = tmp->lon;
+        loc->alt = tmp->alt;
+        g_hash_table_insert(qths, fname, loc);
+
+        qth_data_free(tmp);
+        g_free(confdir);
+        g_free(path);
+    }
+    else
+    {
+        g_free(fname);
+    }
+
+    memset(qth, 0, sizeof(qth_t));
+    qth->lat = loc->lat;
+    qth->lon = loc->lon;
+    qth->alt = loc->alt;
+
+    g_mutex_unlock(&data_lock);
+
+    return TRUE;
+}
+
+/**
+ * Get passes from the cache, searching for new ones as necessary.
+ *
+ * @param catnum The satellite.
+ * @param qth The observer.
+ * @param t The start time.
+ * @param tlim Passes must begin before this time.
+ * @param num The max number of passes.
+ * @param minel The minimum elevation of the passes.
+ * @param passes Array to which the passes are added.
+ * @return The cache entry, locked, or NULL if the satellite could not be
+ *         loaded. The passes are owned by the entry and are valid until
+ *         pass_cache_release() is called.
+ */
+static pass_cache_t *pass_cache_get(gint catnum, qth_t * qth, gdouble t,
+                                    gdouble tlim, guint num, gdouble minel,
+                                    GPtrArray * passes)
+{
+    pass_cache_t   *entry;
+    pass_t         *pass;
+    sat_t           sat;
+    gchar          *key;
+    gboolean        loaded = FALSE;
+    gboolean        hit = TRUE;
+    guint           i, n;
+
+    key = g_strdup_printf("%d:%.5f:%.5f:%d", catnum, qth->lat, qth->lon,
+                          qth->alt);
+
+    g_mutex_lock(&data_lock);
+    data_init();
+    entry = g_hash_table_lookup(cache, key);
+    if (entry == NULL)
+    {
+        if (g_hash_table_size(cache) >= CACHE_SIZE)
+            g_hash_table_remove_all(cache);
+
+        entry = g_new0(pass_cache_t, 1);
+        entry->refcount = 1;
+        g_mutex_init(&entry->lock);
+        entry->t0 = entry->tnext = t;
+        entry->passes = g_ptr_array_new_with_free_func((GDestroyNotify)
+                                                       free_pass);
+        g_hash_table_insert(cache, key, entry);
+    }
+    else
+    {
+        g_free(key);
+    }
+    g_atomic_int_inc(&entry->refcount);
+    g_mutex_unlock(&data_lock);
+
+    g_mutex_lock(&entry->lock);
+
+    /* start over if the query is before the window or far after it */
+    if (t < entry->t0 || t > entry->tnext + CACHE_KEEP)
+    {
+        g_ptr_array_set_size(entry->passes, 0);
+        entry->t0 = entry->tnext = t;
+    }
+    else if (t > entry->t0 + CACHE_KEEP)
+    {
+        for (n = 0; n < entry->passes->len; n++)
+            if (((pass_t *) g_ptr_array_index(entry->passes, n))->los > t)
+                break;
+        g_ptr_array_remove_range(entry->passes, 0, n);
+        entry->t0 = t;
+    }
+
+    for (i = 0; i < entry->passes->len && passes->len < num; i++)
+    {
+        pass = g_ptr_array_index(entry->passes, i);
+        if (pass->aos > tlim)
+            break;
+        if (pass->los > t && pass->max_el >= minel)
+            g_ptr_array_add(passes, pass);
+    }
+
+    /* search the rest of the window */
+    while (passes->len < num && entry->tnext < tlim)
+    {
+        if (!loaded)
+        {
+            if (!get_sat(catnum, &sat))
+            {
+                g_mutex_unlock(&entry->lock);
+                pass_cache_unref(entry);
+                return NULL;
+            }
+            loaded = TRUE;
+            hit = FALSE;
+        }
+
+        pass = get_pass_no_min_el(&sat, qth, entry->tnext,
+                                  tlim - entry->tnext);
+        if (pass == NULL)
+        {
+            entry->tnext = tlim;
+            break;
+        }
+
+        g_ptr_array_add(entry->passes, pass);
+        entry->tnext = pass->los + PASS_GAP;
+
+        if (pass->los > t && pass->max_el >= minel)
+            g_ptr_array_add(passes, pass);
+    }
+
+    if (loaded)
+        gtk_sat_data_clear_sat(&sat);
+
+    g_mutex_lock(&stats_lock);
+    if (hit)
+        cache_hits++;
+    else
+        cache_misses++;
+    g_mutex_unlock(&stats_lock);
+
+    return entry;
+}
+
+static void pass_cache_release(pass_cache_t * entry)
+{
+    g_mutex_unlock(&entry->lock);
+    pass_cache_unref(entry);
+}
+
+static void batch_job_run(gpointer data, gpointer user_data)
+{
+    batch_job_t    *job = data;
+    batch_t        *batch = job->batch;
+    batch_rec_t    *rec;
+    sat_t           sat;
+    guint           i;
+
+    (void)user_data;
+
+    for (i = job->first; i < job->last; i++)
+    {
+        rec = &batch->recs[i];
+        if (!get_sat(rec->catnum, &sat))
+            continue;
+
+        predict_calc(&sat, &batch->qth, batch->t);
+        rec->ok = TRUE;
+        rec->az = sat.az;
+        rec->el = sat.el;
+        rec->range = sat.range;
+        rec->range_rate = sat.range_rate;
+        rec->ssplat = sat.ssplat;
+        rec->ssplon = sat.ssplon;
+        rec->alt = sat.alt;
+
+        gtk_sat_data_clear_sat(&sat);
+    }
+
+    g_mutex_lock(&batch->lock);
+    if (--batch->pending == 0)
+        g_cond_signal(&batch->cond);
+    g_mutex_unlock(&batch->lock);
+
+    g_free(job);
+}
+
+/* Run a batch in the thread pool and wait for it to finish */
+static void batch_run(batch_t * batch, guint n)
+{
+    GError         *error = NULL;
+    batch_job_t    *job;
+    guint           nproc, chunk, i;
+
+    g_mutex_lock(&pool_lock);
+    if (pool == NULL)
+    {
+        pool = g_thread_pool_new(batch_job_run, NULL, g_get_num_processors(),
+                                 FALSE, &error);
+        if (error != NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not create thread pool (%s)"),
+                        __func__, error->message);
+            g_clear_error(&error);
+            pool = NULL;
+        }
+    }
+    g_mutex_unlock(&pool_lock);
+
+    nproc = g_get_num_processors();
+    chunk = MAX((n + nproc - 1) / nproc, BATCH_CHUNK);
+    batch->pending = (n + chunk - 1) / chunk;
+
+    for (i = 0; i < n; i += chunk)
+    {
+        job = g_new(batch_job_t, 1);
+        job->batch = batch;
+        job->first = i;
+        job->last = MIN(i + chunk, n);
+
+        if (pool != NULL)
+            g_thread_pool_push(pool, job, NULL);
+        else
+            batch_job_run(job, NULL);
+    }
+
+    g_mutex_lock(&batch->lock);
+    while (batch->pending > 0)
+        g_cond_wait(&batch->cond, &batch->lock);
+    g_mutex_unlock(&batch->lock);
+}
+
+/* Get the catalogue numbers of all satellites in the satellite data */
+static GArray  *all_catnums(void)
+{
+    GArray         *catnums;
+    GDir           *dir;
+    gchar          *dirname;
+    const gchar    *fname;
+    gint            catnum;
+
+    catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+    dirname = get_satdata_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    g_free(dirname);
+
+    if (dir == NULL)
+        return catnums;
+
+    while ((fname = g_dir_read_name(dir)) != NULL &&
+           catnums->len < MAX_BATCH)
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        catnum = (gint) g_ascii_strtoll(fname, NULL, 10);
+        if (catnum > 0)
+            g_array_append_val(catnums, catnum);
+    }
+    g_dir_close(dir);
+
+    return catnums;
+}
+
+static void json_double(GString * resp, const gchar * key,
+                        const gchar * format, gdouble value)
+{
+    gchar           str[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* e.g. decayed satellites */
+    if (!isfinite(value))
+    {
+        g_string_append_printf(resp, ",\"%s\":null", key);
+        return;
+    }
+
+    g_string_append_printf(resp, ",\"%s\":%s", key,
+                           g_ascii_formatd(str, sizeof(str), format, value));
+}
+
+static void json_string(GString * resp, const gchar * key,
+                        const gchar * value)
+{
+    const gchar    *c;
+
+    g_string_append_printf(resp, ",\"%s\":\"", key);
+    for (c = value ? value : ""; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            g_string_append_c(resp, '\\');
+        if ((guchar) * c >= 0x20)
+            g_string_append_c(resp, *c);
+    }
+    g_string_append_c(resp, '"');
+}
+
+static void json_pass(GString * resp, pass_t * pass, gboolean details)
+{
+    pass_detail_t  *detail;
+    guint           i;
+
+    g_string_append_printf(resp, "{\"orbit\":%d", pass->orbit);
+    json_double(resp, "aos", "%.8f", pass->aos);
+    json_double(resp, "tca", "%.8f", pass->tca);
+    json_double(resp, "los", "%.8f", pass->los);
+    json_double(resp, "max_el", "%.3f", pass->max_el);
+    json_double(resp, "aos_az", "%.3f", pass->aos_az);
+    json_double(resp, "maxel_az", "%.3f", pass->maxel_az);
+    json_double(resp, "los_az", "%.3f", pass->los_az);
+    json_string(resp, "vis", pass->vis);
+
+    if (details)
+    {
+        g_string_append(resp, ",\"details\":[");
+        for (i = 0; i < PASS_NUM_DETAILS(pass); i++)
+        {
+            detail = PASS_NTH_DETAIL(pass, i);
+            g_string_append_printf(resp, "%s{\"vis\":\"%c\"", i ? "," : "",
+                                   vis_to_chr(detail->vis));
+            json_double(resp, "t", "%.8f", detail->time);
+            json_double(resp, "az", "%.3f", detail->az);
+            json_double(resp, "el", "%.3f", detail->el);
+            json_double(resp, "range", "%.3f", detail->range);
+            json_double(resp, "range_rate", "%.5f", detail->range_rate);
+            json_double(resp, "lat", "%.3f", detail->lat);
+            json_double(resp, "lon", "%.3f", detail->lon);
+            json_double(resp, "alt", "%.3f", detail->alt);
+            g_string_append_c(resp, '}');
+        }
+        g_string_append_c(resp, ']');
+    }
+
+    g_string_append_c(resp, '}');
+}
+
+/* Argument parsing; the functions return FALSE for malformed values */
+static gboolean arg_double(GHashTable * args, const gchar * key,
+                           gdouble * value)
+{
+    const gchar    *str = g_hash_table_lookup(args, key);
+    gchar          *end;
+
+    if (str == NULL)
+        return TRUE;
+
+    *value = g_ascii_strtod(str, &end);
+
+    return end != str && *end == '\0';
+}
+
+static gboolean arg_int(GHashTable * args, const gchar * key, gint * value)
+{
+    const gchar    *str = g_hash_table_lookup(args, key);
+    gchar          *end;
+
+    if (str == NULL)
+        return TRUE;
+
+    *value = (gint) g_ascii_strtoll(str, &end, 10);
+
+    return end != str && *end == '\0';
+}
+
+/* Common arguments: satellite, time and location */
+static gboolean common_args(GHashTable * args, gint * catnum, gdouble * t,
+                            qth_t * qth, gchar ** error)
+{
+    if (catnum != NULL &&
+        (!g_hash_table_contains(args, "catnum") ||
+         !arg_int(args, "catnum", catnum)))
+    {
+        *error = g_strdup(_("Missing or invalid catnum"));
+        return FALSE;
+    }
+
+    *t = get_current_daynum();
+    if (!arg_double(args, "t", t))
+    {
+        *error = g_strdup(_("Invalid time"));
+        return FALSE;
+    }
+
+    if (!get_qth(g_hash_table_lookup(args, "qth"), qth))
+    {
+        *error = g_strdup(_("Unknown QTH"));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Arguments of the pass queries */
+static gboolean pass_args(GHashTable * args, gint * num, gdouble * minel,
+                          gdouble * days, gchar ** error)
+{
+    *num = sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_PASS);
+    *minel = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    *days = sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+
+    if (!arg_int(args, "num", num) || *num < 1 || *num > MAX_PASSES ||
+        !arg_double(args, "minel", minel) ||
+        !arg_double(args, "days", days) || *days <= 0.0 || *days > MAX_DAYS)
+    {
+        *error = g_strdup(_("Invalid num, minel or days"));
+        return FALSE;
+    }
+
+    /* get_pass() does the same */
+    if (*minel <= 0.0)
+        *minel = 1.0;
+
+    return TRUE;
+}
+
+static gboolean query_passes(GHashTable * args, GString * resp,
+                             gchar ** error, gboolean details)
+{
+    pass_cache_t   *entry;
+    GPtrArray      *passes;
+    qth_t           qth;
+    gdouble         t, minel, days;
+    gint            catnum, num;
+    guint           i;
+
+    if (!common_args(args, &catnum, &t, &qth, error) ||
+        !pass_args(args, &num, &minel, &days, error))
+        return FALSE;
+
+    if (details)
+        num = 1;
+
+    passes = g_ptr_array_new();
+    entry = pass_cache_get(catnum, &qth, t, t + days, num, minel, passes);
+    if (entry == NULL)
+    {
+        g_ptr_array_free(passes, TRUE);
+        *error = g_strdup_printf(_("Unknown satellite %d"), catnum);
+        return FALSE;
+    }
+
+    g_string_append_printf(resp, ",\"catnum\":%d,", catnum);
+    if (details)
+    {
+        g_string_append(resp, "\"pass\":");
+        if (passes->len > 0)
+            json_pass(resp, g_ptr_array_index(passes, 0), TRUE);
+        else
+            g_string_append(resp, "null");
+    }
+    else
+    {
+        g_string_append(resp, "\"passes\":[");
+        for (i = 0; i < passes->len; i++)
+        {
+            if (i > 0)
+                g_string_append_c(resp, ',');
+            json_pass(resp, g_ptr_array_index(passes, i), FALSE);
+        }
+        g_string_append_c(resp, ']');
+    }
+
+    pass_cache_release(entry);
+    g_ptr_array_free(passes, TRUE);
+
+    return TRUE;
+}
+
+static gboolean query_get_passes(GHashTable * args, GString * resp,
+                                 gchar ** error)
+{
+    return query_passes(args, resp, error, FALSE);
+}
+
+static gboolean query_get_pass(GHashTable * args, GString * resp,
+                               gchar ** error)
+{
+    return query_passes(args, resp, error, TRUE);
+}
+
+static gboolean query_predict_calc(GHashTable * args, GString * resp,
+                                   gchar ** error)
+{
+    sat_t           sat;
+    qth_t           qth;
+    gdouble         t;
+    gint            catnum;
+
+    if (!common_args(args, &catnum, &t, &qth, error))
+        return FALSE;
+
+    if (!get_sat(catnum, &sat))
+    {
+        *error = g_strdup_printf(_("Unknown satellite %d"), catnum);
+        return FALSE;
+    }
+
+    predict_calc(&sat, &qth, t);
+
+    g_string_append_printf(resp, ",\"catnum\":%d", catnum);
+    json_string(resp, "name", sat.nickname);
+    json_double(resp, "t", "%.8f", t);
+    json_double(resp, "az", "%.3f", sat.az);
+    json_double(resp, "el", "%.3f", sat.el);
+    json_double(resp, "range", "%.3f", sat.range);
+    json_double(resp, "range_rate", "%.5f", sat.range_rate);
+    json_double(resp, "ra", "%.3f", sat.ra);
+    json_double(resp, "dec", "%.3f", sat.dec);
+    json_double(resp, "ssplat", "%.3f", sat.ssplat);
+    json_double(resp, "ssplon", "%.3f", sat.ssplon);
+    json_double(resp, "alt", "%.3f", sat.alt);
+    json_double(resp, "velo", "%.5f", sat.velo);
+    json_double(resp, "ma", "%.3f", sat.ma);
+    json_double(resp, "phase", "%.3f", sat.phase);
+    json_double(resp, "footprint", "%.3f", sat.footprint);
+    g_string_append_printf(resp, ",\"orbit\":%ld,\"vis\":\"%c\"", sat.orbit,
+                           vis_to_chr(get_sat_vis(&sat, &qth, t)));
+
+    gtk_sat_data_clear_sat(&sat);
+
+    return TRUE;
+}
+
+static gboolean query_batch(GHashTable * args, GString * resp,
+                            gchar ** error)
+{
+    batch_t         batch;
+    batch_rec_t    *rec;
+    GArray         *catnums;
+    gchar         **list;
+    const gchar    *str;
+    gint            catnum;
+    guint           i;
+
+    if (!common_args(args, NULL, &batch.t, &batch.qth, error))
+        return FALSE;
+
+    str = g_hash_table_lookup(args, "catnums");
+    if (str == NULL)
+    {
+        *error = g_strdup(_("Missing catnums"));
+        return FALSE;
+    }
+
+    if (!strcmp(str, "all"))
+    {
+        catnums = all_catnums();
+    }
+    else
+    {
+        catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+        list = g_strsplit(str, ",", MAX_BATCH);
+        for (i = 0; list[i] != NULL && i < MAX_BATCH; i++)
+        {
+            catnum = (gint) g_ascii_strtoll(list[i], NULL, 10);
+            g_array_append_val(catnums, catnum);
+        }
+        g_strfreev(list);
+    }
+
+    batch.recs = g_new0(batch_rec_t, catnums->len);
+    for (i = 0; i < catnums->len; i++)
+        batch.recs[i].catnum = g_array_index(catnums, gint, i);
+
+    g_mutex_init(&batch.lock);
+    g_cond_init(&batch.cond);
+    if (catnums->len > 0)
+        batch_run(&batch, catnums->len);
+    g_mutex_clear(&batch.lock);
+    g_cond_clear(&batch.cond);
+
+    json_double(resp, "t", "%.8f", batch.t);
+    g_string_append(resp, ",\"sats\":[");
+    for (i = 0; i < catnums->len; i++)
+    {
+        rec = &batch.recs[i];
+        g_string_append_printf(resp, "%s{\"catnum\":%d", i ? "," : "",
+                               rec->catnum);
+        if (rec->ok)
+        {
+            json_double(resp, "az", "%.3f", rec->az);
+            json_double(resp, "el", "%.3f", rec->el);
+            json_double(resp, "range", "%.3f", rec->range);
+            json_double(resp, "range_rate", "%.5f", rec->range_rate);
+            json_double(resp, "ssplat", "%.3f", rec->ssplat);
+            json_double(resp, "ssplon", "%.3f", rec->ssplon);
+            json_double(resp, "alt", "%.3f", rec->alt);
+        }
+        else
+        {
+            g_string_append(resp, ",\"error\":\"unknown satellite\"");
+        }
+        g_string_append_c(resp, '}');
+    }
+    g_string_append_c(resp, ']');
+
+    g_free(batch.recs);
+    g_array_free(catnums, TRUE);
+
+    return TRUE;
+}
+
+static gboolean query_stats(GHashTable * args, GString * resp,
+                            gchar ** error)
+{
+    query_t        *q;
+    guint           i;
+
+    (void)args;
+    (void)error;
+
+    g_mutex_lock(&stats_lock);
+
+    g_string_append(resp, ",\"queries\":{");
+    for (i = 0; i < G_N_ELEMENTS(queries); i++)
+    {
+        q = &queries[i];
+        g_string_append_printf(resp, "%s\"%s\":{\"count\":%" G_GUINT64_FORMAT
+                               ",\"errors\":%" G_GUINT64_FORMAT
+                               ",\"mean_us\":%" G_GUINT64_FORMAT
+                               ",\"max_us\":%" G_GUINT64_FORMAT "}",
+                               i ? "," : "", q->name, q->count, q->errors,
+                               q->count ? q->total_us / q->count : 0,
+                               q->max_us);
+    }
+    g_string_append_printf(resp, "},\"pass_cache\":{\"hits\":%"
+                           G_GUINT64_FORMAT ",\"misses\":%" G_GUINT64_FORMAT
+                           "}", cache_hits, cache_misses);
+
+    g_mutex_unlock(&stats_lock);
+
+    return TRUE;
+}
+
+/**
+ * Execute a query.
+ *
+ * @param request The request line.
+ * @return The JSON response without line terminator; free with g_free().
+ *
+ * This function is thread safe.
+ */
+gchar          *pred_server_query(const gchar * request)
+{
+    GHashTable     *args;
+    GString        *resp;
+    query_t        *query = NULL;
+    gchar         **argv;
+    gchar          *error = NULL;
+    gchar          *value;
+    gint64          tstart;
+    guint64         dt;
+    guint           i;
+    gboolean        ok;
+
+    tstart = g_get_monotonic_time();
+
+    argv = g_strsplit_set(request, " \t\r\n", -1);
+    args = g_hash_table_new(g_str_hash, g_str_equal);
+    for (i = 1; argv[i] != NULL; i++)
+    {
+        value = strchr(argv[i], '=');
+        if (value != NULL)
+        {
+            *value = '\0';
+            g_hash_table_insert(args, argv[i], value + 1);
+        }
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(queries); i++)
+        if (!strcmp(argv[0], queries[i].name))
+            query = &queries[i];
+
+    resp = g_string_new("{\"ok\":true");
+    if (query == NULL)
+    {
+        error = g_strdup_printf(_("Unknown query %s"), argv[0]);
+        ok = FALSE;
+    }
+    else
+    {
+        ok = query->func(args, resp, &error);
+    }
+
+    if (ok)
+    {
+        g_string_append_c(resp, '}');
+    }
+    else
+    {
+        g_string_assign(resp, "{\"ok\":false");
+        json_string(resp, "error", error);
+        g_string_append_c(resp, '}');
+        g_free(error);
+    }
+
+    g_hash_table_destroy(args);
+    g_strfreev(argv);
+
+    if (query != NULL)
+    {
+        dt = g_get_monotonic_time() - tstart;
+
+        g_mutex_lock(&stats_lock);
+        query->count++;
+        if (!ok)
+            query->errors++;
+        query->total_us += dt;
+        query->max_us = MAX(query->max_us, dt);
+        g_mutex_unlock(&stats_lock);
+    }
+
+    return g_string_free(resp, FALSE);
+}
+
+/**
+ * Execute the queries in a file and print the responses.
+ *
+ * @param fname The file name, "-" for standard input.
+ * @return 0 on success, 1 if the file could not be read.
+ *
+ * Used by the --query command line option to run queries without the
+ * server, e.g. for testing.
+ */
+gint pred_server_query_file(const gchar * fname)
+{
+    FILE           *file;
+    GString        *line;
+    gchar           buff[4096];
+    gchar          *resp;
+
+    file = strcmp(fname, "-") ? g_fopen(fname, "r") : stdin;
+    if (file == NULL)
+    {
+        g_printerr(_("Can not open %s\n"), fname);
+        return 1;
+    }
+
+    line = g_string_new(NULL);
+    while (fgets(buff, sizeof(buff), file) != NULL)
+    {
+        g_string_append(line, buff);
+        if (line->str[line->len - 1] != '\n' && !feof(file))
+            continue;
+
+        g_strstrip(line->str);
+        if (line->str[0] != '\0' && line->str[0] != '#')
+        {
+            resp = pred_server_query(line->str);
+            g_print("%s\n", resp);
+            g_free(resp);
+        }
+        g_string_truncate(line, 0);
+    }
+    g_string_free(line, TRUE);
+
+    if (file != stdin)
+        fclose(file);
+
+    pred_server_reload();
+
+    return 0;
+}
+
+/**
+ * Drop the satellite data, locations and cached passes.
+ *
+ * Queries in progress keep using their data; later queries read the
+ * satellite data again.
+ */
+void pred_server_reload(void)
+{
+    g_mutex_lock(&data_lock);
+    if (sats != NULL)
+    {
+        g_hash_table_remove_all(sats);
+        g_hash_table_remove_all(qths);
+        g_hash_table_remove_all(cache);
+    }
+    g_mutex_unlock(&data_lock);
+}
+
+static gboolean run_cb(GThreadedSocketService * srv, GSocketConnection * conn,
+                       GObject * source, gpointer data)
+{
+    GDataInputStream *in;
+    GOutputStream  *out;
+    GCancellable   *cancellable = data;
+    gchar          *line;
+    gchar          *resp;
+    gboolean        ok = TRUE;
+
+    (void)srv;
+    (void)source;
+
+    in = g_data_input_stream_new(g_io_stream_get_input_stream
+                                 (G_IO_STREAM(conn)));
+    g_data_input_stream_set_newline_type(in, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+    out = g_io_stream_get_output_stream(G_IO_STREAM(conn));
+
+    while (ok && (line = g_data_input_stream_read_line(in, NULL, cancellable,
+                                                       NULL)) != NULL)
+    {
+        g_strstrip(line);
+        if (line[0] != '\0')
+        {
+            resp = pred_server_query(line);
+            ok = g_output_stream_write_all(out, resp, strlen(resp), NULL,
+                                           cancellable, NULL) &&
+                g_output_stream_write_all(out, "\n", 1, NULL, cancellable,
+                                          NULL);
+            g_free(resp);
+        }
+        g_free(line);
+    }
+
+    g_object_unref(in);
+
+    return TRUE;
+}
+
+/**
+ * Start the prediction server.
+ *
+ * @return TRUE if the server is listening, FALSE if it is disabled or
+ *         could not be started.
+ */
+gboolean pred_server_start(void)
+{
+    GSocketAddress *addr = NULL;
+    GInetAddress   *inet;
+    GError         *err = NULL;
+    gchar          *path;
+    gint            port;
+
+    if (service != NULL)
+        return TRUE;
+
+    path = sat_cfg_get_str(SAT_CFG_STR_SERVER_SOCKET);
+    port = sat_cfg_get_int(SAT_CFG_INT_SERVER_PORT);
+
+#ifdef HAVE_GIO_UNIX
+    if (path != NULL && path[0] != '\0')
+    {
+        if (!remove_stale_socket(path))
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not start prediction server "
+                          "(%s exists and is not a socket)"), __func__,
+                        path);
+            g_free(path);
+            return FALSE;
+        }
+        addr = g_unix_socket_address_new(path);
+        sockpath = path;
+        path = NULL;
+    }
+#endif
+    g_free(path);
+
+    if (addr == NULL)
+    {
+        if (port <= 0)
+            return FALSE;
+
+        inet = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+        addr = g_inet_socket_address_new(inet, port);
+        g_object_unref(inet);
+    }
+
+    service = g_threaded_socket_service_new(MAX_CLIENTS);
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), addr,
+                                       G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL,
+                                       &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not start prediction server (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        g_object_unref(addr);
+        g_object_unref(service);
+        service = NULL;
+        g_free(sockpath);
+        sockpath = NULL;
+
+        return FALSE;
+    }
+    g_object_unref(addr);
+
+    cancel = g_cancellable_new();
+    g_signal_connect_data(service, "run", G_CALLBACK(run_cb),
+                          g_object_ref(cancel),
+                          (GClosureNotify) g_object_unref, 0);
+    g_socket_service_start(service);
+
+    if (sockpath != NULL)
+        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Listening on %s"),
+                    __func__, sockpath);
+    else
+        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Listening on port %d"),
+                    __func__, port);
+
+    return TRUE;
+}
+
+/** Stop the prediction server. */
+void pred_server_stop(void)
+{
+    if (service == NULL)
+        return;
+
+    /* unblock the connections waiting for requests */
+    g_cancellable_cancel(cancel);
+    g_object_unref(cancel);
+    cancel = NULL;
+
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    g_object_unref(service);
+    service = NULL;
+
+    if (sockpath != NULL)
+    {
+        g_unlink(sockpath);
+        g_free(sockpath);
+        sockpath = NULL;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PRED_SERVER_H
+#define PRED_SERVER_H 1
+
+#include <glib.h>
+
+/*
+ * Local prediction server.
+ *
+ * Answers prediction queries for any satellite in the local satellite data,
+ * whether or not it is used in a module. The server listens on a UNIX
+ * socket if SERVER/SOCKET is set and the platform supports it, otherwise on
+ * 127.0.0.1:SERVER/PORT. A port of 0 disables the server. The queries can
+ * also be run without the server using the --query command line option.
+ *
+ * A request is one line with the name of the query followed by key=value
+ * arguments; the response is one line of JSON with "ok" set to true or
+ * false and, on error, an "error" message. Times are Julian dates (UTC) as
+ * used throughout gpredict; t defaults to now and qth to the default QTH
+ * file.
+ *
+ *   get_passes catnum=N [num=N] [minel=DEG] [days=D] [t=JD] [qth=NAME]
+ *       Next passes with summary data.
+ *   get_pass catnum=N [minel=DEG] [days=D] [t=JD] [qth=NAME]
+ *       Next pass including the details.
+ *   predict_calc catnum=N [t=JD] [qth=NAME]
+ *       Satellite data at a given time.
+ *   batch catnums=N,N,...|all [t=JD] [qth=NAME]
+ *       Position of many satellites at a given time.
+ *   stats
+ *       Number of queries and latency per query type, pass cache usage.
+ *
+ * Passes are served from a cache holding all passes of a satellite found
+ * for a location so far, regardless of the minimum elevation, and only the
+ * part of the time window not searched yet is propagated. Batch queries are
+ * split over a thread pool. The cache and the satellite data are dropped
+ * by pred_server_reload(), e.g. after a TLE update.
+ */
+
+gboolean        pred_server_start(void);
+void            pred_server_stop(void);
+void            pred_server_reload(void);
+gchar          *pred_server_query(const gchar * request);
+gint            pred_server_query_file(const gchar * fname);
+
+#endif
@@ -35,17 +35,89 @@
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <string.h>
 
 #include "gtk-sat-data.h"
 #include "orbit-tools.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "sat-trace.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
 
+/* pass prediction settings, see pass_cfg_read() */
+typedef struct {
+    gdouble         min_el;     /* minimum elevation [deg] */
+    gdouble         tres;       /* time resolution of the details [days] */
+    gint            entries;    /* number of detail entries */
+    gdouble         twilight;   /* twilight threshold for visibility [deg] */
+} pass_cfg_t;
+
+/* how long a pass may last beyond the end of the search window [days] */
+#define PASS_MAX_OVERRUN 1.0
+
+/* shortest chunk searched by the workers of a pass_job_t [days] */
+#define PASS_JOB_MIN_CHUNK 1.0
+
+/* number of chunks per worker; more chunks give the results earlier but
+   the search of each chunk ends with a pass that is thrown away */
+#define PASS_JOB_CHUNKS_PER_WORKER 4
+
+/* passes with AOS in one chunk of the time window of a pass_job_t */
+typedef struct {
+    gdouble         start;
+    gdouble         end;
+    GSList         *passes;
+    gboolean        done;
+} pass_chunk_t;
+
+struct pass_job {
+    sat_t           sat;        /* private copy of the satellite */
+    qth_t           qth;        /* only the position is set */
+    pass_cfg_t      cfg;
+    gdouble         start;
+    guint           num;        /* max number of passes, 0 for no limit */
+    pass_chunk_t   *chunks;
+    guint           nchunks;
+    gint            next;       /* next chunk to search (atomic) */
+    gint            progress;   /* chunks searched (atomic) */
+    gint            cancel;     /* set by pass_job_cancel() (atomic) */
+    gint            stop;       /* cancelled or num reached (atomic) */
+    GMutex          lock;       /* protects the fields below */
+    guint           ready;      /* chunks handed out */
+    guint           found;      /* passes handed out */
+    GSList         *pending;    /* passes not taken yet, in reverse order */
+};
+
 static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
-                                gdouble maxdt, gdouble min_el);
+                                gdouble maxdt, const pass_cfg_t * cfg);
+static void     pass_cfg_read(pass_cfg_t * cfg, gboolean use_min_el);
+static gdouble  skip_low_passes(sat_t * sat, qth_t * qth, gdouble start,
+                                gdouble end, gdouble min_el);
+
+/* margins of the pass elevation bound used by skip_low_passes() */
+#define SKIP_ALT_MARGIN  0.02   /* relative; short periodic perturbations */
+#define SKIP_VEL_MARGIN  0.05   /* relative */
+#define SKIP_DIST_MARGIN 1.0    /* deg; ellipsoid and geodetic latitude */
+#define SKIP_MIN_STEP    (60.0 / 86400.0)       /* day */
+#define SKIP_MAX_ABOVE   1.0    /* day; longer above the horizon is left to
+                                   the regular search */
+
+/* satellite to satellite visibility search parameters [sec] */
+#define LINK_MIN_STEP 2.0       /* smallest step; shorter windows may be lost */
+#define LINK_MAX_STEP 60.0      /* largest step; limits the range sampling error */
+#define LINK_TOL      0.1       /* accuracy of window start and end */
+
+/* one target of get_links_multi() with private copies of the satellites */
+typedef struct {
+    sat_t           sat;
+    sat_t           other;
+    gdouble         start;
+    gdouble         maxdt;
+    gdouble         margin;
+    GSList         *links;
+} link_job_t;
 
 /**
  * \brief SGP4SDP4 driver for doing AOS/LOS calculations.
@@ -55,16 +127,22 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
  */
 void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
 {
-    obs_set_t       obs_set;
-    geodetic_t      sat_geodetic;
-    geodetic_t      obs_geodetic;
-    double          age;
-
-    obs_geodetic.lon = qth->lon * de2ra;
-    obs_geodetic.lat = qth->lat * de2ra;
-    obs_geodetic.alt = qth->alt / 1000.0;
-    obs_geodetic.theta = 0;
+    predict_calc_eci(sat, t);
+    predict_calc_obs(sat, qth);
+}
 
+/**
+ * \brief Propagate the satellite state vector.
+ * \param sat Pointer to the satellite data.
+ * \param t The time for calculation (Julian Date)
+ *
+ * This function runs SGP4 or SDP4 and leaves the ECI position and velocity
+ * in sat->pos and sat->vel scaled to km and km/sec. The orbit phase is left
+ * in sat->phase in radians. None of the observer dependent fields are
+ * updated; use predict_calc_obs() for that.
+ */
+void predict_calc_eci(sat_t * sat, gdouble t)
+{
     sat->jul_utc = t;
     sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
 
@@ -75,11 +153,41 @@ void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
         SGP4(sat, sat->tsince);
 
     Convert_Sat_State(&sat->pos, &sat->vel);
+}
+
+/**
+ * \brief Calculate observer dependent data from the satellite state vector.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ *
+ * sat->pos and sat->vel must contain the ECI state in km and km/sec at
+ * the time sat->jul_utc, and sat->phase must contain the orbit phase in
+ * radians, i.e. what predict_calc_eci() leaves behind. This allows the
+ * state vector to come from somewhere else than the propagator, e.g.
+ * from an interpolated ephemeris.
+ */
+void predict_calc_obs(sat_t * sat, qth_t * qth)
+{
+    obs_set_t       obs_set;
+    geodetic_t      sat_geodetic;
+    geodetic_t      obs_geodetic;
+    vector_t        obs_vel;
+    double          age;
+
+    /* a QTH following a trajectory is where it is at sat->jul_utc */
+    qth_data_get_obs(qth, sat->jul_utc, &obs_geodetic, &obs_vel);
 
     /* get the velocity of the satellite */
     Magnitude(&sat->vel);
     sat->velo = sat->vel.w;
     Calculate_Obs(sat->jul_utc, &sat->pos, &sat->vel, &obs_geodetic, &obs_set);
+
+    /* Calculate_Obs only knows the rotation of the Earth; subtract the
+       velocity of a moving QTH towards the satellite */
+    if (obs_vel.w > 0.0)
+        obs_set.range_rate -= cos(obs_set.el) *
+            (sin(obs_set.az) * obs_vel.x + cos(obs_set.az) * obs_vel.y) +
+            sin(obs_set.el) * obs_vel.z;
     Calculate_LatLonAlt(sat->jul_utc, &sat->pos, &sat_geodetic);
 
     while (sat_geodetic.lon < -pi)
@@ -311,6 +419,55 @@ gdouble find_los(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
     return lostime;
 }
 
+/* max number of Newton steps when refining an AOS or LOS */
+#define REFINE_MAX_ITER  8
+/* max distance of the refined AOS or LOS from the old one [days] */
+#define REFINE_MAX_SHIFT 0.01
+/* time step used for the elevation rate [days] */
+#define REFINE_DT        (1.0 / 86400.0)
+
+/**
+ * \brief Refine the time of an AOS or LOS after a small QTH movement.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param seed The time of the event before the QTH moved.
+ * \param rising TRUE for AOS, FALSE for LOS.
+ * \return The time of the event or 0.0 if it was not found near seed.
+ *
+ * This function uses a few Newton steps on the elevation starting at seed,
+ * which is much cheaper than find_aos or find_los. It fails if the pass has
+ * vanished or the event has moved more than REFINE_MAX_SHIFT, in which case
+ * a full search is needed. The satellite data is left near the event time.
+ */
+gdouble refine_event(sat_t * sat, qth_t * qth, gdouble seed, gboolean rising)
+{
+    gdouble         t = seed;
+    gdouble         el, rate;
+    guint           i;
+
+    for (i = 0; i < REFINE_MAX_ITER; i++)
+    {
+        predict_calc(sat, qth, t + REFINE_DT);
+        rate = sat->el;
+        predict_calc(sat, qth, t);
+        el = sat->el;
+        rate = (rate - el) / REFINE_DT;
+
+        /* the satellite must be rising at AOS and setting at LOS */
+        if (rising ? (rate <= 0.0) : (rate >= 0.0))
+            return 0.0;
+
+        if (fabs(el) < 0.005)
+            return t;
+
+        t -= el / rate;
+        if (fabs(t - seed) > REFINE_MAX_SHIFT)
+            return 0.0;
+    }
+
+    return 0.0;
+}
+
 /**
  * \brief Find AOS time of current pass.
  * \param sat The satellite to find AOS for.
@@ -396,6 +553,26 @@ GSList         *get_next_passes(sat_t * sat, qth_t * qth, gdouble maxdt,
     return get_passes(sat, qth, now, maxdt, num);
 }
 
+/**
+ * \brief Read the pass prediction settings.
+ * \param cfg The settings to fill in.
+ * \param use_min_el Whether to use the configured minimum elevation.
+ *
+ * The settings are read once, before the search, because sat-cfg may not
+ * be used from the worker threads of a pass_job_t.
+ */
+static void pass_cfg_read(pass_cfg_t * cfg, gboolean use_min_el)
+{
+    cfg->min_el = 0.0;
+    if (use_min_el)
+        cfg->min_el = MAX(1, sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL));
+
+    /* sat-cfg stores the time resolution in seconds */
+    cfg->tres = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION) / 86400.0;
+    cfg->entries = sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+    cfg->twilight = sat_cfg_get_int(SAT_CFG_INT_PRED_TWILIGHT_THLD);
+}
+
 /**
  * \brief Predict first pass after a certain time.
  * \param sat Pointer to the satellite data.
@@ -410,12 +587,11 @@ GSList         *get_next_passes(sat_t * sat, qth_t * qth, gdouble maxdt,
  */
 pass_t *get_pass(sat_t * sat_in, qth_t * qth, gdouble start, gdouble maxdt)
 {
-    int      min_ele = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    pass_cfg_t      cfg;
 
-    if (min_ele == 0)
-        min_ele = 1;
+    pass_cfg_read(&cfg, TRUE);
 
-    return get_pass_engine(sat_in, qth, start, maxdt, min_ele);
+    return get_pass_engine(sat_in, qth, start, maxdt, &cfg);
 }
 
 /**
@@ -432,7 +608,11 @@ pass_t *get_pass(sat_t * sat_in, qth_t * qth, gdouble start, gdouble maxdt)
 pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
                                    gdouble maxdt)
 {
-    return get_pass_engine(sat_in, qth, start, maxdt, 0.0);
+    pass_cfg_t      cfg;
+
+    pass_cfg_read(&cfg, FALSE);
+
+    return get_pass_engine(sat_in, qth, start, maxdt, &cfg);
 }
 
 /**
@@ -453,12 +633,10 @@ pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
  *       by the caller, if the caller will need it later on (eg. if the caller
  *       is GtkSatList).
  *
- * \note Prepending to a singly linked list is much faster than appending.
- *       Therefore, the elements are prepended whereafter the GSList is
- *       reversed
+ * \note The details are stored in one array sized for the whole pass.
  */
 static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
-                                gdouble maxdt, gdouble min_el)
+                                gdouble maxdt, const pass_cfg_t * cfg)
 {
     gdouble         aos = 0.0;  /* time of AOS */
     gdouble         tca = 0.0;  /* time of TCA */
@@ -467,38 +645,48 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
     gdouble         step = 0.0; /* time step */
     gdouble         t0 = start;
     gdouble         t;          /* current time counter */
-    gdouble         tres = 0.0; /* required time resolution */
     gdouble         max_el = 0.0;       /* maximum elevation */
     pass_t         *pass = NULL;
     pass_detail_t  *detail = NULL;
     gboolean        done = FALSE;
     guint           iter = 0;   /* number of iterations */
     sat_t          *sat, sat_working;
+    gint64          trace = sat_trace_begin();
 
     /* FIXME: watchdog */
 
     /*copy sat_in to a working structure */
     sat = memcpy(&sat_working, sat_in, sizeof(sat_t));
 
-    /* get time resolution; sat-cfg stores it in seconds */
-    tres = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION) / 86400.0;
-
     /* loop until we find a pass with elevation > SAT_CFG_INT_PRED_MIN_EL
        or we run out of time
        FIXME: we should have a safety break
      */
     while (!done)
     {
+        /* skip the orbits where no pass can reach min_el */
+        t0 = skip_low_passes(sat, qth, t0,
+                             (maxdt > 0.0) ? start + maxdt : 0.0,
+                             cfg->min_el);
+        if (t0 == 0.0)
+        {
+            done = TRUE;
+            continue;
+        }
+
         /* Find los of next pass or of current pass */
-        los = find_los(sat, qth, t0, maxdt);    // See if a pass is ongoing
+        /* See if a pass is ongoing; a pass with AOS near the end of the
+           window may end after it */
+        los = find_los(sat, qth, t0,
+                       (maxdt > 0.0) ? maxdt + PASS_MAX_OVERRUN : 0.0);
         aos = find_aos(sat, qth, t0, start + maxdt - t0);
 
         if (aos > los)
             // los is from an currently happening pass, find previous aos
             aos = find_prev_aos(sat, qth, t0);
 
-        /* aos = 0.0 means no aos */
-        if (aos == 0.0)
+        /* aos = 0.0 means no aos, los = 0.0 no complete pass */
+        if (aos == 0.0 || los == 0.0)
             done = TRUE;
 
         /* check whether we are within time limits;
@@ -514,13 +702,13 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
             dt = los - aos;
 
             /* get time step, which will give us the max number of entries */
-            step = dt / sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+            step = dt / cfg->entries;
 
             /* but if this is smaller than the required resolution
                we go with the resolution
              */
-            if (step < tres)
-                step = tres;
+            if (step < cfg->tres)
+                step = cfg->tres;
 
             /* create a pass_t entry; FIXME: g_try_new in 2.8 */
             pass = g_new(pass_t, 1);
@@ -536,7 +724,9 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
             pass->vis[2] = '-';
             pass->vis[3] = 0;
             pass->satname = g_strdup(sat->nickname);
-            pass->details = NULL;
+            pass->details = g_array_sized_new(FALSE, FALSE,
+                                              sizeof(pass_detail_t),
+                                              (guint) (dt / step) + 2);
             /*copy qth data into the pass for later comparisons */
             qth_small_save(qth, &(pass->qth_comp));
 
@@ -556,8 +746,9 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
                     pass->orbit = sat->orbit;
                 }
 
-                /* append details to sat->details */
-                detail = g_new(pass_detail_t, 1);
+                /* append details to pass->details */
+                g_array_set_size(pass->details, pass->details->len + 1);
+                detail = PASS_NTH_DETAIL(pass, pass->details->len - 1);
                 detail->time = t;
                 detail->pos.x = sat->pos.x;
                 detail->pos.y = sat->pos.y;
@@ -579,7 +770,7 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
                 detail->phase = sat->phase;
                 detail->footprint = sat->footprint;
                 detail->orbit = sat->orbit;
-                detail->vis = get_sat_vis(sat, qth, t);
+                detail->vis = get_sat_vis_thld(sat, qth, t, cfg->twilight);
 
                 /* also store visibility "bit" */
                 switch (detail->vis)
@@ -597,7 +788,6 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
                     break;
                 }
 
-                pass->details = g_slist_prepend(pass->details, detail);
 
                 /* store elevation if greater than the
                    previously stored one
@@ -613,8 +803,6 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
                 /*           t, sat->az, sat->el, max_el); */
             }
 
-            pass->details = g_slist_reverse(pass->details);
-
             /* calculate satellite data */
             predict_calc(sat, qth, pass->los);
             /* store los_az, max_el and tca */
@@ -623,7 +811,7 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
             pass->tca = tca;
 
             /* check whether this pass is good */
-            if (max_el >= min_el)
+            if (max_el >= cfg->min_el)
             {
                 done = TRUE;
             }
@@ -639,9 +827,106 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
         }
     }
 
+    sat_trace_end("predict", "get_pass", trace);
+
     return pass;
 }
 
+/**
+ * \brief Skip the time where no pass can reach a minimum elevation.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the location data.
+ * \param start The time where the search should start.
+ * \param end The upper time limit for AOS (0.0 for no limit).
+ * \param min_el The minimum elevation in degrees.
+ * \return A time no earlier than start and before the first pass that may
+ *         reach min_el, or 0.0 if there is no such pass before end.
+ *
+ * The elevation of a satellite decreases with the great circle distance
+ * between the sub-satellite point and the observer, so a pass can only
+ * reach min_el where this distance is below a limit given by min_el and the
+ * apogee altitude. The distance changes no faster than the angular velocity
+ * of the satellite at perigee plus the rotation of the Earth, which gives a
+ * time step that can not step over such a part of the ground track. Orbits
+ * that stay further away are thus passed in a few steps instead of finding
+ * AOS and LOS and calculating the details of passes that would be discarded
+ * anyway.
+ *
+ * The returned time is the last one where the satellite was known to be
+ * below the horizon, so that the pass is found from its AOS as without the
+ * skipping.
+ */
+static gdouble skip_low_passes(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble end, gdouble min_el)
+{
+    gdouble         sma, rmin, rmax;    /* orbit size [km] */
+    gdouble         rate;               /* max ground track speed [rad/day] */
+    gdouble         limit;              /* max distance for min_el [rad] */
+    gdouble         horizon;            /* max distance for AOS [rad] */
+    gdouble         rpol;               /* polar radius [km] */
+    gdouble         el, lin, lat, dist, step;
+    gdouble         t = start;
+    gdouble         below = start;
+    geodetic_t      obs;
+
+    if (min_el <= 0.0 || !has_aos(sat, qth))
+        return start;
+
+    sma = 331.25 * exp(log(1440.0 / sat->meanmo) * (2.0 / 3.0));
+    rmin = sma * (1.0 - sat->tle.eo);
+    rmax = sma * (1.0 + sat->tle.eo) * (1.0 + SKIP_ALT_MARGIN);
+
+    /* the polar radius gives the highest elevation at a given distance */
+    rpol = xkmper * (1.0 - __f);
+    el = min_el * de2ra;
+    limit = acos(rpol * cos(el) / rmax) - el + SKIP_DIST_MARGIN * de2ra;
+    horizon = acos(rpol / rmax) + SKIP_DIST_MARGIN * de2ra;
+
+    /* no pass at all if the ground track never gets close enough */
+    lin = sat->tle.xincl;
+    if (lin >= pio2)
+        lin = pi - lin;
+    lat = (qth->traj != NULL) ? qth_traj_max_lat(qth->traj) :
+        fabs(qth->lat * de2ra);
+    if (lat - lin > limit)
+        return 0.0;
+
+    /* a moving QTH approaches the ground track at most at its own speed */
+    rate = (1.0 + SKIP_VEL_MARGIN) * 86400.0 *
+        sqrt(ge * (1.0 + sat->tle.eo) / rmin) / rmin + twopi * omega_E;
+    if (qth->traj != NULL)
+        rate += qth_traj_max_rate(qth->traj);
+
+    for (;;)
+    {
+        predict_calc(sat, qth, t);
+        qth_data_get_obs(qth, t, &obs, NULL);
+
+        dist = acos(sin(sat->ssplat * de2ra) * sin(obs.lat) +
+                    cos(sat->ssplat * de2ra) * cos(obs.lat) *
+                    cos(sat->ssplon * de2ra - obs.lon));
+
+        /* at the end of the window passes with AOS before end are over
+           unless one is in progress; checked on every step since the
+           satellite may stay above the horizon without reaching min_el,
+           e.g. in an inclined geosynchronous orbit */
+        if (end > 0.0 && t > end)
+            return (dist > horizon) ? 0.0 : below;
+
+        if (dist > horizon)
+            below = t;
+        else if (t - below > SKIP_MAX_ABOVE)
+            return below;
+
+        /* the steps get shorter when the track approaches the limit */
+        step = (dist - limit) / rate;
+        if (step < SKIP_MIN_STEP)
+            return below;
+
+        t += step;
+    }
+}
+
 /**
  * Predict passes after a certain time.
  *
@@ -711,6 +996,273 @@ GSList         *get_passes(sat_t * sat, qth_t * qth, gdouble start,
     return passes;
 }
 
+/* Search the passes with AOS in one chunk of the time window */
+static void pass_job_search(pass_job_t * job, guint index)
+{
+    pass_chunk_t   *chunk = &job->chunks[index];
+    pass_t         *pass;
+    GSList         *passes = NULL;
+    GSList         *node;
+    gdouble         t = chunk->start;
+
+    while (t < chunk->end && !g_atomic_int_get(&job->stop))
+    {
+        /* the engine works on a copy, so the workers can share job->sat;
+           the AOS search needs some time beyond the chunk to converge */
+        pass = get_pass_engine(&job->sat, &job->qth, t,
+                               chunk->end - t + PASS_MAX_OVERRUN, &job->cfg);
+        if (pass == NULL)
+            break;
+
+        if (pass->aos >= chunk->end)
+        {
+            free_pass(pass);
+            break;
+        }
+
+        t = pass->los + 0.014;  // +20 min
+
+        /* a pass in progress at the start of the chunk belongs to the
+           previous chunk, which finds it from its AOS */
+        if (index > 0 && pass->aos < chunk->start)
+            free_pass(pass);
+        else
+            passes = g_slist_prepend(passes, pass);
+    }
+
+    g_mutex_lock(&job->lock);
+
+    /* a cancelled search may have missed passes at the end of the chunk */
+    if (g_atomic_int_get(&job->stop))
+    {
+        free_passes(passes);
+        g_mutex_unlock(&job->lock);
+        return;
+    }
+
+    chunk->passes = g_slist_reverse(passes);
+    chunk->done = TRUE;
+
+    /* hand out the passes of the chunks that are complete up to here, so
+       that the caller gets them in time order */
+    while (job->ready < job->nchunks && job->chunks[job->ready].done)
+    {
+        for (node = job->chunks[job->ready].passes; node; node = node->next)
+        {
+            if (job->num == 0 || job->found < job->num)
+            {
+                job->pending = g_slist_prepend(job->pending, node->data);
+                job->found++;
+            }
+            else
+            {
+                free_pass(node->data);
+            }
+        }
+        g_slist_free(job->chunks[job->ready].passes);
+        job->chunks[job->ready].passes = NULL;
+        job->ready++;
+    }
+
+    /* no need to search further chunks once we have enough passes */
+    if (job->num > 0 && job->found >= job->num)
+        g_atomic_int_set(&job->stop, 1);
+
+    g_mutex_unlock(&job->lock);
+
+    g_atomic_int_inc(&job->progress);
+}
+
+static gpointer pass_job_worker(gpointer data)
+{
+    pass_job_t     *job = data;
+    gint            index;
+
+    while (!g_atomic_int_get(&job->stop))
+    {
+        index = g_atomic_int_add(&job->next, 1);
+        if (index >= (gint) job->nchunks)
+            break;
+
+        pass_job_search(job, index);
+    }
+
+    return NULL;
+}
+
+/**
+ * Create a new long-horizon pass prediction job.
+ *
+ * @param sat The satellite.
+ * @param qth The observer location.
+ * @param start The start of the time window.
+ * @param maxdt The length of the time window in days (must be > 0).
+ * @param num The maximum number of passes (0 for no limit).
+ * @return A new job, which should be freed with pass_job_free().
+ *
+ * The satellite, the location and the prediction settings are copied, so
+ * the caller does not need to keep them while the job is running.
+ */
+pass_job_t     *pass_job_new(sat_t * sat, qth_t * qth, gdouble start,
+                             gdouble maxdt, guint num)
+{
+    pass_job_t     *job;
+    guint           i;
+
+    job = g_new0(pass_job_t, 1);
+
+    Sat_Copy(&job->sat, sat);
+    job->sat.name = g_strdup(sat->name);
+    job->sat.nickname = g_strdup(sat->nickname);
+    job->sat.website = NULL;
+
+    /* only the position is used */
+    job->qth.lat = qth->lat;
+    job->qth.lon = qth->lon;
+    job->qth.alt = qth->alt;
+    job->qth.traj = qth_traj_ref(qth->traj);
+
+    pass_cfg_read(&job->cfg, TRUE);
+
+    job->start = start;
+    job->num = num;
+    job->nchunks = CLAMP((guint) ceil(maxdt / PASS_JOB_MIN_CHUNK), 1,
+                         PASS_JOB_CHUNKS_PER_WORKER * g_get_num_processors());
+    job->chunks = g_new0(pass_chunk_t, job->nchunks);
+    for (i = 0; i < job->nchunks; i++)
+    {
+        job->chunks[i].start = start + maxdt * i / job->nchunks;
+        job->chunks[i].end = start + maxdt * (i + 1) / job->nchunks;
+    }
+
+    g_mutex_init(&job->lock);
+
+    return job;
+}
+
+/**
+ * Free a pass prediction job.
+ *
+ * @param job The job, which must not be running.
+ *
+ * Passes that have not been taken with pass_job_take() are freed.
+ */
+void pass_job_free(pass_job_t * job)
+{
+    guint           i;
+
+    if (job == NULL)
+        return;
+
+    for (i = 0; i < job->nchunks; i++)
+        free_passes(job->chunks[i].passes);
+    g_free(job->chunks);
+    free_passes(job->pending);
+    qth_traj_unref(job->qth.traj);
+
+    g_free(job->sat.name);
+    g_free(job->sat.nickname);
+    Sat_Release(&job->sat);
+
+    g_mutex_clear(&job->lock);
+    g_free(job);
+}
+
+/**
+ * Run a pass prediction job.
+ *
+ * @param job The job.
+ * @return TRUE if the job completed, FALSE if it was cancelled.
+ *
+ * The time window is split into chunks that are searched by one worker
+ * thread per CPU core. Each chunk holds the passes with AOS in the chunk;
+ * a pass that straddles the end of a chunk is found by that chunk, and the
+ * next chunk drops it. The passes become available to pass_job_take() in
+ * time order as soon as all earlier chunks are done.
+ *
+ * Unlike get_passes(), which may return a pass with AOS after the end of
+ * the time window, all passes have AOS within the time window, except for
+ * a pass in progress at the start.
+ *
+ * This function blocks until the job is done or cancelled and may be
+ * called from a worker thread.
+ */
+gboolean pass_job_run(pass_job_t * job)
+{
+    GThread       **threads;
+    guint           nthreads, i;
+    gint64          start;
+    gboolean        done;
+
+    start = g_get_monotonic_time();
+
+    nthreads = CLAMP(g_get_num_processors(), 1, job->nchunks);
+    threads = g_new0(GThread *, nthreads);
+
+    for (i = 0; i < nthreads; i++)
+        threads[i] = g_thread_new("gpredict_pass", pass_job_worker, job);
+
+    for (i = 0; i < nthreads; i++)
+        g_thread_join(threads[i]);
+
+    g_free(threads);
+
+    done = !g_atomic_int_get(&job->cancel);
+    if (done)
+        g_atomic_int_set(&job->progress, job->nchunks);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Found %d passes for %s in %.1f days "
+                  "in %.1f s using %d threads"),
+                __func__, job->found, job->sat.nickname,
+                job->chunks[job->nchunks - 1].end - job->start,
+                (g_get_monotonic_time() - start) / 1.0e6, nthreads);
+
+    return done;
+}
+
+/**
+ * Take the passes found so far.
+ *
+ * @param job The job.
+ * @return The passes found since the previous call in time order, or NULL.
+ *         The caller owns the list and the passes.
+ *
+ * This function may be called while the job is running.
+ */
+GSList         *pass_job_take(pass_job_t * job)
+{
+    GSList         *passes;
+
+    g_mutex_lock(&job->lock);
+    passes = job->pending;
+    job->pending = NULL;
+    g_mutex_unlock(&job->lock);
+
+    return g_slist_reverse(passes);
+}
+
+/** Stop a running job. The passes found so far can still be taken. */
+void pass_job_cancel(pass_job_t * job)
+{
+    g_atomic_int_set(&job->cancel, 1);
+    g_atomic_int_set(&job->stop, 1);
+}
+
+/** Get the progress of a running job (0.0 - 1.0). */
+gdouble pass_job_get_progress(pass_job_t * job)
+{
+    return (gdouble) g_atomic_int_get(&job->progress) / job->nchunks;
+}
+
+/**
+ * \brief Copy a pass.
+ * \param pass The pass to copy.
+ * \return A new pass_t structure, which should be freed with free_pass().
+ *
+ * The pass details are not copied; the new pass shares the details of the
+ * original, see copy_pass_details().
+ */
 pass_t         *copy_pass(pass_t * pass)
 {
     pass_t         *new;
@@ -719,18 +1271,7 @@ pass_t         *copy_pass(pass_t * pass)
 
     if (new != NULL)
     {
-        new->aos = pass->aos;
-        new->los = pass->los;
-        new->tca = pass->tca;
-        new->max_el = pass->max_el;
-        new->aos_az = pass->aos_az;
-        new->los_az = pass->los_az;
-        new->orbit = pass->orbit;
-        new->maxel_az = pass->maxel_az;
-        new->vis[0] = pass->vis[0];
-        new->vis[1] = pass->vis[1];
-        new->vis[2] = pass->vis[2];
-        new->vis[3] = pass->vis[3];
+        memcpy(new, pass, sizeof(pass_t));
         new->details = copy_pass_details(pass->details);
 
         if (pass->satname != NULL)
@@ -742,23 +1283,21 @@ pass_t         *copy_pass(pass_t * pass)
     return new;
 }
 
-GSList         *copy_pass_details(GSList * details)
+/**
+ * \brief Get a shared reference to pass details.
+ * \param details The details of a pass, may be NULL.
+ * \return The same array with its reference count increased.
+ *
+ * The details of a pass are never modified once the pass has been
+ * predicted, so copies of a pass can share one array. Release the
+ * reference with free_pass_details().
+ */
+GArray         *copy_pass_details(GArray * details)
 {
-    GSList         *new = NULL;
-    guint           i, n;
-
-    n = g_slist_length(details);
-    for (i = 0; i < n; i++)
-    {
-        new = g_slist_prepend(new,
-                              copy_pass_detail(PASS_DETAIL
-                                               (g_slist_nth_data
-                                                (details, i))));
-    }
-
-    new = g_slist_reverse(new);
+    if (details == NULL)
+        return NULL;
 
-    return new;
+    return g_array_ref(details);
 }
 
 pass_detail_t  *copy_pass_detail(pass_detail_t * detail)
@@ -814,56 +1353,25 @@ void free_pass(pass_t * pass)
 /** \brief Free a list of passes. */
 void free_passes(GSList * passes)
 {
-    guint           n, i;
-    gpointer        pass;
-
-    n = g_slist_length(passes);
-
-    for (i = 0; i < n; i++)
-    {
-        pass = g_slist_nth_data(passes, i);
-
-        /* free element data */
-        free_pass(PASS(pass));
-    }
-
-    /* now free the list elements */
-    g_slist_free(passes);
-    passes = NULL;
+    g_slist_free_full(passes, (GDestroyNotify) free_pass);
 }
 
 /**
  * \brief Free a pass detail structure.
  *
- * This function is not rarely useful except for the
- * free_pass function.
+ * This is only needed for details obtained with copy_pass_detail(); the
+ * details of a pass are released by free_pass().
  */
 void free_pass_detail(pass_detail_t * detail)
 {
     g_free(detail);
-    detail = NULL;
 }
 
-/** Free the whole list of details. */
-void free_pass_details(GSList * details)
+/** \brief Release a reference to pass details. */
+void free_pass_details(GArray * details)
 {
-    guint           n, i;
-    gpointer        detail;
-
-    n = g_slist_length(details);
-
-    for (i = 0; i < n; i++)
-    {
-
-        detail = g_slist_nth_data(details, i);
-
-        /* free element data */
-        free_pass_detail(PASS_DETAIL(detail));
-    }
-
-    /* free list elements */
-    g_slist_free(details);
-    details = NULL;
+    if (details != NULL)
+        g_array_unref(details);
 }
 
 /**
@@ -937,3 +1445,292 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
 
     return pass;
 }
+
+/**
+ * \brief Clearance of the line of sight between two satellites.
+ * \param sat1 Pointer to the first satellite.
+ * \param sat2 Pointer to the second satellite.
+ * \param margin Height of the atmosphere margin above the Earth [km].
+ * \return The smallest distance between the chord joining the satellites
+ *         and a sphere of radius xkmper + margin [km]. The satellites
+ *         can see each other when the clearance is positive.
+ *
+ * The ECI positions in sat->pos are used as they are, i.e. this function
+ * must be called after predict_calc_eci() for the same time. The Earth is
+ * taken as a sphere with the equatorial radius, which is conservative
+ * by up to 21 km over the poles.
+ */
+gdouble link_clearance(sat_t * sat1, sat_t * sat2, gdouble margin)
+{
+    vector_t        d, p;
+    gdouble         dd;
+    gdouble         s = 0.0;
+
+    d.x = sat2->pos.x - sat1->pos.x;
+    d.y = sat2->pos.y - sat1->pos.y;
+    d.z = sat2->pos.z - sat1->pos.z;
+    dd = d.x * d.x + d.y * d.y + d.z * d.z;
+
+    /* point of the chord closest to the centre of the Earth */
+    if (dd > 0.0)
+        s = -(sat1->pos.x * d.x + sat1->pos.y * d.y + sat1->pos.z * d.z) / dd;
+    s = CLAMP(s, 0.0, 1.0);
+
+    p.x = sat1->pos.x + s * d.x;
+    p.y = sat1->pos.y + s * d.y;
+    p.z = sat1->pos.z + s * d.z;
+
+    return sqrt(p.x * p.x + p.y * p.y + p.z * p.z) - xkmper - margin;
+}
+
+/* propagate both satellites to t and return the clearance */
+static gdouble link_calc(sat_t * sat1, sat_t * sat2, gdouble t,
+                         gdouble margin)
+{
+    predict_calc_eci(sat1, t);
+    predict_calc_eci(sat2, t);
+
+    return link_clearance(sat1, sat2, margin);
+}
+
+static gdouble link_range(sat_t * sat1, sat_t * sat2)
+{
+    gdouble         dx = sat2->pos.x - sat1->pos.x;
+    gdouble         dy = sat2->pos.y - sat1->pos.y;
+    gdouble         dz = sat2->pos.z - sat1->pos.z;
+
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static gdouble link_speed(sat_t * sat)
+{
+    return sqrt(sat->vel.x * sat->vel.x + sat->vel.y * sat->vel.y +
+                sat->vel.z * sat->vel.z);
+}
+
+/* bisect the visibility change between t0 (state vis0) and t1 */
+static gdouble link_crossing(sat_t * sat1, sat_t * sat2, gdouble t0,
+                             gdouble t1, gboolean vis0, gdouble margin)
+{
+    gdouble         t;
+
+    while ((t1 - t0) * secday > LINK_TOL)
+    {
+        t = 0.5 * (t0 + t1);
+        if ((link_calc(sat1, sat2, t, margin) > 0.0) == vis0)
+            t0 = t;
+        else
+            t1 = t;
+    }
+
+    return 0.5 * (t0 + t1);
+}
+
+static void link_add_range(link_t * link, gdouble range)
+{
+    if (range < link->min_range)
+        link->min_range = range;
+    if (range > link->max_range)
+        link->max_range = range;
+}
+
+/**
+ * \brief Find the mutual visibility windows of two satellites.
+ * \param sat1 Pointer to the first satellite.
+ * \param sat2 Pointer to the second satellite.
+ * \param start Start time of the search.
+ * \param maxdt Length of the search in days.
+ * \param margin Height of the atmosphere margin above the Earth [km].
+ * \return A list of link_t sorted by start time. The satellite name and
+ *         number in each entry are those of sat2.
+ *
+ * The clearance from link_clearance() can not change faster than the
+ * fastest of the two satellites moves, so stepping by clearance / speed
+ * never jumps over a window. The steps are kept between LINK_MIN_STEP and
+ * LINK_MAX_STEP and each change of visibility is bisected to LINK_TOL.
+ * Windows that are open at the start or the end of the search are cut
+ * there. The minimum and maximum range are sampled at the steps.
+ *
+ * Like find_aos() this function leaves the satellites propagated to
+ * some time within the search interval; pass copies if that matters.
+ */
+GSList         *get_links(sat_t * sat1, sat_t * sat2, gdouble start,
+                          gdouble maxdt, gdouble margin)
+{
+    GSList         *links = NULL;
+    link_t         *link = NULL;
+    gdouble         t, tprev;
+    gdouble         f, dt, range, speed;
+    gboolean        vis;
+
+    t = tprev = start;
+    f = link_calc(sat1, sat2, t, margin);
+
+    if (decayed(sat1) || decayed(sat2))
+        return NULL;
+
+    while (!isnan(f))
+    {
+        vis = (f > 0.0);
+        range = link_range(sat1, sat2);
+        speed = MAX(link_speed(sat1), link_speed(sat2));
+
+        if (vis && link == NULL)
+        {
+            link = g_new0(link_t, 1);
+            link->satname = g_strdup(sat2->nickname);
+            link->catnum = sat2->tle.catnr;
+            link->min_range = link->max_range = range;
+            if (t > start)
+            {
+                link->start = link_crossing(sat1, sat2, tprev, t, FALSE,
+                                            margin);
+                link_add_range(link, link_range(sat1, sat2));
+            }
+            else
+            {
+                link->start = start;
+            }
+        }
+        else if (!vis && link != NULL)
+        {
+            link->end = link_crossing(sat1, sat2, tprev, t, TRUE, margin);
+            link_add_range(link, link_range(sat1, sat2));
+            links = g_slist_prepend(links, link);
+            link = NULL;
+        }
+        else if (link != NULL)
+        {
+            link_add_range(link, range);
+        }
+
+        if (t >= start + maxdt)
+            break;
+
+        dt = (speed > 0.0) ? fabs(f) / speed : LINK_MAX_STEP;
+        dt = CLAMP(dt, LINK_MIN_STEP, LINK_MAX_STEP) / secday;
+
+        tprev = t;
+        t = MIN(t + dt, start + maxdt);
+        f = link_calc(sat1, sat2, t, margin);
+    }
+
+    /* window still open at the end, or propagation failed */
+    if (link != NULL)
+    {
+        link->end = isnan(f) ? tprev : t;
+        links = g_slist_prepend(links, link);
+    }
+
+    return g_slist_reverse(links);
+}
+
+static void link_job_run(gpointer data, gpointer user_data)
+{
+    link_job_t     *job = data;
+
+    (void)user_data;
+
+    job->links = get_links(&job->sat, &job->other, job->start, job->maxdt,
+                           job->margin);
+}
+
+static gint link_compare(gconstpointer a, gconstpointer b)
+{
+    if (LINK(a)->start < LINK(b)->start)
+        return -1;
+
+    return (LINK(a)->start > LINK(b)->start) ? 1 : 0;
+}
+
+/**
+ * \brief Find the visibility windows between a satellite and a set of others.
+ * \param sat Pointer to the satellite.
+ * \param sats The other satellites (catnum -> sat_t), e.g. those of a module.
+ *             sat itself may be included and is skipped.
+ * \param start Start time of the search.
+ * \param maxdt Length of the search in days.
+ * \param margin Height of the atmosphere margin above the Earth [km].
+ * \return A list of link_t for all pairs, sorted by start time.
+ *
+ * Each pair is searched with get_links() on its own copy of the two
+ * satellites in a pool with one thread per processor. The satellites
+ * passed in are only read, before this function blocks on the pool, so it
+ * must be called from the thread that owns them.
+ */
+GSList         *get_links_multi(sat_t * sat, GHashTable * sats,
+                                gdouble start, gdouble maxdt,
+                                gdouble margin)
+{
+    GThreadPool    *pool;
+    GPtrArray      *jobs;
+    GHashTableIter  iter;
+    gpointer        value;
+    link_job_t     *job;
+    GSList         *links = NULL;
+    GError         *error = NULL;
+    guint           i;
+
+    jobs = g_ptr_array_new();
+    pool = g_thread_pool_new(link_job_run, NULL, g_get_num_processors(),
+                             FALSE, &error);
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not create thread pool (%s)"),
+                    __func__, error->message);
+        g_clear_error(&error);
+        pool = NULL;
+    }
+
+    g_hash_table_iter_init(&iter, sats);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        if (SAT(value)->tle.catnr == sat->tle.catnr)
+            continue;
+
+        job = g_new(link_job_t, 1);
+        memcpy(&job->sat, sat, sizeof(sat_t));
+        memcpy(&job->other, value, sizeof(sat_t));
+        job->start = start;
+        job->maxdt = maxdt;
+        job->margin = margin;
+        job->links = NULL;
+        g_ptr_array_add(jobs, job);
+
+        if (pool != NULL)
+            g_thread_pool_push(pool, job, NULL);
+        else
+            link_job_run(job, NULL);
+    }
+
+    /* wait for all pairs to finish */
+    if (pool != NULL)
+        g_thread_pool_free(pool, FALSE, TRUE);
+
+    for (i = 0; i < jobs->len; i++)
+    {
+        job = g_ptr_array_index(jobs, i);
+        links = g_slist_concat(links, job->links);
+        g_free(job);
+    }
+    g_ptr_array_free(jobs, TRUE);
+
+    return g_slist_sort(links, link_compare);
+}
+
+/** \brief Free a link window. */
+void free_link(link_t * link)
+{
+    if (link == NULL)
+        return;
+
+    g_free(link->satname);
+    g_free(link);
+}
+
+/** \brief Free a list of link windows. */
+void free_links(GSList * links)
+{
+    g_slist_free_full(links, (GDestroyNotify) free_link);
+}
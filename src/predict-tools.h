@@ -46,7 +46,9 @@ typedef struct {
     gint        orbit;    /*!< Orbit number */
     gdouble     maxel_az; /*!< Azimuth at maximum elevation */
     gchar       vis[4];   /*!< Visibility string, e.g. VSE, -S-, V-- */
-    GSList     *details;  /*!< List of pass_detail_t entries */
+    GArray     *details;  /*!< Array of pass_detail_t entries, shared
+                               between copies and read-only (see
+                               PASS_NTH_DETAIL) */
     qth_small_t qth_comp; /*!< Short version of qth at time computed */
 } pass_t;
 
@@ -78,17 +80,48 @@ typedef struct {
     gint      orbit;
 } pass_detail_t;
 
+/**
+ * \brief Satellite to satellite visibility window.
+ *
+ * A window is a time interval in which the chord between two satellites
+ * is not occluded by the Earth and the atmosphere margin.
+ */
+typedef struct {
+    gchar      *satname;   /*!< name of the other satellite */
+    gint        catnum;    /*!< catalogue number of the other satellite */
+    gdouble     start;     /*!< start of the window in "jul_utc" */
+    gdouble     end;       /*!< end of the window in "jul_utc" */
+    gdouble     min_range; /*!< minimum range during the window [km] */
+    gdouble     max_range; /*!< maximum range during the window [km] */
+} link_t;
+
+/**
+ * \brief Long-horizon pass prediction job.
+ *
+ * Searches the passes in a long time window using several threads, see
+ * pass_job_run().
+ */
+typedef struct pass_job pass_job_t;
+
 /* type casting macros */
 #define PASS(x) ((pass_t *) x)
 #define PASS_DETAIL(x) ((pass_detail_t *) x)
 
+/* indexed access to the pass details */
+#define PASS_NUM_DETAILS(p) ((p)->details != NULL ? (p)->details->len : 0)
+#define PASS_NTH_DETAIL(p, i) (&g_array_index((p)->details, pass_detail_t, (i)))
+#define LINK(x) ((link_t *) x)
+
 /* SGP4/SDP4 driver */
-void predict_calc (sat_t *sat, qth_t *qth, gdouble t);
+void predict_calc     (sat_t *sat, qth_t *qth, gdouble t);
+void predict_calc_eci (sat_t *sat, gdouble t);
+void predict_calc_obs (sat_t *sat, qth_t *qth);
 
 /* AOS/LOS time calculators */
 gdouble find_aos           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 gdouble find_los           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 gdouble find_prev_aos      (sat_t *sat, qth_t *qth, gdouble start);
+gdouble refine_event       (sat_t *sat, qth_t *qth, gdouble seed, gboolean rising);
 
 /* next events */
 pass_t *get_next_pass      (sat_t *sat, qth_t *qth, gdouble maxdt);
@@ -100,15 +133,33 @@ GSList *get_passes         (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt
 pass_t *get_current_pass   (sat_t *sat, qth_t *qth, gdouble start);
 pass_t *get_pass_no_min_el (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 
+/* long-horizon predictions */
+pass_job_t *pass_job_new          (sat_t *sat, qth_t *qth, gdouble start,
+                                   gdouble maxdt, guint num);
+void        pass_job_free         (pass_job_t *job);
+gboolean    pass_job_run          (pass_job_t *job);
+GSList     *pass_job_take         (pass_job_t *job);
+void        pass_job_cancel       (pass_job_t *job);
+gdouble     pass_job_get_progress (pass_job_t *job);
+
+/* satellite to satellite visibility */
+gdouble link_clearance     (sat_t *sat1, sat_t *sat2, gdouble margin);
+GSList *get_links          (sat_t *sat1, sat_t *sat2, gdouble start,
+                            gdouble maxdt, gdouble margin);
+GSList *get_links_multi    (sat_t *sat, GHashTable *sats, gdouble start,
+                            gdouble maxdt, gdouble margin);
+
 /* copying */
 pass_t        *copy_pass         (pass_t *pass);
-GSList        *copy_pass_details (GSList *details);
+GArray        *copy_pass_details (GArray *details);
 pass_detail_t *copy_pass_detail  (pass_detail_t *detail);
 
 /* memory cleaning */
 void free_pass         (pass_t *pass);
 void free_passes       (GSList *passes);
 void free_pass_detail  (pass_detail_t *detail);
-void free_pass_details (GSList *details);
+void free_pass_details (GArray *details);
+void free_link         (link_t *link);
+void free_links        (GSList *links);
 
 #endif
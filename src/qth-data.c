@@ -28,6 +28,7 @@
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <string.h>
 
 #include "config-keys.h"
 #include "gpredict-utils.h"
@@ -54,6 +55,7 @@ gint qth_data_read(const gchar * filename, qth_t * qth)
 {
     GError         *error = NULL;
     gchar          *buff;
+    gchar          *fname;
     gchar         **buffv;
 
     qth->data = g_key_file_new();
@@ -198,6 +200,40 @@ gint qth_data_read(const gchar * filename, qth_t * qth)
         qth->type = QTH_STATIC_TYPE;
     }
 
+    /* Trajectory */
+    qth->traj_file = g_key_file_get_string(qth->data, QTH_CFG_MAIN_SECTION,
+                                           QTH_CFG_TRAJ_FILE_KEY, NULL);
+    if (qth->type == QTH_TRAJ_TYPE)
+    {
+        /* relative paths are relative to the QTH file */
+        if (qth->traj_file != NULL && !g_path_is_absolute(qth->traj_file))
+        {
+            buff = g_path_get_dirname(filename);
+            fname = g_build_filename(buff, qth->traj_file, NULL);
+            g_free(buff);
+        }
+        else
+        {
+            fname = g_strdup(qth->traj_file);
+        }
+
+        if (fname != NULL)
+            qth->traj = qth_traj_read(fname);
+        g_free(fname);
+
+        if (qth->traj == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: No trajectory for %s; using fixed position"),
+                        __func__, qth->name);
+        }
+        else
+        {
+            /* start at the current position */
+            qth_data_update(qth, get_current_daynum());
+        }
+    }
+
 #if HAS_LIBGPS
     /* GPSD Port */
     qth->gpsd_port = g_key_file_get_integer(qth->data,
@@ -306,6 +342,13 @@ gint qth_data_save(const gchar * filename, qth_t * qth)
     g_key_file_set_integer(qth->data, QTH_CFG_MAIN_SECTION, QTH_CFG_TYPE_KEY,
                            qth->type);
 
+    /* trajectory */
+    if (qth->traj_file && (g_utf8_strlen(qth->traj_file, -1) > 0))
+    {
+        g_key_file_set_string(qth->data, QTH_CFG_MAIN_SECTION,
+                              QTH_CFG_TRAJ_FILE_KEY, qth->traj_file);
+    }
+
 #if HAS_LIBGPS
     /* gpsd server */
     if (qth->gpsd_server && (g_utf8_strlen(qth->gpsd_server, -1) > 0))
@@ -360,6 +403,15 @@ void qth_data_free(qth_t * qth)
         qth->wx = NULL;
     }
 
+    if (qth->traj_file)
+    {
+        g_free(qth->traj_file);
+        qth->traj_file = NULL;
+    }
+
+    qth_traj_unref(qth->traj);
+    qth->traj = NULL;
+
     if (qth->data)
     {
         g_key_file_free(qth->data);
@@ -369,168 +421,232 @@ void qth_data_free(qth_t * qth)
     g_free(qth);
 }
 
-/**
- * Update the qth data by whatever method is appropriate.
- *
- * \param qth the qth data structure to update
- * \param qth the time at which the qth is to be computed. this may be ignored by gps updates.
- */
-gboolean qth_data_update(qth_t * qth, gdouble t)
+/* Move the QTH; returns TRUE if the position has changed */
+static gboolean qth_data_set_pos(qth_t * qth, const qth_small_t * pos)
 {
-#ifndef HAS_LIBGPS
-    (void)qth;
-    (void)t;
-    return FALSE;
+    if (qth->lat == pos->lat && qth->lon == pos->lon && qth->alt == pos->alt)
+        return FALSE;
+
+    qth->lat = pos->lat;
+    qth->lon = pos->lon;
+    qth->alt = pos->alt;
+
+    qth_validate(qth);
+    if (longlat2locator(qth->lon, qth->lat, qth->qra, 2) != RIG_OK)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not set QRA for %s at %f, %f."),
+                    __func__, qth->name, qth->lon, qth->lat);
+    }
+
+    return TRUE;
+}
+
+#ifdef HAS_LIBGPS
+/* max time to wait for gpsd data before checking for stop [usec] */
+#define QTH_GPSD_WAIT    500000
+/* reconnect if there was no fix for this long [usec] */
+#define QTH_GPSD_TIMEOUT (30 * G_USEC_PER_SEC)
+
+/* Open the connection to gpsd and start the stream */
+static gboolean qth_gpsd_open(qth_t * qth, struct gps_data_t *gps_data)
+{
+    gchar          *port;
+    gint            retcode;
+
+    port = g_strdup_printf("%d", qth->gpsd_port);
+#if GPSD_API_MAJOR_VERSION==4
+    retcode = gps_open_r(qth->gpsd_server, port, gps_data);
 #else
-    gboolean        retval = FALSE;
-    guint           num_loops = 0;
+    retcode = gps_open(qth->gpsd_server, port, gps_data);
+#endif
+    g_free(port);
 
-    if (qth->type != QTH_GPSD_TYPE)
+    if (retcode == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not open gpsd at  %s:%d"),
+                    __func__, qth->gpsd_server, qth->gpsd_port);
         return FALSE;
+    }
+
+    (void)gps_stream(gps_data, WATCH_ENABLE, NULL);
+
+    return TRUE;
+}
 
-    if (((t - qth->gpsd_update) > 30.0 / 86400.0) &&
-        (t - qth->gpsd_connected > 30.0 / 86400.0))
+/**
+ * Read the next packet from gpsd.
+ *
+ * @return 1 if a packet was read, 0 if no data arrived in time, -1 on error.
+ */
+static gint qth_gpsd_read(struct gps_data_t *gps_data)
+{
+#if GPSD_API_MAJOR_VERSION==4
+    /* gps_waiting() has no timeout in API 4 */
+    if (gps_waiting(gps_data) != TRUE)
     {
-        /* if needed restart the gpsd interface */
-        qth_data_update_stop(qth);
-        qth_data_update_init(qth);
-        qth->gpsd_connected = t;
+        g_usleep(QTH_GPSD_WAIT);
+        return 0;
     }
+    return (gps_poll(gps_data) == 0) ? 1 : -1;
+#else
+    if (gps_waiting(gps_data, QTH_GPSD_WAIT) != 1)
+        return 0;
+    return (gps_read(gps_data) == -1) ? -1 : 1;
+#endif
+}
 
-    if (qth->gps_data != NULL)
+/* Publish a new position; the main thread picks it up in qth_data_update() */
+static void qth_gpsd_publish(qth_t * qth, struct gps_data_t *gps_data)
+{
+    g_mutex_lock(&qth->gpsd_lock);
+    qth->gpsd_fix.lat = gps_data->fix.latitude;
+    qth->gpsd_fix.lon = gps_data->fix.longitude;
+    /* alt is only valid with a 3D fix */
+    qth->gpsd_fix.alt = (gps_data->fix.mode == MODE_3D) ?
+        gps_data->fix.altitude : 0;
+    g_atomic_int_inc(&qth->gpsd_seq);
+    g_mutex_unlock(&qth->gpsd_lock);
+}
+
+/**
+ * gpsd reader thread.
+ *
+ * Reads the gpsd stream until told to stop and publishes every 2D or 3D fix.
+ * The connection is opened again if it fails or if there was no fix for
+ * QTH_GPSD_TIMEOUT; this does not block the main thread.
+ */
+static gpointer qth_gpsd_thread(gpointer data)
+{
+    qth_t          *qth = data;
+    struct gps_data_t gps_data;
+    gboolean        connected = FALSE;
+    gint64          last_fix = 0;
+    gint64          now;
+    gint            retcode;
+
+    while (!g_atomic_int_get(&qth->gpsd_stop))
     {
-        switch (GPSD_API_MAJOR_VERSION)
+        now = g_get_monotonic_time();
+
+        if (!connected)
         {
-        case 4:
-#if GPSD_API_MAJOR_VERSION==4
-            while (gps_waiting(qth->gps_data) == TRUE)
-            {
-                /* this is a watchdog in case there is a problem with the gpsd code. */
-                /* if the server was up and has failed then gps_waiting in 2.92 confirmed */
-                /* will return 1 (supposedly fixed in later versions.) */
-                /* if we do not do this as a while loop, the gpsd packets can backup  */
-                /*   and no longer be in sync with the gps receiver */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_poll(qth->gps_data) == 0)
-                {
-                    /* handling packet_set inline with 
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-        case 5:
-#if GPSD_API_MAJOR_VERSION==5
-            while (gps_waiting(qth->gps_data, 0) == 1)
+            /* wait between attempts, but don't delay stopping */
+            if (last_fix != 0 && now - last_fix < QTH_GPSD_TIMEOUT)
             {
-                /* see comment from above */
-                /* hopefully not needed but does not hurt anything. */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_read(qth->gps_data) == 0)
-                {
-                    /* handling packet_set inline with 
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
+                g_usleep(QTH_GPSD_WAIT);
+                continue;
             }
-#endif
-            break;
-        default:
-            break;
+
+            memset(&gps_data, 0, sizeof(gps_data));
+            connected = qth_gpsd_open(qth, &gps_data);
+            last_fix = now;
+            continue;
         }
-        if (retval == TRUE)
+
+        retcode = qth_gpsd_read(&gps_data);
+        if (retcode > 0 && (gps_data.set & PACKET_SET) &&
+            gps_data.fix.mode >= MODE_2D)
         {
-            qth->gpsd_update = t;
+            /* handling packet_set inline with
+               http://gpsd.berlios.de/client-howto.html
+             */
+            qth_gpsd_publish(qth, &gps_data);
+            last_fix = now;
+        }
+        else if (retcode < 0 || now - last_fix > QTH_GPSD_TIMEOUT)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: No data from gpsd at %s:%d, reconnecting"),
+                        __func__, qth->gpsd_server, qth->gpsd_port);
+            gps_close(&gps_data);
+            connected = FALSE;
+            last_fix = now;
         }
     }
 
-    qth_validate(qth);
-    if (longlat2locator(qth->lon, qth->lat, qth->qra, 2) != RIG_OK)
+    if (connected)
+        gps_close(&gps_data);
+
+    return NULL;
+}
+#endif
+
+/**
+ * Update the qth data by whatever method is appropriate.
+ *
+ * \param qth the qth data structure to update
+ * \param qth the time at which the qth is to be computed. this may be ignored by gps updates.
+ * \return TRUE if the position has changed.
+ *
+ * For gpsd the position is read by a separate thread, see
+ * qth_data_update_init(); this only picks up the last fix and never blocks.
+ */
+gboolean qth_data_update(qth_t * qth, gdouble t)
+{
+    qth_small_t     fix;
+    geodetic_t      obs;
+    guint           seq;
+
+    if (qth->traj != NULL)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Could not set QRA for %s at %f, %f."),
-                    __func__, qth->name, qth->lon, qth->lat);
+        qth_traj_get(qth->traj, t, &obs, NULL);
+
+        fix.lat = Degrees(obs.lat);
+        fix.lon = Degrees(FMod2p(obs.lon + pi) - pi);
+        fix.alt = (gint) rint(obs.alt * 1000.0);
+
+        return qth_data_set_pos(qth, &fix);
+    }
+
+    if (qth->type != QTH_GPSD_TYPE || qth->gpsd_thread == NULL)
+        return FALSE;
+
+    /* cheap check for a new fix */
+    seq = g_atomic_int_get(&qth->gpsd_seq);
+    if (seq == qth->gpsd_seen)
+        return FALSE;
+
+    g_mutex_lock(&qth->gpsd_lock);
+    fix = qth->gpsd_fix;
+    seq = qth->gpsd_seq;
+    g_mutex_unlock(&qth->gpsd_lock);
+
+    qth->gpsd_seen = seq;
+    qth->gpsd_update = t;
+
+    return qth_data_set_pos(qth, &fix);
+}
+
+/**
+ * Get the observer position for predictions.
+ *
+ * \param qth the qth data structure
+ * \param t the time (Julian date)
+ * \param obs where to store the geodetic position in rad and km
+ * \param vel where to store the velocity relative to the ground in km/s as
+ *            east, north and up components, or NULL
+ *
+ * For a QTH following a trajectory this is the position at time t, otherwise
+ * the current position of the QTH.
+ */
+void qth_data_get_obs(qth_t * qth, gdouble t, geodetic_t * obs,
+                      vector_t * vel)
+{
+    if (qth->traj != NULL)
+    {
+        qth_traj_get(qth->traj, t, obs, vel);
+        return;
     }
 
-    return retval;
-#endif  // HAS_LIBGPS
+    obs->lon = qth->lon * de2ra;
+    obs->lat = qth->lat * de2ra;
+    obs->alt = qth->alt / 1000.0;
+    obs->theta = 0;
+
+    if (vel != NULL)
+        vel->x = vel->y = vel->z = vel->w = 0.0;
 }
 
 /**
@@ -540,83 +656,32 @@ gboolean qth_data_update(qth_t * qth, gdouble t)
  * 
  * Initial intention of this is to open sockets and ports to gpsd 
  * and other like services to update the qth position.
+ * For gpsd this starts the reader thread, which connects to gpsd.
  */
 gboolean qth_data_update_init(qth_t * qth)
 {
-#ifdef HAS_LIBGPS
-    char           *port;
-#endif
-    gboolean        retval = FALSE;
-
-
-    if (qth->type != QTH_GPSD_TYPE)
+    if (qth->type != QTH_GPSD_TYPE || qth->gpsd_thread != NULL)
         return FALSE;
 
-    /** FIXME: refactor */
-
 #ifdef HAS_LIBGPS
-    switch (GPSD_API_MAJOR_VERSION)
-    {
-    case 4:
-#if GPSD_API_MAJOR_VERSION==4
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open_r(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-    case 5:
-#if GPSD_API_MAJOR_VERSION==5
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Unsupported gpsd api major version (%d)"),
-                    __func__, GPSD_API_MAJOR_VERSION);
+#if GPSD_API_MAJOR_VERSION==4 || GPSD_API_MAJOR_VERSION==5
+    g_mutex_init(&qth->gpsd_lock);
+    g_atomic_int_set(&qth->gpsd_stop, 0);
+    qth->gpsd_seq = 0;
+    qth->gpsd_seen = 0;
+    qth->gpsd_thread = g_thread_new("gpredict_gpsd", qth_gpsd_thread, qth);
 
+    return TRUE;
+#else
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Unsupported gpsd api major version (%d)"),
+                __func__, GPSD_API_MAJOR_VERSION);
 
-        return FALSE;
-        break;
-    }
+    return FALSE;
+#endif
 #else
     return FALSE;
 #endif
-
-    return retval;
 }
 
 /**
@@ -626,30 +691,17 @@ gboolean qth_data_update_init(qth_t * qth)
  * 
  * Initial intention of this is to open sockets and ports to gpsd 
  * and other like services to update the qth position.
+ * For gpsd this stops the reader thread, which may take up to QTH_GPSD_WAIT.
  */
 void qth_data_update_stop(qth_t * qth)
 {
-    if (qth->type != QTH_GPSD_TYPE)
+    if (qth->gpsd_thread == NULL)
         return;
 
-    /* close gpsd socket */
-    if (qth->gps_data != NULL)
-    {
-#ifdef HAS_LIBGPS
-        switch (GPSD_API_MAJOR_VERSION)
-        {
-        case 4:
-            gps_close(qth->gps_data);
-            break;
-        case 5:
-            gps_close(qth->gps_data);
-            break;
-        default:
-            break;
-        }
-#endif
-        qth->gps_data = NULL;
-    }
+    g_atomic_int_set(&qth->gpsd_stop, 1);
+    g_thread_join(qth->gpsd_thread);
+    qth->gpsd_thread = NULL;
+    g_mutex_clear(&qth->gpsd_lock);
 }
 
 /**
@@ -663,13 +715,14 @@ void qth_init(qth_t * qth)
     qth->lon = 0;
     qth->alt = 0;
     qth->type = QTH_STATIC_TYPE;
-    qth->gps_data = NULL;
+    qth->gpsd_thread = NULL;
     qth->name = NULL;
     qth->loc = NULL;
     qth->gpsd_port = 0;
     qth->gpsd_server = NULL;
     qth->gpsd_update = 0.0;
-    qth->gpsd_connected = 0.0;
+    qth->traj_file = NULL;
+    qth->traj = NULL;
     qth->qra = g_strdup("AA00");
 }
 
@@ -690,7 +743,6 @@ void qth_safe(qth_t * qth)
     qth->lat = 0;
     qth->lon = 0;
     qth->alt = 0;
-    qth->gps_data = NULL;
 }
 
 /**
@@ -785,12 +837,17 @@ void qth_validate(qth_t * qth)
  * \param qth_small the data structure
  * 
  * This is intended for measuring distance between the current qth and
- * the position that tagged some data in qth_small.
+ * the position that tagged some data in qth_small. Data computed for a qth
+ * following a trajectory is computed along it and stays valid as the qth
+ * moves, so the distance is always 0.
  */
 double qth_small_dist(qth_t * qth, qth_small_t qth_small)
 {
     double          distance, azimuth;
 
+    if (qth->traj != NULL)
+        return 0.0;
+
     qrb(qth->lon, qth->lat, qth_small.lon, qth_small.lat, &distance, &azimuth);
 
     return (distance);
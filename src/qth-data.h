@@ -2,8 +2,16 @@
 #define __QTH_DATA_H__ 1
 
 #include <glib.h>
+#include "qth-traj.h"
 #include "sgpsdp/sgp4sdp4.h"
 
+/** Compact QTH data structure for tagging data and comparing. */
+typedef struct {
+    gdouble         lat;        /*!< Latitude in dec. deg. North. */
+    gdouble         lon;        /*!< Longitude in dec. deg. East. */
+    gint            alt;        /*!< Altitude above sea level in meters. */
+} qth_small_t;
+
 /** QTH data structure in human readable form. */
 typedef struct {
     gchar          *name;       /*!< Name, eg. callsign. */
@@ -18,21 +26,21 @@ typedef struct {
     gchar          *gpsd_server;        /*!< GPSD Server name. */
     gint            gpsd_port;  /*!< GPSD Server port. */
     gdouble         gpsd_update;        /*!< Time last GPSD update was received. */
-    gdouble         gpsd_connected;     /*!< Time last GPSD update was last attempted to connect. */
-    struct gps_data_t *gps_data;        /*!< gpsd data structure. */
+    GThread        *gpsd_thread;        /*!< gpsd reader thread. */
+    gint            gpsd_stop;  /*!< Tells the reader thread to stop (atomic). */
+    GMutex          gpsd_lock;  /*!< Protects gpsd_fix. */
+    qth_small_t     gpsd_fix;   /*!< Last position received from gpsd. */
+    guint           gpsd_seq;   /*!< Incremented with each new gpsd_fix (atomic). */
+    guint           gpsd_seen;  /*!< gpsd_seq of the last fix used. */
+    gchar          *traj_file;  /*!< Trajectory file name. */
+    qth_traj_t     *traj;       /*!< Planned trajectory or NULL. */
     GKeyFile       *data;       /*!< Raw data from cfg file. */
 } qth_t;
 
-/** Compact QTH data structure for tagging data and comparing. */
-typedef struct {
-    gdouble         lat;        /*!< Latitude in dec. deg. North. */
-    gdouble         lon;        /*!< Longitude in dec. deg. East. */
-    gint            alt;        /*!< Altitude above sea level in meters. */
-} qth_small_t;
-
 enum {
     QTH_STATIC_TYPE = 0,
-    QTH_GPSD_TYPE
+    QTH_GPSD_TYPE,
+    QTH_TRAJ_TYPE
 } qth_data_type;
 
 
@@ -42,6 +50,8 @@ void            qth_data_free(qth_t * qth);
 gboolean        qth_data_update(qth_t * qth, gdouble t);
 gboolean        qth_data_update_init(qth_t * qth);
 void            qth_data_update_stop(qth_t * qth);
+void            qth_data_get_obs(qth_t * qth, gdouble t, geodetic_t * obs,
+                                 vector_t * vel);
 double          qth_small_dist(qth_t * qth, qth_small_t qth_small);
 void            qth_small_save(qth_t * qth, qth_small_t * qth_small);
 void            qth_init(qth_t * qth);
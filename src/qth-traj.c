@@ -0,0 +1,342 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib/gi18n.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "qth-traj.h"
+#include "sat-log.h"
+
+/* a waypoint and the rates of the leg to the next one */
+typedef struct {
+    gdouble         t;          /* Julian date */
+    gdouble         lat;        /* rad */
+    gdouble         lon;        /* rad, continuous across the date line */
+    gdouble         alt;        /* km */
+    gdouble         dlat;       /* rad/day */
+    gdouble         dlon;       /* rad/day */
+    gdouble         dalt;       /* km/day */
+} qth_waypoint_t;
+
+struct qth_traj {
+    gint            refcount;
+    guint           num;
+    qth_waypoint_t *wp;
+    gdouble         max_lat;    /* rad */
+    gdouble         max_rate;   /* rad/day */
+};
+
+/* Parse a Julian date or a UTC time like 2017-06-12T10:30:00 */
+static gboolean parse_time(const gchar * str, gdouble * t)
+{
+    GDateTime      *dt;
+    gint            year, month, day, hour, min;
+    gint            n = 0;
+    gdouble         sec;
+    gchar          *end;
+
+    if (strchr(str, '-') == NULL)
+    {
+        *t = g_ascii_strtod(str, &end);
+        return (end != str && *end == '\0');
+    }
+
+    /* the seconds may have a fraction, which is always written with a
+       decimal point whatever the locale */
+    if (sscanf(str, "%d-%d-%dT%d:%d:%n", &year, &month, &day, &hour, &min,
+               &n) != 5 || n == 0)
+        return FALSE;
+
+    sec = g_ascii_strtod(str + n, &end);
+    if (end == str + n || *end != '\0')
+        return FALSE;
+
+    dt = g_date_time_new_utc(year, month, day, hour, min, sec);
+    if (dt == NULL)
+        return FALSE;
+
+    *t = 2440587.5 + (g_date_time_to_unix(dt) +
+                      g_date_time_get_microsecond(dt) / 1.0e6) / 86400.0;
+    g_date_time_unref(dt);
+
+    return TRUE;
+}
+
+/* Parse a waypoint line; returns FALSE if it is invalid */
+static gboolean parse_waypoint(gchar * line, qth_waypoint_t * wp)
+{
+    gchar         **tokens;
+    gchar          *fields[4];
+    gchar          *end;
+    gdouble         val[3];
+    gboolean        ok = FALSE;
+    guint           i, n = 0;
+
+    /* fields are separated by any number of spaces or tabs */
+    tokens = g_strsplit_set(line, " \t", -1);
+    for (i = 0; tokens[i] != NULL; i++)
+    {
+        if (*tokens[i] == '\0')
+            continue;
+        if (n == 4)
+            goto out;
+        fields[n++] = tokens[i];
+    }
+
+    if (n != 4 || !parse_time(fields[0], &wp->t))
+        goto out;
+
+    for (i = 0; i < 3; i++)
+    {
+        val[i] = g_ascii_strtod(fields[i + 1], &end);
+        if (end == fields[i + 1] || *end != '\0')
+            goto out;
+    }
+    if (fabs(val[0]) > 90.0 || fabs(val[1]) > 180.0)
+        goto out;
+
+    wp->lat = val[0] * de2ra;
+    wp->lon = val[1] * de2ra;
+    wp->alt = val[2] / 1000.0;
+    ok = TRUE;
+
+  out:
+    g_strfreev(tokens);
+
+    return ok;
+}
+
+/* Compute the rates of the legs and the limits of the trajectory */
+static void compute_legs(qth_traj_t * traj)
+{
+    qth_waypoint_t *a, *b;
+    gdouble         dt, coslat;
+    guint           i;
+
+    traj->max_lat = fabs(traj->wp[0].lat);
+    traj->max_rate = 0.0;
+
+    for (i = 0; i + 1 < traj->num; i++)
+    {
+        a = &traj->wp[i];
+        b = &traj->wp[i + 1];
+
+        /* take the short way across the date line */
+        while (b->lon - a->lon > pi)
+            b->lon -= twopi;
+        while (b->lon - a->lon < -pi)
+            b->lon += twopi;
+
+        dt = b->t - a->t;
+        a->dlat = (b->lat - a->lat) / dt;
+        a->dlon = (b->lon - a->lon) / dt;
+        a->dalt = (b->alt - a->alt) / dt;
+
+        /* the largest angular speed on the leg is where it is closest to
+           the equator */
+        if ((a->lat < 0.0) != (b->lat < 0.0))
+            coslat = 1.0;
+        else
+            coslat = cos(MIN(fabs(a->lat), fabs(b->lat)));
+
+        traj->max_rate = MAX(traj->max_rate,
+                             sqrt(a->dlat * a->dlat +
+                                  a->dlon * a->dlon * coslat * coslat));
+        traj->max_lat = MAX(traj->max_lat, fabs(b->lat));
+    }
+}
+
+/**
+ * Read a trajectory.
+ *
+ * @param filename The trajectory file.
+ * @return The trajectory or NULL if the file can not be read or has no
+ *         valid waypoints. Free it with qth_traj_unref().
+ */
+qth_traj_t     *qth_traj_read(const gchar * filename)
+{
+    qth_traj_t     *traj;
+    GArray         *wps;
+    GError         *error = NULL;
+    gchar          *contents;
+    gchar         **lines;
+    qth_waypoint_t  wp;
+    guint           i;
+
+    if (!g_file_get_contents(filename, &contents, NULL, &error))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not read trajectory %s (%s)"),
+                    __func__, filename, error->message);
+        g_clear_error(&error);
+
+        return NULL;
+    }
+
+    lines = g_strsplit(contents, "\n", -1);
+    g_free(contents);
+
+    wps = g_array_new(FALSE, TRUE, sizeof(qth_waypoint_t));
+    for (i = 0; lines[i] != NULL; i++)
+    {
+        g_strstrip(lines[i]);
+        if (lines[i][0] == '\0' || lines[i][0] == '#')
+            continue;
+
+        memset(&wp, 0, sizeof(wp));
+        if (!parse_waypoint(lines[i], &wp))
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Invalid waypoint in %s line %d"),
+                        __func__, filename, i + 1);
+            continue;
+        }
+
+        if (wps->len > 0 &&
+            wp.t <= g_array_index(wps, qth_waypoint_t, wps->len - 1).t)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Waypoint out of time order in %s line %d"),
+                        __func__, filename, i + 1);
+            continue;
+        }
+
+        g_array_append_val(wps, wp);
+    }
+    g_strfreev(lines);
+
+    if (wps->len == 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: No waypoints in %s"), __func__, filename);
+        g_array_free(wps, TRUE);
+
+        return NULL;
+    }
+
+    traj = g_new0(qth_traj_t, 1);
+    traj->refcount = 1;
+    traj->num = wps->len;
+    traj->wp = (qth_waypoint_t *) g_array_free(wps, FALSE);
+    compute_legs(traj);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Read %d waypoints from %s"), __func__, traj->num,
+                filename);
+
+    return traj;
+}
+
+/** Get a new reference to a trajectory. */
+qth_traj_t     *qth_traj_ref(qth_traj_t * traj)
+{
+    if (traj != NULL)
+        g_atomic_int_inc(&traj->refcount);
+
+    return traj;
+}
+
+/** Release a reference to a trajectory and free it with the last one. */
+void qth_traj_unref(qth_traj_t * traj)
+{
+    if (traj == NULL || !g_atomic_int_dec_and_test(&traj->refcount))
+        return;
+
+    g_free(traj->wp);
+    g_free(traj);
+}
+
+/**
+ * Get the position of the QTH at a given time.
+ *
+ * @param traj The trajectory.
+ * @param t The time (Julian date).
+ * @param obs The geodetic position of the QTH in rad and km.
+ * @param vel Where to store the velocity of the QTH relative to the ground
+ *            in km/s as east, north and up components, or NULL.
+ */
+void qth_traj_get(const qth_traj_t * traj, gdouble t, geodetic_t * obs,
+                  vector_t * vel)
+{
+    const qth_waypoint_t *wp;
+    guint           lo = 0, hi = traj->num - 1, mid;
+    gdouble         dt, r;
+
+    /* last waypoint not after t */
+    if (t >= traj->wp[hi].t)
+    {
+        lo = hi;
+    }
+    else
+    {
+        while (hi - lo > 1)
+        {
+            mid = (lo + hi) / 2;
+            if (traj->wp[mid].t <= t)
+                lo = mid;
+            else
+                hi = mid;
+        }
+    }
+
+    wp = &traj->wp[lo];
+    obs->theta = 0.0;
+
+    /* stay at the first or last waypoint outside the trajectory */
+    if (t < wp->t || lo == traj->num - 1)
+    {
+        obs->lat = wp->lat;
+        obs->lon = wp->lon;
+        obs->alt = wp->alt;
+        if (vel != NULL)
+            vel->x = vel->y = vel->z = vel->w = 0.0;
+
+        return;
+    }
+
+    dt = t - wp->t;
+    obs->lat = wp->lat + dt * wp->dlat;
+    obs->lon = wp->lon + dt * wp->dlon;
+    obs->alt = wp->alt + dt * wp->dalt;
+
+    if (vel != NULL)
+    {
+        r = xkmper + obs->alt;
+        vel->x = wp->dlon * r * cos(obs->lat) / secday;
+        vel->y = wp->dlat * r / secday;
+        vel->z = wp->dalt / secday;
+        vel->w = sqrt(vel->x * vel->x + vel->y * vel->y + vel->z * vel->z);
+    }
+}
+
+/** Get the largest absolute latitude of a trajectory in rad. */
+gdouble qth_traj_max_lat(const qth_traj_t * traj)
+{
+    return traj->max_lat;
+}
+
+/** Get the largest angular speed of a trajectory over ground in rad/day. */
+gdouble qth_traj_max_rate(const qth_traj_t * traj)
+{
+    return traj->max_rate;
+}
@@ -0,0 +1,53 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef QTH_TRAJ_H
+#define QTH_TRAJ_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+/*
+ * Planned trajectory of a moving QTH, e.g. a ship or an aircraft.
+ *
+ * The trajectory is read from a text file with one waypoint per line:
+ *
+ *   TIME LAT LON ALT
+ *
+ * TIME is a Julian date or a UTC time like 2017-06-12T10:30:00, LAT and LON
+ * are in degrees North and East and ALT is in meters above sea level. Empty
+ * lines and lines starting with # are ignored. The waypoints must be in
+ * time order.
+ *
+ * The position is interpolated linearly between the waypoints, with the
+ * rates of each leg computed when the file is read, so a query is a binary
+ * search and a few multiplications. Before the first and after the last
+ * waypoint the QTH stays at the first or last position. A trajectory is
+ * read-only once loaded and can be shared between threads.
+ */
+typedef struct qth_traj qth_traj_t;
+
+qth_traj_t     *qth_traj_read(const gchar * filename);
+qth_traj_t     *qth_traj_ref(qth_traj_t * traj);
+void            qth_traj_unref(qth_traj_t * traj);
+void            qth_traj_get(const qth_traj_t * traj, gdouble t,
+                             geodetic_t * obs, vector_t * vel);
+gdouble         qth_traj_max_lat(const qth_traj_t * traj);
+gdouble         qth_traj_max_rate(const qth_traj_t * traj);
+
+#endif
@@ -206,7 +206,20 @@ sat_cfg_int_t   sat_cfg_int[SAT_CFG_INT_NUM] = {
     {"TLE", "AUTO_UPDATE_ACTION", 1},   /* notify, see tle_auto_upd_action_t */
     {"TLE", "LAST_UPDATE", 0},
     {"LOG", "CLEAN_AGE", 0},    /* 0 = Never clean */
-    {"LOG", "LEVEL", 2}
+    {"LOG", "LEVEL", 2},
+    {"PREDICT", "EPHEM_STEP", 60},
+    {"PREDICT", "EPHEM_MAX_ERROR", 50},
+    {"MODULES", "TICK_BUDGET", 75},
+    {"PREDICT", "CONJ_THRESHOLD", 5},
+    {"PREDICT", "CONJ_WINDOW", 24},
+    {"PREDICT", "LINK_MARGIN", 100},
+    {"PREDICT", "LINK_WINDOW", 48},
+    {"PREDICT", "COV_MIN_EL", 10},
+    {"PREDICT", "COV_WINDOW", 24},
+    {"PREDICT", "DOP_MASK", 10},
+    {"PREDICT", "DOP_WINDOW", 24},
+    {"STREAM", "PORT", 0},
+    {"SERVER", "PORT", 0}
 };
 
 /** Array containing the string configuration values */
@@ -242,12 +255,71 @@ sat_cfg_str_t   sat_cfg_str[SAT_CFG_STR_NUM] = {
      "http://www.celestrak.com/NORAD/elements/visual.txt;"
      "http://www.celestrak.com/NORAD/elements/weather.txt"},
     {"TLE", "FILE_DIR", NULL},
-    {"PREDICT", "SAVE_DIR", NULL}
+    {"PREDICT", "SAVE_DIR", NULL},
+    {"STREAM", "SOCKET", NULL},
+    {"SERVER", "SOCKET", NULL}
 };
 
 /* The configuration data buffer */
 static GKeyFile *config = NULL;
 
+/*
+ * Cached value of an integer or boolean parameter. These are read in every
+ * module cycle and looking them up in the GKeyFile allocates memory, so the
+ * value is kept until the parameter is changed. Misses and changes are done
+ * with the cache lock held.
+ */
+typedef struct {
+    gint            value;
+    gint            valid;
+} cfg_cache_t;
+
+static cfg_cache_t bool_cache[SAT_CFG_BOOL_NUM];
+static cfg_cache_t int_cache[SAT_CFG_INT_NUM];
+
+/* strings returned by sat_cfg_peek_str(); replaced values are kept until
+   the configuration is closed since they may still be in use */
+static gchar   *str_cache[SAT_CFG_STR_NUM];
+static GSList  *str_stale = NULL;
+
+G_LOCK_DEFINE_STATIC(cache);
+
+static void cache_store(cfg_cache_t * entry, gint value)
+{
+    g_atomic_int_set(&entry->value, value);
+    g_atomic_int_set(&entry->valid, TRUE);
+}
+
+static void cache_clear(void)
+{
+    guint           i;
+
+    G_LOCK(cache);
+    for (i = 0; i < SAT_CFG_BOOL_NUM; i++)
+        g_atomic_int_set(&bool_cache[i].valid, FALSE);
+    for (i = 0; i < SAT_CFG_INT_NUM; i++)
+        g_atomic_int_set(&int_cache[i].valid, FALSE);
+    for (i = 0; i < SAT_CFG_STR_NUM; i++)
+    {
+        g_free(str_cache[i]);
+        g_atomic_pointer_set(&str_cache[i], NULL);
+    }
+    g_slist_free_full(str_stale, g_free);
+    str_stale = NULL;
+    G_UNLOCK(cache);
+}
+
+static void str_cache_drop(sat_cfg_str_e param)
+{
+    gchar          *old = str_cache[param];
+
+    if (old != NULL)
+    {
+        g_atomic_pointer_set(&str_cache[param], NULL);
+        str_stale = g_slist_prepend(str_stale, old);
+    }
+}
+
 /**
  * Load configuration data.
  * @return 0 if everything OK, 1 otherwise.
@@ -267,6 +339,7 @@ guint sat_cfg_load()
         sat_cfg_close();
 
     /* load the configuration file */
+    cache_clear();
     config = g_key_file_new();
     confdir = get_user_conf_dir();
     keyfile = g_strconcat(confdir, G_DIR_SEPARATOR_S, "gpredict.cfg", NULL);
@@ -382,6 +455,8 @@ void sat_cfg_close()
         g_key_file_free(config);
         config = NULL;
     }
+
+    cache_clear();
 }
 
 /** Get boolean value */
@@ -400,9 +475,14 @@ gboolean sat_cfg_get_bool(sat_cfg_bool_e param)
             /* return default value */
             value = sat_cfg_bool[param].defval;
         }
+        else if (g_atomic_int_get(&bool_cache[param].valid))
+        {
+            value = g_atomic_int_get(&bool_cache[param].value);
+        }
         else
         {
             /* fetch value */
+            G_LOCK(cache);
             value = g_key_file_get_boolean(config,
                                            sat_cfg_bool[param].group,
                                            sat_cfg_bool[param].key, &error);
@@ -412,6 +492,8 @@ gboolean sat_cfg_get_bool(sat_cfg_bool_e param)
                 g_clear_error(&error);
                 value = sat_cfg_bool[param].defval;
             }
+            cache_store(&bool_cache[param], value);
+            G_UNLOCK(cache);
         }
 
     }
@@ -461,9 +543,12 @@ void sat_cfg_set_bool(sat_cfg_bool_e param, gboolean value)
         }
         else
         {
+            G_LOCK(cache);
             g_key_file_set_boolean(config,
                                    sat_cfg_bool[param].group,
                                    sat_cfg_bool[param].key, value);
+            cache_store(&bool_cache[param], value ? TRUE : FALSE);
+            G_UNLOCK(cache);
         }
     }
     else
@@ -484,9 +569,12 @@ void sat_cfg_reset_bool(sat_cfg_bool_e param)
         }
         else
         {
+            G_LOCK(cache);
             g_key_file_remove_key(config,
                                   sat_cfg_bool[param].group,
                                   sat_cfg_bool[param].key, NULL);
+            g_atomic_int_set(&bool_cache[param].valid, FALSE);
+            G_UNLOCK(cache);
         }
 
     }
@@ -497,15 +585,32 @@ void sat_cfg_reset_bool(sat_cfg_bool_e param)
     }
 }
 
+/* Read a string value from the configuration; needs the cache lock */
+static gchar   *str_read(sat_cfg_str_e param)
+{
+    gchar          *value;
+    GError         *error = NULL;
+
+    value = g_key_file_get_string(config, sat_cfg_str[param].group,
+                                  sat_cfg_str[param].key, &error);
+    if (error != NULL)
+    {
+        g_clear_error(&error);
+        value = g_strdup(sat_cfg_str[param].defval);
+    }
+
+    return value;
+}
+
 /**
  * Get string value
  *
  * Return a newly allocated gchar * which must be freed when no longer needed.
+ * May be called from any thread.
  */
 gchar          *sat_cfg_get_str(sat_cfg_str_e param)
 {
     gchar          *value;
-    GError         *error = NULL;
 
     if (param < SAT_CFG_STR_NUM)
     {
@@ -520,14 +625,9 @@ gchar          *sat_cfg_get_str(sat_cfg_str_e param)
         else
         {
             /* fetch value */
-            value = g_key_file_get_string(config,
-                                          sat_cfg_str[param].group,
-                                          sat_cfg_str[param].key, &error);
-            if (error != NULL)
-            {
-                g_clear_error(&error);
-                value = g_strdup(sat_cfg_str[param].defval);
-            }
+            G_LOCK(cache);
+            value = str_read(param);
+            G_UNLOCK(cache);
         }
     }
     else
@@ -541,6 +641,41 @@ gchar          *sat_cfg_get_str(sat_cfg_str_e param)
     return value;
 }
 
+/**
+ * Get string value without copying it.
+ *
+ * The string is owned by the configuration and remains valid until
+ * sat_cfg_close(). Use this for values that are needed in every cycle.
+ */
+const gchar    *sat_cfg_peek_str(sat_cfg_str_e param)
+{
+    gchar          *value;
+
+    if (param >= SAT_CFG_STR_NUM)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Unknown STR param index (%d)\n"), __func__, param);
+
+        return "ERROR";
+    }
+
+    value = g_atomic_pointer_get(&str_cache[param]);
+    if (value == NULL)
+    {
+        G_LOCK(cache);
+        value = str_cache[param];
+        if (value == NULL)
+        {
+            value = (config != NULL) ? str_read(param) :
+                g_strdup(sat_cfg_str[param].defval);
+            g_atomic_pointer_set(&str_cache[param], value);
+        }
+        G_UNLOCK(cache);
+    }
+
+    return value;
+}
+
 /**
  * Get default value of string parameter
  *
@@ -577,6 +712,7 @@ void sat_cfg_set_str(sat_cfg_str_e param, const gchar * value)
         }
         else
         {
+            G_LOCK(cache);
             if (value)
             {
                 g_key_file_set_string(config,
@@ -590,6 +726,8 @@ void sat_cfg_set_str(sat_cfg_str_e param, const gchar * value)
                                       sat_cfg_str[param].group,
                                       sat_cfg_str[param].key, NULL);
             }
+            str_cache_drop(param);
+            G_UNLOCK(cache);
         }
     }
     else
@@ -611,9 +749,12 @@ void sat_cfg_reset_str(sat_cfg_str_e param)
         }
         else
         {
+            G_LOCK(cache);
             g_key_file_remove_key(config,
                                   sat_cfg_str[param].group,
                                   sat_cfg_str[param].key, NULL);
+            str_cache_drop(param);
+            G_UNLOCK(cache);
         }
 
     }
@@ -639,9 +780,14 @@ gint sat_cfg_get_int(sat_cfg_int_e param)
             /* return default value */
             value = sat_cfg_int[param].defval;
         }
+        else if (g_atomic_int_get(&int_cache[param].valid))
+        {
+            value = g_atomic_int_get(&int_cache[param].value);
+        }
         else
         {
             /* fetch value */
+            G_LOCK(cache);
             value = g_key_file_get_integer(config,
                                            sat_cfg_int[param].group,
                                            sat_cfg_int[param].key, &error);
@@ -651,6 +797,8 @@ gint sat_cfg_get_int(sat_cfg_int_e param)
                 g_clear_error(&error);
                 value = sat_cfg_int[param].defval;
             }
+            cache_store(&int_cache[param], value);
+            G_UNLOCK(cache);
         }
 
     }
@@ -691,9 +839,12 @@ void sat_cfg_set_int(sat_cfg_int_e param, gint value)
         }
         else
         {
+            G_LOCK(cache);
             g_key_file_set_integer(config,
                                    sat_cfg_int[param].group,
                                    sat_cfg_int[param].key, value);
+            cache_store(&int_cache[param], value);
+            G_UNLOCK(cache);
         }
 
     }
@@ -715,9 +866,12 @@ void sat_cfg_reset_int(sat_cfg_int_e param)
         }
         else
         {
+            G_LOCK(cache);
             g_key_file_remove_key(config,
                                   sat_cfg_int[param].group,
                                   sat_cfg_int[param].key, NULL);
+            g_atomic_int_set(&int_cache[param].valid, FALSE);
+            G_UNLOCK(cache);
         }
 
     }
@@ -128,6 +128,19 @@ typedef enum {
     SAT_CFG_INT_TLE_LAST_UPDATE,        /*!< Date and time of last update, Unix seconds. */
     SAT_CFG_INT_LOG_CLEAN_AGE,  /*!< Age of log file to delete (seconds) */
     SAT_CFG_INT_LOG_LEVEL,      /*!< Logging level */
+    SAT_CFG_INT_EPHEM_STEP,     /*!< Max node spacing in ephemeris caches [sec] */
+    SAT_CFG_INT_EPHEM_MAX_ERR,  /*!< Ephemeris cache error bound [m] */
+    SAT_CFG_INT_TICK_BUDGET,    /*!< Module cycle time budget [% of refresh rate] */
+    SAT_CFG_INT_CONJ_THRESHOLD, /*!< Close approach threshold [km] */
+    SAT_CFG_INT_CONJ_WINDOW,    /*!< Close approach screening window [hours] */
+    SAT_CFG_INT_LINK_MARGIN,    /*!< Atmosphere margin for sat-sat links [km] */
+    SAT_CFG_INT_LINK_WINDOW,    /*!< Sat-sat link search window [hours] */
+    SAT_CFG_INT_COV_MIN_EL,     /*!< Coverage analysis min. elevation [deg] */
+    SAT_CFG_INT_COV_WINDOW,     /*!< Coverage analysis window [hours] */
+    SAT_CFG_INT_DOP_MASK,       /*!< GNSS DOP elevation mask [deg] */
+    SAT_CFG_INT_DOP_WINDOW,     /*!< GNSS DOP window [hours] */
+    SAT_CFG_INT_STREAM_PORT,    /*!< State stream TCP port, 0 disables */
+    SAT_CFG_INT_SERVER_PORT,    /*!< Prediction server TCP port, 0 disables */
     SAT_CFG_INT_NUM             /*!< Number of integer parameters. */
 } sat_cfg_int_e;
 
@@ -151,6 +164,8 @@ typedef enum {
     SAT_CFG_STR_TLE_URLS,       /*!< ; separated list of TLE file URLs (since 1.4) */
     SAT_CFG_STR_TLE_FILE_DIR,   /*!< Local directory from which tle were last updated. */
     SAT_CFG_STR_PRED_SAVE_DIR,  /*!< Last used save directory for pass predictions */
+    SAT_CFG_STR_STREAM_SOCKET,  /*!< State stream UNIX socket path */
+    SAT_CFG_STR_SERVER_SOCKET,  /*!< Prediction server UNIX socket path */
     SAT_CFG_STR_NUM             /*!< Number of string parameters */
 } sat_cfg_str_e;
 
@@ -162,6 +177,7 @@ gboolean        sat_cfg_get_bool_def(sat_cfg_bool_e param);
 void            sat_cfg_set_bool(sat_cfg_bool_e param, gboolean value);
 void            sat_cfg_reset_bool(sat_cfg_bool_e param);
 gchar          *sat_cfg_get_str(sat_cfg_str_e param);
+const gchar    *sat_cfg_peek_str(sat_cfg_str_e param);
 gchar          *sat_cfg_get_str_def(sat_cfg_str_e param);
 void            sat_cfg_set_str(sat_cfg_str_e param, const gchar * value);
 void            sat_cfg_reset_str(sat_cfg_str_e param);
@@ -0,0 +1,190 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Per-satellite update decimation.
+ *
+ * Satellites that move slowly on the screen do not need to be propagated in
+ * every module cycle. Each satellite gets an update interval derived from
+ * its angular rate as seen from the observer and on the map, and from the
+ * angular resolution of the views. Between two propagations the ECI state
+ * is extrapolated with a second order Taylor series using the two-body
+ * acceleration, and only the cheap observer dependent part is recalculated.
+ *
+ * The interval is also limited so that the extrapolation error, which is
+ * dominated by the neglected jerk term, stays below
+ * SAT_CFG_INT_EPHEM_MAX_ERR.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <math.h>
+
+#include "sat-cfg.h"
+#include "sat-decim.h"
+
+/* upper limit for the propagation interval [days] */
+#define DECIM_MAX_INTERVAL  (300.0 / 86400.0)
+
+
+/**
+ * Create decimation state for a satellite.
+ *
+ * @param sat The satellite.
+ * @return Newly allocated state; free with g_free().
+ *
+ * The satellite is due for propagation until sat_decim_store() is called.
+ */
+sat_decim_t    *sat_decim_new(sat_t * sat)
+{
+    sat_decim_t    *decim;
+
+    decim = g_new0(sat_decim_t, 1);
+    decim->catnum = sat->tle.catnr;
+
+    return decim;
+}
+
+/* angle between two directions given as (lon,lat) pairs [deg], small angles */
+static gdouble angle_diff(gdouble lon1, gdouble lat1, gdouble lon2,
+                          gdouble lat2)
+{
+    gdouble         dlon = lon2 - lon1;
+    gdouble         dlat = lat2 - lat1;
+
+    while (dlon > 180.0)
+        dlon -= 360.0;
+    while (dlon < -180.0)
+        dlon += 360.0;
+
+    dlon *= cos(0.5 * (lat1 + lat2) * de2ra);
+
+    return sqrt(dlon * dlon + dlat * dlat);
+}
+
+/**
+ * Largest interval for which the extrapolation error is below maxerr.
+ *
+ * The jerk of a two-body orbit is bounded by 4*mu*|v|/r^3 and the error
+ * of the second order series is jerk*dt^3/6.
+ */
+static gdouble max_extrap_interval(vector_t * pos, vector_t * vel)
+{
+    gdouble         maxerr;
+    gdouble         jerk;
+
+    maxerr = sat_cfg_get_int(SAT_CFG_INT_EPHEM_MAX_ERR) / 1000.0;
+    jerk = 4.0 * ge * vel->w / (pos->w * pos->w * pos->w);
+
+    if (jerk <= 0.0)
+        return 0.0;
+
+    return cbrt(6.0 * maxerr / jerk) / secday;
+}
+
+/**
+ * Check whether a satellite needs to be propagated.
+ *
+ * @param decim The decimation state of the satellite.
+ * @param t The time.
+ * @return TRUE if the update interval has elapsed since the last
+ *         propagation, in either direction.
+ */
+gboolean sat_decim_due(sat_decim_t * decim, gdouble t)
+{
+    return decim->t <= 0.0 || fabs(t - decim->t) >= decim->interval;
+}
+
+/**
+ * Extrapolate the state from the last propagation.
+ *
+ * @param decim The decimation state of the satellite.
+ * @param sat The satellite.
+ * @param t The time.
+ *
+ * This function is equivalent to predict_calc_eci(sat, t) and should be
+ * followed by predict_calc_obs().
+ */
+void sat_decim_extrapolate(sat_decim_t * decim, sat_t * sat, gdouble t)
+{
+    gdouble         dt = (t - decim->t) * secday;
+    gdouble         k;
+
+    /* two-body acceleration is -mu*r/|r|^3 */
+    k = -ge / (decim->pos.w * decim->pos.w * decim->pos.w);
+
+    sat->pos.x = decim->pos.x + dt * (decim->vel.x + 0.5 * dt * k * decim->pos.x);
+    sat->pos.y = decim->pos.y + dt * (decim->vel.y + 0.5 * dt * k * decim->pos.y);
+    sat->pos.z = decim->pos.z + dt * (decim->vel.z + 0.5 * dt * k * decim->pos.z);
+    sat->vel.x = decim->vel.x + dt * k * decim->pos.x;
+    sat->vel.y = decim->vel.y + dt * k * decim->pos.y;
+    sat->vel.z = decim->vel.z + dt * k * decim->pos.z;
+    Magnitude(&sat->pos);
+    Magnitude(&sat->vel);
+
+    /* tle.xno is in rad/min */
+    sat->phase = FMod2p(decim->phase + sat->tle.xno * dt / 60.0);
+
+    sat->jul_utc = t;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+}
+
+/**
+ * Store the state of a propagated satellite.
+ *
+ * @param decim The decimation state of the satellite.
+ * @param sat The satellite, fully updated with predict_calc() or equivalent.
+ * @param res The angular resolution of the views [deg].
+ *
+ * The new interval is chosen so that the satellite moves less than res
+ * until the next propagation.
+ */
+void sat_decim_store(sat_decim_t * decim, sat_t * sat, gdouble res)
+{
+    gdouble         t = sat->jul_utc;
+    gdouble         dt, rate, rate_map, interval;
+
+    dt = fabs(t - decim->t);
+
+    interval = 0.0;
+    if (decim->t > 0.0 && dt > 0.0)
+    {
+        /* angular rates [deg/day] in the sky and on the map */
+        rate = angle_diff(decim->az, decim->el, sat->az, sat->el) / dt;
+        rate_map = angle_diff(decim->lon, decim->lat,
+                              sat->ssplon, sat->ssplat) / dt;
+        rate = MAX(rate, rate_map);
+
+        interval = (rate > 0.0) ? res / rate : DECIM_MAX_INTERVAL;
+        interval = MIN(interval, max_extrap_interval(&sat->pos, &sat->vel));
+        interval = CLAMP(interval, 0.0, DECIM_MAX_INTERVAL);
+    }
+
+    decim->t = t;
+    decim->interval = interval;
+    decim->pos = sat->pos;
+    decim->vel = sat->vel;
+    decim->phase = sat->phase * de2ra;    /* predict_calc_obs() uses deg */
+    decim->az = sat->az;
+    decim->el = sat->el;
+    decim->lat = sat->ssplat;
+    decim->lon = sat->ssplon;
+}
@@ -0,0 +1,46 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_DECIM_H
+#define SAT_DECIM_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+/** Per-satellite update decimation state. */
+typedef struct {
+    gint            catnum;     /*!< Catalogue number, used as hash key */
+    gdouble         t;          /*!< Time of last propagation (0.0 = never) */
+    gdouble         interval;   /*!< Current propagation interval [days] */
+    vector_t        pos;        /*!< ECI position at t [km] */
+    vector_t        vel;        /*!< ECI velocity at t [km/sec] */
+    gdouble         phase;      /*!< Orbit phase at t [rad] */
+    gdouble         az;         /*!< Azimuth at t [deg] */
+    gdouble         el;         /*!< Elevation at t [deg] */
+    gdouble         lat;        /*!< SSP latitude at t [deg] */
+    gdouble         lon;        /*!< SSP longitude at t [deg] */
+} sat_decim_t;
+
+sat_decim_t    *sat_decim_new(sat_t * sat);
+gboolean        sat_decim_due(sat_decim_t * decim, gdouble t);
+void            sat_decim_extrapolate(sat_decim_t * decim, sat_t * sat,
+                                      gdouble t);
+void            sat_decim_store(sat_decim_t * decim, sat_t * sat,
+                                gdouble res);
+
+#endif
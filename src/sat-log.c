@@ -55,6 +55,9 @@ static GIOChannel *logfile = NULL;
 static sat_log_level_t loglevel = SAT_LOG_LEVEL_DEBUG;
 static gboolean debug_to_stderr = FALSE; // whether to also send debug msg to stderr
 
+/* messages may come from the worker threads */
+G_LOCK_DEFINE_STATIC(logfile);
+
 /** String representation of debug levels. */
 const gchar    *debug_level_str[] = {
     N_(" --- "),
@@ -232,6 +235,7 @@ static void manage_debug_message(sat_log_level_t debug_level,
                           debug_level, SAT_LOG_MSG_SEPARATOR, message);
 
     /* print debug message */
+    G_LOCK(logfile);
     if G_LIKELY(initialised)
     {
         /* save to file */
@@ -249,6 +253,7 @@ static void manage_debug_message(sat_log_level_t debug_level,
         /* send to stderr */
         g_fprintf(stderr, "%s", msg);
     }
+    G_UNLOCK(logfile);
 
     g_free(msg);
 }
@@ -51,6 +51,22 @@
 
 #define RESPONSE_PRINT 10
 #define RESPONSE_SAVE  11
+#define RESPONSE_STOP  12
+
+/* refresh interval of the multi-pass dialog while a job is running [msec] */
+#define MULTI_PASS_JOB_REFRESH 250
+
+/* long-horizon prediction job of a multi-pass dialog */
+typedef struct {
+    pass_job_t     *job;        /* NULL when done */
+    GThread        *thread;
+    GtkWidget      *dialog;
+    GtkWidget      *progress;
+    gint            days;
+    gboolean        valid;      /* the job was not stopped */
+    gint            done;       /* the thread is done (atomic) */
+    guint           timerid;
+} pass_job_dlg_t;
 
 /** Column titles for multi-pass lists */
 const gchar    *MULTI_PASS_COL_TITLE[MULTI_PASS_COL_NUMBER] = {
@@ -338,11 +354,11 @@ void show_pass(const gchar * satname, qth_t * qth, pass_t * pass,
                                    G_TYPE_STRING);      // visibility
 
     /* add rows to list store */
-    num = g_slist_length(pass->details);
+    num = PASS_NUM_DETAILS(pass);
 
     for (i = 0; i < num; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+        detail = PASS_NTH_DETAIL(pass, i);
 
         gtk_list_store_append(liststore, &item);
         gtk_list_store_set(liststore, &item,
@@ -913,33 +929,15 @@ static void Calc_RADec(gdouble jul_utc, gdouble saz, gdouble sel,
 
 /***   MULTI PASS  ***/
 
-/**
- * Show details about a satellite pass.
- *
- * @param satname The name of the satellite.
- * @param qth Pointer to the QTH data.
- * @param passes List of passes to show.
- * @param toplevel The toplevel window or NULL.
- *
- * This function creates a dialog window with a list showing the
- * details of a pass.
- *
- */
-void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
-                 GtkWidget * toplevel)
+/* Create the list of a multi-pass dialog */
+static GtkWidget *multi_pass_list_new(qth_t * qth, GtkWidget * toplevel)
 {
-    GtkWidget      *dialog;
     GtkWidget      *list;
     GtkListStore   *liststore;
     GtkCellRenderer *renderer;
     GtkTreeViewColumn *column;
-    GtkTreeIter     item;
-    GtkWidget      *swin;
-    gchar          *title;
     guint           flags;
-    guint           i, num;
-    pass_t         *pass = NULL;
-    gchar          *buff;
+    guint           i;
 
     /* get columns flags */
     flags = sat_cfg_get_int(SAT_CFG_INT_PRED_MULTI_COL);
@@ -972,7 +970,7 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
         }
     }
 
-    /* create and fill model */
+    /* create model */
     liststore = gtk_list_store_new(MULTI_PASS_COL_NUMBER + 1, G_TYPE_DOUBLE,    // aos time
                                    G_TYPE_DOUBLE,       // tca time
                                    G_TYPE_DOUBLE,       // los time
@@ -985,12 +983,56 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
                                    G_TYPE_STRING,       // visibility
                                    G_TYPE_INT); // row number
 
-    /* add rows to list store */
-    num = g_slist_length(passes);
+    /* connect model to tree view */
+    gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(liststore));
+    g_object_unref(liststore);
 
-    for (i = 0; i < num; i++)
+    /* store reference to QTH */
+    g_object_set_data(G_OBJECT(list), "qth", qth);
+
+    /* mouse events => popup menu */
+    g_signal_connect(list, "button-press-event", G_CALLBACK(button_press_cb),
+                     NULL);
+    g_signal_connect(list, "popup-menu", G_CALLBACK(popup_menu_cb), NULL);
+
+    /* "row-activated" signal is used to catch double click events, which means
+       a pass has been double clicked => show details */
+    g_signal_connect(list, "row-activated", G_CALLBACK(row_activated_cb),
+                     toplevel);
+
+    return list;
+}
+
+/**
+ * Add passes to a multi-pass dialog.
+ *
+ * @param dialog The multi-pass dialog.
+ * @param passes The passes to add; the dialog takes ownership.
+ *
+ * The passes are appended to the list of passes of the dialog and its
+ * tree view.
+ */
+static void multi_pass_append(GtkWidget * dialog, GSList * passes)
+{
+    GtkWidget      *list;
+    GtkListStore   *liststore;
+    GtkTreeIter     item;
+    GSList         *all;
+    pass_t         *pass;
+    guint           i;
+
+    if (passes == NULL)
+        return;
+
+    list = GTK_WIDGET(g_object_get_data(G_OBJECT(dialog), "list"));
+    liststore = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(list)));
+    all = (GSList *) g_object_get_data(G_OBJECT(dialog), "passes");
+
+    /* add rows to list store */
+    i = g_slist_length(all);
+    for (; passes != NULL; passes = passes->next, i++)
     {
-        pass = PASS(g_slist_nth_data(passes, i));
+        pass = PASS(passes->data);
         gtk_list_store_append(liststore, &item);
         gtk_list_store_set(liststore, &item,
                            MULTI_PASS_COL_AOS_TIME, pass->aos,
@@ -1005,24 +1047,29 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
                            MULTI_PASS_COL_VIS, pass->vis,
                            MULTI_PASS_COL_NUMBER, i, -1);
     }
+}
 
-    /* connect model to tree view */
-    gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(liststore));
-    g_object_unref(liststore);
+/* Store a list of passes in a multi-pass dialog and its tree view */
+static void multi_pass_set_passes(GtkWidget * dialog, GSList * passes)
+{
+    GtkWidget      *list;
 
-    /* store reference to passes and QTH */
+    list = GTK_WIDGET(g_object_get_data(G_OBJECT(dialog), "list"));
     g_object_set_data(G_OBJECT(list), "passes", passes);
-    g_object_set_data(G_OBJECT(list), "qth", qth);
+    g_object_set_data(G_OBJECT(dialog), "passes", passes);
+}
 
-    /* mouse events => popup menu */
-    g_signal_connect(list, "button-press-event", G_CALLBACK(button_press_cb),
-                     NULL);
-    g_signal_connect(list, "popup-menu", G_CALLBACK(popup_menu_cb), NULL);
+/* Create a multi-pass dialog without passes */
+static GtkWidget *multi_pass_dialog_new(const gchar * satname, qth_t * qth,
+                                        GtkWidget * toplevel)
+{
+    GtkWidget      *dialog;
+    GtkWidget      *list;
+    GtkWidget      *swin;
+    gchar          *title;
+    gchar          *buff;
 
-    /* "row-activated" signal is used to catch double click events, which means
-       a pass has been double clicked => show details */
-    g_signal_connect(list, "row-activated", G_CALLBACK(row_activated_cb),
-                     toplevel);
+    list = multi_pass_list_new(qth, toplevel);
 
     /* scrolled window */
     swin = gtk_scrolled_window_new(NULL, NULL);
@@ -1058,7 +1105,7 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
 
     g_object_set_data(G_OBJECT(dialog), "sat", (gpointer) satname);
     g_object_set_data(G_OBJECT(dialog), "qth", qth);
-    g_object_set_data(G_OBJECT(dialog), "passes", passes);
+    g_object_set_data(G_OBJECT(dialog), "list", list);
 
     g_signal_connect(dialog, "response", G_CALLBACK(multi_pass_response),
                      NULL);
@@ -1071,9 +1118,140 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
                        swin, TRUE, TRUE, 0);
 
     gtk_window_set_default_size(GTK_WINDOW(dialog), -1, 300);
+
+    return dialog;
+}
+
+/**
+ * Show details about a satellite pass.
+ *
+ * @param satname The name of the satellite.
+ * @param qth Pointer to the QTH data.
+ * @param passes List of passes to show.
+ * @param toplevel The toplevel window or NULL.
+ *
+ * This function creates a dialog window with a list showing the
+ * details of a pass.
+ *
+ */
+void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
+                 GtkWidget * toplevel)
+{
+    GtkWidget      *dialog;
+
+    dialog = multi_pass_dialog_new(satname, qth, toplevel);
+    multi_pass_append(dialog, passes);
+    multi_pass_set_passes(dialog, passes);
+
     gtk_widget_show_all(dialog);
 }
 
+/* Move the passes found by the job to the dialog and update the progress */
+static gboolean multi_pass_job_update(gpointer data)
+{
+    pass_job_dlg_t *jd = data;
+    GSList         *passes;
+    GSList         *all;
+    gchar          *buff;
+    gboolean        done;
+
+    done = g_atomic_int_get(&jd->done);
+    if (done)
+    {
+        g_thread_join(jd->thread);
+        jd->thread = NULL;
+    }
+
+    passes = pass_job_take(jd->job);
+    all = (GSList *) g_object_get_data(G_OBJECT(jd->dialog), "passes");
+    multi_pass_append(jd->dialog, passes);
+    all = g_slist_concat(all, passes);
+    multi_pass_set_passes(jd->dialog, all);
+
+    if (!done)
+    {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(jd->progress),
+                                      pass_job_get_progress(jd->job));
+        buff = g_strdup_printf(_("Searching... %d passes found"),
+                               g_slist_length(all));
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(jd->progress), buff);
+        g_free(buff);
+
+        return TRUE;
+    }
+
+    if (all == NULL)
+        buff = g_strdup_printf(_("No passes within the next %d days"),
+                               jd->days);
+    else if (jd->valid)
+        buff = g_strdup_printf(_("%d passes"), g_slist_length(all));
+    else
+        buff = g_strdup_printf(_("Stopped after %d passes"),
+                               g_slist_length(all));
+
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(jd->progress), 1.0);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(jd->progress), buff);
+    g_free(buff);
+
+    gtk_dialog_set_response_sensitive(GTK_DIALOG(jd->dialog), RESPONSE_STOP,
+                                      FALSE);
+
+    pass_job_free(jd->job);
+    jd->job = NULL;
+    jd->timerid = 0;
+
+    return FALSE;
+}
+
+static gpointer multi_pass_job_thread(gpointer data)
+{
+    pass_job_dlg_t *jd = data;
+
+    jd->valid = pass_job_run(jd->job);
+    g_atomic_int_set(&jd->done, 1);
+
+    return NULL;
+}
+
+/**
+ * Show the passes found by a long-horizon prediction job.
+ *
+ * @param satname The name of the satellite.
+ * @param qth Pointer to the QTH data.
+ * @param job The job, which must not be running; the dialog takes ownership.
+ * @param days The length of the time window of the job.
+ * @param toplevel The toplevel window or NULL.
+ *
+ * The job is run in a background thread and the passes are added to the
+ * list as they are found. The job is stopped with the Stop button or when
+ * the dialog is closed.
+ */
+void show_passes_job(const gchar * satname, qth_t * qth, pass_job_t * job,
+                     gint days, GtkWidget * toplevel)
+{
+    pass_job_dlg_t *jd;
+
+    jd = g_new0(pass_job_dlg_t, 1);
+    jd->job = job;
+    jd->days = days;
+    jd->dialog = multi_pass_dialog_new(satname, qth, toplevel);
+    g_object_set_data(G_OBJECT(jd->dialog), "job", jd);
+
+    gtk_dialog_add_button(GTK_DIALOG(jd->dialog), "S_top", RESPONSE_STOP);
+
+    jd->progress = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(jd->progress), TRUE);
+    gtk_box_pack_start(GTK_BOX
+                       (gtk_dialog_get_content_area(GTK_DIALOG(jd->dialog))),
+                       jd->progress, FALSE, FALSE, 0);
+
+    jd->thread = g_thread_new("gpredict_passes", multi_pass_job_thread, jd);
+    jd->timerid = g_timeout_add(MULTI_PASS_JOB_REFRESH,
+                                multi_pass_job_update, jd);
+
+    gtk_widget_show_all(jd->dialog);
+}
+
 /**
  * Manage button responses for multi-pass dialogues.
  *
@@ -1087,6 +1265,8 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
 static void multi_pass_response(GtkWidget * dialog, gint response,
                                 gpointer data)
 {
+    pass_job_dlg_t *jd;
+
     (void)data;
 
     switch (response)
@@ -1098,6 +1278,11 @@ static void multi_pass_response(GtkWidget * dialog, gint response,
     case RESPONSE_SAVE:
         save_passes(dialog);
         break;
+    case RESPONSE_STOP:
+        jd = g_object_get_data(G_OBJECT(dialog), "job");
+        if (jd != NULL && jd->job != NULL)
+            pass_job_cancel(jd->job);
+        break;
         /* Close button or delete events */
     default:
         gtk_widget_destroy(dialog);
@@ -1120,9 +1305,23 @@ static void multi_pass_dialog_destroy(GtkWidget * dialog, gpointer data)
 {
     GSList         *passes =
         (GSList *) g_object_get_data(G_OBJECT(dialog), "passes");
+    pass_job_dlg_t *jd = g_object_get_data(G_OBJECT(dialog), "job");
 
     (void)data;
 
+    /* stop the job; the passes it has found are freed with the job */
+    if (jd != NULL)
+    {
+        if (jd->timerid > 0)
+            g_source_remove(jd->timerid);
+        if (jd->job != NULL)
+            pass_job_cancel(jd->job);
+        if (jd->thread != NULL)
+            g_thread_join(jd->thread);
+        pass_job_free(jd->job);
+        g_free(jd);
+    }
+
     free_passes(passes);
     gtk_widget_destroy(dialog);
 }
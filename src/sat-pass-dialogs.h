@@ -113,5 +113,8 @@ void            show_pass(const gchar * satname, qth_t * qth, pass_t * pass,
                           GtkWidget * toplevel);
 void            show_passes(const gchar * satname, qth_t * qth,
                             GSList * passes, GtkWidget * toplevel);
+void            show_passes_job(const gchar * satname, qth_t * qth,
+                                pass_job_t * job, gint days,
+                                GtkWidget * toplevel);
 
 #endif
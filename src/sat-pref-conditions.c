@@ -191,7 +191,7 @@ GtkWidget      *sat_pref_conditions_create()
     label = gtk_label_new(_("Number of passes to predict"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
     gtk_grid_attach(GTK_GRID(table), label, 0, 3, 1, 1);
-    numpass = gtk_spin_button_new_with_range(5, 50, 1);
+    numpass = gtk_spin_button_new_with_range(5, 500, 1);
     gtk_widget_set_tooltip_text(numpass,
                                 _("The maximum number of passes to predict."));
     gtk_spin_button_set_digits(GTK_SPIN_BUTTON(numpass), 0);
@@ -207,7 +207,7 @@ GtkWidget      *sat_pref_conditions_create()
     label = gtk_label_new(_("Passes should occur within"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
     gtk_grid_attach(GTK_GRID(table), label, 0, 4, 1, 1);
-    lookahead = gtk_spin_button_new_with_range(1, 14, 1);
+    lookahead = gtk_spin_button_new_with_range(1, 90, 1);
     gtk_widget_set_tooltip_text(lookahead,
                                 _("Only passes that occur within the "
                                   "specified number of days will be "
@@ -40,5 +40,6 @@ typedef enum {
     QTH_LIST_COL_TYPE,          /*!< Is this QTH the default one? */
     QTH_LIST_COL_GPSD_SERVER,   /*!< Is this QTH the default one? */
     QTH_LIST_COL_GPSD_PORT,     /*!< Is this QTH the default one? */
+    QTH_LIST_COL_TRAJ_FILE,     /*!< Trajectory file. */
     QTH_LIST_COL_NUM            /*!< The number of fields. */
 } qth_list_col_t;
@@ -43,6 +43,7 @@
 #include "gpredict-utils.h"
 #include "loc-tree.h"
 #include "locator.h"
+#include "qth-data.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 #include "sat-pref-qth-data.h"
@@ -72,6 +73,8 @@ static GtkWidget *qra;          /* QRA locator */
 static gulong   latsigid, lonsigid, nssigid, ewsigid, qrasigid;
 static GtkWidget *wx;           /* weather station */
 
+static GtkWidget *traj;         /* trajectory file */
+
 #ifdef HAS_LIBGPS
 static GtkWidget *type;         /* GPSD type */
 static GtkWidget *server;       /* GPSD Server */
@@ -95,6 +98,7 @@ static void update_widgets(GtkTreeView * treeview)
     gchar          *qthgpsdserver;      /* gpsdserver */
     guint           qthtype;    /* type */
     guint           qthgpsdport;        /* gpsdport */
+    gchar          *qthtraj;    /* trajectory file */
 
     selection = gtk_tree_view_get_selection(treeview);
     if (gtk_tree_selection_get_selected(selection, &model, &iter))
@@ -110,6 +114,7 @@ static void update_widgets(GtkTreeView * treeview)
                            QTH_LIST_COL_WX, &qthwx,
                            QTH_LIST_COL_GPSD_SERVER, &qthgpsdserver,
                            QTH_LIST_COL_GPSD_PORT, &qthgpsdport,
+                           QTH_LIST_COL_TRAJ_FILE, &qthtraj,
                            QTH_LIST_COL_TYPE, &qthtype, -1);
 
         /* update widgets and free memory afterwards */
@@ -135,6 +140,12 @@ static void update_widgets(GtkTreeView * treeview)
             gtk_entry_set_text(GTK_ENTRY(wx), qthwx);
             g_free(qthwx);
         }
+
+        if (qthtraj)
+        {
+            gtk_entry_set_text(GTK_ENTRY(traj), qthtraj);
+            g_free(qthtraj);
+        }
 #ifdef HAS_LIBGPS
         if (qthgpsdserver)
         {
@@ -159,7 +170,9 @@ static void update_widgets(GtkTreeView * treeview)
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(alt), qthalt);
 #ifdef HAS_LIBGPS
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(port), qthgpsdport);
-        gtk_combo_box_set_active(GTK_COMBO_BOX(type), qthtype);
+        gtk_combo_box_set_active(GTK_COMBO_BOX(type),
+                                 (qthtype == QTH_GPSD_TYPE) ? qthtype :
+                                 QTH_STATIC_TYPE);
 #endif
 
         sat_log_log(SAT_LOG_LEVEL_DEBUG,
@@ -192,6 +205,7 @@ static void clear_widgets()
     gtk_entry_set_text(GTK_ENTRY(location), "");
     gtk_entry_set_text(GTK_ENTRY(desc), "");
     gtk_entry_set_text(GTK_ENTRY(wx), "");
+    gtk_entry_set_text(GTK_ENTRY(traj), "");
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(lat), 0.0);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(lon), 0.0);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(alt), 0);
@@ -215,6 +229,7 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
     const gchar    *qthdesc;
     const gchar    *qthwx;
     const gchar    *qthgpsdserver;
+    const gchar    *qthtraj;
     gdouble         qthlat;
     gdouble         qthlon;
     guint           qthalt;
@@ -252,6 +267,11 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
     qthtype = 0;                // FIXME: should probably use a #define
 #endif
 
+    /* a trajectory overrides the type */
+    qthtraj = gtk_entry_get_text(GTK_ENTRY(traj));
+    if (qthtraj[0] != '\0')
+        qthtype = QTH_TRAJ_TYPE;
+
     /* get liststore */
     liststore = GTK_LIST_STORE(gtk_tree_view_get_model(treeview));
 
@@ -292,6 +312,7 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
                        QTH_LIST_COL_WX, qthwx,
                        QTH_LIST_COL_GPSD_SERVER, qthgpsdserver,
                        QTH_LIST_COL_GPSD_PORT, qthgpsdport,
+                       QTH_LIST_COL_TRAJ_FILE, qthtraj,
                        QTH_LIST_COL_TYPE, qthtype, -1);
 
     qthqra = gtk_entry_get_text(GTK_ENTRY(qra));
@@ -435,6 +456,31 @@ static void select_location(GtkWidget * widget, gpointer data)
     /* else do nothing; we are finished */
 }
 
+/** Select a trajectory file */
+static void select_traj(GtkWidget * widget, gpointer data)
+{
+    GtkWidget      *chooser;
+    gchar          *fname;
+
+    (void)widget;
+    (void)data;
+
+    chooser = gtk_file_chooser_dialog_new(_("Select trajectory"),
+                                          GTK_WINDOW(dialog),
+                                          GTK_FILE_CHOOSER_ACTION_OPEN,
+                                          "_Cancel", GTK_RESPONSE_CANCEL,
+                                          "_Open", GTK_RESPONSE_ACCEPT, NULL);
+
+    if (gtk_dialog_run(GTK_DIALOG(chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        fname = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(chooser));
+        gtk_entry_set_text(GTK_ENTRY(traj), fname);
+        g_free(fname);
+    }
+
+    gtk_widget_destroy(chooser);
+}
+
 /**
  * Manage coordinate changes.
  *
@@ -580,6 +626,7 @@ static GtkWidget *create_editor_widgets(GtkTreeView * treeview, gboolean new)
     GtkWidget      *label;
     GtkWidget      *locbut;
     GtkWidget      *wxbut;
+    GtkWidget      *trajbut;
 
     table = gtk_grid_new();
     gtk_grid_set_column_homogeneous(GTK_GRID(table), FALSE);
@@ -744,6 +791,28 @@ static GtkWidget *create_editor_widgets(GtkTreeView * treeview, gboolean new)
                      GUINT_TO_POINTER(SELECTION_MODE_WX));
     gtk_grid_attach(GTK_GRID(table), wxbut, 3, 7, 1, 1);
 
+    /* trajectory */
+    label = gtk_label_new(_("Trajectory"));
+    g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 11, 1, 1);
+
+    traj = gtk_entry_new();
+    gtk_widget_set_tooltip_text(traj,
+                                _("Optional file with the planned track of a "
+                                  "moving ground station, e.g. a ship or an "
+                                  "aircraft. Each line holds a UTC time "
+                                  "(2017-06-12T10:30:00) or Julian date, the "
+                                  "latitude, the longitude and the altitude "
+                                  "in meters. The ground station follows the "
+                                  "track and the predictions are made along "
+                                  "it."));
+    gtk_grid_attach(GTK_GRID(table), traj, 1, 11, 2, 1);
+
+    trajbut = gtk_button_new_with_label(_("Select"));
+    gtk_widget_set_tooltip_text(trajbut, _("Select a trajectory file"));
+    g_signal_connect(trajbut, "clicked", G_CALLBACK(select_traj), NULL);
+    gtk_grid_attach(GTK_GRID(table), trajbut, 3, 11, 1, 1);
+
 #ifdef HAS_LIBGPS
     /* GPSD enabled */
     label = gtk_label_new(_("QTH Type"));
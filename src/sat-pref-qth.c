@@ -306,7 +306,8 @@ static GtkTreeModel *create_and_fill_model()
                                    G_TYPE_BOOLEAN,      // Default
                                    G_TYPE_INT,  //type
                                    G_TYPE_STRING,       //server
-                                   G_TYPE_INT   //port
+                                   G_TYPE_INT,  //port
+                                   G_TYPE_STRING        //trajectory
         );
 
     gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(liststore),
@@ -472,7 +473,8 @@ static guint read_qth_file(GtkListStore * liststore, gchar * filename)
                        QTH_LIST_COL_DEF, is_default,
                        QTH_LIST_COL_TYPE, qth->type,
                        QTH_LIST_COL_GPSD_SERVER, qth->gpsd_server,
-                       QTH_LIST_COL_GPSD_PORT, qth->gpsd_port, -1);
+                       QTH_LIST_COL_GPSD_PORT, qth->gpsd_port,
+                       QTH_LIST_COL_TRAJ_FILE, qth->traj_file, -1);
 
     g_free(fname);
 
@@ -831,7 +833,8 @@ static gboolean save_qth(GtkTreeModel * model, GtkTreePath * path,
                        QTH_LIST_COL_WX, &qth.wx,
                        QTH_LIST_COL_TYPE, &qth.type,
                        QTH_LIST_COL_GPSD_SERVER, &qth.gpsd_server,
-                       QTH_LIST_COL_GPSD_PORT, &qth.gpsd_port, -1);
+                       QTH_LIST_COL_GPSD_PORT, &qth.gpsd_port,
+                       QTH_LIST_COL_TRAJ_FILE, &qth.traj_file, -1);
 
     confdir = get_user_conf_dir();
     filename = g_strconcat(confdir, G_DIR_SEPARATOR_S, qth.name, ".qth", NULL);
@@ -866,6 +869,7 @@ static gboolean save_qth(GtkTreeModel * model, GtkTreePath * path,
     g_free(qth.loc);
     g_free(qth.desc);
     g_free(qth.wx);
+    g_free(qth.traj_file);
 
     return FALSE;
 }
@@ -0,0 +1,734 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <gio/gio.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include "compat.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "sat-stream.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/* max number of connected clients */
+#define MAX_CLIENTS 16
+
+/* max length of a command line */
+#define MAX_LINE 4096
+
+G_STATIC_ASSERT(sizeof(sat_stream_rec_t) == 48);
+
+/** A connected client. */
+typedef struct {
+    GSocketConnection *conn;
+    GSocket        *socket;
+    GSource        *in_src;     /*!< Watch for commands */
+    GSource        *out_src;    /*!< Watch for writability while sending */
+    GHashTable     *catnums;    /*!< Subscribed catnums or NULL for all */
+    gboolean        binary;     /*!< Binary frames instead of JSON */
+    GBytes         *cur;        /*!< Frame being sent */
+    gsize           off;        /*!< Bytes of cur already sent */
+    GHashTable     *next;       /*!< Latest frame of each module waiting
+                                     for cur */
+    GQueue         *order;      /*!< Modules in next, oldest first; the
+                                     names are owned by next */
+    GString        *line;       /*!< Incomplete command line */
+    guint64         frames;     /*!< Frames sent */
+    guint64         dropped;    /*!< Stale frames dropped */
+} stream_client_t;
+
+static GSocketService *service = NULL;
+static GList   *clients = NULL;
+static gchar   *sockpath = NULL;
+
+static void     client_free(stream_client_t * c);
+
+
+/* byte order of the binary frames */
+static void rec_to_le(sat_stream_rec_t * rec)
+{
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+    guint32        *w = (guint32 *) rec;
+    guint64        *d = (guint64 *) & rec->aos;
+    guint           i;
+
+    for (i = 0; i < 8; i++)
+        w[i] = GUINT32_TO_LE(w[i]);
+    d[0] = GUINT64_TO_LE(d[0]);
+    d[1] = GUINT64_TO_LE(d[1]);
+#else
+    (void)rec;
+#endif
+}
+
+static void rec_from_le(const sat_stream_rec_t * src, sat_stream_rec_t * rec)
+{
+    *rec = *src;
+    /* the conversion is symmetric */
+    rec_to_le(rec);
+}
+
+/* fill in the binary frame header */
+static void frame_header(guint8 * hdr, const gchar * module, gdouble t,
+                         guint n)
+{
+    guint16         u16;
+    guint64         u64;
+
+    memset(hdr, 0, SAT_STREAM_HDRSIZE);
+    memcpy(hdr, SAT_STREAM_MAGIC, 4);
+    u16 = GUINT16_TO_LE(SAT_STREAM_VERSION);
+    memcpy(hdr + 4, &u16, 2);
+    u16 = GUINT16_TO_LE((guint16) n);
+    memcpy(hdr + 6, &u16, 2);
+    memcpy(&u64, &t, 8);
+    u64 = GUINT64_TO_LE(u64);
+    memcpy(hdr + 8, &u64, 8);
+    if (module != NULL)
+        strncpy((gchar *) hdr + 16, module, 23);
+}
+
+/**
+ * Pack the state of the satellites into a binary frame.
+ *
+ * The records are written directly into the frame buffer, which is shared
+ * by all binary clients that subscribe to all satellites.
+ */
+static GBytes  *pack_frame(const gchar * module, GHashTable * sats,
+                           gdouble t)
+{
+    GHashTableIter  iter;
+    gpointer        value;
+    sat_stream_rec_t *rec;
+    sat_t          *sat;
+    guint8         *buff;
+    guint           n;
+
+    n = MIN(g_hash_table_size(sats), G_MAXUINT16);
+    buff = g_malloc(SAT_STREAM_HDRSIZE + n * sizeof(sat_stream_rec_t));
+    frame_header(buff, module, t, n);
+
+    rec = (sat_stream_rec_t *) (buff + SAT_STREAM_HDRSIZE);
+    g_hash_table_iter_init(&iter, sats);
+    while (n > 0 && g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        sat = SAT(value);
+        rec->catnum = sat->tle.catnr;
+        rec->reserved = 0;
+        rec->az = sat->az;
+        rec->el = sat->el;
+        rec->range = sat->range;
+        rec->range_rate = sat->range_rate;
+        rec->ssplat = sat->ssplat;
+        rec->ssplon = sat->ssplon;
+        rec->aos = sat->aos;
+        rec->los = sat->los;
+        rec_to_le(rec);
+        rec++;
+        n--;
+    }
+
+    return g_bytes_new_take(buff, (guint8 *) rec - buff);
+}
+
+static gboolean wanted(stream_client_t * c, const sat_stream_rec_t * rec)
+{
+    gint            catnum;
+
+    if (c == NULL || c->catnums == NULL)
+        return TRUE;
+
+    catnum = GINT32_FROM_LE(rec->catnum);
+
+    return g_hash_table_contains(c->catnums, &catnum);
+}
+
+static void json_double(GString * buff, const gchar * key,
+                        const gchar * format, gdouble value)
+{
+    gchar           str[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append_printf(buff, ",\"%s\":%s", key,
+                           g_ascii_formatd(str, sizeof(str), format, value));
+}
+
+/* encode a packed frame as JSON, optionally for the subset of a client */
+static GBytes  *json_frame(GBytes * packed, stream_client_t * c)
+{
+    const guint8   *data;
+    const sat_stream_rec_t *src;
+    sat_stream_rec_t rec;
+    GString        *buff;
+    gchar           module[24];
+    gdouble         t;
+    guint64         u64;
+    gsize           len;
+    guint           i, n;
+    gboolean        first = TRUE;
+
+    data = g_bytes_get_data(packed, &len);
+    n = (len - SAT_STREAM_HDRSIZE) / sizeof(sat_stream_rec_t);
+    memcpy(&u64, data + 8, 8);
+    u64 = GUINT64_FROM_LE(u64);
+    memcpy(&t, &u64, 8);
+    memcpy(module, data + 16, sizeof(module));
+    module[sizeof(module) - 1] = '\0';
+
+    buff = g_string_sized_new(64 + n * 160);
+    g_string_append(buff, "{\"t\":");
+    g_string_append_printf(buff, "%.8f", t);
+    g_string_append(buff, ",\"module\":\"");
+    for (i = 0; module[i] != '\0'; i++)
+    {
+        if (module[i] == '"' || module[i] == '\\')
+            g_string_append_c(buff, '\\');
+        if ((guchar) module[i] >= 0x20)
+            g_string_append_c(buff, module[i]);
+    }
+    g_string_append(buff, "\",\"sats\":[");
+
+    src = (const sat_stream_rec_t *)(data + SAT_STREAM_HDRSIZE);
+    for (i = 0; i < n; i++)
+    {
+        if (!wanted(c, &src[i]))
+            continue;
+
+        rec_from_le(&src[i], &rec);
+        g_string_append_printf(buff, "%s{\"catnum\":%d", first ? "" : ",",
+                               rec.catnum);
+        json_double(buff, "az", "%.3f", rec.az);
+        json_double(buff, "el", "%.3f", rec.el);
+        json_double(buff, "range", "%.3f", rec.range);
+        json_double(buff, "range_rate", "%.5f", rec.range_rate);
+        json_double(buff, "ssplat", "%.3f", rec.ssplat);
+        json_double(buff, "ssplon", "%.3f", rec.ssplon);
+        json_double(buff, "aos", "%.8f", rec.aos);
+        json_double(buff, "los", "%.8f", rec.los);
+        g_string_append_c(buff, '}');
+        first = FALSE;
+    }
+    g_string_append(buff, "]}\n");
+
+    len = buff->len;
+    return g_bytes_new_take(g_string_free(buff, FALSE), len);
+}
+
+/* copy the records subscribed by a client into a new binary frame */
+static GBytes  *subset_frame(GBytes * packed, stream_client_t * c)
+{
+    const guint8   *data;
+    const sat_stream_rec_t *src;
+    guint8         *buff;
+    guint16         u16;
+    gsize           len, size;
+    guint           i, n, m = 0;
+
+    data = g_bytes_get_data(packed, &len);
+    n = (len - SAT_STREAM_HDRSIZE) / sizeof(sat_stream_rec_t);
+    buff = g_malloc(len);
+    memcpy(buff, data, SAT_STREAM_HDRSIZE);
+    size = SAT_STREAM_HDRSIZE;
+
+    src = (const sat_stream_rec_t *)(data + SAT_STREAM_HDRSIZE);
+    for (i = 0; i < n; i++)
+    {
+        if (wanted(c, &src[i]))
+        {
+            memcpy(buff + size, &src[i], sizeof(sat_stream_rec_t));
+            size += sizeof(sat_stream_rec_t);
+            m++;
+        }
+    }
+
+    u16 = GUINT16_TO_LE((guint16) m);
+    memcpy(buff + 6, &u16, 2);
+
+    return g_bytes_new_take(buff, size);
+}
+
+static gboolean client_out_cb(GSocket * socket, GIOCondition cond,
+                              gpointer data);
+
+/* take the oldest waiting frame; returns NULL if there is none */
+static GBytes  *client_next(stream_client_t * c)
+{
+    GBytes         *frame;
+    gchar          *module;
+
+    module = g_queue_pop_head(c->order);
+    if (module == NULL)
+        return NULL;
+
+    frame = g_bytes_ref(g_hash_table_lookup(c->next, module));
+    g_hash_table_remove(c->next, module);
+
+    return frame;
+}
+
+/**
+ * Send as much of the pending frames as the socket accepts.
+ *
+ * @return FALSE if the client has to be closed.
+ */
+static gboolean client_send(stream_client_t * c)
+{
+    GError         *err = NULL;
+    const gchar    *data;
+    gsize           len;
+    gssize          n;
+
+    while (c->cur != NULL)
+    {
+        data = g_bytes_get_data(c->cur, &len);
+        n = g_socket_send(c->socket, data + c->off, len - c->off, NULL,
+                          &err);
+        if (n < 0)
+        {
+            if (g_error_matches(err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+                g_clear_error(&err);
+
+                /* continue when the socket becomes writable */
+                if (c->out_src == NULL)
+                {
+                    c->out_src = g_socket_create_source(c->socket, G_IO_OUT,
+                                                        NULL);
+                    g_source_set_callback(c->out_src,
+                                          (GSourceFunc) client_out_cb, c,
+                                          NULL);
+                    g_source_attach(c->out_src, NULL);
+                }
+
+                return TRUE;
+            }
+
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Client dropped (%s)"),
+                        __func__, err->message);
+            g_clear_error(&err);
+
+            return FALSE;
+        }
+
+        c->off += n;
+        if (c->off == len)
+        {
+            g_bytes_unref(c->cur);
+            c->cur = client_next(c);
+            c->off = 0;
+            c->frames++;
+        }
+    }
+
+    if (c->out_src != NULL)
+    {
+        g_source_destroy(c->out_src);
+        g_source_unref(c->out_src);
+        c->out_src = NULL;
+    }
+
+    return TRUE;
+}
+
+static gboolean client_out_cb(GSocket * socket, GIOCondition cond,
+                              gpointer data)
+{
+    stream_client_t *c = data;
+
+    (void)socket;
+    (void)cond;
+
+    if (!client_send(c))
+    {
+        client_free(c);
+        return FALSE;
+    }
+
+    /* client_send() removes the source when everything is sent */
+    return c->out_src != NULL;
+}
+
+/**
+ * Queue a frame for a client.
+ *
+ * A client keeps at most the frame it is sending and the latest frame of
+ * each module; a frame that has not been started when a newer one of the
+ * same module arrives is stale and dropped.
+ */
+static gboolean client_queue(stream_client_t * c, const gchar * module,
+                             GBytes * frame)
+{
+    gchar          *key;
+
+    if (c->cur == NULL)
+    {
+        c->cur = frame;
+        c->off = 0;
+    }
+    else
+    {
+        if (g_hash_table_contains(c->next, module))
+        {
+            /* keeps the key and its place in the queue */
+            g_hash_table_insert(c->next, g_strdup(module), frame);
+            c->dropped++;
+        }
+        else
+        {
+            key = g_strdup(module);
+            g_hash_table_insert(c->next, key, frame);
+            g_queue_push_tail(c->order, key);
+        }
+
+        /* the socket is not writable yet */
+        if (c->out_src != NULL)
+            return TRUE;
+    }
+
+    return client_send(c);
+}
+
+static void parse_catnums(stream_client_t * c, gchar ** argv, gboolean add)
+{
+    gint           *catnum;
+    guint           i;
+
+    for (i = 1; argv[i] != NULL; i++)
+    {
+        if (argv[i][0] == '\0')
+            continue;
+
+        if (!strcmp(argv[i], "*"))
+        {
+            if (add && c->catnums != NULL)
+            {
+                g_hash_table_destroy(c->catnums);
+                c->catnums = NULL;
+            }
+            continue;
+        }
+
+        catnum = g_new(gint, 1);
+        *catnum = (gint) g_ascii_strtoll(argv[i], NULL, 10);
+
+        if (add)
+        {
+            if (c->catnums == NULL)
+                c->catnums = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                                   g_free, NULL);
+            g_hash_table_add(c->catnums, catnum);
+        }
+        else
+        {
+            if (c->catnums != NULL)
+                g_hash_table_remove(c->catnums, catnum);
+            g_free(catnum);
+        }
+    }
+}
+
+static void client_command(stream_client_t * c, const gchar * line)
+{
+    gchar         **argv;
+
+    argv = g_strsplit_set(line, " \t\r", -1);
+
+    if (!g_ascii_strcasecmp(argv[0], "SUB"))
+        parse_catnums(c, argv, TRUE);
+    else if (!g_ascii_strcasecmp(argv[0], "UNSUB"))
+        parse_catnums(c, argv, FALSE);
+    else if (!g_ascii_strcasecmp(argv[0], "FMT") && argv[1] != NULL)
+        c->binary = !g_ascii_strcasecmp(argv[1], "bin");
+    else if (argv[0][0] != '\0')
+        sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Unknown command: %s"),
+                    __func__, line);
+
+    g_strfreev(argv);
+}
+
+static gboolean client_in_cb(GSocket * socket, GIOCondition cond,
+                             gpointer data)
+{
+    stream_client_t *c = data;
+    GError         *err = NULL;
+    gchar           buff[256];
+    gchar          *eol;
+    gssize          n;
+
+    (void)cond;
+
+    n = g_socket_receive(socket, buff, sizeof(buff), NULL, &err);
+    if (n < 0 && g_error_matches(err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+        g_clear_error(&err);
+        return TRUE;
+    }
+
+    if (n <= 0)
+    {
+        g_clear_error(&err);
+        client_free(c);
+        return FALSE;
+    }
+
+    g_string_append_len(c->line, buff, n);
+    while ((eol = memchr(c->line->str, '\n', c->line->len)) != NULL)
+    {
+        *eol = '\0';
+        client_command(c, c->line->str);
+        g_string_erase(c->line, 0, eol - c->line->str + 1);
+    }
+
+    if (c->line->len > MAX_LINE)
+    {
+        client_free(c);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void client_free(stream_client_t * c)
+{
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Client disconnected (%" G_GUINT64_FORMAT " frames, %"
+                  G_GUINT64_FORMAT " dropped)"), __func__, c->frames,
+                c->dropped);
+
+    clients = g_list_remove(clients, c);
+
+    g_source_destroy(c->in_src);
+    g_source_unref(c->in_src);
+    if (c->out_src != NULL)
+    {
+        g_source_destroy(c->out_src);
+        g_source_unref(c->out_src);
+    }
+    if (c->catnums != NULL)
+        g_hash_table_destroy(c->catnums);
+    if (c->cur != NULL)
+        g_bytes_unref(c->cur);
+    g_hash_table_destroy(c->next);
+    g_queue_free(c->order);
+    g_string_free(c->line, TRUE);
+    g_io_stream_close(G_IO_STREAM(c->conn), NULL, NULL);
+    g_object_unref(c->conn);
+    g_free(c);
+}
+
+static gboolean incoming_cb(GSocketService * srv, GSocketConnection * conn,
+                            GObject * source, gpointer data)
+{
+    stream_client_t *c;
+
+    (void)srv;
+    (void)source;
+    (void)data;
+
+    if (g_list_length(clients) >= MAX_CLIENTS)
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Too many clients, connection refused"), __func__);
+        return FALSE;
+    }
+
+    c = g_new0(stream_client_t, 1);
+    c->conn = g_object_ref(conn);
+    c->socket = g_socket_connection_get_socket(conn);
+    c->line = g_string_new(NULL);
+    c->next = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                    (GDestroyNotify) g_bytes_unref);
+    c->order = g_queue_new();
+    g_socket_set_blocking(c->socket, FALSE);
+
+    c->in_src = g_socket_create_source(c->socket,
+                                       G_IO_IN | G_IO_HUP | G_IO_ERR, NULL);
+    g_source_set_callback(c->in_src, (GSourceFunc) client_in_cb, c, NULL);
+    g_source_attach(c->in_src, NULL);
+
+    clients = g_list_prepend(clients, c);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Client connected"), __func__);
+
+    return TRUE;
+}
+
+/**
+ * Start the stream server.
+ *
+ * @return TRUE if the server is listening, FALSE if it is disabled or
+ *         could not be started.
+ */
+gboolean sat_stream_start(void)
+{
+    GSocketAddress *addr = NULL;
+    GInetAddress   *inet;
+    GError         *err = NULL;
+    gchar          *path;
+    gint            port;
+
+    if (service != NULL)
+        return TRUE;
+
+    path = sat_cfg_get_str(SAT_CFG_STR_STREAM_SOCKET);
+    port = sat_cfg_get_int(SAT_CFG_INT_STREAM_PORT);
+
+#ifdef HAVE_GIO_UNIX
+    if (path != NULL && path[0] != '\0')
+    {
+        if (!remove_stale_socket(path))
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not start stream server "
+                          "(%s exists and is not a socket)"), __func__, path);
+            g_free(path);
+            return FALSE;
+        }
+        addr = g_unix_socket_address_new(path);
+        sockpath = path;
+        path = NULL;
+    }
+#endif
+    g_free(path);
+
+    if (addr == NULL)
+    {
+        if (port <= 0)
+            return FALSE;
+
+        inet = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+        addr = g_inet_socket_address_new(inet, port);
+        g_object_unref(inet);
+    }
+
+    service = g_socket_service_new();
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), addr,
+                                       G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL,
+                                       &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not start stream server (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        g_object_unref(addr);
+        g_object_unref(service);
+        service = NULL;
+        g_free(sockpath);
+        sockpath = NULL;
+
+        return FALSE;
+    }
+    g_object_unref(addr);
+
+    g_signal_connect(service, "incoming", G_CALLBACK(incoming_cb), NULL);
+    g_socket_service_start(service);
+
+    if (sockpath != NULL)
+        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Streaming on %s"),
+                    __func__, sockpath);
+    else
+        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Streaming on port %d"),
+                    __func__, port);
+
+    return TRUE;
+}
+
+/** Stop the stream server and disconnect the clients. */
+void sat_stream_stop(void)
+{
+    if (service == NULL)
+        return;
+
+    while (clients != NULL)
+        client_free(clients->data);
+
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    g_object_unref(service);
+    service = NULL;
+
+    if (sockpath != NULL)
+    {
+        g_unlink(sockpath);
+        g_free(sockpath);
+        sockpath = NULL;
+    }
+}
+
+/**
+ * Publish the state of the satellites of a module.
+ *
+ * @param module The name of the module.
+ * @param sats The satellites of the module.
+ * @param t The time of the state (Julian date).
+ *
+ * This is called in every module cycle. The state is packed once; clients
+ * that subscribe to all satellites share the same frame. Sending never
+ * blocks, see client_queue().
+ */
+void sat_stream_publish(const gchar * module, GHashTable * sats, gdouble t)
+{
+    stream_client_t *c;
+    GBytes         *packed;
+    GBytes         *json = NULL;
+    GBytes         *frame;
+    GList          *iter, *next;
+
+    if (clients == NULL || sats == NULL)
+        return;
+
+    packed = pack_frame(module, sats, t);
+
+    for (iter = clients; iter != NULL; iter = next)
+    {
+        next = iter->next;
+        c = iter->data;
+
+        if (c->catnums != NULL)
+        {
+            frame = c->binary ? subset_frame(packed, c) :
+                json_frame(packed, c);
+        }
+        else if (c->binary)
+        {
+            frame = g_bytes_ref(packed);
+        }
+        else
+        {
+            if (json == NULL)
+                json = json_frame(packed, NULL);
+            frame = g_bytes_ref(json);
+        }
+
+        if (!client_queue(c, module != NULL ? module : "", frame))
+            client_free(c);
+    }
+
+    g_bytes_unref(packed);
+    if (json != NULL)
+        g_bytes_unref(json);
+}
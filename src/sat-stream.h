@@ -0,0 +1,80 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_STREAM_H
+#define SAT_STREAM_H 1
+
+#include <glib.h>
+
+/*
+ * Live tracking state stream.
+ *
+ * Every module cycle publishes a frame with the state of its satellites to
+ * the connected clients. The server listens on a UNIX socket if
+ * STREAM/SOCKET is set and the platform supports it, otherwise on
+ * 127.0.0.1:STREAM/PORT. A port of 0 disables the server.
+ *
+ * Clients may send newline terminated commands:
+ *
+ *   SUB * | SUB catnum [catnum ...]   select all or add satellites
+ *   UNSUB catnum [catnum ...]         remove satellites
+ *   FMT json | FMT bin                select the frame format
+ *
+ * The default is all satellites in JSON format. A JSON frame is one line:
+ *
+ *   {"t":jd,"module":"name","sats":[{"catnum":n,"az":deg,"el":deg,
+ *    "range":km,"range_rate":km/s,"ssplat":deg,"ssplon":deg,
+ *    "aos":jd,"los":jd},...]}
+ *
+ * A binary frame is a header followed by the records, little endian:
+ *
+ *    0  char[4]   magic "GPST"
+ *    4  uint16    version (1)
+ *    6  uint16    number of records
+ *    8  float64   time (Julian date, UTC)
+ *   16  char[24]  module name, NUL padded
+ *   40  sat_stream_rec_t[]
+ *
+ * A client that can not keep up gets the latest frame of each module only;
+ * stale frames are dropped and never block the module cycle.
+ */
+
+#define SAT_STREAM_MAGIC   "GPST"
+#define SAT_STREAM_VERSION 1
+#define SAT_STREAM_HDRSIZE 40
+
+/** Binary stream record. */
+typedef struct {
+    gint32          catnum;     /*!< Catalogue number */
+    guint32         reserved;   /*!< Reserved, always 0 */
+    gfloat          az;         /*!< Azimuth [deg] */
+    gfloat          el;         /*!< Elevation [deg] */
+    gfloat          range;      /*!< Range [km] */
+    gfloat          range_rate; /*!< Range rate [km/sec] */
+    gfloat          ssplat;     /*!< SSP latitude [deg] */
+    gfloat          ssplon;     /*!< SSP longitude [deg] */
+    gdouble         aos;        /*!< Next AOS (Julian date) or 0 */
+    gdouble         los;        /*!< Next LOS (Julian date) or 0 */
+} sat_stream_rec_t;
+
+gboolean        sat_stream_start(void);
+void            sat_stream_stop(void);
+void            sat_stream_publish(const gchar * module, GHashTable * sats,
+                                   gdouble t);
+
+#endif
@@ -0,0 +1,299 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Span tracing in the Chrome trace event format.
+ *
+ * Every thread that records a span gets a buffer the first time, which is
+ * kept in a global list until the trace is written so that the spans of
+ * pool threads that have exited are not lost. A buffer is only locked by
+ * its own thread while recording, so the threads do not contend with each
+ * other. A buffer stops recording when it holds SAT_TRACE_MAX_EVENTS
+ * events, and the number of dropped events is logged.
+ *
+ * The spans are written as complete events ("ph":"X") with the time in
+ * microseconds since sat_trace_start(), and the instants as thread scoped
+ * instant events ("ph":"i").
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+
+#include "sat-log.h"
+#include "sat-trace.h"
+
+/* max number of events recorded by one thread */
+#define SAT_TRACE_MAX_EVENTS 262144
+
+typedef struct {
+    const gchar    *cat;
+    const gchar    *name;
+    gchar          *arg;
+    gint64          ts;         /* usec since trace_start */
+    gint64          dur;        /* usec, -1 for instant events */
+} trace_event_t;
+
+typedef struct {
+    guint           tid;
+    GArray         *events;     /* trace_event_t */
+    guint           dropped;
+    GMutex          lock;
+} trace_buf_t;
+
+/* read by all threads, so only accessed with the atomic operations */
+gint            sat_trace_on = FALSE;
+
+static gchar   *trace_file = NULL;
+static gint64   trace_start = 0;
+static guint    trace_main_tid = 0;
+static GSList  *buffers = NULL;
+static guint    next_tid = 1;
+static GMutex   buffers_lock;
+static GPrivate thread_buf = G_PRIVATE_INIT(NULL);
+
+/* Get the buffer of the calling thread */
+static trace_buf_t *get_buf(void)
+{
+    trace_buf_t    *buf = g_private_get(&thread_buf);
+
+    if (buf != NULL)
+        return buf;
+
+    buf = g_new0(trace_buf_t, 1);
+    buf->events = g_array_new(FALSE, FALSE, sizeof(trace_event_t));
+    g_mutex_init(&buf->lock);
+
+    g_mutex_lock(&buffers_lock);
+    buf->tid = next_tid++;
+    buffers = g_slist_prepend(buffers, buf);
+    g_mutex_unlock(&buffers_lock);
+
+    g_private_set(&thread_buf, buf);
+
+    return buf;
+}
+
+static void record(const gchar * cat, const gchar * name, gint64 start,
+                   gint64 dur, const gchar * arg)
+{
+    trace_buf_t    *buf = get_buf();
+    trace_event_t   ev;
+
+    g_mutex_lock(&buf->lock);
+    if (buf->events->len < SAT_TRACE_MAX_EVENTS)
+    {
+        ev.cat = cat;
+        ev.name = name;
+        ev.arg = g_strdup(arg);
+        ev.ts = start - trace_start;
+        ev.dur = dur;
+        g_array_append_val(buf->events, ev);
+    }
+    else
+    {
+        buf->dropped++;
+    }
+    g_mutex_unlock(&buf->lock);
+}
+
+/**
+ * Start tracing.
+ *
+ * @param filename The file where the trace is written by sat_trace_stop().
+ *
+ * The calling thread is named "main" in the trace.
+ */
+void sat_trace_start(const gchar * filename)
+{
+    if (g_atomic_int_get(&sat_trace_on))
+        return;
+
+    g_free(trace_file);
+    trace_file = g_strdup(filename);
+    trace_start = g_get_monotonic_time();
+    trace_main_tid = get_buf()->tid;
+    g_atomic_int_set(&sat_trace_on, TRUE);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Tracing to %s"), __func__,
+                filename);
+}
+
+/**
+ * Record a span.
+ *
+ * @param cat The category of the span.
+ * @param name The name of the span.
+ * @param start The value returned by sat_trace_begin() at the start.
+ */
+void sat_trace_end(const gchar * cat, const gchar * name, gint64 start)
+{
+    if (start == 0 || !g_atomic_int_get(&sat_trace_on))
+        return;
+
+    record(cat, name, start, g_get_monotonic_time() - start, NULL);
+}
+
+/**
+ * Record a span with an argument, e.g. a module name or a command.
+ *
+ * @param cat The category of the span.
+ * @param name The name of the span.
+ * @param start The value returned by sat_trace_begin() at the start.
+ * @param arg The argument shown with the span, or NULL.
+ */
+void sat_trace_end_arg(const gchar * cat, const gchar * name, gint64 start,
+                       const gchar * arg)
+{
+    if (start == 0 || !g_atomic_int_get(&sat_trace_on))
+        return;
+
+    record(cat, name, start, g_get_monotonic_time() - start, arg);
+}
+
+/**
+ * Record an instant event, e.g. a missed deadline.
+ *
+ * @param cat The category of the event.
+ * @param name The name of the event.
+ * @param arg The argument shown with the event, or NULL.
+ */
+void sat_trace_instant(const gchar * cat, const gchar * name,
+                       const gchar * arg)
+{
+    if (!g_atomic_int_get(&sat_trace_on))
+        return;
+
+    record(cat, name, g_get_monotonic_time(), -1, arg);
+}
+
+/* Write a JSON string */
+static void write_str(FILE * fp, const gchar * str)
+{
+    const guchar   *c;
+
+    fputc('"', fp);
+    for (c = (const guchar *)str; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fprintf(fp, "\\%c", *c);
+        else if (*c < 0x20)
+            fprintf(fp, "\\u%04x", *c);
+        else
+            fputc(*c, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_event(FILE * fp, const trace_event_t * ev, guint tid)
+{
+    fputs(",\n{\"name\":", fp);
+    write_str(fp, ev->name);
+    fputs(",\"cat\":", fp);
+    write_str(fp, ev->cat);
+    if (ev->dur < 0)
+        fprintf(fp, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" G_GINT64_FORMAT,
+                ev->ts);
+    else
+        fprintf(fp, ",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT
+                ",\"dur\":%" G_GINT64_FORMAT, ev->ts, ev->dur);
+    fprintf(fp, ",\"pid\":1,\"tid\":%u", tid);
+    if (ev->arg != NULL)
+    {
+        fputs(",\"args\":{\"arg\":", fp);
+        write_str(fp, ev->arg);
+        fputc('}', fp);
+    }
+    fputc('}', fp);
+}
+
+/**
+ * Stop tracing and write the trace file.
+ *
+ * The buffers are emptied, so tracing can be started again.
+ */
+void sat_trace_stop()
+{
+    trace_buf_t    *buf;
+    trace_event_t  *ev;
+    GSList         *node;
+    FILE           *fp;
+    guint           i, num = 0, dropped = 0;
+
+    if (!g_atomic_int_get(&sat_trace_on))
+        return;
+
+    g_atomic_int_set(&sat_trace_on, FALSE);
+
+    fp = g_fopen(trace_file, "w");
+    if (fp == NULL)
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not write %s"),
+                    __func__, trace_file);
+    else
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+              "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"args\":{\"name\":\"gpredict\"}}", fp);
+
+    g_mutex_lock(&buffers_lock);
+    for (node = buffers; node != NULL; node = node->next)
+    {
+        buf = node->data;
+
+        g_mutex_lock(&buf->lock);
+        if (fp != NULL)
+        {
+            fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    "\"tid\":%u,\"args\":{\"name\":", buf->tid);
+            if (buf->tid == trace_main_tid)
+                write_str(fp, "main");
+            else
+                fprintf(fp, "\"thread %u\"", buf->tid);
+            fputs("}}", fp);
+        }
+
+        for (i = 0; i < buf->events->len; i++)
+        {
+            ev = &g_array_index(buf->events, trace_event_t, i);
+            if (fp != NULL)
+                write_event(fp, ev, buf->tid);
+            g_free(ev->arg);
+        }
+
+        num += buf->events->len;
+        dropped += buf->dropped;
+        g_array_set_size(buf->events, 0);
+        buf->dropped = 0;
+        g_mutex_unlock(&buf->lock);
+    }
+    g_mutex_unlock(&buffers_lock);
+
+    if (fp == NULL)
+        return;
+
+    fputs("\n]}\n", fp);
+    fclose(fp);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Wrote %d events to %s (%d dropped)"),
+                __func__, num, trace_file, dropped);
+}
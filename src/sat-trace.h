@@ -0,0 +1,57 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_TRACE_H
+#define SAT_TRACE_H 1
+
+#include <glib.h>
+
+/*
+ * Span tracing (--trace FILE).
+ *
+ * Code paths that may make the tracker stutter record spans while tracing
+ * is enabled:
+ *
+ *   gint64 start = sat_trace_begin();
+ *   ...
+ *   sat_trace_end("module", "update views", start);
+ *
+ * sat_trace_begin() returns 0 when tracing is off and sat_trace_end() does
+ * nothing for a start of 0, so a disabled span costs a flag test and a
+ * function call. Each thread records into its own buffer. The spans are
+ * written in the Chrome trace event format when tracing is stopped and can
+ * be opened in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * The category and name must be string literals or otherwise live until
+ * the trace is written; the argument of sat_trace_end_arg() is copied.
+ */
+extern gint     sat_trace_on;
+
+#define sat_trace_begin() \
+    (G_UNLIKELY(g_atomic_int_get(&sat_trace_on)) ? g_get_monotonic_time() : 0)
+
+void            sat_trace_start(const gchar * filename);
+void            sat_trace_stop(void);
+void            sat_trace_end(const gchar * cat, const gchar * name,
+                              gint64 start);
+void            sat_trace_end_arg(const gchar * cat, const gchar * name,
+                                  gint64 start, const gchar * arg);
+void            sat_trace_instant(const gchar * cat, const gchar * name,
+                                  const gchar * arg);
+
+#endif
@@ -54,10 +54,26 @@ static gchar *VIS2STR[SAT_VIS_NUM] = {
  */
 sat_vis_t
 get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc)
+{
+    return get_sat_vis_thld (sat, qth, jul_utc,
+                             (gdouble) sat_cfg_get_int (SAT_CFG_INT_PRED_TWILIGHT_THLD));
+}
+
+
+/** \brief Calculate satellite visibility with a given twilight threshold.
+ *  \param sat The satellite structure.
+ *  \param qth The QTH
+ *  \param jul_utc The time at which the visibility should be calculated.
+ *  \param threshold The highest solar elevation for a visible pass [deg].
+ *  \return The visiblity code.
+ *
+ * Does not use sat-cfg and may be called from any thread.
+ */
+sat_vis_t
+get_sat_vis_thld (sat_t *sat, qth_t *qth, gdouble jul_utc, gdouble threshold)
 {
     gboolean sat_sun_status;
     gdouble  sun_el;
-    gdouble  threshold;
     gdouble  eclipse_depth;
     sat_vis_t vis = SAT_VIS_NONE;
     vector_t zero_vector = {0,0,0,0};
@@ -69,11 +85,7 @@ get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc)
     /* Solar observed az and el vector  */
     obs_set_t solar_set;
 
-    /* FIXME: could be passed as parameter */
-    obs_geodetic.lon = qth->lon * de2ra;
-    obs_geodetic.lat = qth->lat * de2ra;
-    obs_geodetic.alt = qth->alt / 1000.0;
-    obs_geodetic.theta = 0;
+    qth_data_get_obs (qth, jul_utc, &obs_geodetic, NULL);
 
 
     Calculate_Solar_Position (jul_utc, &solar_vector);
@@ -91,8 +103,7 @@ get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc)
 
     if (sat_sun_status) {
         sun_el = Degrees (solar_set.el);
-        threshold = (gdouble) sat_cfg_get_int (SAT_CFG_INT_PRED_TWILIGHT_THLD);
-        
+
         if (sun_el <= threshold && sat->el >= 0.0)
             vis = SAT_VIS_VISIBLE;
         else
@@ -30,6 +30,7 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "pass-export.h"
 #include "pass-to-txt.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
@@ -48,8 +49,11 @@ static void     save_passes_exec(GtkWidget * parent,
                                  GSList * passes, qth_t * qth,
                                  const gchar * savedir, const gchar * savefile,
                                  gint format, gint contents);
-static void     save_to_file(GtkWidget * parent, const gchar * fname,
-                             const gchar * data);
+static pass_export_t *open_file(GtkWidget * parent, const gchar * fname,
+                                gint format, qth_t * qth);
+static void     close_file(GtkWidget * parent, const gchar * fname,
+                           pass_export_t * exp);
+static GtkWidget *create_format_combo(void);
 
 enum pass_content_e {
     PASS_CONTENT_ALL = 0,
@@ -62,8 +66,6 @@ enum passes_content_e {
     PASSES_CONTENT_SUM,
 };
 
-#define SAVE_FORMAT_TXT     0
-
 /**
  * Save a satellite pass.
  *
@@ -86,6 +88,7 @@ void save_pass(GtkWidget * parent)
     GtkWidget      *dirchooser;
     GtkWidget      *filchooser;
     GtkWidget      *contents;
+    GtkWidget      *format;
     GtkWidget      *label;
     gint            response;
     pass_t         *pass;
@@ -93,6 +96,7 @@ void save_pass(GtkWidget * parent)
     gchar          *savedir = NULL;
     gchar          *savefile;
     gint            cont;
+    gint            fmt;
 
 
     /* get data attached to parent */
@@ -172,6 +176,15 @@ void save_pass(GtkWidget * parent)
                              sat_cfg_get_int(SAT_CFG_INT_PRED_SAVE_CONTENTS));
     gtk_grid_attach(GTK_GRID(grid), contents, 1, 2, 1, 1);
 
+    /* file format */
+    label = gtk_label_new(_("File format:"));
+    g_object_set(G_OBJECT(label), "halign", GTK_ALIGN_START,
+                 "valign", GTK_ALIGN_CENTER, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 3, 1, 1);
+
+    format = create_format_combo();
+    gtk_grid_attach(GTK_GRID(grid), format, 1, 3, 1, 1);
+
     gtk_widget_show_all(grid);
     gtk_container_add(GTK_CONTAINER
                       (gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
@@ -188,14 +201,15 @@ void save_pass(GtkWidget * parent)
         savedir = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dirchooser));
         savefile = g_strdup(gtk_entry_get_text(GTK_ENTRY(filchooser)));
         cont = gtk_combo_box_get_active(GTK_COMBO_BOX(contents));
+        fmt = gtk_combo_box_get_active(GTK_COMBO_BOX(format));
 
         /* call saver */
-        save_pass_exec(dialog, pass, qth, savedir, savefile, SAVE_FORMAT_TXT,
-                       cont);
+        save_pass_exec(dialog, pass, qth, savedir, savefile, fmt, cont);
 
         /* store new settings */
         sat_cfg_set_str(SAT_CFG_STR_PRED_SAVE_DIR, savedir);
         sat_cfg_set_int(SAT_CFG_INT_PRED_SAVE_CONTENTS, cont);
+        sat_cfg_set_int(SAT_CFG_INT_PRED_SAVE_FORMAT, fmt);
 
         /* clean up */
         g_free(savedir);
@@ -233,6 +247,7 @@ void save_passes(GtkWidget * parent)
     GtkWidget      *dirchooser;
     GtkWidget      *filchooser;
     GtkWidget      *contents;
+    GtkWidget      *format;
     GtkWidget      *label;
     gint            response;
     GSList         *passes;
@@ -241,6 +256,7 @@ void save_passes(GtkWidget * parent)
     gchar          *savedir = NULL;
     gchar          *savefile;
     gint            cont;
+    gint            fmt;
 
     /* get data attached to parent */
     sat = (gchar *) g_object_get_data(G_OBJECT(parent), "sat");
@@ -315,6 +331,15 @@ void save_passes(GtkWidget * parent)
     gtk_combo_box_set_active(GTK_COMBO_BOX(contents), 0);
     gtk_grid_attach(GTK_GRID(grid), contents, 1, 2, 1, 1);
 
+    /* file format */
+    label = gtk_label_new(_("File format:"));
+    g_object_set(G_OBJECT(label), "halign", GTK_ALIGN_START,
+                 "valign", GTK_ALIGN_CENTER, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 3, 1, 1);
+
+    format = create_format_combo();
+    gtk_grid_attach(GTK_GRID(grid), format, 1, 3, 1, 1);
+
     gtk_widget_show_all(grid);
     gtk_container_add(GTK_CONTAINER
                       (gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
@@ -331,13 +356,14 @@ void save_passes(GtkWidget * parent)
         savedir = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dirchooser));
         savefile = g_strdup(gtk_entry_get_text(GTK_ENTRY(filchooser)));
         cont = gtk_combo_box_get_active(GTK_COMBO_BOX(contents));
+        fmt = gtk_combo_box_get_active(GTK_COMBO_BOX(format));
 
         /* call saver */
-        save_passes_exec(dialog, passes, qth, savedir, savefile,
-                         SAVE_FORMAT_TXT, cont);
+        save_passes_exec(dialog, passes, qth, savedir, savefile, fmt, cont);
 
         /* store new settings */
         sat_cfg_set_str(SAT_CFG_STR_PRED_SAVE_DIR, savedir);
+        sat_cfg_set_int(SAT_CFG_INT_PRED_SAVE_FORMAT, fmt);
 
         /* clean up */
         g_free(savedir);
@@ -426,78 +452,74 @@ static void save_passes_exec(GtkWidget * parent,
                              const gchar * savedir, const gchar * savefile,
                              gint format, gint contents)
 {
+    pass_export_t  *exp;
     gchar          *fname;
-    gchar          *pgheader;
-    gchar          *tblheader;
-    gchar          *tblcontents;
-    gchar          *buff = NULL;
-    gchar          *data = NULL;
+    gchar          *buff;
+    GSList         *iter;
     pass_t         *pass;
     gint            fields;
-    guint           i, n;
 
-    switch (format)
+    if (format < 0 || format >= PASS_EXPORT_NUM)
     {
-    case SAVE_FORMAT_TXT:
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Invalid file format: %d"), __func__, format);
+        return;
+    }
 
-        /* prepare full file name */
-        fname =
-            g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile, ".txt", NULL);
+    fname = g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile,
+                        pass_export_extension(format), NULL);
+    exp = open_file(parent, fname, format, qth);
+    if (exp == NULL)
+    {
+        g_free(fname);
+        return;
+    }
 
-        /* get visible columns for summary */
-        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_MULTI_COL);
+    /* page header and summary; a CSV file can only hold one table so the
+       complete report there is the details of all passes, while the binary
+       ephemeris has no summary and always gets the details */
+    buff = passes_to_txt_pgheader(passes, qth, 0);
+    pass_export_text(exp, buff);
+    g_free(buff);
 
-        /* create file contents */
-        pgheader = passes_to_txt_pgheader(passes, qth, fields);
-        tblheader = passes_to_txt_tblheader(passes, qth, fields);
-        tblcontents = passes_to_txt_tblcontents(passes, qth, fields);
+    if (format != PASS_EXPORT_CSV || contents == PASSES_CONTENT_SUM)
+    {
+        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_MULTI_COL);
+        pass_export_summary_header(exp, passes, fields);
+        pass_export_summary(exp, passes, fields);
+    }
 
-        data = g_strconcat(pgheader, tblheader, tblcontents, NULL);
+    if (contents == PASSES_CONTENT_FULL && format != PASS_EXPORT_BIN)
+    {
+        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
 
-        g_free(pgheader);
-        g_free(tblheader);
-        g_free(tblcontents);
+        if (format == PASS_EXPORT_CSV)
+            pass_export_details_header(exp, PASS(passes->data), fields);
 
-        if (contents == PASSES_CONTENT_FULL)
+        for (iter = passes; iter != NULL; iter = iter->next)
         {
-            fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
-            n = g_slist_length(passes);
+            pass = PASS(iter->data);
 
-            for (i = 0; i < n; i++)
+            if (format == PASS_EXPORT_TXT)
             {
-
-                pass = PASS(g_slist_nth_data(passes, i));
-
-                tblheader = pass_to_txt_tblheader(pass, qth, fields);
-                tblcontents = pass_to_txt_tblcontents(pass, qth, fields);
-                buff = g_strdup_printf("%s\n Orbit %d\n%s%s",
-                                       data, pass->orbit,
-                                       tblheader, tblcontents);
-                g_free(data);
-                data = g_strdup(buff);
+                buff = g_strdup_printf("\n Orbit %d\n", pass->orbit);
+                pass_export_text(exp, buff);
                 g_free(buff);
-
+                pass_export_details_header(exp, pass, fields);
             }
+            pass_export_details(exp, pass, fields);
         }
-
-        /* save data */
-        save_to_file(parent, fname, data);
-        g_free(data);
-        g_free(fname);
-        break;
-
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Invalid file format: %d"), __func__, format);
-        break;
     }
+
+    close_file(parent, fname, exp);
+    g_free(fname);
 }
 
 /**
  * Save data to file.
  *
  * @param parent Parent window (needed for error dialogs).
- * @param passes The pass data to save.
+ * @param pass The pass data to save.
  * @param qth The observer data
  * @param savedir The directory where data should be saved.
  * @param savefile The file where data should be saved.
@@ -506,158 +528,123 @@ static void save_passes_exec(GtkWidget * parent,
  *
  * This is the function that does the actual saving to a data file once all
  * required information has been gathered (i.e. file name, format, contents).
- * The function does some last minute checking while saving and provides
- * error messages if anything fails during the process.
- *
- * @note The formatting is done by external functions according to the selected
- *       file format.
+ * The rows are streamed to the file by the pass exporter, which also
+ * takes care of the format specific details.
  */
 static void save_pass_exec(GtkWidget * parent,
                            pass_t * pass, qth_t * qth,
                            const gchar * savedir, const gchar * savefile,
                            gint format, gint contents)
 {
+    pass_export_t  *exp;
     gchar          *fname;
-    gchar          *pgheader;
-    gchar          *tblheader;
-    gchar          *tblcontents;
-    gchar          *buff = NULL;
-    gchar          *data = NULL;
+    gchar          *buff;
     gint            fields;
 
-    switch (format)
+    if (format < 0 || format >= PASS_EXPORT_NUM)
     {
-    case SAVE_FORMAT_TXT:
-
-        /* prepare full file name */
-        fname =
-            g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile, ".txt", NULL);
-
-        /* get visible columns */
-        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Invalid file format: %d"), __func__, format);
+        return;
+    }
 
-        /* create file contents */
-        pgheader = pass_to_txt_pgheader(pass, qth, fields);
-        tblheader = pass_to_txt_tblheader(pass, qth, fields);
-        tblcontents = pass_to_txt_tblcontents(pass, qth, fields);
+    fname = g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile,
+                        pass_export_extension(format), NULL);
+    exp = open_file(parent, fname, format, qth);
+    if (exp == NULL)
+    {
+        g_free(fname);
+        return;
+    }
 
-        /* Add page header if selected */
-        if (contents == PASS_CONTENT_ALL)
-        {
-            data = g_strdup(pgheader);
-        }
+    /* get visible columns */
+    fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
 
-        /* Add table header if selected */
-        if ((contents == PASS_CONTENT_ALL) || (contents == PASS_CONTENT_TABLE))
-        {
-            if (data != NULL)
-            {
-                buff = g_strdup(data);
-                g_free(data);
-                data = g_strconcat(buff, tblheader, NULL);
-                g_free(buff);
-            }
-            else
-            {
-                data = g_strdup(tblheader);
-            }
+    /* Add page header if selected */
+    if (contents == PASS_CONTENT_ALL)
+    {
+        buff = pass_to_txt_pgheader(pass, qth, fields);
+        pass_export_text(exp, buff);
+        g_free(buff);
+    }
 
-        }
+    /* Add table header if selected */
+    if ((contents == PASS_CONTENT_ALL) || (contents == PASS_CONTENT_TABLE))
+        pass_export_details_header(exp, pass, fields);
 
-        /* Add data */
-        if (data != NULL)
-        {
-            buff = g_strdup(data);
-            g_free(data);
-            data = g_strconcat(buff, tblcontents, NULL);
-            g_free(buff);
-        }
-        else
-        {
-            data = g_strdup(tblcontents);
-        }
+    /* Add data */
+    pass_export_details(exp, pass, fields);
 
-        /* save data */
-        save_to_file(parent, fname, data);
+    close_file(parent, fname, exp);
+    g_free(fname);
+}
 
-        /* clean up memory */
-        g_free(fname);
-        g_free(data);
-        g_free(pgheader);
-        g_free(tblheader);
-        g_free(tblcontents);
+/* create the file format selector */
+static GtkWidget *create_format_combo(void)
+{
+    GtkWidget      *combo;
+
+    combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), _("Text"));
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo),
+                                   _("Comma separated values (CSV)"));
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo),
+                                   _("Binary ephemeris"));
+    gtk_combo_box_set_active(GTK_COMBO_BOX(combo),
+                             CLAMP(sat_cfg_get_int
+                                   (SAT_CFG_INT_PRED_SAVE_FORMAT), 0,
+                                   PASS_EXPORT_NUM - 1));
+
+    return combo;
+}
 
-        break;
+static void error_dialog(GtkWidget * parent, const gchar * fmt,
+                         const gchar * fname, const gchar * message)
+{
+    GtkWidget      *dialog;
 
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Invalid file format: %d"), __func__, format);
-        break;
-    }
+    dialog = gtk_message_dialog_new(GTK_WINDOW(parent),
+                                    GTK_DIALOG_MODAL |
+                                    GTK_DIALOG_DESTROY_WITH_PARENT,
+                                    GTK_MESSAGE_ERROR,
+                                    GTK_BUTTONS_CLOSE, fmt, fname, message);
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
 }
 
-static void save_to_file(GtkWidget * parent, const gchar * fname,
-                         const gchar * data)
+static pass_export_t *open_file(GtkWidget * parent, const gchar * fname,
+                                gint format, qth_t * qth)
 {
-    GIOChannel     *chan;
+    pass_export_t  *exp;
     GError         *err = NULL;
-    GtkWidget      *dialog;
-    gsize           count;
 
-    /* create file */
-    chan = g_io_channel_new_file(fname, "w", &err);
-    if (err != NULL)
+    exp = pass_export_new_file(fname, format, qth, &err);
+    if (exp == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: Could not create file %s (%s)"),
                     __func__, fname, err->message);
-
-        /* error dialog */
-        dialog = gtk_message_dialog_new(GTK_WINDOW(parent),
-                                        GTK_DIALOG_MODAL |
-                                        GTK_DIALOG_DESTROY_WITH_PARENT,
-                                        GTK_MESSAGE_ERROR,
-                                        GTK_BUTTONS_CLOSE,
-                                        _("Could not create file %s\n\n%s"),
-                                        fname, err->message);
-        gtk_dialog_run(GTK_DIALOG(dialog));
-        gtk_widget_destroy(dialog);
-
-        /* clean up and return */
+        error_dialog(parent, _("Could not create file %s\n\n%s"),
+                     fname, err->message);
         g_clear_error(&err);
-
-        return;
     }
 
-    /* save contents to file */
-    g_io_channel_write_chars(chan, data, -1, &count, &err);
-    if (err != NULL)
+    return exp;
+}
+
+static void close_file(GtkWidget * parent, const gchar * fname,
+                       pass_export_t * exp)
+{
+    GError         *err = NULL;
+
+    if (!pass_export_close(exp, &err))
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: An error occurred while saving data to %s (%s)"),
                     __func__, fname, err->message);
-
-        dialog = gtk_message_dialog_new(GTK_WINDOW(parent),
-                                        GTK_DIALOG_MODAL |
-                                        GTK_DIALOG_DESTROY_WITH_PARENT,
-                                        GTK_MESSAGE_ERROR,
-                                        GTK_BUTTONS_CLOSE,
-                                        _
-                                        ("An error occurred while saving data to %s\n\n%s"),
-                                        fname, err->message);
-        gtk_dialog_run(GTK_DIALOG(dialog));
-        gtk_widget_destroy(dialog);
+        error_dialog(parent,
+                     _("An error occurred while saving data to %s\n\n%s"),
+                     fname, err->message);
         g_clear_error(&err);
     }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s: Written %d characters to %s"),
-                    __func__, count, fname);
-    }
-
-    /* close file, we don't care about errors here */
-    g_io_channel_shutdown(chan, TRUE, NULL);
-    g_io_channel_unref(chan);
-
 }
@@ -0,0 +1,287 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Ephemeris and event table used while scrubbing with the time controller.
+ *
+ * When the user drags the time slider, the module time can jump by hours
+ * between two cycles. Running find_aos() and find_los() for every satellite
+ * at each of those jumps makes the module miss its deadline. Instead, the
+ * module builds a table covering a window around the current time in a
+ * background thread. Each satellite gets an ephemeris cache filled for the
+ * whole window and the sorted lists of AOS and LOS times within the window
+ * plus the look-ahead time. Queries are then interpolation and a binary
+ * search.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "scrub-table.h"
+
+
+static void scrub_sat_free(gpointer data)
+{
+    scrub_sat_t    *ssat = data;
+
+    ephem_cache_free(ssat->ephem);
+    Sat_Release(&ssat->sat);
+    g_array_unref(ssat->aos);
+    g_array_unref(ssat->los);
+    g_free(ssat);
+}
+
+static void scrub_table_unref(scrub_table_t * table)
+{
+    if (!g_atomic_int_dec_and_test(&table->refcount))
+        return;
+
+    g_hash_table_destroy(table->index);
+    g_ptr_array_free(table->sats, TRUE);
+    g_free(table);
+}
+
+static void store_sat(gpointer key, gpointer value, gpointer user_data)
+{
+    scrub_table_t  *table = user_data;
+    sat_t          *sat = SAT(value);
+    scrub_sat_t    *ssat;
+
+    (void)key;
+
+    ssat = g_new(scrub_sat_t, 1);
+    ssat->catnum = sat->tle.catnr;
+    Sat_Copy(&ssat->sat, sat);
+    ssat->ephem = ephem_cache_new(sat, 0.0);
+    ssat->ephem->autofill = FALSE;
+    ssat->aos = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    ssat->los = g_array_new(FALSE, FALSE, sizeof(gdouble));
+
+    g_ptr_array_add(table->sats, ssat);
+    g_hash_table_insert(table->index, &ssat->catnum, ssat);
+}
+
+/**
+ * Find events for one satellite.
+ *
+ * The AOS and LOS times are searched separately so that a pass in progress
+ * at t0 gets its LOS, and a pass in progress at tend gets its AOS.
+ */
+static void find_events(scrub_table_t * table, scrub_sat_t * ssat)
+{
+    sat_t          *sat = &ssat->sat;
+    qth_t          *qth = &table->qth;
+    gdouble         tend = table->t1 + table->maxdt;
+    gdouble         t;
+
+    if (!has_aos(sat, qth))
+        return;
+
+    t = table->t0;
+    while (t < tend && !g_atomic_int_get(&table->cancel))
+    {
+        t = find_aos(sat, qth, t, tend - t);
+        if (t <= 0.0)
+            break;
+
+        g_array_append_val(ssat->aos, t);
+        t += 0.001;
+    }
+
+    t = table->t0;
+    while (t < tend && !g_atomic_int_get(&table->cancel))
+    {
+        t = find_los(sat, qth, t, tend - t);
+        if (t <= 0.0)
+            break;
+
+        g_array_append_val(ssat->los, t);
+        t += 0.001;
+    }
+}
+
+static gpointer scrub_table_build(gpointer data)
+{
+    scrub_table_t  *table = data;
+    scrub_sat_t    *ssat;
+    guint           i;
+
+    for (i = 0; i < table->sats->len; i++)
+    {
+        if (g_atomic_int_get(&table->cancel))
+            break;
+
+        ssat = g_ptr_array_index(table->sats, i);
+        ephem_cache_fill(ssat->ephem, table->t0 - 2.0 * ssat->ephem->step,
+                         table->t1 + 2.0 * ssat->ephem->step);
+        find_events(table, ssat);
+    }
+
+    if (!g_atomic_int_get(&table->cancel))
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Scrub table for %d satellites ready"),
+                    __func__, table->sats->len);
+        g_atomic_int_set(&table->ready, 1);
+    }
+
+    scrub_table_unref(table);
+
+    return NULL;
+}
+
+/**
+ * Create a new scrub table.
+ *
+ * @param sats The satellites of the module (catnum -> sat_t).
+ * @param qth The observer.
+ * @param t0 The start of the time window.
+ * @param t1 The end of the time window.
+ * @return A new table, which should be freed with scrub_table_free().
+ *
+ * The satellites and the QTH are copied so they can be modified or freed
+ * while the table is built in the background.
+ */
+scrub_table_t  *scrub_table_new(GHashTable * sats, qth_t * qth,
+                                gdouble t0, gdouble t1)
+{
+    scrub_table_t  *table;
+    GThread        *thread;
+
+    table = g_new0(scrub_table_t, 1);
+    table->t0 = t0;
+    table->t1 = t1;
+    table->maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+    memcpy(&table->qth, qth, sizeof(qth_t));
+    qth_small_save(qth, &table->qth_comp);
+    table->sats = g_ptr_array_new_with_free_func(scrub_sat_free);
+    table->index = g_hash_table_new(g_int_hash, g_int_equal);
+    table->refcount = 2;
+
+    g_hash_table_foreach(sats, store_sat, table);
+
+    thread = g_thread_new("gpredict_scrub", scrub_table_build, table);
+    g_thread_unref(thread);
+
+    return table;
+}
+
+/**
+ * Free a scrub table.
+ *
+ * @param table The table to free.
+ *
+ * If the table is still being built, the build is cancelled and the
+ * memory is released by the build thread when it exits.
+ */
+void scrub_table_free(scrub_table_t * table)
+{
+    if (table == NULL)
+        return;
+
+    g_atomic_int_set(&table->cancel, 1);
+    scrub_table_unref(table);
+}
+
+/**
+ * Check whether the table can be used.
+ *
+ * @param table The scrub table.
+ * @param qth The current observer.
+ * @param t The time.
+ * @return TRUE if the table is ready, covers t and was built for this
+ *         location.
+ */
+gboolean scrub_table_covers(scrub_table_t * table, qth_t * qth, gdouble t)
+{
+    if (table == NULL || !g_atomic_int_get(&table->ready))
+        return FALSE;
+
+    if (t < table->t0 || t > table->t1)
+        return FALSE;
+
+    return qth_small_dist(qth, table->qth_comp) < 1.0;
+}
+
+/** Get the first time in a sorted array that is later than t. */
+static gdouble next_event(GArray * events, gdouble t, gdouble maxdt)
+{
+    guint           lo = 0;
+    guint           hi = events->len;
+    guint           mid;
+    gdouble         next;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (g_array_index(events, gdouble, mid) <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == events->len)
+        return 0.0;
+
+    next = g_array_index(events, gdouble, lo);
+
+    /* find_aos() and find_los() return 0.0 beyond the look-ahead time */
+    return (next - t > maxdt) ? 0.0 : next;
+}
+
+/**
+ * Calculate satellite data from the scrub table.
+ *
+ * @param table The scrub table.
+ * @param sat The satellite to update.
+ * @param qth The observer.
+ * @param t The time.
+ * @return TRUE if the satellite data has been updated, FALSE if the table
+ *         could not be used, in which case sat is not modified.
+ *
+ * This function updates the same fields as predict_calc() and also sets
+ * the AOS and LOS times like the module would do using find_aos() and
+ * find_los().
+ */
+gboolean scrub_table_calc(scrub_table_t * table, sat_t * sat, qth_t * qth,
+                          gdouble t)
+{
+    scrub_sat_t    *ssat;
+
+    if (!scrub_table_covers(table, qth, t))
+        return FALSE;
+
+    ssat = g_hash_table_lookup(table->index, &sat->tle.catnr);
+    if (ssat == NULL)
+        return FALSE;
+
+    ephem_cache_calc(ssat->ephem, sat, qth, t);
+    sat->aos = next_event(ssat->aos, t, table->maxdt);
+    sat->los = next_event(ssat->los, t, table->maxdt);
+
+    return TRUE;
+}
@@ -0,0 +1,65 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SCRUB_TABLE_H
+#define SCRUB_TABLE_H 1
+
+#include <glib.h>
+#include "ephem-cache.h"
+#include "qth-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+/** Precomputed data for one satellite. */
+typedef struct {
+    gint            catnum;     /*!< Catalogue number, used as hash key */
+    sat_t           sat;        /*!< Private copy used for event search */
+    ephem_cache_t  *ephem;      /*!< Ephemeris covering the table window */
+    GArray         *aos;        /*!< AOS times (gdouble), sorted */
+    GArray         *los;        /*!< LOS times (gdouble), sorted */
+} scrub_sat_t;
+
+/**
+ * Time indexed ephemeris and event table.
+ *
+ * The table covers the time window [t0;t1] for all satellites in a module
+ * and is built in a background thread. Once ready, satellite data at any
+ * time within the window can be obtained without running the propagator
+ * or the AOS/LOS search.
+ */
+typedef struct {
+    gdouble         t0;         /*!< Start of the window */
+    gdouble         t1;         /*!< End of the window */
+    gdouble         maxdt;      /*!< AOS/LOS look-ahead [days] */
+    qth_t           qth;        /*!< Copy of the QTH used for the events */
+    qth_small_t     qth_comp;   /*!< QTH position the table was built for */
+    GPtrArray      *sats;       /*!< scrub_sat_t */
+    GHashTable     *index;      /*!< catnum -> scrub_sat_t */
+    gint            ready;      /*!< Set when the build is finished */
+    gint            cancel;     /*!< Set to abort the build */
+    gint            refcount;   /*!< Owner + build thread */
+} scrub_table_t;
+
+scrub_table_t  *scrub_table_new(GHashTable * sats, qth_t * qth,
+                                gdouble t0, gdouble t1);
+void            scrub_table_free(scrub_table_t * table);
+gboolean        scrub_table_covers(scrub_table_t * table, qth_t * qth,
+                                   gdouble t);
+gboolean        scrub_table_calc(scrub_table_t * table, sat_t * sat,
+                                 qth_t * qth, gdouble t);
+
+#endif
@@ -0,0 +1,164 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/*
+ * Microbenchmark for SGP4 and SDP4.
+ *
+ * Each satellite in the TLE file (default test-004.tle) is propagated in
+ * one minute steps starting at epoch, which is what the real-time modules
+ * and the pass predictions do. The best time of several repeats is used to
+ * reduce the noise from other processes. The results are printed as JSON so
+ * that runs can be compared by scripts.
+ *
+ * Usage: sgpsdp-bench [tlefile [propagations [repeats]]]
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "sgp4sdp4.h"
+
+#define DEF_PROPAGATIONS 100000
+#define DEF_REPEATS      5
+
+static double bench_sat(sat_t * sat, int propagations, int repeats)
+{
+    clock_t         start;
+    double          secs, best = -1.0;
+    int             i, j;
+
+    for (j = 0; j < repeats; j++)
+    {
+        start = clock();
+        for (i = 0; i < propagations; i++)
+        {
+            if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+                SDP4(sat, i);
+            else
+                SGP4(sat, i);
+        }
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        if (best < 0.0 || secs < best)
+            best = secs;
+    }
+
+    return best;
+}
+
+static void print_name(const char *name)
+{
+    /* JSON string without the trailing white space of the TLE name */
+    int             len = strlen(name);
+
+    while (len > 0 && (name[len - 1] == ' ' || name[len - 1] == '\r' ||
+                       name[len - 1] == '\n'))
+        len--;
+
+    putchar('"');
+    for (; len > 0; len--, name++)
+    {
+        if (*name == '"' || *name == '\\')
+            putchar('\\');
+        putchar(*name);
+    }
+    putchar('"');
+}
+
+int main(int argc, char *argv[])
+{
+    FILE           *fp;
+    const char     *fname = "test-004.tle";
+    char            tle_str[3][80];
+    sat_t           sat;
+    double          secs;
+    int             propagations = DEF_PROPAGATIONS;
+    int             repeats = DEF_REPEATS;
+    int             n = 0;
+
+    if (argc > 1)
+        fname = argv[1];
+    if (argc > 2)
+        propagations = atoi(argv[2]);
+    if (argc > 3)
+        repeats = atoi(argv[3]);
+    if (propagations < 1 || repeats < 1)
+    {
+        fprintf(stderr, "Usage: %s [tlefile [propagations [repeats]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    /* make bench runs the benchmark in the build directory */
+    if (argc < 2 && getenv("srcdir") != NULL &&
+        chdir(getenv("srcdir")) != 0)
+        return 1;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", fname);
+        return 1;
+    }
+
+    printf("{\"benchmark\":\"sgpsdp\",\"version\":1,"
+           "\"propagations\":%d,\"repeats\":%d,\"results\":[",
+           propagations, repeats);
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        memset(&sat, 0, sizeof(sat));
+        if (Get_Next_Tle_Set(tle_str, &sat.tle) != 1)
+        {
+            fprintf(stderr, "Could not read TLE data %s", tle_str[0]);
+            continue;
+        }
+        select_ephemeris(&sat);
+
+        secs = bench_sat(&sat, propagations, repeats);
+
+        printf("%s\n{\"name\":", n++ ? "," : "");
+        print_name(sat.tle.sat_name);
+        printf(",\"catnum\":%d,\"model\":\"%s\",\"seconds\":%.6f,"
+               "\"rate\":%.0f}", sat.tle.catnr,
+               (sat.flags & DEEP_SPACE_EPHEM_FLAG) ? "SDP4" : "SGP4",
+               secs, secs > 0.0 ? propagations / secs : 0.0);
+
+        Sat_Release(&sat);
+    }
+    fclose(fp);
+
+    printf("]}\n");
+
+    return n == 0;
+}
@@ -11,8 +11,144 @@
  *   Reentrancy mods by Alexandru Csete OZ9AEC
  */
 
+#include <glib.h>
 #include "sgp4sdp4.h"
 
+/* Flags that are set by the initialization and kept with the constants */
+#define CONST_FLAGS (SGP4_INITIALIZED_FLAG | SDP4_INITIALIZED_FLAG | \
+					 SIMPLE_FLAG | RESONANCE_FLAG | SYNCHRONOUS_FLAG)
+
+/* Resonance integrator checkpoints. The integrator state is saved */
+/* every CKPT_STEPS steps on either side of epoch, so that a time   */
+/* query integrates from the nearest checkpoint before it instead   */
+/* of from epoch. The saved states are the ones reached when        */
+/* integrating from epoch, so the result for a given time does not  */
+/* depend on the previous queries. The table is shared by all the   */
+/* copies of a satellite.                                           */
+#define CKPT_STEPS 8
+
+typedef struct {
+	double atime,xli,xni;
+} ckpt_state_t;
+
+struct deep_ckpt {
+	GMutex  lock;
+	GArray *side[2];  /* after [0] and before [1] epoch; entry i is */
+	                  /* the state after (i+1)*CKPT_STEPS steps      */
+};
+
+/* Allocate propagator constants. The deep-space part */
+/* is only allocated for SDP4, i.e. when deep != 0.    */
+static sgpsdp_const_t *
+new_consts (int deep)
+{
+	sgpsdp_const_t *consts;
+
+	/* one block, the deep-space part follows the common part */
+	consts = calloc (1, sizeof (sgpsdp_const_t) +
+					 (deep ? sizeof (deep_const_t) : 0));
+	consts->refcount = 1;
+	if (deep) {
+		consts->deep = (deep_const_t *) (consts + 1);
+		consts->deep->ckpt = calloc (1, sizeof (struct deep_ckpt));
+		g_mutex_init (&consts->deep->ckpt->lock);
+		consts->deep->ckpt->side[0] = g_array_new (FALSE, FALSE, sizeof (ckpt_state_t));
+		consts->deep->ckpt->side[1] = g_array_new (FALSE, FALSE, sizeof (ckpt_state_t));
+	}
+
+	return consts;
+}
+
+/* Free propagator constants */
+void
+Free_Consts (sgpsdp_const_t *consts)
+{
+	if (consts->deep != NULL) {
+		g_mutex_clear (&consts->deep->ckpt->lock);
+		g_array_free (consts->deep->ckpt->side[0], TRUE);
+		g_array_free (consts->deep->ckpt->side[1], TRUE);
+		free (consts->deep->ckpt);
+	}
+
+	free (consts);
+}
+
+/* Load the integrator state of the checkpoint nearest before t */
+/* unless the current state is closer. Returns the number of    */
+/* integrator steps from epoch to the resulting state.          */
+static int
+ckpt_restore (sat_t *sat, double t, int side, int nstep)
+{
+	struct deep_ckpt *ckpt = sat->consts->deep->ckpt;
+	deep_static_t *dps = &sat->consts->deep->dps;
+	ckpt_state_t *state;
+	GArray *tab = ckpt->side[side];
+	int i;
+
+	g_mutex_lock (&ckpt->lock);
+
+	i = (int) (fabs (t) / (CKPT_STEPS*dps->stepp)) - 1;
+	if (i >= (int) tab->len)
+		i = tab->len - 1;
+	while (i >= 0 && fabs (g_array_index (tab, ckpt_state_t, i).atime) > fabs (t))
+		i--;
+
+	if (i < 0) {
+		if (nstep < 0) {
+			sat->dstate.atime = 0;
+			sat->dstate.xni = dps->xnq;
+			sat->dstate.xli = dps->xlamo;
+			nstep = 0;
+		}
+	}
+	else if ((i+1)*CKPT_STEPS > nstep) {
+		state = &g_array_index (tab, ckpt_state_t, i);
+		sat->dstate.atime = state->atime;
+		sat->dstate.xni = state->xni;
+		sat->dstate.xli = state->xli;
+		nstep = (i+1)*CKPT_STEPS;
+	}
+
+	g_mutex_unlock (&ckpt->lock);
+
+	return nstep;
+}
+
+/* Save the integrator state if it is the next checkpoint */
+static void
+ckpt_save (sat_t *sat, int side, int nstep)
+{
+	struct deep_ckpt *ckpt = sat->consts->deep->ckpt;
+	ckpt_state_t state;
+
+	g_mutex_lock (&ckpt->lock);
+
+	if (ckpt->side[side]->len == (guint) (nstep/CKPT_STEPS - 1)) {
+		state.atime = sat->dstate.atime;
+		state.xni = sat->dstate.xni;
+		state.xli = sat->dstate.xli;
+		g_array_append_val (ckpt->side[side], state);
+	}
+
+	g_mutex_unlock (&ckpt->lock);
+}
+
+/* Attach a satellite whose propagator has been reset to its already */
+/* computed constants. Only the flags and the deep-space integrator  */
+/* state are reinitialized; the shared constants are not touched.    */
+static void
+attach_consts (sat_t *sat)
+{
+	sat->flags = (sat->flags & ~CONST_FLAGS) | sat->consts->flags;
+
+	if (sat->flags & SDP4_INITIALIZED_FLAG) {
+		sat->dstate.atime = 0;
+		sat->dstate.xli = sat->consts->deep->dps.xlamo;
+		sat->dstate.xni = sat->consts->deep->dps.xnq;
+		sat->dstate.savtsn = 1E20;
+	}
+}
+
 /* SGP4 */
 /* This function is used to calculate the position and velocity */
 /* of near-earth (period < 225 minutes) satellites. tsince is   */
@@ -37,34 +173,41 @@ SGP4 (sat_t *sat, double tsince)
 
 	int i;  
 
+	sgpsdp_static_t *sgps;
+
 	/* Initialization */
+	if ((~sat->flags & SGP4_INITIALIZED_FLAG) && sat->consts != NULL)
+		attach_consts (sat);
+
 	if (~sat->flags & SGP4_INITIALIZED_FLAG) {
 	//if (!(sat->flags & SGP4_INITIALIZED_FLAG)) {
 		
 		sat->flags |= SGP4_INITIALIZED_FLAG;
+		sat->consts = new_consts (0);
+		sgps = &sat->consts->sgps;
 
 		//g_print ("SAT %d INITIALISED.\n", sat->tle.catnr);
 
 		/* Recover original mean motion (xnodp) and   */
 		/* semimajor axis (aodp) from input elements. */
 		a1 = pow (xke/sat->tle.xno, tothrd);
-		sat->sgps.cosio = cos (sat->tle.xincl);
-		theta2 = sat->sgps.cosio * sat->sgps.cosio;
-		sat->sgps.x3thm1 = 3 * theta2 - 1.0;
+		sgps->cosio = cos (sat->tle.xincl);
+		theta2 = sgps->cosio * sgps->cosio;
+		sgps->x3thm1 = 3 * theta2 - 1.0;
 		eosq = sat->tle.eo * sat->tle.eo;
 		betao2 = 1 - eosq;
 		betao = sqrt (betao2);
-		del1 = 1.5 * ck2 * sat->sgps.x3thm1 / (a1*a1*betao*betao2);
+		del1 = 1.5 * ck2 * sgps->x3thm1 / (a1*a1*betao*betao2);
 		ao = a1*(1-del1*(0.5*tothrd+del1*(1+134.0/81.0*del1)));
-		delo = 1.5 * ck2 * sat->sgps.x3thm1 / (ao*ao*betao*betao2);
-		sat->sgps.xnodp = sat->tle.xno / (1.0 + delo);
-		sat->sgps.aodp = ao / (1.0 - delo);
+		delo = 1.5 * ck2 * sgps->x3thm1 / (ao*ao*betao*betao2);
+		sgps->xnodp = sat->tle.xno / (1.0 + delo);
+		sgps->aodp = ao / (1.0 - delo);
 
 		/* For perigee less than 220 kilometers, the "simple" flag is set */
 		/* and the equations are truncated to linear variation in sqrt a  */
 		/* and quadratic variation in mean anomaly.  Also, the c3 term,   */
 		/* the delta omega term, and the delta m term are dropped.        */
-		if ((sat->sgps.aodp * (1.0 - sat->tle.eo) / ae) < (220.0 / xkmper + ae))
+		if ((sgps->aodp * (1.0 - sat->tle.eo) / ae) < (220.0 / xkmper + ae))
 			sat->flags |= SIMPLE_FLAG;
 		else
 			sat->flags &= ~SIMPLE_FLAG;
@@ -73,7 +216,7 @@ SGP4 (sat_t *sat, double tsince)
 		/* values of s and qoms2t are altered. */
 		s4 = __s__;
 		qoms24 = qoms2t;
-		perige = (sat->sgps.aodp * (1 - sat->tle.eo) - ae) * xkmper;
+		perige = (sgps->aodp * (1 - sat->tle.eo) - ae) * xkmper;
 		if (perige < 156.0) {
 			if (perige <= 98.0)
 				s4 = 20.0;
@@ -83,108 +226,112 @@ SGP4 (sat_t *sat, double tsince)
 			s4 = s4 / xkmper + ae;
 		}; /* FIXME FIXME: End of if(perige <= 98) NO WAY!!!! */
 
-		pinvsq = 1.0 / (sat->sgps.aodp * sat->sgps.aodp * betao2 * betao2);
-		tsi = 1.0 / (sat->sgps.aodp - s4);
-		sat->sgps.eta = sat->sgps.aodp * sat->tle.eo * tsi;
-		etasq = sat->sgps.eta * sat->sgps.eta;
-		eeta = sat->tle.eo * sat->sgps.eta;
+		pinvsq = 1.0 / (sgps->aodp * sgps->aodp * betao2 * betao2);
+		tsi = 1.0 / (sgps->aodp - s4);
+		sgps->eta = sgps->aodp * sat->tle.eo * tsi;
+		etasq = sgps->eta * sgps->eta;
+		eeta = sat->tle.eo * sgps->eta;
 		psisq = fabs (1.0 - etasq);
 		coef = qoms24 * pow (tsi, 4);
 		coef1 = coef / pow (psisq, 3.5);
-		c2 = coef1 * sat->sgps.xnodp * (sat->sgps.aodp *
+		c2 = coef1 * sgps->xnodp * (sgps->aodp *
 						(1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
-						0.75 * ck2 * tsi / psisq * sat->sgps.x3thm1 *
+						0.75 * ck2 * tsi / psisq * sgps->x3thm1 *
 						(8.0 + 3.0 * etasq * (8 + etasq)));
-		sat->sgps.c1 = c2 * sat->tle.bstar;
-		sat->sgps.sinio = sin (sat->tle.xincl);
+		sgps->c1 = c2 * sat->tle.bstar;
+		sgps->sinio = sin (sat->tle.xincl);
 		a3ovk2 = -xj3 / ck2 * pow (ae, 3);
-		c3 = coef * tsi * a3ovk2 * sat->sgps.xnodp * ae * sat->sgps.sinio / sat->tle.eo;
-		sat->sgps.x1mth2 = 1.0 - theta2;
-		sat->sgps.c4 = 2.0 * sat->sgps.xnodp * coef1 * sat->sgps.aodp * betao2 *
-			(sat->sgps.eta * (2.0 + 0.5 * etasq) +
+		c3 = coef * tsi * a3ovk2 * sgps->xnodp * ae * sgps->sinio / sat->tle.eo;
+		sgps->x1mth2 = 1.0 - theta2;
+		sgps->c4 = 2.0 * sgps->xnodp * coef1 * sgps->aodp * betao2 *
+			(sgps->eta * (2.0 + 0.5 * etasq) +
 			 sat->tle.eo * (0.5 + 2.0 * etasq) -
-			 2.0 * ck2 * tsi / (sat->sgps.aodp * psisq) *
-			 (-3.0 * sat->sgps.x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 
-			  0.75 * sat->sgps.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * 
+			 2.0 * ck2 * tsi / (sgps->aodp * psisq) *
+			 (-3.0 * sgps->x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 
+			  0.75 * sgps->x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * 
 			  cos (2.0 * sat->tle.omegao)));
-		sat->sgps.c5 = 2.0 * coef1 * sat->sgps.aodp * betao2 *
+		sgps->c5 = 2.0 * coef1 * sgps->aodp * betao2 *
 			(1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
 		theta4 = theta2 * theta2;
-		temp1 = 3.0 * ck2 * pinvsq * sat->sgps.xnodp;
+		temp1 = 3.0 * ck2 * pinvsq * sgps->xnodp;
 		temp2 = temp1 * ck2 * pinvsq;
-		temp3 = 1.25 * ck4 * pinvsq * pinvsq * sat->sgps.xnodp;
-		sat->sgps.xmdot = sat->sgps.xnodp + 0.5 * temp1 * betao * sat->sgps.x3thm1 +
+		temp3 = 1.25 * ck4 * pinvsq * pinvsq * sgps->xnodp;
+		sgps->xmdot = sgps->xnodp + 0.5 * temp1 * betao * sgps->x3thm1 +
 			0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
 		x1m5th = 1.0 - 5.0 * theta2;
-		sat->sgps.omgdot = -0.5 * temp1 * x1m5th +
+		sgps->omgdot = -0.5 * temp1 * x1m5th +
 			0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) +
 			temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
-		xhdot1 = -temp1 * sat->sgps.cosio;
-		sat->sgps.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) +
-					     2.0 * temp3 * (3.0 - 7.0 * theta2)) * sat->sgps.cosio;
-		sat->sgps.omgcof = sat->tle.bstar * c3 * cos (sat->tle.omegao);
-		sat->sgps.xmcof = -tothrd * coef * sat->tle.bstar * ae / eeta;
-		sat->sgps.xnodcf = 3.5 * betao2 * xhdot1 * sat->sgps.c1;
-		sat->sgps.t2cof = 1.5 * sat->sgps.c1;
-		sat->sgps.xlcof = 0.125 * a3ovk2 * sat->sgps.sinio *
-			(3.0 + 5.0 * sat->sgps.cosio) / (1.0 + sat->sgps.cosio);
-		sat->sgps.aycof = 0.25 * a3ovk2 * sat->sgps.sinio;
-		sat->sgps.delmo = pow (1.0 + sat->sgps.eta * cos (sat->tle.xmo), 3);
-		sat->sgps.sinmo = sin (sat->tle.xmo);
-		sat->sgps.x7thm1 = 7.0 * theta2 - 1.0;
+		xhdot1 = -temp1 * sgps->cosio;
+		sgps->xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) +
+					     2.0 * temp3 * (3.0 - 7.0 * theta2)) * sgps->cosio;
+		sgps->omgcof = sat->tle.bstar * c3 * cos (sat->tle.omegao);
+		sgps->xmcof = -tothrd * coef * sat->tle.bstar * ae / eeta;
+		sgps->xnodcf = 3.5 * betao2 * xhdot1 * sgps->c1;
+		sgps->t2cof = 1.5 * sgps->c1;
+		sgps->xlcof = 0.125 * a3ovk2 * sgps->sinio *
+			(3.0 + 5.0 * sgps->cosio) / (1.0 + sgps->cosio);
+		sgps->aycof = 0.25 * a3ovk2 * sgps->sinio;
+		sgps->delmo = pow (1.0 + sgps->eta * cos (sat->tle.xmo), 3);
+		sgps->sinmo = sin (sat->tle.xmo);
+		sgps->x7thm1 = 7.0 * theta2 - 1.0;
 		if (~sat->flags & SIMPLE_FLAG) {
-			c1sq = sat->sgps.c1 * sat->sgps.c1;
-			sat->sgps.d2 = 4.0 * sat->sgps.aodp * tsi * c1sq;
-			temp = sat->sgps.d2 * tsi * sat->sgps.c1 / 3.0;
-			sat->sgps.d3 = (17.0 * sat->sgps.aodp + s4) * temp;
-			sat->sgps.d4 = 0.5 * temp * sat->sgps.aodp * tsi *
-				(221.0 * sat->sgps.aodp + 31.0 * s4) * sat->sgps.c1;
-			sat->sgps.t3cof = sat->sgps.d2 + 2.0 * c1sq;
-			sat->sgps.t4cof = 0.25 * (3.0 * sat->sgps.d3 + sat->sgps.c1 *
-						  (12.0 * sat->sgps.d2 + 10.0 * c1sq));
-			sat->sgps.t5cof = 0.2 * (3.0 * sat->sgps.d4 +
-						 12.0 * sat->sgps.c1 * sat->sgps.d3 +
-						 6.0 * sat->sgps.d2 * sat->sgps.d2 +
-						 15.0 * c1sq * (2.0 * sat->sgps.d2 + c1sq));
+			c1sq = sgps->c1 * sgps->c1;
+			sgps->d2 = 4.0 * sgps->aodp * tsi * c1sq;
+			temp = sgps->d2 * tsi * sgps->c1 / 3.0;
+			sgps->d3 = (17.0 * sgps->aodp + s4) * temp;
+			sgps->d4 = 0.5 * temp * sgps->aodp * tsi *
+				(221.0 * sgps->aodp + 31.0 * s4) * sgps->c1;
+			sgps->t3cof = sgps->d2 + 2.0 * c1sq;
+			sgps->t4cof = 0.25 * (3.0 * sgps->d3 + sgps->c1 *
+						  (12.0 * sgps->d2 + 10.0 * c1sq));
+			sgps->t5cof = 0.2 * (3.0 * sgps->d4 +
+						 12.0 * sgps->c1 * sgps->d3 +
+						 6.0 * sgps->d2 * sgps->d2 +
+						 15.0 * c1sq * (2.0 * sgps->d2 + c1sq));
 		}; /* End of if (isFlagClear(SIMPLE_FLAG)) */
+
+		sat->consts->flags = sat->flags & CONST_FLAGS;
 	}; /* End of SGP4() initialization */
 
+	sgps = &sat->consts->sgps;
+
 	/* Update for secular gravity and atmospheric drag. */
-	xmdf = sat->tle.xmo + sat->sgps.xmdot * tsince;
-	omgadf = sat->tle.omegao + sat->sgps.omgdot * tsince;
-	xnoddf = sat->tle.xnodeo + sat->sgps.xnodot * tsince;
+	xmdf = sat->tle.xmo + sgps->xmdot * tsince;
+	omgadf = sat->tle.omegao + sgps->omgdot * tsince;
+	xnoddf = sat->tle.xnodeo + sgps->xnodot * tsince;
 	omega = omgadf;
 	xmp = xmdf;
 	tsq = tsince*tsince;
-	xnode = xnoddf + sat->sgps.xnodcf * tsq;
-	tempa = 1.0 - sat->sgps.c1 * tsince;
-	tempe = sat->tle.bstar * sat->sgps.c4 * tsince;
-	templ = sat->sgps.t2cof * tsq;
+	xnode = xnoddf + sgps->xnodcf * tsq;
+	tempa = 1.0 - sgps->c1 * tsince;
+	tempe = sat->tle.bstar * sgps->c4 * tsince;
+	templ = sgps->t2cof * tsq;
 	if (~sat->flags & SIMPLE_FLAG) {
-		delomg = sat->sgps.omgcof * tsince;
-		delm = sat->sgps.xmcof * (pow (1 + sat->sgps.eta * cos (xmdf), 3) - sat->sgps.delmo);
+		delomg = sgps->omgcof * tsince;
+		delm = sgps->xmcof * (pow (1 + sgps->eta * cos (xmdf), 3) - sgps->delmo);
 		temp = delomg + delm;
 		xmp = xmdf + temp;
 		omega = omgadf - temp;
 		tcube = tsq * tsince;
 		tfour = tsince * tcube;
-		tempa = tempa - sat->sgps.d2 * tsq - sat->sgps.d3 * tcube - sat->sgps.d4 * tfour;
-		tempe = tempe + sat->tle.bstar * sat->sgps.c5 * (sin (xmp) - sat->sgps.sinmo);
-		templ = templ + sat->sgps.t3cof * tcube + tfour *
-			(sat->sgps.t4cof + tsince * sat->sgps.t5cof);
+		tempa = tempa - sgps->d2 * tsq - sgps->d3 * tcube - sgps->d4 * tfour;
+		tempe = tempe + sat->tle.bstar * sgps->c5 * (sin (xmp) - sgps->sinmo);
+		templ = templ + sgps->t3cof * tcube + tfour *
+			(sgps->t4cof + tsince * sgps->t5cof);
 	}; /* End of if (isFlagClear(SIMPLE_FLAG)) */
 
-	a = sat->sgps.aodp * pow (tempa, 2);
+	a = sgps->aodp * pow (tempa, 2);
 	e = sat->tle.eo - tempe;
-	xl = xmp + omega + xnode + sat->sgps.xnodp * templ;
+	xl = xmp + omega + xnode + sgps->xnodp * templ;
 	beta = sqrt (1.0 - e*e);
 	xn = xke / pow (a, 1.5);
 
 	/* Long period periodics */
 	axn = e * cos (omega);
 	temp = 1.0 / (a * beta * beta);
-	xll = temp * sat->sgps.xlcof * axn;
-	aynl = temp * sat->sgps.aycof;
+	xll = temp * sgps->xlcof * axn;
+	aynl = temp * sgps->aycof;
 	xlt = xl + xll;
 	ayn = e * sin (omega) + aynl;
 
@@ -230,13 +377,13 @@ SGP4 (sat_t *sat, double tsince)
 	temp2 = temp1 * temp;
 
 	/* Update for short periodics */
-	rk = r * (1.0 - 1.5 * temp2 * betal * sat->sgps.x3thm1) +
-		0.5 * temp1 * sat->sgps.x1mth2 * cos2u;
-	uk = u - 0.25 * temp2 * sat->sgps.x7thm1 * sin2u;
-	xnodek = xnode + 1.5 * temp2 * sat->sgps.cosio * sin2u;
-	xinck = sat->tle.xincl + 1.5 * temp2 * sat->sgps.cosio * sat->sgps.sinio * cos2u;
-	rdotk = rdot - xn * temp1 * sat->sgps.x1mth2 * sin2u;
-	rfdotk = rfdot + xn * temp1 * (sat->sgps.x1mth2 * cos2u + 1.5 * sat->sgps.x3thm1);
+	rk = r * (1.0 - 1.5 * temp2 * betal * sgps->x3thm1) +
+		0.5 * temp1 * sgps->x1mth2 * cos2u;
+	uk = u - 0.25 * temp2 * sgps->x7thm1 * sin2u;
+	xnodek = xnode + 1.5 * temp2 * sgps->cosio * sin2u;
+	xinck = sat->tle.xincl + 1.5 * temp2 * sgps->cosio * sgps->sinio * cos2u;
+	rdotk = rdot - xn * temp1 * sgps->x1mth2 * sin2u;
+	rfdotk = rfdot + xn * temp1 * (sgps->x1mth2 * cos2u + 1.5 * sgps->x3thm1);
 
 
 	/* Orientation vectors */
@@ -300,34 +447,41 @@ SDP4 (sat_t *sat, double tsince)
 		psisq,tsi,qoms24,s4,pinvsq,temp,tempa,temp1,
 		temp2,temp3,temp4,temp5,temp6;
 
+	sgpsdp_static_t *sgps;
+	deep_arg_t deep_arg;
 
 	/* Initialization */
+	if ((~sat->flags & SDP4_INITIALIZED_FLAG) && sat->consts != NULL)
+		attach_consts (sat);
+
 	if (~sat->flags & SDP4_INITIALIZED_FLAG) {
 
 		sat->flags |= SDP4_INITIALIZED_FLAG;
+		sat->consts = new_consts (1);
+		sgps = &sat->consts->sgps;
 
 		/* Recover original mean motion (xnodp) and   */
 		/* semimajor axis (aodp) from input elements. */
 		a1 = pow (xke / sat->tle.xno, tothrd);
-		sat->deep_arg.cosio = cos (sat->tle.xincl);
-		sat->deep_arg.theta2 = sat->deep_arg.cosio * sat->deep_arg.cosio;
-		sat->sgps.x3thm1 = 3.0 * sat->deep_arg.theta2 - 1.0;
-		sat->deep_arg.eosq = sat->tle.eo * sat->tle.eo;
-		sat->deep_arg.betao2 = 1.0 - sat->deep_arg.eosq;
-		sat->deep_arg.betao = sqrt (sat->deep_arg.betao2);
-		del1 = 1.5 * ck2 * sat->sgps.x3thm1 /
-			(a1 * a1 * sat->deep_arg.betao * sat->deep_arg.betao2);
+		deep_arg.cosio = cos (sat->tle.xincl);
+		deep_arg.theta2 = deep_arg.cosio * deep_arg.cosio;
+		sgps->x3thm1 = 3.0 * deep_arg.theta2 - 1.0;
+		deep_arg.eosq = sat->tle.eo * sat->tle.eo;
+		deep_arg.betao2 = 1.0 - deep_arg.eosq;
+		deep_arg.betao = sqrt (deep_arg.betao2);
+		del1 = 1.5 * ck2 * sgps->x3thm1 /
+			(a1 * a1 * deep_arg.betao * deep_arg.betao2);
 		ao = a1 * (1.0 - del1 * (0.5 * tothrd + del1 * (1.0 + 134.0 / 81.0 * del1)));
-		delo = 1.5 * ck2 * sat->sgps.x3thm1 /
-			(ao * ao * sat->deep_arg.betao * sat->deep_arg.betao2);
-		sat->deep_arg.xnodp = sat->tle.xno / (1.0 + delo);
-		sat->deep_arg.aodp = ao / (1.0 - delo);
+		delo = 1.5 * ck2 * sgps->x3thm1 /
+			(ao * ao * deep_arg.betao * deep_arg.betao2);
+		deep_arg.xnodp = sat->tle.xno / (1.0 + delo);
+		deep_arg.aodp = ao / (1.0 - delo);
 
 		/* For perigee below 156 km, the values */
 		/* of s and qoms2t are altered.         */
 		s4 = __s__;
 		qoms24 = qoms2t;
-		perige = (sat->deep_arg.aodp * (1.0 - sat->tle.eo) - ae) * xkmper;
+		perige = (deep_arg.aodp * (1.0 - sat->tle.eo) - ae) * xkmper;
 		if (perige < 156.0) {
 			if (perige <= 98.0)
 				s4 = 20.0;
@@ -336,104 +490,111 @@ SDP4 (sat_t *sat, double tsince)
 			qoms24 = pow ((120.0 - s4) * ae / xkmper, 4);
 			s4 = s4 / xkmper + ae;
 		}
-		pinvsq = 1.0 / (sat->deep_arg.aodp * sat->deep_arg.aodp *
-				sat->deep_arg.betao2 * sat->deep_arg.betao2);
-		sat->deep_arg.sing = sin (sat->tle.omegao);
-		sat->deep_arg.cosg = cos (sat->tle.omegao);
-		tsi = 1.0 / (sat->deep_arg.aodp - s4);
-		eta = sat->deep_arg.aodp * sat->tle.eo * tsi;
+		pinvsq = 1.0 / (deep_arg.aodp * deep_arg.aodp *
+				deep_arg.betao2 * deep_arg.betao2);
+		deep_arg.sing = sin (sat->tle.omegao);
+		deep_arg.cosg = cos (sat->tle.omegao);
+		tsi = 1.0 / (deep_arg.aodp - s4);
+		eta = deep_arg.aodp * sat->tle.eo * tsi;
 		etasq = eta * eta;
 		eeta = sat->tle.eo * eta;
 		psisq = fabs (1.0 - etasq);
 		coef = qoms24 * pow (tsi, 4);
 		coef1 = coef / pow (psisq, 3.5);
-		c2 = coef1 * sat->deep_arg.xnodp * (sat->deep_arg.aodp *
+		c2 = coef1 * deep_arg.xnodp * (deep_arg.aodp *
 						    (1.0 + 1.5 * etasq + eeta *
 						     (4.0 + etasq)) + 0.75 * ck2 * tsi / psisq * 
-						    sat->sgps.x3thm1 * (8.0 + 3.0 * etasq *
+						    sgps->x3thm1 * (8.0 + 3.0 * etasq *
 									(8.0 + etasq)));
-		sat->sgps.c1 = sat->tle.bstar * c2;
-		sat->deep_arg.sinio = sin (sat->tle.xincl);
+		sgps->c1 = sat->tle.bstar * c2;
+		deep_arg.sinio = sin (sat->tle.xincl);
 		a3ovk2 = -xj3 / ck2 * pow (ae, 3);
-		sat->sgps.x1mth2 = 1.0 - sat->deep_arg.theta2;
-		sat->sgps.c4 = 2.0 * sat->deep_arg.xnodp * coef1 *
-			sat->deep_arg.aodp * sat->deep_arg.betao2 *
+		sgps->x1mth2 = 1.0 - deep_arg.theta2;
+		sgps->c4 = 2.0 * deep_arg.xnodp * coef1 *
+			deep_arg.aodp * deep_arg.betao2 *
 			(eta * (2.0 + 0.5 * etasq) + sat->tle.eo *
 			 (0.5 + 2.0 * etasq) - 2.0 * ck2 * tsi /
-			 (sat->deep_arg.aodp * psisq) * (-3.0 * sat->sgps.x3thm1 *
+			 (deep_arg.aodp * psisq) * (-3.0 * sgps->x3thm1 *
 							 (1.0 - 2.0 * eeta + etasq *
 							  (1.5 - 0.5 * eeta)) +
-							 0.75 * sat->sgps.x1mth2 * 
+							 0.75 * sgps->x1mth2 * 
 							 (2.0 * etasq - eeta * (1.0 + etasq)) *
 							 cos (2.0 * sat->tle.omegao)));
-		theta4 = sat->deep_arg.theta2 * sat->deep_arg.theta2;
-		temp1 = 3.0 * ck2 * pinvsq * sat->deep_arg.xnodp;
+		theta4 = deep_arg.theta2 * deep_arg.theta2;
+		temp1 = 3.0 * ck2 * pinvsq * deep_arg.xnodp;
 		temp2 = temp1 * ck2 * pinvsq;
-		temp3 = 1.25 * ck4 * pinvsq * pinvsq * sat->deep_arg.xnodp;
-		sat->deep_arg.xmdot = sat->deep_arg.xnodp + 0.5 * temp1 * sat->deep_arg.betao *
-			sat->sgps.x3thm1 + 0.0625 * temp2 * sat->deep_arg.betao *
-			(13.0 - 78.0 * sat->deep_arg.theta2 + 137.0 * theta4);
-		x1m5th = 1.0 - 5.0 * sat->deep_arg.theta2;
-		sat->deep_arg.omgdot = -0.5 * temp1 * x1m5th + 0.0625 * temp2 *
-                        (7.0 - 114.0 * sat->deep_arg.theta2 + 395.0 * theta4) +
-	                temp3 * (3.0 - 36.0 * sat->deep_arg.theta2 + 49.0 * theta4);
-		xhdot1 = -temp1 * sat->deep_arg.cosio;
-		sat->deep_arg.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * sat->deep_arg.theta2) +
-						 2.0 * temp3 * (3.0 - 7.0 * sat->deep_arg.theta2)) *
-			sat->deep_arg.cosio;
-		sat->sgps.xnodcf = 3.5 * sat->deep_arg.betao2 * xhdot1 * sat->sgps.c1;
-		sat->sgps.t2cof = 1.5 * sat->sgps.c1;
-		sat->sgps.xlcof = 0.125 * a3ovk2 * sat->deep_arg.sinio *
-			(3.0 + 5.0 * sat->deep_arg.cosio) / (1.0 + sat->deep_arg.cosio);
-		sat->sgps.aycof = 0.25 * a3ovk2 * sat->deep_arg.sinio;
-		sat->sgps.x7thm1 = 7.0 * sat->deep_arg.theta2 - 1.0;
+		temp3 = 1.25 * ck4 * pinvsq * pinvsq * deep_arg.xnodp;
+		deep_arg.xmdot = deep_arg.xnodp + 0.5 * temp1 * deep_arg.betao *
+			sgps->x3thm1 + 0.0625 * temp2 * deep_arg.betao *
+			(13.0 - 78.0 * deep_arg.theta2 + 137.0 * theta4);
+		x1m5th = 1.0 - 5.0 * deep_arg.theta2;
+		deep_arg.omgdot = -0.5 * temp1 * x1m5th + 0.0625 * temp2 *
+                        (7.0 - 114.0 * deep_arg.theta2 + 395.0 * theta4) +
+	                temp3 * (3.0 - 36.0 * deep_arg.theta2 + 49.0 * theta4);
+		xhdot1 = -temp1 * deep_arg.cosio;
+		deep_arg.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * deep_arg.theta2) +
+						 2.0 * temp3 * (3.0 - 7.0 * deep_arg.theta2)) *
+			deep_arg.cosio;
+		sgps->xnodcf = 3.5 * deep_arg.betao2 * xhdot1 * sgps->c1;
+		sgps->t2cof = 1.5 * sgps->c1;
+		sgps->xlcof = 0.125 * a3ovk2 * deep_arg.sinio *
+			(3.0 + 5.0 * deep_arg.cosio) / (1.0 + deep_arg.cosio);
+		sgps->aycof = 0.25 * a3ovk2 * deep_arg.sinio;
+		sgps->x7thm1 = 7.0 * deep_arg.theta2 - 1.0;
 
 		/* initialize Deep() */
-		Deep (dpinit, sat);
+		Deep (dpinit, sat, &deep_arg);
+
+		sat->consts->deep->deep_arg = deep_arg;
+		sat->consts->flags = sat->flags & CONST_FLAGS;
 	}; /*End of SDP4() initialization */
 
+	/* the rest of deep_arg is scratch space for this call */
+	sgps = &sat->consts->sgps;
+	deep_arg = sat->consts->deep->deep_arg;
+
 	/* Update for secular gravity and atmospheric drag */
-	xmdf = sat->tle.xmo + sat->deep_arg.xmdot * tsince;
-	sat->deep_arg.omgadf = sat->tle.omegao + sat->deep_arg.omgdot * tsince;
-	xnoddf = sat->tle.xnodeo + sat->deep_arg.xnodot * tsince;
+	xmdf = sat->tle.xmo + deep_arg.xmdot * tsince;
+	deep_arg.omgadf = sat->tle.omegao + deep_arg.omgdot * tsince;
+	xnoddf = sat->tle.xnodeo + deep_arg.xnodot * tsince;
 	tsq = tsince * tsince;
-	sat->deep_arg.xnode = xnoddf + sat->sgps.xnodcf * tsq;
-	tempa = 1.0 - sat->sgps.c1 * tsince;
-	tempe = sat->tle.bstar * sat->sgps.c4 * tsince;
-	templ = sat->sgps.t2cof * tsq;
-	sat->deep_arg.xn = sat->deep_arg.xnodp;
+	deep_arg.xnode = xnoddf + sgps->xnodcf * tsq;
+	tempa = 1.0 - sgps->c1 * tsince;
+	tempe = sat->tle.bstar * sgps->c4 * tsince;
+	templ = sgps->t2cof * tsq;
+	deep_arg.xn = deep_arg.xnodp;
 
 	/* Update for deep-space secular effects */
-	sat->deep_arg.xll = xmdf;
-	sat->deep_arg.t = tsince;
+	deep_arg.xll = xmdf;
+	deep_arg.t = tsince;
 
-	Deep (dpsec, sat);
+	Deep (dpsec, sat, &deep_arg);
 
-	xmdf = sat->deep_arg.xll;
-	a = pow (xke / sat->deep_arg.xn, tothrd) * tempa * tempa;
-	sat->deep_arg.em = sat->deep_arg.em - tempe;
-	xmam = xmdf + sat->deep_arg.xnodp * templ;
+	xmdf = deep_arg.xll;
+	a = pow (xke / deep_arg.xn, tothrd) * tempa * tempa;
+	deep_arg.em = deep_arg.em - tempe;
+	xmam = xmdf + deep_arg.xnodp * templ;
 
 	/* Update for deep-space periodic effects */
-	sat->deep_arg.xll = xmam;
+	deep_arg.xll = xmam;
 
-	Deep (dpper, sat);
+	Deep (dpper, sat, &deep_arg);
 
-	xmam = sat->deep_arg.xll;
-	xl = xmam + sat->deep_arg.omgadf + sat->deep_arg.xnode;
-	beta = sqrt (1.0 - sat->deep_arg.em * sat->deep_arg.em);
-	sat->deep_arg.xn = xke / pow( a, 1.5);
+	xmam = deep_arg.xll;
+	xl = xmam + deep_arg.omgadf + deep_arg.xnode;
+	beta = sqrt (1.0 - deep_arg.em * deep_arg.em);
+	deep_arg.xn = xke / pow( a, 1.5);
 
 	/* Long period periodics */
-	axn = sat->deep_arg.em * cos (sat->deep_arg.omgadf);
+	axn = deep_arg.em * cos (deep_arg.omgadf);
 	temp = 1.0 / (a * beta * beta);
-	xll = temp * sat->sgps.xlcof * axn;
-	aynl = temp * sat->sgps.aycof;
+	xll = temp * sgps->xlcof * axn;
+	aynl = temp * sgps->aycof;
 	xlt = xl + xll;
-	ayn = sat->deep_arg.em * sin (sat->deep_arg.omgadf) + aynl;
+	ayn = deep_arg.em * sin (deep_arg.omgadf) + aynl;
 
 	/* Solve Kepler's Equation */
-	capu = FMod2p (xlt - sat->deep_arg.xnode);
+	capu = FMod2p (xlt - deep_arg.xnode);
 	temp2 = capu;
 
 	i = 0;
@@ -474,15 +635,15 @@ SDP4 (sat_t *sat, double tsince)
 	temp2 = temp1 * temp;
 
 	/* Update for short periodics */
-	rk = r * (1.0 - 1.5 * temp2 * betal * sat->sgps.x3thm1) +
-	     0.5 * temp1 * sat->sgps.x1mth2 * cos2u;
-	uk = u - 0.25 * temp2 * sat->sgps.x7thm1 * sin2u;
-	xnodek = sat->deep_arg.xnode + 1.5 * temp2 * sat->deep_arg.cosio * sin2u;
-	xinck = sat->deep_arg.xinc + 1.5 * temp2 *
-	     sat->deep_arg.cosio * sat->deep_arg.sinio * cos2u;
-	rdotk = rdot - sat->deep_arg.xn * temp1 * sat->sgps.x1mth2 * sin2u;
-	rfdotk = rfdot + sat->deep_arg.xn * temp1 *
-	     (sat->sgps.x1mth2 * cos2u + 1.5 * sat->sgps.x3thm1);
+	rk = r * (1.0 - 1.5 * temp2 * betal * sgps->x3thm1) +
+	     0.5 * temp1 * sgps->x1mth2 * cos2u;
+	uk = u - 0.25 * temp2 * sgps->x7thm1 * sin2u;
+	xnodek = deep_arg.xnode + 1.5 * temp2 * deep_arg.cosio * sin2u;
+	xinck = deep_arg.xinc + 1.5 * temp2 *
+	     deep_arg.cosio * deep_arg.sinio * cos2u;
+	rdotk = rdot - deep_arg.xn * temp1 * sgps->x1mth2 * sin2u;
+	rfdotk = rfdot + deep_arg.xn * temp1 *
+	     (sgps->x1mth2 * cos2u + 1.5 * sgps->x3thm1);
 
 	/* Orientation vectors */
 	sinuk = sin (uk);
@@ -509,14 +670,14 @@ SDP4 (sat_t *sat, double tsince)
 	sat->vel.z = rdotk * uz + rfdotk * vz;
 
 	/* Phase in rads */
-	sat->phase = xlt - sat->deep_arg.xnode - sat->deep_arg.omgadf + twopi;
+	sat->phase = xlt - deep_arg.xnode - deep_arg.omgadf + twopi;
 	if (sat->phase < 0.0)
 		sat->phase += twopi;
 	sat->phase = FMod2p (sat->phase);
 
-	sat->tle.omegao1 = sat->deep_arg.omgadf;
-	sat->tle.xincl1  = sat->deep_arg.xinc;
-	sat->tle.xnodeo1 = sat->deep_arg.xnode;
+	sat->tle.omegao1 = deep_arg.omgadf;
+	sat->tle.xincl1  = deep_arg.xinc;
+	sat->tle.xnodeo1 = deep_arg.xnode;
 } /* SDP4 */
 
 /*------------------------------------------------------------------*/
@@ -525,8 +686,9 @@ SDP4 (sat_t *sat, double tsince)
 /* This function is used by SDP4 to add lunar and solar */
 /* perturbation effects to deep-space orbit objects.    */
 void
-Deep (int ientry, sat_t *sat)
+Deep (int ientry, sat_t *sat, deep_arg_t *deep_arg)
 {
+	deep_static_t *dps = &sat->consts->deep->dps;
 
 	double
 		a1,a2,a3,a4,a5,a6,a7,a8,a9,a10,ainv2,alfdp,aqnv,
@@ -541,47 +703,48 @@ Deep (int ientry, sat_t *sat)
 		xndot,xno2,xnodce,xnoi,xomi,xpidot,z1,z11,z12,z13,
 		z2,z21,z22,z23,z3,z31,z32,z33,ze,zf,zm,zn,
 		zsing,zsinh,zsini,zcosg,zcosh,zcosi,delt=0,ft=0;
+	int side,nstep;
 
 	switch (ientry) {
 	case dpinit : /* Entrance for deep space initialization */
-		sat->dps.thgr = ThetaG (sat->tle.epoch, &sat->deep_arg);
+		dps->thgr = ThetaG (sat->tle.epoch, deep_arg);
 		eq = sat->tle.eo;
-		sat->dps.xnq = sat->deep_arg.xnodp;
-		aqnv = 1.0 / sat->deep_arg.aodp;
-		sat->dps.xqncl = sat->tle.xincl;
+		dps->xnq = deep_arg->xnodp;
+		aqnv = 1.0 / deep_arg->aodp;
+		dps->xqncl = sat->tle.xincl;
 		xmao = sat->tle.xmo;
-		xpidot = sat->deep_arg.omgdot + sat->deep_arg.xnodot;
+		xpidot = deep_arg->omgdot + deep_arg->xnodot;
 		sinq = sin (sat->tle.xnodeo);
 		cosq = cos (sat->tle.xnodeo);
-		sat->dps.omegaq = sat->tle.omegao;
-		sat->dps.preep = 0;
+		dps->omegaq = sat->tle.omegao;
+		dps->preep = 0;
 
 		/* Initialize lunar solar terms */
-		day = sat->deep_arg.ds50 + 18261.5;  /*Days since 1900 Jan 0.5*/
-		if (day != sat->dps.preep) {
-			sat->dps.preep = day;
+		day = deep_arg->ds50 + 18261.5;  /*Days since 1900 Jan 0.5*/
+		if (day != dps->preep) {
+			dps->preep = day;
 			xnodce = 4.5236020 - 9.2422029E-4 * day;
 			stem = sin (xnodce);
 			ctem = cos (xnodce);
-			sat->dps.zcosil = 0.91375164 - 0.03568096 * ctem;
-			sat->dps.zsinil = sqrt (1.0 - sat->dps.zcosil * sat->dps.zcosil);
-			sat->dps.zsinhl = 0.089683511 * stem / sat->dps.zsinil;
-			sat->dps.zcoshl = sqrt (1.0 - sat->dps.zsinhl * sat->dps.zsinhl);
+			dps->zcosil = 0.91375164 - 0.03568096 * ctem;
+			dps->zsinil = sqrt (1.0 - dps->zcosil * dps->zcosil);
+			dps->zsinhl = 0.089683511 * stem / dps->zsinil;
+			dps->zcoshl = sqrt (1.0 - dps->zsinhl * dps->zsinhl);
 			c = 4.7199672 + 0.22997150 * day;
 			gam = 5.8351514 + 0.0019443680 * day;
-			sat->dps.zmol = FMod2p (c - gam);
-			zx = 0.39785416 * stem / sat->dps.zsinil;
-			zy = sat->dps.zcoshl * ctem + 0.91744867 * sat->dps.zsinhl * stem;
+			dps->zmol = FMod2p (c - gam);
+			zx = 0.39785416 * stem / dps->zsinil;
+			zy = dps->zcoshl * ctem + 0.91744867 * dps->zsinhl * stem;
 			zx = AcTan (zx,zy);
 			zx = gam + zx - xnodce;
-			sat->dps.zcosgl = cos (zx);
-			sat->dps.zsingl = sin (zx);
-			sat->dps.zmos = 6.2565837 + 0.017201977 * day;
-			sat->dps.zmos = FMod2p (sat->dps.zmos);
+			dps->zcosgl = cos (zx);
+			dps->zsingl = sin (zx);
+			dps->zmos = 6.2565837 + 0.017201977 * day;
+			dps->zmos = FMod2p (dps->zmos);
 		} /* End if(day != preep) */
 
 		/* Do solar terms */
-		sat->dps.savtsn = 1E20;
+		sat->dstate.savtsn = 1E20;
 		zcosg = zcosgs;
 		zsing = zsings;
 		zcosi = zcosis;
@@ -591,7 +754,7 @@ Deep (int ientry, sat_t *sat)
 		cc = c1ss;
 		zn = zns;
 		ze = zes;
-		xnoi = 1.0 / sat->dps.xnq;
+		xnoi = 1.0 / dps->xnq;
 
 		/* Loop breaks when Solar terms are done a second */
 		/* time, after Lunar terms are initialized        */
@@ -603,429 +766,408 @@ Deep (int ientry, sat_t *sat)
 			a8 = zsing * zsini;
 			a9 = zsing * zsinh + zcosg * zcosi * zcosh;
 			a10 = zcosg * zsini;
-			a2 = sat->deep_arg.cosio * a7 + sat->deep_arg.sinio * a8;
-			a4 = sat->deep_arg.cosio * a9 + sat->deep_arg.sinio * a10;
-			a5 = -sat->deep_arg.sinio * a7 + sat->deep_arg.cosio * a8;
-			a6 = -sat->deep_arg.sinio*a9+ sat->deep_arg.cosio*a10;
-			x1 = a1*sat->deep_arg.cosg+a2*sat->deep_arg.sing;
-			x2 = a3*sat->deep_arg.cosg+a4*sat->deep_arg.sing;
-			x3 = -a1*sat->deep_arg.sing+a2*sat->deep_arg.cosg;
-			x4 = -a3*sat->deep_arg.sing+a4*sat->deep_arg.cosg;
-			x5 = a5*sat->deep_arg.sing;
-			x6 = a6*sat->deep_arg.sing;
-			x7 = a5*sat->deep_arg.cosg;
-			x8 = a6*sat->deep_arg.cosg;
+			a2 = deep_arg->cosio * a7 + deep_arg->sinio * a8;
+			a4 = deep_arg->cosio * a9 + deep_arg->sinio * a10;
+			a5 = -deep_arg->sinio * a7 + deep_arg->cosio * a8;
+			a6 = -deep_arg->sinio*a9+ deep_arg->cosio*a10;
+			x1 = a1*deep_arg->cosg+a2*deep_arg->sing;
+			x2 = a3*deep_arg->cosg+a4*deep_arg->sing;
+			x3 = -a1*deep_arg->sing+a2*deep_arg->cosg;
+			x4 = -a3*deep_arg->sing+a4*deep_arg->cosg;
+			x5 = a5*deep_arg->sing;
+			x6 = a6*deep_arg->sing;
+			x7 = a5*deep_arg->cosg;
+			x8 = a6*deep_arg->cosg;
 			z31 = 12*x1*x1-3*x3*x3;
 			z32 = 24*x1*x2-6*x3*x4;
 			z33 = 12*x2*x2-3*x4*x4;
-			z1 = 3*(a1*a1+a2*a2)+z31*sat->deep_arg.eosq;
-			z2 = 6*(a1*a3+a2*a4)+z32*sat->deep_arg.eosq;
-			z3 = 3*(a3*a3+a4*a4)+z33*sat->deep_arg.eosq;
-			z11 = -6*a1*a5+sat->deep_arg.eosq*(-24*x1*x7-6*x3*x5);
-			z12 = -6*(a1*a6+a3*a5)+ sat->deep_arg.eosq*
+			z1 = 3*(a1*a1+a2*a2)+z31*deep_arg->eosq;
+			z2 = 6*(a1*a3+a2*a4)+z32*deep_arg->eosq;
+			z3 = 3*(a3*a3+a4*a4)+z33*deep_arg->eosq;
+			z11 = -6*a1*a5+deep_arg->eosq*(-24*x1*x7-6*x3*x5);
+			z12 = -6*(a1*a6+a3*a5)+ deep_arg->eosq*
 				(-24*(x2*x7+x1*x8)-6*(x3*x6+x4*x5));
-			z13 = -6*a3*a6+sat->deep_arg.eosq*(-24*x2*x8-6*x4*x6);
-			z21 = 6*a2*a5+sat->deep_arg.eosq*(24*x1*x5-6*x3*x7);
-			z22 = 6*(a4*a5+a2*a6)+ sat->deep_arg.eosq*
+			z13 = -6*a3*a6+deep_arg->eosq*(-24*x2*x8-6*x4*x6);
+			z21 = 6*a2*a5+deep_arg->eosq*(24*x1*x5-6*x3*x7);
+			z22 = 6*(a4*a5+a2*a6)+ deep_arg->eosq*
 				(24*(x2*x5+x1*x6)-6*(x4*x7+x3*x8));
-			z23 = 6*a4*a6+sat->deep_arg.eosq*(24*x2*x6-6*x4*x8);
-			z1 = z1+z1+sat->deep_arg.betao2*z31;
-			z2 = z2+z2+sat->deep_arg.betao2*z32;
-			z3 = z3+z3+sat->deep_arg.betao2*z33;
+			z23 = 6*a4*a6+deep_arg->eosq*(24*x2*x6-6*x4*x8);
+			z1 = z1+z1+deep_arg->betao2*z31;
+			z2 = z2+z2+deep_arg->betao2*z32;
+			z3 = z3+z3+deep_arg->betao2*z33;
 			s3 = cc*xnoi;
-			s2 = -0.5*s3/sat->deep_arg.betao;
-			s4 = s3*sat->deep_arg.betao;
+			s2 = -0.5*s3/deep_arg->betao;
+			s4 = s3*deep_arg->betao;
 			s1 = -15*eq*s4;
 			s5 = x1*x3+x2*x4;
 			s6 = x2*x3+x1*x4;
 			s7 = x2*x4-x1*x3;
 			se = s1*zn*s5;
 			si = s2*zn*(z11+z13);
-			sl = -zn*s3*(z1+z3-14-6*sat->deep_arg.eosq);
+			sl = -zn*s3*(z1+z3-14-6*deep_arg->eosq);
 			sgh = s4*zn*(z31+z33-6);
 			sh = -zn*s2*(z21+z23);
-			if (sat->dps.xqncl < 5.2359877E-2)
+			if (dps->xqncl < 5.2359877E-2)
 				sh = 0;
-			sat->dps.ee2 = 2*s1*s6;
-			sat->dps.e3 = 2*s1*s7;
-			sat->dps.xi2 = 2*s2*z12;
-			sat->dps.xi3 = 2*s2*(z13-z11);
-			sat->dps.xl2 = -2*s3*z2;
-			sat->dps.xl3 = -2*s3*(z3-z1);
-			sat->dps.xl4 = -2*s3*(-21-9*sat->deep_arg.eosq)*ze;
-			sat->dps.xgh2 = 2*s4*z32;
-			sat->dps.xgh3 = 2*s4*(z33-z31);
-			sat->dps.xgh4 = -18*s4*ze;
-			sat->dps.xh2 = -2*s2*z22;
-			sat->dps.xh3 = -2*s2*(z23-z21);
+			dps->ee2 = 2*s1*s6;
+			dps->e3 = 2*s1*s7;
+			dps->xi2 = 2*s2*z12;
+			dps->xi3 = 2*s2*(z13-z11);
+			dps->xl2 = -2*s3*z2;
+			dps->xl3 = -2*s3*(z3-z1);
+			dps->xl4 = -2*s3*(-21-9*deep_arg->eosq)*ze;
+			dps->xgh2 = 2*s4*z32;
+			dps->xgh3 = 2*s4*(z33-z31);
+			dps->xgh4 = -18*s4*ze;
+			dps->xh2 = -2*s2*z22;
+			dps->xh3 = -2*s2*(z23-z21);
 
 			if (sat->flags & LUNAR_TERMS_DONE_FLAG)
 				break;
 
 			/* Do lunar terms */
-			sat->dps.sse = se;
-			sat->dps.ssi = si;
-			sat->dps.ssl = sl;
-			sat->dps.ssh = sh/sat->deep_arg.sinio;
-			sat->dps.ssg = sgh-sat->deep_arg.cosio*sat->dps.ssh;
-			sat->dps.se2 = sat->dps.ee2;
-			sat->dps.si2 = sat->dps.xi2;
-			sat->dps.sl2 = sat->dps.xl2;
-			sat->dps.sgh2 = sat->dps.xgh2;
-			sat->dps.sh2 = sat->dps.xh2;
-			sat->dps.se3 = sat->dps.e3;
-			sat->dps.si3 = sat->dps.xi3;
-			sat->dps.sl3 = sat->dps.xl3;
-			sat->dps.sgh3 = sat->dps.xgh3;
-			sat->dps.sh3 = sat->dps.xh3;
-			sat->dps.sl4 = sat->dps.xl4;
-			sat->dps.sgh4 = sat->dps.xgh4;
-			zcosg = sat->dps.zcosgl;
-			zsing = sat->dps.zsingl;
-			zcosi = sat->dps.zcosil;
-			zsini = sat->dps.zsinil;
-			zcosh = sat->dps.zcoshl*cosq+sat->dps.zsinhl*sinq;
-			zsinh = sinq*sat->dps.zcoshl-cosq*sat->dps.zsinhl;
+			dps->sse = se;
+			dps->ssi = si;
+			dps->ssl = sl;
+			dps->ssh = sh/deep_arg->sinio;
+			dps->ssg = sgh-deep_arg->cosio*dps->ssh;
+			dps->se2 = dps->ee2;
+			dps->si2 = dps->xi2;
+			dps->sl2 = dps->xl2;
+			dps->sgh2 = dps->xgh2;
+			dps->sh2 = dps->xh2;
+			dps->se3 = dps->e3;
+			dps->si3 = dps->xi3;
+			dps->sl3 = dps->xl3;
+			dps->sgh3 = dps->xgh3;
+			dps->sh3 = dps->xh3;
+			dps->sl4 = dps->xl4;
+			dps->sgh4 = dps->xgh4;
+			zcosg = dps->zcosgl;
+			zsing = dps->zsingl;
+			zcosi = dps->zcosil;
+			zsini = dps->zsinil;
+			zcosh = dps->zcoshl*cosq+dps->zsinhl*sinq;
+			zsinh = sinq*dps->zcoshl-cosq*dps->zsinhl;
 			zn = znl;
 			cc = c1l;
 			ze = zel;
 			sat->flags |= LUNAR_TERMS_DONE_FLAG;
 		} /* End of for(;;) */
 
-		sat->dps.sse = sat->dps.sse+se;
-		sat->dps.ssi = sat->dps.ssi+si;
-		sat->dps.ssl = sat->dps.ssl+sl;
-		sat->dps.ssg = sat->dps.ssg+sgh-sat->deep_arg.cosio/sat->deep_arg.sinio*sh;
-		sat->dps.ssh = sat->dps.ssh+sh/sat->deep_arg.sinio;
+		dps->sse = dps->sse+se;
+		dps->ssi = dps->ssi+si;
+		dps->ssl = dps->ssl+sl;
+		dps->ssg = dps->ssg+sgh-deep_arg->cosio/deep_arg->sinio*sh;
+		dps->ssh = dps->ssh+sh/deep_arg->sinio;
 
 		/* Geopotential resonance initialization for 12 hour orbits */
 		sat->flags &= ~RESONANCE_FLAG;
 		sat->flags &= ~SYNCHRONOUS_FLAG;
 
-		if( !((sat->dps.xnq < 0.0052359877) && (sat->dps.xnq > 0.0034906585)) ) {
-			if( (sat->dps.xnq < 0.00826) || (sat->dps.xnq > 0.00924) )
+		if( !((dps->xnq < 0.0052359877) && (dps->xnq > 0.0034906585)) ) {
+			if( (dps->xnq < 0.00826) || (dps->xnq > 0.00924) )
 				return;
 			if (eq < 0.5)
 				return;
 			sat->flags |= RESONANCE_FLAG;
-			eoc = eq*sat->deep_arg.eosq;
+			eoc = eq*deep_arg->eosq;
 			g201 = -0.306-(eq-0.64)*0.440;
 			if (eq <= 0.65) {
-				g211 = 3.616-13.247*eq+16.290*sat->deep_arg.eosq;
+				g211 = 3.616-13.247*eq+16.290*deep_arg->eosq;
 				g310 = -19.302+117.390*eq-228.419*
-					sat->deep_arg.eosq+156.591*eoc;
+					deep_arg->eosq+156.591*eoc;
 				g322 = -18.9068+109.7927*eq-214.6334*
-					sat->deep_arg.eosq+146.5816*eoc;
+					deep_arg->eosq+146.5816*eoc;
 				g410 = -41.122+242.694*eq-471.094*
-					sat->deep_arg.eosq+313.953*eoc;
+					deep_arg->eosq+313.953*eoc;
 				g422 = -146.407+841.880*eq-1629.014*
-					sat->deep_arg.eosq+1083.435*eoc;
+					deep_arg->eosq+1083.435*eoc;
 				g520 = -532.114+3017.977*eq-5740*
-					sat->deep_arg.eosq+3708.276*eoc;
+					deep_arg->eosq+3708.276*eoc;
 			}
 			else {
 				g211 = -72.099+331.819*eq-508.738*
-					sat->deep_arg.eosq+266.724*eoc;
+					deep_arg->eosq+266.724*eoc;
 				g310 = -346.844+1582.851*eq-2415.925*
-					sat->deep_arg.eosq+1246.113*eoc;
+					deep_arg->eosq+1246.113*eoc;
 				g322 = -342.585+1554.908*eq-2366.899*
-					sat->deep_arg.eosq+1215.972*eoc;
+					deep_arg->eosq+1215.972*eoc;
 				g410 = -1052.797+4758.686*eq-7193.992*
-					sat->deep_arg.eosq+3651.957*eoc;
+					deep_arg->eosq+3651.957*eoc;
 				g422 = -3581.69+16178.11*eq-24462.77*
-					sat->deep_arg.eosq+ 12422.52*eoc;
+					deep_arg->eosq+ 12422.52*eoc;
 				if (eq <= 0.715)
-					g520 = 1464.74-4664.75*eq+3763.64*sat->deep_arg.eosq;
+					g520 = 1464.74-4664.75*eq+3763.64*deep_arg->eosq;
 				else
 					g520 = -5149.66+29936.92*eq-54087.36*
-						sat->deep_arg.eosq+31324.56*eoc;
+						deep_arg->eosq+31324.56*eoc;
 			} /* End if (eq <= 0.65) */
 
 			if (eq < 0.7) {
 				g533 = -919.2277+4988.61*eq-9064.77*
-					sat->deep_arg.eosq+5542.21*eoc;
+					deep_arg->eosq+5542.21*eoc;
 				g521 = -822.71072+4568.6173*eq-8491.4146*
-					sat->deep_arg.eosq+5337.524*eoc;
+					deep_arg->eosq+5337.524*eoc;
 				g532 = -853.666+4690.25*eq-8624.77*
-					sat->deep_arg.eosq+ 5341.4*eoc;
+					deep_arg->eosq+ 5341.4*eoc;
 			}
 			else {
 				g533 = -37995.78+161616.52*eq-229838.2*
-					sat->deep_arg.eosq+109377.94*eoc;
+					deep_arg->eosq+109377.94*eoc;
 				g521 = -51752.104+218913.95*eq-309468.16*
-					sat->deep_arg.eosq+146349.42*eoc;
+					deep_arg->eosq+146349.42*eoc;
 				g532 = -40023.88+170470.89*eq-242699.48*
-					sat->deep_arg.eosq+115605.82*eoc;
+					deep_arg->eosq+115605.82*eoc;
 			} /* End if (eq <= 0.7) */
 
-			sini2 = sat->deep_arg.sinio*sat->deep_arg.sinio;
-			f220 = 0.75*(1+2*sat->deep_arg.cosio+sat->deep_arg.theta2);
+			sini2 = deep_arg->sinio*deep_arg->sinio;
+			f220 = 0.75*(1+2*deep_arg->cosio+deep_arg->theta2);
 			f221 = 1.5*sini2;
-			f321 = 1.875*sat->deep_arg.sinio*(1-2*\
-						      sat->deep_arg.cosio-3*sat->deep_arg.theta2);
-			f322 = -1.875*sat->deep_arg.sinio*(1+2*
-						       sat->deep_arg.cosio-3*sat->deep_arg.theta2);
+			f321 = 1.875*deep_arg->sinio*(1-2*\
+						      deep_arg->cosio-3*deep_arg->theta2);
+			f322 = -1.875*deep_arg->sinio*(1+2*
+						       deep_arg->cosio-3*deep_arg->theta2);
 			f441 = 35*sini2*f220;
 			f442 = 39.3750*sini2*sini2;
-			f522 = 9.84375*sat->deep_arg.sinio*(sini2*(1-2*sat->deep_arg.cosio-5*
-							       sat->deep_arg.theta2)+0.33333333*(-2+4*sat->deep_arg.cosio+
-											     6*sat->deep_arg.theta2));
-			f523 = sat->deep_arg.sinio*(4.92187512*sini2*(-2-4*
-								  sat->deep_arg.cosio+10*sat->deep_arg.theta2)+6.56250012
-						*(1+2*sat->deep_arg.cosio-3*sat->deep_arg.theta2));
-			f542 = 29.53125*sat->deep_arg.sinio*(2-8*
-							 sat->deep_arg.cosio+sat->deep_arg.theta2*
-							 (-12+8*sat->deep_arg.cosio+10*sat->deep_arg.theta2));
-			f543 = 29.53125*sat->deep_arg.sinio*(-2-8*sat->deep_arg.cosio+
-							 sat->deep_arg.theta2*(12+8*sat->deep_arg.cosio-10*
-									   sat->deep_arg.theta2));
-			xno2 = sat->dps.xnq*sat->dps.xnq;
+			f522 = 9.84375*deep_arg->sinio*(sini2*(1-2*deep_arg->cosio-5*
+							       deep_arg->theta2)+0.33333333*(-2+4*deep_arg->cosio+
+											     6*deep_arg->theta2));
+			f523 = deep_arg->sinio*(4.92187512*sini2*(-2-4*
+								  deep_arg->cosio+10*deep_arg->theta2)+6.56250012
+						*(1+2*deep_arg->cosio-3*deep_arg->theta2));
+			f542 = 29.53125*deep_arg->sinio*(2-8*
+							 deep_arg->cosio+deep_arg->theta2*
+							 (-12+8*deep_arg->cosio+10*deep_arg->theta2));
+			f543 = 29.53125*deep_arg->sinio*(-2-8*deep_arg->cosio+
+							 deep_arg->theta2*(12+8*deep_arg->cosio-10*
+									   deep_arg->theta2));
+			xno2 = dps->xnq*dps->xnq;
 			ainv2 = aqnv*aqnv;
 			temp1 = 3*xno2*ainv2;
 			temp = temp1*root22;
-			sat->dps.d2201 = temp*f220*g201;
-			sat->dps.d2211 = temp*f221*g211;
+			dps->d2201 = temp*f220*g201;
+			dps->d2211 = temp*f221*g211;
 			temp1 = temp1*aqnv;
 			temp = temp1*root32;
-			sat->dps.d3210 = temp*f321*g310;
-			sat->dps.d3222 = temp*f322*g322;
+			dps->d3210 = temp*f321*g310;
+			dps->d3222 = temp*f322*g322;
 			temp1 = temp1*aqnv;
 			temp = 2*temp1*root44;
-			sat->dps.d4410 = temp*f441*g410;
-			sat->dps.d4422 = temp*f442*g422;
+			dps->d4410 = temp*f441*g410;
+			dps->d4422 = temp*f442*g422;
 			temp1 = temp1*aqnv;
 			temp = temp1*root52;
-			sat->dps.d5220 = temp*f522*g520;
-			sat->dps.d5232 = temp*f523*g532;
+			dps->d5220 = temp*f522*g520;
+			dps->d5232 = temp*f523*g532;
 			temp = 2*temp1*root54;
-			sat->dps.d5421 = temp*f542*g521;
-			sat->dps.d5433 = temp*f543*g533;
-			sat->dps.xlamo = xmao+sat->tle.xnodeo+sat->tle.xnodeo-sat->dps.thgr-sat->dps.thgr;
-			bfact = sat->deep_arg.xmdot+sat->deep_arg.xnodot+
-				sat->deep_arg.xnodot-thdt-thdt;
-			bfact = bfact+sat->dps.ssl+sat->dps.ssh+sat->dps.ssh;
-		} /* if( !(sat->dps.xnq < 0.0052359877) && (sat->dps.xnq > 0.0034906585) ) */
+			dps->d5421 = temp*f542*g521;
+			dps->d5433 = temp*f543*g533;
+			dps->xlamo = xmao+sat->tle.xnodeo+sat->tle.xnodeo-dps->thgr-dps->thgr;
+			bfact = deep_arg->xmdot+deep_arg->xnodot+
+				deep_arg->xnodot-thdt-thdt;
+			bfact = bfact+dps->ssl+dps->ssh+dps->ssh;
+		} /* if( !(dps->xnq < 0.0052359877) && (dps->xnq > 0.0034906585) ) */
 		else {
 			sat->flags |= RESONANCE_FLAG;
 			sat->flags |= SYNCHRONOUS_FLAG;
 			/* Synchronous resonance terms initialization */
-			g200 = 1+sat->deep_arg.eosq*(-2.5+0.8125*sat->deep_arg.eosq);
-			g310 = 1+2*sat->deep_arg.eosq;
-			g300 = 1+sat->deep_arg.eosq*(-6+6.60937*sat->deep_arg.eosq);
-			f220 = 0.75*(1+sat->deep_arg.cosio)*(1+sat->deep_arg.cosio);
-			f311 = 0.9375*sat->deep_arg.sinio*sat->deep_arg.sinio*
-				(1+3*sat->deep_arg.cosio)-0.75*(1+sat->deep_arg.cosio);
-			f330 = 1+sat->deep_arg.cosio;
+			g200 = 1+deep_arg->eosq*(-2.5+0.8125*deep_arg->eosq);
+			g310 = 1+2*deep_arg->eosq;
+			g300 = 1+deep_arg->eosq*(-6+6.60937*deep_arg->eosq);
+			f220 = 0.75*(1+deep_arg->cosio)*(1+deep_arg->cosio);
+			f311 = 0.9375*deep_arg->sinio*deep_arg->sinio*
+				(1+3*deep_arg->cosio)-0.75*(1+deep_arg->cosio);
+			f330 = 1+deep_arg->cosio;
 			f330 = 1.875*f330*f330*f330;
-			sat->dps.del1 = 3*sat->dps.xnq*sat->dps.xnq*aqnv*aqnv;
-			sat->dps.del2 = 2*sat->dps.del1*f220*g200*q22;
-			sat->dps.del3 = 3*sat->dps.del1*f330*g300*q33*aqnv;
-			sat->dps.del1 = sat->dps.del1*f311*g310*q31*aqnv;
-			sat->dps.fasx2 = 0.13130908;
-			sat->dps.fasx4 = 2.8843198;
-			sat->dps.fasx6 = 0.37448087;
-			sat->dps.xlamo = xmao+sat->tle.xnodeo+sat->tle.omegao-sat->dps.thgr;
-			bfact = sat->deep_arg.xmdot+xpidot-thdt;
-			bfact = bfact+sat->dps.ssl+sat->dps.ssg+sat->dps.ssh;
+			dps->del1 = 3*dps->xnq*dps->xnq*aqnv*aqnv;
+			dps->del2 = 2*dps->del1*f220*g200*q22;
+			dps->del3 = 3*dps->del1*f330*g300*q33*aqnv;
+			dps->del1 = dps->del1*f311*g310*q31*aqnv;
+			dps->fasx2 = 0.13130908;
+			dps->fasx4 = 2.8843198;
+			dps->fasx6 = 0.37448087;
+			dps->xlamo = xmao+sat->tle.xnodeo+sat->tle.omegao-dps->thgr;
+			bfact = deep_arg->xmdot+xpidot-thdt;
+			bfact = bfact+dps->ssl+dps->ssg+dps->ssh;
 		} /* End if( !(xnq < 0.0052359877) && (xnq > 0.0034906585) ) */
 
-		sat->dps.xfact = bfact-sat->dps.xnq;
+		dps->xfact = bfact-dps->xnq;
 
 		/* Initialize integrator */
-		sat->dps.xli = sat->dps.xlamo;
-		sat->dps.xni = sat->dps.xnq;
-		sat->dps.atime = 0;
-		sat->dps.stepp = 720;
-		sat->dps.stepn = -720;
-		sat->dps.step2 = 259200;
+		sat->dstate.xli = dps->xlamo;
+		sat->dstate.xni = dps->xnq;
+		sat->dstate.atime = 0;
+		dps->stepp = 720;
+		dps->stepn = -720;
+		dps->step2 = 259200;
 		/* End case dpinit: */
 		return;
 
 	case dpsec: /* Entrance for deep space secular effects */
-		sat->deep_arg.xll = sat->deep_arg.xll+sat->dps.ssl*sat->deep_arg.t;
-		sat->deep_arg.omgadf = sat->deep_arg.omgadf+sat->dps.ssg*sat->deep_arg.t;
-		sat->deep_arg.xnode = sat->deep_arg.xnode+sat->dps.ssh*sat->deep_arg.t;
-		sat->deep_arg.em = sat->tle.eo+sat->dps.sse*sat->deep_arg.t;
-		sat->deep_arg.xinc = sat->tle.xincl+sat->dps.ssi*sat->deep_arg.t;
-		if (sat->deep_arg.xinc < 0) {
-			sat->deep_arg.xinc = -sat->deep_arg.xinc;
-			sat->deep_arg.xnode = sat->deep_arg.xnode + pi;
-			sat->deep_arg.omgadf = sat->deep_arg.omgadf-pi;
+		deep_arg->xll = deep_arg->xll+dps->ssl*deep_arg->t;
+		deep_arg->omgadf = deep_arg->omgadf+dps->ssg*deep_arg->t;
+		deep_arg->xnode = deep_arg->xnode+dps->ssh*deep_arg->t;
+		deep_arg->em = sat->tle.eo+dps->sse*deep_arg->t;
+		deep_arg->xinc = sat->tle.xincl+dps->ssi*deep_arg->t;
+		if (deep_arg->xinc < 0) {
+			deep_arg->xinc = -deep_arg->xinc;
+			deep_arg->xnode = deep_arg->xnode + pi;
+			deep_arg->omgadf = deep_arg->omgadf-pi;
 		}
 		if( ~sat->flags & RESONANCE_FLAG ) return;
 
-		do {
-			if( (sat->dps.atime == 0) ||
-			    ((sat->deep_arg.t >= 0) && (sat->dps.atime < 0)) || 
-			    ((sat->deep_arg.t < 0) && (sat->dps.atime >= 0)) ) {
-				/* Epoch restart */
-				if( sat->deep_arg.t >= 0 )
-					delt = sat->dps.stepp;
-				else
-					delt = sat->dps.stepn;
+		side = (deep_arg->t < 0);
+		delt = side ? dps->stepn : dps->stepp;
 
-				sat->dps.atime = 0;
-				sat->dps.xni = sat->dps.xnq;
-				sat->dps.xli = sat->dps.xlamo;
-			}
-			else {	  
-				if( fabs(sat->deep_arg.t) >= fabs(sat->dps.atime) ) {
-					if ( sat->deep_arg.t > 0 )
-						delt = sat->dps.stepp;
-					else
-						delt = sat->dps.stepn;
-				}
+		/* The current state can be used if it lies between epoch */
+		/* and t. If it is more than CKPT_STEPS steps away from t */
+		/* a checkpoint may be closer.                            */
+		if ((side ? sat->dstate.atime > 0 : sat->dstate.atime < 0) ||
+			fabs (deep_arg->t) < fabs (sat->dstate.atime))
+			nstep = -1;
+		else
+			nstep = (int) (fabs (sat->dstate.atime) / dps->stepp + 0.5);
+
+		if (nstep < 0 ||
+			fabs (deep_arg->t-sat->dstate.atime) >= CKPT_STEPS*dps->stepp)
+			nstep = ckpt_restore (sat, deep_arg->t, side, nstep);
+
+		for (;;) {
+			if (fabs (deep_arg->t-sat->dstate.atime) < dps->stepp)
+				ft = deep_arg->t-sat->dstate.atime;
+
+			/* Dot terms calculated */
+			if (sat->flags & SYNCHRONOUS_FLAG) {
+				xndot = dps->del1*sin(sat->dstate.xli-dps->fasx2)+dps->del2*sin(2*(sat->dstate.xli-dps->fasx4))
+					+dps->del3*sin(3*(sat->dstate.xli-dps->fasx6));
+				xnddt = dps->del1*cos(sat->dstate.xli-dps->fasx2)+2*dps->del2*cos(2*(sat->dstate.xli-dps->fasx4))
+					+3*dps->del3*cos(3*(sat->dstate.xli-dps->fasx6));
 			}
+			else {
+				xomi = dps->omegaq+deep_arg->omgdot*sat->dstate.atime;
+				x2omi = xomi+xomi;
+				x2li = sat->dstate.xli+sat->dstate.xli;
+				xndot = dps->d2201*sin(x2omi+sat->dstate.xli-g22)
+					+dps->d2211*sin(sat->dstate.xli-g22)
+					+dps->d3210*sin(xomi+sat->dstate.xli-g32)
+					+dps->d3222*sin(-xomi+sat->dstate.xli-g32)
+					+dps->d4410*sin(x2omi+x2li-g44)
+					+dps->d4422*sin(x2li-g44)
+					+dps->d5220*sin(xomi+sat->dstate.xli-g52)
+					+dps->d5232*sin(-xomi+sat->dstate.xli-g52)
+					+dps->d5421*sin(xomi+x2li-g54)
+					+dps->d5433*sin(-xomi+x2li-g54);
+				xnddt = dps->d2201*cos(x2omi+sat->dstate.xli-g22)
+					+dps->d2211*cos(sat->dstate.xli-g22)
+					+dps->d3210*cos(xomi+sat->dstate.xli-g32)
+					+dps->d3222*cos(-xomi+sat->dstate.xli-g32)
+					+dps->d5220*cos(xomi+sat->dstate.xli-g52)
+					+dps->d5232*cos(-xomi+sat->dstate.xli-g52)
+					+2*(dps->d4410*cos(x2omi+x2li-g44)
+					    +dps->d4422*cos(x2li-g44)
+					    +dps->d5421*cos(xomi+x2li-g54)
+					    +dps->d5433*cos(-xomi+x2li-g54));
+			} /* End of if (isFlagSet(SYNCHRONOUS_FLAG)) */
+
+			xldot = sat->dstate.xni+dps->xfact;
+			xnddt = xnddt*xldot;
+
+			if (fabs (deep_arg->t-sat->dstate.atime) < dps->stepp)
+				break;
 
-			do {
-				if ( fabs(sat->deep_arg.t-sat->dps.atime) >= sat->dps.stepp ) {
-					sat->flags |= DO_LOOP_FLAG;
-					sat->flags &= ~EPOCH_RESTART_FLAG;
-				}
-				else {
-					ft = sat->deep_arg.t-sat->dps.atime;
-					sat->flags &= ~DO_LOOP_FLAG;
-				}
-
-				if( fabs(sat->deep_arg.t) < fabs(sat->dps.atime) ) {
-					if (sat->deep_arg.t >= 0)
-						delt = sat->dps.stepn;
-					else
-						delt = sat->dps.stepp;
-					sat->flags |= (DO_LOOP_FLAG | EPOCH_RESTART_FLAG);
-				}
-
-				/* Dot terms calculated */
-				if (sat->flags & SYNCHRONOUS_FLAG) {
-					xndot = sat->dps.del1*sin(sat->dps.xli-sat->dps.fasx2)+sat->dps.del2*sin(2*(sat->dps.xli-sat->dps.fasx4))
-						+sat->dps.del3*sin(3*(sat->dps.xli-sat->dps.fasx6));
-					xnddt = sat->dps.del1*cos(sat->dps.xli-sat->dps.fasx2)+2*sat->dps.del2*cos(2*(sat->dps.xli-sat->dps.fasx4))
-						+3*sat->dps.del3*cos(3*(sat->dps.xli-sat->dps.fasx6));
-				}
-				else {
-					xomi = sat->dps.omegaq+sat->deep_arg.omgdot*sat->dps.atime;
-					x2omi = xomi+xomi;
-					x2li = sat->dps.xli+sat->dps.xli;
-					xndot = sat->dps.d2201*sin(x2omi+sat->dps.xli-g22)
-						+sat->dps.d2211*sin(sat->dps.xli-g22)
-						+sat->dps.d3210*sin(xomi+sat->dps.xli-g32)
-						+sat->dps.d3222*sin(-xomi+sat->dps.xli-g32)
-						+sat->dps.d4410*sin(x2omi+x2li-g44)
-						+sat->dps.d4422*sin(x2li-g44)
-						+sat->dps.d5220*sin(xomi+sat->dps.xli-g52)
-						+sat->dps.d5232*sin(-xomi+sat->dps.xli-g52)
-						+sat->dps.d5421*sin(xomi+x2li-g54)
-						+sat->dps.d5433*sin(-xomi+x2li-g54);
-					xnddt = sat->dps.d2201*cos(x2omi+sat->dps.xli-g22)
-						+sat->dps.d2211*cos(sat->dps.xli-g22)
-						+sat->dps.d3210*cos(xomi+sat->dps.xli-g32)
-						+sat->dps.d3222*cos(-xomi+sat->dps.xli-g32)
-						+sat->dps.d5220*cos(xomi+sat->dps.xli-g52)
-						+sat->dps.d5232*cos(-xomi+sat->dps.xli-g52)
-						+2*(sat->dps.d4410*cos(x2omi+x2li-g44)
-						    +sat->dps.d4422*cos(x2li-g44)
-						    +sat->dps.d5421*cos(xomi+x2li-g54)
-						    +sat->dps.d5433*cos(-xomi+x2li-g54));
-				} /* End of if (isFlagSet(SYNCHRONOUS_FLAG)) */
-
-				xldot = sat->dps.xni+sat->dps.xfact;
-				xnddt = xnddt*xldot;
-
-				if(sat->flags & DO_LOOP_FLAG) {
-					sat->dps.xli = sat->dps.xli+xldot*delt+xndot*sat->dps.step2;
-					sat->dps.xni = sat->dps.xni+xndot*delt+xnddt*sat->dps.step2;
-					sat->dps.atime = sat->dps.atime+delt;
-				}
-			}
-			while ( (sat->flags & DO_LOOP_FLAG) &&
-				(~sat->flags & EPOCH_RESTART_FLAG));
+			sat->dstate.xli = sat->dstate.xli+xldot*delt+xndot*dps->step2;
+			sat->dstate.xni = sat->dstate.xni+xndot*delt+xnddt*dps->step2;
+			sat->dstate.atime = sat->dstate.atime+delt;
+
+			if (++nstep % CKPT_STEPS == 0)
+				ckpt_save (sat, side, nstep);
 		}
-		while ((sat->flags & DO_LOOP_FLAG) && (sat->flags & EPOCH_RESTART_FLAG));
 
-		sat->deep_arg.xn = sat->dps.xni+xndot*ft+xnddt*ft*ft*0.5;
-		xl = sat->dps.xli+xldot*ft+xndot*ft*ft*0.5;
-		temp = -sat->deep_arg.xnode+sat->dps.thgr+sat->deep_arg.t*thdt;
+		deep_arg->xn = sat->dstate.xni+xndot*ft+xnddt*ft*ft*0.5;
+		xl = sat->dstate.xli+xldot*ft+xndot*ft*ft*0.5;
+		temp = -deep_arg->xnode+dps->thgr+deep_arg->t*thdt;
 
 		if (~sat->flags & SYNCHRONOUS_FLAG)
-			sat->deep_arg.xll = xl+temp+temp;
+			deep_arg->xll = xl+temp+temp;
 		else
-			sat->deep_arg.xll = xl-sat->deep_arg.omgadf+temp;
+			deep_arg->xll = xl-deep_arg->omgadf+temp;
 
 		return;
 		/*End case dpsec: */
 
 	case dpper: /* Entrance for lunar-solar periodics */
-		sinis = sin(sat->deep_arg.xinc);
-		cosis = cos(sat->deep_arg.xinc);
-		if (fabs(sat->dps.savtsn-sat->deep_arg.t) >= 30) {
-			sat->dps.savtsn = sat->deep_arg.t;
-			zm = sat->dps.zmos+zns*sat->deep_arg.t;
+		sinis = sin(deep_arg->xinc);
+		cosis = cos(deep_arg->xinc);
+		if (fabs(sat->dstate.savtsn-deep_arg->t) >= 30) {
+			sat->dstate.savtsn = deep_arg->t;
+			zm = dps->zmos+zns*deep_arg->t;
 			zf = zm+2*zes*sin(zm);
 			sinzf = sin(zf);
 			f2 = 0.5*sinzf*sinzf-0.25;
 			f3 = -0.5*sinzf*cos(zf);
-			ses = sat->dps.se2*f2+sat->dps.se3*f3;
-			sis = sat->dps.si2*f2+sat->dps.si3*f3;
-			sls = sat->dps.sl2*f2+sat->dps.sl3*f3+sat->dps.sl4*sinzf;
-			sat->dps.sghs = sat->dps.sgh2*f2+sat->dps.sgh3*f3+sat->dps.sgh4*sinzf;
-			sat->dps.shs = sat->dps.sh2*f2+sat->dps.sh3*f3;
-			zm = sat->dps.zmol+znl*sat->deep_arg.t;
+			ses = dps->se2*f2+dps->se3*f3;
+			sis = dps->si2*f2+dps->si3*f3;
+			sls = dps->sl2*f2+dps->sl3*f3+dps->sl4*sinzf;
+			sat->dstate.sghs = dps->sgh2*f2+dps->sgh3*f3+dps->sgh4*sinzf;
+			sat->dstate.shs = dps->sh2*f2+dps->sh3*f3;
+			zm = dps->zmol+znl*deep_arg->t;
 			zf = zm+2*zel*sin(zm);
 			sinzf = sin(zf);
 			f2 = 0.5*sinzf*sinzf-0.25;
 			f3 = -0.5*sinzf*cos(zf);
-			sel = sat->dps.ee2*f2+sat->dps.e3*f3;
-			sil = sat->dps.xi2*f2+sat->dps.xi3*f3;
-			sll = sat->dps.xl2*f2+sat->dps.xl3*f3+sat->dps.xl4*sinzf;
-			sat->dps.sghl = sat->dps.xgh2*f2+sat->dps.xgh3*f3+sat->dps.xgh4*sinzf;
-			sat->dps.sh1 = sat->dps.xh2*f2+sat->dps.xh3*f3;
-			sat->dps.pe = ses+sel;
-			sat->dps.pinc = sis+sil;
-			sat->dps.pl = sls+sll;
+			sel = dps->ee2*f2+dps->e3*f3;
+			sil = dps->xi2*f2+dps->xi3*f3;
+			sll = dps->xl2*f2+dps->xl3*f3+dps->xl4*sinzf;
+			sat->dstate.sghl = dps->xgh2*f2+dps->xgh3*f3+dps->xgh4*sinzf;
+			sat->dstate.sh1 = dps->xh2*f2+dps->xh3*f3;
+			sat->dstate.pe = ses+sel;
+			sat->dstate.pinc = sis+sil;
+			sat->dstate.pl = sls+sll;
 		}
 
-		pgh = sat->dps.sghs+sat->dps.sghl;
-		ph = sat->dps.shs+sat->dps.sh1;
-		sat->deep_arg.xinc = sat->deep_arg.xinc+sat->dps.pinc;
-		sat->deep_arg.em = sat->deep_arg.em+sat->dps.pe;
+		pgh = sat->dstate.sghs+sat->dstate.sghl;
+		ph = sat->dstate.shs+sat->dstate.sh1;
+		deep_arg->xinc = deep_arg->xinc+sat->dstate.pinc;
+		deep_arg->em = deep_arg->em+sat->dstate.pe;
 
-		if (sat->dps.xqncl >= 0.2) {
+		if (dps->xqncl >= 0.2) {
 			/* Apply periodics directly */
-			ph = ph/sat->deep_arg.sinio;
-			pgh = pgh-sat->deep_arg.cosio*ph;
-			sat->deep_arg.omgadf = sat->deep_arg.omgadf+pgh;
-			sat->deep_arg.xnode = sat->deep_arg.xnode+ph;
-			sat->deep_arg.xll = sat->deep_arg.xll+sat->dps.pl;
+			ph = ph/deep_arg->sinio;
+			pgh = pgh-deep_arg->cosio*ph;
+			deep_arg->omgadf = deep_arg->omgadf+pgh;
+			deep_arg->xnode = deep_arg->xnode+ph;
+			deep_arg->xll = deep_arg->xll+sat->dstate.pl;
 		}
 		else {
 			/* Apply periodics with Lyddane modification */
-			sinok = sin(sat->deep_arg.xnode);
-			cosok = cos(sat->deep_arg.xnode);
+			sinok = sin(deep_arg->xnode);
+			cosok = cos(deep_arg->xnode);
 			alfdp = sinis*sinok;
 			betdp = sinis*cosok;
-			dalf = ph*cosok+sat->dps.pinc*cosis*sinok;
-			dbet = -ph*sinok+sat->dps.pinc*cosis*cosok;
+			dalf = ph*cosok+sat->dstate.pinc*cosis*sinok;
+			dbet = -ph*sinok+sat->dstate.pinc*cosis*cosok;
 			alfdp = alfdp+dalf;
 			betdp = betdp+dbet;
-			sat->deep_arg.xnode = FMod2p(sat->deep_arg.xnode);
-			xls = sat->deep_arg.xll+sat->deep_arg.omgadf+cosis*sat->deep_arg.xnode;
-			dls = sat->dps.pl+pgh-sat->dps.pinc*sat->deep_arg.xnode*sinis;
+			deep_arg->xnode = FMod2p(deep_arg->xnode);
+			xls = deep_arg->xll+deep_arg->omgadf+cosis*deep_arg->xnode;
+			dls = sat->dstate.pl+pgh-sat->dstate.pinc*deep_arg->xnode*sinis;
 			xls = xls+dls;
-			xnoh = sat->deep_arg.xnode;
-			sat->deep_arg.xnode = AcTan(alfdp,betdp);
+			xnoh = deep_arg->xnode;
+			deep_arg->xnode = AcTan(alfdp,betdp);
 
 			/* This is a patch to Lyddane modification */
 			/* suggested by Rob Matson. */
-			if(fabs(xnoh-sat->deep_arg.xnode) > pi) {
-				if(sat->deep_arg.xnode < xnoh)
-					sat->deep_arg.xnode +=twopi;
+			if(fabs(xnoh-deep_arg->xnode) > pi) {
+				if(deep_arg->xnode < xnoh)
+					deep_arg->xnode +=twopi;
 				else
-					sat->deep_arg.xnode -=twopi;
+					deep_arg->xnode -=twopi;
 			}
 
-			sat->deep_arg.xll = sat->deep_arg.xll+sat->dps.pl;
-			sat->deep_arg.omgadf = xls-sat->deep_arg.xll-cos(sat->deep_arg.xinc)*
-				sat->deep_arg.xnode;
+			deep_arg->xll = deep_arg->xll+sat->dstate.pl;
+			deep_arg->omgadf = xls-deep_arg->xll-cos(deep_arg->xinc)*
+				deep_arg->xnode;
 		} /* End case dpper: */
 		return;
 
@@ -139,16 +139,44 @@ typedef struct {
 
 /* static data for DEEP */
 typedef struct {
-	double thgr,xnq,xqncl,omegaq,zmol,zmos,savtsn,ee2,e3,xi2;
+	double thgr,xnq,xqncl,omegaq,zmol,zmos,ee2,e3,xi2;
 	double xl2,xl3,xl4,xgh2,xgh3,xgh4,xh2,xh3,sse,ssi,ssg,xi3;
 	double se2,si2,sl2,sgh2,sh2,se3,si3,sl3,sgh3,sh3,sl4,sgh4;
 	double ssl,ssh,d3210,d3222,d4410,d4422,d5220,d5232,d5421;
 	double d5433,del1,del2,del3,fasx2,fasx4,fasx6,xlamo,xfact;
-	double xni,atime,stepp,stepn,step2,preep,pl,sghs,xli;
-	double d2201,d2211,sghl,sh1,pinc,pe,shs,zsingl,zcosgl;
+	double stepp,stepn,step2,preep;
+	double d2201,d2211,zsingl,zcosgl;
 	double zsinhl,zcoshl,zsinil,zcosil;
 } deep_static_t;
 
+/* DEEP data that changes during propagation: the resonance
+   integrator and the cached lunar-solar periodics */
+typedef struct {
+	double atime,xli,xni;
+	double savtsn,sghs,shs,sghl,sh1,pe,pinc,pl;
+} deep_state_t;
+
+/* constant data for SDP4 and DEEP */
+typedef struct {
+	deep_arg_t      deep_arg;  /* dpinit part of the deep-space args */
+	deep_static_t   dps;
+	struct deep_ckpt *ckpt;    /* resonance integrator checkpoints */
+} deep_const_t;
+
+/** \brief Propagator constants
+ *  \ingroup sgpsdpif
+ *
+ * Computed once per element set by SGP4() or SDP4() and shared by all
+ * copies of the satellite made with Sat_Copy(). The deep-space part
+ * is only allocated for objects propagated with SDP4().
+ */
+typedef struct {
+	int             refcount;
+	int             flags;     /*!< Flags set by the initialization */
+	sgpsdp_static_t sgps;
+	deep_const_t   *deep;      /*!< Deep-space constants or NULL */
+} sgpsdp_const_t;
+
 /** \brief Satellite data structure
  *  \ingroup sgpsdpif
  *
@@ -159,17 +187,11 @@ typedef struct {
         char           *website;
 	tle_t           tle;     /*!< Keplerian elements */
 	int             flags;   /*!< Flags for algo ctrl */
-	sgpsdp_static_t sgps;
-	deep_static_t   dps;
-	deep_arg_t      deep_arg;
+	sgpsdp_const_t *consts;    /*!< Propagator constants (shared) */
+	deep_state_t    dstate;    /*!< Deep-space integrator state */
 	vector_t        pos;       /*!< Raw position and range */
 	vector_t        vel;       /*!< Raw velocity */
 
-	/*** FIXME: REMOVE */
-	obs_set_t       bearing;   /*!< Az, El, range and vel */
-	obs_astro_t     astro;     /*!< Ra and Decl */
-	/*** END */
-
 	/* time keeping fields */
 	double          jul_epoch;
 	double          jul_utc;
@@ -290,7 +312,8 @@ FIXME: Change to enu */
 /* sgp4sdp4.c */
 void    SGP4 (sat_t *sat, double tsince);
 void    SDP4 (sat_t *sat, double tsince);
-void    Deep (int ientry, sat_t *sat);
+void    Deep (int ientry, sat_t *sat, deep_arg_t *deep_arg);
+void    Free_Consts (sgpsdp_const_t *consts);
 int     isFlagSet(int flag);
 int     isFlagClear(int flag);
 void    SetFlag(int flag);
@@ -302,6 +325,8 @@ int     Good_Elements(char *tle_set);
 void    Convert_Satellite_Data(char *tle_set, tle_t *tle);
 int     Get_Next_Tle_Set( char lines[3][80], tle_t *tle );
 void    select_ephemeris(sat_t *sat);
+void    Sat_Copy(sat_t *dest, const sat_t *src);
+void    Sat_Release(sat_t *sat);
 
 /* sgp_math.c */
 int     Sign(double arg);
@@ -349,6 +349,8 @@ Get_Next_Tle_Set (char line[3][80], tle_t *tle)
 /* for predictions according to the data in the TLE */
 /* It also processes values in the tle set so that  */
 /* they are apropriate for the sgp4/sdp4 routines   */
+/* The satellite must be zeroed or hold a reference */
+/* on its propagator constants, which is released.  */
 void
 select_ephemeris (sat_t *sat)
 {
@@ -389,8 +391,46 @@ select_ephemeris (sat_t *sat)
 	else
 		sat->flags &= ~DEEP_SPACE_EPHEM_FLAG;
 
+	/* Compute the propagator constants of the new elements right */
+	/* away so that all copies of the satellite can share them     */
+	Sat_Release (sat);
+	sat->flags &= ~(SGP4_INITIALIZED_FLAG | SDP4_INITIALIZED_FLAG);
+	if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+		SDP4 (sat, 0.0);
+	else
+		SGP4 (sat, 0.0);
+
 	return;
 } /* End of select_ephemeris() */
 
 /*------------------------------------------------------------------*/
 
+/* Copies a satellite and takes a reference on its propagator   */
+/* constants. The copy must be released with Sat_Release(). The */
+/* name strings are not duplicated. Copies that do not outlive  */
+/* the source, e.g. for what-if computations, can use a plain   */
+/* memcpy() and must not be released.                          */
+void
+Sat_Copy (sat_t *dest, const sat_t *src)
+{
+	memcpy (dest, src, sizeof (sat_t));
+
+	if (dest->consts != NULL)
+		g_atomic_int_inc (&dest->consts->refcount);
+}
+
+/*------------------------------------------------------------------*/
+
+/* Releases the propagator constants of a satellite */
+void
+Sat_Release (sat_t *sat)
+{
+	if (sat->consts != NULL &&
+		g_atomic_int_dec_and_test (&sat->consts->refcount))
+		Free_Consts (sat->consts);
+
+	sat->consts = NULL;
+}
+
+/*------------------------------------------------------------------*/
+
@@ -32,10 +32,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <unistd.h>
 #include "sgp4sdp4.h"
 
 #define TEST_STEPS 5
 
+/* The expected values are given with limited precision */
+#define POS_TOL    0.05         /* km */
+#define VEL_TOL    0.00005      /* km/s */
+
 /* structure to hold a set of data */
 typedef struct {
     double          t;
@@ -73,7 +78,11 @@ sat_t           sat;
 int main(void)
 {
     FILE           *fp;
-    int             i;
+    int             i, errors = 0;
+
+    /* make check runs the tests in the build directory */
+    if (getenv("srcdir") != NULL && chdir(getenv("srcdir")) != 0)
+        return 1;
 
     /* read tle file */
     fp = fopen("test-002.tle", "r");
@@ -160,7 +169,18 @@ int main(void)
                sat.vel.z, expected[i].vz, fabs(sat.vel.z - expected[i].vz),
                100.0 * fabs(sat.vel.z -
                             expected[i].vz) / fabs(expected[i].vz));
+
+        if (fabs(sat.pos.x - expected[i].x) > POS_TOL ||
+            fabs(sat.pos.y - expected[i].y) > POS_TOL ||
+            fabs(sat.pos.z - expected[i].z) > POS_TOL ||
+            fabs(sat.vel.x - expected[i].vx) > VEL_TOL ||
+            fabs(sat.vel.y - expected[i].vy) > VEL_TOL ||
+            fabs(sat.vel.z - expected[i].vz) > VEL_TOL)
+        {
+            printf("STEP %d FAILED\n", i + 1);
+            errors++;
+        }
     }
 
-    return 0;
+    return errors > 0;
 }
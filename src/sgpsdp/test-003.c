@@ -0,0 +1,166 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/*
+ * Random access test and benchmark for the SDP4 resonance integrator.
+ *
+ * For each satellite in test-003.tle the position and velocity at random
+ * times before and after epoch are computed by one satellite in random
+ * order and compared to a new satellite integrating from epoch for each
+ * time. The results must be identical. The time used for random access
+ * and for stepping forward in time is printed.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <time.h>
+#include "sgp4sdp4.h"
+
+#define TEST_QUERIES  200
+#define BENCH_QUERIES 100000
+#define MIN_DAYS      -30.0
+#define MAX_DAYS      3650.0
+
+/* reproducible random numbers */
+static unsigned long seed = 1;
+
+static double random_time(void)
+{
+    seed = seed * 1103515245UL + 12345UL;
+    return (MIN_DAYS + (MAX_DAYS - MIN_DAYS) *
+            ((seed >> 16) & 0x7fff) / 32767.0) * xmnpda;
+}
+
+static void propagate(sat_t * sat, double t)
+{
+    /* don't reuse the lunar-solar periodics of the previous time */
+    sat->dstate.savtsn = 1E20;
+    SDP4(sat, t);
+}
+
+static int test_sat(char tle_str[3][80])
+{
+    sat_t           sat, ref;
+    tle_t           tle;
+    double          t[TEST_QUERIES];
+    double          t0, dt;
+    clock_t         start;
+    int             i, errors = 0;
+
+    memset(&sat, 0, sizeof(sat));
+    if (Get_Next_Tle_Set(tle_str, &sat.tle) != 1)
+    {
+        printf("Could not read TLE data\n");
+        return 1;
+    }
+    tle = sat.tle;
+    select_ephemeris(&sat);
+
+    printf("%s", tle_str[0]);
+    if (~sat.flags & RESONANCE_FLAG)
+    {
+        printf("  not resonant, skipped\n");
+        Sat_Release(&sat);
+        return 0;
+    }
+
+    /* random access compared to integration from epoch */
+    for (i = 0; i < TEST_QUERIES; i++)
+        t[i] = random_time();
+
+    for (i = 0; i < TEST_QUERIES; i++)
+    {
+        memset(&ref, 0, sizeof(ref));
+        ref.tle = tle;
+        select_ephemeris(&ref);
+        propagate(&ref, t[i]);
+        Sat_Release(&ref);
+
+        propagate(&sat, t[i]);
+
+        if (memcmp(&sat.pos, &ref.pos, sizeof(vector_t)) ||
+            memcmp(&sat.vel, &ref.vel, sizeof(vector_t)))
+        {
+            if (errors++ < 10)
+                printf("  MISMATCH at t = %.1f min: dX = %g dY = %g dZ = %g\n",
+                       t[i], sat.pos.x - ref.pos.x, sat.pos.y - ref.pos.y,
+                       sat.pos.z - ref.pos.z);
+        }
+    }
+    printf("  %d random access queries, %d mismatches\n",
+           TEST_QUERIES, errors);
+
+    /* benchmark */
+    start = clock();
+    for (i = 0; i < BENCH_QUERIES; i++)
+        propagate(&sat, random_time());
+    printf("  random access:  %.0f queries/s\n",
+           BENCH_QUERIES / ((double)(clock() - start) / CLOCKS_PER_SEC));
+
+    t0 = random_time();
+    dt = (MAX_DAYS * xmnpda - t0) / BENCH_QUERIES;
+    start = clock();
+    for (i = 0; i < BENCH_QUERIES; i++)
+        propagate(&sat, t0 + i * dt);
+    printf("  forward steps:  %.0f queries/s\n",
+           BENCH_QUERIES / ((double)(clock() - start) / CLOCKS_PER_SEC));
+
+    Sat_Release(&sat);
+
+    return errors > 0;
+}
+
+int main(void)
+{
+    FILE           *fp;
+    char            tle_str[3][80];
+    int             result = 0;
+
+    /* make check runs the tests in the build directory */
+    if (getenv("srcdir") != NULL && chdir(getenv("srcdir")) != 0)
+        return 1;
+
+    fp = fopen("test-003.tle", "r");
+    if (fp == NULL)
+    {
+        printf("Could not open test-003.tle\n");
+        return 1;
+    }
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+        result |= test_sat(tle_str);
+
+    fclose(fp);
+
+    return result;
+}
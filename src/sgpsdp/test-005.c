@@ -0,0 +1,174 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/*
+ * Verification test for SGP4 and SDP4 with published values.
+ *
+ * Propagates the satellites in test-005.tle and compares the position and
+ * velocity to the values in test-005.ref, which are from the verification
+ * cases of Vallado, Crawford, Hujsak and Kelso, "Revisiting Spacetrack
+ * Report #3", AIAA 2006-6753 (sgp4-ver.tle and tcppver.out, WGS-72). The
+ * cases cover a high eccentricity near-Earth orbit, near-Earth orbits with
+ * and without strong drag, a 12 h resonant Molniya orbit and a deep-space
+ * orbit with high eccentricity.
+ *
+ * The revised SGP4 of that paper fixes several problems of the Spacetrack
+ * Report #3 code this propagator is based on, and solves Kepler's equation
+ * and the sidereal time differently, so the results are not identical. The
+ * cases here agree within 20 m and 20 mm/s; the position must match within
+ * POS_TOL (50 m) and the velocity within VEL_TOL (50 mm/s), like the
+ * Spacetrack Report #3 values in test-001 and test-002. This is a
+ * selection of the published cases; cases that exercise the revisions,
+ * such as the Lyddane modification at low inclination, are left out.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+#include "sgp4sdp4.h"
+
+#define MAX_SATS   16
+#define POS_TOL    0.05         /* km */
+#define VEL_TOL    0.00005      /* km/s */
+
+static sat_t    sats[MAX_SATS];
+static int      nsats;
+
+static int read_tles(const char *fname)
+{
+    FILE           *fp;
+    char            tle_str[3][80];
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 1;
+    }
+
+    while (nsats < MAX_SATS &&
+           fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        if (Get_Next_Tle_Set(tle_str, &sats[nsats].tle) != 1)
+        {
+            printf("Could not read TLE data %s", tle_str[0]);
+            fclose(fp);
+            return 1;
+        }
+        select_ephemeris(&sats[nsats]);
+        nsats++;
+    }
+    fclose(fp);
+
+    return 0;
+}
+
+static sat_t   *find_sat(int catnum)
+{
+    int             i;
+
+    for (i = 0; i < nsats; i++)
+        if (sats[i].tle.catnr == catnum)
+            return &sats[i];
+
+    return NULL;
+}
+
+static void propagate(sat_t * sat, double t)
+{
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4(sat, t);
+    else
+        SGP4(sat, t);
+    Convert_Sat_State(&sat->pos, &sat->vel);
+}
+
+static int check(const char *fname)
+{
+    FILE           *fp;
+    sat_t          *sat;
+    vector_t        pos, vel;
+    double          t;
+    int             catnum, n = 0, errors = 0;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 1;
+    }
+
+    while (fscanf(fp, "%d %lf %lf %lf %lf %lf %lf %lf", &catnum, &t,
+                  &pos.x, &pos.y, &pos.z, &vel.x, &vel.y, &vel.z) == 8)
+    {
+        n++;
+        sat = find_sat(catnum);
+        if (sat == NULL)
+        {
+            printf("%d: no TLE data\n", catnum);
+            errors++;
+            continue;
+        }
+
+        propagate(sat, t);
+        if (!(fabs(sat->pos.x - pos.x) <= POS_TOL &&
+              fabs(sat->pos.y - pos.y) <= POS_TOL &&
+              fabs(sat->pos.z - pos.z) <= POS_TOL &&
+              fabs(sat->vel.x - vel.x) <= VEL_TOL &&
+              fabs(sat->vel.y - vel.y) <= VEL_TOL &&
+              fabs(sat->vel.z - vel.z) <= VEL_TOL))
+        {
+            printf("%d t: %.1f FAILED  dX: %g  dY: %g  dZ: %g  "
+                   "dVX: %g  dVY: %g  dVZ: %g\n", catnum, t,
+                   sat->pos.x - pos.x, sat->pos.y - pos.y,
+                   sat->pos.z - pos.z, sat->vel.x - vel.x,
+                   sat->vel.y - vel.y, sat->vel.z - vel.z);
+            errors++;
+        }
+    }
+    fclose(fp);
+
+    printf("%d satellites, %d vectors, %d failed\n", nsats, n, errors);
+
+    return errors > 0 || n == 0;
+}
+
+int main(void)
+{
+    /* make check runs the tests in the build directory */
+    if (getenv("srcdir") != NULL && chdir(getenv("srcdir")) != 0)
+        return 1;
+
+    if (read_tles("test-005.tle"))
+        return 1;
+
+    return check("test-005.ref");
+}
@@ -0,0 +1,130 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * Startup profiling.
+ *
+ * Each phase is identified by its name, which must be a string literal or
+ * otherwise live as long as the program. The phases are printed in the
+ * order they were first seen, followed by the wall clock time since
+ * startup_prof_start(). Phases may be added from any thread.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "startup-prof.h"
+
+typedef struct {
+    const gchar    *name;
+    gint64          total;      /* usec */
+    guint           count;
+} prof_phase_t;
+
+static gboolean enabled = FALSE;
+static gint64   prof_start = 0;
+static GArray  *phases = NULL;
+static GMutex   prof_lock;
+
+/** Enable profiling and start the wall clock. */
+void startup_prof_start()
+{
+    g_mutex_lock(&prof_lock);
+    enabled = TRUE;
+    prof_start = g_get_monotonic_time();
+    if (phases == NULL)
+        phases = g_array_new(FALSE, TRUE, sizeof(prof_phase_t));
+    g_mutex_unlock(&prof_lock);
+}
+
+/** Check whether startup profiling is running. */
+gboolean startup_prof_enabled()
+{
+    return enabled;
+}
+
+/**
+ * Add the time of a phase.
+ *
+ * @param phase The name of the phase.
+ * @param start Monotonic time when the phase was started.
+ *
+ * Nothing is done if profiling is not running.
+ */
+void startup_prof_add(const gchar * phase, gint64 start)
+{
+    gint64          now = g_get_monotonic_time();
+    prof_phase_t   *p = NULL;
+    guint           i;
+
+    if (!enabled)
+        return;
+
+    g_mutex_lock(&prof_lock);
+    for (i = 0; i < phases->len; i++)
+    {
+        if (strcmp(g_array_index(phases, prof_phase_t, i).name, phase) == 0)
+        {
+            p = &g_array_index(phases, prof_phase_t, i);
+            break;
+        }
+    }
+
+    if (p == NULL)
+    {
+        g_array_set_size(phases, phases->len + 1);
+        p = &g_array_index(phases, prof_phase_t, phases->len - 1);
+        p->name = phase;
+    }
+
+    p->total += now - start;
+    p->count++;
+    g_mutex_unlock(&prof_lock);
+}
+
+/** Print the phases to standard output and stop profiling. */
+void startup_prof_print()
+{
+    prof_phase_t   *p;
+    guint           i;
+
+    if (!enabled)
+        return;
+
+    g_mutex_lock(&prof_lock);
+    enabled = FALSE;
+
+    g_print(_("Startup profile:\n"));
+    g_print("  %-32s %10s %7s\n", _("phase"), _("time [ms]"), _("count"));
+    for (i = 0; i < phases->len; i++)
+    {
+        p = &g_array_index(phases, prof_phase_t, i);
+        g_print("  %-32s %10.1f %7u\n", p->name, p->total / 1000.0, p->count);
+    }
+    g_print("  %-32s %10.1f\n", _("total (wall clock)"),
+            (g_get_monotonic_time() - prof_start) / 1000.0);
+
+    g_array_free(phases, TRUE);
+    phases = NULL;
+    g_mutex_unlock(&prof_lock);
+}
@@ -0,0 +1,38 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef STARTUP_PROF_H
+#define STARTUP_PROF_H 1
+
+#include <glib.h>
+
+/*
+ * Startup profiling (--profile-startup).
+ *
+ * The time spent in each phase of the startup is added up while profiling
+ * is enabled and printed as a table when the main window has been shown.
+ * Phases that run once per module or satellite batch, or on several
+ * threads, are summed, so the total of the phases can exceed the wall
+ * clock time.
+ */
+void            startup_prof_start(void);
+gboolean        startup_prof_enabled(void);
+void            startup_prof_add(const gchar * phase, gint64 start);
+void            startup_prof_print(void);
+
+#endif
@@ -0,0 +1,291 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Check that the module cycle does not allocate in steady state.
+ *
+ * Opens a module with all five views and the radio and rotator
+ * controllers in a temporary configuration directory, lets it run past the
+ * first cycles, which load the events and size the map, and fails if any
+ * of the following cycles allocates, including allocations made by GLib
+ * and GTK+. Time runs THROTTLE times faster than real time so that the
+ * satellites move by a few pixels in each cycle and the map redraws the
+ * markers and footprints, including footprints that cover a pole or cross
+ * the edge of the map. The controllers are not engaged, so they track the
+ * target without talking to a radio or rotator.
+ *
+ * make check runs the test through test-alloc.sh, which provides a virtual
+ * display when there is none. The test is skipped if there is no display
+ * or the allocation counter is not available.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alloc-count.h"
+#include "gtk-rig-ctrl.h"
+#include "gtk-rot-ctrl.h"
+#include "gtk-sat-module.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+#define WARMUP_CYCLES   15
+#define TEST_CYCLES     30
+
+/* one minute per cycle of 20 ms */
+#define THROTTLE        3000
+
+/* the main window used by other parts of gpredict */
+GtkWidget      *app = NULL;
+
+/* a near-Earth, a Molniya and a geostationary satellite without drag */
+static const gchar *sats[][3] = {
+    {"90001",
+     "1 90001U 00000A   17001.50000000  .00000000  00000-0  00000-0 0  9994",
+     "2 90001  62.8000 100.0000 7200000 270.0000  10.0000  2.00614000    12"},
+    {"90002",
+     "1 90002U 00000A   17001.50000000  .00000000  00000-0  00000-0 0  9995",
+     "2 90002   0.0500  80.0000 0002000  90.0000 200.0000  1.00271000    11"},
+    {"90003",
+     "1 90003U 00000A   17001.50000000  .00000000  00000-0  00000-0 0  9996",
+     "2 90003  51.6400 100.0000 0005000  90.0000 270.0000 15.50000000    16"}
+};
+
+/* list, map, event list, polar and single sat view;
+   type;left;right;top;bottom for each view */
+static const gchar module_cfg[] =
+    "[GLOBAL]\n"
+    "SATELLITES=90001;90002;90003;\n"
+    "TIMEOUT=20\n"
+    "GRID=0;0;1;0;1;1;0;1;1;2;4;1;2;0;2;2;2;3;0;1;3;2;3;1;2\n";
+
+/* a receiver and a rotator on the default rigctld and rotctld ports */
+static const gchar radio_cfg[] =
+    "[Radio]\n"
+    "Host=localhost\n"
+    "Port=4532\n"
+    "Type=0\n"
+    "PTT=0\n";
+
+static const gchar rotator_cfg[] =
+    "[Rotator]\n"
+    "Host=localhost\n"
+    "Port=4533\n"
+    "AzType=0\n"
+    "MinAz=0\n"
+    "MaxAz=360\n"
+    "MinEl=0\n"
+    "MaxEl=90\n"
+    "AzStopPos=0\n";
+
+static gboolean write_file(const gchar * dir, const gchar * name,
+                           const gchar * contents)
+{
+    gchar          *path;
+    gboolean        ok;
+
+    path = g_build_filename(dir, name, NULL);
+    ok = g_file_set_contents(path, contents, -1, NULL);
+    g_free(path);
+
+    return ok;
+}
+
+/* Create the configuration directory with the satellites, the module and
+   the radio and rotator */
+static gchar   *create_config(const gchar * confdir)
+{
+    gchar          *satdir, *moddir, *hwdir;
+    gchar          *name, *contents;
+    guint           i;
+
+    satdir = g_build_filename(confdir, "Gpredict", "satdata", NULL);
+    moddir = g_build_filename(confdir, "Gpredict", "modules", NULL);
+    hwdir = g_build_filename(confdir, "Gpredict", "hwconf", NULL);
+    g_mkdir_with_parents(satdir, 0755);
+    g_mkdir_with_parents(moddir, 0755);
+    g_mkdir_with_parents(hwdir, 0755);
+
+    for (i = 0; i < G_N_ELEMENTS(sats); i++)
+    {
+        name = g_strdup_printf("%s.sat", sats[i][0]);
+        contents = g_strdup_printf("[Satellite]\n"
+                                   "VERSION=1.1\n"
+                                   "NAME=TEST SAT %s\n"
+                                   "NICKNAME=TEST SAT %s\n"
+                                   "TLE1=%s\n"
+                                   "TLE2=%s\n",
+                                   sats[i][0], sats[i][0], sats[i][1],
+                                   sats[i][2]);
+        write_file(satdir, name, contents);
+        g_free(contents);
+        g_free(name);
+    }
+
+    write_file(moddir, "test.mod", module_cfg);
+    write_file(hwdir, "test.rig", radio_cfg);
+    write_file(hwdir, "test.rot", rotator_cfg);
+    g_free(satdir);
+    g_free(hwdir);
+
+    return moddir;
+}
+
+/*
+ * Put a controller in its own window like the module popup menu does. The
+ * module pointers are cleared when the module destroys the window.
+ */
+static void show_ctrl(GtkWidget ** ctrl, GtkWidget ** window)
+{
+    if (*ctrl == NULL)
+        return;
+
+    *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    g_signal_connect(*window, "destroy", G_CALLBACK(gtk_widget_destroyed),
+                     window);
+    g_signal_connect(*ctrl, "destroy", G_CALLBACK(gtk_widget_destroyed),
+                     ctrl);
+    gtk_container_add(GTK_CONTAINER(*window), *ctrl);
+    gtk_widget_show_all(*window);
+}
+
+/*
+ * Check the allocations of the last cycle; returns TRUE if there were none.
+ * The stage and view counters hold the values of the last time a stage or
+ * view has been run and are only printed to help find the culprit.
+ */
+static gboolean check_cycle(GtkSatModule * mod)
+{
+    static const gchar *views[GTK_SAT_MOD_VIEW_NUM] = {
+        "list", "map", "polar", "single", "events"
+    };
+    guint           i;
+
+    if (mod->cycle_allocs == 0)
+        return TRUE;
+
+    printf("cycle %u: %u allocations\n", mod->cycles, mod->cycle_allocs);
+    for (i = 0; i < GTK_SAT_MOD_STAGE_NUM; i++)
+        if (mod->stats[i].allocs > 0)
+            printf("  stage %u: %u\n", i, mod->stats[i].allocs);
+    for (i = 0; i < GTK_SAT_MOD_VIEW_NUM; i++)
+        if (mod->view_allocs[i] > 0)
+            printf("  %s view: %u\n", views[i], mod->view_allocs[i]);
+
+    return FALSE;
+}
+
+int main(int argc, char *argv[])
+{
+    GtkSatModule   *mod;
+    GtkWidget      *module;
+    GtkWidget      *window;
+    gchar          *confdir;
+    gchar          *moddir;
+    gchar          *modfile;
+    guint           cycles;
+    guint           fails = 0;
+
+    /* keep the user configuration out of the test; this has to happen
+       before GLib looks up the directories */
+    confdir = g_dir_make_tmp("gpredict-test-XXXXXX", NULL);
+    if (confdir == NULL)
+    {
+        printf("Could not create a configuration directory\n");
+        return 1;
+    }
+    g_setenv("XDG_CONFIG_HOME", confdir, TRUE);
+
+    if (!gtk_init_check(&argc, &argv))
+    {
+        printf("No display; skipping\n");
+        return 77;
+    }
+
+    if (!alloc_count_enable())
+    {
+        printf("Allocation counter not available; skipping\n");
+        return 77;
+    }
+
+    sat_log_init();
+    sat_cfg_load();
+
+    moddir = create_config(confdir);
+    modfile = g_build_filename(moddir, "test.mod", NULL);
+
+    module = gtk_sat_module_new(modfile);
+    if (module == NULL)
+    {
+        printf("Could not open %s\n", modfile);
+        return 1;
+    }
+    mod = GTK_SAT_MODULE(module);
+    mod->throttle = THROTTLE;
+
+    /* in its own window the module is updated while it is shown */
+    mod->state = GTK_SAT_MOD_STATE_WINDOW;
+    window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_default_size(GTK_WINDOW(window), 1000, 600);
+    gtk_container_add(GTK_CONTAINER(window), module);
+    gtk_widget_show_all(window);
+
+    /* the module updates the controllers in each cycle and destroys their
+       windows when it is destroyed */
+    mod->rigctrl = gtk_rig_ctrl_new(mod);
+    show_ctrl(&mod->rigctrl, &mod->rigctrlwin);
+    mod->rotctrl = gtk_rot_ctrl_new(mod);
+    show_ctrl(&mod->rotctrl, &mod->rotctrlwin);
+    if (mod->rigctrl == NULL || mod->rotctrl == NULL)
+    {
+        printf("Could not create the radio and rotator controllers\n");
+        return 1;
+    }
+
+    while (mod->cycles < WARMUP_CYCLES)
+        g_main_context_iteration(NULL, TRUE);
+
+    cycles = mod->cycles;
+    while (mod->cycles < WARMUP_CYCLES + TEST_CYCLES)
+    {
+        g_main_context_iteration(NULL, TRUE);
+        if (mod->cycles != cycles)
+        {
+            cycles = mod->cycles;
+            if (!check_cycle(mod))
+                fails++;
+        }
+    }
+
+    printf("%u cycles checked, %u allocated\n", TEST_CYCLES, fails);
+
+    gtk_widget_destroy(window);
+    sat_cfg_close();
+    sat_log_close();
+
+    g_free(modfile);
+    g_free(moddir);
+    g_free(confdir);
+
+    return fails > 0 ? 1 : 0;
+}
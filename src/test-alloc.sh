@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# Run test-alloc with a display.
+#
+# Uses the display of the session if there is one, otherwise a virtual X
+# server started with xvfb-run or, failing that, the GTK+ Broadway backend
+# with its own broadwayd. The test is skipped if none of them is available.
+
+test=${TEST_ALLOC:-./test-alloc}
+
+if test -n "$DISPLAY" || test -n "$WAYLAND_DISPLAY"
+then
+    exec "$test"
+fi
+
+if command -v xvfb-run > /dev/null 2>&1
+then
+    exec xvfb-run -a -s "-screen 0 1280x1024x24" "$test"
+fi
+
+if command -v broadwayd > /dev/null 2>&1
+then
+    # broadwayd listens on port 8080 plus the display number
+    display=:`expr $$ % 500 + 100`
+    broadwayd "$display" > /dev/null 2>&1 &
+    pid=$!
+    trap 'kill $pid 2> /dev/null' 0
+    sleep 1
+    GDK_BACKEND=broadway BROADWAY_DISPLAY=$display "$test"
+    exit $?
+fi
+
+echo "No display, xvfb-run or broadwayd; skipping"
+exit 77
@@ -0,0 +1,387 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Compare the close approach screening to a brute force search.
+ *
+ * A small synthetic catalogue is screened over a day. Every pair that the
+ * screening has to consider is also sampled every BRUTE_STEP seconds, and
+ * the local minima of the sampled distance are refined with a golden
+ * section search. The minima of a pair within the threshold are grouped
+ * into encounters: minima between which the distance stays below the
+ * threshold, or which are closer than two sieve steps, belong to the same
+ * encounter, as the screening merges them too.
+ *
+ * Each approach found by the screening must lie within an encounter of
+ * its pair, and each encounter must have been found with the miss
+ * distance of its closest approach within DIST_TOL and its time within
+ * TCA_TOL.
+ *
+ * Besides random low Earth orbits the catalogue holds two slow
+ * encounters, where the objects close in at a few m/s and the time of
+ * closest approach is far from the straight line estimate of the sieve:
+ * a pair of LEO objects in neighbouring orbits, one of which catches up
+ * with the other, and a pair of geostationary objects.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "conj-screen.h"
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+#define NUM_RANDOM      40
+#define NUM_PRIMARY     12      /* the first random objects */
+#define THRESHOLD       50.0    /* km */
+#define WINDOW          1.0     /* days */
+#define BRUTE_STEP      10.0    /* sec */
+#define TCA_TOL         1.0     /* sec */
+#define DIST_TOL        0.01    /* km */
+
+/* the main window used by other parts of gpredict */
+GtkWidget      *app = NULL;
+
+/* an encounter found by the brute force search */
+typedef struct {
+    gdouble         start;      /* interval containing the encounter */
+    gdouble         end;
+    gdouble         tca;        /* closest approach */
+    gdouble         dist;
+    gboolean        found;
+} encounter_t;
+
+/* Set up a satellite from mean elements; angles in degrees */
+static void make_sat(sat_t * sat, gint catnum, gdouble alt, gdouble ecc,
+                     gdouble incl, gdouble raan, gdouble argp, gdouble ma)
+{
+    gdouble         a = xkmper + alt;
+
+    memset(sat, 0, sizeof(sat_t));
+    sat->tle.catnr = catnum;
+    sat->tle.epoch = 17001.0;
+    sat->tle.epoch_year = 17;
+    sat->tle.epoch_day = 1;
+    sat->tle.xincl = incl;
+    sat->tle.xnodeo = raan;
+    sat->tle.eo = ecc;
+    sat->tle.omegao = argp;
+    sat->tle.xmo = ma;
+    sat->tle.xno = sqrt(ge / (a * a * a)) * secday / twopi;
+    sat->tle.bstar = 1.0E-5;
+    sat->nickname = g_strdup_printf("OBJ %d", catnum);
+    select_ephemeris(sat);
+    gtk_sat_data_init_sat(sat, NULL);
+}
+
+static gdouble distance(sat_t * s1, sat_t * s2, gdouble t)
+{
+    predict_calc_eci(s1, t);
+    predict_calc_eci(s2, t);
+
+    return sqrt((s1->pos.x - s2->pos.x) * (s1->pos.x - s2->pos.x) +
+                (s1->pos.y - s2->pos.y) * (s1->pos.y - s2->pos.y) +
+                (s1->pos.z - s2->pos.z) * (s1->pos.z - s2->pos.z));
+}
+
+/* Golden section search for the minimum distance within [ta;tb] */
+static gdouble minimize(sat_t * s1, sat_t * s2, gdouble ta, gdouble tb,
+                        gdouble * tca)
+{
+    const gdouble   gr = 0.6180339887498949;
+    gdouble         x1, x2, f1, f2;
+
+    x1 = tb - gr * (tb - ta);
+    x2 = ta + gr * (tb - ta);
+    f1 = distance(s1, s2, x1);
+    f2 = distance(s1, s2, x2);
+
+    while ((tb - ta) * secday > 1.0E-3)
+    {
+        if (f1 < f2)
+        {
+            tb = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = tb - gr * (tb - ta);
+            f1 = distance(s1, s2, x1);
+        }
+        else
+        {
+            ta = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = ta + gr * (tb - ta);
+            f2 = distance(s1, s2, x2);
+        }
+    }
+
+    *tca = 0.5 * (ta + tb);
+
+    return distance(s1, s2, *tca);
+}
+
+/* Positions every BRUTE_STEP seconds from t0 */
+static gdouble *sample_sat(sat_t * sat, gdouble t0, gint nsamples)
+{
+    gdouble        *pos = g_new(gdouble, 3 * nsamples);
+    gint            k;
+
+    for (k = 0; k < nsamples; k++)
+    {
+        predict_calc_eci(sat, t0 + k * BRUTE_STEP / secday);
+        pos[3 * k] = sat->pos.x;
+        pos[3 * k + 1] = sat->pos.y;
+        pos[3 * k + 2] = sat->pos.z;
+    }
+
+    return pos;
+}
+
+/* Find the encounters of a pair from the sampled positions */
+static GArray  *brute_force(sat_t * s1, sat_t * s2, gdouble * p1,
+                            gdouble * p2, gdouble t0, gdouble step,
+                            gint nsamples)
+{
+    GArray         *result;
+    encounter_t     enc, *last;
+    gdouble        *d;
+    gdouble         tca, dist;
+    gint            k, lo, hi;
+
+    result = g_array_new(FALSE, FALSE, sizeof(encounter_t));
+    d = g_new(gdouble, nsamples);
+    for (k = 0; k < nsamples; k++)
+        d[k] = sqrt((p1[3 * k] - p2[3 * k]) * (p1[3 * k] - p2[3 * k]) +
+                    (p1[3 * k + 1] - p2[3 * k + 1]) *
+                    (p1[3 * k + 1] - p2[3 * k + 1]) +
+                    (p1[3 * k + 2] - p2[3 * k + 2]) *
+                    (p1[3 * k + 2] - p2[3 * k + 2]));
+
+    for (k = 0; k < nsamples; k++)
+    {
+        if ((k > 0 && d[k] > d[k - 1]) ||
+            (k < nsamples - 1 && d[k] >= d[k + 1]))
+            continue;
+
+        lo = MAX(k - 1, 0);
+        hi = MIN(k + 1, nsamples - 1);
+        dist = minimize(s1, s2, t0 + lo * BRUTE_STEP / secday,
+                        t0 + hi * BRUTE_STEP / secday, &tca);
+        if (dist > THRESHOLD)
+            continue;
+
+        /* extend the interval while the distance stays below threshold */
+        while (lo > 0 && d[lo] <= THRESHOLD)
+            lo--;
+        while (hi < nsamples - 1 && d[hi] <= THRESHOLD)
+            hi++;
+
+        enc.start = t0 + lo * BRUTE_STEP / secday;
+        enc.end = t0 + hi * BRUTE_STEP / secday;
+        enc.tca = tca;
+        enc.dist = dist;
+        enc.found = FALSE;
+
+        last = result->len ?
+            &g_array_index(result, encounter_t, result->len - 1) : NULL;
+        if (last != NULL && enc.start - last->end <= 2.0 * step / secday)
+        {
+            last->end = MAX(last->end, enc.end);
+            if (enc.dist < last->dist)
+            {
+                last->tca = enc.tca;
+                last->dist = enc.dist;
+            }
+        }
+        else
+        {
+            g_array_append_val(result, enc);
+        }
+    }
+
+    g_free(d);
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    conj_job_t     *job;
+    GArray         *result, *enc;
+    GRand          *rand;
+    gchar          *confdir;
+    sat_t           sats[NUM_RANDOM + 4];
+    gboolean        primary[NUM_RANDOM + 4];
+    gdouble        *pos[NUM_RANDOM + 4];
+    conj_t         *c;
+    encounter_t    *e;
+    gdouble         t0, t1, best, besttca;
+    gint            nsats, nsamples, nenc = 0, fails = 0;
+    gint            i, j;
+    guint           k, m;
+
+    (void)argc;
+    (void)argv;
+
+    /* keep the user configuration out of the test */
+    confdir = g_dir_make_tmp("gpredict-test-XXXXXX", NULL);
+    if (confdir == NULL)
+    {
+        printf("Could not create a configuration directory\n");
+        return 1;
+    }
+    g_setenv("XDG_CONFIG_HOME", confdir, TRUE);
+
+    sat_log_init();
+    sat_cfg_load();
+
+    rand = g_rand_new_with_seed(31);
+    for (i = 0; i < NUM_RANDOM; i++)
+    {
+        make_sat(&sats[i], 1000 + i, g_rand_double_range(rand, 500, 800),
+                 g_rand_double_range(rand, 0.0, 0.01),
+                 g_rand_double_range(rand, 50.0, 100.0),
+                 g_rand_double_range(rand, 0.0, 360.0),
+                 g_rand_double_range(rand, 0.0, 360.0),
+                 g_rand_double_range(rand, 0.0, 360.0));
+        primary[i] = (i < NUM_PRIMARY);
+    }
+    g_rand_free(rand);
+
+    /* the lower object is 40 km behind and catches up at 1.5 m/s */
+    nsats = NUM_RANDOM;
+    make_sat(&sats[nsats], 2000, 700.0, 0.001, 98.0, 40.0, 90.0, 0.0);
+    primary[nsats++] = TRUE;
+    make_sat(&sats[nsats], 2001, 701.0, 0.0011, 98.0, 40.0, 90.0, 0.32);
+    primary[nsats++] = FALSE;
+
+    /* geostationary objects drifting past each other */
+    make_sat(&sats[nsats], 3000, 35786.0, 0.0002, 0.05, 80.0, 0.0, 100.0);
+    primary[nsats++] = TRUE;
+    make_sat(&sats[nsats], 3001, 35790.0, 0.0003, 0.03, 80.0, 0.0, 100.1);
+    primary[nsats++] = FALSE;
+
+    t0 = sats[0].jul_epoch;
+    t1 = t0 + WINDOW;
+    job = conj_job_new(t0, t1, THRESHOLD);
+    for (i = 0; i < nsats; i++)
+        conj_job_add_sat(job, &sats[i], primary[i]);
+    result = conj_job_run(job);
+
+    nsamples = (gint) (WINDOW * secday / BRUTE_STEP) + 1;
+    for (i = 0; i < nsats; i++)
+        pos[i] = sample_sat(&sats[i], t0, nsamples);
+
+    for (i = 0; i < nsats; i++)
+    {
+        for (j = i + 1; j < nsats; j++)
+        {
+            if (!primary[i] && !primary[j])
+                continue;
+
+            enc = brute_force(&sats[i], &sats[j], pos[i], pos[j], t0,
+                              job->step, nsamples);
+
+            /* every approach of the pair must belong to an encounter */
+            for (k = 0; k < result->len; k++)
+            {
+                c = &g_array_index(result, conj_t, k);
+                if (c->catnum1 != sats[i].tle.catnr ||
+                    c->catnum2 != sats[j].tle.catnr)
+                    continue;
+
+                for (m = 0; m < enc->len; m++)
+                {
+                    e = &g_array_index(enc, encounter_t, m);
+                    if (c->tca >= e->start && c->tca <= e->end)
+                        break;
+                }
+                if (m == enc->len)
+                {
+                    printf("%5d %5d  %8.1f s  %8.3f km  not an encounter\n",
+                           c->catnum1, c->catnum2, (c->tca - t0) * secday,
+                           c->dist);
+                    fails++;
+                }
+            }
+
+            /* every encounter must have been found */
+            for (m = 0; m < enc->len; m++)
+            {
+                e = &g_array_index(enc, encounter_t, m);
+                best = -1.0;
+                besttca = 0.0;
+                for (k = 0; k < result->len; k++)
+                {
+                    c = &g_array_index(result, conj_t, k);
+                    if (c->catnum1 == sats[i].tle.catnr &&
+                        c->catnum2 == sats[j].tle.catnr &&
+                        c->tca >= e->start && c->tca <= e->end &&
+                        (best < 0.0 || c->dist < best))
+                    {
+                        best = c->dist;
+                        besttca = c->tca;
+                    }
+                }
+
+                e->found = best >= 0.0 &&
+                    fabs(best - e->dist) <= DIST_TOL &&
+                    fabs(besttca - e->tca) * secday <= TCA_TOL;
+                printf("%5d %5d  %8.1f s  %8.3f km  ", sats[i].tle.catnr,
+                       sats[j].tle.catnr, (e->tca - t0) * secday, e->dist);
+                if (best < 0.0)
+                    printf("missed\n");
+                else
+                    printf("%+8.3f s  %+8.4f km  %s\n",
+                           (besttca - e->tca) * secday, best - e->dist,
+                           e->found ? "ok" : "FAILED");
+                if (!e->found)
+                    fails++;
+                nenc++;
+            }
+
+            g_array_free(enc, TRUE);
+        }
+    }
+
+    printf("%d encounters, %u approaches, %d failed\n", nenc, result->len,
+           fails);
+
+    g_array_free(result, TRUE);
+    conj_job_free(job);
+    for (i = 0; i < nsats; i++)
+    {
+        g_free(pos[i]);
+        g_free(sats[i].nickname);
+        Sat_Release(&sats[i]);
+    }
+
+    sat_cfg_close();
+    sat_log_close();
+    g_free(confdir);
+
+    return (nenc == 0 || fails > 0) ? 1 : 0;
+}
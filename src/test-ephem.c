@@ -0,0 +1,194 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Check the accuracy of the ephemeris cache against direct SGP4/SDP4.
+ *
+ * Fills a cache for each satellite in sgpsdp/test-004.tle with the default
+ * error bound and compares the interpolated state to the propagator at
+ * times between the nodes. The position must be within the error bound of
+ * the cache, the velocity within VEL_TOL and the range rate seen from a
+ * ground station, which sets the Doppler shift, within RATE_TOL.
+ *
+ * SGP4 and SDP4 solve Kepler's equation to e6a, which leaves noise of up
+ * to e6a times the radius in the direct positions, e.g. 0.1 km at
+ * 100000 km. This noise is added to the error bound.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ephem-cache.h"
+#include "gtk-sat-data.h"
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+#define WINDOW          0.25    /* days covered by the cache */
+#define SAMPLE_STEP     (7.3 / 86400.0)         /* days */
+#define VEL_TOL         1.0E-4  /* km/s */
+#define RATE_TOL        1.0E-4  /* km/s */
+
+/* the main window used by other parts of gpredict */
+GtkWidget      *app = NULL;
+
+static gdouble distance(vector_t * a, vector_t * b)
+{
+    return sqrt((a->x - b->x) * (a->x - b->x) +
+                (a->y - b->y) * (a->y - b->y) +
+                (a->z - b->z) * (a->z - b->z));
+}
+
+/* Compare the cache of one satellite to the propagator; returns TRUE if ok */
+static gboolean check_sat(sat_t * sat, qth_t * qth)
+{
+    ephem_cache_t  *cache;
+    sat_t           direct, cached;
+    gdouble         t, t0;
+    gdouble         dpos, dvel, drate;
+    gdouble         maxpos = 0.0, maxvel = 0.0, maxrate = 0.0;
+    gdouble         excess = 0.0;
+    guint           n = 0;
+    gboolean        ok;
+
+    cache = ephem_cache_new(sat, 0.0);
+    cache->autofill = FALSE;
+
+    /* start half a day after epoch; the outer intervals of the cache are
+       not used */
+    t0 = sat->jul_epoch + 0.5;
+    ephem_cache_fill(cache, t0 - 2.0 * cache->step,
+                     t0 + WINDOW + 2.0 * cache->step);
+
+    Sat_Copy(&direct, sat);
+    Sat_Copy(&cached, sat);
+    for (t = t0; t < t0 + WINDOW; t += SAMPLE_STEP)
+    {
+        /* the lunar-solar periodics of SDP4 at t, not those of up to 30
+           minutes ago */
+        direct.dstate.savtsn = 1E20;
+        predict_calc(&direct, qth, t);
+        ephem_cache_calc(cache, &cached, qth, t);
+        if (decayed(&direct))
+            break;
+
+        dpos = distance(&direct.pos, &cached.pos);
+        Magnitude(&direct.pos);
+        excess = MAX(excess, dpos - e6a * direct.pos.w - cache->maxerr);
+        dvel = distance(&direct.vel, &cached.vel);
+        drate = fabs(direct.range_rate - cached.range_rate);
+        maxpos = MAX(maxpos, dpos);
+        maxvel = MAX(maxvel, dvel);
+        maxrate = MAX(maxrate, drate);
+        n++;
+    }
+
+    ok = n > 0 && cache->misses == 0 && excess <= 0.0 &&
+        maxvel <= VEL_TOL && maxrate <= RATE_TOL;
+    printf("%5d %-18s step %5.1f s  %5u samples  pos %8.5f km  "
+           "vel %.2e km/s  rate %.2e km/s  %s\n",
+           sat->tle.catnr, sat->nickname, cache->step * 86400.0, n, maxpos,
+           maxvel, maxrate, ok ? "ok" : "FAILED");
+
+    Sat_Release(&direct);
+    Sat_Release(&cached);
+    ephem_cache_free(cache);
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE           *fp;
+    gchar          *confdir;
+    gchar          *fname;
+    gchar           tle_str[3][80];
+    sat_t           sat;
+    qth_t           qth;
+    guint           n = 0, fails = 0;
+
+    (void)argc;
+    (void)argv;
+
+    /* keep the user configuration out of the test */
+    confdir = g_dir_make_tmp("gpredict-test-XXXXXX", NULL);
+    if (confdir == NULL)
+    {
+        printf("Could not create a configuration directory\n");
+        return 1;
+    }
+    g_setenv("XDG_CONFIG_HOME", confdir, TRUE);
+
+    sat_log_init();
+    sat_cfg_load();
+
+    fname = g_build_filename(g_getenv("srcdir") ? g_getenv("srcdir") : ".",
+                             "sgpsdp", "test-004.tle", NULL);
+    fp = g_fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 1;
+    }
+
+    memset(&qth, 0, sizeof(qth));
+    qth.lat = 55.6167;
+    qth.lon = 12.65;
+    qth.alt = 5;
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        memset(&sat, 0, sizeof(sat));
+        if (Get_Next_Tle_Set(tle_str, &sat.tle) != 1)
+        {
+            printf("Could not read TLE data %s", tle_str[0]);
+            fails++;
+            continue;
+        }
+        g_strchomp(sat.tle.sat_name);
+        sat.nickname = g_strdup(sat.tle.sat_name);
+        select_ephemeris(&sat);
+        gtk_sat_data_init_sat(&sat, NULL);
+
+        if (!check_sat(&sat, &qth))
+            fails++;
+        n++;
+
+        g_free(sat.nickname);
+        Sat_Release(&sat);
+    }
+    fclose(fp);
+
+    printf("%u satellites, %u failed\n", n, fails);
+
+    sat_cfg_close();
+    sat_log_close();
+    g_free(fname);
+    g_free(confdir);
+
+    return (n == 0 || fails > 0) ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+#!/bin/sh
+#
+# Check the offline queries of gpredict --query.
+#
+# Runs the queries in test-query.in against the satellites in test-query.tle
+# and the location in test-query.qth in a temporary configuration directory
+# and compares the responses to test-query.ref. Decimal numbers may differ by
+# up to 5 units in the last printed digit, which allows for differences in
+# the maths library; everything else must match.
+#
+# Run with -g to print new reference responses.
+
+srcdir=${srcdir:-.}
+gpredict=${GPREDICT:-./gpredict}
+
+confdir=`mktemp -d "${TMPDIR:-/tmp}/gpredict-test-XXXXXX"` || exit 1
+trap 'rm -rf "$confdir"' 0
+gpdir="$confdir/Gpredict"
+
+# the location, satellites and a category keep the first time checks from
+# looking for the installed data
+mkdir -p "$gpdir/satdata" "$gpdir/modules" || exit 1
+cp "$srcdir/test-query.qth" "$gpdir/sample.qth" || exit 1
+cp "$srcdir/test-query.qth" "$gpdir/test.qth" || exit 1
+echo "Test" > "$gpdir/satdata/test.cat"
+while IFS= read -r name && IFS= read -r tle1 && IFS= read -r tle2
+do
+    catnum=`echo "$tle2" | cut -c3-7 | tr -d ' '`
+    printf '[Satellite]\nVERSION=1.1\nNAME=%s\nNICKNAME=%s\nTLE1=%s\nTLE2=%s\n' \
+        "$name" "$name" "$tle1" "$tle2" > "$gpdir/satdata/$catnum.sat"
+    echo "$catnum" >> "$gpdir/satdata/test.cat"
+done < "$srcdir/test-query.tle"
+
+XDG_CONFIG_HOME="$confdir" HOME="$confdir" LC_ALL=C \
+    "$gpredict" --query "$srcdir/test-query.in" > "$confdir/out" || exit 1
+
+if test "x$1" = "x-g"
+then
+    cat "$confdir/out"
+    exit 0
+fi
+
+awk '
+# Replace the numbers of a line with # and store them in nums
+function scan(s, nums,    n)
+{
+    n = 0
+    skel = ""
+    while (match(s, /-?[0-9]+(\.[0-9]+)?/))
+    {
+        nums[++n] = substr(s, RSTART, RLENGTH)
+        skel = skel substr(s, 1, RSTART - 1) "#"
+        s = substr(s, RSTART + RLENGTH)
+    }
+    skel = skel s
+
+    return n
+}
+
+NR == FNR { ref[FNR] = $0; nref = FNR; next }
+
+{
+    lines = FNR
+    n = scan(ref[FNR], want)
+    wskel = skel
+    if (scan($0, got) != n || skel != wskel)
+    {
+        printf("line %d differs:\n  expected %s\n  got      %s\n",
+               FNR, ref[FNR], $0)
+        bad = 1
+        next
+    }
+    for (i = 1; i <= n; i++)
+    {
+        dot = index(want[i], ".")
+        tol = dot ? 5 / 10 ^ (length(want[i]) - dot) : 0
+        diff = want[i] - got[i]
+        if (diff < 0)
+            diff = -diff
+        if (diff > tol * 1.000001)
+        {
+            printf("line %d: expected %s, got %s\n", FNR, want[i], got[i])
+            bad = 1
+        }
+    }
+}
+
+END {
+    if (lines != nref)
+    {
+        printf("expected %d responses, got %d\n", nref, lines)
+        bad = 1
+    }
+    exit bad
+}' "$srcdir/test-query.ref" "$confdir/out"
@@ -0,0 +1,240 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Check that a slow stream client gets the frames of every module.
+ *
+ * Two modules publish to a binary client that does not read until the
+ * socket is full. The client must then get the latest frame of both
+ * modules; the older frames of the busy module are dropped. The test is
+ * skipped if UNIX sockets are not available.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include "gtk-sat-data.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "sat-stream.h"
+
+/* enough records to fill the socket buffers in a few frames */
+#define BIG_SATS        4000
+#define BIG_FRAMES      8
+
+/* the main window used by other parts of gpredict */
+GtkWidget      *app = NULL;
+
+/* Run the main loop for a while */
+static void spin(guint ms)
+{
+    gint64          end = g_get_monotonic_time() + ms * 1000;
+
+    while (g_get_monotonic_time() < end)
+        if (!g_main_context_iteration(NULL, FALSE))
+            g_usleep(1000);
+}
+
+static GHashTable *create_sats(sat_t * sats, guint n, gint first)
+{
+    GHashTable     *table;
+    guint           i;
+
+    table = g_hash_table_new(g_int_hash, g_int_equal);
+    for (i = 0; i < n; i++)
+    {
+        sats[i].tle.catnr = first + i;
+        g_hash_table_insert(table, &sats[i].tle.catnr, &sats[i]);
+    }
+
+    return table;
+}
+
+/* Read until the server has nothing more to send */
+static GByteArray *read_all(GSocket * socket)
+{
+    GByteArray     *data;
+    gchar           buff[65536];
+    gssize          n;
+    guint           idle = 0;
+
+    data = g_byte_array_new();
+    while (idle < 50)
+    {
+        spin(10);
+        n = g_socket_receive(socket, buff, sizeof(buff), NULL, NULL);
+        if (n > 0)
+        {
+            g_byte_array_append(data, (guint8 *) buff, n);
+            idle = 0;
+        }
+        else
+        {
+            idle++;
+        }
+    }
+
+    return data;
+}
+
+/* Find the time of the last frame of a module; returns -1 if none */
+static gdouble last_frame(GByteArray * data, const gchar * module,
+                          guint * count)
+{
+    const guint8   *p = data->data;
+    const guint8   *end = data->data + data->len;
+    gdouble         t, last = -1.0;
+    guint16         n;
+
+    *count = 0;
+    while (p + SAT_STREAM_HDRSIZE <= end && !memcmp(p, SAT_STREAM_MAGIC, 4))
+    {
+        memcpy(&n, p + 6, 2);
+        memcpy(&t, p + 8, 8);
+        n = GUINT16_FROM_LE(n);
+        if (!strncmp((const gchar *)p + 16, module, 24))
+        {
+            last = t;
+            (*count)++;
+        }
+        p += SAT_STREAM_HDRSIZE + n * sizeof(sat_stream_rec_t);
+    }
+
+    return last;
+}
+
+int main(int argc, char *argv[])
+{
+#ifdef HAVE_GIO_UNIX
+    GSocketClient  *client;
+    GSocketConnection *conn;
+    GSocketAddress *addr;
+    GSocket        *socket;
+    GByteArray     *data;
+    GHashTable     *big, *small;
+    sat_t          *bigsats, smallsat;
+    gchar          *confdir;
+    gchar          *path;
+    gdouble         tbig, tsmall;
+    guint           nbig, nsmall;
+    guint           i;
+    gint            ret = 0;
+
+    (void)argc;
+    (void)argv;
+
+    /* keep the user configuration out of the test */
+    confdir = g_dir_make_tmp("gpredict-test-XXXXXX", NULL);
+    if (confdir == NULL)
+    {
+        printf("Could not create a configuration directory\n");
+        return 1;
+    }
+    g_setenv("XDG_CONFIG_HOME", confdir, TRUE);
+
+    sat_log_init();
+    sat_cfg_load();
+
+    path = g_build_filename(confdir, "stream.sock", NULL);
+    sat_cfg_set_str(SAT_CFG_STR_STREAM_SOCKET, path);
+    if (!sat_stream_start())
+    {
+        printf("Could not start the stream server\n");
+        return 1;
+    }
+
+    client = g_socket_client_new();
+    addr = g_unix_socket_address_new(path);
+    conn = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(addr), NULL,
+                                   NULL);
+    if (conn == NULL)
+    {
+        printf("Could not connect to %s\n", path);
+        return 1;
+    }
+    socket = g_socket_connection_get_socket(conn);
+    g_socket_set_blocking(socket, FALSE);
+    g_socket_send(socket, "FMT bin\n", 8, NULL, NULL);
+    spin(200);
+
+    bigsats = g_new0(sat_t, BIG_SATS);
+    big = create_sats(bigsats, BIG_SATS, 1);
+    memset(&smallsat, 0, sizeof(smallsat));
+    small = create_sats(&smallsat, 1, 90000);
+
+    /* the big module fills the socket, the small one publishes in the
+       same cycles */
+    for (i = 1; i <= BIG_FRAMES; i++)
+    {
+        sat_stream_publish("big", big, i);
+        sat_stream_publish("small", small, i);
+    }
+    sat_stream_publish("big", big, BIG_FRAMES + 1);
+
+    data = read_all(socket);
+    tbig = last_frame(data, "big", &nbig);
+    tsmall = last_frame(data, "small", &nsmall);
+    printf("%u bytes: %u frames of big, last %.0f; "
+           "%u frames of small, last %.0f\n",
+           data->len, nbig, tbig, nsmall, tsmall);
+
+    if (nbig > BIG_FRAMES)
+    {
+        printf("The socket did not fill up\n");
+        ret = 1;
+    }
+    if (tbig != BIG_FRAMES + 1 || tsmall != BIG_FRAMES)
+    {
+        printf("Latest frames missing\n");
+        ret = 1;
+    }
+
+    g_byte_array_free(data, TRUE);
+    g_object_unref(conn);
+    g_object_unref(addr);
+    g_object_unref(client);
+    sat_stream_stop();
+    g_hash_table_destroy(big);
+    g_hash_table_destroy(small);
+    g_free(bigsats);
+
+    sat_cfg_close();
+    sat_log_close();
+
+    g_unlink(path);
+    g_free(path);
+    g_free(confdir);
+
+    return ret;
+#else
+    (void)argc;
+    (void)argv;
+
+    printf("No UNIX sockets; skipping\n");
+
+    return 77;
+#endif
+}
@@ -42,6 +42,7 @@
 #include "gpredict-utils.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "sat-trace.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "tle-update.h"
 
@@ -118,6 +119,7 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
     guint           total, total_tmp;
     gdouble         fraction = 0.0;
     gdouble         start = 0.0;
+    gint64          trace;
 
     (void)filter;
 
@@ -183,7 +185,9 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
                 }
 
                 /* now, do read the fresh data */
+                trace = sat_trace_begin();
                 num = read_fresh_tle(dir, fnam, data);
+                sat_trace_end_arg("tle", "read TLE file", trace, fnam);
             }
             else
             {
@@ -263,6 +267,7 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
             g_dir_rewind(loc_dir);
 
             /* update TLE files one by one */
+            trace = sat_trace_begin();
             while ((fnam = g_dir_read_name(loc_dir)) != NULL)
             {
                 /* only consider .sat files */
@@ -366,6 +371,8 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
                 }
             }
 
+            sat_trace_end("tle", "update .sat files", trace);
+
             /* force gui update */
             while (g_main_context_iteration(NULL, FALSE));
 
@@ -375,7 +382,9 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
             /* see if we have any new sats that need to be added */
             if (sat_cfg_get_bool(SAT_CFG_BOOL_TLE_ADD_NEW))
             {
+                trace = sat_trace_begin();
                 newsats = add_new_sats(data);
+                sat_trace_end("tle", "add new satellites", trace);
 
                 if (!silent && (label2 != NULL))
                 {
@@ -494,6 +503,7 @@ void tle_update_from_network(gboolean silent,
     gchar          *text;
     GError         *err = NULL;
     guint           success = 0;        /* no. of successfull downloads */
+    gint64          trace;
 
     /* bail out if we are already in an update process */
     if (g_mutex_trylock(&tle_in_progress) == FALSE)
@@ -580,6 +590,7 @@ void tle_update_from_network(gboolean silent,
             outfile = g_fopen(locfile, "wb");
             if (outfile != NULL)
             {
+                trace = sat_trace_begin();
 #ifdef WIN32
                 res = win32_fetch(curfile, outfile, proxy, "gpredict/win32");
                 if (res != 0)
@@ -617,6 +628,7 @@ void tle_update_from_network(gboolean silent,
                 }
 #endif
                 fclose(outfile);
+                sat_trace_end_arg("tle", "download", trace, curfile);
             }
             else
             {
@@ -41,6 +41,26 @@
 #define KEY_MODE        "MODE"
 #define KEY_BAUD        "BAUD"
 
+/* Frequency range of a transponder in the database */
+typedef struct {
+    gint64          low;
+    gint64          high;
+    guint           catnum;
+} trsp_range_t;
+
+/* The transponder database */
+static struct {
+    GHashTable     *sats;       /* catnum -> GSList of trsp_t */
+    GArray         *down;       /* downlink ranges sorted by low */
+    GArray         *up;         /* uplink ranges sorted by low */
+    gint64          downspan;   /* widest downlink range */
+    gint64          upspan;     /* widest uplink range */
+    gboolean        dirty;      /* ranges need to be rebuilt */
+} db;
+
+static GMutex   db_mutex;
+static GHookList db_watches;
+
 static void check_trsp_freq(trsp_t * trsp)
 {
     /* ensure we don't have any negative frequencies */
@@ -64,13 +84,8 @@ static void check_trsp_freq(trsp_t * trsp)
         trsp->uphigh = trsp->uplow;
 }
 
-/**
- * Read transponder data file.
- * 
- * @param catnum The catalog number of the satellite to read transponders for.
- * @return  The new transponder list.
- */
-GSList *read_transponders(guint catnum)
+/* Read transponder data file */
+static GSList  *load_transponders(guint catnum)
 {
     GSList         *trsplist = NULL;
     trsp_t         *trsp;
@@ -128,7 +143,7 @@ GSList *read_transponders(guint catnum)
         trsp->uplow = g_key_file_get_int64(cfg, groups[i], KEY_UP_LOW, &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_UP_LOW,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_UP_LOW,
                         name, groups[i]);
             g_clear_error(&error);
         }
@@ -137,7 +152,7 @@ GSList *read_transponders(guint catnum)
                                             &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_UP_HIGH,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_UP_HIGH,
                         name, groups[i]);
             g_clear_error(&error);
         }
@@ -146,7 +161,7 @@ GSList *read_transponders(guint catnum)
                                              &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_DOWN_LOW,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_DOWN_LOW,
                         name, groups[i]);
             g_clear_error(&error);
         }
@@ -155,7 +170,7 @@ GSList *read_transponders(guint catnum)
                                               &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_DOWN_HIGH,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_DOWN_HIGH,
                         name, groups[i]);
             g_clear_error(&error);
         }
@@ -167,7 +182,7 @@ GSList *read_transponders(guint catnum)
                                               KEY_INVERT, &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_INVERT,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_INVERT,
                         name, groups[i]);
             g_clear_error(&error);
             trsp->invert = FALSE;
@@ -176,7 +191,7 @@ GSList *read_transponders(guint catnum)
         trsp->mode = g_key_file_get_string(cfg, groups[i], KEY_MODE, &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_MODE,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_MODE,
                         name, groups[i]);
             g_clear_error(&error);
         }
@@ -184,7 +199,7 @@ GSList *read_transponders(guint catnum)
         trsp->baud = g_key_file_get_double(cfg, groups[i], KEY_BAUD, &error);
         if (error != NULL)
         {
-            sat_log_log(SAT_LOG_LEVEL_INFO, INFO_MSG, __func__, KEY_BAUD,
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, INFO_MSG, __func__, KEY_BAUD,
                         name, groups[i]);
             g_clear_error(&error);
         }
@@ -202,6 +217,170 @@ GSList *read_transponders(guint catnum)
     return trsplist;
 }
 
+static GSList  *copy_transponders(GSList * trsplist)
+{
+    GSList         *copy = NULL;
+    trsp_t         *trsp;
+
+    for (; trsplist != NULL; trsplist = trsplist->next)
+    {
+        trsp = g_new(trsp_t, 1);
+        *trsp = *(trsp_t *) trsplist->data;
+        trsp->name = g_strdup(trsp->name);
+        trsp->mode = g_strdup(trsp->mode);
+        copy = g_slist_prepend(copy, trsp);
+    }
+
+    return g_slist_reverse(copy);
+}
+
+static gboolean equal_transponders(GSList * a, GSList * b)
+{
+    trsp_t         *ta, *tb;
+
+    for (; a != NULL && b != NULL; a = a->next, b = b->next)
+    {
+        ta = (trsp_t *) a->data;
+        tb = (trsp_t *) b->data;
+
+        if (g_strcmp0(ta->name, tb->name) || g_strcmp0(ta->mode, tb->mode) ||
+            ta->uplow != tb->uplow || ta->uphigh != tb->uphigh ||
+            ta->downlow != tb->downlow || ta->downhigh != tb->downhigh ||
+            ta->baud != tb->baud || !ta->invert != !tb->invert)
+            return FALSE;
+    }
+
+    return a == NULL && b == NULL;
+}
+
+/* Load all .trsp files into the database. Must be called with db_mutex held. */
+static void db_load(void)
+{
+    GDir           *dir;
+    GSList         *trsplist;
+    gchar          *dirname;
+    const gchar    *fname;
+    gchar          *end;
+    guint           catnum;
+
+    db.sats = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                    (GDestroyNotify) free_transponders);
+    db.down = g_array_new(FALSE, FALSE, sizeof(trsp_range_t));
+    db.up = g_array_new(FALSE, FALSE, sizeof(trsp_range_t));
+    db.dirty = TRUE;
+
+    dirname = get_trsp_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not open transponder directory %s"),
+                    __func__, dirname);
+        g_free(dirname);
+        return;
+    }
+
+    while ((fname = g_dir_read_name(dir)))
+    {
+        catnum = (guint) g_ascii_strtoull(fname, &end, 10);
+        if (end == fname || g_strcmp0(end, ".trsp"))
+            continue;
+
+        trsplist = load_transponders(catnum);
+        if (trsplist != NULL)
+            g_hash_table_insert(db.sats, GUINT_TO_POINTER(catnum), trsplist);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Loaded transponders for %d satellites"),
+                __func__, g_hash_table_size(db.sats));
+
+    g_dir_close(dir);
+    g_free(dirname);
+}
+
+static gint range_compare(gconstpointer a, gconstpointer b)
+{
+    const trsp_range_t *ra = a;
+    const trsp_range_t *rb = b;
+
+    return (ra->low > rb->low) - (ra->low < rb->low);
+}
+
+static void add_range(GArray * ranges, gint64 * span, gint64 low,
+                      gint64 high, guint catnum)
+{
+    trsp_range_t    range;
+
+    if (high <= 0)
+        return;
+
+    /* inverting transponders may be listed high to low */
+    range.low = MIN(low, high);
+    range.high = MAX(low, high);
+    range.catnum = catnum;
+    g_array_append_val(ranges, range);
+
+    if (range.high - range.low > *span)
+        *span = range.high - range.low;
+}
+
+/* Rebuild the frequency ranges. Must be called with db_mutex held. */
+static void db_rebuild_ranges(void)
+{
+    GHashTableIter  iter;
+    gpointer        key, value;
+    GSList         *l;
+    trsp_t         *trsp;
+
+    g_array_set_size(db.down, 0);
+    g_array_set_size(db.up, 0);
+    db.downspan = 0;
+    db.upspan = 0;
+
+    g_hash_table_iter_init(&iter, db.sats);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+    {
+        for (l = value; l != NULL; l = l->next)
+        {
+            trsp = (trsp_t *) l->data;
+            add_range(db.down, &db.downspan, trsp->downlow, trsp->downhigh,
+                      GPOINTER_TO_UINT(key));
+            add_range(db.up, &db.upspan, trsp->uplow, trsp->uphigh,
+                      GPOINTER_TO_UINT(key));
+        }
+    }
+
+    g_array_sort(db.down, range_compare);
+    g_array_sort(db.up, range_compare);
+    db.dirty = FALSE;
+}
+
+/**
+ * Get the transponders of a satellite.
+ *
+ * @param catnum The catalog number of the satellite to read transponders for.
+ * @return  A copy of the transponder list, which must be freed using
+ *          free_transponders().
+ *
+ * The transponder files are loaded into memory the first time this or any
+ * other transponder database function is called.
+ */
+GSList         *read_transponders(guint catnum)
+{
+    GSList         *trsplist;
+
+    g_mutex_lock(&db_mutex);
+    if (db.sats == NULL)
+        db_load();
+    trsplist = copy_transponders(g_hash_table_lookup(db.sats,
+                                                     GUINT_TO_POINTER
+                                                     (catnum)));
+    g_mutex_unlock(&db_mutex);
+
+    return trsplist;
+}
+
 /**
  * Write transponder list to file.
  *
@@ -209,7 +388,8 @@ GSList *read_transponders(guint catnum)
  * @param trsplist Pointer to a GSList of trsp_t structures.
  *
  * The transponder list is written to a file called "catnum.trsp". If the file
- * already exists, its contents will be deleted.
+ * already exists, its contents will be deleted. The transponder database is
+ * updated if the file was written successfully.
  */
 void write_transponders(guint catnum, GSList * trsp_list)
 {
@@ -236,6 +416,7 @@ void write_transponders(guint catnum, GSList * trsp_list)
             continue;
         }
 
+        trsp_written++;
         if (trsp->uplow > 0)
             g_key_file_set_int64(trsp_data, trsp->name, KEY_UP_LOW,
                                  trsp->uplow);
@@ -253,7 +434,7 @@ void write_transponders(guint catnum, GSList * trsp_list)
         if (trsp->invert)
             g_key_file_set_boolean(trsp_data, trsp->name, KEY_INVERT, TRUE);
         if (trsp->mode)
-            g_key_file_set_string(trsp_data, trsp->name, KEY_MODE, trsp->name);
+            g_key_file_set_string(trsp_data, trsp->name, KEY_MODE, trsp->mode);
     }
 
     if (gpredict_save_key_file(trsp_data, trsp_file))
@@ -265,8 +446,17 @@ void write_transponders(guint catnum, GSList * trsp_list)
     else
     {
         sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("Wrote %d transmponders to %s"),
-                    trsp_written, trsp_file_name);
+                    _("%s: Wrote %d transponders to %s"),
+                    __func__, trsp_written, trsp_file);
+
+        g_mutex_lock(&db_mutex);
+        if (db.sats != NULL)
+        {
+            g_hash_table_replace(db.sats, GUINT_TO_POINTER(catnum),
+                                 copy_transponders(trsp_list));
+            db.dirty = TRUE;
+        }
+        g_mutex_unlock(&db_mutex);
     }
 
     g_key_file_free(trsp_data);
@@ -296,3 +486,169 @@ void free_transponders(GSList * trsplist)
     g_slist_free(trsplist);
     trsplist = NULL;
 }
+
+/**
+ * Store the transponders of a satellite if they have changed.
+ *
+ * @param catnum The catalog number of the satellite.
+ * @param trsplist Pointer to a GSList of trsp_t structures.
+ * @return TRUE if the transponders were different and have been written.
+ *
+ * The list is compared to the one in the transponder database and only
+ * written using write_transponders() if it differs. The frequencies are
+ * normalised the same way as when reading the file.
+ */
+gboolean trsp_db_store(guint catnum, GSList * trsplist)
+{
+    GSList         *l;
+    gboolean        changed;
+
+    for (l = trsplist; l != NULL; l = l->next)
+        check_trsp_freq((trsp_t *) l->data);
+
+    g_mutex_lock(&db_mutex);
+    if (db.sats == NULL)
+        db_load();
+    changed = !equal_transponders(trsplist,
+                                  g_hash_table_lookup(db.sats,
+                                                      GUINT_TO_POINTER
+                                                      (catnum)));
+    g_mutex_unlock(&db_mutex);
+
+    if (changed)
+        write_transponders(catnum, trsplist);
+
+    return changed;
+}
+
+static gint catnum_compare(gconstpointer a, gconstpointer b)
+{
+    guint           ca = *(const guint *)a;
+    guint           cb = *(const guint *)b;
+
+    return (ca > cb) - (ca < cb);
+}
+
+/**
+ * Find satellites with a transponder in a frequency range.
+ *
+ * @param low The lower limit of the frequency range [Hz].
+ * @param high The upper limit of the frequency range [Hz].
+ * @param uplink Search uplinks instead of downlinks.
+ * @return A sorted array of guint catalog numbers, without duplicates. Free
+ *         it using g_array_unref().
+ *
+ * A satellite matches if any part of one of its transponders is within
+ * the range.
+ */
+GArray         *trsp_db_find(gint64 low, gint64 high, gboolean uplink)
+{
+    GArray         *result;
+    GArray         *ranges;
+    trsp_range_t   *range;
+    gint64          start;
+    guint           lo, hi, mid, i, n;
+
+    result = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    g_mutex_lock(&db_mutex);
+    if (db.sats == NULL)
+        db_load();
+    if (db.dirty)
+        db_rebuild_ranges();
+
+    ranges = uplink ? db.up : db.down;
+    start = low - (uplink ? db.upspan : db.downspan);
+
+    /* first range that can reach low; no range is wider than the span */
+    lo = 0;
+    hi = ranges->len;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (g_array_index(ranges, trsp_range_t, mid).low < start)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (i = lo; i < ranges->len; i++)
+    {
+        range = &g_array_index(ranges, trsp_range_t, i);
+        if (range->low > high)
+            break;
+        if (range->high >= low)
+            g_array_append_val(result, range->catnum);
+    }
+    g_mutex_unlock(&db_mutex);
+
+    g_array_sort(result, catnum_compare);
+    for (i = 0, n = 0; i < result->len; i++)
+    {
+        if (n == 0 || g_array_index(result, guint, i) !=
+            g_array_index(result, guint, n - 1))
+            g_array_index(result, guint, n++) = g_array_index(result, guint, i);
+    }
+    g_array_set_size(result, n);
+
+    return result;
+}
+
+static void watch_marshal(GHook * hook, gpointer data)
+{
+    ((trsp_db_watch_t) hook->func) ((GArray *) data, hook->data);
+}
+
+static gboolean notify_watches(gpointer data)
+{
+    if (db_watches.is_setup)
+        g_hook_list_marshal(&db_watches, FALSE, watch_marshal, data);
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * Notify the watches that transponders have changed.
+ *
+ * @param catnums Array of guint catalog numbers of the changed satellites.
+ *
+ * The watches are called from the main loop. The array is referenced and
+ * may be released by the caller.
+ */
+void trsp_db_notify(GArray * catnums)
+{
+    g_main_context_invoke_full(NULL, G_PRIORITY_DEFAULT, notify_watches,
+                               g_array_ref(catnums),
+                               (GDestroyNotify) g_array_unref);
+}
+
+/**
+ * Add a transponder database watch.
+ *
+ * @param func The function to call when transponders have changed.
+ * @param data User data passed to func.
+ * @return The ID of the watch to be used with trsp_db_remove_watch().
+ *
+ * Watches must be added and removed from the main loop.
+ */
+guint trsp_db_add_watch(trsp_db_watch_t func, gpointer data)
+{
+    GHook          *hook;
+
+    if (!db_watches.is_setup)
+        g_hook_list_init(&db_watches, sizeof(GHook));
+
+    hook = g_hook_alloc(&db_watches);
+    hook->func = func;
+    hook->data = data;
+    g_hook_append(&db_watches, hook);
+
+    return hook->hook_id;
+}
+
+/** Remove a transponder database watch. */
+void trsp_db_remove_watch(guint id)
+{
+    if (db_watches.is_setup)
+        g_hook_destroy(&db_watches, id);
+}
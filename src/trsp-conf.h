@@ -43,8 +43,22 @@ typedef struct {
 
 /* The actual data would then be a singly linked list with pointers to transponder_t structures */
 
+/**
+ * Called when transponders have changed.
+ *
+ * @param catnums Array of guint catalog numbers of the changed satellites.
+ * @param data User data given to trsp_db_add_watch().
+ */
+typedef void    (*trsp_db_watch_t) (GArray * catnums, gpointer data);
+
 GSList         *read_transponders(guint catnum);
 void            write_transponders(guint catnum, GSList * trsplist);
 void            free_transponders(GSList * trsplist);
 
+gboolean        trsp_db_store(guint catnum, GSList * trsplist);
+GArray         *trsp_db_find(gint64 low, gint64 high, gboolean uplink);
+void            trsp_db_notify(GArray * catnums);
+guint           trsp_db_add_watch(trsp_db_watch_t func, gpointer data);
+void            trsp_db_remove_watch(guint id);
+
 #endif
@@ -36,6 +36,7 @@
 #include <locale.h>
 
 #include "compat.h"
+#include "trsp-conf.h"
 #include "trsp-update.h"
 #include "gpredict-utils.h"
 #include "sat-cfg.h"
@@ -61,21 +62,6 @@ typedef enum {
     TRSP_AUTO_UPDATE_NUM
 } trsp_auto_upd_freq_t;
 
-/* Data structure to hold a TRSP set. */
-struct transponder {
-    char            uuid[30];   /* uuid */
-    int             catnum;     /* Catalog number. */
-    char            description[80];    /* Transponder descriptoion */
-    long long       uplink_low; /* Uplink starting frequency */
-    long long       uplink_high;        /* uplink end frequency  */
-    long long       downlink_low;       /* downlink starting frequency */
-    long long       downlink_high;      /* downlink end frequency */
-    char            mode[20];   /* mode (from modes files) */
-    int             invert;     /* inverting / noninverting */
-    double          baud;       /* baudrate */
-    int             alive;      /* alive or dead */
-};
-
 /* Data structure to hold a MODES set. */
 struct modes {
     int             id;         /* id */
@@ -88,12 +74,6 @@ typedef struct {
     gchar          *modname;    /* Mode description. */
 } new_mode_t;
 
-/* Data structure to hold a TRSP list. */
-typedef struct {
-    guint           catnum;     /* Catalog number. */
-    guint           numtrsp;    /* Number of transponders. */
-} new_trsp_t;
-
 #ifndef WIN32
 /* private function prototypes */
 static size_t   my_write_func(void *ptr, size_t size, size_t nmemb,
@@ -128,17 +108,46 @@ static void free_new_mode(gpointer data)
     g_free(mmode);
 }
 
-/** Free a new_trsp_t structure. */
-static void free_new_trsp(gpointer data)
+/* Find a transponder by name */
+static gboolean has_trsp(GSList * trsplist, const gchar * name)
 {
-    //TODO: remove this.
-    new_trsp_t     *mtrsp;
+    for (; trsplist != NULL; trsplist = trsplist->next)
+        if (!g_strcmp0(((trsp_t *) trsplist->data)->name, name))
+            return TRUE;
+
+    return FALSE;
+}
+
+/*
+ * Append a transponder to a list. The name is used as group name in the
+ * .trsp file, so it is made valid and unique within the satellite.
+ */
+static GSList  *add_trsp(GSList * trsplist, trsp_t * trsp)
+{
+    gchar          *name;
+    guint           n = 1;
 
-    mtrsp = (new_trsp_t *) data;
+    g_strdelimit(trsp->name, "[", '(');
+    g_strdelimit(trsp->name, "]", ')');
+    g_strdelimit(trsp->name, "\r\n", ' ');
 
-    g_free(mtrsp);
+    name = g_strdup(trsp->name);
+    while (has_trsp(trsplist, name))
+    {
+        g_free(name);
+        name = g_strdup_printf("%s (%d)", trsp->name, ++n);
+    }
+    g_free(trsp->name);
+    trsp->name = name;
+
+    return g_slist_append(trsplist, trsp);
 }
 
+/*
+ * Update the .trsp files from the SatNOGS transmitters.json and modes.json.
+ * Only the files of satellites whose transponders have changed are written
+ * and the transponder database watches are notified about those.
+ */
 void trsp_update_files(gchar * input_file)
 {
 
@@ -146,17 +155,19 @@ void trsp_update_files(gchar * input_file)
     size_t          mfplen;     /* size of transmitter information json file */
     long            flen;       /* holds the file size returned by ftell or -1 on error */
     int             result;
-    FILE           *ffile;      /* transponder output file in gpredict format */
     char           *jsn_object; /* json array will be in this buffer before parsing */
     unsigned int    idx;        /* object index in JSON-Array */
     new_mode_t     *nmode;
-    new_trsp_t     *ntrsp;
+    trsp_t         *trsp;
     GHashTable     *modes_hash; /* hash table to store modes */
-    GHashTable     *trsp_hash;  /* hash table to store satellite list to generate trsp files */
+    GHashTable     *trsp_hash;  /* catnum -> GSList of new transponders */
+    GHashTableIter  iter;
+    gpointer        hkey, hvalue;
+    GArray         *changed;    /* catnums with changed transponders */
     guint          *key = NULL;
+    guint           catnum, mode_id;
 
     gchar          *userconfdir;
-    gchar          *trspfile;
     gchar          *modesfile;
     gchar          *trspfolder;
 
@@ -165,8 +176,7 @@ void trsp_update_files(gchar * input_file)
 
     modes_hash =
         g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_new_mode);
-    trsp_hash =
-        g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_new_trsp);
+    trsp_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     userconfdir = get_user_conf_dir();
     trspfolder = g_strconcat(userconfdir, G_DIR_SEPARATOR_S, "trsp", NULL);
@@ -223,6 +233,10 @@ void trsp_update_files(gchar * input_file)
                             g_hash_table_insert(modes_hash, key, nmode);
 
                         }
+                        else
+                        {
+                            g_free(key);
+                        }
 
                         sat_log_log(SAT_LOG_LEVEL_INFO, _("MODE %d %s"),
                                     m_modes.id, m_modes.name);
@@ -263,118 +277,43 @@ void trsp_update_files(gchar * input_file)
                     while (1)
                     {
                         const nx_json  *json_obj = nx_json_item(json, idx++);
-                        struct transponder m_trsp;
+                        const gchar    *text;
 
                         if (json_obj->type == NX_JSON_NULL)
                             break;
 
-                        strncpy(m_trsp.description,
-                                nx_json_get(json_obj,
-                                            "description")->text_value, 79);
-                        m_trsp.description[79] = 0;
-                        m_trsp.catnum =
+                        catnum =
                             nx_json_get(json_obj, "norad_cat_id")->int_value;
-                        m_trsp.uplink_low =
+                        if (catnum == 0)
+                            continue;
+
+                        trsp = g_new0(trsp_t, 1);
+                        text = nx_json_get(json_obj, "description")->text_value;
+                        trsp->name = g_strdup(text ? text : "Transponder");
+                        trsp->uplow =
                             nx_json_get(json_obj, "uplink_low")->int_value;
-                        m_trsp.uplink_high =
+                        trsp->uphigh =
                             nx_json_get(json_obj, "uplink_high")->int_value;
-                        m_trsp.downlink_low =
+                        trsp->downlow =
                             nx_json_get(json_obj, "downlink_low")->int_value;
-                        m_trsp.downlink_high =
+                        trsp->downhigh =
                             nx_json_get(json_obj, "downlink_high")->int_value;
 
-                        key = g_try_new0(guint, 1);
-                        *key = nx_json_get(json_obj, "mode_id")->int_value;
-                        nmode = g_hash_table_lookup(modes_hash, key);
+                        mode_id = nx_json_get(json_obj, "mode_id")->int_value;
+                        nmode = g_hash_table_lookup(modes_hash, &mode_id);
                         if (nmode != NULL)
-                            sprintf(m_trsp.mode, "%s", nmode->modname);
+                            trsp->mode = g_strdup(nmode->modname);
                         else
-                            sprintf(m_trsp.mode, "%lli",
-                                    nx_json_get(json_obj,
-                                                "mode_id")->int_value);
-
-                        m_trsp.invert =
-                            nx_json_get(json_obj, "invert")->int_value;
-                        m_trsp.baud = nx_json_get(json_obj, "baud")->dbl_value;
-                        m_trsp.alive =
-                            nx_json_get(json_obj, "alive")->int_value;
-
-                        //strcpy(m_trsp.uuid,nx_json_get(json_obj,          "uuid")->text_value);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(">>> Preparing information for transponders of cat_id %d <<<"), m_trsp.catnum, __func__);
-                        ////sat_log_log (SAT_LOG_LEVEL_INFO, _("         uuid : %s"), m_trsp.uuid, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("  description : %s"), m_trsp.description, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("        alive : %s"), m_trsp.alive ? "true" : "false", __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("   uplink_low : %Ld"),m_trsp.uplink_low, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("  uplink_high : %Ld"),m_trsp.uplink_high, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(" downink_low  : %Ld"),m_trsp.downlink_low, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("downlink_high : %Ld"),m_trsp.downlink_high, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("         Mode : %s"), m_trsp.mode, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("       Invert : %s"), m_trsp.invert ? "true" : "false", __func__);
-                        // sat_log_log(SAT_LOG_LEVEL_DEBUG, _("         Baud : %lf"),m_trsp.baud, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(" norad_cat_id : %Ld"),m_trsp.catnum, __func__);
-                        char            m_catnum[20];
-
-                        sprintf(m_catnum, "%d", m_trsp.catnum);
-                        trspfile = g_strconcat(trspfolder, G_DIR_SEPARATOR_S,
-                                               m_catnum, ".trsp", NULL);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Writing to file : %s "), __func__, trspfile);
-
-                        //first lets delete the file we already have, to make space for the new version
-                        /* check existence and add data to hash table for future check */
-                        key = g_try_new0(guint, 1);
-                        *key = m_trsp.catnum;
-                        ntrsp = g_hash_table_lookup(trsp_hash, key);
+                            trsp->mode = g_strdup_printf("%u", mode_id);
 
-                        if (ntrsp == NULL)
-                        {
-                            /* create new_trsp structure */
-                            ntrsp = g_try_new(new_trsp_t, 1);
-                            ntrsp->catnum = m_trsp.catnum;
-                            ntrsp->numtrsp = 1; //our first insertion of transponder to this file
-                            g_hash_table_insert(trsp_hash, key, ntrsp);
-                            if (g_remove(trspfile))
-                                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                            _("%s: Failed to remove %s"),
-                                            __func__, trspfile);
-                        }
-                        else
-                        {
-                            //TODO: increase number of transponders here
-                            //ntrsp->numtrsp += 1; //number of transponder info in this file
-                            //g_hash_table_replace(trsp_hash, key, ntrsp);
-                        }
+                        trsp->invert =
+                            nx_json_get(json_obj, "invert")->int_value != 0;
+                        trsp->baud = nx_json_get(json_obj, "baud")->dbl_value;
 
-                        //now lets write the new version
-                        ffile = g_fopen(trspfile, "a");
-                        if (ffile != NULL)
-                        {
-                            fprintf(ffile, "\n[%s]\n", m_trsp.description);
-                            if (m_trsp.uplink_low > 0)
-                                fprintf(ffile, "UP_LOW=%lld\n",
-                                        m_trsp.uplink_low);
-                            if (m_trsp.uplink_high > 0)
-                                fprintf(ffile, "UP_HIGH=%lld\n",
-                                        m_trsp.uplink_high);
-                            if (m_trsp.downlink_low > 0)
-                                fprintf(ffile, "DOWN_LOW=%lld\n",
-                                        m_trsp.downlink_low);
-                            if (m_trsp.downlink_high > 0)
-                                fprintf(ffile, "DOWN_HIGH=%lld\n",
-                                        m_trsp.downlink_high);
-                            fprintf(ffile, "MODE=%s\n", m_trsp.mode);
-                            if (m_trsp.baud > 0.0)
-                                fprintf(ffile, "BAUD=%.0f\n", m_trsp.baud);
-                            if (m_trsp.invert)
-                                fprintf(ffile, "INVERT=%s\n", "true");
-                            fclose(ffile);
-                        }
-                        else
-                        {
-                            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                        _
-                                        ("%s: Could not open trsp file for write"),
-                                        __func__);
-                        }
+                        hvalue = g_hash_table_lookup(trsp_hash,
+                                                     GUINT_TO_POINTER(catnum));
+                        g_hash_table_insert(trsp_hash, GUINT_TO_POINTER(catnum),
+                                            add_trsp(hvalue, trsp));
                     }           // while(1)
                     nx_json_free(json);
                 }               // if(json)
@@ -384,7 +323,30 @@ void trsp_update_files(gchar * input_file)
         fclose(mfp);
     }                           // if(mfp)
 
+    /* only rewrite the satellites whose transponders have changed */
+    changed = g_array_new(FALSE, FALSE, sizeof(guint));
+    g_hash_table_iter_init(&iter, trsp_hash);
+    while (g_hash_table_iter_next(&iter, &hkey, &hvalue))
+    {
+        catnum = GPOINTER_TO_UINT(hkey);
+        if (trsp_db_store(catnum, hvalue))
+            g_array_append_val(changed, catnum);
+        free_transponders(hvalue);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Transponders changed for %d of %d satellites"),
+                __func__, changed->len, g_hash_table_size(trsp_hash));
+
+    if (changed->len > 0)
+        trsp_db_notify(changed);
+
+    g_array_unref(changed);
+    g_hash_table_destroy(trsp_hash);
     g_hash_table_destroy(modes_hash);
+    g_free(modesfile);
+    g_free(trspfolder);
+    g_free(userconfdir);
 }
 
 /** Update MODES files from network. */